@@ -28,6 +28,7 @@
 #include "itkObjectFactory.h"
 #include "itkPoint.h"
 
+#include "otbDEMTileCache.h"
 #include "OTBOSSIMAdaptersExport.h"
 #include <string>
 
@@ -81,6 +82,13 @@ namespace otb
  * GetHeightAboveEllipsoid() method.
  *
  * DEM directory can either contain DTED or SRTM formats.
+ *
+ * When all the opened DEM directories contain SRTM tiles, heights are
+ * read from a DEMTileCache instead of the OSSIM elevation manager:
+ * tiles are decoded once and shared by all threads, without locking,
+ * within a memory budget (SetTileCacheMaximumMemory()).
+ * Points not covered by the tiles, or surrounded by no-data posts,
+ * still follow the rules above through OSSIM.
  * \ingroup Images
  *
  *
@@ -135,6 +143,12 @@ public:
    */
   virtual bool OpenGeoidFile(const std::string& geoidFile);
 
+  /**
+   * \brief Close the geoid file opened by OpenGeoidFile(), so that
+   * another one can be opened.
+   */
+  void ClearGeoid();
+
   /** Compute the height above MSL(Mean Sea Level) of a geographic point. */
   virtual double GetHeightAboveMSL(double lon, double lat) const;
   virtual double GetHeightAboveMSL(const PointType& geoPoint) const;
@@ -143,6 +157,19 @@ public:
   virtual double GetHeightAboveEllipsoid(double lon, double lat) const;
   virtual double GetHeightAboveEllipsoid(const PointType& geoPoint) const;
 
+  /** Compute the heights above MSL of an array of geographic points.
+   * The SRTM tile cache is queried once for the whole batch. */
+  virtual void GetHeightAboveMSL(const PointType* geoPoints, double* heights, std::size_t count) const;
+
+  /** Compute the heights above ellipsoid of an array of geographic points.
+   * The SRTM tile cache is queried once for the whole batch. */
+  virtual void GetHeightAboveEllipsoid(const PointType* geoPoints, double* heights, std::size_t count) const;
+
+  /** Set the memory budget of the decoded SRTM tiles, in MB (default 256).
+   * The least recently used tiles are released when it is exceeded. */
+  void SetTileCacheMaximumMemory(unsigned int megabytes);
+  unsigned int GetTileCacheMaximumMemory() const;
+
   /** Set the default height above ellipsoid in case no information is available*/
   virtual void SetDefaultHeightAboveEllipsoid(double h);
 
@@ -181,6 +208,12 @@ protected:
   // ellipsoid We therefore must keep it on our side
   double m_DefaultHeightAboveEllipsoid;
 
+  // SRTM tiles shared by all threads
+  DEMTileCache m_TileCache;
+
+  // False if a DEM directory is handled by OSSIM only
+  bool m_UseTileCache;
+
   static Pointer m_Singleton;
 
 };
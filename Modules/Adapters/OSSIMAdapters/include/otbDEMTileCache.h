@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbDEMTileCache_h
+#define otbDEMTileCache_h
+
+#include "itkMutexLock.h"
+#include "OTBOSSIMAdaptersExport.h"
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace otb
+{
+
+/** \class DEMTileCache
+ *
+ * \brief Thread-safe cache of SRTM tiles, decoded once and shared
+ *
+ * The cache indexes the SRTM tiles (files named like N43E001.hgt) of
+ * one or several directories. A tile is decoded the first time a point
+ * falls in it, and it is never modified afterwards: concurrent height
+ * queries only read an atomic pointer in a table with one slot per
+ * 1x1 degree cell, and take no lock. The lock is only taken to
+ * load a missing tile.
+ *
+ * Heights are interpolated bilinearly between the four surrounding
+ * posts, ignoring the no-data posts, as done by the OSSIM SRTM handler.
+ * The geoid offset is sampled on a 15' grid (the EGM96 grid) when a tile
+ * is loaded, and interpolated bilinearly as well.
+ *
+ * The decoded tiles are limited by a memory budget (SetMaximumMemory()).
+ * When a new tile does not fit, the least recently used tiles are
+ * unlinked from the table. As queries hold no lock, an unlinked tile is
+ * only freed once the queries that may still read it are over: each
+ * query registers in the current epoch, and the tiles unlinked during
+ * an epoch are freed when the next epoch is over. The budget can thus
+ * be exceeded for the duration of the running queries.
+ *
+ * AddDirectory(), SetGeoidFunction(), SetMaximumMemory() and Clear()
+ * are configuration methods: they must not be called while heights are
+ * queried.
+ *
+ * \ingroup OTBOSSIMAdapters
+ */
+class OTBOSSIMAdapters_EXPORT DEMTileCache
+{
+public:
+  /** Function giving the geoid offset at (lon, lat) */
+  typedef std::function<double (double, double)> GeoidFunctionType;
+
+  DEMTileCache();
+  ~DEMTileCache();
+
+  /** Index the SRTM tiles of a directory. Tiles already indexed from a
+   * previous directory are kept. Returns the number of tiles found. */
+  unsigned int AddDirectory(const std::string & directory);
+
+  /** Set the function used to sample the geoid. Loaded tiles are
+   * released, so that their geoid samples are computed again. */
+  void SetGeoidFunction(const GeoidFunctionType & geoid);
+
+  /** Forget all the indexed tiles */
+  void Clear();
+
+  /** Number of indexed tiles */
+  unsigned int GetNumberOfTiles() const;
+
+  /** Set the memory budget of the decoded tiles, in MB (default 256).
+   * The last loaded tile is always kept, even if it exceeds the budget. */
+  void SetMaximumMemory(unsigned int megabytes);
+  unsigned int GetMaximumMemory() const;
+
+  /** Number of decoded tiles kept in memory */
+  unsigned int GetNumberOfLoadedTiles() const;
+
+  /** Interpolate the height above MSL. Returns false if the point is
+   * not covered by a tile, or if the surrounding posts are no-data. */
+  bool GetHeightAboveMSL(double lon, double lat, double & height) const;
+
+  /** Interpolate the height above ellipsoid (height above MSL plus
+   * geoid offset). Same return value as GetHeightAboveMSL(). */
+  bool GetHeightAboveEllipsoid(double lon, double lat, double & height) const;
+
+  /** Interpolate the heights above MSL of count points. The coordinates
+   * of point i are lon[i * stride] and lat[i * stride]. Points without
+   * height get NaN. Returns the number of points without height. */
+  std::size_t GetHeightAboveMSL(const double* lon, const double* lat, std::size_t stride,
+                                std::size_t count, double* heights) const;
+
+  /** Same as above for the heights above ellipsoid */
+  std::size_t GetHeightAboveEllipsoid(const double* lon, const double* lat, std::size_t stride,
+                                      std::size_t count, double* heights) const;
+
+private:
+  DEMTileCache(const DEMTileCache &) = delete;
+  void operator =(const DEMTileCache &) = delete;
+
+  /** Number of geoid samples along each side of a tile */
+  static const unsigned int GeoidSamples = 5;
+
+  struct Tile
+  {
+    /** Cell of the tile */
+    int                                 Id;
+    /** Value of the load counter when the tile was last read */
+    mutable std::atomic<unsigned long>  LastUse;
+    /** Number of posts along each side */
+    unsigned int                        Size;
+    /** Posts, row major, from the north-west corner */
+    std::vector<short>                  Posts;
+    /** Geoid offset, row major, from the south-west corner */
+    double                              Geoid[GeoidSamples][GeoidSamples];
+  };
+
+  /** Get the tile of a cell, loading it if needed. Returns nullptr if
+   * the cell is not covered. */
+  const Tile* GetTile(int lonIndex, int latIndex) const;
+
+  /** Decode a tile file. Returns nullptr if the file is not valid. */
+  Tile* LoadTile(const std::string & filename, int lon, int lat) const;
+
+  bool Interpolate(double lon, double lat, double & height, double & offset, bool withGeoid) const;
+
+  std::size_t InterpolateBatch(const double* lon, const double* lat, std::size_t stride,
+                               std::size_t count, double* heights, bool withGeoid) const;
+
+  /** Register a query in the current epoch, returns the epoch */
+  unsigned int BeginRead() const;
+  void EndRead(unsigned int epoch) const;
+
+  /** Unlink the least recently used tiles until a tile of the given
+   * size fits in the budget. Called under the lock. */
+  void MakeRoom(std::size_t bytes) const;
+
+  /** Free the unlinked tiles that no query can read anymore, and start
+   * a new epoch. Called under the lock. */
+  void ReclaimTiles() const;
+
+  /** Release the decoded tiles, keeping the index */
+  void ReleaseTiles();
+
+  /** Marks the cells without tile */
+  Tile                                         m_NoTile;
+
+  /** One slot per 1x1 degree cell: nullptr until the tile is loaded */
+  std::unique_ptr<std::atomic<const Tile*>[]>  m_Slots;
+
+  /** Tile filename of each indexed cell */
+  std::map<int, std::string>                   m_Files;
+
+  /** Owner of the decoded tiles */
+  mutable std::vector<std::unique_ptr<Tile> >  m_Tiles;
+
+  /** Unlinked tiles, by parity of the epoch they were unlinked in */
+  mutable std::vector<std::unique_ptr<Tile> >  m_RetiredTiles[2];
+
+  /** Number of running queries, by parity of their epoch */
+  mutable std::atomic<long>                    m_Readers[2];
+
+  mutable std::atomic<unsigned int>            m_Epoch;
+
+  /** Incremented at each tile load, stamps the tiles being read */
+  mutable std::atomic<unsigned long>           m_LoadCounter;
+
+  /** Memory used by the linked tiles */
+  mutable std::size_t                          m_LoadedBytes;
+
+  std::size_t                                  m_MaximumBytes;
+
+  GeoidFunctionType                            m_Geoid;
+
+  mutable itk::SimpleMutexLock                 m_Mutex;
+};
+
+} // namespace otb
+
+#endif
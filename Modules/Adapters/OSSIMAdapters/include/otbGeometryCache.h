@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbGeometryCache_h
+#define otbGeometryCache_h
+
+#include "otbImageKeywordlist.h"
+#include "OTBOSSIMAdaptersExport.h"
+
+#include <string>
+
+namespace otb
+{
+
+/** \class GeometryCache
+ *
+ * \brief On-disk cache of sensor geometries
+ *
+ * Parsing the metadata of a sensor product (DIMAP, ...) through the
+ * OSSIM plugins, and estimating a RPC model from a physical model, are
+ * done again each time the same product is processed. This cache stores
+ * the resulting keywordlists as geom files in the directory given by
+ * ConfigurationManager::GetGeometryCacheDirectory()
+ * (OTB_GEOMETRY_CACHE_DIRECTORY). It is disabled when no directory is
+ * set.
+ *
+ * Entries are named after a key. Product keys hash the absolute path,
+ * size and modification time of the product file and the name, size and
+ * modification time of all the files of its directory, so that a new
+ * version of the product metadata gives a new key. The files of a
+ * directory are listed once per process, and again each time the
+ * modification time of the directory changes (a file is added, removed
+ * or replaced): a metadata file rewritten in place, without changing
+ * the directory, is only noticed by a new process. Other keys hash a
+ * description of what is cached, for instance the serialized input
+ * model and the estimation parameters.
+ *
+ * Entries are written to a temporary file and renamed, so that
+ * concurrent processes never read a partial entry.
+ *
+ * \ingroup OTBOSSIMAdapters
+ */
+class OTBOSSIMAdapters_EXPORT GeometryCache
+{
+public:
+  /** True if a cache directory is set */
+  static bool IsEnabled();
+
+  /** Key of a product file. Options modifying how the product is read
+   * are appended to the hashed description. Returns an empty key if
+   * the file does not exist (GDAL virtual file systems, ...). */
+  static std::string ComputeProductKey(const std::string & filename,
+                                       const std::string & options = "");
+
+  /** Key of a description */
+  static std::string ComputeKey(const std::string & description);
+
+  /** Serialize a keywordlist, to build a description */
+  static std::string Serialize(const ImageKeywordlist & kwl);
+
+  /** Read an entry. Returns false if the entry does not exist or is
+   * empty. */
+  static bool Load(const std::string & key, ImageKeywordlist & kwl);
+
+  /** Write an entry. Errors are logged and ignored: the cache is only
+   * an optimization. */
+  static void Store(const std::string & key, const ImageKeywordlist & kwl);
+
+private:
+  GeometryCache() = delete;
+  ~GeometryCache() = delete;
+  GeometryCache(const GeometryCache&) = delete;
+  void operator =(const GeometryCache&) = delete;
+};
+
+} // namespace otb
+
+#endif
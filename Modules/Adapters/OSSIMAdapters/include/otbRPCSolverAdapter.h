@@ -31,8 +31,6 @@
 
 #include "OTBOSSIMAdaptersExport.h"
 
-class ossimRpcSolver;
-
 namespace otb {
 
 class ImageKeywordlist;
@@ -65,6 +63,12 @@ public:
    *  not provide elevation support, since there are not enough points
    *  to estimate all the coefficients. Starting at 40 points, a full
    *  RPC model is estimated.
+   *
+   *  From 512 GCPs, the coefficients are estimated by iteratively
+   *  reweighted least squares. The normal equations are assembled in
+   *  parallel, each thread accumulating the contribution of a block of
+   *  GCPs. Smaller GCP sets, and the sets for which this estimation
+   *  fails, are solved by ossimRpcSolver.
    */
   static void Solve(const GCPsContainerType& gcpContainer,
                     double& rmsError,
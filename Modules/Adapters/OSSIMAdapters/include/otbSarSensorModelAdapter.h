@@ -92,6 +92,12 @@ public:
   (col,row) */
   bool WorldToLineSample(const Point3DType & inGEoPOint, Point2DType & cr) const;
 
+  /** Transform an array of world points (lat,lon,hgt) to input image
+  points (col,row). Consecutive points should be close to each other,
+  since each one is located starting from the previous one. Return
+  false if one of the points could not be located. */
+  bool WorldToLineSample(const Point3DType * inGeoPoints, Point2DType * cr, std::size_t count) const;
+
 /** Transform world point (lat,lon,hgt) to satellite position (x,y,z) and satellite velocity */
   bool WorldToSatPositionAndVelocity(const Point3DType & inGeoPoint, Point3DType & satellitePosition,  
 				     Point3DType & satelliteVelocity) const;
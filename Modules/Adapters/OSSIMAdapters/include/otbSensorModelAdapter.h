@@ -87,6 +87,21 @@ public:
   void InverseTransformPoint(double lon, double lat,
                              double& x, double& y, double& z) const;
 
+  /** Forward sensor modelling of count points. If z is null, the
+   *  elevation is estimated by the algorithm for each point. */
+  void ForwardTransformPoints(std::size_t count,
+                              const double* x, const double* y, const double* z,
+                              double* lon, double* lat, double* h) const;
+
+  /** Inverse sensor modelling of count points. If h is null, the
+   *  elevations are read from DEMHandler in a single batched query, so
+   *  that neighbouring points share the DEM tile lookups. SAR models
+   *  locate the points with a batched search of the orbit records, which
+   *  gives the same points as InverseTransformPoint(). */
+  void InverseTransformPoints(std::size_t count,
+                              const double* lon, const double* lat, const double* h,
+                              double* x, double* y, double* z) const;
+
 
   /** Add a tie point with elevation (above ellipsoid) provided by the user */
   void AddTiePoint(double x, double y, double z, double lon, double lat);
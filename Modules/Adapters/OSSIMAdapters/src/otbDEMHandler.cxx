@@ -22,6 +22,7 @@
 #include "otbMacro.h"
 
 #include <cassert>
+#include <cmath>
 
 #if defined(__GNUC__) || defined(__clang__)
 #pragma GCC diagnostic push
@@ -69,16 +70,75 @@ DEMHandler::Pointer DEMHandler::Instance()
   return m_Singleton;
 }
 
+namespace
+{
+double GeoidOffset(double lon, double lat)
+{
+  // Same offset as the one added by the OSSIM elevation databases
+  return ossimGeoidManager::instance()->offsetFromEllipsoid(ossimGpt(lat, lon));
+}
+
+/** Geoid registered once in the OSSIM geoid manager, whose grid can be
+ * closed: OSSIM does not allow removing a geoid from the manager. */
+class ClosableGeoid : public ossimGeoid
+{
+public:
+  bool open(const ossimFilename& geoidFile, ossimByteOrder byteOrder = OSSIM_BIG_ENDIAN) override
+  {
+    ossimRefPtr<ossimGeoid> geoid = new ossimGeoidEgm96(geoidFile, byteOrder);
+    if (geoid->getErrorStatus() != ossimErrorCodes::OSSIM_OK)
+      {
+      return false;
+      }
+    m_Geoid = geoid;
+    return true;
+  }
+
+  void close()
+  {
+    m_Geoid = nullptr;
+  }
+
+  double offsetFromEllipsoid(const ossimGpt& gpt) override
+  {
+    return m_Geoid.valid() ? m_Geoid->offsetFromEllipsoid(gpt) : ossim::nan();
+  }
+
+  // Only found by its name while a grid is open
+  ossimString getShortName() const override
+  {
+    return m_Geoid.valid() ? m_Geoid->getShortName() : ossimString("closed");
+  }
+
+private:
+  ossimRefPtr<ossimGeoid> m_Geoid;
+};
+
+ClosableGeoid * GetClosableGeoid()
+{
+  static ossimRefPtr<ClosableGeoid> geoid;
+  if (!geoid.valid())
+    {
+    geoid = new ClosableGeoid;
+    ossimGeoidManager::instance()->addGeoid(geoid.get());
+    }
+  return geoid.get();
+}
+}
+
 DEMHandler
 ::DEMHandler() :
   m_GeoidFile(""),
-  m_DefaultHeightAboveEllipsoid(0)
+  m_DefaultHeightAboveEllipsoid(0),
+  m_UseTileCache(true)
 {
   assert( ossimElevManager::instance()!=NULL );
 
   ossimElevManager::instance()->setDefaultHeightAboveEllipsoid(m_DefaultHeightAboveEllipsoid);
   // Force geoid fallback
   ossimElevManager::instance()->setUseGeoidIfNullFlag(true);
+
+  m_TileCache.SetGeoidFunction(&GeoidOffset);
 }
 
 void
@@ -109,6 +169,13 @@ DEMHandler
       ossimElevManager::instance()->addDatabase(imageElevationDatabase.get());
       }
     }
+
+  // Directories without SRTM tiles are only read by OSSIM: to keep the
+  // same precedence between directories, the tile cache is not used
+  if (m_TileCache.AddDirectory(DEMDirectory) == 0)
+    {
+    m_UseTileCache = false;
+    }
 }
 
 
@@ -119,6 +186,9 @@ DEMHandler
   assert( ossimElevManager::instance()!=NULL );
 
   ossimElevManager::instance()->clear();
+
+  m_TileCache.Clear();
+  m_UseTileCache = true;
 }
 
 
@@ -155,16 +225,15 @@ DEMHandler
   if ((ossimGeoidManager::instance()->findGeoidByShortName("geoid1996")) == nullptr)
     {
     otbMsgDevMacro(<< "Opening geoid: " << geoidFile);
-    ossimFilename           geoid(geoidFile);
-    ossimRefPtr<ossimGeoid> geoidPtr = new ossimGeoidEgm96(geoid);
-    if (geoidPtr->getErrorStatus() == ossimErrorCodes::OSSIM_OK)
+    if (GetClosableGeoid()->open(ossimFilename(geoidFile)))
       {
       // Ossim does not allow retrieving the geoid file path
       // We therefore must keep it on our side
       m_GeoidFile = geoidFile;
       otbMsgDevMacro(<< "Geoid successfully opened");
-      ossimGeoidManager::instance()->addGeoid(geoidPtr);
-      geoidPtr.release();
+
+      // Geoid samples of the loaded tiles are outdated
+      m_TileCache.SetGeoidFunction(&GeoidOffset);
 
       // The previous flag will be ignored if
       // defaultHeightAboveEllipsoid is not NaN
@@ -177,7 +246,6 @@ DEMHandler
     else
       {
       otbMsgDevMacro(<< "Failure opening geoid");
-      geoidPtr.release();
 
       itkExceptionMacro( << "Failed to open geoid file: '" << geoidFile << "'" );
 
@@ -195,11 +263,31 @@ DEMHandler
   return OpenGeoidFile(geoidFile.c_str());
 }
 
+void
+DEMHandler
+::ClearGeoid()
+{
+  GetClosableGeoid()->close();
+  m_GeoidFile = "";
+
+  // Geoid samples of the loaded tiles are outdated
+  m_TileCache.SetGeoidFunction(&GeoidOffset);
+
+  assert( ossimElevManager::instance()!=NULL );
+
+  ossimElevManager::instance()->setDefaultHeightAboveEllipsoid(m_DefaultHeightAboveEllipsoid);
+}
+
 double
 DEMHandler
 ::GetHeightAboveMSL(double lon, double lat) const
 {
   double   height;
+  if (m_UseTileCache && m_TileCache.GetHeightAboveMSL(lon, lat, height))
+    {
+    return height;
+    }
+
   ossimGpt ossimWorldPoint;
 
   ossimWorldPoint.lon = lon;
@@ -224,6 +312,11 @@ DEMHandler
 ::GetHeightAboveEllipsoid(double lon, double lat) const
 {
   double   height;
+  if (m_UseTileCache && m_TileCache.GetHeightAboveEllipsoid(lon, lat, height))
+    {
+    return height;
+    }
+
   ossimGpt ossimWorldPoint;
 
   ossimWorldPoint.lon = lon;
@@ -243,6 +336,77 @@ DEMHandler
   return GetHeightAboveEllipsoid(geoPoint[0], geoPoint[1]);
 }
 
+// The batched queries read the coordinates through strided pointers
+static_assert(sizeof(DEMHandler::PointType) == 2 * sizeof(double), "PointType must hold two packed doubles");
+
+void
+DEMHandler
+::GetHeightAboveMSL(const PointType* geoPoints, double* heights, std::size_t count) const
+{
+  if (count == 0)
+    {
+    return;
+    }
+  std::size_t missing = count;
+  if (m_UseTileCache)
+    {
+    missing = m_TileCache.GetHeightAboveMSL(&geoPoints[0][0], &geoPoints[0][1], 2, count, heights);
+    }
+  // Points without SRTM height go through OSSIM
+  for (std::size_t i = 0; missing > 0 && i < count; ++i)
+    {
+    if (!m_UseTileCache || std::isnan(heights[i]))
+      {
+      ossimGpt ossimWorldPoint;
+      ossimWorldPoint.lon = geoPoints[i][0];
+      ossimWorldPoint.lat = geoPoints[i][1];
+      heights[i] = ossimElevManager::instance()->getHeightAboveMSL(ossimWorldPoint);
+      --missing;
+      }
+    }
+}
+
+void
+DEMHandler
+::GetHeightAboveEllipsoid(const PointType* geoPoints, double* heights, std::size_t count) const
+{
+  if (count == 0)
+    {
+    return;
+    }
+  std::size_t missing = count;
+  if (m_UseTileCache)
+    {
+    missing = m_TileCache.GetHeightAboveEllipsoid(&geoPoints[0][0], &geoPoints[0][1], 2, count, heights);
+    }
+  // Points without SRTM height go through OSSIM
+  for (std::size_t i = 0; missing > 0 && i < count; ++i)
+    {
+    if (!m_UseTileCache || std::isnan(heights[i]))
+      {
+      ossimGpt ossimWorldPoint;
+      ossimWorldPoint.lon = geoPoints[i][0];
+      ossimWorldPoint.lat = geoPoints[i][1];
+      heights[i] = ossimElevManager::instance()->getHeightAboveEllipsoid(ossimWorldPoint);
+      --missing;
+      }
+    }
+}
+
+void
+DEMHandler
+::SetTileCacheMaximumMemory(unsigned int megabytes)
+{
+  m_TileCache.SetMaximumMemory(megabytes);
+}
+
+unsigned int
+DEMHandler
+::GetTileCacheMaximumMemory() const
+{
+  return m_TileCache.GetMaximumMemory();
+}
+
 void
 DEMHandler
 ::SetDefaultHeightAboveEllipsoid(double h)
@@ -300,6 +464,10 @@ DEMHandler
 {
   Superclass::PrintSelf(os, indent);
   os << indent << "DEMHandler" << std::endl;
+  os << indent << "Number of SRTM tiles: " << m_TileCache.GetNumberOfTiles()
+     << (m_UseTileCache ? "" : " (not used)") << std::endl;
+  os << indent << "SRTM tiles in memory: " << m_TileCache.GetNumberOfLoadedTiles()
+     << " (maximum memory: " << m_TileCache.GetMaximumMemory() << " MB)" << std::endl;
 }
 
 } // namespace otb
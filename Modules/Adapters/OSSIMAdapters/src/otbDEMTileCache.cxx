@@ -0,0 +1,511 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbDEMTileCache.h"
+#include "otbMacro.h"
+#include "itkDirectory.h"
+#include "itkMutexLockHolder.h"
+#include "itksys/SystemTools.hxx"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+
+namespace otb
+{
+
+namespace
+{
+const int NumberOfLonCells = 360;
+const int NumberOfLatCells = 180;
+
+/** SRTM no-data value */
+const short NoDataPost = -32768;
+
+/** Default memory budget of the decoded tiles, in MB */
+const unsigned int DefaultMaximumMemory = 256;
+
+inline int CellId(int lonIndex, int latIndex)
+{
+  return latIndex * NumberOfLonCells + lonIndex;
+}
+
+/** Decode a SRTM tile name (N43E001.hgt). Returns false if the name does
+ * not match. lon and lat are the coordinates of the south-west corner. */
+bool ParseTileName(const std::string & filename, int & lon, int & lat)
+{
+  if (filename.size() != 11)
+    {
+    return false;
+    }
+  std::string name = itksys::SystemTools::LowerCase(filename);
+  if (name.compare(7, 4, ".hgt") != 0 ||
+      (name[0] != 'n' && name[0] != 's') ||
+      (name[3] != 'e' && name[3] != 'w'))
+    {
+    return false;
+    }
+  for (unsigned int i : {1, 2, 4, 5, 6})
+    {
+    if (!std::isdigit(static_cast<unsigned char>(name[i])))
+      {
+      return false;
+      }
+    }
+  lat = std::atoi(name.substr(1, 2).c_str());
+  lon = std::atoi(name.substr(4, 3).c_str());
+  if (name[0] == 's')
+    {
+    lat = -lat;
+    }
+  if (name[3] == 'w')
+    {
+    lon = -lon;
+    }
+  return lat >= -90 && lat < 90 && lon >= -180 && lon < 180;
+}
+}
+
+DEMTileCache::DEMTileCache()
+  : m_Slots(new std::atomic<const Tile*>[NumberOfLonCells * NumberOfLatCells]),
+    m_Epoch(0),
+    m_LoadCounter(0),
+    m_LoadedBytes(0),
+    m_MaximumBytes(static_cast<std::size_t>(DefaultMaximumMemory) << 20)
+{
+  m_Readers[0].store(0);
+  m_Readers[1].store(0);
+  m_NoTile.Id = -1;
+  m_NoTile.LastUse.store(0);
+  m_NoTile.Size = 0;
+  for (int i = 0; i < NumberOfLonCells * NumberOfLatCells; ++i)
+    {
+    m_Slots[i].store(&m_NoTile);
+    }
+}
+
+DEMTileCache::~DEMTileCache()
+{
+}
+
+unsigned int
+DEMTileCache::AddDirectory(const std::string & directory)
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+
+  itk::Directory::Pointer dir = itk::Directory::New();
+  if (!dir->Load(directory.c_str()))
+    {
+    return 0;
+    }
+
+  unsigned int count = 0;
+  for (unsigned int i = 0; i < dir->GetNumberOfFiles(); ++i)
+    {
+    std::string filename(dir->GetFile(i));
+    int lon = 0;
+    int lat = 0;
+    if (!ParseTileName(filename, lon, lat))
+      {
+      continue;
+      }
+    const int id = CellId(lon + 180, lat + 90);
+    // As in OSSIM, the first directory providing a tile has priority
+    if (m_Files.count(id) == 0)
+      {
+      m_Files[id] = directory + "/" + filename;
+      m_Slots[id].store(nullptr);
+      }
+    ++count;
+    }
+  otbLogMacro(Debug, << count << " SRTM tiles indexed in " << directory);
+  return count;
+}
+
+void
+DEMTileCache::SetGeoidFunction(const GeoidFunctionType & geoid)
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+  m_Geoid = geoid;
+  this->ReleaseTiles();
+}
+
+void
+DEMTileCache::Clear()
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+  for (const auto & file : m_Files)
+    {
+    m_Slots[file.first].store(&m_NoTile);
+    }
+  m_Files.clear();
+  m_Tiles.clear();
+  m_RetiredTiles[0].clear();
+  m_RetiredTiles[1].clear();
+  m_LoadedBytes = 0;
+}
+
+unsigned int
+DEMTileCache::GetNumberOfTiles() const
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+  return m_Files.size();
+}
+
+void
+DEMTileCache::SetMaximumMemory(unsigned int megabytes)
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+  m_MaximumBytes = static_cast<std::size_t>(megabytes) << 20;
+  this->MakeRoom(0);
+  this->ReclaimTiles();
+}
+
+unsigned int
+DEMTileCache::GetMaximumMemory() const
+{
+  return static_cast<unsigned int>(m_MaximumBytes >> 20);
+}
+
+unsigned int
+DEMTileCache::GetNumberOfLoadedTiles() const
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+  return m_Tiles.size();
+}
+
+void
+DEMTileCache::ReleaseTiles()
+{
+  for (const auto & file : m_Files)
+    {
+    m_Slots[file.first].store(nullptr);
+    }
+  m_Tiles.clear();
+  m_RetiredTiles[0].clear();
+  m_RetiredTiles[1].clear();
+  m_LoadedBytes = 0;
+}
+
+unsigned int
+DEMTileCache::BeginRead() const
+{
+  // The epoch is read again after the registration: a query registered
+  // in an epoch that is already over would not be waited for
+  for (;;)
+    {
+    const unsigned int epoch = m_Epoch.load();
+    m_Readers[epoch & 1].fetch_add(1);
+    if (m_Epoch.load() == epoch)
+      {
+      return epoch;
+      }
+    m_Readers[epoch & 1].fetch_sub(1);
+    }
+}
+
+void
+DEMTileCache::EndRead(unsigned int epoch) const
+{
+  m_Readers[epoch & 1].fetch_sub(1);
+}
+
+void
+DEMTileCache::MakeRoom(std::size_t bytes) const
+{
+  while (!m_Tiles.empty() && m_LoadedBytes + bytes > m_MaximumBytes)
+    {
+    auto oldest = m_Tiles.begin();
+    for (auto it = m_Tiles.begin(); it != m_Tiles.end(); ++it)
+      {
+      if ((*it)->LastUse.load(std::memory_order_relaxed) < (*oldest)->LastUse.load(std::memory_order_relaxed))
+        {
+        oldest = it;
+        }
+      }
+    // Queries started from now on load the tile again
+    m_Slots[(*oldest)->Id].store(nullptr);
+    m_LoadedBytes -= (*oldest)->Posts.size() * sizeof(short);
+    otbLogMacro(Debug, << "DEM tile of cell " << (*oldest)->Id << " released");
+    m_RetiredTiles[m_Epoch.load() & 1].push_back(std::move(*oldest));
+    *oldest = std::move(m_Tiles.back());
+    m_Tiles.pop_back();
+    }
+}
+
+void
+DEMTileCache::ReclaimTiles() const
+{
+  // Tiles unlinked during the previous epoch can only be read by the
+  // queries of that epoch. Once they are over, these tiles are freed and
+  // the next epoch starts (it reuses the counter of the previous one).
+  const unsigned int epoch = m_Epoch.load();
+  const unsigned int previous = (epoch + 1) & 1;
+  if (m_Readers[previous].load() == 0)
+    {
+    m_RetiredTiles[previous].clear();
+    m_Epoch.store(epoch + 1);
+    }
+}
+
+const DEMTileCache::Tile*
+DEMTileCache::GetTile(int lonIndex, int latIndex) const
+{
+  if (lonIndex < 0 || lonIndex >= NumberOfLonCells || latIndex < 0 || latIndex >= NumberOfLatCells)
+    {
+    return nullptr;
+    }
+  const int id = CellId(lonIndex, latIndex);
+  const Tile* tile = m_Slots[id].load(std::memory_order_acquire);
+  if (tile == nullptr)
+    {
+    itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+    // Another thread may have loaded the tile while we were waiting
+    tile = m_Slots[id].load(std::memory_order_acquire);
+    if (tile == nullptr)
+      {
+      Tile* newTile = this->LoadTile(m_Files.at(id), lonIndex - 180, latIndex - 90);
+      if (newTile)
+        {
+        const std::size_t bytes = newTile->Posts.size() * sizeof(short);
+        this->ReclaimTiles();
+        this->MakeRoom(bytes);
+        newTile->Id = id;
+        newTile->LastUse.store(m_LoadCounter.fetch_add(1) + 1, std::memory_order_relaxed);
+        m_Tiles.emplace_back(newTile);
+        m_LoadedBytes += bytes;
+        tile = newTile;
+        }
+      else
+        {
+        tile = &m_NoTile;
+        }
+      m_Slots[id].store(tile, std::memory_order_release);
+      }
+    }
+  if (tile == &m_NoTile)
+    {
+    return nullptr;
+    }
+  // Only written when a tile was loaded since the last read, so that
+  // concurrent queries of the same tile do not share a written cache line
+  const unsigned long counter = m_LoadCounter.load(std::memory_order_relaxed);
+  if (tile->LastUse.load(std::memory_order_relaxed) != counter)
+    {
+    tile->LastUse.store(counter, std::memory_order_relaxed);
+    }
+  return tile;
+}
+
+DEMTileCache::Tile*
+DEMTileCache::LoadTile(const std::string & filename, int lon, int lat) const
+{
+  std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!file)
+    {
+    otbLogMacro(Warning, << "Can not open DEM tile " << filename);
+    return nullptr;
+    }
+  file.seekg(0, std::ios::end);
+  const std::streamoff length = file.tellg();
+  file.seekg(0, std::ios::beg);
+
+  // SRTM tiles are square grids of 16 bits posts: 1201x1201 (3") or 3601x3601 (1")
+  const unsigned int size = static_cast<unsigned int>(std::sqrt(static_cast<double>(length / 2)) + 0.5);
+  if (size < 2 || static_cast<std::streamoff>(size) * size * 2 != length)
+    {
+    otbLogMacro(Warning, << "Invalid SRTM tile size for " << filename);
+    return nullptr;
+    }
+
+  std::unique_ptr<Tile> tile(new Tile);
+  tile->Size = size;
+  tile->Posts.resize(size * size);
+
+  std::vector<unsigned char> buffer(length);
+  file.read(reinterpret_cast<char*>(buffer.data()), length);
+  if (!file)
+    {
+    otbLogMacro(Warning, << "Failed to read DEM tile " << filename);
+    return nullptr;
+    }
+  // Posts are big endian
+  for (unsigned int i = 0; i < size * size; ++i)
+    {
+    tile->Posts[i] = static_cast<short>((buffer[2 * i] << 8) | buffer[2 * i + 1]);
+    }
+
+  for (unsigned int j = 0; j < GeoidSamples; ++j)
+    {
+    for (unsigned int i = 0; i < GeoidSamples; ++i)
+      {
+      double offset = 0.;
+      if (m_Geoid)
+        {
+        offset = m_Geoid(lon + static_cast<double>(i) / (GeoidSamples - 1),
+                         lat + static_cast<double>(j) / (GeoidSamples - 1));
+        if (std::isnan(offset))
+          {
+          offset = 0.;
+          }
+        }
+      tile->Geoid[j][i] = offset;
+      }
+    }
+
+  otbLogMacro(Debug, << "DEM tile " << filename << " loaded (" << size << "x" << size << " posts)");
+  return tile.release();
+}
+
+bool
+DEMTileCache::Interpolate(double lon, double lat, double & height, double & offset, bool withGeoid) const
+{
+  // Also rejects NaN coordinates
+  if (!(lon >= -180. && lon < 180. && lat >= -90. && lat < 90.))
+    {
+    return false;
+    }
+  const double lonFloor = std::floor(lon);
+  const double latFloor = std::floor(lat);
+  const Tile* tile = this->GetTile(static_cast<int>(lonFloor) + 180, static_cast<int>(latFloor) + 90);
+  if (tile == nullptr)
+    {
+    return false;
+    }
+
+  // Post coordinates, from the south-west corner
+  const unsigned int last = tile->Size - 1;
+  const double xi = (lon - lonFloor) * last;
+  const double yi = (lat - latFloor) * last;
+  unsigned int x0 = static_cast<unsigned int>(xi);
+  unsigned int y0 = static_cast<unsigned int>(yi);
+  if (x0 >= last)
+    {
+    x0 = last - 1;
+    }
+  if (y0 >= last)
+    {
+    y0 = last - 1;
+    }
+  const double xt = xi - x0;
+  const double yt = yi - y0;
+
+  // Rows are stored from the north
+  const short* row0 = &tile->Posts[(last - y0) * tile->Size + x0];
+  const short* row1 = row0 - tile->Size;
+  const short p00 = row0[0];
+  const short p01 = row0[1];
+  const short p10 = row1[0];
+  const short p11 = row1[1];
+
+  // No-data posts are ignored
+  const double w00 = p00 == NoDataPost ? 0. : (1. - xt) * (1. - yt);
+  const double w01 = p01 == NoDataPost ? 0. : xt * (1. - yt);
+  const double w10 = p10 == NoDataPost ? 0. : (1. - xt) * yt;
+  const double w11 = p11 == NoDataPost ? 0. : xt * yt;
+  const double sumWeights = w00 + w01 + w10 + w11;
+  if (sumWeights == 0.)
+    {
+    return false;
+    }
+  height = (p00 * w00 + p01 * w01 + p10 * w10 + p11 * w11) / sumWeights;
+
+  offset = 0.;
+  if (withGeoid)
+    {
+    const double gx = (lon - lonFloor) * (GeoidSamples - 1);
+    const double gy = (lat - latFloor) * (GeoidSamples - 1);
+    unsigned int gx0 = std::min(static_cast<unsigned int>(gx), GeoidSamples - 2);
+    unsigned int gy0 = std::min(static_cast<unsigned int>(gy), GeoidSamples - 2);
+    const double gxt = gx - gx0;
+    const double gyt = gy - gy0;
+    offset = (1. - gyt) * ((1. - gxt) * tile->Geoid[gy0][gx0] + gxt * tile->Geoid[gy0][gx0 + 1])
+      + gyt * ((1. - gxt) * tile->Geoid[gy0 + 1][gx0] + gxt * tile->Geoid[gy0 + 1][gx0 + 1]);
+    }
+  return true;
+}
+
+bool
+DEMTileCache::GetHeightAboveMSL(double lon, double lat, double & height) const
+{
+  double offset;
+  const unsigned int epoch = this->BeginRead();
+  const bool found = this->Interpolate(lon, lat, height, offset, false);
+  this->EndRead(epoch);
+  return found;
+}
+
+bool
+DEMTileCache::GetHeightAboveEllipsoid(double lon, double lat, double & height) const
+{
+  double offset;
+  const unsigned int epoch = this->BeginRead();
+  const bool found = this->Interpolate(lon, lat, height, offset, true);
+  this->EndRead(epoch);
+  if (!found)
+    {
+    return false;
+    }
+  height += offset;
+  return true;
+}
+
+std::size_t
+DEMTileCache::InterpolateBatch(const double* lon, const double* lat, std::size_t stride,
+                               std::size_t count, double* heights, bool withGeoid) const
+{
+  std::size_t missing = 0;
+  // A single registration for the whole batch
+  const unsigned int epoch = this->BeginRead();
+  for (std::size_t i = 0; i < count; ++i)
+    {
+    double height, offset;
+    if (this->Interpolate(lon[i * stride], lat[i * stride], height, offset, withGeoid))
+      {
+      heights[i] = height + offset;
+      }
+    else
+      {
+      heights[i] = std::numeric_limits<double>::quiet_NaN();
+      ++missing;
+      }
+    }
+  this->EndRead(epoch);
+  return missing;
+}
+
+std::size_t
+DEMTileCache::GetHeightAboveMSL(const double* lon, const double* lat, std::size_t stride,
+                                std::size_t count, double* heights) const
+{
+  return this->InterpolateBatch(lon, lat, stride, count, heights, false);
+}
+
+std::size_t
+DEMTileCache::GetHeightAboveEllipsoid(const double* lon, const double* lat, std::size_t stride,
+                                      std::size_t count, double* heights) const
+{
+  return this->InterpolateBatch(lon, lat, stride, count, heights, true);
+}
+
+} // namespace otb
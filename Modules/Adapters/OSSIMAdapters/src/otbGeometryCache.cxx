@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbGeometryCache.h"
+#include "otbConfigurationManager.h"
+#include "otbMacro.h"
+#include "itkDirectory.h"
+#include "itkMutexLock.h"
+#include "itkMutexLockHolder.h"
+#include "itksys/SystemTools.hxx"
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#pragma GCC diagnostic ignored "-Woverloaded-virtual"
+#pragma GCC diagnostic ignored "-Wshadow"
+#include "ossim/base/ossimKeywordlist.h"
+#pragma GCC diagnostic pop
+#else
+#include "ossim/base/ossimKeywordlist.h"
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <iomanip>
+#include <map>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace otb
+{
+
+namespace
+{
+/** 64 bits FNV-1a hash, as an hexadecimal string */
+std::string Hash(const std::string & data)
+{
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : data)
+    {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+    }
+  std::ostringstream oss;
+  oss << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return oss.str();
+}
+
+std::string EntryPath(const std::string & key)
+{
+  return ConfigurationManager::GetGeometryCacheDirectory() + "/" + key + ".geom";
+}
+
+/** Names, sizes and modification times of the files of a directory,
+ * with the modification time of the directory when they were listed */
+struct DirectoryListing
+{
+  long        ModifiedTime;
+  std::time_t ScanTime;
+  std::string Description;
+};
+
+itk::SimpleMutexLock                     listingsMutex;
+std::map<std::string, DirectoryListing> listings;
+
+/** Describe the files of a directory. The listing is done again only
+ * when the modification time of the directory changes, that is when a
+ * file is added, removed or replaced. Listings made less than two
+ * seconds after the last directory change are not reused: a later
+ * change in the same second would not change the modification time. */
+std::string DescribeDirectory(const std::string & directory)
+{
+  const long modifiedTime = itksys::SystemTools::ModifiedTime(directory);
+  {
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(listingsMutex);
+  auto it = listings.find(directory);
+  if (it != listings.end() && it->second.ModifiedTime == modifiedTime
+      && it->second.ScanTime > modifiedTime + 1)
+    {
+    return it->second.Description;
+    }
+  }
+
+  DirectoryListing listing;
+  listing.ModifiedTime = modifiedTime;
+  listing.ScanTime = std::time(nullptr);
+
+  std::vector<std::string> names;
+  itk::Directory::Pointer dir = itk::Directory::New();
+  if (dir->Load(directory.c_str()))
+    {
+    for (unsigned int i = 0; i < dir->GetNumberOfFiles(); ++i)
+      {
+      names.push_back(dir->GetFile(i));
+      }
+    }
+  std::sort(names.begin(), names.end());
+  std::ostringstream description;
+  for (const std::string & name : names)
+    {
+    const std::string file = directory + "/" + name;
+    if (itksys::SystemTools::FileIsDirectory(file))
+      {
+      continue;
+      }
+    description << name << " " << itksys::SystemTools::FileLength(file)
+                << " " << itksys::SystemTools::ModifiedTime(file) << "\n";
+    }
+  listing.Description = description.str();
+  otbLogMacro(Debug, << "Listed " << names.size() << " entries of " << directory << " for the geometry cache");
+
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(listingsMutex);
+  listings[directory] = listing;
+  return listing.Description;
+}
+}
+
+bool
+GeometryCache::IsEnabled()
+{
+  return !ConfigurationManager::GetGeometryCacheDirectory().empty();
+}
+
+std::string
+GeometryCache::ComputeProductKey(const std::string & filename, const std::string & options)
+{
+  if (!itksys::SystemTools::FileExists(filename, true))
+    {
+    return std::string();
+    }
+  const std::string path = itksys::SystemTools::CollapseFullPath(filename);
+  const std::string directory = itksys::SystemTools::GetFilenamePath(path);
+
+  std::ostringstream description;
+  description << path << "\n" << options << "\n"
+              << itksys::SystemTools::FileLength(path) << " " << itksys::SystemTools::ModifiedTime(path) << "\n";
+
+  // Product metadata are stored in the files next to the image
+  description << DescribeDirectory(directory);
+  return "product-" + Hash(description.str());
+}
+
+std::string
+GeometryCache::ComputeKey(const std::string & description)
+{
+  return Hash(description);
+}
+
+std::string
+GeometryCache::Serialize(const ImageKeywordlist & kwl)
+{
+  std::ostringstream oss;
+  for (const auto & keyword : kwl.GetKeywordlist())
+    {
+    oss << keyword.first << ": " << keyword.second << "\n";
+    }
+  return oss.str();
+}
+
+bool
+GeometryCache::Load(const std::string & key, ImageKeywordlist & kwl)
+{
+  if (!IsEnabled() || key.empty())
+    {
+    return false;
+    }
+  const std::string path = EntryPath(key);
+  if (!itksys::SystemTools::FileExists(path, true))
+    {
+    return false;
+    }
+  kwl = ReadGeometryFromGEOMFile(path);
+  return !kwl.Empty();
+}
+
+void
+GeometryCache::Store(const std::string & key, const ImageKeywordlist & kwl)
+{
+  if (!IsEnabled() || key.empty() || kwl.Empty())
+    {
+    return;
+    }
+  const std::string directory = ConfigurationManager::GetGeometryCacheDirectory();
+  if (!itksys::SystemTools::MakeDirectory(directory))
+    {
+    otbLogMacro(Warning, << "Can not create the geometry cache directory " << directory);
+    return;
+    }
+
+  ossimKeywordlist geom_kwl;
+  kwl.convertToOSSIMKeywordlist(geom_kwl);
+
+  // Write a temporary file, then rename it, so that a concurrent process
+  // never reads a partial entry
+  const std::string path = EntryPath(key);
+  std::random_device random;
+  const std::string temporaryPath = path + "." + std::to_string(random()) + ".tmp";
+  if (!geom_kwl.write(temporaryPath.c_str()) || std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+    {
+    std::remove(temporaryPath.c_str());
+    otbLogMacro(Warning, << "Can not write the geometry cache entry " << path);
+    return;
+    }
+  otbLogMacro(Debug, << "Geometry stored in cache entry " << path);
+}
+
+} // namespace otb
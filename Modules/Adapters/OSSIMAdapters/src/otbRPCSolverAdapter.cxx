@@ -23,78 +23,186 @@
 #include "otbImageKeywordlist.h"
 #include "otbMacro.h"
 
+#include "itkMultiThreader.h"
+#include "itkNumericTraits.h"
+#include "vnl/vnl_matrix.h"
+#include "vnl/vnl_vector.h"
+#include "vnl/algo/vnl_svd.h"
+
+#include <algorithm>
+#include <cmath>
+
 #if defined(__GNUC__) || defined(__clang__)
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 #pragma GCC diagnostic ignored "-Woverloaded-virtual"
 #pragma GCC diagnostic ignored "-Wshadow"
+#include "ossim/projection/ossimRpcModel.h"
 #include "ossim/projection/ossimRpcSolver.h"
-#include "ossim/projection/ossimProjection.h"
 #include "ossim/projection/ossimRpcProjection.h"
 #include "ossim/imaging/ossimImageGeometry.h"
+#include "ossim/base/ossimKeywordlist.h"
 #pragma GCC diagnostic pop
 #else
+#include "ossim/projection/ossimRpcModel.h"
 #include "ossim/projection/ossimRpcSolver.h"
-#include "ossim/projection/ossimProjection.h"
 #include "ossim/projection/ossimRpcProjection.h"
 #include "ossim/imaging/ossimImageGeometry.h"
+#include "ossim/base/ossimKeywordlist.h"
 #endif
 
 
 namespace otb
 {
 
-void
-RPCSolverAdapter::Solve(const GCPsContainerType& gcpContainer,
-                        double& rmsError,
-                        ImageKeywordlist& otb_kwl)
+namespace
 {
-  // TODO: for now, this is a simple transfer of what was done in the
-  // GCPsToRPCSensorModelImageFilter. We might find some way to improve that.
 
-  // The vector where geo and sensor points are stored
-  std::vector<ossimDpt> sensorPoints;
-  std::vector<ossimGpt> geoPoints;
+/** Number of terms of a RPC polynomial */
+const unsigned int NumberOfRPCTerms = 20;
 
-  // Temporary points variable
-  ossimDpt sensorPoint;
-  ossimGpt geoPoint;
+/** Terms of the RPC00B polynomial which do not depend on the elevation */
+const unsigned int PlanimetricRPCTerms[] = {0, 1, 2, 4, 7, 8, 11, 12, 14, 15};
 
-  // Retrieve the additional GCPs
-  GCPsContainerType::const_iterator gcpIt;
-  for (gcpIt = gcpContainer.begin(); gcpIt != gcpContainer.end(); ++gcpIt)
-    {
-    // Check if point is inside bounds
-    // Fill sensor point
-    sensorPoint = ossimDpt( internal::ConvertToOSSIMFrame(gcpIt->first[0]),
-                            internal::ConvertToOSSIMFrame(gcpIt->first[1]));
+/** Minimum number of GCPs processed by a thread */
+const unsigned int MinimumGCPsPerThread = 256;
+
+/** Minimum number of GCPs for the parallel solver. Smaller sets would
+ *  be assembled by a single thread anyway: they are still solved by
+ *  ossimRpcSolver, so that the models estimated from them do not change. */
+const unsigned int MinimumGCPsForParallelSolver = 2 * MinimumGCPsPerThread;
+
+/** Compute the terms of the RPC00B polynomial at normalized (lon, lat, h) */
+void ComputeRPCTerms(double l, double p, double h, double * terms)
+{
+  terms[0] = 1.;
+  terms[1] = l;
+  terms[2] = p;
+  terms[3] = h;
+  terms[4] = l * p;
+  terms[5] = l * h;
+  terms[6] = p * h;
+  terms[7] = l * l;
+  terms[8] = p * p;
+  terms[9] = h * h;
+  terms[10] = p * l * h;
+  terms[11] = l * l * l;
+  terms[12] = l * p * p;
+  terms[13] = l * h * h;
+  terms[14] = l * l * p;
+  terms[15] = p * p * p;
+  terms[16] = p * h * h;
+  terms[17] = l * l * h;
+  terms[18] = p * p * h;
+  terms[19] = h * h * h;
+}
 
-    // Fill geo point (lat, lon, elev)
-    geoPoint =  ossimGpt(gcpIt->second[1], gcpIt->second[0], gcpIt->second[2]);
+/** Least squares problem of one image coordinate: the unknowns are the
+ *  numerator coefficients followed by the denominator coefficients
+ *  (the constant term of the denominator is 1). The rows are
+ *  [t, -r t'] with right hand side r, where t are the active terms, t'
+ *  the active terms without the constant one and r the normalized
+ *  image coordinate. */
+struct NormalEquations
+{
+  vnl_matrix<double> Matrix;
+  vnl_vector<double> Vector;
+};
+
+/** Data shared by the threads assembling the normal equations */
+struct AssemblyStruct
+{
+  unsigned int                        NumberOfTerms;
+  unsigned int                        NumberOfGCPs;
+  const std::vector<double> *         Terms;
+  const std::vector<double> *         Targets[2];
+  const std::vector<double> *         Weights[2];
+  std::vector<NormalEquations>        Partial[2];
+};
+
+ITK_THREAD_RETURN_TYPE AssemblyCallback(void * arg)
+{
+  itk::MultiThreader::ThreadInfoStruct * info = static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+  AssemblyStruct * str = static_cast<AssemblyStruct *>(info->UserData);
+
+  const unsigned int n = str->NumberOfTerms;
+  const unsigned int m = 2 * n - 1;
+  const unsigned int start = static_cast<unsigned int>(
+    static_cast<unsigned long>(str->NumberOfGCPs) * info->ThreadID / info->NumberOfThreads);
+  const unsigned int stop = static_cast<unsigned int>(
+    static_cast<unsigned long>(str->NumberOfGCPs) * (info->ThreadID + 1) / info->NumberOfThreads);
+
+  std::vector<double> row(m);
+  for (unsigned int coord = 0; coord < 2; ++coord)
+    {
+    NormalEquations & equations = str->Partial[coord][info->ThreadID];
+    equations.Matrix.set_size(m, m);
+    equations.Matrix.fill(0.);
+    equations.Vector.set_size(m);
+    equations.Vector.fill(0.);
 
-    // Add the sensor point to the list
-    sensorPoints.push_back(sensorPoint);
+    for (unsigned int i = start; i < stop; ++i)
+      {
+      const double * terms = &(*str->Terms)[i * n];
+      const double r = (*str->Targets[coord])[i];
+      const double w = (*str->Weights[coord])[i];
+      for (unsigned int k = 0; k < n; ++k)
+        {
+        row[k] = terms[k];
+        }
+      for (unsigned int k = 1; k < n; ++k)
+        {
+        row[n + k - 1] = -r * terms[k];
+        }
 
-    // Add the geo point to the list
-    geoPoints.push_back(geoPoint);
+      // Upper triangle only, the matrix is symmetric
+      for (unsigned int a = 0; a < m; ++a)
+        {
+        const double wa = w * row[a];
+        double * matrixRow = equations.Matrix[a];
+        for (unsigned int b = a; b < m; ++b)
+          {
+          matrixRow[b] += wa * row[b];
+          }
+        equations.Vector[a] += wa * r;
+        }
+      }
     }
 
-  // Check for enough points
-  if(sensorPoints.size() < 20)
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+/** Normalization of a coordinate to [-1, 1] */
+void ComputeNormalization(const std::vector<double> & values, double & offset, double & scale)
+{
+  const auto bounds = std::minmax_element(values.begin(), values.end());
+  offset = 0.5 * (*bounds.first + *bounds.second);
+  scale = 0.5 * (*bounds.second - *bounds.first);
+  if (scale == 0.)
     {
-    itkGenericExceptionMacro(<<"At least 20 points are required to estimate the 40 parameters of a RPC model without elevation support, and 40 are required to estimate the 80 parameters of a RPC model with elevation support. Only "<<sensorPoints.size()<<" points were given.");
+    scale = 1.;
     }
+}
 
-  // By default, use elevation provided with ground control points
-  bool useElevation = true;
+/** Estimate the RPC model with ossimRpcSolver */
+void SolveWithOSSIM(const RPCSolverAdapter::GCPsContainerType& gcpContainer,
+                    bool useElevation,
+                    double& rmsError,
+                    ossimKeywordlist& geom_kwl)
+{
+  // The vector where geo and sensor points are stored
+  std::vector<ossimDpt> sensorPoints;
+  std::vector<ossimGpt> geoPoints;
+  sensorPoints.reserve(gcpContainer.size());
+  geoPoints.reserve(gcpContainer.size());
 
-  // If not enough points are given for a proper estimation of RPC
-  // with elevation support, disable elevation. This will result in
-  // all coefficients related to elevation set to zero.
-  if(sensorPoints.size()<40)
+  for (const auto & gcp : gcpContainer)
     {
-    otbGenericWarningMacro("Only "<<sensorPoints.size()<<" ground control points are provided, can not estimate a RPC model with elevation support (at least 40 points required). Elevation support will be disabled for RPC estimation. All coefficients related to elevation will be set to zero, and elevation will have no effect on the resulting transform.");
-    useElevation = false;
+    sensorPoints.push_back(ossimDpt(internal::ConvertToOSSIMFrame(gcp.first[0]),
+                                    internal::ConvertToOSSIMFrame(gcp.first[1])));
+
+    // Geo point (lat, lon, elev)
+    geoPoints.push_back(ossimGpt(gcp.second[1], gcp.second[0], gcp.second[2]));
     }
 
   // Build the ossim rpc solver
@@ -113,8 +221,300 @@ RPCSolverAdapter::Solve(const GCPsContainerType& gcpContainer,
 #endif
 
   // Export the sensor model in an ossimKeywordlist
-  ossimKeywordlist geom_kwl;
   rpcProjection->saveState(geom_kwl);
+}
+
+/** Estimate the RPC model by iteratively reweighted least squares,
+ *  assembling the normal equations in parallel. Returns false if the
+ *  estimation failed. */
+bool SolveInParallel(const RPCSolverAdapter::GCPsContainerType& gcpContainer,
+                     bool useElevation,
+                     double& rmsError,
+                     ossimKeywordlist& geom_kwl)
+{
+  const unsigned int nbGCPs = gcpContainer.size();
+
+  // Sensor points in the OSSIM frame, geo points as (lon, lat, h)
+  std::vector<double> samples(nbGCPs), lines(nbGCPs), lons(nbGCPs), lats(nbGCPs), heights(nbGCPs);
+  for (unsigned int i = 0; i < nbGCPs; ++i)
+    {
+    samples[i] = internal::ConvertToOSSIMFrame(gcpContainer[i].first[0]);
+    lines[i] = internal::ConvertToOSSIMFrame(gcpContainer[i].first[1]);
+    lons[i] = gcpContainer[i].second[0];
+    lats[i] = gcpContainer[i].second[1];
+    heights[i] = gcpContainer[i].second[2];
+    }
+
+  double sampOffset, sampScale, lineOffset, lineScale;
+  double lonOffset, lonScale, latOffset, latScale, heightOffset, heightScale;
+  ComputeNormalization(samples, sampOffset, sampScale);
+  ComputeNormalization(lines, lineOffset, lineScale);
+  ComputeNormalization(lons, lonOffset, lonScale);
+  ComputeNormalization(lats, latOffset, latScale);
+  ComputeNormalization(heights, heightOffset, heightScale);
+
+  // Active terms of the polynomials
+  std::vector<unsigned int> activeTerms;
+  if (useElevation)
+    {
+    for (unsigned int k = 0; k < NumberOfRPCTerms; ++k)
+      {
+      activeTerms.push_back(k);
+      }
+    }
+  else
+    {
+    activeTerms.assign(std::begin(PlanimetricRPCTerms), std::end(PlanimetricRPCTerms));
+    }
+  const unsigned int n = activeTerms.size();
+  const unsigned int m = 2 * n - 1;
+
+  // The terms and the targets do not change across the iterations
+  std::vector<double> terms(nbGCPs * n);
+  std::vector<double> targets[2] = {std::vector<double>(nbGCPs), std::vector<double>(nbGCPs)};
+  double allTerms[NumberOfRPCTerms];
+  for (unsigned int i = 0; i < nbGCPs; ++i)
+    {
+    ComputeRPCTerms((lons[i] - lonOffset) / lonScale,
+                    (lats[i] - latOffset) / latScale,
+                    (heights[i] - heightOffset) / heightScale, allTerms);
+    for (unsigned int k = 0; k < n; ++k)
+      {
+      terms[i * n + k] = allTerms[activeTerms[k]];
+      }
+    targets[0][i] = (samples[i] - sampOffset) / sampScale;
+    targets[1][i] = (lines[i] - lineOffset) / lineScale;
+    }
+
+  // The normal equations are assembled by blocks of GCPs in parallel
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  const unsigned int nbThreads = std::max(1u, std::min<unsigned int>(
+    threader->GetNumberOfThreads(), nbGCPs / MinimumGCPsPerThread));
+  threader->SetNumberOfThreads(nbThreads);
+
+  std::vector<double> weights[2] = {std::vector<double>(nbGCPs, 1.), std::vector<double>(nbGCPs, 1.)};
+  AssemblyStruct str;
+  str.NumberOfTerms = n;
+  str.NumberOfGCPs = nbGCPs;
+  str.Terms = &terms;
+  for (unsigned int coord = 0; coord < 2; ++coord)
+    {
+    str.Targets[coord] = &targets[coord];
+    str.Weights[coord] = &weights[coord];
+    str.Partial[coord].resize(threader->GetNumberOfThreads());
+    }
+  threader->SetSingleMethod(AssemblyCallback, &str);
+
+  // Iteratively reweighted least squares: the linearized residual
+  // N - r D is weighted by 1 / D^2 using the denominator of the
+  // previous iteration, so that it approaches the image residual
+  const unsigned int maxIterations = 10;
+  std::vector<double> coefficients[2] = {std::vector<double>(m, 0.), std::vector<double>(m, 0.)};
+  std::vector<double> denominators[2] = {std::vector<double>(nbGCPs), std::vector<double>(nbGCPs)};
+  std::vector<double> bestCoefficients[2];
+  double bestRMS = itk::NumericTraits<double>::max();
+
+  for (unsigned int iteration = 0; iteration < maxIterations; ++iteration)
+    {
+    threader->SingleMethodExecute();
+
+    double squaredError = 0.;
+    for (unsigned int coord = 0; coord < 2; ++coord)
+      {
+      NormalEquations equations = str.Partial[coord][0];
+      for (unsigned int t = 1; t < str.Partial[coord].size(); ++t)
+        {
+        equations.Matrix += str.Partial[coord][t].Matrix;
+        equations.Vector += str.Partial[coord][t].Vector;
+        }
+      for (unsigned int a = 0; a < m; ++a)
+        {
+        for (unsigned int b = 0; b < a; ++b)
+          {
+          equations.Matrix[a][b] = equations.Matrix[b][a];
+          }
+        }
+
+      // The normal equations of RPC models are badly conditioned: use a
+      // truncated pseudo-inverse
+      vnl_svd<double> svd(equations.Matrix);
+      svd.zero_out_relative(1e-15);
+      const vnl_vector<double> solution = svd.solve(equations.Vector);
+      std::copy(solution.begin(), solution.end(), coefficients[coord].begin());
+
+      // Image residuals
+      const double scale = coord == 0 ? sampScale : lineScale;
+      for (unsigned int i = 0; i < nbGCPs; ++i)
+        {
+        const double * t = &terms[i * n];
+        double numerator = 0.;
+        double denominator = 1.;
+        for (unsigned int k = 0; k < n; ++k)
+          {
+          numerator += coefficients[coord][k] * t[k];
+          }
+        for (unsigned int k = 1; k < n; ++k)
+          {
+          denominator += coefficients[coord][n + k - 1] * t[k];
+          }
+        denominators[coord][i] = denominator;
+        const double residual = (numerator / denominator - targets[coord][i]) * scale;
+        squaredError += residual * residual;
+        }
+      }
+    const double rms = std::sqrt(squaredError / nbGCPs);
+    otbGenericMsgDebugMacro(<<"RPC estimation iteration "<<iteration<<": RMS error "<<rms);
+
+    // Stop when the reweighting does not improve the fit any more
+    if (!(rms < bestRMS * (1. - 1e-6)))
+      {
+      if (rms < bestRMS)
+        {
+        bestRMS = rms;
+        bestCoefficients[0] = coefficients[0];
+        bestCoefficients[1] = coefficients[1];
+        }
+      break;
+      }
+    bestRMS = rms;
+    bestCoefficients[0] = coefficients[0];
+    bestCoefficients[1] = coefficients[1];
+
+    for (unsigned int coord = 0; coord < 2; ++coord)
+      {
+      for (unsigned int i = 0; i < nbGCPs; ++i)
+        {
+        weights[coord][i] = 1. / (denominators[coord][i] * denominators[coord][i]);
+        }
+      }
+    }
+
+  if (bestCoefficients[0].empty())
+    {
+    return false;
+    }
+  for (unsigned int coord = 0; coord < 2; ++coord)
+    {
+    for (const double coefficient : bestCoefficients[coord])
+      {
+      if (!std::isfinite(coefficient))
+        {
+        return false;
+        }
+      }
+    }
+  rmsError = bestRMS;
+
+  // Full RPC00B coefficients
+  std::vector<double> numerators[2] = {std::vector<double>(NumberOfRPCTerms, 0.), std::vector<double>(NumberOfRPCTerms, 0.)};
+  std::vector<double> denominatorCoefficients[2] = {std::vector<double>(NumberOfRPCTerms, 0.), std::vector<double>(NumberOfRPCTerms, 0.)};
+  for (unsigned int coord = 0; coord < 2; ++coord)
+    {
+    denominatorCoefficients[coord][0] = 1.;
+    for (unsigned int k = 0; k < n; ++k)
+      {
+      numerators[coord][activeTerms[k]] = bestCoefficients[coord][k];
+      }
+    for (unsigned int k = 1; k < n; ++k)
+      {
+      denominatorCoefficients[coord][activeTerms[k]] = bestCoefficients[coord][n + k - 1];
+      }
+    }
+
+  // Build the RPC model
+  ossimRefPtr<ossimRpcModel> rpcModel = new ossimRpcModel;
+  rpcModel->setAttributes(sampOffset,
+                          lineOffset,
+                          sampScale,
+                          lineScale,
+                          latOffset,
+                          lonOffset,
+                          heightOffset,
+                          latScale,
+                          lonScale,
+                          heightScale,
+                          numerators[0],
+                          denominatorCoefficients[0],
+                          numerators[1],
+                          denominatorCoefficients[1]);
+  rpcModel->setPositionError(0.0, 0.0, true);
+
+  // The image rectangle is the bounding box of the GCPs
+  const auto sampBounds = std::minmax_element(samples.begin(), samples.end());
+  const auto lineBounds = std::minmax_element(lines.begin(), lines.end());
+  ossimDrect rectangle(*sampBounds.first, *lineBounds.first, *sampBounds.second, *lineBounds.second);
+  rpcModel->setImageRect(rectangle);
+  ossimDpt size;
+  size.line = rectangle.height();
+  size.samp = rectangle.width();
+  rpcModel->setImageSize(size);
+
+  // Compute 4 corners and reference point
+  rpcModel->updateModel();
+  ossimGpt ulGpt, urGpt, lrGpt, llGpt;
+  ossimGpt refGndPt;
+  rpcModel->lineSampleHeightToWorld(rectangle.ul(), heightOffset, ulGpt);
+  rpcModel->lineSampleHeightToWorld(rectangle.ur(), heightOffset, urGpt);
+  rpcModel->lineSampleHeightToWorld(rectangle.lr(), heightOffset, lrGpt);
+  rpcModel->lineSampleHeightToWorld(rectangle.ll(), heightOffset, llGpt);
+  rpcModel->setGroundRect(ulGpt, urGpt, lrGpt, llGpt);
+  rpcModel->lineSampleHeightToWorld(rectangle.midPoint(), heightOffset, refGndPt);
+  rpcModel->setRefGndPt(refGndPt);
+
+  // compute ground sampling distance
+  try
+    {
+    // Method can throw ossimException.
+    rpcModel->computeGsd();
+    }
+  catch (const ossimException& itkNotUsed(e))
+    {
+    otbMsgDevMacro(<< "OSSIM Compute ground sampling distance FAILED ! ");
+    }
+
+  // Export the sensor model in an ossimKeywordlist
+  rpcModel->saveState(geom_kwl);
+  return true;
+}
+
+} // end anonymous namespace
+
+void
+RPCSolverAdapter::Solve(const GCPsContainerType& gcpContainer,
+                        double& rmsError,
+                        ImageKeywordlist& otb_kwl)
+{
+  const unsigned int nbGCPs = gcpContainer.size();
+
+  // Check for enough points
+  if(nbGCPs < 20)
+    {
+    itkGenericExceptionMacro(<<"At least 20 points are required to estimate the 40 parameters of a RPC model without elevation support, and 40 are required to estimate the 80 parameters of a RPC model with elevation support. Only "<<nbGCPs<<" points were given.");
+    }
+
+  // By default, use elevation provided with ground control points
+  bool useElevation = true;
+
+  // If not enough points are given for a proper estimation of RPC
+  // with elevation support, disable elevation. This will result in
+  // all coefficients related to elevation set to zero.
+  if(nbGCPs<40)
+    {
+    otbGenericWarningMacro("Only "<<nbGCPs<<" ground control points are provided, can not estimate a RPC model with elevation support (at least 40 points required). Elevation support will be disabled for RPC estimation. All coefficients related to elevation will be set to zero, and elevation will have no effect on the resulting transform.");
+    useElevation = false;
+    }
+
+  ossimKeywordlist geom_kwl;
+  if (nbGCPs < MinimumGCPsForParallelSolver
+      || !SolveInParallel(gcpContainer, useElevation, rmsError, geom_kwl))
+    {
+    if (nbGCPs >= MinimumGCPsForParallelSolver)
+      {
+      otbGenericWarningMacro("The parallel RPC estimation failed, falling back to ossimRpcSolver.");
+      geom_kwl.clear();
+      }
+    SolveWithOSSIM(gcpContainer, useElevation, rmsError, geom_kwl);
+    }
 
   // Build an otb::ImageKeywordList
   otb_kwl.SetKeywordlist(geom_kwl);
@@ -22,6 +22,7 @@
 #include "otbSarSensorModelAdapter.h"
 
 #include <cassert>
+#include <vector>
 
 #include "otbMacro.h"
 #include "otbImageKeywordlist.h"
@@ -162,6 +163,35 @@ bool SarSensorModelAdapter::WorldToLineSample(const Point3DType & inGeoPoint, Po
   return true;
 }
 
+bool SarSensorModelAdapter::WorldToLineSample(const Point3DType * inGeoPoints, Point2DType * cr, std::size_t count) const
+{
+  if(m_SensorModel.get() == nullptr)
+    {
+    return false;
+    }
+
+  std::vector<ossimGpt> inGpts(count);
+  for(std::size_t i = 0; i < count; ++i)
+    {
+    inGpts[i].lon = inGeoPoints[i][0];
+    inGpts[i].lat = inGeoPoints[i][1];
+    inGpts[i].hgt = inGeoPoints[i][2];
+    }
+
+  std::vector<ossimDpt> outDpts(count);
+  m_SensorModel->worldToLineSampleBatch(inGpts.data(), outDpts.data(), count);
+
+  bool success = true;
+  for(std::size_t i = 0; i < count; ++i)
+    {
+    success = success && !outDpts[i].isNan();
+    cr[i][0]=outDpts[i].x;
+    cr[i][1]=outDpts[i].y;
+    }
+
+  return success;
+}
+
 bool SarSensorModelAdapter::WorldToCartesian(const Point3DType & inGeoPoint, Point3DType & outCartesianPoint)
 {
   ossimGpt inGpt;
@@ -22,6 +22,7 @@
 #include "otbSensorModelAdapter.h"
 
 #include <cassert>
+#include <vector>
 
 #include "otbMacro.h"
 #include "otbImageKeywordlist.h"
@@ -36,6 +37,7 @@
 #include "ossim/projection/ossimSensorModel.h"
 #include "ossim/projection/ossimRpcProjection.h"
 #include "ossim/ossimPluginProjectionFactory.h"
+#include "ossim/ossimSarSensorModel.h"
 #include "ossim/base/ossimTieGptSet.h"
 
 #pragma GCC diagnostic pop
@@ -45,6 +47,7 @@
 #include "ossim/projection/ossimSensorModel.h"
 #include "ossim/projection/ossimRpcProjection.h"
 #include "ossim/ossimPluginProjectionFactory.h"
+#include "ossim/ossimSarSensorModel.h"
 #include "ossim/base/ossimTieGptSet.h"
 
 #endif
@@ -166,6 +169,89 @@ void SensorModelAdapter::InverseTransformPoint(double lon, double lat,
   z = ossimGPoint.height();
 }
 
+void SensorModelAdapter::ForwardTransformPoints(std::size_t count,
+                                                const double* x, const double* y, const double* z,
+                                                double* lon, double* lat, double* h) const
+{
+  if (this->m_SensorModel == nullptr)
+    {
+    itkExceptionMacro(<< "ForwardTransformPoints(): Invalid sensor model (m_SensorModel pointer is null)");
+    }
+
+  ossimGpt ossimGPoint;
+  for (std::size_t i = 0; i < count; ++i)
+    {
+    ossimDpt ossimPoint( internal::ConvertToOSSIMFrame(x[i]),
+                         internal::ConvertToOSSIMFrame(y[i]));
+    if (z)
+      {
+      this->m_SensorModel->lineSampleHeightToWorld(ossimPoint, z[i], ossimGPoint);
+      }
+    else
+      {
+      this->m_SensorModel->lineSampleToWorld(ossimPoint, ossimGPoint);
+      }
+    lon[i] = ossimGPoint.lon;
+    lat[i] = ossimGPoint.lat;
+    h[i] = ossimGPoint.hgt;
+    }
+}
+
+void SensorModelAdapter::InverseTransformPoints(std::size_t count,
+                                                const double* lon, const double* lat, const double* h,
+                                                double* x, double* y, double* z) const
+{
+  if (this->m_SensorModel == nullptr)
+    {
+    itkExceptionMacro(<< "InverseTransformPoints(): Invalid sensor model (m_SensorModel pointer is null)");
+    }
+
+  // Get all the elevations from DEMHandler at once
+  std::vector<double> demHeights;
+  if (h == nullptr)
+    {
+    std::vector<DEMHandler::PointType> geoPoints(count);
+    for (std::size_t i = 0; i < count; ++i)
+      {
+      geoPoints[i][0] = lon[i];
+      geoPoints[i][1] = lat[i];
+      }
+    demHeights.resize(count);
+    m_DEMHandler->GetHeightAboveEllipsoid(geoPoints.data(), demHeights.data(), count);
+    h = demHeights.data();
+    }
+
+  // SAR models have a batched inverse location
+  if (const ossimplugins::ossimSarSensorModel * sarModel =
+        dynamic_cast<const ossimplugins::ossimSarSensorModel *>(this->m_SensorModel))
+    {
+    std::vector<ossimGpt> ossimGPoints(count);
+    std::vector<ossimDpt> ossimDPoints(count);
+    for (std::size_t i = 0; i < count; ++i)
+      {
+      ossimGPoints[i] = ossimGpt(lat[i], lon[i], h[i]);
+      }
+    sarModel->worldToLineSampleBatch(ossimGPoints.data(), ossimDPoints.data(), count);
+    for (std::size_t i = 0; i < count; ++i)
+      {
+      x[i] = internal::ConvertFromOSSIMFrame(ossimDPoints[i].x);
+      y[i] = internal::ConvertFromOSSIMFrame(ossimDPoints[i].y);
+      z[i] = ossimGPoints[i].height();
+      }
+    return;
+    }
+
+  ossimDpt ossimDPoint;
+  for (std::size_t i = 0; i < count; ++i)
+    {
+    ossimGpt ossimGPoint(lat[i], lon[i], h[i]);
+    this->m_SensorModel->worldToLineSample(ossimGPoint, ossimDPoint);
+    x[i] = internal::ConvertFromOSSIMFrame(ossimDPoint.x);
+    y[i] = internal::ConvertFromOSSIMFrame(ossimDPoint.y);
+    z[i] = ossimGPoint.height();
+    }
+}
+
 void SensorModelAdapter::AddTiePoint(double x, double y, double z, double lon, double lat)
 {
   // Create the tie point
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#pragma GCC diagnostic ignored "-Woverloaded-virtual"
+#pragma GCC diagnostic ignored "-Wshadow"
+#include "ossim/elevation/ossimElevManager.h"
+#pragma GCC diagnostic pop
+#else
+#include "ossim/elevation/ossimElevManager.h"
+#endif
+
+#include "otbDEMHandler.h"
+
+// Compare the heights read from the SRTM tile cache of DEMHandler (with the
+// batched API) to the heights computed by the OSSIM elevation manager, then
+// check that the tiles released by the memory budget are read again correctly
+int otbDEMTileCacheTest(int argc, char* argv[])
+{
+  if (argc != 8)
+    {
+    std::cerr << "Usage: " << argv[0] << " srtmDir geoid originX originY spacing size tolerance" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const double originX   = atof(argv[3]);
+  const double originY   = atof(argv[4]);
+  const double spacing   = atof(argv[5]);
+  const int    size      = atoi(argv[6]);
+  const double tolerance = atof(argv[7]);
+
+  otb::DEMHandler::Pointer demHandler = otb::DEMHandler::Instance();
+  demHandler->OpenDEMDirectory(argv[1]);
+  demHandler->OpenGeoidFile(argv[2]);
+
+  std::vector<otb::DEMHandler::PointType> points;
+  for (int j = 0; j < size; ++j)
+    {
+    for (int i = 0; i < size; ++i)
+      {
+      otb::DEMHandler::PointType point;
+      point[0] = originX + i * spacing;
+      point[1] = originY - j * spacing;
+      points.push_back(point);
+      }
+    }
+
+  std::vector<double> heights(points.size());
+  demHandler->GetHeightAboveEllipsoid(points.data(), heights.data(), points.size());
+  std::vector<double> msl(points.size());
+  demHandler->GetHeightAboveMSL(points.data(), msl.data(), points.size());
+
+  bool fail = false;
+  for (unsigned int k = 0; k < points.size(); ++k)
+    {
+    ossimGpt gpt(points[k][1], points[k][0]);
+    const double refHeight = ossimElevManager::instance()->getHeightAboveEllipsoid(gpt);
+    const double refMSL = ossimElevManager::instance()->getHeightAboveMSL(gpt);
+    if (std::abs(heights[k] - refHeight) > tolerance || std::abs(msl[k] - refMSL) > tolerance)
+      {
+      std::cerr << "Mismatch at (" << points[k][0] << ", " << points[k][1] << "): "
+                << heights[k] << " / " << msl[k] << " instead of "
+                << refHeight << " / " << refMSL << std::endl;
+      fail = true;
+      }
+    }
+
+  // With a zero budget, only the last loaded tile stays in memory: visit
+  // every indexed cell, then check that the grid is read again identically
+  otb::DEMTileCache cache;
+  cache.AddDirectory(argv[1]);
+  cache.SetMaximumMemory(0);
+  std::vector<double> cached(points.size());
+  cache.GetHeightAboveMSL(&points[0][0], &points[0][1], 2, points.size(), cached.data());
+  double height;
+  for (int lat = -90; lat < 90; ++lat)
+    {
+    for (int lon = -180; lon < 180; ++lon)
+      {
+      cache.GetHeightAboveMSL(lon + 0.5, lat + 0.5, height);
+      }
+    }
+  if (cache.GetNumberOfLoadedTiles() > 1)
+    {
+    std::cerr << cache.GetNumberOfLoadedTiles() << " tiles in memory with a zero budget" << std::endl;
+    fail = true;
+    }
+
+  std::vector<double> reloaded(points.size());
+  cache.GetHeightAboveMSL(&points[0][0], &points[0][1], 2, points.size(), reloaded.data());
+  for (unsigned int k = 0; k < points.size(); ++k)
+    {
+    // Points without SRTM height are NaN in both passes
+    if (reloaded[k] != cached[k] && !(std::isnan(reloaded[k]) && std::isnan(cached[k])))
+      {
+      std::cerr << "Mismatch after tile release at (" << points[k][0] << ", " << points[k][1] << "): "
+                << reloaded[k] << " instead of " << cached[k] << std::endl;
+      fail = true;
+      }
+    }
+
+  return fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include "itksys/SystemTools.hxx"
+#include "otbGeometryCache.h"
+
+// Check the product keys and a store/load round trip of the geometry cache
+int otbGeometryCacheTest(int argc, char* argv[])
+{
+  if (argc != 4)
+    {
+    std::cerr << "Usage: " << argv[0] << " cacheDirectory productDirectory geomFile" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const std::string cacheDirectory(argv[1]);
+  const std::string productDirectory(argv[2]);
+  itksys::SystemTools::RemoveADirectory(cacheDirectory);
+  itksys::SystemTools::RemoveADirectory(productDirectory);
+  itksys::SystemTools::MakeDirectory(productDirectory);
+  itksys::SystemTools::PutEnv("OTB_GEOMETRY_CACHE_DIRECTORY=" + cacheDirectory);
+
+  if (!otb::GeometryCache::IsEnabled())
+    {
+    std::cerr << "The geometry cache is not enabled" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A fake product: an image and its metadata
+  const std::string image = productDirectory + "/IMG_PRODUCT.TIF";
+  const std::string metadata = productDirectory + "/DIM_PRODUCT.XML";
+  std::ofstream(image.c_str()) << "image";
+  std::ofstream(metadata.c_str()) << "<Dimap_Document/>";
+
+  const std::string key = otb::GeometryCache::ComputeProductKey(image);
+  bool fail = false;
+  if (key.empty() || key != otb::GeometryCache::ComputeProductKey(image))
+    {
+    std::cerr << "The product key is not reproducible" << std::endl;
+    fail = true;
+    }
+  if (key == otb::GeometryCache::ComputeProductKey(image, "skiprpctag"))
+    {
+    std::cerr << "The product key does not depend on the reading options" << std::endl;
+    fail = true;
+    }
+  if (!otb::GeometryCache::ComputeProductKey(productDirectory + "/missing.tif").empty())
+    {
+    std::cerr << "A missing file has a product key" << std::endl;
+    fail = true;
+    }
+
+  // A new version of the metadata changes the key
+  const std::string newMetadata = productDirectory + "/DIM_PRODUCT.XML.new";
+  std::ofstream(newMetadata.c_str()) << "<Dimap_Document/><Processing_Information/>";
+  itksys::SystemTools::RenameFile(newMetadata.c_str(), metadata.c_str());
+  if (key == otb::GeometryCache::ComputeProductKey(image))
+    {
+    std::cerr << "The product key does not depend on the product metadata" << std::endl;
+    fail = true;
+    }
+
+  otb::ImageKeywordlist kwl = otb::ReadGeometryFromGEOMFile(argv[3]);
+  otb::ImageKeywordlist loaded;
+  if (otb::GeometryCache::Load(key, loaded))
+    {
+    std::cerr << "An entry was found in an empty cache" << std::endl;
+    fail = true;
+    }
+  otb::GeometryCache::Store(key, kwl);
+  if (!otb::GeometryCache::Load(key, loaded) || loaded != kwl)
+    {
+    std::cerr << "The keywordlist read from the cache is not the stored one" << std::endl;
+    fail = true;
+    }
+
+  return fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -30,6 +30,9 @@ void RegisterTests()
   REGISTER_TEST(otbGeometricSarSensorModelAdapterTest);
   REGISTER_TEST(otbPlatformPositionComputeBaselineTest);
   REGISTER_TEST(otbDEMHandlerTest);
+  REGISTER_TEST(otbDEMTileCacheTest);
+  REGISTER_TEST(otbGeometryCacheTest);
   REGISTER_TEST(otbRPCSolverAdapterTest);
+  REGISTER_TEST(otbRPCSolverAdapterSyntheticTest);
   REGISTER_TEST(otbSarSensorModelAdapterTest);
 }
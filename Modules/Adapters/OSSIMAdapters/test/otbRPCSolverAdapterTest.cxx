@@ -27,6 +27,8 @@
 #include "otbSensorModelAdapter.h"
 #include "otbRPCSolverAdapter.h"
 
+#include <algorithm>
+
 typedef otb::Image<double>                     ImageType;
 typedef otb::ImageFileReader<ImageType>        ReaderType;
 typedef otb::GenericRSTransform<>              RSTranformType;
@@ -190,3 +192,147 @@ int otbRPCSolverAdapterTest(int argc, char* argv[])
 
   return EXIT_SUCCESS;
 }
+
+namespace
+{
+
+/** Terms of the RPC00B polynomial at normalized (lon, lat, h) */
+void ComputeSyntheticRPCTerms(double l, double p, double h, double * terms)
+{
+  const double t[20] = {1., l, p, h, l * p, l * h, p * h, l * l, p * p, h * h,
+                        p * l * h, l * l * l, l * p * p, l * h * h, l * l * p,
+                        p * p * p, p * h * h, l * l * h, p * p * h, h * h * h};
+  std::copy(t, t + 20, terms);
+}
+
+/** Known RPC model used to generate the GCPs: mostly affine with
+ *  small quadratic, elevation and denominator terms */
+Point2DType SyntheticRPCImagePoint(const Point3DType & ground)
+{
+  const double sampNum[20] = {0.01, 1.02, 0.03, -0.02, 0.004, 0., 0., -0.003, 0.002};
+  const double sampDen[20] = {1., 0.001, -0.002, 0.0005};
+  const double lineNum[20] = {-0.02, 0.01, -0.98, 0.05, 0.002, 0., 0., 0.001, -0.004};
+  const double lineDen[20] = {1., -0.001, 0.0015, 0.0003};
+
+  double terms[20];
+  ComputeSyntheticRPCTerms((ground[0] - 1.425) / 0.03, (ground[1] - 43.605) / 0.03,
+                           (ground[2] - 250.) / 500., terms);
+
+  double sn = 0., sd = 0., ln = 0., ld = 0.;
+  for (unsigned int k = 0; k < 20; ++k)
+    {
+    sn += sampNum[k] * terms[k];
+    sd += sampDen[k] * terms[k];
+    ln += lineNum[k] * terms[k];
+    ld += lineDen[k] * terms[k];
+    }
+
+  Point2DType imagePoint;
+  imagePoint[0] = 5000. + 5000. * sn / sd;
+  imagePoint[1] = 5000. + 5000. * ln / ld;
+  return imagePoint;
+}
+
+}
+
+int otbRPCSolverAdapterSyntheticTest(int argc, char* argv[])
+{
+  if (argc < 4)
+    {
+    std::cout << "Usage: test_driver grid_size nb_heights img_tol" << std::endl;
+    return EXIT_FAILURE;
+    }
+  // This test generates gcps from a known rpc model and checks that
+  // the estimated model reprojects them, and the points between them,
+  // onto the known image positions. With a single height, the
+  // elevation terms can not be estimated and the problem is rank
+  // deficient: the model is then only checked at this height.
+  const unsigned int gridSize = atoi(argv[1]);
+  const unsigned int nbHeights = atoi(argv[2]);
+  const double imgTol = atof(argv[3]);
+
+  if (gridSize < 2 || nbHeights == 0)
+    {
+    std::cerr << "Grid size must be at least 2 and there must be at least one height!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::vector<double> heights;
+  for (unsigned int k = 0; k < nbHeights; ++k)
+    {
+    heights.push_back(nbHeights > 1 ? 500. * k / (nbHeights - 1) : 0.);
+    }
+
+  // Generate gcps, and check points in between
+  otb::RPCSolverAdapter::GCPsContainerType gcps;
+  std::vector<Point3DType> checkPoints;
+  for (const double height : heights)
+    {
+    for (unsigned int i = 0; i < 2 * gridSize - 1; ++i)
+      {
+      for (unsigned int j = 0; j < 2 * gridSize - 1; ++j)
+        {
+        Point3DType groundPoint;
+        groundPoint[0] = 1.395 + 0.06 * i / (2 * gridSize - 2);
+        groundPoint[1] = 43.575 + 0.06 * j / (2 * gridSize - 2);
+        groundPoint[2] = height;
+
+        if (i % 2 == 0 && j % 2 == 0)
+          {
+          gcps.push_back(std::make_pair(SyntheticRPCImagePoint(groundPoint), groundPoint));
+          }
+        checkPoints.push_back(groundPoint);
+        }
+      }
+    }
+
+  std::cout << "Estimating a rpc model from " << gcps.size() << " gcps" << std::endl;
+
+  otb::ImageKeywordlist rpcKwl;
+  double rmse;
+  otb::RPCSolverAdapter::Solve(gcps, rmse, rpcKwl);
+
+  std::cout << "Optimization done, RMSE=" << rmse << std::endl;
+
+  bool fail = false;
+  if (!(rmse <= imgTol))
+    {
+    fail = true;
+    std::cerr << "RMSE " << rmse << " is above the tolerance " << imgTol << std::endl;
+    }
+
+  RSTranform3dType::Pointer rpcInvTransform = RSTranform3dType::New();
+  rpcInvTransform->SetOutputKeywordList(rpcKwl);
+  rpcInvTransform->InstantiateTransform();
+
+  EuclideanDistanceMetricType::Pointer euclideanDistanceMetric = EuclideanDistanceMetricType::New();
+
+  double maxRes = 0.;
+  for (const auto & groundPoint : checkPoints)
+    {
+    const Point3DType imgPoint3D = rpcInvTransform->TransformPoint(groundPoint);
+
+    Point2DType imgPoint;
+    imgPoint[0] = imgPoint3D[0];
+    imgPoint[1] = imgPoint3D[1];
+
+    const Point2DType refPoint = SyntheticRPCImagePoint(groundPoint);
+    const double imgRes = euclideanDistanceMetric->Evaluate(imgPoint, refPoint);
+    maxRes = std::max(maxRes, imgRes);
+
+    if (!(imgRes <= imgTol))
+      {
+      fail = true;
+      std::cerr << "Imprecise result with estimated model: inv(" << groundPoint << ") = " << imgPoint << ", but reference is " << refPoint << " error: " << imgRes << " pixels)" << std::endl;
+      }
+    }
+
+  std::cout << "Maximum image error: " << maxRes << " pixels" << std::endl;
+
+  if (fail)
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -19,8 +19,10 @@
  */
 
 
+#include <cmath>
 #include <fstream>
 #include <iomanip>
+#include <vector>
 
 #include "otbSarSensorModelAdapter.h"
 #include "otbImageKeywordlist.h"
@@ -78,7 +80,55 @@ int otbSarSensorModelAdapterTest(int itkNotUsed(argc), char* argv[])
 
   sensorModel->WorldToCartesian(in, out5);
   sensorModel->WorldToSatPositionAndVelocity(in,out3, out4);
-  
-  
+
+  // The batched inverse location should match the point-wise one on a
+  // line of points around GCP 99. Both interpolate the doppler between
+  // the same orbit records: only the evaluation of the orbit polynomials
+  // differs, by rounding errors.
+  const unsigned int nbPoints = 50;
+  std::vector<otb::SarSensorModelAdapter::Point3DType> geoPoints(nbPoints);
+  std::vector<otb::SarSensorModelAdapter::Point2DType> batchPoints(nbPoints);
+  for (unsigned int i = 0; i < nbPoints; ++i)
+    {
+    geoPoints[i][0] = 1.116316013091967e+00 + 2e-4 * i;
+    geoPoints[i][1] = 4.323458093295080e+01 - 1e-4 * i;
+    geoPoints[i][2] = 2.238244926818182e+02;
+    }
+  if (!sensorModel->WorldToLineSample(geoPoints.data(), batchPoints.data(), nbPoints))
+    {
+    std::cerr<<"Batched WorldToLineSample() call failed."<<std::endl;
+    return EXIT_FAILURE;
+    }
+  for (unsigned int i = 0; i < nbPoints; ++i)
+    {
+    sensorModel->WorldToLineSample(geoPoints[i], out1);
+    if (std::abs(out1[0] - batchPoints[i][0]) > 1e-3 || std::abs(out1[1] - batchPoints[i][1]) > 1e-3)
+      {
+      std::cerr<<"Batched WorldToLineSample() gives "<<batchPoints[i]<<" for "<<geoPoints[i]
+               <<" instead of "<<out1<<std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // The search of the orbit records does not depend on the starting
+  // point: the batch in reverse order, started from the other end, must
+  // give the same image points
+  std::vector<otb::SarSensorModelAdapter::Point3DType> reversedGeoPoints(geoPoints.rbegin(), geoPoints.rend());
+  std::vector<otb::SarSensorModelAdapter::Point2DType> reversedBatchPoints(nbPoints);
+  if (!sensorModel->WorldToLineSample(reversedGeoPoints.data(), reversedBatchPoints.data(), nbPoints))
+    {
+    std::cerr<<"Batched WorldToLineSample() call failed."<<std::endl;
+    return EXIT_FAILURE;
+    }
+  for (unsigned int i = 0; i < nbPoints; ++i)
+    {
+    if (reversedBatchPoints[nbPoints - 1 - i].EuclideanDistanceTo(batchPoints[i]) > 1e-5)
+      {
+      std::cerr<<"Batched WorldToLineSample() gives "<<reversedBatchPoints[nbPoints - 1 - i]<<" for "<<geoPoints[i]
+               <<" in reverse order instead of "<<batchPoints[i]<<std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
   return EXIT_SUCCESS;
 }
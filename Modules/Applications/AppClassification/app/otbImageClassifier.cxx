@@ -154,15 +154,13 @@ private:
 
     // Load svm model
     otbAppLogINFO("Loading model");
-    m_Model = MachineLearningModelFactoryType::CreateMachineLearningModel(GetParameterString("model"),
-                                                                          MachineLearningModelFactoryType::ReadMode);
+    m_Model = MachineLearningModelFactoryType::LoadMachineLearningModel(GetParameterString("model"));
 
     if (m_Model.IsNull())
       {
       otbAppLogFATAL(<< "Error when loading model " << GetParameterString("model") << " : unsupported model type");
       }
 
-    m_Model->Load(GetParameterString("model"));
     otbAppLogINFO("Model loaded");
 
     // Normalize input image (optional)
@@ -29,6 +29,8 @@
 #include "itkBinaryMorphologicalOpeningImageFilter.h"
 #include "itkBinaryMorphologicalClosingImageFilter.h"
 #include "itkBinaryMorphologyImageFilter.h"
+#include "itkBinaryThresholdImageFilter.h"
+#include "otbVanHerkGilWermanMorphologyImageFilter.h"
 
 #include "otbMultiToMonoChannelExtractROI.h"
 #include "otbImageList.h"
@@ -63,6 +65,9 @@ typedef itk::BinaryMorphologicalOpeningImageFilter<FloatImageType, FloatImageTyp
 typedef itk::BinaryMorphologicalClosingImageFilter<FloatImageType, FloatImageType, StructuringType>
                                                                                ClosingFilterType;
 
+typedef VanHerkGilWermanMorphologyImageFilter<FloatImageType, FloatImageType> VanHerkGilWermanFilterType;
+typedef itk::BinaryThresholdImageFilter<FloatImageType, FloatImageType>        ThresholdFilterType;
+
 typedef ImageList<FloatImageType>                                              ImageListType;
 typedef ImageListToVectorImageFilter<ImageListType, FloatVectorImageType>      ImageListToVectorImageFilterType;
 
@@ -80,7 +85,11 @@ SetDescription( "Performs morphological operations on an input image channel" );
 // Documentation
 SetDocName( "Binary Morphological Operation" );
 SetDocLongDescription( "This application performs binary morphological "
-  "operations on a mono band image or a channel of the input." );
+  "operations on a mono band image or a channel of the input. "
+  "With the vHGW algorithm, the foreground mask is filtered by line decompositions "
+  "of the structuring element, faster for large radius. The ball is exact: it is "
+  "decomposed into the largest boxes it contains, whose union is the ball of "
+  "itk::FlatStructuringElement. The output only holds the foreground and background values." );
 SetDocLimitations( "None" );
 SetDocAuthors( "OTB-Team" );
 SetDocSeeAlso( "itkBinaryDilateImageFilter, itkBinaryErodeImageFilter, "
@@ -166,6 +175,16 @@ SetParameterDescription( "filter.closing.foreval" ,
   "Set the foreground value, default is 1.0." );
 SetDefaultParameterFloat( "filter.closing.foreval" , 1.0 );
 
+AddParameter( ParameterType_Choice , "algorithm" , "Algorithm" );
+SetParameterDescription( "algorithm" , "Choice of the algorithm" );
+AddChoice( "algorithm.neighborhood" , "Neighborhood" );
+SetParameterDescription( "algorithm.neighborhood" ,
+  "Neighborhood based algorithms of ITK, exact for all the structuring elements." );
+AddChoice( "algorithm.vhgw" , "Van Herk/Gil-Werman" );
+SetParameterDescription( "algorithm.vhgw" ,
+  "Line decompositions of the structuring element, faster for large radius. "
+  "The ball is decomposed into the largest boxes it contains, the result is exact." );
+
 // Doc example parameter settings
 SetDocExampleParameterValue("in", "qb_RoadExtract.tif");
 SetDocExampleParameterValue("out", "opened.tif");
@@ -206,6 +225,61 @@ void DoExecute() override
   rad[0] = this->GetParameterInt("xradius");
   rad[1] = this->GetParameterInt("yradius");
 
+  if(GetParameterString("algorithm") == "vhgw")
+    {
+    const std::string filter = GetParameterString("filter");
+    const float foreval = GetParameterFloat("filter." + filter + ".foreval");
+    const float backval = filter == "closing" ? 0. : GetParameterFloat("filter." + filter + ".backval");
+
+    // Foreground mask
+    m_MaskFilter = ThresholdFilterType::New();
+    m_MaskFilter->SetInput(m_ExtractorFilter->GetOutput());
+    m_MaskFilter->SetLowerThreshold(foreval);
+    m_MaskFilter->SetUpperThreshold(foreval);
+    m_MaskFilter->SetInsideValue(1);
+    m_MaskFilter->SetOutsideValue(0);
+
+    m_VanHerkGilWermanFilter = VanHerkGilWermanFilterType::New();
+    m_VanHerkGilWermanFilter->SetInput(m_MaskFilter->GetOutput());
+    m_VanHerkGilWermanFilter->SetRadius(rad);
+    if(GetParameterString("structype") == "box")
+      {
+      m_VanHerkGilWermanFilter->SetShape(VanHerkGilWermanFilterType::BOX);
+      }
+    else if(GetParameterString("structype") == "ball")
+      {
+      m_VanHerkGilWermanFilter->SetShape(VanHerkGilWermanFilterType::BALL);
+      }
+    else if(GetParameterString("structype") == "cross")
+      {
+      m_VanHerkGilWermanFilter->SetShape(VanHerkGilWermanFilterType::CROSS);
+      }
+    if(filter == "dilate")
+      {
+      m_VanHerkGilWermanFilter->SetOperation(VanHerkGilWermanFilterType::DILATE);
+      }
+    else if(filter == "erode")
+      {
+      m_VanHerkGilWermanFilter->SetOperation(VanHerkGilWermanFilterType::ERODE);
+      }
+    else if(filter == "opening")
+      {
+      m_VanHerkGilWermanFilter->SetOperation(VanHerkGilWermanFilterType::OPENING);
+      }
+    else if(filter == "closing")
+      {
+      m_VanHerkGilWermanFilter->SetOperation(VanHerkGilWermanFilterType::CLOSING);
+      }
+
+    m_OutputFilter = ThresholdFilterType::New();
+    m_OutputFilter->SetInput(m_VanHerkGilWermanFilter->GetOutput());
+    m_OutputFilter->SetLowerThreshold(0.5);
+    m_OutputFilter->SetInsideValue(foreval);
+    m_OutputFilter->SetOutsideValue(backval);
+    SetParameterOutputImage("out", m_OutputFilter->GetOutput());
+    return;
+    }
+
   StructuringType se;
   if(GetParameterString("structype") == "box")
     {
@@ -263,6 +337,9 @@ DilateFilterType::Pointer                   m_DilFilter;
 ErodeFilterType::Pointer                    m_EroFilter;
 OpeningFilterType::Pointer                  m_OpeFilter;
 ClosingFilterType::Pointer                  m_CloFilter;
+ThresholdFilterType::Pointer                m_MaskFilter;
+VanHerkGilWermanFilterType::Pointer         m_VanHerkGilWermanFilter;
+ThresholdFilterType::Pointer                m_OutputFilter;
 };
 }
 }
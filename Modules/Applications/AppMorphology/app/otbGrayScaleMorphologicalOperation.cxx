@@ -28,6 +28,7 @@
 #include "itkGrayscaleErodeImageFilter.h"
 #include "itkGrayscaleMorphologicalOpeningImageFilter.h"
 #include "itkGrayscaleMorphologicalClosingImageFilter.h"
+#include "otbVanHerkGilWermanMorphologyImageFilter.h"
 
 #include "otbMultiToMonoChannelExtractROI.h"
 #include "otbImageList.h"
@@ -62,6 +63,8 @@ typedef itk::GrayscaleMorphologicalOpeningImageFilter<FloatImageType, FloatImage
 typedef itk::GrayscaleMorphologicalClosingImageFilter<FloatImageType, FloatImageType, StructuringType>
                                                                                ClosingFilterType;
 
+typedef VanHerkGilWermanMorphologyImageFilter<FloatImageType, FloatImageType> VanHerkGilWermanFilterType;
+
 typedef ImageList<FloatImageType>                                              ImageListType;
 typedef ImageListToVectorImageFilter<ImageListType, FloatVectorImageType>      ImageListToVectorImageFilterType;
 
@@ -78,10 +81,14 @@ SetDescription("Performs morphological operations on a grayscale input image");
 
 // Documentation
 SetDocName("Grayscale Morphological Operation");
-SetDocLongDescription("This application performs grayscale morphological operations on a mono band image");
+SetDocLongDescription("This application performs grayscale morphological operations on a mono band image. "
+  "With the vHGW algorithm, the structuring element is decomposed into line segments, whose running "
+  "minimum or maximum costs a few comparisons per pixel whatever the radius. The box and the cross are "
+  "decomposed into two segments, the ball into the largest boxes it contains, about one per pixel of "
+  "radius: the outputs are the same as with the basic algorithm.");
 SetDocLimitations("None");
 SetDocAuthors("OTB-Team");
-SetDocSeeAlso("itkGrayscaleDilateImageFilter, itkGrayscaleErodeImageFilter, itkGrayscaleMorphologicalOpeningImageFilter and itkGrayscaleMorphologicalClosingImageFilter classes");
+SetDocSeeAlso("itkGrayscaleDilateImageFilter, itkGrayscaleErodeImageFilter, itkGrayscaleMorphologicalOpeningImageFilter, itkGrayscaleMorphologicalClosingImageFilter and otbVanHerkGilWermanMorphologyImageFilter classes");
 
 AddDocTag(Tags::FeatureExtraction);
 AddDocTag("Morphology");
@@ -120,6 +127,13 @@ AddChoice("filter.erode", "Erode");
 AddChoice("filter.opening", "Opening");
 AddChoice("filter.closing", "Closing");
 
+AddParameter(ParameterType_Choice, "algorithm", "Algorithm");
+SetParameterDescription("algorithm", "Choice of the algorithm");
+AddChoice("algorithm.neighborhood", "Neighborhood");
+SetParameterDescription("algorithm.neighborhood", "Neighborhood based algorithms of ITK, exact for all the structuring elements.");
+AddChoice("algorithm.vhgw", "Van Herk/Gil-Werman");
+SetParameterDescription("algorithm.vhgw", "Line decompositions of the structuring element, faster for large radius.");
+
 // Doc example parameter settings
 SetDocExampleParameterValue("in", "qb_RoadExtract.tif");
 SetDocExampleParameterValue("out", "opened.tif");
@@ -160,6 +174,43 @@ void DoExecute() override
   rad[0] = this->GetParameterInt("xradius");
   rad[1] = this->GetParameterInt("yradius");
 
+  if(GetParameterString("algorithm") == "vhgw")
+    {
+    m_VanHerkGilWermanFilter = VanHerkGilWermanFilterType::New();
+    m_VanHerkGilWermanFilter->SetInput(m_ExtractorFilter->GetOutput());
+    m_VanHerkGilWermanFilter->SetRadius(rad);
+    if(GetParameterString("structype") == "box")
+      {
+      m_VanHerkGilWermanFilter->SetShape(VanHerkGilWermanFilterType::BOX);
+      }
+    else if(GetParameterString("structype") == "ball")
+      {
+      m_VanHerkGilWermanFilter->SetShape(VanHerkGilWermanFilterType::BALL);
+      }
+    else if(GetParameterString("structype") == "cross")
+      {
+      m_VanHerkGilWermanFilter->SetShape(VanHerkGilWermanFilterType::CROSS);
+      }
+    if(GetParameterString("filter") == "dilate")
+      {
+      m_VanHerkGilWermanFilter->SetOperation(VanHerkGilWermanFilterType::DILATE);
+      }
+    else if(GetParameterString("filter") == "erode")
+      {
+      m_VanHerkGilWermanFilter->SetOperation(VanHerkGilWermanFilterType::ERODE);
+      }
+    else if(GetParameterString("filter") == "opening")
+      {
+      m_VanHerkGilWermanFilter->SetOperation(VanHerkGilWermanFilterType::OPENING);
+      }
+    else if(GetParameterString("filter") == "closing")
+      {
+      m_VanHerkGilWermanFilter->SetOperation(VanHerkGilWermanFilterType::CLOSING);
+      }
+    SetParameterOutputImage("out", m_VanHerkGilWermanFilter->GetOutput());
+    return;
+    }
+
   StructuringType se;
   if(GetParameterString("structype") == "box")
     {
@@ -210,6 +261,7 @@ DilateFilterType::Pointer                   m_DilFilter;
 ErodeFilterType::Pointer                    m_EroFilter;
 OpeningFilterType::Pointer                  m_OpeFilter;
 ClosingFilterType::Pointer                  m_CloFilter;
+VanHerkGilWermanFilterType::Pointer         m_VanHerkGilWermanFilter;
 };
 }
 }
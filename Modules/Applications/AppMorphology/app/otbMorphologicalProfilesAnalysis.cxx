@@ -39,6 +39,7 @@
 #include "otbConvexOrConcaveClassificationFilter.h"
 #include "otbMorphologicalProfilesSegmentationFilter.h"
 #include "otbGeodesicMorphologyIterativeDecompositionImageFilter.h"
+#include "otbAttributeProfilesImageFilter.h"
 
 namespace otb
 {
@@ -64,6 +65,11 @@ public:
   typedef itk::BinaryBallStructuringElement<InputPixelType, 2> BallStructuringElementType;
   typedef itk::BinaryCrossStructuringElement<InputPixelType, 2> CrossStructuringElementType;
 
+  typedef otb::AttributeProfilesImageFilter<FloatImageType, FloatVectorImageType> AttributeProfilesFilterType;
+  typedef otb::MultiToMonoChannelExtractROI<InputPixelType, InputPixelType> MaximaExtractorFilterType;
+  typedef otb::MultiToMonoChannelExtractROI<InputPixelType, LabeledPixelType> CharacteristicsExtractorFilterType;
+  typedef otb::MultiScaleConvexOrConcaveClassificationFilter<FloatImageType, LabeledImageType> AttributeClassificationFilterType;
+
 /** Standard macro */
   itkNewMacro( Self );
 
@@ -102,8 +108,15 @@ private:
                                    "The output image can be :"
                                    "- A :math:`N` multi band image for the opening/closing normal or derivative profiles.\n"
                                    "- A mono band image for the opening/closing characteristics.\n"
-                                   "- A labeled image for the classification." );
-    SetDocLimitations( "Generation of the morphological profile is not streamable, pay attention to this fact when setting the radius initial size and step of the structuring element." );
+                                   "- A labeled image for the classification.\n"
+                                   "\n"
+                                   "With the area method, the openings and closings by reconstruction are replaced by "
+                                   "area openings and closings, the area threshold of each level being the number of "
+                                   "pixels of the structuring element. All the levels are then derived from a max-tree "
+                                   "and a min-tree built once per tile, and the profiles are streamed." );
+    SetDocLimitations( "With the geodesic method, the generation of the morphological profile is not streamable, pay attention to this fact when setting the radius initial size and step of the structuring element. "
+                       "With the area method, the tiles are padded by the area of the largest structuring element, so that the output "
+                       "does not depend on the streaming: with large structuring elements, each tile may then read most of the input image." );
     SetDocAuthors( "OTB-Team" );
     SetDocSeeAlso( "otbMorphologicalOpeningProfileFilter, otbMorphologicalClosingProfileFilter, otbProfileToProfileDerivativeFilter, otbProfileDerivativeToMultiScaleCharacteristicsFilter, otbMultiScaleConvexOrConcaveClassificationFilter, classes" );
 
@@ -129,6 +142,13 @@ private:
     AddChoice( "structype.ball", "Ball" );
     AddChoice( "structype.cross", "Cross" );
 
+    AddParameter( ParameterType_Choice, "method", "Profile method" );
+    SetParameterDescription( "method", "Choice of the morphological operators used for the profiles" );
+    AddChoice( "method.geodesic", "Geodesic" );
+    SetParameterDescription( "method.geodesic", "Openings and closings by reconstruction, computed level by level." );
+    AddChoice( "method.area", "Area" );
+    SetParameterDescription( "method.area", "Area openings and closings, all levels being computed from one component tree per tile." );
+
     AddParameter( ParameterType_Int, "size", "Profile Size" );
     SetParameterDescription( "size", "Size of the profiles" );
     SetDefaultParameterInt( "size", 5 );
@@ -205,6 +225,18 @@ private:
     float sigma = GetParameterFloat( "profile.classification.sigma" );
     std::string profile = GetParameterString( "profile" );
 
+    if ( GetParameterString( "method" ) == "area" )
+      {
+      if ( GetParameterString( "structype" ) == "ball" )
+        {
+        performAttributeProfileAnalysis<BallStructuringElementType>( profile, profileSize, initValue, step, sigma );
+        }
+      else // Cross
+        {
+        performAttributeProfileAnalysis<CrossStructuringElementType>( profile, profileSize, initValue, step, sigma );
+        }
+      return;
+      }
 
     if ( GetParameterString( "structype" ) == "ball" )
       {
@@ -216,6 +248,91 @@ private:
       }
   }
 
+  template<typename StructuringElementType>
+  void
+  performAttributeProfileAnalysis(std::string profile, unsigned int profileSize, unsigned short initValue,
+                                  unsigned short step, float sigma) {
+
+    // The area threshold of each level is the size of the structuring element
+    AttributeProfilesFilterType::ThresholdListType thresholds;
+    for ( unsigned int i = 0; i < profileSize; ++i )
+      {
+      StructuringElementType se;
+      se.SetRadius( initValue + i * step );
+      se.CreateStructuringElement();
+      unsigned long area = 0;
+      for ( typename StructuringElementType::ConstIterator it = se.Begin(); it != se.End(); ++it )
+        {
+        if ( *it > 0 )
+          {
+          ++area;
+          }
+        }
+      thresholds.push_back( area );
+      }
+
+    m_AttributeProfilesFilter = AttributeProfilesFilterType::New();
+    m_AttributeProfilesFilter->SetInput( m_ExtractorFilter->GetOutput() );
+    m_AttributeProfilesFilter->SetThresholds( thresholds );
+    m_AttributeProfilesFilter->SetInitialValue( initValue );
+    m_AttributeProfilesFilter->SetStep( step );
+
+    if ( profile == "opening" )
+      {
+      SetParameterOutputImage( "out", m_AttributeProfilesFilter->GetOpeningProfileOutput() );
+      }
+    else if ( profile == "closing" )
+      {
+      SetParameterOutputImage( "out", m_AttributeProfilesFilter->GetClosingProfileOutput() );
+      }
+    else if ( profile == "derivativeopening" )
+      {
+      SetParameterOutputImage( "out", m_AttributeProfilesFilter->GetOpeningDerivativeOutput() );
+      }
+    else if ( profile == "derivativeclosing" )
+      {
+      SetParameterOutputImage( "out", m_AttributeProfilesFilter->GetClosingDerivativeOutput() );
+      }
+    else if ( profile == "openingcharacteristics" )
+      {
+      m_OpeningCharacteristicsExtractorFilter = CharacteristicsExtractorFilterType::New();
+      m_OpeningCharacteristicsExtractorFilter->SetInput( m_AttributeProfilesFilter->GetOpeningCharacteristicsOutput() );
+      m_OpeningCharacteristicsExtractorFilter->SetChannel( 2 );
+      SetParameterOutputImage( "out", m_OpeningCharacteristicsExtractorFilter->GetOutput() );
+      }
+    else if ( profile == "closingcharacteristics" )
+      {
+      m_ClosingCharacteristicsExtractorFilter = CharacteristicsExtractorFilterType::New();
+      m_ClosingCharacteristicsExtractorFilter->SetInput( m_AttributeProfilesFilter->GetClosingCharacteristicsOutput() );
+      m_ClosingCharacteristicsExtractorFilter->SetChannel( 2 );
+      SetParameterOutputImage( "out", m_ClosingCharacteristicsExtractorFilter->GetOutput() );
+      }
+    else // classification
+      {
+      m_OpeningMaximaExtractorFilter = MaximaExtractorFilterType::New();
+      m_OpeningMaximaExtractorFilter->SetInput( m_AttributeProfilesFilter->GetOpeningCharacteristicsOutput() );
+      m_OpeningMaximaExtractorFilter->SetChannel( 1 );
+      m_OpeningCharacteristicsExtractorFilter = CharacteristicsExtractorFilterType::New();
+      m_OpeningCharacteristicsExtractorFilter->SetInput( m_AttributeProfilesFilter->GetOpeningCharacteristicsOutput() );
+      m_OpeningCharacteristicsExtractorFilter->SetChannel( 2 );
+      m_ClosingMaximaExtractorFilter = MaximaExtractorFilterType::New();
+      m_ClosingMaximaExtractorFilter->SetInput( m_AttributeProfilesFilter->GetClosingCharacteristicsOutput() );
+      m_ClosingMaximaExtractorFilter->SetChannel( 1 );
+      m_ClosingCharacteristicsExtractorFilter = CharacteristicsExtractorFilterType::New();
+      m_ClosingCharacteristicsExtractorFilter->SetInput( m_AttributeProfilesFilter->GetClosingCharacteristicsOutput() );
+      m_ClosingCharacteristicsExtractorFilter->SetChannel( 2 );
+
+      m_AttributeClassificationFilter = AttributeClassificationFilterType::New();
+      m_AttributeClassificationFilter->SetOpeningProfileDerivativeMaxima( m_OpeningMaximaExtractorFilter->GetOutput() );
+      m_AttributeClassificationFilter->SetOpeningProfileCharacteristics( m_OpeningCharacteristicsExtractorFilter->GetOutput() );
+      m_AttributeClassificationFilter->SetClosingProfileDerivativeMaxima( m_ClosingMaximaExtractorFilter->GetOutput() );
+      m_AttributeClassificationFilter->SetClosingProfileCharacteristics( m_ClosingCharacteristicsExtractorFilter->GetOutput() );
+      m_AttributeClassificationFilter->SetSigma( sigma );
+      m_AttributeClassificationFilter->SetLabelSeparator( static_cast<unsigned short>(initValue + profileSize * step) );
+      SetParameterOutputImage( "out", m_AttributeClassificationFilter->GetOutput() );
+      }
+  }
+
   template<typename StructuringElementType>
   void
   performProfileAnalysis(std::string profile, unsigned int profileSize, unsigned short initValue,
@@ -333,6 +450,13 @@ private:
 
   ExtractorFilterType::Pointer m_ExtractorFilter;
 
+  AttributeProfilesFilterType::Pointer        m_AttributeProfilesFilter;
+  MaximaExtractorFilterType::Pointer          m_OpeningMaximaExtractorFilter;
+  MaximaExtractorFilterType::Pointer          m_ClosingMaximaExtractorFilter;
+  CharacteristicsExtractorFilterType::Pointer m_OpeningCharacteristicsExtractorFilter;
+  CharacteristicsExtractorFilterType::Pointer m_ClosingCharacteristicsExtractorFilter;
+  AttributeClassificationFilterType::Pointer  m_AttributeClassificationFilter;
+
 };
 }
 }
@@ -227,6 +227,19 @@ private:
                             "but increasing this parameter will reduce processing time.");
     MandatoryOff("opt.gridspacing");
 
+    // Adaptive displacement field
+    AddParameter(ParameterType_Float, "opt.maxerror", "Maximum geometric error (pixels)");
+    SetDefaultParameterFloat("opt.maxerror", 0.1);
+    SetMinimumParameterFloatValue("opt.maxerror", 0.);
+    SetParameterDescription("opt.maxerror",
+                            "When enabled, the deformation grid is refined adaptively: the sensor "
+                            "model is evaluated on a coarse grid, and the cells are subdivided only "
+                            "where interpolating the grid would lead to a geometric error larger than "
+                            "this value, expressed in input pixels. Unless opt.gridspacing is set, "
+                            "the finest grid spacing is the output spacing.");
+    DisableParameter("opt.maxerror");
+    MandatoryOff("opt.maxerror");
+
     // Doc example parameter settings
     SetDocExampleParameterValue("io.in", "QB_TOULOUSE_MUL_Extract_500_500.tif");
     SetDocExampleParameterValue("io.out","QB_Toulouse_ortho.tif");
@@ -522,11 +535,11 @@ private:
           // Use the smallest spacing (more precise grid)
           double optimalSpacing = std::min( std::abs(xgridspacing), std::abs(ygridspacing) );
           otbAppLogINFO( "Setting grid spacing to " << optimalSpacing );
-          SetParameterFloat("opt.gridspacing",optimalSpacing);
+          SetParameterFloat("opt.gridspacing",optimalSpacing, false);
           }
         else // if (m_OutputProjectionRef == otb::GeoInformationConversion::ToWKT(4326))
           {
-          SetParameterFloat("opt.gridspacing",DefaultGridSpacingMeter);
+          SetParameterFloat("opt.gridspacing",DefaultGridSpacingMeter, false);
           } // if (m_OutputProjectionRef == otb::GeoInformationConversion::ToWKT(4326))
         } // if (!HasUserValue("opt.gridspacing"))
       } // if (HasValue("io.in"))
@@ -617,9 +630,18 @@ private:
     otbAppLogINFO("Area outside input image bounds will have a pixel value of " << defaultValue);
 
 
+    // Adaptive displacement field
+    bool adaptiveGrid = IsParameterEnabled("opt.maxerror") && GetParameterFloat("opt.maxerror") > 0.;
+    if (adaptiveGrid)
+      {
+      m_ResampleFilter->SetMaximumGeometricError(GetParameterFloat("opt.maxerror"));
+      otbAppLogINFO("Using an adaptive deformation grid with a maximum error of "
+                    << GetParameterFloat("opt.maxerror") << " pixels");
+      }
+
     // Displacement Field spacing
     ResampleFilterType::SpacingType gridSpacing;
-    if (IsParameterEnabled("opt.gridspacing"))
+    if (IsParameterEnabled("opt.gridspacing") && (!adaptiveGrid || HasUserValue("opt.gridspacing")))
       {
       gridSpacing[0] = GetParameterFloat("opt.gridspacing");
       gridSpacing[1] = -GetParameterFloat("opt.gridspacing");
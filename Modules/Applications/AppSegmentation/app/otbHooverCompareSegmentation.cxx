@@ -21,11 +21,7 @@
 #include "otbWrapperApplication.h"
 #include "otbWrapperApplicationFactory.h"
 
-#include "otbHooverMatrixFilter.h"
-#include "otbHooverInstanceFilter.h"
-#include "otbLabelMapToAttributeImageFilter.h"
-
-#include "itkLabelImageToLabelMapFilter.h"
+#include "otbStreamingHooverMetricsFilter.h"
 #include "otbUnaryFunctorImageFilter.h"
 
 namespace otb
@@ -33,12 +29,12 @@ namespace otb
 
 namespace Functor
 {
-// Functor to color Hoover instances
-template<class TInput, class TOutput>
+// Functor to color Hoover instances, from the scores of each label
+template<class TInput, class TOutput, class TScoreMap>
 class HooverColorMapping
 {
 public:
-  HooverColorMapping() {}
+  HooverColorMapping() : m_Scores(nullptr) {}
   virtual ~HooverColorMapping() {}
 
   typedef std::vector<TOutput> ColorListType;
@@ -57,19 +53,32 @@ public:
     m_Background = bg;
   }
 
-  inline TOutput operator ()(const TInput& A)
+  /** Scores of each region, which must outlive the functor */
+  void SetScores(const TScoreMap * scores)
+  {
+    m_Scores = scores;
+  }
+
+  inline TOutput operator ()(const TInput& label)
   {
     TOutput out;
     out.SetSize(3);
 
-    typename TInput::ValueType max = 0.0;
+    typename TScoreMap::const_iterator it = m_Scores->find(label);
+    if (it == m_Scores->end())
+      {
+      out = m_Background;
+      return out;
+      }
+
+    double max = 0.0;
     unsigned int index=0;
     for (unsigned int i=0; i<m_ScoreColors.size(); i++)
       {
-      if (A[i] > max)
+      if (it->second[i] > max)
         {
         index = i;
-        max = A[i];
+        max = it->second[i];
         }
       }
     if (max > 0.01)
@@ -84,8 +93,9 @@ public:
   }
 
 private:
-  ColorListType m_ScoreColors;
-  TOutput       m_Background;
+  ColorListType     m_ScoreColors;
+  TOutput           m_Background;
+  const TScoreMap * m_Scores;
 };
 
 } // end namespace Functor
@@ -108,26 +118,16 @@ public:
 
   itkTypeMacro(HooverCompareSegmentation, otb::Application);
 
-  typedef otb::AttributesMapLabelObject<unsigned int, 2, float> LabelObjectType;
-  typedef itk::LabelMap<LabelObjectType>            LabelMapType;
-  typedef otb::HooverMatrixFilter<LabelMapType>     HooverMatrixFilterType;
   typedef UInt32ImageType                           ImageType;
-  typedef FloatVectorImageType::PixelType           FloatPixelType;
   typedef Int16VectorImageType::PixelType           Int16PixelType;
-  //typedef otb::VectorImage<float, 2>                VectorImageType;
-  typedef itk::LabelImageToLabelMapFilter
-    <ImageType, LabelMapType>                       ImageToLabelMapFilterType;
-  typedef otb::ImageFileReader<ImageType>           ImageReaderType;
-  typedef HooverMatrixFilterType::MatrixType        MatrixType;
-
-  typedef otb::HooverInstanceFilter<LabelMapType>   InstanceFilterType;
-  typedef otb::LabelMapToAttributeImageFilter
-      <LabelMapType, FloatVectorImageType>          AttributeImageFilterType;
+  typedef otb::StreamingHooverMetricsFilter
+    <ImageType>                                     HooverMetricsFilterType;
+  typedef HooverMetricsFilterType::ScoreMapType     ScoreMapType;
   typedef otb::UnaryFunctorImageFilter
-      <FloatVectorImageType,
+      <ImageType,
        Int16VectorImageType,
        Functor::HooverColorMapping
-        <FloatPixelType, Int16PixelType> >          HooverColorFilterType;
+        <ImageType::PixelType, Int16PixelType, ScoreMapType> > HooverColorFilterType;
 
 private:
   void DoInit() override
@@ -148,7 +148,7 @@ private:
                           " comparison of range image segmentation algorithms\", IEEE PAMI vol. 18, no. 7, July 1996.");
     SetDocLimitations("None");
     SetDocAuthors("OTB-Team");
-    SetDocSeeAlso("otbHooverMatrixFilter, otbHooverInstanceFilter, otbLabelMapToAttributeImageFilter");
+    SetDocSeeAlso("otbStreamingHooverMetricsFilter, otbHooverMatrixFilter, otbHooverInstanceFilter");
 
     AddDocTag(Tags::Segmentation);
 
@@ -212,46 +212,23 @@ private:
     UInt32ImageType::Pointer inputGT = GetParameterUInt32Image("ingt");
     UInt32ImageType::Pointer inputMS = GetParameterUInt32Image("inms");
 
-    m_GTFilter = ImageToLabelMapFilterType::New();
-    m_GTFilter->SetInput(inputGT);
-    m_GTFilter->SetBackgroundValue( GetParameterInt("bg") );
-
-    m_MSFilter = ImageToLabelMapFilterType::New();
-    m_MSFilter->SetInput(inputMS);
-    m_MSFilter->SetBackgroundValue( GetParameterInt("bg") );
-
-    m_HooverFilter = HooverMatrixFilterType::New();
-    m_HooverFilter->SetGroundTruthLabelMap(m_GTFilter->GetOutput());
-    m_HooverFilter->SetMachineSegmentationLabelMap(m_MSFilter->GetOutput());
+    // The contingency table is computed by streaming both images
+    m_HooverFilter = HooverMetricsFilterType::New();
+    m_HooverFilter->SetGroundTruthImage(inputGT);
+    m_HooverFilter->SetMachineSegmentationImage(inputMS);
+    m_HooverFilter->SetBackgroundValue( GetParameterInt("bg") );
+    m_HooverFilter->SetThreshold( GetParameterFloat("th") );
 
+    AddProcess(m_HooverFilter->GetStreamer(), "Computing Hoover metrics...");
     m_HooverFilter->Update();
 
-    m_InstanceFilter = InstanceFilterType::New();
-    m_InstanceFilter->SetGroundTruthLabelMap(m_GTFilter->GetOutput());
-    m_InstanceFilter->SetMachineSegmentationLabelMap(m_MSFilter->GetOutput());
-    m_InstanceFilter->SetThreshold( GetParameterFloat("th") );
-    m_InstanceFilter->SetHooverMatrix( m_HooverFilter->GetHooverConfusionMatrix() );
-    m_InstanceFilter->SetUseExtendedAttributes(false);
-
-    m_AttributeImageGT = AttributeImageFilterType::New();
-    m_AttributeImageGT->SetInput(m_InstanceFilter->GetOutputGroundTruthLabelMap());
-    m_AttributeImageGT->SetAttributeForNthChannel(0, InstanceFilterType::GetNameFromAttribute(InstanceFilterType::ATTRIBUTE_RC));
-    m_AttributeImageGT->SetAttributeForNthChannel(1, InstanceFilterType::GetNameFromAttribute(InstanceFilterType::ATTRIBUTE_RF));
-    m_AttributeImageGT->SetAttributeForNthChannel(2, InstanceFilterType::GetNameFromAttribute(InstanceFilterType::ATTRIBUTE_RA));
-    m_AttributeImageGT->SetAttributeForNthChannel(3, InstanceFilterType::GetNameFromAttribute(InstanceFilterType::ATTRIBUTE_RM));
-
-    m_AttributeImageMS = AttributeImageFilterType::New();
-    m_AttributeImageMS->SetInput(m_InstanceFilter->GetOutputMachineSegmentationLabelMap());
-    m_AttributeImageMS->SetAttributeForNthChannel(0, InstanceFilterType::GetNameFromAttribute(InstanceFilterType::ATTRIBUTE_RC));
-    m_AttributeImageMS->SetAttributeForNthChannel(1, InstanceFilterType::GetNameFromAttribute(InstanceFilterType::ATTRIBUTE_RF));
-    m_AttributeImageMS->SetAttributeForNthChannel(2, InstanceFilterType::GetNameFromAttribute(InstanceFilterType::ATTRIBUTE_RA));
-    //m_AttributeImageMS->SetAttributeForNthChannel(3, InstanceFilterType::GetNameFromAttribute(InstanceFilterType::ATTRIBUTE_RN);
-
     m_GTColorFilter = HooverColorFilterType::New();
-    m_GTColorFilter->SetInput(m_AttributeImageGT->GetOutput());
+    m_GTColorFilter->SetInput(inputGT);
+    m_GTColorFilter->GetFunctor().SetScores(&m_HooverFilter->GetGroundTruthScores());
 
     m_MSColorFilter = HooverColorFilterType::New();
-    m_MSColorFilter->SetInput(m_AttributeImageMS->GetOutput());
+    m_MSColorFilter->SetInput(inputMS);
+    m_MSColorFilter->GetFunctor().SetScores(&m_HooverFilter->GetMachineSegmentationScores());
 
     Int16PixelType colorPixel;
     colorPixel.SetSize(3);
@@ -295,22 +272,13 @@ private:
       SetParameterOutputImage("outms", m_MSColorFilter->GetOutput());
       }
 
-    m_InstanceFilter->Update();
-
-    SetParameterFloat("rc",m_InstanceFilter->GetMeanRC());
-    SetParameterFloat("rf",m_InstanceFilter->GetMeanRF());
-    SetParameterFloat("ra",m_InstanceFilter->GetMeanRA());
-    SetParameterFloat("rm",m_InstanceFilter->GetMeanRM());
+    SetParameterFloat("rc",m_HooverFilter->GetMeanRC());
+    SetParameterFloat("rf",m_HooverFilter->GetMeanRF());
+    SetParameterFloat("ra",m_HooverFilter->GetMeanRA());
+    SetParameterFloat("rm",m_HooverFilter->GetMeanRM());
   }
 
-  ImageToLabelMapFilterType::Pointer m_GTFilter;
-  ImageToLabelMapFilterType::Pointer m_MSFilter;
-
-  HooverMatrixFilterType::Pointer m_HooverFilter;
-  InstanceFilterType::Pointer m_InstanceFilter;
-
-  AttributeImageFilterType::Pointer m_AttributeImageGT;
-  AttributeImageFilterType::Pointer m_AttributeImageMS;
+  HooverMetricsFilterType::Pointer m_HooverFilter;
 
   HooverColorFilterType::Pointer m_GTColorFilter;
   HooverColorFilterType::Pointer m_MSColorFilter;
@@ -21,26 +21,55 @@
 
 #include "otbMultiChannelExtractROI.h"
 #include "otbExtractROI.h"
-
-#include "otbStreamingStatisticsImageFilter.h"
-#include "otbSystem.h"
+#include "otbRegionAdjacencyGraph.h"
 #include "itkUnaryFunctorImageFilter.h"
-#include "itkChangeLabelImageFilter.h"
-
-#include "otbTileImageFilter.h"
 
 #include <time.h>
 #include <algorithm>
-#include <climits>
+#include <vector>
 
 #include "otbWrapperApplication.h"
 #include "otbWrapperApplicationFactory.h"
 
-#include "otbStandardWriterWatcher.h"
-
 
 namespace otb
 {
+
+namespace Functor
+{
+
+/** \class LabelLookUpTable
+ *  \brief Replaces each label by its value in a look-up table
+ *
+ * \ingroup AppSegmentation
+ */
+template <class TLabel>
+class LabelLookUpTable
+{
+public:
+  void SetLookUpTable(const std::vector<TLabel> & lut) { m_LookUpTable = lut; }
+
+  bool operator!=(const LabelLookUpTable & other) const
+  {
+    return m_LookUpTable != other.m_LookUpTable;
+  }
+
+  bool operator==(const LabelLookUpTable & other) const
+  {
+    return !(*this != other);
+  }
+
+  inline TLabel operator()(const TLabel & label) const
+  {
+    return label < m_LookUpTable.size() ? m_LookUpTable[label] : label;
+  }
+
+private:
+  std::vector<TLabel> m_LookUpTable;
+};
+
+} // end namespace Functor
+
 namespace Wrapper
 {
 class LSMSSmallRegionsMerging : public Application
@@ -59,19 +88,17 @@ public:
   typedef otb::MultiChannelExtractROI <ImagePixelType,ImagePixelType > MultiChannelExtractROIFilterType;
   typedef otb::ExtractROI<LabelImagePixelType,LabelImagePixelType> ExtractROIFilterType;
 
-  typedef otb::StreamingStatisticsImageFilter<LabelImageType> StatisticsImageFilterType;
+  typedef otb::RegionAdjacencyGraph<LabelImagePixelType> RegionAdjacencyGraphType;
+  typedef RegionAdjacencyGraphType::LabelListType         LabelListType;
 
-  typedef itk::ImageRegionConstIterator<LabelImageType> LabelImageIterator;
-  typedef itk::ImageRegionConstIterator<ImageType> ImageIterator;
-
-  typedef itk::ChangeLabelImageFilter<LabelImageType,LabelImageType> ChangeLabelImageFilterType;
-  typedef otb::TileImageFilter<LabelImageType> TileImageFilterType;
+  typedef otb::Functor::LabelLookUpTable<LabelImagePixelType> LookUpTableFunctorType;
+  typedef itk::UnaryFunctorImageFilter<LabelImageType, LabelImageType, LookUpTableFunctorType> RelabelFilterType;
 
   itkNewMacro(Self);
   itkTypeMacro(Merging, otb::Application);
 
 private:
-  ChangeLabelImageFilterType::Pointer m_ChangeLabelFilter;
+  RelabelFilterType::Pointer m_RelabelFilter;
 
   void DoInit() override
   {
@@ -166,35 +193,20 @@ private:
 
     LabelImageType::Pointer labelIn = GetParameterUInt32Image("inseg");
 
-    StatisticsImageFilterType::Pointer stats = StatisticsImageFilterType::New();
-    stats->SetInput(labelIn);
-    stats->GetStreamer()->SetAutomaticAdaptativeStreaming(GetParameterInt("ram"));
-    AddProcess(stats->GetStreamer(), "Retrieve region count...");
-    stats->Update();
-    unsigned int regionCount=stats->GetMaximum();
-
-    std::vector<unsigned int>nbPixels;
-    nbPixels.clear();
-    nbPixels.resize(regionCount+1);
-    for(LabelImagePixelType curLabel = 1; curLabel <= regionCount; ++curLabel)
-      nbPixels[curLabel] = 0;
-
-    ImageType::PixelType defaultValue(numberOfComponentsPerPixel);
-    defaultValue.Fill(0);
-
-    std::vector<ImageType::PixelType>sum(regionCount+1,defaultValue);
-
     unsigned int nbTilesX = sizeImageX/sizeTilesX + (sizeImageX%sizeTilesX > 0 ? 1 : 0);
     unsigned int nbTilesY = sizeImageY/sizeTilesY + (sizeImageY%sizeTilesY > 0 ? 1 : 0);
 
     otbAppLogINFO(<<"Number of tiles: "<<nbTilesX<<" x "<<nbTilesY);
 
-    //Sums calculation per label
-    otbAppLogINFO(<<"Sums calculation ...");
+    //Sums and adjacencies of the labels, tile by tile
+    otbAppLogINFO(<<"Building the region adjacency graph ...");
+
+    RegionAdjacencyGraphType::Pointer graph = RegionAdjacencyGraphType::New();
+    graph->SetNumberOfComponents(numberOfComponentsPerPixel);
 
     for(unsigned int row = 0; row < nbTilesY; row++)
       for(unsigned int column = 0; column < nbTilesX; column++)
-       {
+        {
         unsigned long startX = column*sizeTilesX;
         unsigned long startY = row*sizeTilesY;
         unsigned long sizeX = std::min(sizeTilesX,sizeImageX-startX);
@@ -209,234 +221,52 @@ private:
         imageROI->SetSizeY(sizeY);
         imageROI->Update();
 
-        //Tiles extraction of the segmented image
+        //Tiles extraction of the segmented image, with one more row and
+        //column for the adjacencies with the next tiles
         ExtractROIFilterType::Pointer labelImageROI = ExtractROIFilterType::New();
         labelImageROI->SetInput(labelIn);
         labelImageROI->SetStartX(startX);
         labelImageROI->SetStartY(startY);
-        labelImageROI->SetSizeX(sizeX);
-        labelImageROI->SetSizeY(sizeY);
+        labelImageROI->SetSizeX(std::min(sizeTilesX+1,sizeImageX-startX));
+        labelImageROI->SetSizeY(std::min(sizeTilesY+1,sizeImageY-startY));
         labelImageROI->Update();
 
-        //Sums calculation for the mean calculation per label
-        LabelImageIterator itLabel( labelImageROI->GetOutput(), labelImageROI->GetOutput()->GetLargestPossibleRegion());
-        ImageIterator itImage( imageROI->GetOutput(), imageROI->GetOutput()->GetLargestPossibleRegion());
-
-        for (itLabel.GoToBegin(), itImage.GoToBegin(); !itLabel.IsAtEnd(); ++itLabel, ++itImage)
-          {
-          nbPixels[itLabel.Value()]++;
-          for(unsigned int comp = 0; comp<numberOfComponentsPerPixel; ++comp)
-            {
-            sum[itLabel.Value()][comp]+=itImage.Get()[comp];
-            }
-          }
+        graph->AddLabelImage(labelImageROI->GetOutput(), imageROI->GetOutput(),
+                             imageROI->GetOutput()->GetLargestPossibleRegion());
         }
 
-    //LUT creation for the final relabelling
-    std::vector<LabelImagePixelType> LUT;
-    LUT.clear();
-    LUT.resize(regionCount+1);
-    for(LabelImagePixelType curLabel = 1; curLabel <= regionCount; ++curLabel)
-      {
-      LUT[curLabel] = curLabel;
-      }
+    graph->BuildAdjacency();
+
+    otbAppLogINFO(<<"LUT size: "<<graph->GetNumberOfLabels()<<" labels");
 
     //Minimal size region suppression
     otbAppLogINFO(<<"Building LUT for small regions merging ...");
 
-    for (unsigned int size=1; size<minSize; size++)
+    //The regions are processed by increasing size. The regions of the same
+    //size choose the region to merge with before any of them is merged.
+    graph->MergeSmallRegions(minSize,
+      [&graph, numberOfComponentsPerPixel](LabelImagePixelType curLabel, LabelImagePixelType adjLabel)
       {
-      // LUTtmp creation in order to modify the LUT only at the end of the pass
-      std::vector<LabelImagePixelType> LUTtmp;
-      LUTtmp.clear();
-      LUTtmp.resize(regionCount+1);
-      for(LabelImagePixelType curLabel = 1; curLabel <= regionCount; ++curLabel)
+      double error = 0;
+      for(unsigned int comp = 0; comp<numberOfComponentsPerPixel; ++comp)
         {
-        LUTtmp[curLabel] = LUT[curLabel];
+        double curComp = graph->GetRegionMean(curLabel, comp);
+        // The mean of the adjacent region is truncated, as it always was
+        int tmpComp = static_cast<int>(graph->GetRegionMean(adjLabel, comp));
+        error += (curComp-tmpComp)*(curComp-tmpComp);
         }
+      return error;
+      });
 
-      for(unsigned int row = 0; row < nbTilesY; row++)
-        {
-        for(unsigned int column = 0; column < nbTilesX; column++)
-          {
-          std::set<int> minLabel, edgeLabel, labelMerged;
-          std::map<int,std::set<int> > adjMap;
-
-          unsigned long startX = column*sizeTilesX, startY = row*sizeTilesY;
-          unsigned long sizeX = std::min(sizeTilesX+size+1,sizeImageX-startX),
-            sizeY = std::min(sizeTilesY+size+1,sizeImageY-startY);
-
-          ExtractROIFilterType::Pointer labelImageROI = ExtractROIFilterType::New();
-          labelImageROI->SetInput(labelIn);
-          labelImageROI->SetStartX(startX);
-          labelImageROI->SetStartY(startY);
-          labelImageROI->SetSizeX(sizeX);
-          labelImageROI->SetSizeY(sizeY);
-          labelImageROI->Update();
-
-          LabelImageType::IndexType pixelIndex;
-
-          //"Adjacency map" creation for the region with nbPixels=="size"
-          for(pixelIndex[0]=0; pixelIndex[0]<static_cast<long>(sizeX); ++pixelIndex[0])
-            for(pixelIndex[1]=0; pixelIndex[1]<static_cast<long>(sizeY); ++pixelIndex[1])
-              {
-              LabelImagePixelType curLabel = labelImageROI->GetOutput()->GetPixel(pixelIndex);
-
-              if(labelMerged.count(LUT[curLabel]))
-                {
-                edgeLabel.insert(LUT[curLabel]);
-                }
-              if((pixelIndex[0]==0)&&(startX!=0))
-                {
-                edgeLabel.insert(LUT[curLabel]);
-                }
-              if((pixelIndex[1]==0)&&(startY!=0))
-                {
-                edgeLabel.insert(LUT[curLabel]);
-                }
-
-              if(pixelIndex[0]==static_cast<long>(sizeX)-1)
-                {
-                if(startX!=(nbTilesX-1)*sizeTilesX) edgeLabel.insert(LUT[curLabel]);
-                }
-              else
-                {
-                ++pixelIndex[0];
-                LabelImagePixelType adjLabelX = labelImageROI->GetOutput()->GetPixel(pixelIndex);
-                --pixelIndex[0];
-
-                if(LUT[adjLabelX]!=LUT[curLabel])
-                  {
-                  if((nbPixels[LUT[curLabel]]>0)&&(nbPixels[LUT[curLabel]]==size))
-                    {
-                    adjMap[LUT[curLabel]].insert(LUT[adjLabelX]);
-                    minLabel.insert(LUT[curLabel]);
-                    }
-                  if((nbPixels[LUT[adjLabelX]]>0)&&(nbPixels[LUT[adjLabelX]]==size))
-                    {
-                    adjMap[LUT[adjLabelX]].insert(LUT[curLabel]);
-                    minLabel.insert(LUT[adjLabelX]);
-                    }
-                  }
-                }
-              if(pixelIndex[1]==static_cast<long>(sizeY)-1)
-                {
-                if(startY!=(nbTilesY-1)*sizeTilesY) edgeLabel.insert(LUT[curLabel]);
-                }
-              else
-                {
-                ++pixelIndex[1];
-                LabelImagePixelType adjLabelY = labelImageROI->GetOutput()->GetPixel(pixelIndex);
-                --pixelIndex[1];
-                if(LUT[adjLabelY]!=LUT[curLabel])
-                  {
-                  if((nbPixels[LUT[curLabel]]>0)&&(nbPixels[LUT[curLabel]]==size))
-                    {
-                    adjMap[LUT[curLabel]].insert(LUT[adjLabelY]);
-                    minLabel.insert(LUT[curLabel]);
-                    }
-                  if((nbPixels[LUT[adjLabelY]]>0)&&(nbPixels[LUT[adjLabelY]]==size))
-                    {
-                    adjMap[LUT[adjLabelY]].insert(LUT[curLabel]);
-                    minLabel.insert(LUT[adjLabelY]); }
-                  }
-                }
-              }
-
-          //Searching the "nearest" region
-          for(std::set<int>::iterator itMinLabel=minLabel.begin(); itMinLabel!=minLabel.end(); ++itMinLabel)
-            {
-            LabelImagePixelType curLabel = *itMinLabel, adjLabel(0);
-            double err = itk::NumericTraits<double>::max();
-            if(edgeLabel.count(curLabel)==0)
-              {
-              if(nbPixels[curLabel]==size)
-                {
-                edgeLabel.insert(curLabel);
-                for(std::set<int>::iterator itAdjLabel=(adjMap[curLabel]).begin();
-                    itAdjLabel!=(adjMap[curLabel]).end(); ++itAdjLabel)
-                  {
-                  double tmpError = 0;
-                  LabelImagePixelType tmpLabel = *itAdjLabel;
-                  if(tmpLabel!=curLabel)
-                    {
-                    for(unsigned int comp = 0; comp<numberOfComponentsPerPixel; ++comp)
-                      {
-                      double curComp = static_cast<double>(sum[curLabel][comp])/nbPixels[curLabel];
-                      int tmpComp = static_cast<double>(sum[tmpLabel][comp])/nbPixels[tmpLabel];
-                      tmpError += (curComp-tmpComp)*(curComp-tmpComp);
-                      }
-                    if(tmpError<err)
-                      {
-                      err = tmpError;
-                      adjLabel = tmpLabel;
-                      }
-                    }
-                  }
-
-                //Fusion of the two regions
-                if(adjLabel!=curLabel)
-                  {
-                  unsigned int curLabelLUT = curLabel, adjLabelLUT = adjLabel;
-                  while(LUTtmp[curLabelLUT] != curLabelLUT)
-                    {
-                    curLabelLUT = LUTtmp[curLabelLUT];
-                    }
-                  while(LUTtmp[adjLabelLUT] != adjLabelLUT)
-                    {
-                    adjLabelLUT = LUTtmp[adjLabelLUT];
-                    }
-                  if(curLabelLUT < adjLabelLUT)
-                    {
-                    LUTtmp[adjLabelLUT] = curLabelLUT;
-                    }
-                  else
-                    {
-                    LUTtmp[LUTtmp[curLabelLUT]] = adjLabelLUT; LUTtmp[curLabelLUT] = adjLabelLUT;
-                    }
-                  }
-                }
-              }
-            }
-
-          for(LabelImagePixelType label = 1; label < regionCount+1; ++label)
-            {
-            LabelImagePixelType can = label;
-            while(LUTtmp[can] != can)
-              {
-              can = LUTtmp[can];
-              }
-            LUTtmp[label] = can;
-            }
-          }
-        }
-
-      for(LabelImagePixelType label = 1; label < regionCount+1; ++label)
-        {
-        LUT[label]=LUTtmp[label];
-        if((nbPixels[label]!=0)&&(LUT[label]!=label))
-          {
-          nbPixels[LUT[label]]+=nbPixels[label];
-          nbPixels[label]=0;
-          for(unsigned int comp = 0; comp<numberOfComponentsPerPixel; ++comp)
-            {
-            sum[LUT[label]][comp]+=sum[label][comp];
-            }
-          }
-        }
-      }
     //Relabelling
-    m_ChangeLabelFilter = ChangeLabelImageFilterType::New();
-    m_ChangeLabelFilter->SetInput(labelIn);
-    for(LabelImagePixelType label = 1; label<regionCount+1; ++label)
-      {
-      if(label!=LUT[label])
-        {
-        m_ChangeLabelFilter->SetChange(label,LUT[label]);
-        }
-      }
+    LabelListType LUT;
+    graph->GetRegionLabels(LUT);
+
+    m_RelabelFilter = RelabelFilterType::New();
+    m_RelabelFilter->SetInput(labelIn);
+    m_RelabelFilter->GetFunctor().SetLookUpTable(LUT);
 
-    SetParameterOutputImage("out", m_ChangeLabelFilter->GetOutput());
+    SetParameterOutputImage("out", m_RelabelFilter->GetOutput());
 
     clock_t toc = clock();
 
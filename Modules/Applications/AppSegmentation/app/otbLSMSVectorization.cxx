@@ -25,7 +25,7 @@
 #include "otbExtractROI.h"
 
 #include "otbStreamingStatisticsImageFilter.h"
-#include "otbLabelImageToOGRDataSourceFilter.h"
+#include "otbStreamingLabelImageVectorizationFilter.h"
 #include "otbOGRFeatureWrapper.h"
 
 #include <time.h>
@@ -58,7 +58,7 @@ public:
   typedef itk::ImageRegionConstIterator<LabelImageType> LabelImageIterator;
   typedef itk::ImageRegionConstIterator<ImageType> ImageIterator;
 
-  typedef otb::LabelImageToOGRDataSourceFilter<LabelImageType> LabelImageToOGRDataSourceFilterType;
+  typedef otb::StreamingLabelImageVectorizationFilter<LabelImageType> VectorizationFilterType;
 
 
   itkNewMacro(Self);
@@ -78,8 +78,9 @@ private:
                           " convert it to a GIS vector file containing one polygon per"
                           " segment. Each polygon contains additional fields: mean and variance of"
                           " each channels from input image (in parameter), segmentation image"
-                          " label, number of pixels in the polygon. For large images one can use"
-                          " the tilesizex and tilesizey parameters for tile-wise processing, with"
+                          " label, number of pixels in the polygon. The statistics are computed"
+                          " tile-wise, according to the tilesizex and tilesizey parameters, and the"
+                          " polygons are traced strip-wise, according to the available RAM, with"
                           " the guarantees of identical results.");
     SetDocLimitations("This application is part of the Large-Scale Mean-Shift segmentation workflow (LSMS) and may not be suited for any other purpose.");
     SetDocAuthors("David Youssefi");
@@ -208,8 +209,8 @@ private:
     layer.CreateField(field, true);
     }
 
-    //Vectorization per tile
-    otbAppLogINFO(<<"Vectorization ...");
+    //Statistics per tile
+    otbAppLogINFO(<<"Computing statistics ...");
     for(unsigned int row = 0; row < nbTilesY; row++)
       {
       for(unsigned int column = 0; column < nbTilesX; column++)
@@ -249,94 +250,41 @@ private:
             sum2[itLabel.Value()][comp]+=itImage.Get()[comp]*itImage.Get()[comp];
             }
           }
-
-        labelImageROI = ExtractROIFilterType::New();
-        labelImageROI->SetInput(labelIn);
-        labelImageROI->SetStartX(startX);
-        labelImageROI->SetStartY(startY);
-        labelImageROI->SetSizeX(sizeX+1);
-        labelImageROI->SetSizeY(sizeY+1);
-        labelImageROI->Update();
-
-        //Raster->Vecteur conversion
-        LabelImageToOGRDataSourceFilterType::Pointer labelToOGR = LabelImageToOGRDataSourceFilterType::New();
-        labelToOGR->SetInput(labelImageROI->GetOutput());
-        labelToOGR->SetInputMask(labelImageROI->GetOutput());
-        labelToOGR->SetFieldName("label");
-        labelToOGR->Update();
-
-        otb::ogr::DataSource::ConstPointer ogrDSTmp = labelToOGR->GetOutput();
-        otb::ogr::Layer layerTmp = ogrDSTmp->GetLayerChecked(0);
-
-        otb::ogr::Layer::const_iterator featIt = layerTmp.begin();
-        for(; featIt!=layerTmp.end(); ++featIt)
-          {
-          otb::ogr::Feature dstFeature(layer.GetLayerDefn());
-          dstFeature.SetFrom( *featIt, TRUE );
-          layer.CreateFeature( dstFeature );
-          }
        }
       }
 
-    //Sorting by increasing label of the features
-    std::ostringstream sqloss;
-    sqloss.str("");
-    sqloss<<"SELECT * FROM \""<<layername<<"\" ORDER BY label";
-    otb::ogr::Layer layerTmp=ogrDS->ExecuteSQL(sqloss.str().c_str(), nullptr, nullptr);
-    otb::ogr::Feature firstFeature = layerTmp.ogr().GetNextFeature();
+    //Raster->Vector conversion, the polygons being stitched across the strips
+    VectorizationFilterType::Pointer vectorization = VectorizationFilterType::New();
+    vectorization->SetInput(labelIn);
+    vectorization->SetOGRLayer(layer);
+    vectorization->SetFieldName("label");
+    vectorization->SetBackgroundValue(0);
+    vectorization->SetUseBackgroundValue(true);
+    vectorization->GetStreamer()->SetAutomaticStrippedStreaming(GetParameterInt("ram"));
+    AddProcess(vectorization->GetStreamer(), "Vectorization...");
+    vectorization->Update();
+    otbAppLogINFO(<<vectorization->GetNumberOfPolygons()<<" polygons written");
+
+    //Features calculation
+    OGRErr err = layer.ogr().StartTransaction();
+    if (err != OGRERR_NONE)
+    {
+    itkExceptionMacro(<< "Unable to start transaction for OGR layer " << layer.ogr().GetName() << ".");
+    }
 
-    //Geometry fusion
-    otbAppLogINFO("Merging polygons across tiles ...");
-    while(firstFeature.addr())
+    layer.ogr().ResetReading();
+    for(otb::ogr::Feature feature = layer.ogr().GetNextFeature(); feature.addr(); feature = layer.ogr().GetNextFeature())
       {
-      LabelImagePixelType curLabel = firstFeature.ogr().GetFieldAsInteger("label");
-
-      //Creation of a multipolygon where are stored the geometries to be merged
-      OGRMultiPolygon geomToMerge;
-      geomToMerge.addGeometry(firstFeature.GetGeometry());
-      bool merging = true;
-      otb::ogr::Feature nextFeature(nullptr);
-      bool haveMerged=false;
-
-      while(merging)
-        {
-        nextFeature = layerTmp.ogr().GetNextFeature();
+      LabelImagePixelType curLabel = feature.ogr().GetFieldAsInteger("label");
 
-        if(nextFeature.addr())
-          {
-          LabelImagePixelType newLabel = nextFeature.ogr().GetFieldAsInteger("label");
-          merging=(newLabel==curLabel);
-
-          //Storing of the new geometry if labels are identical
-          if(merging)
-            {
-            geomToMerge.addGeometry(nextFeature.GetGeometry());
-            layer.DeleteFeature(nextFeature.GetFID());
-            haveMerged=true;
-            }
-          //If storing made and new label -> polygons fusion
-          else if(haveMerged)
-            {
-            otb::ogr::UniqueGeometryPtr fusionPolygon = otb::ogr::UnionCascaded(geomToMerge);
-            firstFeature.SetGeometry(fusionPolygon.get());
-            }
-          }
-        //If end of list : end of loop
-        else
-          {
-          merging=false;
-          }
-        }
-
-      //Features calculation
       //Number of pixels per label
-      firstFeature.ogr().SetField("nbPixels",nbPixels[curLabel]);
+      feature.ogr().SetField("nbPixels",nbPixels[curLabel]);
 
       //Radiometric means per label
       for(unsigned int comp = 0; comp<numberOfComponentsPerPixel; ++comp){
       std::ostringstream fieldoss;
       fieldoss<<"meanB"<<comp;
-      firstFeature.ogr().SetField(fieldoss.str().c_str(),sum[curLabel][comp]/nbPixels[curLabel]);
+      feature.ogr().SetField(fieldoss.str().c_str(),sum[curLabel][comp]/nbPixels[curLabel]);
       }
 
       //Variances per label
@@ -346,32 +294,19 @@ private:
       float var = 0;
       if (nbPixels[curLabel]!=1)
         var = (sum2[curLabel][comp]-sum[curLabel][comp]*sum[curLabel][comp]/nbPixels[curLabel])/(nbPixels[curLabel]-1);
-      firstFeature.ogr().SetField(fieldoss.str().c_str(),var);
+      feature.ogr().SetField(fieldoss.str().c_str(),var);
       }
 
-      //Geometries simplification
-      otb::ogr::UniqueGeometryPtr geom = otb::ogr::Simplify(*firstFeature.GetGeometry(),0);
-      firstFeature.SetGeometryDirectly(otb::ogr::Simplify(*geom,0));
-
-      layer.SetFeature(firstFeature);
-
-      //Next geometry
-      firstFeature=nextFeature;
+      layer.SetFeature(feature);
       }
 
-    const OGRErr err = layer.ogr().CommitTransaction();
+    err = layer.ogr().CommitTransaction();
 
     if (err != OGRERR_NONE)
     {
     itkExceptionMacro(<< "Unable to commit transaction for OGR layer " << layer.ogr().GetName() << ".");
     }
 
-    if(extension==".shp"){
-    sqloss.str("");
-    sqloss<<"REPACK "<<layername;
-    ogrDS->ogr().ExecuteSQL(sqloss.str().c_str(), nullptr, nullptr);
-    }
-
     ogrDS->SyncToDisk();
 
     clock_t toc = clock();
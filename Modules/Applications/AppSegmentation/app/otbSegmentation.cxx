@@ -26,6 +26,7 @@
 // Segmentation filters includes
 #include "otbMeanShiftSegmentationFilter.h"
 #include "otbConnectedComponentMuParserFunctor.h"
+#include "otbTiledConnectedComponentFunctorImageFilter.h"
 #include "otbMaskMuParserFilter.h"
 #include "otbVectorImageToAmplitudeImageFilter.h"
 #include "itkGradientMagnitudeImageFilter.h"
@@ -79,6 +80,12 @@ public:
    FunctorType,
    MaskImageType >                        ConnectedComponentSegmentationFilterType;
 
+  typedef otb::TiledConnectedComponentFunctorImageFilter
+  <FloatVectorImageType,
+   LabelImageType,
+   FunctorType,
+   MaskImageType >                        TiledConnectedComponentSegmentationFilterType;
+
   typedef itk::ScalarConnectedComponentImageFilter
   <LabelImageType,
    LabelImageType>                        LabeledConnectedComponentSegmentationFilterType;
@@ -157,7 +164,7 @@ private:
                           " (i.e. remove nodes in polygons) according to a user-defined tolerance. The stitch option tries to stitch together the polygons corresponding"
                           " to segmented region that may have been split by the tiling scheme. ");
 
-    SetDocLimitations("In raster mode, the application can not handle large input images. Stitching step of vector mode might become slow with very large input images."
+    SetDocLimitations("In raster mode, the application can not handle large input images, except with the connected components filter. Stitching step of vector mode might become slow with very large input images."
                      " \nMeanShift filter results depends on the number of threads used. \nWatershed and multiscale geodesic morphology segmentation will be performed on the amplitude "
                      " of the input image.");
 
@@ -232,7 +239,7 @@ private:
     SetParameterDescription("mode.vector","In this mode, the application will output a vector file or database, and process the input image piecewise. This allows performing segmentation of very large images.");
 
     AddChoice("mode.raster", "Standard segmentation with labeled raster output");
-    SetParameterDescription("mode.raster","In this mode, the application will output a standard labeled raster. This mode can not handle large data.");
+    SetParameterDescription("mode.raster","In this mode, the application will output a standard labeled raster. This mode can not handle large data, except with the connected components filter, which is streamed.");
 
     // GeoMorpho
     AddChoice("filter.mprofiles","Morphological profiles based segmentation");
@@ -558,7 +565,20 @@ private:
     // The actual stream size used
     FloatVectorImageType::SizeType streamSize;
 
-    if (segType == "cc")
+    if (segType == "cc" && segModeType == "raster")
+      {
+      otbAppLogINFO(<<"Use tiled connected component segmentation."<<std::endl);
+      DisableParameter("mode.vector.out");
+      EnableParameter("mode.raster.out");
+
+      // Streamed by the output writer, with consistent labels across tiles
+      m_TiledCCFilter = TiledConnectedComponentSegmentationFilterType::New();
+      m_TiledCCFilter->SetInput(this->GetParameterFloatVectorImage("in"));
+      m_TiledCCFilter->GetFunctor().SetExpression(GetParameterString("filter.cc.expr"));
+      SetParameterOutputImage<UInt32ImageType>("mode.raster.out", m_TiledCCFilter->GetOutput());
+      return;
+      }
+    else if (segType == "cc")
       {
       otbAppLogINFO(<<"Use connected component segmentation."<<std::endl);
       ConnectedComponentStreamingVectorizedSegmentationOGRType::Pointer
@@ -702,6 +722,7 @@ private:
   }
 
   ClampFilterType::Pointer m_ClampFilter;
+  TiledConnectedComponentSegmentationFilterType::Pointer m_TiledCCFilter;
 };
 }
 }
@@ -103,6 +103,29 @@ public:
    * 
    */
   static itk::LoggerBase::PriorityLevelType GetLoggerLevel();
+
+  /**
+   * MaxCachedModels is the number of machine learning models that can
+   * be kept in memory after being loaded for prediction, so that a
+   * process running the same classification several times reads the
+   * model file only once.
+   *
+   * If environment variable OTB_MAX_CACHED_MODELS is defined and could
+   * be converted to int, return its content.
+   * Else, returns default value, which is 0 (no cache)
+   */
+  static unsigned int GetMaxCachedModels();
+
+  /**
+   * GeometryCacheDirectory is a directory where the sensor geometries
+   * parsed from product metadata, and the estimated RPC models, are
+   * stored so that a later run on the same product reuses them.
+   *
+   * If environment variable OTB_GEOMETRY_CACHE_DIRECTORY is defined,
+   * returns it contents as a string
+   * Else, returns an empty string (no cache)
+   */
+  static std::string GetGeometryCacheDirectory();
  
   
 private:
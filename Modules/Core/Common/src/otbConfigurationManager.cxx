@@ -46,6 +46,13 @@ std::string ConfigurationManager::GetGeoidFile()
   return svalue;
 }
 
+std::string ConfigurationManager::GetGeometryCacheDirectory()
+{
+  std::string svalue;
+  itksys::SystemTools::GetEnv("OTB_GEOMETRY_CACHE_DIRECTORY",svalue);
+  return svalue;
+}
+
 ConfigurationManager::RAMValueType ConfigurationManager::GetMaxRAMHint()
 {
   std::string svalue;
@@ -66,6 +73,20 @@ ConfigurationManager::RAMValueType ConfigurationManager::GetMaxRAMHint()
   return value;
 }
 
+unsigned int ConfigurationManager::GetMaxCachedModels()
+{
+  std::string svalue;
+
+  unsigned int value = 0;
+
+  if(itksys::SystemTools::GetEnv("OTB_MAX_CACHED_MODELS",svalue))
+    {
+    value = static_cast<unsigned int>(strtoul(svalue.c_str(),nullptr,10));
+    }
+
+  return value;
+}
+
 itk::LoggerBase::PriorityLevelType ConfigurationManager::GetLoggerLevel()
 {
   std::string svalue;
@@ -26,6 +26,9 @@
 #include "otbMath.h"
 
 #include "otbVectorImage.h"
+#include "otbSmallBuffer.h"
+
+#include <vector>
 
 namespace otb
 {
@@ -101,6 +104,14 @@ public:
   virtual void SetAlpha(double alpha);
   virtual double GetAlpha() const;
 
+  /** Set/Get the number of tabulated subpixel positions. When it is not
+   * null, the coefficients are computed once for this number of regularly
+   * spaced positions between two pixels, and each evaluation uses the
+   * coefficients of the nearest position instead of computing them. The
+   * default value 0 computes the exact coefficients at each evaluation. */
+  virtual void SetNumberOfSubpixelPositions(unsigned int positions);
+  virtual unsigned int GetNumberOfSubpixelPositions() const;
+
   /** Evaluate the function at a ContinuousIndex position
    *
    * Returns the linearly interpolated image intensity at a
@@ -112,11 +123,24 @@ public:
   OutputType EvaluateAtContinuousIndex( const ContinuousIndexType & index ) const override = 0;
 
 protected:
-  BCOInterpolateImageFunctionBase() : m_Radius(2), m_WinSize(5), m_Alpha(-0.5) {};
+  BCOInterpolateImageFunctionBase() : m_Radius(2), m_WinSize(5), m_Alpha(-0.5), m_NumberOfSubpixelPositions(0) {};
   ~BCOInterpolateImageFunctionBase() override {};
   void PrintSelf(std::ostream& os, itk::Indent indent) const override;
   /** Compute the BCO coefficients. */
   virtual CoefContainerType EvaluateCoef( const ContinuousIndexValueType & indexValue ) const;
+
+  /** Compute the m_WinSize BCO coefficients in coef, from the table when
+   * subpixel positions are tabulated */
+  void ComputeCoef( const ContinuousIndexValueType & indexValue, double * coef ) const;
+
+  /** Compute the m_WinSize indices of the window along dimension dim,
+   * clamped to the buffered region */
+  void ComputeNeighborIndices( IndexValueType baseIndex, unsigned int dim, IndexValueType * neighIndex ) const;
+
+  /** Windows up to this size (radius 16) and pixels up to this number of
+   * components are evaluated without heap allocation */
+  static const unsigned int StackWindowSize = 33;
+  static const unsigned int StackComponents = 16;
   
     /** Used radius for the BCO */
   unsigned int           m_Radius;
@@ -126,6 +150,17 @@ protected:
   double                 m_Alpha;
 
 private:
+  /** Compute the normalized coefficients for an offset in [-0.5, 0.5] */
+  void ComputeExactCoef( double offset, double * coef ) const;
+
+  /** Fill the coefficients table */
+  void UpdateCoefTable();
+
+  /** Number of tabulated subpixel positions */
+  unsigned int           m_NumberOfSubpixelPositions;
+  /** Coefficients of the tabulated positions, m_WinSize per position */
+  std::vector<double>    m_CoefTable;
+
   BCOInterpolateImageFunctionBase( const Self& ) = delete;
   void operator=( const Self& ) = delete;
 
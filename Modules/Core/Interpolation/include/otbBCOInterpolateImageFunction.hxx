@@ -25,6 +25,8 @@
 
 #include "itkNumericTraits.h"
 
+#include <algorithm>
+
 namespace otb
 {
 
@@ -35,6 +37,7 @@ void BCOInterpolateImageFunctionBase<TInputImage, TCoordRep>
   Superclass::PrintSelf(os, indent);
   os << indent << "Radius: " << m_Radius << std::endl;
   os << indent << "Alpha: " << m_Alpha << std::endl;
+  os << indent << "NumberOfSubpixelPositions: " << m_NumberOfSubpixelPositions << std::endl;
 }
 
 template <class TInputImage, class TCoordRep>
@@ -49,6 +52,7 @@ void BCOInterpolateImageFunctionBase<TInputImage, TCoordRep>
     {
     m_Radius = radius;
     m_WinSize = 2*m_Radius+1;
+    this->UpdateCoefTable();
     }
 }
 
@@ -64,6 +68,7 @@ void BCOInterpolateImageFunctionBase<TInputImage, TCoordRep>
 ::SetAlpha(double alpha)
 {
   m_Alpha = alpha;
+  this->UpdateCoefTable();
 }
 
 template <class TInputImage, class TCoordRep>
@@ -73,18 +78,44 @@ double BCOInterpolateImageFunctionBase<TInputImage, TCoordRep>
   return m_Alpha;
 }
 
-template<class TInputImage, class TCoordRep>
-typename BCOInterpolateImageFunctionBase< TInputImage, TCoordRep >
-::CoefContainerType
-BCOInterpolateImageFunctionBase<TInputImage, TCoordRep>
-::EvaluateCoef( const ContinuousIndexValueType & indexValue ) const
+template <class TInputImage, class TCoordRep>
+void BCOInterpolateImageFunctionBase<TInputImage, TCoordRep>
+::SetNumberOfSubpixelPositions(unsigned int positions)
 {
-  // Init BCO coefficient container
+  m_NumberOfSubpixelPositions = positions;
+  this->UpdateCoefTable();
+}
 
-  CoefContainerType BCOCoef(m_WinSize, 0.);
-  double offset, dist, position, step;
+template <class TInputImage, class TCoordRep>
+unsigned int BCOInterpolateImageFunctionBase<TInputImage, TCoordRep>
+::GetNumberOfSubpixelPositions() const
+{
+  return m_NumberOfSubpixelPositions;
+}
+
+template <class TInputImage, class TCoordRep>
+void BCOInterpolateImageFunctionBase<TInputImage, TCoordRep>
+::UpdateCoefTable()
+{
+  m_CoefTable.clear();
+  if (m_NumberOfSubpixelPositions > 0)
+    {
+    // Positions from offset -0.5 to 0.5 included
+    m_CoefTable.resize((m_NumberOfSubpixelPositions + 1) * m_WinSize);
+    for (unsigned int p = 0; p <= m_NumberOfSubpixelPositions; ++p)
+      {
+      const double offset = static_cast<double>(p) / m_NumberOfSubpixelPositions - 0.5;
+      this->ComputeExactCoef(offset, &m_CoefTable[p * m_WinSize]);
+      }
+    }
+  this->Modified();
+}
 
-  offset = indexValue - itk::Math::Floor<IndexValueType>(indexValue+0.5);
+template <class TInputImage, class TCoordRep>
+void BCOInterpolateImageFunctionBase<TInputImage, TCoordRep>
+::ComputeExactCoef(double offset, double * coef) const
+{
+  double dist, position, step;
 
   // Compute BCO coefficients
   step = 4./static_cast<double>(2*m_Radius);
@@ -102,30 +133,83 @@ BCOInterpolateImageFunctionBase<TInputImage, TCoordRep>
       {
       if (dist <= 1.)
         {
-        BCOCoef[i] = (m_Alpha + 2.)*std::abs(dist * dist * dist)
+        coef[i] = (m_Alpha + 2.)*std::abs(dist * dist * dist)
           - (m_Alpha + 3.)*dist*dist + 1;
         }
       else
         {
-        BCOCoef[i] = m_Alpha*std::abs(dist * dist * dist) - 5
+        coef[i] = m_Alpha*std::abs(dist * dist * dist) - 5
           *m_Alpha*dist*dist + 8*m_Alpha*std::abs(dist) - 4*m_Alpha;
         }
       }
     else
       {
-      BCOCoef[i] = 0;
+      coef[i] = 0;
       }
 
-    sum += BCOCoef[i];
+    sum += coef[i];
     position += step;
     }
 
   for ( unsigned int i = 0; i < m_WinSize; ++i)
-    BCOCoef[i] = BCOCoef[i] / sum;
+    coef[i] = coef[i] / sum;
+}
+
+template<class TInputImage, class TCoordRep>
+typename BCOInterpolateImageFunctionBase< TInputImage, TCoordRep >
+::CoefContainerType
+BCOInterpolateImageFunctionBase<TInputImage, TCoordRep>
+::EvaluateCoef( const ContinuousIndexValueType & indexValue ) const
+{
+  // Init BCO coefficient container
+  CoefContainerType BCOCoef(m_WinSize, 0.);
+
+  double offset = indexValue - itk::Math::Floor<IndexValueType>(indexValue+0.5);
+  this->ComputeExactCoef(offset, BCOCoef.data_block());
 
   return BCOCoef;
 }
 
+template<class TInputImage, class TCoordRep>
+void
+BCOInterpolateImageFunctionBase<TInputImage, TCoordRep>
+::ComputeCoef( const ContinuousIndexValueType & indexValue, double * coef ) const
+{
+  double offset = indexValue - itk::Math::Floor<IndexValueType>(indexValue+0.5);
+
+  if (m_CoefTable.empty())
+    {
+    this->ComputeExactCoef(offset, coef);
+    }
+  else
+    {
+    // Nearest tabulated position
+    unsigned int p = static_cast<unsigned int>((offset + 0.5) * m_NumberOfSubpixelPositions + 0.5);
+    p = std::min(p, m_NumberOfSubpixelPositions);
+    std::copy(&m_CoefTable[p * m_WinSize], &m_CoefTable[p * m_WinSize] + m_WinSize, coef);
+    }
+}
+
+template<class TInputImage, class TCoordRep>
+void
+BCOInterpolateImageFunctionBase<TInputImage, TCoordRep>
+::ComputeNeighborIndices( IndexValueType baseIndex, unsigned int dim, IndexValueType * neighIndex ) const
+{
+  for (unsigned int i = 0; i < m_WinSize; ++i)
+    {
+    IndexValueType index = baseIndex + i - m_Radius;
+    if( index > this->m_EndIndex[dim] )
+      {
+      index = this->m_EndIndex[dim];
+      }
+    if( index < this->m_StartIndex[dim] )
+      {
+      index = this->m_StartIndex[dim];
+      }
+    neighIndex[i] = index;
+    }
+}
+
 template <class TInputImage, class TCoordRep>
 void BCOInterpolateImageFunction<TInputImage, TCoordRep>
 ::PrintSelf(std::ostream& os, itk::Indent indent) const
@@ -139,49 +223,36 @@ typename BCOInterpolateImageFunction< TInputImage, TCoordRep >
 BCOInterpolateImageFunction<TInputImage, TCoordRep>
 ::EvaluateAtContinuousIndex( const ContinuousIndexType & index ) const
 {
+  const unsigned int winSize = this->m_WinSize;
 
-  unsigned int dim;
-
-  IndexType baseIndex;
   IndexType neighIndex;
 
   RealType value = itk::NumericTraits<RealType>::Zero;
 
-  CoefContainerType BCOCoefX = this->EvaluateCoef(index[0]);
-  CoefContainerType BCOCoefY = this->EvaluateCoef(index[1]);
+  // Coefficients and clamped window indices are separable: they are
+  // computed once along each dimension
+  SmallBuffer<double, 2 * Superclass::StackWindowSize> BCOCoef(2 * winSize);
+  double * BCOCoefX = BCOCoef.data();
+  double * BCOCoefY = BCOCoefX + winSize;
+  this->ComputeCoef(index[0], BCOCoefX);
+  this->ComputeCoef(index[1], BCOCoefY);
 
   // Compute base index = closet index
-  for( dim = 0; dim < ImageDimension; dim++ )
-    {
-    baseIndex[dim] = itk::Math::Floor< IndexValueType >( index[dim]+0.5 );
-    }
-
-  for(unsigned int i = 0; i < this->m_WinSize; ++i )
+  SmallBuffer<IndexValueType, 2 * Superclass::StackWindowSize> neighIndices(2 * winSize);
+  IndexValueType * neighX = neighIndices.data();
+  IndexValueType * neighY = neighX + winSize;
+  this->ComputeNeighborIndices(itk::Math::Floor< IndexValueType >( index[0]+0.5 ), 0, neighX);
+  this->ComputeNeighborIndices(itk::Math::Floor< IndexValueType >( index[1]+0.5 ), 1, neighY);
+
+  const InputImageType * image = this->GetInputImage();
+  for(unsigned int i = 0; i < winSize; ++i )
     {
     RealType lineRes = 0.;
-    for(unsigned int j = 0; j < this->m_WinSize; ++j )
+    neighIndex[0] = neighX[i];
+    for(unsigned int j = 0; j < winSize; ++j )
       {
-      // get neighbor index
-      neighIndex[0] = baseIndex[0] + i - this->m_Radius;
-      neighIndex[1] = baseIndex[1] + j - this->m_Radius;
-
-      if( neighIndex[0] > this->m_EndIndex[0] )
-        {
-        neighIndex[0] = this->m_EndIndex[0];
-        }
-      if( neighIndex[0] < this->m_StartIndex[0] )
-        {
-        neighIndex[0] = this->m_StartIndex[0];
-        }
-      if( neighIndex[1] > this->m_EndIndex[1] )
-        {
-        neighIndex[1] = this->m_EndIndex[1];
-        }
-      if( neighIndex[1] < this->m_StartIndex[1] )
-        {
-        neighIndex[1] = this->m_StartIndex[1];
-        }
-      lineRes += static_cast<RealType>( this->GetInputImage()->GetPixel( neighIndex ) ) * BCOCoefY[j];
+      neighIndex[1] = neighY[j];
+      lineRes += static_cast<RealType>( image->GetPixel( neighIndex ) ) * BCOCoefY[j];
       }
     value += lineRes*BCOCoefX[i];
     }
@@ -205,61 +276,58 @@ BCOInterpolateImageFunction< otb::VectorImage<TPixel, VImageDimension> , TCoordR
 {
   typedef typename itk::NumericTraits<InputPixelType>::ScalarRealType ScalarRealType;
 
+  const InputImageType * image = this->GetInputImage();
+  const unsigned int winSize = this->m_WinSize;
+  const unsigned int componentNumber = image->GetNumberOfComponentsPerPixel();
 
-  unsigned int dim;
-  unsigned int componentNumber = this->GetInputImage()->GetNumberOfComponentsPerPixel();
-
-  IndexType baseIndex;
-  IndexType neighIndex;
-
-
-  std::vector<ScalarRealType> lineRes(componentNumber);
+  SmallBuffer<ScalarRealType, Superclass::StackComponents> lineRes(componentNumber);
   OutputType output(componentNumber);
   output.Fill(itk::NumericTraits<ScalarRealType>::Zero);
 
-  CoefContainerType BCOCoefX = this->EvaluateCoef(index[0]);
-  CoefContainerType BCOCoefY = this->EvaluateCoef(index[1]);
-
-  //Compute base index = closet index
-  for( dim = 0; dim < ImageDimension; dim++ )
+  // Coefficients and clamped window indices are separable: they are
+  // computed once along each dimension
+  SmallBuffer<double, 2 * Superclass::StackWindowSize> BCOCoef(2 * winSize);
+  double * BCOCoefX = BCOCoef.data();
+  double * BCOCoefY = BCOCoefX + winSize;
+  this->ComputeCoef(index[0], BCOCoefX);
+  this->ComputeCoef(index[1], BCOCoefY);
+
+  SmallBuffer<IndexValueType, 2 * Superclass::StackWindowSize> neighIndices(2 * winSize);
+  IndexValueType * neighX = neighIndices.data();
+  IndexValueType * neighY = neighX + winSize;
+  this->ComputeNeighborIndices(itk::Math::Floor< IndexValueType >( index[0]+0.5 ), 0, neighX);
+  this->ComputeNeighborIndices(itk::Math::Floor< IndexValueType >( index[1]+0.5 ), 1, neighY);
+
+  // The components of a pixel are contiguous in the buffer: read them
+  // directly instead of building a pixel for each neighbor
+  const TPixel * buffer = image->GetBufferPointer();
+  const IndexType bufferStart = image->GetBufferedRegion().GetIndex();
+  const typename InputImageType::OffsetValueType * offsetTable = image->GetOffsetTable();
+  SmallBuffer<typename InputImageType::OffsetValueType, 2 * Superclass::StackWindowSize> bufferOffsets(2 * winSize);
+  typename InputImageType::OffsetValueType * offsetX = bufferOffsets.data();
+  typename InputImageType::OffsetValueType * offsetY = offsetX + winSize;
+  for(unsigned int i = 0; i < winSize; ++i )
     {
-    baseIndex[dim] = itk::Math::Floor< IndexValueType >( index[dim]+0.5 );
+    offsetX[i] = (neighX[i] - bufferStart[0]) * offsetTable[0];
+    offsetY[i] = (neighY[i] - bufferStart[1]) * offsetTable[1];
     }
 
-  for(unsigned int i = 0; i < this->m_WinSize; ++i )
+  for(unsigned int i = 0; i < winSize; ++i )
     {
-    std::fill(lineRes.begin(), lineRes.end(), itk::NumericTraits<ScalarRealType>::Zero);
-    for(unsigned int j = 0; j < this->m_WinSize; ++j )
+    std::fill(lineRes.data(), lineRes.data() + componentNumber, itk::NumericTraits<ScalarRealType>::Zero);
+    for(unsigned int j = 0; j < winSize; ++j )
       {
-      // get neighbor index
-      neighIndex[0] = baseIndex[0] + i - this->m_Radius;
-      neighIndex[1] = baseIndex[1] + j - this->m_Radius;
-      if( neighIndex[0] > this->m_EndIndex[0] )
-        {
-        neighIndex[0] = this->m_EndIndex[0];
-        }
-      if( neighIndex[0] < this->m_StartIndex[0] )
-        {
-        neighIndex[0] = this->m_StartIndex[0];
-        }
-      if( neighIndex[1] > this->m_EndIndex[1] )
-        {
-        neighIndex[1] = this->m_EndIndex[1];
-        }
-      if( neighIndex[1] < this->m_StartIndex[1] )
-        {
-        neighIndex[1] = this->m_StartIndex[1];
-        }
-
-      const InputPixelType & pixel = this->GetInputImage()->GetPixel( neighIndex );
+      const TPixel * pixel = buffer + (offsetX[i] + offsetY[j]) * componentNumber;
+      const double coefY = BCOCoefY[j];
       for( unsigned int k = 0; k<componentNumber; ++k)
         {
-        lineRes[k] += pixel.GetElement(k) * BCOCoefY[j];
+        lineRes[k] += pixel[k] * coefY;
         }
       }
+    const double coefX = BCOCoefX[i];
     for( unsigned int k = 0; k<componentNumber; ++k)
       {
-      output[k] += lineRes[k]*BCOCoefX[i];
+      output[k] += lineRes[k]*coefX;
       }
     }
 
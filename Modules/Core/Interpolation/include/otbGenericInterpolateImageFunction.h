@@ -25,6 +25,10 @@
 #include "itkConstNeighborhoodIterator.h"
 #include "itkConstantBoundaryCondition.h"
 
+#include "otbSmallBuffer.h"
+
+#include <vector>
+
 namespace otb
 {
 
@@ -113,6 +117,14 @@ public:
   itkSetMacro(NormalizeWeight, bool);
   itkGetMacro(NormalizeWeight, bool);
 
+  /** Set/Get the number of tabulated subpixel positions. When it is not
+   * null, Initialize() tabulates the weights for this number of regularly
+   * spaced positions between two pixels, and each evaluation uses the
+   * weights of the nearest position instead of evaluating the function.
+   * The default value 0 evaluates the function at each evaluation. */
+  itkSetMacro(NumberOfSubpixelPositions, unsigned int);
+  itkGetConstMacro(NumberOfSubpixelPositions, unsigned int);
+
 protected:
   GenericInterpolateImageFunction();
   ~GenericInterpolateImageFunction() override;
@@ -128,6 +140,13 @@ protected:
   virtual void InitializeTables();
   /** Fill the weight offset table*/
   virtual void FillWeightOffsetTable();
+  /** Compute the m_WindowSize weights of one dimension, for a distance in
+   * [0, 1) to the base index */
+  void ComputeWeights(double distance, double * weights) const;
+
+  /** Windows up to this size (radius 16) are evaluated without heap
+   * allocation of the weights */
+  static const unsigned int StackWindowSize = 32;
 
 private:
   GenericInterpolateImageFunction(const Self &) = delete;
@@ -156,6 +175,10 @@ private:
   mutable bool m_TablesHaveBeenGenerated;
   /** Weights normalization */
   bool m_NormalizeWeight;
+  /** Number of tabulated subpixel positions */
+  unsigned int m_NumberOfSubpixelPositions;
+  /** Weights of the tabulated positions, m_WindowSize per position */
+  std::vector<double> m_WeightTable;
 };
 
 } // end namespace itk
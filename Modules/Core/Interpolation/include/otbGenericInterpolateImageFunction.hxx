@@ -22,6 +22,9 @@
 #define otbGenericInterpolateImageFunction_hxx
 #include "otbGenericInterpolateImageFunction.h"
 #include "vnl/vnl_math.h"
+#include "itkDefaultConvertPixelTraits.h"
+
+#include <algorithm>
 
 namespace otb
 {
@@ -37,6 +40,7 @@ GenericInterpolateImageFunction<TInputImage, TFunction, TBoundaryCondition, TCoo
   m_WeightOffsetTable = nullptr;
   m_TablesHaveBeenGenerated = false;
   m_NormalizeWeight =  false;
+  m_NumberOfSubpixelPositions = 0;
 }
 
 /** Destructor */
@@ -183,9 +187,51 @@ GenericInterpolateImageFunction<TInputImage, TFunction, TBoundaryCondition, TCoo
   this->InitializeTables();
   // fill the weight table
   this->FillWeightOffsetTable();
+
+  // Tabulate the weights of the subpixel positions
+  // (the table must be empty while the function is evaluated)
+  m_WeightTable.clear();
+  std::vector<double> weightTable(m_NumberOfSubpixelPositions * m_WindowSize);
+  for (unsigned int p = 0; p < m_NumberOfSubpixelPositions; ++p)
+    {
+    this->ComputeWeights(static_cast<double>(p) / m_NumberOfSubpixelPositions, &weightTable[p * m_WindowSize]);
+    }
+  m_WeightTable.swap(weightTable);
   m_TablesHaveBeenGenerated = true;
 }
 
+/** Compute the weights of one dimension */
+template<class TInputImage, class TFunction, class TBoundaryCondition, class TCoordRep>
+void
+GenericInterpolateImageFunction<TInputImage, TFunction, TBoundaryCondition, TCoordRep>
+::ComputeWeights(double distance, double * weights) const
+{
+  if (!m_WeightTable.empty())
+    {
+    // Nearest tabulated position. A distance rounded to 1 is the first
+    // position of the next pixel, which is not tabulated: the last
+    // position is used instead.
+    unsigned int p = static_cast<unsigned int>(distance * m_NumberOfSubpixelPositions + 0.5);
+    p = std::min(p, m_NumberOfSubpixelPositions - 1);
+    std::copy(&m_WeightTable[p * m_WindowSize], &m_WeightTable[p * m_WindowSize] + m_WindowSize, weights);
+    return;
+    }
+
+  // x is the offset, hence the parameter of the kernel
+  double x = distance + this->GetRadius();
+
+  // i is the relative offset in dimension dim.
+  for (unsigned int i = 0; i < m_WindowSize; ++i)
+    {
+    // Increment the offset, taking it through the range
+    // (dist + rad - 1, ..., dist - rad), i.e. all x
+    // such that std::abs(x) <= rad
+    x -= 1.0;
+    // Compute the weight for this m
+    weights[i] = m_Function(x);
+    }
+}
+
 /** Evaluate at image index position */
 template<class TInputImage, class TFunction, class TBoundaryCondition, class TCoordRep>
 typename GenericInterpolateImageFunction<TInputImage, TFunction, TBoundaryCondition, TCoordRep>::OutputType
@@ -224,76 +270,97 @@ GenericInterpolateImageFunction<TInputImage, TFunction, TBoundaryCondition, TCoo
     distance[dim] = index[dim] - double(baseIndex[dim]);
     }
 
-  // Position the neighborhood at the index of interest
-  SizeType radius;
-  radius.Fill(this->GetRadius());
-  IteratorType nit = IteratorType(radius, this->GetInputImage(), this->GetInputImage()->GetBufferedRegion());
-  nit.SetLocation(baseIndex);
-
-  const unsigned int twiceRadius = static_cast<const unsigned int>(2 * this->GetRadius());
-  /*  double xWeight[ImageDimension][ twiceRadius]; */
-  std::vector<std::vector<double> > xWeight;
-  xWeight.resize(ImageDimension);
-  for (unsigned int cpt = 0; cpt < xWeight.size(); ++cpt)
-    {
-    xWeight[cpt].resize(twiceRadius);
-    }
+  const unsigned int radius = this->GetRadius();
 
+  // Weights of each dimension
+  SmallBuffer<double, ImageDimension * StackWindowSize> weights(ImageDimension * m_WindowSize);
   for (unsigned int dim = 0; dim < ImageDimension; ++dim)
     {
-    // x is the offset, hence the parameter of the kernel
-    double x = distance[dim] + this->GetRadius();
-
-    // If distance is zero, i.e. the index falls precisely on the
-    // pixel boundary, the weights form a delta function.
-    /*
-    if(distance[dim] == 0.0)
-    {
-    for( unsigned int i = 0; i < m_WindowSize; ++i)
-      {
-    xWeight[dim][i] = static_cast<int>(i) == (static_cast<int>(this->GetRadius()) - 1) ? 1. : 0.;
-      }
-    }
-    else
-    {
-    */
-    // i is the relative offset in dimension dim.
-    for (unsigned int i = 0; i < m_WindowSize; ++i)
-      {
-      // Increment the offset, taking it through the range
-      // (dist + rad - 1, ..., dist - rad), i.e. all x
-      // such that std::abs(x) <= rad
-      x -= 1.0;
-      // Compute the weight for this m
-      xWeight[dim][i] = m_Function(x);
-      }
-    //}
+    this->ComputeWeights(distance[dim], &weights[dim * m_WindowSize]);
     }
   if (m_NormalizeWeight == true)
     {
     for (unsigned int dim = 0; dim < ImageDimension; ++dim)
       {
+      double * xWeight = &weights[dim * m_WindowSize];
       double sum = 0.;
       // Compute the weights sum
       for (unsigned int i = 0; i < m_WindowSize; ++i)
         {
-        sum += xWeight[dim][i];
+        sum += xWeight[i];
         }
       if (sum != 1.)
         {
         // Normalize the weights
         for (unsigned int i = 0; i < m_WindowSize; ++i)
           {
-          xWeight[dim][i] =  xWeight[dim][i] / sum;
+          xWeight[i] =  xWeight[i] / sum;
           }
         }
       }
     }
 
+  const InputImageType * image = this->GetInputImage();
+  RealType xPixelValue;
+
+  // When the whole window is buffered, the boundary condition is not
+  // needed: the pixels are read directly instead of building a
+  // neighborhood iterator. They are weighted and summed in the order of
+  // the offset table, so that both paths give the same result.
+  bool insideBuffer = (ImageDimension == 2);
+  const typename InputImageType::RegionType & bufferedRegion = image->GetBufferedRegion();
+  for (unsigned int dim = 0; dim < ImageDimension && insideBuffer; ++dim)
+    {
+    const typename IndexType::IndexValueType first = baseIndex[dim] - static_cast<long>(radius) + 1;
+    const typename IndexType::IndexValueType last = baseIndex[dim] + static_cast<long>(radius);
+    insideBuffer = first >= bufferedRegion.GetIndex()[dim]
+      && last < bufferedRegion.GetIndex()[dim] + static_cast<long>(bufferedRegion.GetSize()[dim]);
+    }
+
+  if (insideBuffer)
+    {
+    typedef typename Superclass::InputPixelType               InputPixelType;
+    typedef itk::DefaultConvertPixelTraits<InputPixelType>    InputPixelTraits;
+    typedef itk::DefaultConvertPixelTraits<RealType>          RealPixelTraits;
+    typedef typename itk::NumericTraits<RealType>::ValueType  ScalarRealType;
+
+    const unsigned int numberOfComponents = image->GetNumberOfComponentsPerPixel();
+    itk::NumericTraits<RealType>::SetLength(xPixelValue, numberOfComponents);
+    xPixelValue = static_cast<RealType>(0.0);
+
+    const double * xWeight = &weights[0];
+    const double * yWeight = &weights[m_WindowSize];
+
+    IndexType neighIndex;
+    for (unsigned int j = 0; j < m_WindowSize; ++j)
+      {
+      neighIndex[1] = baseIndex[1] + static_cast<long>(j) - static_cast<long>(radius) + 1;
+      for (unsigned int i = 0; i < m_WindowSize; ++i)
+        {
+        neighIndex[0] = baseIndex[0] + static_cast<long>(i) - static_cast<long>(radius) + 1;
+        const InputPixelType & pixel = image->GetPixel(neighIndex);
+        // Component-wise, the operations of the neighborhood path below
+        for (unsigned int k = 0; k < numberOfComponents; ++k)
+          {
+          ScalarRealType xVal = static_cast<ScalarRealType>(InputPixelTraits::GetNthComponent(k, pixel));
+          xVal *= xWeight[i];
+          xVal *= yWeight[j];
+          RealPixelTraits::SetNthComponent(k, xPixelValue, RealPixelTraits::GetNthComponent(k, xPixelValue) + xVal);
+          }
+        }
+      }
+    return static_cast<OutputType>(xPixelValue);
+    }
+
+  // Position the neighborhood at the index of interest
+  SizeType radiusSize;
+  radiusSize.Fill(radius);
+  IteratorType nit = IteratorType(radiusSize, image, bufferedRegion);
+  nit.SetLocation(baseIndex);
+
   // Iterate over the neighborhood, taking the correct set
   // of weights in each dimension
-  RealType xPixelValue;
-  itk::NumericTraits<RealType>::SetLength(xPixelValue, this->GetInputImage()->GetNumberOfComponentsPerPixel());
+  itk::NumericTraits<RealType>::SetLength(xPixelValue, image->GetNumberOfComponentsPerPixel());
   xPixelValue=static_cast<RealType>(0.0);
 
   for (unsigned int j = 0; j < m_OffsetTableSize; ++j)
@@ -308,7 +375,7 @@ GenericInterpolateImageFunction<TInputImage, TFunction, TBoundaryCondition, TCoo
     // that the compiler will unwrap this loop and pipeline this!
     for (unsigned int dim = 0; dim < ImageDimension; ++dim)
       {
-      xVal *= xWeight[dim][m_WeightOffsetTable[j][dim]];
+      xVal *= weights[dim * m_WindowSize + m_WeightOffsetTable[j][dim]];
       }
 
     // Increment the pixel value
@@ -325,6 +392,7 @@ GenericInterpolateImageFunction<TInputImage, TFunction, TBoundaryCondition, TCoo
 ::PrintSelf(std::ostream& os, itk::Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfSubpixelPositions: " << m_NumberOfSubpixelPositions << std::endl;
 }
 
 } //namespace otb
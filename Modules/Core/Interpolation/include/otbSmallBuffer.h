@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbSmallBuffer_h
+#define otbSmallBuffer_h
+
+#include <cstddef>
+#include <vector>
+
+namespace otb
+{
+
+/** \class SmallBuffer
+ *
+ * \brief Scratch array stored on the stack up to N elements
+ *
+ * Interpolators evaluate small windows for each output pixel: their
+ * temporary arrays are kept on the stack for the usual window sizes,
+ * and only allocated on the heap for larger ones.
+ *
+ * \ingroup OTBInterpolation
+ */
+template <class T, std::size_t N>
+class SmallBuffer
+{
+public:
+  explicit SmallBuffer(std::size_t size)
+    : m_Data(m_Stack)
+  {
+    if (size > N)
+      {
+      m_Heap.resize(size);
+      m_Data = m_Heap.data();
+      }
+  }
+
+  T * data() { return m_Data; }
+  const T * data() const { return m_Data; }
+
+  T & operator[](std::size_t i) { return m_Data[i]; }
+  const T & operator[](std::size_t i) const { return m_Data[i]; }
+
+private:
+  SmallBuffer(const SmallBuffer &) = delete;
+  void operator =(const SmallBuffer &) = delete;
+
+  T              m_Stack[N];
+  std::vector<T> m_Heap;
+  T *            m_Data;
+};
+
+} // namespace otb
+
+#endif
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "itkMacro.h"
+
+#include "otbWindowedSincInterpolateImageLanczosFunction.h"
+#include "otbBCOInterpolateImageFunction.h"
+#include "otbImage.h"
+#include "otbVectorImage.h"
+#include "itkImageRegionIterator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+typedef otb::Image<double, 2> ImageType;
+
+/** Deterministic test pattern */
+double PatternValue(long x, long y)
+{
+  return std::fmod(37. * x + 11. * y + 0.1 * x * y, 251.) - 100.;
+}
+
+/** Image of the pattern on size x size pixels, padded with pad zero
+ * pixels around it. */
+ImageType::Pointer CreatePatternImage(unsigned int size, unsigned int pad)
+{
+  ImageType::IndexType start;
+  start.Fill(-static_cast<long>(pad));
+  ImageType::SizeType regionSize;
+  regionSize.Fill(size + 2 * pad);
+  ImageType::RegionType region(start, regionSize);
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+
+  itk::ImageRegionIterator<ImageType> it(image, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    const ImageType::IndexType & index = it.GetIndex();
+    const bool inside = index[0] >= 0 && index[1] >= 0
+      && index[0] < static_cast<long>(size) && index[1] < static_cast<long>(size);
+    it.Set(inside ? PatternValue(index[0], index[1]) : 0.);
+    }
+  return image;
+}
+}
+
+/** The windowed-sinc interpolators read the pixels directly when the window
+ * is buffered, and through a neighborhood iterator with the boundary
+ * condition otherwise. Near the border of an image, the neighborhood path is
+ * compared to the direct path on the same image padded with the constant of
+ * the boundary condition: both must give the same values. */
+int otbGenericInterpolateImageFunctionPaths(int itkNotUsed(argc), char * itkNotUsed(argv) [])
+{
+  typedef otb::WindowedSincInterpolateImageLanczosFunction<ImageType> InterpolatorType;
+  typedef InterpolatorType::ContinuousIndexType                       ContinuousIndexType;
+
+  const unsigned int size = 40;
+  const unsigned int radius = 3;
+
+  ImageType::Pointer image = CreatePatternImage(size, 0);
+  ImageType::Pointer padded = CreatePatternImage(size, radius + 1);
+
+  InterpolatorType::Pointer interp = InterpolatorType::New();
+  interp->SetInputImage(image);
+  interp->SetRadius(radius);
+  interp->Initialize();
+
+  InterpolatorType::Pointer paddedInterp = InterpolatorType::New();
+  paddedInterp->SetInputImage(padded);
+  paddedInterp->SetRadius(radius);
+  paddedInterp->Initialize();
+
+  const double positions[] = {0., 0.3, 1.7, 2.5, 20.25, 36.6, 38.5, 39.};
+  const unsigned int nbPositions = sizeof(positions) / sizeof(positions[0]);
+
+  bool fail = false;
+  for (unsigned int j = 0; j < nbPositions; ++j)
+    {
+    for (unsigned int i = 0; i < nbPositions; ++i)
+      {
+      ContinuousIndexType index;
+      index[0] = positions[i];
+      index[1] = positions[j];
+      const double value = interp->EvaluateAtContinuousIndex(index);
+      const double reference = paddedInterp->EvaluateAtContinuousIndex(index);
+      if (std::abs(value - reference) > 1e-9)
+        {
+        std::cerr << "At " << index << ": " << value << " (neighborhood) vs "
+                  << reference << " (buffered window)" << std::endl;
+        fail = true;
+        }
+      }
+    }
+
+  return fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/** With tabulated subpixel positions, the interpolated values are exact at
+ * the tabulated positions, and close to the exact values elsewhere. */
+int otbInterpolateImageFunctionSubpixelPositions(int itkNotUsed(argc), char * itkNotUsed(argv) [])
+{
+  typedef otb::WindowedSincInterpolateImageLanczosFunction<ImageType> LanczosType;
+  typedef otb::BCOInterpolateImageFunction<ImageType>                 BCOType;
+  typedef otb::VectorImage<double, 2>                                 VectorImageType;
+  typedef otb::BCOInterpolateImageFunction<VectorImageType>           VectorBCOType;
+  typedef LanczosType::ContinuousIndexType                            ContinuousIndexType;
+
+  const unsigned int size = 40;
+  const unsigned int positions = 64;
+
+  ImageType::Pointer image = CreatePatternImage(size, 0);
+
+  VectorImageType::Pointer vectorImage = VectorImageType::New();
+  vectorImage->SetRegions(image->GetLargestPossibleRegion());
+  vectorImage->SetNumberOfComponentsPerPixel(3);
+  vectorImage->Allocate();
+  itk::ImageRegionIterator<VectorImageType> vit(vectorImage, vectorImage->GetLargestPossibleRegion());
+  for (vit.GoToBegin(); !vit.IsAtEnd(); ++vit)
+    {
+    VectorImageType::PixelType pixel(3);
+    pixel[0] = image->GetPixel(vit.GetIndex());
+    pixel[1] = -pixel[0];
+    pixel[2] = 2. * pixel[0] + 1.;
+    vit.Set(pixel);
+    }
+
+  LanczosType::Pointer lanczos = LanczosType::New();
+  lanczos->SetInputImage(image);
+  lanczos->SetRadius(3);
+  lanczos->Initialize();
+  LanczosType::Pointer tabulatedLanczos = LanczosType::New();
+  tabulatedLanczos->SetInputImage(image);
+  tabulatedLanczos->SetRadius(3);
+  tabulatedLanczos->SetNumberOfSubpixelPositions(positions);
+  tabulatedLanczos->Initialize();
+
+  BCOType::Pointer bco = BCOType::New();
+  bco->SetInputImage(image);
+  bco->SetRadius(2);
+  BCOType::Pointer tabulatedBCO = BCOType::New();
+  tabulatedBCO->SetInputImage(image);
+  tabulatedBCO->SetRadius(2);
+  tabulatedBCO->SetNumberOfSubpixelPositions(positions);
+
+  VectorBCOType::Pointer vectorBCO = VectorBCOType::New();
+  vectorBCO->SetInputImage(vectorImage);
+  vectorBCO->SetRadius(2);
+  VectorBCOType::Pointer tabulatedVectorBCO = VectorBCOType::New();
+  tabulatedVectorBCO->SetInputImage(vectorImage);
+  tabulatedVectorBCO->SetRadius(2);
+  tabulatedVectorBCO->SetNumberOfSubpixelPositions(positions);
+
+  // Away from the tabulated positions, the kernels are shifted by at most
+  // half a step (1/128 pixel): on this pattern, with values spanning 251
+  // grey levels, the error stays below 2
+  const double tolerance = 2.;
+
+  bool fail = false;
+  for (unsigned int k = 0; k < 200; ++k)
+    {
+    // Tabulated positions (multiples of 1 / positions) every other point
+    const double step = (k % 2 == 0) ? 1. / positions : 0.0123;
+    ContinuousIndexType index;
+    index[0] = 5. + std::fmod(k * 7 * step, 30.);
+    index[1] = 5. + std::fmod(k * 3 * step + 0.5, 30.);
+    const double maxError = (k % 2 == 0) ? 1e-9 : tolerance;
+
+    const double lanczosError = std::abs(lanczos->EvaluateAtContinuousIndex(index)
+                                         - tabulatedLanczos->EvaluateAtContinuousIndex(index));
+    const double bcoError = std::abs(bco->EvaluateAtContinuousIndex(index)
+                                     - tabulatedBCO->EvaluateAtContinuousIndex(index));
+    const VectorBCOType::OutputType exact = vectorBCO->EvaluateAtContinuousIndex(index);
+    const VectorBCOType::OutputType tabulated = tabulatedVectorBCO->EvaluateAtContinuousIndex(index);
+    double vectorError = 0.;
+    for (unsigned int c = 0; c < 3; ++c)
+      {
+      vectorError = std::max(vectorError, std::abs(exact[c] - tabulated[c]) / (c == 2 ? 2. : 1.));
+      }
+
+    if (lanczosError > maxError || bcoError > maxError || vectorError > maxError)
+      {
+      std::cerr << "At " << index << ": errors " << lanczosError << " (Lanczos), "
+                << bcoError << " (BCO), " << vectorError << " (BCO vector), max "
+                << maxError << std::endl;
+      fail = true;
+      }
+    }
+
+  return fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -39,4 +39,6 @@ void RegisterTests()
   REGISTER_TEST(otbBCOInterpolateImageFunctionVectorImageTest);
   REGISTER_TEST(otbProlateInterpolateImageFunction);
   REGISTER_TEST(otbProlateValidationTest);
+  REGISTER_TEST(otbGenericInterpolateImageFunctionPaths);
+  REGISTER_TEST(otbInterpolateImageFunctionSubpixelPositions);
 }
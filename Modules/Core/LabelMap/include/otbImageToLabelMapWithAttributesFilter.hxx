@@ -135,7 +135,6 @@ ImageToLabelMapWithAttributesFilter<TInputImage, TLabeledImage, TOutputLabel, TO
   bandStatsLabelMapFilter->SetFeatureImage(inputImage);
 
   // Get the label map
-  bandStatsLabelMapFilter->GetOutput()->SetAdjacencyMap(lfilter->GetOutput()->GetAdjacencyMap());
   bandStatsLabelMapFilter->GraftOutput( this->GetOutput() );
 
   // execute the mini-pipeline
@@ -143,6 +142,9 @@ ImageToLabelMapWithAttributesFilter<TInputImage, TLabeledImage, TOutputLabel, TO
 
   // graft the mini-pipeline output back onto this filter's output.
   this->GraftOutput( bandStatsLabelMapFilter->GetOutput() );
+
+  // The adjacency is only known once the label map is computed
+  this->GetOutput()->CopyAdjacency(lfilter->GetOutput());
 }
 
 
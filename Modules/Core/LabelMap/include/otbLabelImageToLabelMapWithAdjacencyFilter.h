@@ -31,6 +31,20 @@ namespace otb {
 /** \class LabelImageToLabelMapWithAdjacencyFilter
  * \brief convert a labeled image to a label map with adjacency information.
  *
+ * The adjacency is found while run-length encoding the image, in a
+ * single pass: two labels are adjacent when their runs are consecutive
+ * on a line, or touch each other (diagonals included) on two consecutive
+ * lines. Each thread collects the adjacent pairs of labels in an array,
+ * which is sorted and made unique whenever it has doubled, and the arrays
+ * of the threads are merged into the compressed adjacency of the output.
+ *
+ * By default the whole input is requested at once. When
+ * NumberOfLinesPerStrip is set, the input is instead pulled strip by
+ * strip, each strip with the line above it, in the same single pass:
+ * only the runs and the adjacent pairs are kept in memory, never the
+ * whole label image. The output is the same either way.
+ *
+ * \sa LabelMapWithAdjacency
  *
  * \ingroup OTBLabelMap
  */
@@ -62,6 +76,8 @@ public:
   typedef typename OutputImageType::LabelObjectType             LabelObjectType;
   typedef typename OutputImageType::AdjacencyMapType            AdjacencyMapType;
   typedef typename OutputImageType::AdjacentLabelsContainerType AdjacentLabelsContainerType;
+  typedef typename OutputImageType::LabelPairType               LabelPairType;
+  typedef typename OutputImageType::LabelPairVectorType         LabelPairVectorType;
   typedef typename OutputImageType::LabelType                   LabelType;
 
   /** Const iterator over LabelObject lines */
@@ -87,6 +103,13 @@ public:
   itkSetMacro(BackgroundValue, OutputImagePixelType);
   itkGetConstMacro(BackgroundValue, OutputImagePixelType);
 
+  /**
+   * Set/Get the number of lines of the strips the input is pulled by.
+   * Defaults to 0, which requests the whole input at once.
+   */
+  itkSetMacro(NumberOfLinesPerStrip, unsigned long);
+  itkGetConstMacro(NumberOfLinesPerStrip, unsigned long);
+
 protected:
   /** Constructor */
   LabelImageToLabelMapWithAdjacencyFilter();
@@ -126,6 +149,8 @@ protected:
   /** LabelImageToLabelMapWithAdjacencyFilter will produce the entire output. */
   void EnlargeOutputRequestedRegion(itk::DataObject *itkNotUsed(output)) override;
 
+  void GenerateData() override;
+
   void BeforeThreadedGenerateData() override;
 
   void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId) override;
@@ -146,10 +171,33 @@ private:
   LabelImageToLabelMapWithAdjacencyFilter(const Self&) = delete;
   void operator=(const Self&) = delete;
 
+  /** Move the label objects found by the threads other than the first
+   * one to the output, in the order of the threads */
+  void MergeTemporaryImages();
+
+  static ITK_THREAD_RETURN_TYPE StripThreaderCallback(void *arg);
+
+  /** Internal structure used for passing data into the threading library */
+  struct ThreadStruct
+  {
+    Self *                Filter;
+    OutputImageRegionType Strip;
+  };
+
   OutputImagePixelType m_BackgroundValue;
 
+  unsigned long m_NumberOfLinesPerStrip;
+
+  /** Progress of the current strip */
+  float m_ProgressOffset;
+  float m_ProgressWeight;
+
   typename std::vector< OutputImagePointer > m_TemporaryImages;
-  typename std::vector<AdjacencyMapType>     m_TemporaryAdjacencyMaps;
+
+  /** Adjacent pairs of labels found by each thread, the smallest label
+   * first, and the size which triggers their next sort */
+  std::vector<LabelPairVectorType> m_TemporaryLabelPairs;
+  std::vector<std::size_t>         m_TemporaryLabelPairsCapacities;
 
 }; // end of class
 
@@ -28,6 +28,8 @@
 #include "itkImageLinearConstIteratorWithIndex.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
 
+#include <algorithm>
+
 namespace otb {
 
 template <class TInputImage, class TOutputImage>
@@ -35,6 +37,9 @@ LabelImageToLabelMapWithAdjacencyFilter<TInputImage, TOutputImage>
 ::LabelImageToLabelMapWithAdjacencyFilter()
 {
   m_BackgroundValue = itk::NumericTraits<OutputImagePixelType>::NonpositiveMin();
+  m_NumberOfLinesPerStrip = 0;
+  m_ProgressOffset = 0;
+  m_ProgressWeight = 1;
 }
 
 template <class TInputImage, class TOutputImage>
@@ -61,6 +66,12 @@ LabelImageToLabelMapWithAdjacencyFilter<TInputImage, TOutputImage>
           // input a lower dimension than the output.
           InputImageRegionType inputRegion;
           this->CallCopyOutputRegionToInputRegion(inputRegion, this->GetOutput()->GetRequestedRegion());
+          // In streamed mode, only the first strip is requested: the
+          // next ones are pulled by GenerateData()
+          if (m_NumberOfLinesPerStrip > 0)
+            {
+            inputRegion.SetSize(1, std::min<unsigned long>(m_NumberOfLinesPerStrip, inputRegion.GetSize(1)));
+            }
           input->SetRequestedRegion( inputRegion );
           }
         }
@@ -75,15 +86,95 @@ LabelImageToLabelMapWithAdjacencyFilter<TInputImage, TOutputImage>
 }
 
 
+template<class TInputImage, class TOutputImage>
+void
+LabelImageToLabelMapWithAdjacencyFilter<TInputImage, TOutputImage>
+::GenerateData()
+{
+  if (m_NumberOfLinesPerStrip == 0)
+    {
+    Superclass::GenerateData();
+    return;
+    }
+
+  this->AllocateOutputs();
+  this->BeforeThreadedGenerateData();
+
+  InputImageType * input = const_cast<InputImageType *>(this->GetInput());
+  OutputImageRegionType outputRegion = this->GetOutput()->GetRequestedRegion();
+  const unsigned long nbLines = outputRegion.GetSize(1);
+
+  ThreadStruct str;
+  str.Filter = this;
+  for (unsigned long line = 0; line < nbLines; line += m_NumberOfLinesPerStrip)
+    {
+    str.Strip = outputRegion;
+    str.Strip.SetIndex(1, outputRegion.GetIndex(1) + line);
+    str.Strip.SetSize(1, std::min(m_NumberOfLinesPerStrip, nbLines - line));
+
+    // Pull the strip, with the line above it for the vertical adjacency
+    InputImageRegionType inputRegion;
+    this->CallCopyOutputRegionToInputRegion(inputRegion, str.Strip);
+    if (line > 0)
+      {
+      inputRegion.SetIndex(1, inputRegion.GetIndex(1) - 1);
+      inputRegion.SetSize(1, inputRegion.GetSize(1) + 1);
+      }
+    input->SetRequestedRegion(inputRegion);
+    input->PropagateRequestedRegion();
+    input->UpdateOutputData();
+
+    // Split the lines of the strip among the threads
+    m_ProgressOffset = static_cast<float>(line) / nbLines;
+    m_ProgressWeight = static_cast<float>(str.Strip.GetSize(1)) / nbLines;
+    const unsigned long nbThreads = std::min<unsigned long>(this->GetNumberOfThreads(), str.Strip.GetSize(1));
+    this->GetMultiThreader()->SetNumberOfThreads(nbThreads);
+    this->GetMultiThreader()->SetSingleMethod(this->StripThreaderCallback, &str);
+    this->GetMultiThreader()->SingleMethodExecute();
+
+    // Keep the lines of the label objects in raster order
+    this->MergeTemporaryImages();
+    }
+
+  this->AfterThreadedGenerateData();
+}
+
+template<class TInputImage, class TOutputImage>
+ITK_THREAD_RETURN_TYPE
+LabelImageToLabelMapWithAdjacencyFilter<TInputImage, TOutputImage>
+::StripThreaderCallback(void *arg)
+{
+  const unsigned int threadId = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->ThreadID;
+  const unsigned int threadCount = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->NumberOfThreads;
+  ThreadStruct * str = (ThreadStruct *) (((itk::MultiThreader::ThreadInfoStruct *) (arg))->UserData);
+
+  const unsigned long nbLines = str->Strip.GetSize(1);
+  const unsigned long firstLine = nbLines * threadId / threadCount;
+  const unsigned long endLine = nbLines * (threadId + 1) / threadCount;
+  if (firstLine < endLine)
+    {
+    OutputImageRegionType regionForThread = str->Strip;
+    regionForThread.SetIndex(1, str->Strip.GetIndex(1) + firstLine);
+    regionForThread.SetSize(1, endLine - firstLine);
+    str->Filter->ThreadedGenerateData(regionForThread, threadId);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 template<class TInputImage, class TOutputImage>
 void
 LabelImageToLabelMapWithAdjacencyFilter<TInputImage, TOutputImage>
 ::BeforeThreadedGenerateData()
 {
+  m_ProgressOffset = 0;
+  m_ProgressWeight = 1;
+
   // init the temp images - one per thread
   m_TemporaryImages.resize( this->GetNumberOfThreads() );
-  // Clear previous adjacency map
-  m_TemporaryAdjacencyMaps.resize( this->GetNumberOfThreads() );
+  // Clear previous adjacency
+  m_TemporaryLabelPairs.assign( this->GetNumberOfThreads(), LabelPairVectorType() );
+  m_TemporaryLabelPairsCapacities.assign( this->GetNumberOfThreads(), 1024 );
 
   for( unsigned int i=0; i<this->GetNumberOfThreads(); ++i )
     {
@@ -110,27 +201,22 @@ void
 LabelImageToLabelMapWithAdjacencyFilter<TInputImage, TOutputImage>
 ::AddAdjacency(LabelType label1, LabelType label2, itk::ThreadIdType threadId)
 {
-  // Insert label1 in v neighbors
-  if(m_TemporaryAdjacencyMaps[threadId].find(label2)!= m_TemporaryAdjacencyMaps[threadId].end())
-    {
-    m_TemporaryAdjacencyMaps[threadId][label2].insert(label1);
-    }
-  else
-    {
-    AdjacentLabelsContainerType newContainer;
-    newContainer.insert(label1);
-    m_TemporaryAdjacencyMaps[threadId][label2]=newContainer;
-    }
-  // Insert label2 in label1s neighbors
-  if(m_TemporaryAdjacencyMaps[threadId].find(label1)!=m_TemporaryAdjacencyMaps[threadId].end())
+  LabelPairVectorType & labelPairs = m_TemporaryLabelPairs[threadId];
+  const LabelPairType labelPair(std::min(label1, label2), std::max(label1, label2));
+
+  // Neighbor runs often repeat the same pair
+  if(!labelPairs.empty() && labelPairs.back() == labelPair)
     {
-    m_TemporaryAdjacencyMaps[threadId][label1].insert(label2);
+    return;
     }
-  else
+  labelPairs.push_back(labelPair);
+
+  // Remove the duplicated pairs once the array has doubled
+  if(labelPairs.size() >= m_TemporaryLabelPairsCapacities[threadId])
     {
-    AdjacentLabelsContainerType newContainer;
-    newContainer.insert(label2);
-    m_TemporaryAdjacencyMaps[threadId][label1]=newContainer;
+    std::sort(labelPairs.begin(), labelPairs.end());
+    labelPairs.erase(std::unique(labelPairs.begin(), labelPairs.end()), labelPairs.end());
+    m_TemporaryLabelPairsCapacities[threadId] = std::max(m_TemporaryLabelPairsCapacities[threadId], 2 * labelPairs.size());
     }
 }
 
@@ -167,35 +253,44 @@ LabelImageToLabelMapWithAdjacencyFilter<TInputImage, TOutputImage>
   // Provided to disable fully connected if needed
   long offset = 1;
 
-  // Iterate on line1
-  for(typename RLEVectorType::const_iterator it1 = line1.begin(); it1!=line1.end(); ++it1)
+  // Both lines are sorted: sweep them together, always moving forward
+  // the RLE which ends first. When both end together, the next RLE of
+  // line1 may still touch the current RLE of line2.
+  typename RLEVectorType::const_iterator it1 = line1.begin();
+  typename RLEVectorType::const_iterator it2 = line2.begin();
+
+  while(it1!=line1.end() && it2!=line2.end())
     {
-    // Delimitate RLE1
+    // Delimitate RLE1 and RLE2
     long start1 = it1->where[0];
     long end1 = start1 + it1->length-1;
-    LabelType label1 = it1->label;
+    long start2 = it2->where[0];
+    long end2 = start2 + it2->length-1;
 
-    // Iterate on line2
-    for(typename RLEVectorType::const_iterator it2 = line2.begin(); it2!=line2.end(); ++it2)
+    // If labels are different and RLEs are adjacent
+    if(it1->label != it2->label
+       && start1 <= end2 + offset && start2 <= end1 + offset)
       {
-      // Delimitate RLE2
-      long start2 = it2->where[0];
-      long end2 = start2 + it2->length-1;
-      LabelType label2 = it2->label;
-
-      // If labels are different
-      if(label1 != label2)
-  {
-  //Check adjacency
-  if(  (  (start1 >= start2 - offset) && (start1 <= end2 + offset) )
-       || ( (end1 >= start2 - offset) && (end1  <= end2 + offset) )
-       || ( (start2 >= start1 - offset) && (start2 <= end1 + offset) )
-       || ( (end2 >= start1 - offset) && (end2 <= end1 + offset) ))
-    {
-    // Add the adjacency
-    this->AddAdjacency(label1, label2, threadId);
-    }
-  }
+      // Add the adjacency
+      this->AddAdjacency(it1->label, it2->label, threadId);
+      }
+
+    if(end1 < end2)
+      {
+      ++it1;
+      }
+    else
+      {
+      if(end1 == end2)
+        {
+        typename RLEVectorType::const_iterator next1 = it1 + 1;
+        if(next1!=line1.end() && next1->label != it2->label
+           && next1->where[0] <= end2 + offset)
+          {
+          this->AddAdjacency(next1->label, it2->label, threadId);
+          }
+        }
+      ++it2;
       }
     }
 }
@@ -205,7 +300,7 @@ void
 LabelImageToLabelMapWithAdjacencyFilter<TInputImage, TOutputImage>
 ::ThreadedGenerateData( const OutputImageRegionType& regionForThread, itk::ThreadIdType threadId )
 {
-  itk::ProgressReporter progress( this, threadId, regionForThread.GetNumberOfPixels() );
+  itk::ProgressReporter progress( this, threadId, regionForThread.GetNumberOfPixels(), 100, m_ProgressOffset, m_ProgressWeight );
 
   typedef itk::ImageLinearConstIteratorWithIndex< InputImageType > InputLineIteratorType;
 
@@ -314,14 +409,13 @@ LabelImageToLabelMapWithAdjacencyFilter<TInputImage, TOutputImage>
 template<class TInputImage, class TOutputImage>
 void
 LabelImageToLabelMapWithAdjacencyFilter<TInputImage, TOutputImage>
-::AfterThreadedGenerateData()
+::MergeTemporaryImages()
 {
-
   OutputImageType * output = this->GetOutput();
 
   // merge the lines from the temporary images in the output image
   // don't use the first image - that's the output image
-  for( unsigned int i=1; i<this->GetNumberOfThreads(); ++i )
+  for( unsigned int i=1; i<m_TemporaryImages.size(); ++i )
     {
     typedef typename OutputImageType::LabelObjectVectorType LabelObjectVectorType;
     const LabelObjectVectorType & labelObjectContainer = m_TemporaryImages[i]->GetLabelObjects();
@@ -358,55 +452,49 @@ LabelImageToLabelMapWithAdjacencyFilter<TInputImage, TOutputImage>
         output->AddLabelObject( labelObject );
         }
       }
+
+    // start again from an empty image for the next strip
+    m_TemporaryImages[i] = OutputImageType::New();
+    m_TemporaryImages[i]->SetBackgroundValue( m_BackgroundValue );
     }
+}
 
-  // Merge adjacency tables
-  AdjacencyMapType adjMap = m_TemporaryAdjacencyMaps[0];
+template<class TInputImage, class TOutputImage>
+void
+LabelImageToLabelMapWithAdjacencyFilter<TInputImage, TOutputImage>
+::AfterThreadedGenerateData()
+{
+  this->MergeTemporaryImages();
 
-  // For each remaining thread
+  // Merge the adjacent pairs of the threads
+  LabelPairVectorType labelPairs;
+  labelPairs.swap(m_TemporaryLabelPairs[0]);
   for(itk::ThreadIdType threadId = 1; threadId < this->GetNumberOfThreads(); ++threadId)
     {
-    // For each label in the thread adjacency map
-    for(typename AdjacencyMapType::const_iterator mit = m_TemporaryAdjacencyMaps[threadId].begin();
-  mit!= m_TemporaryAdjacencyMaps[threadId].end();
-  ++mit)
-      {
-      // If the label exists in the main map
-      if(adjMap.find(mit->first) != adjMap.end())
-  {
-  // We need to merge
-  AdjacentLabelsContainerType adjLabels1 = adjMap[mit->first];
-  AdjacentLabelsContainerType adjLabels2 = mit->second;
-  std::vector<LabelType> mergedLabels(adjLabels1.size()+adjLabels2.size(), 0);
-
-  // Merge
-  typename std::vector<LabelType>::const_iterator vend = set_union(adjLabels1.begin(), adjLabels1.end(), adjLabels2.begin(), adjLabels2.end(), mergedLabels.begin());
-
-  AdjacentLabelsContainerType mergedLabelsSet;
-
-  for(typename std::vector<LabelType>::const_iterator vit = mergedLabels.begin();
-      vit!=vend; ++vit)
-    {
-    mergedLabelsSet.insert(*vit);
+    labelPairs.insert(labelPairs.end(), m_TemporaryLabelPairs[threadId].begin(), m_TemporaryLabelPairs[threadId].end());
+    LabelPairVectorType().swap(m_TemporaryLabelPairs[threadId]);
     }
+  std::sort(labelPairs.begin(), labelPairs.end());
+  labelPairs.erase(std::unique(labelPairs.begin(), labelPairs.end()), labelPairs.end());
 
-  // Set the final result
-  adjMap[mit->first]=mergedLabelsSet;
-  }
-      else
-  {
-  // Set the labels
-  adjMap[mit->first]=mit->second;
-  }
+  // Each label is adjacent to the other one
+  const std::size_t nbPairs = labelPairs.size();
+  labelPairs.reserve(2 * nbPairs);
+  for(std::size_t i = 0; i < nbPairs; ++i)
+    {
+    if(labelPairs[i].first != labelPairs[i].second)
+      {
+      labelPairs.push_back(LabelPairType(labelPairs[i].second, labelPairs[i].first));
       }
     }
 
-  // Set the adjacency map to the output
-  output->SetAdjacencyMap(adjMap);
+  // Set the adjacency to the output
+  output->SetAdjacentLabelPairs(std::move(labelPairs));
 
   // release the data in the temp images
   m_TemporaryImages.clear();
-  m_TemporaryAdjacencyMaps.clear();
+  m_TemporaryLabelPairs.clear();
+  m_TemporaryLabelPairsCapacities.clear();
 }
 
 
@@ -418,6 +506,7 @@ LabelImageToLabelMapWithAdjacencyFilter<TInputImage, TOutputImage>
   Superclass::PrintSelf(os, indent);
 
   os << indent << "BackgroundValue: "  << static_cast<typename itk::NumericTraits<OutputImagePixelType>::PrintType>(m_BackgroundValue) << std::endl;
+  os << indent << "NumberOfLinesPerStrip: " << m_NumberOfLinesPerStrip << std::endl;
 }
 
 }// end namespace otb
@@ -24,15 +24,39 @@
 #include "itkLabelMap.h"
 #include "otbMergeLabelObjectFunctor.h"
 
+#include <algorithm>
+#include <map>
 #include <set>
+#include <unordered_map>
+#include <vector>
 
 namespace otb
 {
 /** \class LabelMapWithAdjacency
 *   \brief This class is a LabelMap with additional adjacency information.
 *
-*   The adjacency information is stored as a map of set of labels, in
-*   order to avoid duplicated neighbors.
+*   The adjacency information is stored in compressed sparse row form:
+*   the sorted labels which have adjacent labels, the offset of each of
+*   them in a single array of adjacent labels, and this array, in which
+*   the adjacent labels of each label are sorted and unique. This costs
+*   one label per adjacency, instead of one node of a std::set, so that
+*   the adjacency of millions of objects fits in memory.
+*
+*   GetAdjacentLabels() returns a range over the adjacent labels of a
+*   label. The whole structure can also be walked with
+*   GetAdjacencyLabels(), GetAdjacencyOffsets() and GetAdjacentLabelArray().
+*
+*   The labels added by AddAdjacentLabel() are buffered and inserted all
+*   at once by Compact(), which is called by the other methods when
+*   needed. Since reading the adjacency may then modify the label map,
+*   call Compact() before reading it from several threads.
+*   RemoveAdjacentLabel() and ClearAdjacentLabels() are linear in the
+*   number of adjacencies: removing many adjacencies, or merging many
+*   labels, should be done with SetAdjacentLabelPairs() and
+*   MergeLabels(const LabelPairVectorType &) respectively.
+*
+*   GetAdjacencyMap() and SetAdjacencyMap() convert from and to the
+*   former map of sets representation.
  *
  * \ingroup OTBLabelMap
 */
@@ -81,148 +105,335 @@ public:
   /** A vector of pair of labels */
   typedef std::vector<LabelPairType>                      LabelPairVectorType;
 
-  /** Set/Get the adjacency map */
+  /** Arrays of the compressed adjacency */
+  typedef std::vector<LabelType>                          LabelVectorType;
+  typedef std::vector<std::size_t>                        OffsetVectorType;
+
+  /** Range of the sorted adjacent labels of a label */
+  class AdjacentLabelsRange
+  {
+  public:
+    typedef typename LabelVectorType::const_iterator const_iterator;
+
+    AdjacentLabelsRange(const_iterator first, const_iterator last)
+      : m_Begin(first), m_End(last) {}
+
+    const_iterator begin() const
+    {
+      return m_Begin;
+    }
+    const_iterator end() const
+    {
+      return m_End;
+    }
+    std::size_t size() const
+    {
+      return m_End - m_Begin;
+    }
+    bool empty() const
+    {
+      return m_Begin == m_End;
+    }
+    /** Whether a label belongs to the range */
+    bool count(LabelType label) const
+    {
+      return std::binary_search(m_Begin, m_End, label);
+    }
+
+  private:
+    const_iterator m_Begin;
+    const_iterator m_End;
+  };
+
+  /** Set the adjacency from a list of pairs (label, adjacent label), in
+   * any order and possibly duplicated. The adjacency is not made
+   * symmetric: each pair only adds its second label to the adjacent
+   * labels of its first label. */
+  void SetAdjacentLabelPairs(LabelPairVectorType labelPairs)
+  {
+    m_PendingLabelPairs.clear();
+    std::sort(labelPairs.begin(), labelPairs.end());
+    labelPairs.erase(std::unique(labelPairs.begin(), labelPairs.end()), labelPairs.end());
+
+    LabelVectorType labels;
+    for(typename LabelPairVectorType::const_iterator it = labelPairs.begin(); it != labelPairs.end(); ++it)
+      {
+      if(labels.empty() || labels.back() != it->first)
+        {
+        labels.push_back(it->first);
+        }
+      }
+    this->BuildAdjacency(labels, labelPairs);
+    this->Modified();
+  }
+
+  /** Set/Get the adjacency map. These methods convert the adjacency and
+   * are meant for small label maps. */
   void SetAdjacencyMap(const AdjacencyMapType & amap)
   {
-    m_AdjacencyMap = amap;
+    m_PendingLabelPairs.clear();
+    m_AdjacencyLabels.clear();
+    m_AdjacencyOffsets.assign(1, 0);
+    m_AdjacentLabels.clear();
+    for(typename AdjacencyMapType::const_iterator it = amap.begin(); it != amap.end(); ++it)
+      {
+      m_AdjacencyLabels.push_back(it->first);
+      m_AdjacentLabels.insert(m_AdjacentLabels.end(), it->second.begin(), it->second.end());
+      m_AdjacencyOffsets.push_back(m_AdjacentLabels.size());
+      }
+    this->Modified();
+  }
+
+  AdjacencyMapType GetAdjacencyMap() const
+  {
+    this->Compact();
+    AdjacencyMapType amap;
+    for(std::size_t i = 0; i < m_AdjacencyLabels.size(); ++i)
+      {
+      amap[m_AdjacencyLabels[i]] = AdjacentLabelsContainerType(m_AdjacentLabels.begin() + m_AdjacencyOffsets[i],
+                                                               m_AdjacentLabels.begin() + m_AdjacencyOffsets[i + 1]);
+      }
+    return amap;
+  }
+
+  /** Copy the adjacency of another label map */
+  void CopyAdjacency(const Self * labelMap)
+  {
+    labelMap->Compact();
+    m_PendingLabelPairs.clear();
+    m_AdjacencyLabels = labelMap->m_AdjacencyLabels;
+    m_AdjacencyOffsets = labelMap->m_AdjacencyOffsets;
+    m_AdjacentLabels = labelMap->m_AdjacentLabels;
+    this->Modified();
+  }
+
+  /** Sorted labels which have adjacent labels, possibly none after
+   * ClearAdjacentLabels() */
+  const LabelVectorType & GetAdjacencyLabels() const
+  {
+    this->Compact();
+    return m_AdjacencyLabels;
   }
 
-  const AdjacencyMapType & GetAdjacencyMap() const
+  /** Offset in GetAdjacentLabelArray() of the adjacent labels of each
+   * label of GetAdjacencyLabels(), followed by the total number of
+   * adjacencies */
+  const OffsetVectorType & GetAdjacencyOffsets() const
   {
-    return m_AdjacencyMap;
+    this->Compact();
+    return m_AdjacencyOffsets;
+  }
+
+  /** Adjacent labels of all the labels of GetAdjacencyLabels() */
+  const LabelVectorType & GetAdjacentLabelArray() const
+  {
+    this->Compact();
+    return m_AdjacentLabels;
+  }
+
+  /** Total number of adjacencies, each adjacency being counted once per
+   * label which has it */
+  std::size_t GetNumberOfAdjacencies() const
+  {
+    this->Compact();
+    return m_AdjacentLabels.size();
   }
 
   /** Add a given label to the adjacent labels set of another label */
   void AddAdjacentLabel(LabelType label1, LabelType label2)
   {
-    if(m_AdjacencyMap.find(label1) != m_AdjacencyMap.end())
-      {
-      m_AdjacencyMap[label1].insert(label2);
-      }
-    else
-      {
-      AdjacentLabelsContainerType newContainer;
-      newContainer.insert(label2);
-      m_AdjacencyMap[label1]=newContainer;
-      }
+    m_PendingLabelPairs.push_back(LabelPairType(label1, label2));
   }
 
    /** Clear the adjacent labels of a given label */
   void ClearAdjacentLabels(LabelType label)
   {
-    if(m_AdjacencyMap.find(label) != m_AdjacencyMap.end())
+    const std::size_t index = this->FindAdjacencyLabel(label);
+    if(index != m_AdjacencyLabels.size())
       {
-      m_AdjacencyMap[label].clear();
+      this->EraseAdjacentLabels(index, m_AdjacencyOffsets[index], m_AdjacencyOffsets[index + 1]);
       }
   }
 
   /** Remove the given adjacent label from the given label */
   void RemoveAdjacentLabel(LabelType label1, LabelType label2)
   {
-    if(m_AdjacencyMap.find(label1) != m_AdjacencyMap.end())
+    const std::size_t index = this->FindAdjacencyLabel(label1);
+    if(index != m_AdjacencyLabels.size())
       {
-      m_AdjacencyMap[label1].erase(label2);
+      typename LabelVectorType::iterator first = m_AdjacentLabels.begin() + m_AdjacencyOffsets[index];
+      typename LabelVectorType::iterator last = m_AdjacentLabels.begin() + m_AdjacencyOffsets[index + 1];
+      typename LabelVectorType::iterator it = std::lower_bound(first, last, label2);
+      if(it != last && *it == label2)
+        {
+        const std::size_t position = it - m_AdjacentLabels.begin();
+        this->EraseAdjacentLabels(index, position, position + 1);
+        }
       }
   }
 
-  /** Get the set of adjacent labels from a given label */
-  const AdjacentLabelsContainerType & GetAdjacentLabels(LabelType label) const
+  /** Whether a given label has an adjacency entry */
+  bool HasAdjacentLabels(LabelType label) const
   {
-    typename AdjacencyMapType::const_iterator it = m_AdjacencyMap.find(label);
-    if(it != m_AdjacencyMap.end())
-      {
-      return it->second;
-      }
-    else
+    return this->FindAdjacencyLabel(label) != m_AdjacencyLabels.size();
+  }
+
+  /** Get the sorted adjacent labels of a given label */
+  AdjacentLabelsRange GetAdjacentLabels(LabelType label) const
+  {
+    const std::size_t index = this->FindAdjacencyLabel(label);
+    if(index == m_AdjacencyLabels.size())
       {
       itkExceptionMacro(<<"No Adjacency set for label "<<label<<".");
       }
+    return AdjacentLabelsRange(m_AdjacentLabels.begin() + m_AdjacencyOffsets[index],
+                               m_AdjacentLabels.begin() + m_AdjacencyOffsets[index + 1]);
   }
 
   /** Merge two label objects. The first label will be the one retained */
   void MergeLabels(const LabelType & label1, const LabelType& label2)
   {
-    // Check if source and destination labels are the same
-    if(label1 == label2)
-      {
-      // If so, there is nothing to merge
-      return;
-      }
-
-    // Check if two labels are adjacent
-    if(m_AdjacencyMap.find(label1) != m_AdjacencyMap.end() && !m_AdjacencyMap[label1].count(label2))
-      {
-      itkExceptionMacro(<<"Labels "<<label1<<" and "<<label2<<" are not adjacent, can not merge.");
-      }
+    this->MergeLabels(LabelPairVectorType(1, LabelPairType(label1, label2)));
+  }
 
-    // Retrieve the two label objects
-    typename LabelObjectType::Pointer lo1 = this->GetLabelObject(label1);
-    typename LabelObjectType::Pointer lo2 = this->GetLabelObject(label2);
+  /** Merge a list of pairs of labels. For each pair, the first label
+   * will be the one retained. The labels of the pairs which have already
+   * been merged stand for their retained label, and the two labels of a
+   * pair must be adjacent, which assumes that the adjacency is
+   * symmetric. The adjacency is rebuilt once, after all the merges. */
+  void MergeLabels(const LabelPairVectorType & labels)
+  {
+    this->Compact();
 
-    // Merges label object
-    MergeFunctorType mergeFunctor;
-    typename LabelObjectType::Pointer loOut = mergeFunctor(lo1, lo2);
+    // Retained label of each merged label
+    RetainedLabelMapType retainedLabels;
+    // Labels merged into each retained label
+    MergedLabelsMapType mergedLabels;
 
-    // Move every occurrence of label2 to label1 in adjacency map
-    for(typename AdjacentLabelsContainerType::iterator it = m_AdjacencyMap[label2].begin();
-        it != m_AdjacencyMap[label2].end(); ++it)
+    for(typename LabelPairVectorType::const_iterator lpit = labels.begin(); lpit != labels.end(); ++lpit)
       {
-      m_AdjacencyMap[*it].erase(label2);
-      if(*it != label1)
+      const LabelType label1 = FindRetainedLabel(retainedLabels, lpit->first);
+      const LabelType label2 = FindRetainedLabel(retainedLabels, lpit->second);
+
+      // Check if source and destination labels are the same
+      if(label1 == label2)
         {
-        m_AdjacencyMap[*it].insert(label1);
-        m_AdjacencyMap[label1].insert(*it);
+        // If so, there is nothing to merge
+        continue;
         }
-      }
 
-    // Remove label2 from adjancency map
-    m_AdjacencyMap.erase(label2);
+      // Check if two labels are adjacent
+      if(!this->AreAdjacent(label1, label2, retainedLabels, mergedLabels))
+        {
+        itkExceptionMacro(<<"Labels "<<label1<<" and "<<label2<<" are not adjacent, can not merge.");
+        }
 
-    // Remove label object corresponding to label2
-    this->RemoveLabel(label2);
+      // Retrieve the two label objects
+      typename LabelObjectType::Pointer lo1 = this->GetLabelObject(label1);
+      typename LabelObjectType::Pointer lo2 = this->GetLabelObject(label2);
 
-    // Replace label object corresponding to label1
-    this->RemoveLabel(label1);
-    this->AddLabelObject(loOut);
-  }
+      // Merges label object
+      MergeFunctorType mergeFunctor;
+      typename LabelObjectType::Pointer loOut = mergeFunctor(lo1, lo2);
 
-  /** Merge a list of pairs of labels. For each pair, the first label
-   * will be the one retained */
-  void MergeLabels(const LabelPairVectorType & labels)
-  {
-    LabelPairVectorType internalLabelPairs = labels;
-
-    typename LabelPairVectorType::iterator lpit1, lpit2;
+      // Remove label object corresponding to label2
+      this->RemoveLabel(label2);
 
-    for (lpit1 = internalLabelPairs.begin(); lpit1 != internalLabelPairs.end(); ++lpit1)
-      {
-      // Merge the current label pair
-      this->MergeLabels(lpit1->first, lpit1->second);
+      // Replace label object corresponding to label1
+      this->RemoveLabel(label1);
+      this->AddLabelObject(loOut);
 
-      // Update the remaining label pairs
-      for (lpit2 = lpit1 + 1; lpit2 != internalLabelPairs.end(); ++lpit2)
+      // Move label2 and the labels merged into it to label1
+      retainedLabels[label2] = label1;
+      LabelVectorType & merged1 = mergedLabels[label1];
+      merged1.push_back(label2);
+      typename MergedLabelsMapType::iterator mit = mergedLabels.find(label2);
+      if(mit != mergedLabels.end())
         {
-        if (lpit2->first == lpit1->second)
+        if(mit->second.size() > merged1.size())
           {
-          lpit2->first = lpit1->first;
+          merged1.swap(mit->second);
           }
-        if (lpit2->second == lpit1->second)
+        merged1.insert(merged1.end(), mit->second.begin(), mit->second.end());
+        mergedLabels.erase(mit);
+        }
+      }
+
+    if(retainedLabels.empty())
+      {
+      return;
+      }
+
+    // Replace every merged label by its retained label in the adjacency
+    LabelVectorType newLabels;
+    LabelPairVectorType labelPairs;
+    labelPairs.reserve(m_AdjacentLabels.size());
+    for(std::size_t i = 0; i < m_AdjacencyLabels.size(); ++i)
+      {
+      const LabelType label = m_AdjacencyLabels[i];
+      const LabelType newLabel = FindRetainedLabel(retainedLabels, label);
+      newLabels.push_back(newLabel);
+      for(std::size_t pos = m_AdjacencyOffsets[i]; pos < m_AdjacencyOffsets[i + 1]; ++pos)
+        {
+        const LabelType adjacentLabel = m_AdjacentLabels[pos];
+        const LabelType newAdjacentLabel = FindRetainedLabel(retainedLabels, adjacentLabel);
+        // Drop the adjacencies between merged labels
+        if(newAdjacentLabel != newLabel || adjacentLabel == label)
           {
-          lpit2->second = lpit1->first;
+          labelPairs.push_back(LabelPairType(newLabel, newAdjacentLabel));
           }
         }
       }
+
+    std::sort(newLabels.begin(), newLabels.end());
+    newLabels.erase(std::unique(newLabels.begin(), newLabels.end()), newLabels.end());
+    std::sort(labelPairs.begin(), labelPairs.end());
+    labelPairs.erase(std::unique(labelPairs.begin(), labelPairs.end()), labelPairs.end());
+    this->BuildAdjacency(newLabels, labelPairs);
+  }
+
+  /** Insert the labels added by AddAdjacentLabel() in the adjacency */
+  void Compact() const
+  {
+    if(m_PendingLabelPairs.empty())
+      {
+      return;
+      }
+
+    LabelPairVectorType labelPairs;
+    labelPairs.swap(m_PendingLabelPairs);
+    LabelVectorType labels = m_AdjacencyLabels;
+    for(typename LabelPairVectorType::const_iterator it = labelPairs.begin(); it != labelPairs.end(); ++it)
+      {
+      labels.push_back(it->first);
+      }
+    labelPairs.reserve(labelPairs.size() + m_AdjacentLabels.size());
+    for(std::size_t i = 0; i < m_AdjacencyLabels.size(); ++i)
+      {
+      for(std::size_t pos = m_AdjacencyOffsets[i]; pos < m_AdjacencyOffsets[i + 1]; ++pos)
+        {
+        labelPairs.push_back(LabelPairType(m_AdjacencyLabels[i], m_AdjacentLabels[pos]));
+        }
+      }
+
+    std::sort(labels.begin(), labels.end());
+    labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+    std::sort(labelPairs.begin(), labelPairs.end());
+    labelPairs.erase(std::unique(labelPairs.begin(), labelPairs.end()), labelPairs.end());
+    this->BuildAdjacency(labels, labelPairs);
   }
 
 protected:
   /** Constructor */
-  LabelMapWithAdjacency(){}
+  LabelMapWithAdjacency() : m_AdjacencyOffsets(1, 0) {}
   /** Destructor */
   ~LabelMapWithAdjacency() override{}
   /** Printself */
   void PrintSelf(std::ostream& os, itk::Indent indent) const override
   {
     Superclass::PrintSelf(os, indent);
+    os << indent << "Number of labels with adjacency: " << m_AdjacencyLabels.size() << std::endl;
+    os << indent << "Number of adjacencies: " << m_AdjacentLabels.size() + m_PendingLabelPairs.size() << std::endl;
   }
 
   /** Re-implement CopyInformation to pass the adjancency graph
@@ -237,15 +448,141 @@ protected:
 
     // If cast succeed
     if(selfData)
-      m_AdjacencyMap = selfData->m_AdjacencyMap;
+      this->CopyAdjacency(selfData);
   }
 
 private:
   LabelMapWithAdjacency(const Self&) = delete;
   void operator=(const Self&) = delete;
 
-  /** The adjacency map */
-  AdjacencyMapType m_AdjacencyMap;
+  typedef std::unordered_map<LabelType, LabelType>       RetainedLabelMapType;
+  typedef std::unordered_map<LabelType, LabelVectorType> MergedLabelsMapType;
+
+  /** Index of a label in m_AdjacencyLabels, or its size if the label has
+   * no adjacency entry */
+  std::size_t FindAdjacencyLabel(LabelType label) const
+  {
+    this->Compact();
+    typename LabelVectorType::const_iterator it =
+      std::lower_bound(m_AdjacencyLabels.begin(), m_AdjacencyLabels.end(), label);
+    if(it != m_AdjacencyLabels.end() && *it == label)
+      {
+      return it - m_AdjacencyLabels.begin();
+      }
+    return m_AdjacencyLabels.size();
+  }
+
+  /** Erase a range of m_AdjacentLabels, which belongs to the label at
+   * the given index */
+  void EraseAdjacentLabels(std::size_t index, std::size_t first, std::size_t last)
+  {
+    m_AdjacentLabels.erase(m_AdjacentLabels.begin() + first, m_AdjacentLabels.begin() + last);
+    for(std::size_t i = index + 1; i < m_AdjacencyOffsets.size(); ++i)
+      {
+      m_AdjacencyOffsets[i] -= last - first;
+      }
+    this->Modified();
+  }
+
+  /** Build the compressed adjacency from the sorted labels and the
+   * sorted and unique pairs (label, adjacent label). The labels must
+   * include the first label of every pair. */
+  void BuildAdjacency(const LabelVectorType & labels, const LabelPairVectorType & labelPairs) const
+  {
+    m_AdjacencyLabels = labels;
+    m_AdjacencyOffsets.assign(labels.size() + 1, 0);
+    m_AdjacentLabels.resize(labelPairs.size());
+
+    std::size_t pos = 0;
+    for(std::size_t i = 0; i < labels.size(); ++i)
+      {
+      while(pos < labelPairs.size() && labelPairs[pos].first == labels[i])
+        {
+        m_AdjacentLabels[pos] = labelPairs[pos].second;
+        ++pos;
+        }
+      m_AdjacencyOffsets[i + 1] = pos;
+      }
+  }
+
+  /** Label retained for a label after the merges so far */
+  static LabelType FindRetainedLabel(RetainedLabelMapType & retainedLabels, LabelType label)
+  {
+    LabelType root = label;
+    typename RetainedLabelMapType::const_iterator it;
+    while((it = retainedLabels.find(root)) != retainedLabels.end())
+      {
+      root = it->second;
+      }
+    // Path compression
+    while(label != root)
+      {
+      LabelType & parent = retainedLabels[label];
+      label = parent;
+      parent = root;
+      }
+    return root;
+  }
+
+  /** Whether two retained labels are adjacent, considering the labels
+   * merged into them so far. As in the map of sets representation,
+   * a label without adjacency entry is adjacent to any label. */
+  bool AreAdjacent(LabelType label1, LabelType label2,
+                   RetainedLabelMapType & retainedLabels,
+                   const MergedLabelsMapType & mergedLabels) const
+  {
+    LabelVectorType members1(1, label1);
+    LabelVectorType members2(1, label2);
+    typename MergedLabelsMapType::const_iterator mit = mergedLabels.find(label1);
+    if(mit != mergedLabels.end())
+      {
+      members1.insert(members1.end(), mit->second.begin(), mit->second.end());
+      }
+    mit = mergedLabels.find(label2);
+    if(mit != mergedLabels.end())
+      {
+      members2.insert(members2.end(), mit->second.begin(), mit->second.end());
+      }
+
+    // Look for an adjacency from the smaller group of labels, the
+    // adjacency being symmetric
+    const bool fromFirst = members1.size() <= members2.size();
+    const LabelVectorType & members = fromFirst ? members1 : members2;
+    const LabelType target = fromFirst ? label2 : label1;
+    for(typename LabelVectorType::const_iterator it = members.begin(); it != members.end(); ++it)
+      {
+      const std::size_t index = this->FindAdjacencyLabel(*it);
+      if(index == m_AdjacencyLabels.size())
+        {
+        continue;
+        }
+      for(std::size_t pos = m_AdjacencyOffsets[index]; pos < m_AdjacencyOffsets[index + 1]; ++pos)
+        {
+        if(FindRetainedLabel(retainedLabels, m_AdjacentLabels[pos]) == target)
+          {
+          return true;
+          }
+        }
+      }
+
+    // Not adjacent: this is only allowed if label1 has no adjacency entry
+    for(typename LabelVectorType::const_iterator it = members1.begin(); it != members1.end(); ++it)
+      {
+      if(this->FindAdjacencyLabel(*it) != m_AdjacencyLabels.size())
+        {
+        return false;
+        }
+      }
+    return true;
+  }
+
+  /** The compressed adjacency */
+  mutable LabelVectorType     m_AdjacencyLabels;
+  mutable OffsetVectorType    m_AdjacencyOffsets;
+  mutable LabelVectorType     m_AdjacentLabels;
+
+  /** Pairs added by AddAdjacentLabel() since the last Compact() */
+  mutable LabelPairVectorType m_PendingLabelPairs;
 };
 
 } // end namespace otb
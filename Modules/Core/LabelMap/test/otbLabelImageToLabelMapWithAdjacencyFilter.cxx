@@ -24,6 +24,7 @@
 #include "otbImageFileReader.h"
 #include "itkNumericTraits.h"
 
+#include <cstdlib>
 #include <fstream>
 
 typedef unsigned short                              LabelType;
@@ -38,7 +39,7 @@ typedef otb::LabelImageToLabelMapWithAdjacencyFilter
 
 
 
-int otbLabelImageToLabelMapWithAdjacencyFilter(int itkNotUsed(argc), char * argv[])
+int otbLabelImageToLabelMapWithAdjacencyFilter(int argc, char * argv[])
 {
   LabelReaderType::Pointer reader = LabelReaderType::New();
   reader->SetFileName(argv[1]);
@@ -46,6 +47,10 @@ int otbLabelImageToLabelMapWithAdjacencyFilter(int itkNotUsed(argc), char * argv
   FilterType::Pointer filter = FilterType::New();
   filter->SetInput(reader->GetOutput());
   filter->SetBackgroundValue(itk::NumericTraits<LabelType>::max());
+  if (argc > 3)
+    {
+    filter->SetNumberOfLinesPerStrip(atoi(argv[3]));
+    }
   filter->Update();
 
   std::ofstream ofs(argv[2]);
@@ -76,16 +81,16 @@ int otbLabelImageToLabelMapWithAdjacencyFilter(int itkNotUsed(argc), char * argv
 
   ofs<<"Adjacency map: "<<std::endl;
 
-  // Retrieve the adjacency map
-  LabelMapType::AdjacencyMapType adjMap = filter->GetOutput()->GetAdjacencyMap();
+  // Retrieve the adjacency
+  const LabelMapType::LabelVectorType & labels = filter->GetOutput()->GetAdjacencyLabels();
 
-  for(LabelMapType::AdjacencyMapType::const_iterator it = adjMap.begin(); it!=adjMap.end(); ++it)
+  for(LabelMapType::LabelVectorType::const_iterator it = labels.begin(); it!=labels.end(); ++it)
     {
-    ofs<<"Label:\t"<<it->first<<" adjacent with labels";
+    ofs<<"Label:\t"<<(*it)<<" adjacent with labels";
 
-    LabelMapType::AdjacentLabelsContainerType::const_iterator lit = it->second.begin();
+    LabelMapType::AdjacentLabelsRange adjacentLabels = filter->GetOutput()->GetAdjacentLabels(*it);
 
-    for(; lit!=it->second.end(); ++lit)
+    for(LabelMapType::AdjacentLabelsRange::const_iterator lit = adjacentLabels.begin(); lit!=adjacentLabels.end(); ++lit)
       {
 
       ofs<<"\t"<<(*lit);
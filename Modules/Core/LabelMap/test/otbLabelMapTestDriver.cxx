@@ -24,6 +24,7 @@ void RegisterTests()
 {
   REGISTER_TEST(otbLabelObjectMapVectorizer);
   REGISTER_TEST(otbLabelImageToLabelMapWithAdjacencyFilter);
+  REGISTER_TEST(otbLabelMapWithAdjacency);
   REGISTER_TEST(otbImageToLabelMapWithAttributesFilter);
   REGISTER_TEST(otbKMeansAttributesLabelMapFilter);
   REGISTER_TEST(otbLabelMapToSampleListFilter);
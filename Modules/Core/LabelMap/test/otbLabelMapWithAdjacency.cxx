@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbLabelMapWithAdjacency.h"
+#include "itkLabelObject.h"
+
+#include <iostream>
+
+typedef unsigned int                                LabelType;
+typedef itk::LabelObject<LabelType, 2>              LabelObjectType;
+typedef otb::LabelMapWithAdjacency<LabelObjectType> LabelMapType;
+typedef LabelMapType::AdjacencyMapType              AdjacencyMapType;
+typedef LabelMapType::LabelPairVectorType           LabelPairVectorType;
+
+namespace
+{
+// Merge two labels of an adjacency map, as the map of sets representation did
+void MergeReferenceLabels(AdjacencyMapType & adjMap, LabelType label1, LabelType label2)
+{
+  AdjacencyMapType::mapped_type adjacentLabels2 = adjMap[label2];
+  for (AdjacencyMapType::mapped_type::const_iterator it = adjacentLabels2.begin(); it != adjacentLabels2.end(); ++it)
+    {
+    adjMap[*it].erase(label2);
+    if (*it != label1)
+      {
+      adjMap[*it].insert(label1);
+      adjMap[label1].insert(*it);
+      }
+    }
+  adjMap.erase(label2);
+}
+
+bool CheckAdjacency(const LabelMapType * labelMap, const AdjacencyMapType & reference, const char * step)
+{
+  if (labelMap->GetAdjacencyMap() != reference)
+    {
+    std::cerr << "Wrong adjacency after " << step << std::endl;
+    return false;
+    }
+  return true;
+}
+}
+
+int otbLabelMapWithAdjacency(int itkNotUsed(argc), char * itkNotUsed(argv) [])
+{
+  // A grid of square objects, each of them adjacent to its 4 neighbors
+  const unsigned int gridSize = 20;
+  const unsigned int objectSize = 3;
+
+  LabelMapType::Pointer labelMap = LabelMapType::New();
+  AdjacencyMapType reference;
+
+  for (unsigned int y = 0; y < gridSize; ++y)
+    {
+    for (unsigned int x = 0; x < gridSize; ++x)
+      {
+      const LabelType label = y * gridSize + x + 1;
+      LabelObjectType::Pointer labelObject = LabelObjectType::New();
+      labelObject->SetLabel(label);
+      for (unsigned int line = 0; line < objectSize; ++line)
+        {
+        LabelObjectType::IndexType index;
+        index[0] = x * objectSize;
+        index[1] = y * objectSize + line;
+        labelObject->AddLine(index, objectSize);
+        }
+      labelMap->AddLabelObject(labelObject);
+
+      if (x > 0)
+        {
+        labelMap->AddAdjacentLabel(label, label - 1);
+        labelMap->AddAdjacentLabel(label - 1, label);
+        reference[label].insert(label - 1);
+        reference[label - 1].insert(label);
+        }
+      if (y > 0)
+        {
+        labelMap->AddAdjacentLabel(label, label - gridSize);
+        labelMap->AddAdjacentLabel(label - gridSize, label);
+        reference[label].insert(label - gridSize);
+        reference[label - gridSize].insert(label);
+        }
+      }
+    }
+
+  bool success = CheckAdjacency(labelMap, reference, "construction");
+
+  if (labelMap->GetNumberOfAdjacencies() != 4 * gridSize * (gridSize - 1)
+      || !labelMap->GetAdjacentLabels(1).count(2) || labelMap->GetAdjacentLabels(1).size() != 2)
+    {
+    std::cerr << "Wrong number of adjacencies" << std::endl;
+    success = false;
+    }
+
+  // Merge pairs of neighbor objects, which stay adjacent or merged
+  LabelPairVectorType pairs;
+  unsigned int seed = 12345;
+  for (unsigned int i = 0; i < gridSize * gridSize / 2; ++i)
+    {
+    seed = seed * 1103515245 + 12345;
+    const LabelType label = (seed >> 8) % (gridSize * (gridSize - 1)) + 1;
+    if ((seed >> 4) & 1)
+      {
+      pairs.push_back(std::make_pair(label + gridSize, label));
+      }
+    else
+      {
+      pairs.push_back(std::make_pair(label, (label % gridSize) ? label + 1 : label - 1));
+      }
+    }
+
+  // Expected result, merging the pairs one after the other
+  LabelPairVectorType remainingPairs = pairs;
+  std::size_t nbMerges = 0;
+  for (LabelPairVectorType::iterator lpit1 = remainingPairs.begin(); lpit1 != remainingPairs.end(); ++lpit1)
+    {
+    if (lpit1->first == lpit1->second)
+      {
+      continue;
+      }
+    MergeReferenceLabels(reference, lpit1->first, lpit1->second);
+    ++nbMerges;
+    for (LabelPairVectorType::iterator lpit2 = lpit1 + 1; lpit2 != remainingPairs.end(); ++lpit2)
+      {
+      if (lpit2->first == lpit1->second)
+        {
+        lpit2->first = lpit1->first;
+        }
+      if (lpit2->second == lpit1->second)
+        {
+        lpit2->second = lpit1->first;
+        }
+      }
+    }
+
+  labelMap->MergeLabels(pairs);
+
+  success = CheckAdjacency(labelMap, reference, "merging") && success;
+
+  if (labelMap->GetNumberOfLabelObjects() != gridSize * gridSize - nbMerges)
+    {
+    std::cerr << "Wrong number of label objects after merging" << std::endl;
+    success = false;
+    }
+
+  // Two labels which are not adjacent can not be merged
+  const LabelType first = reference.begin()->first;
+  const LabelType last = reference.rbegin()->first;
+  if (!reference[first].count(last))
+    {
+    try
+      {
+      labelMap->MergeLabels(first, last);
+      std::cerr << "Labels " << first << " and " << last << " should not be merged" << std::endl;
+      success = false;
+      }
+    catch (itk::ExceptionObject &)
+      {
+      }
+    }
+
+  // Edit the adjacency
+  const LabelType adjacentLabel = *reference[first].begin();
+  labelMap->RemoveAdjacentLabel(first, adjacentLabel);
+  reference[first].erase(adjacentLabel);
+  labelMap->ClearAdjacentLabels(last);
+  reference[last].clear();
+  labelMap->AddAdjacentLabel(first, last);
+  reference[first].insert(last);
+
+  success = CheckAdjacency(labelMap, reference, "editing") && success;
+
+  // Conversion from a map of sets
+  LabelMapType::Pointer copy = LabelMapType::New();
+  copy->SetAdjacencyMap(reference);
+
+  success = CheckAdjacency(copy, reference, "conversion") && success;
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbAdaptiveTransformToDisplacementFieldSource_h
+#define otbAdaptiveTransformToDisplacementFieldSource_h
+
+#include "itkTransformToDisplacementFieldSource.h"
+
+namespace otb
+{
+
+/** \class AdaptiveTransformToDisplacementFieldSource
+ *  \brief Generate a displacement field from a transform, evaluating the
+ *  transform only where bilinear interpolation is not accurate enough.
+ *
+ *  The requested region is divided into cells of InitialCellSize nodes
+ *  along each side. The transform is evaluated at the corners of the
+ *  cells, then at the center and at the middle of the edges of each cell.
+ *  If the displacement at one of these probes differs from the bilinear
+ *  interpolation of the corners by more than MaximumError, the cell is
+ *  split in four and the probes are the corners of the sub-cells. The
+ *  remaining nodes are interpolated from the corners of the smallest cell
+ *  containing them.
+ *
+ *  The initial cells are aligned on the largest possible region, and each
+ *  thread refines all the cells which contain a node of its region, so the
+ *  field does not depend on the number of threads nor on the streaming.
+ *
+ *  MaximumError is expressed in the units of the transform output, for
+ *  each dimension. When it is null (the default), or if the transform is
+ *  linear, the transform is evaluated at every node as in
+ *  itk::TransformToDisplacementFieldSource. Only 2D fields are refined.
+ *
+ *  The probes of all the cells of a refinement level are transformed in a
+ *  single call to BatchTransformPoints().
+ *
+ * \ingroup Transform
+ *
+ * \ingroup OTBTransform
+ */
+template <class TOutputImage, class TTransformPrecisionType = double>
+class ITK_EXPORT AdaptiveTransformToDisplacementFieldSource :
+    public itk::TransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>
+{
+public:
+  /** Standard class typedefs. */
+  typedef AdaptiveTransformToDisplacementFieldSource          Self;
+  typedef itk::TransformToDisplacementFieldSource<TOutputImage,
+                                                  TTransformPrecisionType> Superclass;
+  typedef itk::SmartPointer<Self>                             Pointer;
+  typedef itk::SmartPointer<const Self>                       ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(AdaptiveTransformToDisplacementFieldSource, itk::TransformToDisplacementFieldSource);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  typedef typename Superclass::OutputImageType       OutputImageType;
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+  typedef typename Superclass::TransformType         TransformType;
+  typedef typename Superclass::PixelType             PixelType;
+  typedef typename Superclass::PixelValueType        PixelValueType;
+  typedef typename Superclass::IndexType             IndexType;
+  typedef typename Superclass::PointType             PointType;
+
+  /** Tolerance on the interpolated transform, for each dimension */
+  typedef itk::Vector<double, TOutputImage::ImageDimension> ErrorType;
+
+  /** Set/Get the maximum interpolation error */
+  itkSetMacro(MaximumError, ErrorType);
+  itkGetConstReferenceMacro(MaximumError, ErrorType);
+
+  /** Set/Get the size of the initial cells, in nodes (default 16) */
+  itkSetClampMacro(InitialCellSize, unsigned int, 1, itk::NumericTraits<unsigned int>::max());
+  itkGetConstMacro(InitialCellSize, unsigned int);
+
+protected:
+  AdaptiveTransformToDisplacementFieldSource();
+  ~AdaptiveTransformToDisplacementFieldSource() override {}
+
+  void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                            itk::ThreadIdType threadId) override;
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+private:
+  AdaptiveTransformToDisplacementFieldSource(const Self &) = delete;
+  void operator =(const Self&) = delete;
+
+  /** Refine the displacement field of a 2D region */
+  void AdaptiveThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                                    itk::ThreadIdType threadId);
+
+  ErrorType    m_MaximumError;
+  unsigned int m_InitialCellSize;
+};
+
+} // namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbAdaptiveTransformToDisplacementFieldSource.hxx"
+#endif
+
+#endif
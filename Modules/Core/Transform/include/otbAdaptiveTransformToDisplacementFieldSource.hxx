@@ -0,0 +1,338 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbAdaptiveTransformToDisplacementFieldSource_hxx
+#define otbAdaptiveTransformToDisplacementFieldSource_hxx
+
+#include "otbAdaptiveTransformToDisplacementFieldSource.h"
+#include "otbTransform.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace otb
+{
+
+template <class TOutputImage, class TTransformPrecisionType>
+AdaptiveTransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>
+::AdaptiveTransformToDisplacementFieldSource()
+  : m_InitialCellSize(16)
+{
+  m_MaximumError.Fill(0.);
+}
+
+template <class TOutputImage, class TTransformPrecisionType>
+void
+AdaptiveTransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>
+::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                       itk::ThreadIdType threadId)
+{
+  bool adaptive = (ImageDimension == 2) && !this->GetTransform()->IsLinear();
+  for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+    {
+    adaptive = adaptive && m_MaximumError[dim] > 0.;
+    }
+
+  if (adaptive)
+    {
+    this->AdaptiveThreadedGenerateData(outputRegionForThread, threadId);
+    }
+  else
+    {
+    Superclass::ThreadedGenerateData(outputRegionForThread, threadId);
+    }
+}
+
+template <class TOutputImage, class TTransformPrecisionType>
+void
+AdaptiveTransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>
+::AdaptiveThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                               itk::ThreadIdType threadId)
+{
+  typedef typename TransformType::InputPointType  TransformInputPointType;
+  typedef typename TransformType::OutputPointType TransformOutputPointType;
+
+  // A cell, defined by its first and last nodes (included)
+  struct Cell
+  {
+    unsigned int x0, y0, x1, y1;
+  };
+
+  // Node states
+  const unsigned char Unknown = 0;
+  const unsigned char Pending = 1;
+  const unsigned char Exact = 2;
+  const unsigned char Interpolated = 3;
+
+  OutputImageType * outputPtr = this->GetOutput();
+  const TransformType * transform = this->GetTransform();
+
+  if (outputRegionForThread.GetNumberOfPixels() == 0)
+    {
+    return;
+    }
+
+  // The initial cells are aligned on the largest possible region, and the
+  // region is padded by one cell, so that every cell containing a node of
+  // the region is refined in full: the field does not depend on how the
+  // requested region is split among the threads or the streamed regions
+  const OutputImageRegionType & largestRegion = outputPtr->GetLargestPossibleRegion();
+  const long cellSize = m_InitialCellSize;
+  IndexType start;
+  unsigned int sizes[ImageDimension];
+  for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+    {
+    const long origin = largestRegion.GetIndex(dim);
+    const long last = origin + static_cast<long>(largestRegion.GetSize(dim)) - 1;
+    const long first = outputRegionForThread.GetIndex(dim) - origin;
+    const long end = first + static_cast<long>(outputRegionForThread.GetSize(dim)) - 1;
+    start[dim] = std::max(origin, origin + (first / cellSize - 1) * cellSize);
+    sizes[dim] = std::min(last, origin + ((end + cellSize - 1) / cellSize + 1) * cellSize) - start[dim] + 1;
+    }
+  const unsigned int nx = sizes[0];
+  const unsigned int ny = sizes[1];
+
+  std::vector<PixelType> field(nx * ny);
+  std::vector<unsigned char> state(nx * ny, Unknown);
+
+  // Nodes waiting for the transform
+  std::vector<unsigned int> pending;
+  auto request = [&](unsigned int x, unsigned int y)
+  {
+    const unsigned int id = y * nx + x;
+    if (state[id] == Unknown)
+      {
+      state[id] = Pending;
+      pending.push_back(id);
+      }
+  };
+
+  // Transform all the pending nodes at once
+  std::vector<PointType>               outputPoints;
+  std::vector<TransformInputPointType>  inputPoints;
+  std::vector<TransformOutputPointType> transformedPoints;
+  auto evaluate = [&]()
+  {
+    outputPoints.resize(pending.size());
+    inputPoints.resize(pending.size());
+    transformedPoints.resize(pending.size());
+    for (unsigned int k = 0; k < pending.size(); ++k)
+      {
+      IndexType index = start;
+      index[0] += pending[k] % nx;
+      index[1] += pending[k] / nx;
+      outputPtr->TransformIndexToPhysicalPoint(index, outputPoints[k]);
+      for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+        {
+        inputPoints[k][dim] = outputPoints[k][dim];
+        }
+      }
+    BatchTransformPoints(transform, inputPoints.data(), transformedPoints.data(), pending.size());
+    for (unsigned int k = 0; k < pending.size(); ++k)
+      {
+      PixelType & deformation = field[pending[k]];
+      for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+        {
+        deformation[dim] = static_cast<PixelValueType>(transformedPoints[k][dim] - outputPoints[k][dim]);
+        }
+      state[pending[k]] = Exact;
+      }
+    pending.clear();
+  };
+
+  // Bilinear interpolation of the corners of a cell
+  auto interpolate = [&](const Cell & cell, unsigned int x, unsigned int y, unsigned int dim)
+  {
+    const double tx = cell.x1 > cell.x0 ? static_cast<double>(x - cell.x0) / (cell.x1 - cell.x0) : 0.;
+    const double ty = cell.y1 > cell.y0 ? static_cast<double>(y - cell.y0) / (cell.y1 - cell.y0) : 0.;
+    const double top = (1. - tx) * field[cell.y0 * nx + cell.x0][dim] + tx * field[cell.y0 * nx + cell.x1][dim];
+    const double bottom = (1. - tx) * field[cell.y1 * nx + cell.x0][dim] + tx * field[cell.y1 * nx + cell.x1][dim];
+    return (1. - ty) * top + ty * bottom;
+  };
+
+  // Initial cells
+  std::vector<Cell> cells;
+  for (unsigned int y0 = 0; ; y0 += m_InitialCellSize)
+    {
+    const unsigned int y1 = std::min(y0 + m_InitialCellSize, ny - 1);
+    for (unsigned int x0 = 0; ; x0 += m_InitialCellSize)
+      {
+      const unsigned int x1 = std::min(x0 + m_InitialCellSize, nx - 1);
+      cells.push_back(Cell{x0, y0, x1, y1});
+      request(x0, y0);
+      request(x1, y0);
+      request(x0, y1);
+      request(x1, y1);
+      if (x1 == nx - 1)
+        {
+        break;
+        }
+      }
+    if (y1 == ny - 1)
+      {
+      break;
+      }
+    }
+  evaluate();
+
+  // Refine the cells level by level
+  std::vector<Cell> accepted;
+  std::vector<Cell> tested;
+  std::vector<Cell> refined;
+  while (!cells.empty())
+    {
+    tested.clear();
+    for (const Cell & cell : cells)
+      {
+      if (cell.x1 - cell.x0 > 1 || cell.y1 - cell.y0 > 1)
+        {
+        const unsigned int mx = (cell.x0 + cell.x1) / 2;
+        const unsigned int my = (cell.y0 + cell.y1) / 2;
+        request(mx, my);
+        request(mx, cell.y0);
+        request(mx, cell.y1);
+        request(cell.x0, my);
+        request(cell.x1, my);
+        tested.push_back(cell);
+        }
+      else
+        {
+        // No node inside the cell
+        accepted.push_back(cell);
+        }
+      }
+    evaluate();
+
+    refined.clear();
+    for (const Cell & cell : tested)
+      {
+      const unsigned int mx = (cell.x0 + cell.x1) / 2;
+      const unsigned int my = (cell.y0 + cell.y1) / 2;
+      const unsigned int probes[5][2] = {{mx, my}, {mx, cell.y0}, {mx, cell.y1}, {cell.x0, my}, {cell.x1, my}};
+
+      bool accurate = true;
+      for (unsigned int p = 0; p < 5 && accurate; ++p)
+        {
+        const PixelType & exact = field[probes[p][1] * nx + probes[p][0]];
+        for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+          {
+          if (std::abs(exact[dim] - interpolate(cell, probes[p][0], probes[p][1], dim)) > m_MaximumError[dim])
+            {
+            accurate = false;
+            break;
+            }
+          }
+        }
+
+      if (accurate)
+        {
+        accepted.push_back(cell);
+        continue;
+        }
+
+      // Split the cell along the dimensions where it has inner nodes
+      const unsigned int xs[3] = {cell.x0, mx, cell.x1};
+      const unsigned int ys[3] = {cell.y0, my, cell.y1};
+      const unsigned int nbx = cell.x1 - cell.x0 > 1 ? 2 : 1;
+      const unsigned int nby = cell.y1 - cell.y0 > 1 ? 2 : 1;
+      for (unsigned int j = 0; j < nby; ++j)
+        {
+        for (unsigned int i = 0; i < nbx; ++i)
+          {
+          Cell child;
+          child.x0 = xs[i];
+          child.x1 = nbx == 2 ? xs[i + 1] : cell.x1;
+          child.y0 = ys[j];
+          child.y1 = nby == 2 ? ys[j + 1] : cell.y1;
+          refined.push_back(child);
+          }
+        }
+      }
+    cells.swap(refined);
+    }
+
+  // Interpolate the remaining nodes, from the smallest cells first so that
+  // nodes shared with a larger cell use the most accurate corners. Cells of
+  // the same area are taken in raster order, so that the order does not
+  // depend on the padded region.
+  std::sort(accepted.begin(), accepted.end(), [](const Cell & a, const Cell & b)
+    {
+    const unsigned int areaA = (a.x1 - a.x0) * (a.y1 - a.y0);
+    const unsigned int areaB = (b.x1 - b.x0) * (b.y1 - b.y0);
+    if (areaA != areaB)
+      {
+      return areaA < areaB;
+      }
+    if (a.y0 != b.y0)
+      {
+      return a.y0 < b.y0;
+      }
+    if (a.x0 != b.x0)
+      {
+      return a.x0 < b.x0;
+      }
+    return a.y1 != b.y1 ? a.y1 < b.y1 : a.x1 < b.x1;
+    });
+  for (const Cell & cell : accepted)
+    {
+    for (unsigned int y = cell.y0; y <= cell.y1; ++y)
+      {
+      for (unsigned int x = cell.x0; x <= cell.x1; ++x)
+        {
+        const unsigned int id = y * nx + x;
+        if (state[id] == Unknown)
+          {
+          for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+            {
+            field[id][dim] = static_cast<PixelValueType>(interpolate(cell, x, y, dim));
+            }
+          state[id] = Interpolated;
+          }
+        }
+      }
+    }
+
+  // Fill the output
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+  itk::ImageRegionIteratorWithIndex<OutputImageType> outIt(outputPtr, outputRegionForThread);
+  for (outIt.GoToBegin(); !outIt.IsAtEnd(); ++outIt)
+    {
+    const IndexType & index = outIt.GetIndex();
+    outIt.Set(field[(index[1] - start[1]) * nx + index[0] - start[0]]);
+    progress.CompletedPixel();
+    }
+}
+
+template <class TOutputImage, class TTransformPrecisionType>
+void
+AdaptiveTransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "MaximumError: " << m_MaximumError << std::endl;
+  os << indent << "InitialCellSize: " << m_InitialCellSize << std::endl;
+}
+
+} // namespace otb
+
+#endif
@@ -119,6 +119,12 @@ public:
   /**  Method to transform a point. */
   SecondTransformOutputPointType TransformPoint(const FirstTransformInputPointType&) const override;
 
+  /**  Method to transform an array of points: each transform processes the
+   *  whole array, through its own batch method when it has one. */
+  void TransformPoints(const FirstTransformInputPointType * inputPoints,
+                       SecondTransformOutputPointType * outputPoints,
+                       std::size_t count) const override;
+
   /**  Method to transform a vector. */
   //  virtual OutputVectorType TransformVector(const InputVectorType &) const;
 
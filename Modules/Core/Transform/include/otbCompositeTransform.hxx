@@ -28,6 +28,8 @@
 #include "otbInverseSensorModel.h"
 #include "itkIdentityTransform.h"
 
+#include <vector>
+
 namespace otb
 {
 
@@ -89,6 +91,26 @@ CompositeTransform<TFirstTransform,
   return outputPoint;
 }
 
+template<class TFirstTransform,
+    class TSecondTransform,
+    class TScalarType,
+    unsigned int NInputDimensions,
+    unsigned int NOutputDimensions>
+void
+CompositeTransform<TFirstTransform,
+    TSecondTransform,
+    TScalarType,
+    NInputDimensions,
+    NOutputDimensions>
+::TransformPoints(const FirstTransformInputPointType * inputPoints,
+                  SecondTransformOutputPointType * outputPoints,
+                  std::size_t count) const
+{
+  std::vector<FirstTransformOutputPointType> geoPoints(count);
+  BatchTransformPoints(m_FirstTransform.GetPointer(), inputPoints, geoPoints.data(), count);
+  BatchTransformPoints(m_SecondTransform.GetPointer(), geoPoints.data(), outputPoints, count);
+}
+
 /*template<class TFirstTransform, class TSecondTransform, class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
   typename CompositeTransform<TFirstTransform, TSecondTransform, TScalarType, NInputDimensions, NOutputDimensions>::OutputVectorType
   CompositeTransform<TFirstTransform, TSecondTransform, TScalarType, NInputDimensions, NOutputDimensions>
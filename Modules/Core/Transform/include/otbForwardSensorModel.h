@@ -76,6 +76,12 @@ public:
   /** Compute the world coordinates. */
   OutputPointType TransformPoint(const InputPointType& point) const override;
 
+  /** Transform an array of points with a single call to the sensor model
+   * adapter */
+  void TransformPoints(const InputPointType * inputPoints,
+                       OutputPointType * outputPoints,
+                       std::size_t count) const override;
+
 protected:
   ForwardSensorModel();
   ~ForwardSensorModel() override;
@@ -24,6 +24,8 @@
 #include "otbForwardSensorModel.h"
 #include "otbMacro.h"
 
+#include <vector>
+
 namespace otb
 {
 
@@ -69,6 +71,39 @@ ForwardSensorModel<TScalarType, NInputDimensions, NOutputDimensions>
   return outputPoint;
 }
 
+template <class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
+void
+ForwardSensorModel<TScalarType, NInputDimensions, NOutputDimensions>
+::TransformPoints(const InputPointType * inputPoints, OutputPointType * outputPoints, std::size_t count) const
+{
+  const bool hasHeight = (InputPointType::PointDimension == 3);
+
+  std::vector<double> x(count), y(count), z(hasHeight ? count : 0);
+  for (std::size_t i = 0; i < count; ++i)
+    {
+    x[i] = inputPoints[i][0];
+    y[i] = inputPoints[i][1];
+    if (hasHeight)
+      {
+      z[i] = inputPoints[i][2];
+      }
+    }
+
+  std::vector<double> lon(count), lat(count), h(count);
+  this->m_Model->ForwardTransformPoints(count, x.data(), y.data(), hasHeight ? z.data() : nullptr,
+                                       lon.data(), lat.data(), h.data());
+
+  for (std::size_t i = 0; i < count; ++i)
+    {
+    outputPoints[i][0] = lon[i];
+    outputPoints[i][1] = lat[i];
+    if (OutputPointType::PointDimension == 3)
+      {
+      outputPoints[i][2] = h[i];
+      }
+    }
+}
+
 template <class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
 void
 ForwardSensorModel<TScalarType, NInputDimensions, NOutputDimensions>
@@ -171,6 +171,13 @@ public:
 
   OutputPointType TransformPoint(const InputPointType& point) const override;
 
+  /** Transform an array of points. Sensor models and DEM queries are
+   * evaluated once for the whole array, which is much faster than
+   * calling TransformPoint() on each point. */
+  void TransformPoints(const InputPointType * inputPoints,
+                       OutputPointType * outputPoints,
+                       std::size_t count) const override;
+
   virtual void  InstantiateTransform();
   
   // Get inverse methods
@@ -30,6 +30,8 @@
 
 #include "ogr_spatialref.h"
 
+#include <vector>
+
 namespace otb
 {
 
@@ -280,6 +282,30 @@ GenericRSTransform<TScalarType, NInputDimensions, NOutputDimensions>
   return outputPoint;
 }
 
+template<class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
+void
+GenericRSTransform<TScalarType, NInputDimensions, NOutputDimensions>
+::TransformPoints(const InputPointType * inputPoints, OutputPointType * outputPoints, std::size_t count) const
+{
+  // Apply input origin/spacing
+  std::vector<InputPointType> points(inputPoints, inputPoints + count);
+  for (auto & inputPoint : points)
+    {
+    inputPoint[0] = inputPoint[0] * m_InputSpacing[0] + m_InputOrigin[0];
+    inputPoint[1] = inputPoint[1] * m_InputSpacing[1] + m_InputOrigin[1];
+    }
+
+  // Transform points
+  this->GetTransform()->TransformPoints(points.data(), outputPoints, count);
+
+  // Apply output origin/spacing
+  for (std::size_t i = 0; i < count; ++i)
+    {
+    outputPoints[i][0] = (outputPoints[i][0] - m_OutputOrigin[0]) / m_OutputSpacing[0];
+    outputPoints[i][1] = (outputPoints[i][1] - m_OutputOrigin[1]) / m_OutputSpacing[1];
+    }
+}
+
 template<class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
 bool
 GenericRSTransform<TScalarType, NInputDimensions, NOutputDimensions>
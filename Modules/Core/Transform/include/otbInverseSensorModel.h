@@ -75,6 +75,12 @@ public:
 
   // Transform of geographic point in image sensor index
   OutputPointType TransformPoint(const InputPointType& point) const override;
+
+  /** Transform an array of points with a single call to the sensor model
+   * adapter, which queries the DEM once for all the points */
+  void TransformPoints(const InputPointType * inputPoints,
+                       OutputPointType * outputPoints,
+                       std::size_t count) const override;
   // Transform of geographic point in image sensor index -- Backward Compatibility
   //  OutputPointType TransformPoint(const InputPointType &point, double height) const;
 
@@ -24,6 +24,8 @@
 #include "otbInverseSensorModel.h"
 #include "otbMacro.h"
 
+#include <vector>
+
 namespace otb
 {
 
@@ -73,6 +75,39 @@ InverseSensorModel<TScalarType, NInputDimensions, NOutputDimensions>
 }
 
 
+template <class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
+void
+InverseSensorModel<TScalarType, NInputDimensions, NOutputDimensions>
+::TransformPoints(const InputPointType * inputPoints, OutputPointType * outputPoints, std::size_t count) const
+{
+  const bool hasHeight = (InputPointType::PointDimension == 3);
+
+  std::vector<double> lon(count), lat(count), h(hasHeight ? count : 0);
+  for (std::size_t i = 0; i < count; ++i)
+    {
+    lon[i] = inputPoints[i][0];
+    lat[i] = inputPoints[i][1];
+    if (hasHeight)
+      {
+      h[i] = inputPoints[i][2];
+      }
+    }
+
+  std::vector<double> x(count), y(count), z(count);
+  this->m_Model->InverseTransformPoints(count, lon.data(), lat.data(), hasHeight ? h.data() : nullptr,
+                                       x.data(), y.data(), z.data());
+
+  for (std::size_t i = 0; i < count; ++i)
+    {
+    outputPoints[i][0] = x[i];
+    outputPoints[i][1] = y[i];
+    if (OutputPointType::PointDimension == 3)
+      {
+      outputPoints[i][2] = z[i];
+      }
+    }
+}
+
 template <class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
 void
 InverseSensorModel<TScalarType, NInputDimensions, NOutputDimensions>
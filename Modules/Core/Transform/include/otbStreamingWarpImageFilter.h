@@ -23,6 +23,10 @@
 
 #include "itkWarpImageFilter.h"
 #include "otbStreamingTraits.h"
+#include "itkContinuousIndex.h"
+
+#include <utility>
+#include <vector>
 
 namespace otb
 {
@@ -40,6 +44,13 @@ namespace otb
  * If the maximum displacement is wrong, this filter is likely to request data outside of the input image buffered region. In this case, pixels
  * outside the region will be set to Zero according to itk::NumericTraits.
  *
+ * The input requested region is the bounding box of the input positions of the displacement field nodes. With strong relief or SAR
+ * geometry, this box can be much larger than the input area actually sampled. The output requested region is therefore split in two
+ * halves as long as the sum of their input bounding boxes is smaller than the bounding box of the whole region by a factor of at least
+ * MinimumSplitGain (blocks are not split below 32 pixels, nor when their input region is below 256x256 pixels). GenerateData() then
+ * updates the input and warps the blocks one after the other, so that only the input pixels around the sampled positions are read.
+ * A gain of 1 or less disables the splitting.
+ *
  * \sa itk::WarpImageFilter
  *
  * \ingroup Streamed
@@ -79,11 +90,19 @@ public:
   typedef typename DisplacementFieldType::PixelType  DisplacementValueType;
   typedef typename DisplacementFieldType::Pointer    DisplacementFieldPointerType;
   typedef typename DisplacementFieldType::RegionType DisplacementFieldRegionType;
+  typedef typename InputImageType::RegionType        InputImageRegionType;
+  typedef itk::ContinuousIndex<double,
+                               InputImageType::ImageDimension> NodePositionType;
 
   /** Accessors */
   itkSetMacro(MaximumDisplacement, DisplacementValueType);
   itkGetConstReferenceMacro(MaximumDisplacement, DisplacementValueType);
 
+  /** Set/Get the minimum reduction of the input region size needed to
+   * split an output region (default 1.5) */
+  itkSetMacro(MinimumSplitGain, double);
+  itkGetConstMacro(MinimumSplitGain, double);
+
   const SpacingType & GetOutputSpacing() const override
   {
     return m_OutputSignedSpacing;
@@ -107,6 +126,10 @@ protected:
 
   void GenerateOutputInformation() override;
 
+  /** Warp the blocks of the output region one after the other when the
+   * region has been split */
+  void GenerateData() override;
+
   /**
    * Re-implement the method ThreadedGenerateData to mask area outside the deformation grid
    */
@@ -121,8 +144,33 @@ private:
   //signed spacing
   SpacingType m_OutputSignedSpacing;
 
+  /** Displacement field region needed to warp an output region. Returns
+   * false if it does not intersect the displacement field. */
+  bool ComputeDisplacementFieldRegion(const OutputImageRegionType & outputRegion,
+                                      DisplacementFieldRegionType & fieldRegion) const;
+
+  /** Compute the input positions of the nodes of a field region */
+  void ComputeNodePositions(const DisplacementFieldRegionType & fieldRegion);
+
+  /** Input region needed to warp an output region, from the node
+   * positions, padded by the interpolator radius */
+  InputImageRegionType ComputeInputRegion(const OutputImageRegionType & outputRegion) const;
+
+  /** Split an output region while the split reduces the input region
+   * size, and append the blocks to m_Blocks */
+  void SplitOutputRegion(const OutputImageRegionType & outputRegion, const InputImageRegionType & inputRegion);
+
   // Assessment of the maximum displacement for streaming
   DisplacementValueType m_MaximumDisplacement;
+
+  double m_MinimumSplitGain;
+
+  /** Input positions of the nodes of m_NodeRegion, while splitting */
+  std::vector<NodePositionType> m_NodePositions;
+  DisplacementFieldRegionType   m_NodeRegion;
+
+  /** Output blocks and their input requested region */
+  std::vector<std::pair<OutputImageRegionType, InputImageRegionType> > m_Blocks;
 };
 
 } // end namespace otb
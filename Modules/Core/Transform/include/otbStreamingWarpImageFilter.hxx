@@ -24,9 +24,15 @@
 
 #include "otbStreamingWarpImageFilter.h"
 #include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkDefaultConvertPixelTraits.h"
 #include "itkMetaDataObject.h"
 #include "otbMetaDataKey.h"
+#include "otbMacro.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace otb
 {
@@ -37,6 +43,7 @@ StreamingWarpImageFilter<TInputImage, TOutputImage, TDisplacementField>
  {
   // Fill the default maximum displacement
   m_MaximumDisplacement.Fill(1);
+  m_MinimumSplitGain = 1.5;
   m_OutputSignedSpacing = this->Superclass::GetOutputSpacing();
  }
 
@@ -108,37 +115,9 @@ StreamingWarpImageFilter<TInputImage, TOutputImage, TDisplacementField>
   // 1) First, evaluate the displacement field requested region corresponding to the output requested region
   // (Here we suppose that the displacement field and the output image are in the same geometry/map projection)
   typename OutputImageType::RegionType outputRequestedRegion = outputPtr->GetRequestedRegion();
-  typename OutputImageType::IndexType outIndexStart = outputRequestedRegion.GetIndex();
-  typename OutputImageType::IndexType outIndexEnd;
-  for(unsigned int dim = 0; dim<OutputImageType::ImageDimension; ++dim)
-    outIndexEnd[dim]= outIndexStart[dim] + outputRequestedRegion.GetSize()[dim]-1;
-  typename OutputImageType::PointType outPointStart, outPointEnd;
-  outputPtr->TransformIndexToPhysicalPoint(outIndexStart, outPointStart);
-  outputPtr->TransformIndexToPhysicalPoint(outIndexEnd, outPointEnd);
-
-  typename DisplacementFieldType::IndexType defIndexStart, defIndexEnd;
-  displacementPtr->TransformPhysicalPointToIndex(outPointStart, defIndexStart);
-  displacementPtr->TransformPhysicalPointToIndex(outPointEnd, defIndexEnd);
-
-  typename DisplacementFieldType::SizeType defRequestedSize;
-  typename DisplacementFieldType::IndexType defRequestedIndex;
-
-  for(unsigned int dim = 0; dim<OutputImageType::ImageDimension; ++dim)
-    {
-    defRequestedIndex[dim] = std::min(defIndexStart[dim], defIndexEnd[dim]);
-    defRequestedSize[dim] = std::max(defIndexStart[dim], defIndexEnd[dim]) - defRequestedIndex[dim] + 1;
-    }
-
-  // Finally, build the displacement field requested region
   typename DisplacementFieldType::RegionType displacementRequestedRegion;
-  displacementRequestedRegion.SetIndex(defRequestedIndex);
-  displacementRequestedRegion.SetSize(defRequestedSize);
 
-  // Avoid extrapolation
-  displacementRequestedRegion.PadByRadius(1);
-
-  // crop the input requested region at the input's largest possible region
-  if (displacementRequestedRegion.Crop(displacementPtr->GetLargestPossibleRegion()))
+  if (this->ComputeDisplacementFieldRegion(outputRequestedRegion, displacementRequestedRegion))
     {
     displacementPtr->SetRequestedRegion(displacementRequestedRegion);
     }
@@ -248,8 +227,248 @@ StreamingWarpImageFilter<TInputImage, TOutputImage, TDisplacementField>
 //    e.SetDataObject(inputPtr);
 //    throw e;
     }
+
+  // 4) Split the output region if reading the input of two halves
+  // instead of the whole region reduces the number of input pixels by
+  // more than MinimumSplitGain, and so on. The input requested region is
+  // then the one of the first block, the other blocks are read in
+  // GenerateData().
+  m_Blocks.clear();
+  if (m_MinimumSplitGain > 1. && DisplacementFieldType::ImageDimension == 2)
+    {
+    this->ComputeNodePositions(displacementRequestedRegion);
+    this->SplitOutputRegion(outputRequestedRegion, this->ComputeInputRegion(outputRequestedRegion));
+    m_NodePositions.clear();
+    if (m_Blocks.size() > 1)
+      {
+      otbMsgDevMacro(<< "Output region " << outputRequestedRegion.GetIndex() << " " << outputRequestedRegion.GetSize()
+                     << " split in " << m_Blocks.size() << " blocks to limit the input requested region");
+      inputPtr->SetRequestedRegion(m_Blocks[0].second);
+      }
+    else
+      {
+      m_Blocks.clear();
+      }
+    }
  }
 
+template<class TInputImage, class TOutputImage, class TDisplacementField>
+bool
+StreamingWarpImageFilter<TInputImage, TOutputImage, TDisplacementField>
+::ComputeDisplacementFieldRegion(const OutputImageRegionType & outputRegion,
+                                 DisplacementFieldRegionType & fieldRegion) const
+{
+  const DisplacementFieldType * displacementPtr = this->GetDisplacementField();
+  const OutputImageType * outputPtr = this->GetOutput();
+
+  typename OutputImageType::IndexType outIndexStart = outputRegion.GetIndex();
+  typename OutputImageType::IndexType outIndexEnd;
+  for(unsigned int dim = 0; dim<OutputImageType::ImageDimension; ++dim)
+    outIndexEnd[dim]= outIndexStart[dim] + outputRegion.GetSize()[dim]-1;
+  typename OutputImageType::PointType outPointStart, outPointEnd;
+  outputPtr->TransformIndexToPhysicalPoint(outIndexStart, outPointStart);
+  outputPtr->TransformIndexToPhysicalPoint(outIndexEnd, outPointEnd);
+
+  typename DisplacementFieldType::IndexType defIndexStart, defIndexEnd;
+  displacementPtr->TransformPhysicalPointToIndex(outPointStart, defIndexStart);
+  displacementPtr->TransformPhysicalPointToIndex(outPointEnd, defIndexEnd);
+
+  typename DisplacementFieldType::SizeType defRequestedSize;
+  typename DisplacementFieldType::IndexType defRequestedIndex;
+
+  for(unsigned int dim = 0; dim<OutputImageType::ImageDimension; ++dim)
+    {
+    defRequestedIndex[dim] = std::min(defIndexStart[dim], defIndexEnd[dim]);
+    defRequestedSize[dim] = std::max(defIndexStart[dim], defIndexEnd[dim]) - defRequestedIndex[dim] + 1;
+    }
+
+  // Finally, build the displacement field requested region
+  fieldRegion.SetIndex(defRequestedIndex);
+  fieldRegion.SetSize(defRequestedSize);
+
+  // Avoid extrapolation
+  fieldRegion.PadByRadius(1);
+
+  // crop the region at the field's largest possible region
+  return fieldRegion.Crop(displacementPtr->GetLargestPossibleRegion());
+}
+
+template<class TInputImage, class TOutputImage, class TDisplacementField>
+void
+StreamingWarpImageFilter<TInputImage, TOutputImage, TDisplacementField>
+::ComputeNodePositions(const DisplacementFieldRegionType & fieldRegion)
+{
+  const InputImageType * inputPtr = this->GetInput();
+  const DisplacementFieldType * displacementPtr = this->GetDisplacementField();
+
+  m_NodeRegion = fieldRegion;
+  m_NodePositions.clear();
+  m_NodePositions.reserve(fieldRegion.GetNumberOfPixels());
+
+  typename InputImageType::PointType currentPoint;
+  NodePositionType currentIndex;
+  itk::ImageRegionConstIteratorWithIndex<DisplacementFieldType> defIt(displacementPtr, fieldRegion);
+  for (defIt.GoToBegin(); !defIt.IsAtEnd(); ++defIt)
+    {
+    displacementPtr->TransformIndexToPhysicalPoint(defIt.GetIndex(), currentPoint);
+    for(unsigned int dim = 0; dim < DisplacementFieldType::ImageDimension; ++dim)
+      {
+      currentPoint[dim]+=defIt.Get()[dim];
+      }
+    inputPtr->TransformPhysicalPointToContinuousIndex(currentPoint, currentIndex);
+    m_NodePositions.push_back(currentIndex);
+    }
+}
+
+template<class TInputImage, class TOutputImage, class TDisplacementField>
+typename StreamingWarpImageFilter<TInputImage, TOutputImage, TDisplacementField>::InputImageRegionType
+StreamingWarpImageFilter<TInputImage, TOutputImage, TDisplacementField>
+::ComputeInputRegion(const OutputImageRegionType & outputRegion) const
+{
+  const unsigned int Dimension = DisplacementFieldType::ImageDimension;
+
+  DisplacementFieldRegionType fieldRegion;
+  double lower[Dimension];
+  double upper[Dimension];
+  for(unsigned int dim = 0; dim < Dimension; ++dim)
+    {
+    lower[dim] = std::numeric_limits<double>::max();
+    upper[dim] = -std::numeric_limits<double>::max();
+    }
+
+  if (this->ComputeDisplacementFieldRegion(outputRegion, fieldRegion) && fieldRegion.Crop(m_NodeRegion))
+    {
+    // Walk the stored node positions of the field region
+    itk::ImageRegionConstIteratorWithIndex<DisplacementFieldType> defIt(this->GetDisplacementField(), fieldRegion);
+    for (defIt.GoToBegin(); !defIt.IsAtEnd(); ++defIt)
+      {
+      typename DisplacementFieldType::OffsetValueType id = 0;
+      typename DisplacementFieldType::OffsetValueType stride = 1;
+      for(unsigned int dim = 0; dim < Dimension; ++dim)
+        {
+        id += (defIt.GetIndex()[dim] - m_NodeRegion.GetIndex()[dim]) * stride;
+        stride *= m_NodeRegion.GetSize()[dim];
+        }
+      const NodePositionType & position = m_NodePositions[id];
+      for(unsigned int dim = 0; dim < Dimension; ++dim)
+        {
+        lower[dim] = std::min(lower[dim], position[dim]);
+        upper[dim] = std::max(upper[dim], position[dim]);
+        }
+      }
+    }
+
+  // Bounding box, padded by the interpolator radius
+  typename InputImageType::IndexType inputIndex;
+  typename InputImageType::SizeType inputSize;
+  bool valid = true;
+  for(unsigned int dim = 0; dim < Dimension; ++dim)
+    {
+    valid = valid && lower[dim] <= upper[dim];
+    inputIndex[dim] = valid ? static_cast<typename InputImageType::IndexValueType>(std::floor(lower[dim])) : 0;
+    inputSize[dim] = valid ? static_cast<typename InputImageType::SizeValueType>(std::ceil(upper[dim]) - inputIndex[dim]) + 1 : 0;
+    }
+  InputImageRegionType inputRegion;
+  inputRegion.SetIndex(inputIndex);
+  inputRegion.SetSize(inputSize);
+
+  unsigned int interpolatorRadius =
+      StreamingTraits<typename Superclass::InputImageType>::CalculateNeededRadiusForInterpolator(this->GetInterpolator());
+  inputRegion.PadByRadius(interpolatorRadius);
+
+  if (!valid || !inputRegion.Crop(this->GetInput()->GetLargestPossibleRegion()))
+    {
+    inputIndex.Fill(0);
+    inputSize.Fill(0);
+    inputRegion.SetIndex(inputIndex);
+    inputRegion.SetSize(inputSize);
+    }
+  return inputRegion;
+}
+
+template<class TInputImage, class TOutputImage, class TDisplacementField>
+void
+StreamingWarpImageFilter<TInputImage, TOutputImage, TDisplacementField>
+::SplitOutputRegion(const OutputImageRegionType & outputRegion, const InputImageRegionType & inputRegion)
+{
+  // Blocks are not split below this size, and input regions below this
+  // number of pixels are never split
+  const unsigned int minimumBlockSize = 32;
+  const double minimumInputPixels = 256. * 256.;
+
+  const double inputPixels = static_cast<double>(inputRegion.GetNumberOfPixels());
+  const unsigned int splitDim = outputRegion.GetSize()[0] >= outputRegion.GetSize()[1] ? 0 : 1;
+
+  if (inputPixels > minimumInputPixels && outputRegion.GetSize()[splitDim] >= 2 * minimumBlockSize)
+    {
+    OutputImageRegionType first = outputRegion;
+    OutputImageRegionType second = outputRegion;
+    const unsigned int firstSize = outputRegion.GetSize()[splitDim] / 2;
+    first.SetSize(splitDim, firstSize);
+    second.SetIndex(splitDim, outputRegion.GetIndex()[splitDim] + firstSize);
+    second.SetSize(splitDim, outputRegion.GetSize()[splitDim] - firstSize);
+
+    const InputImageRegionType firstInput = this->ComputeInputRegion(first);
+    const InputImageRegionType secondInput = this->ComputeInputRegion(second);
+    const double splitPixels = static_cast<double>(firstInput.GetNumberOfPixels() + secondInput.GetNumberOfPixels());
+
+    if (splitPixels * m_MinimumSplitGain < inputPixels)
+      {
+      this->SplitOutputRegion(first, firstInput);
+      this->SplitOutputRegion(second, secondInput);
+      return;
+      }
+    }
+
+  m_Blocks.push_back(std::make_pair(outputRegion, inputRegion));
+}
+
+template<class TInputImage, class TOutputImage, class TDisplacementField>
+void
+StreamingWarpImageFilter<TInputImage, TOutputImage, TDisplacementField>
+::GenerateData()
+{
+  if (m_Blocks.empty())
+    {
+    Superclass::GenerateData();
+    return;
+    }
+
+  // Same steps as itk::ImageSource::GenerateData(), with a multithreaded
+  // execution for each block
+  this->AllocateOutputs();
+  this->BeforeThreadedGenerateData();
+
+  InputImageType * inputPtr = const_cast<InputImageType *>(this->GetInput());
+  OutputImageType * outputPtr = this->GetOutput();
+  const OutputImageRegionType outputRequestedRegion = outputPtr->GetRequestedRegion();
+
+  typename Superclass::ThreadStruct str;
+  str.Filter = this;
+  this->GetMultiThreader()->SetNumberOfThreads(this->GetNumberOfThreads());
+  this->GetMultiThreader()->SetSingleMethod(this->ThreaderCallback, &str);
+
+  for (unsigned int i = 0; i < m_Blocks.size(); ++i)
+    {
+    // The input of the first block has been updated by the pipeline
+    if (i > 0)
+      {
+      inputPtr->SetRequestedRegion(m_Blocks[i].second);
+      inputPtr->PropagateRequestedRegion();
+      inputPtr->UpdateOutputData();
+      // The interpolator caches the buffered region of its input
+      const_cast<typename Superclass::InterpolatorType *>(this->GetInterpolator())->SetInputImage(inputPtr);
+      }
+
+    // Threads split the output requested region
+    outputPtr->SetRequestedRegion(m_Blocks[i].first);
+    this->GetMultiThreader()->SingleMethodExecute();
+    }
+
+  outputPtr->SetRequestedRegion(outputRequestedRegion);
+  this->AfterThreadedGenerateData();
+}
+
 
 template<class TInputImage, class TOutputImage, class TDisplacementField>
 void
@@ -346,6 +565,7 @@ StreamingWarpImageFilter<TInputImage, TOutputImage, TDisplacementField>
  {
   Superclass::PrintSelf(os, indent);
   os << indent << "Maximum displacement: " << m_MaximumDisplacement << std::endl;
+  os << indent << "Minimum split gain: " << m_MinimumSplitGain << std::endl;
  }
 
 } // end namespace otb
@@ -22,7 +22,10 @@
 #define otbTransform_h
 
 #include "itkTransform.h"
+#include "itkMultiThreader.h"
 #include "vnl/vnl_vector_fixed.h"
+#include <algorithm>
+#include <cstddef>
 
 
 namespace otb
@@ -100,6 +103,19 @@ public:
 
   OutputPointType TransformPoint(const InputPointType  & ) const override
     { return OutputPointType(); }
+
+  /** Method to transform an array of points. The default implementation
+   * calls TransformPoint() on each point: subclasses override it when the
+   * points can be processed more efficiently together. */
+  virtual void TransformPoints(const InputPointType * inputPoints,
+                               OutputPointType * outputPoints,
+                               std::size_t count) const
+  {
+    for (std::size_t i = 0; i < count; ++i)
+      {
+      outputPoints[i] = this->TransformPoint(inputPoints[i]);
+      }
+  }
   
   using Superclass::TransformVector;
   /**  Method to transform a vector. */
@@ -229,6 +245,92 @@ private:
   Transform(const Self &) = delete;
   void operator=(const Self &) = delete;
 };
+
+/** Transform an array of points with any ITK transform, using the batch
+ * evaluation of otb::Transform when it is available.
+ *
+ * \ingroup OTBTransform
+ */
+template <class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
+void BatchTransformPoints(const itk::Transform<TScalarType, NInputDimensions, NOutputDimensions> * transform,
+                          const itk::Point<TScalarType, NInputDimensions> * inputPoints,
+                          itk::Point<TScalarType, NOutputDimensions> * outputPoints,
+                          std::size_t count)
+{
+  typedef Transform<TScalarType, NInputDimensions, NOutputDimensions> OTBTransformType;
+  if (const OTBTransformType * otbTransform = dynamic_cast<const OTBTransformType *>(transform))
+    {
+    otbTransform->TransformPoints(inputPoints, outputPoints, count);
+    }
+  else
+    {
+    for (std::size_t i = 0; i < count; ++i)
+      {
+      outputPoints[i] = transform->TransformPoint(inputPoints[i]);
+      }
+    }
+}
+
+namespace internal
+{
+template <class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
+struct BatchTransformStruct
+{
+  const itk::Transform<TScalarType, NInputDimensions, NOutputDimensions> * Transform;
+  const itk::Point<TScalarType, NInputDimensions> *                        InputPoints;
+  itk::Point<TScalarType, NOutputDimensions> *                             OutputPoints;
+  std::size_t                                                              Count;
+};
+
+template <class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
+ITK_THREAD_RETURN_TYPE BatchTransformCallback(void * arg)
+{
+  itk::MultiThreader::ThreadInfoStruct * info = static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+  const BatchTransformStruct<TScalarType, NInputDimensions, NOutputDimensions> * str =
+    static_cast<BatchTransformStruct<TScalarType, NInputDimensions, NOutputDimensions> *>(info->UserData);
+
+  const std::size_t start = str->Count * info->ThreadID / info->NumberOfThreads;
+  const std::size_t stop = str->Count * (info->ThreadID + 1) / info->NumberOfThreads;
+  BatchTransformPoints(str->Transform, str->InputPoints + start, str->OutputPoints + start, stop - start);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+} // end namespace internal
+
+/** Transform an array of points with any ITK transform, splitting the
+ * array in contiguous blocks transformed in parallel by the threads of
+ * the given multithreader. The transform must be thread-safe, as for
+ * any transform used in a multithreaded filter.
+ *
+ * \ingroup OTBTransform
+ */
+template <class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
+void ParallelBatchTransformPoints(const itk::Transform<TScalarType, NInputDimensions, NOutputDimensions> * transform,
+                                  const itk::Point<TScalarType, NInputDimensions> * inputPoints,
+                                  itk::Point<TScalarType, NOutputDimensions> * outputPoints,
+                                  std::size_t count,
+                                  itk::MultiThreader * threader)
+{
+  // Do not spawn threads for a few points
+  const std::size_t minimumPointsPerThread = 64;
+  const std::size_t nbThreads = std::min<std::size_t>(threader->GetNumberOfThreads(), count / minimumPointsPerThread);
+  if (nbThreads < 2)
+    {
+    BatchTransformPoints(transform, inputPoints, outputPoints, count);
+    return;
+    }
+
+  internal::BatchTransformStruct<TScalarType, NInputDimensions, NOutputDimensions> str;
+  str.Transform = transform;
+  str.InputPoints = inputPoints;
+  str.OutputPoints = outputPoints;
+  str.Count = count;
+
+  threader->SetNumberOfThreads(nbThreads);
+  threader->SetSingleMethod(internal::BatchTransformCallback<TScalarType, NInputDimensions, NOutputDimensions>, &str);
+  threader->SingleMethodExecute();
+}
+
 } // end namespace otb
 
 #endif
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "otbAdaptiveTransformToDisplacementFieldSource.h"
+#include "otbLogPolarTransform.h"
+#include "otbImage.h"
+#include "itkImageRegionConstIterator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+// Compare the displacement field refined adaptively to the field computed
+// on every node, for a non-linear transform
+int otbAdaptiveTransformToDisplacementFieldSource(int argc, char* argv[])
+{
+  if (argc != 4)
+    {
+    std::cerr << "Usage: " << argv[0] << " size maxError tolerance" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int size = atoi(argv[1]);
+  const double maxError = atof(argv[2]);
+  const double tolerance = atof(argv[3]);
+
+  typedef otb::Image<itk::Vector<double, 2> >                                       FieldType;
+  typedef otb::AdaptiveTransformToDisplacementFieldSource<FieldType, double>        SourceType;
+  typedef otb::LogPolarTransform<double>                                            TransformType;
+
+  TransformType::Pointer transform = TransformType::New();
+  TransformType::ParametersType params(4);
+  params[0] = 0.;
+  params[1] = 0.;
+  params[2] = 2. / size;
+  params[3] = 90. / size;
+  transform->SetParameters(params);
+
+  FieldType::SizeType fieldSize;
+  fieldSize.Fill(size);
+
+  SourceType::Pointer reference = SourceType::New();
+  reference->SetTransform(transform);
+  reference->SetOutputSize(fieldSize);
+  reference->Update();
+
+  SourceType::ErrorType error;
+  error.Fill(maxError);
+  SourceType::Pointer adaptive = SourceType::New();
+  adaptive->SetTransform(transform);
+  adaptive->SetOutputSize(fieldSize);
+  adaptive->SetMaximumError(error);
+  adaptive->Update();
+
+  itk::ImageRegionConstIterator<FieldType> refIt(reference->GetOutput(), reference->GetOutput()->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<FieldType> adaptiveIt(adaptive->GetOutput(), adaptive->GetOutput()->GetLargestPossibleRegion());
+
+  double maxDifference = 0.;
+  for (; !refIt.IsAtEnd(); ++refIt, ++adaptiveIt)
+    {
+    for (unsigned int dim = 0; dim < 2; ++dim)
+      {
+      maxDifference = std::max(maxDifference, std::abs(refIt.Get()[dim] - adaptiveIt.Get()[dim]));
+      }
+    }
+
+  std::cout << "Maximum difference: " << maxDifference << std::endl;
+  if (maxDifference > tolerance)
+    {
+    std::cerr << "Maximum difference " << maxDifference << " over tolerance " << tolerance << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The refined field must not depend on the number of threads
+  SourceType::Pointer singleThread = SourceType::New();
+  singleThread->SetTransform(transform);
+  singleThread->SetOutputSize(fieldSize);
+  singleThread->SetMaximumError(error);
+  singleThread->SetNumberOfThreads(1);
+  singleThread->Update();
+
+  SourceType::Pointer multiThread = SourceType::New();
+  multiThread->SetTransform(transform);
+  multiThread->SetOutputSize(fieldSize);
+  multiThread->SetMaximumError(error);
+  multiThread->SetNumberOfThreads(7);
+  multiThread->Update();
+
+  itk::ImageRegionConstIterator<FieldType> singleIt(singleThread->GetOutput(), singleThread->GetOutput()->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<FieldType> multiIt(multiThread->GetOutput(), multiThread->GetOutput()->GetLargestPossibleRegion());
+  for (; !singleIt.IsAtEnd(); ++singleIt, ++multiIt)
+    {
+    if (singleIt.Get() != multiIt.Get())
+      {
+      std::cerr << "Field at " << singleIt.GetIndex() << " differs with 1 thread (" << singleIt.Get()
+                << ") and 7 threads (" << multiIt.Get() << ")" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "itkVector.h"
+#include "otbImage.h"
+#include "otbStreamingWarpImageFilter.h"
+#include "itkStreamingImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
+
+// Warp an image with a displacement field sending a few columns far away,
+// with and without splitting the output regions, and check that the
+// outputs are identical and that the split reads a smaller input region
+int otbStreamingWarpImageFilterFootprint(int itkNotUsed(argc), char * itkNotUsed(argv)[])
+{
+  typedef otb::Image<double, 2>                                                      ImageType;
+  typedef itk::Vector<double, 2>                                                     DisplacementValueType;
+  typedef otb::Image<DisplacementValueType, 2>                                       DisplacementFieldType;
+  typedef otb::StreamingWarpImageFilter<ImageType, ImageType, DisplacementFieldType> WarperType;
+  typedef itk::StreamingImageFilter<ImageType, ImageType>                            StreamingType;
+
+  ImageType::SizeType size;
+  size.Fill(1000);
+  ImageType::RegionType region;
+  region.SetSize(size);
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    it.Set(it.GetIndex()[0] + 1000. * it.GetIndex()[1]);
+    }
+
+  // Identity field on the first 200x200 pixels, except a band of columns
+  // sampling the bottom of the image
+  DisplacementFieldType::SizeType fieldSize;
+  fieldSize.Fill(200);
+  DisplacementFieldType::RegionType fieldRegion;
+  fieldRegion.SetSize(fieldSize);
+  DisplacementFieldType::Pointer field = DisplacementFieldType::New();
+  field->SetRegions(fieldRegion);
+  field->Allocate();
+  itk::ImageRegionIteratorWithIndex<DisplacementFieldType> fieldIt(field, fieldRegion);
+  for (fieldIt.GoToBegin(); !fieldIt.IsAtEnd(); ++fieldIt)
+    {
+    DisplacementValueType displacement;
+    displacement.Fill(0.);
+    if (fieldIt.GetIndex()[0] >= 170 && fieldIt.GetIndex()[0] < 173)
+      {
+      displacement[1] = 700.;
+      }
+    fieldIt.Set(displacement);
+    }
+
+  ImageType::SizeType outputSize;
+  outputSize.Fill(200);
+
+  ImageType::Pointer outputs[2];
+  ImageType::RegionType::SizeValueType inputPixels[2];
+  const double gains[2] = {0., 1.5};
+  for (unsigned int k = 0; k < 2; ++k)
+    {
+    WarperType::Pointer warper = WarperType::New();
+    warper->SetInput(image);
+    warper->SetDisplacementField(field);
+    warper->SetOutputSize(outputSize);
+    warper->SetMinimumSplitGain(gains[k]);
+
+    StreamingType::Pointer streaming = StreamingType::New();
+    streaming->SetInput(warper->GetOutput());
+    streaming->SetNumberOfStreamDivisions(2);
+    streaming->Update();
+    outputs[k] = streaming->GetOutput();
+    inputPixels[k] = image->GetRequestedRegion().GetNumberOfPixels();
+    }
+
+  unsigned int nbPixelsWithDiff = 0;
+  itk::ImageRegionConstIterator<ImageType> it0(outputs[0], outputs[0]->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<ImageType> it1(outputs[1], outputs[1]->GetLargestPossibleRegion());
+  for (it0.GoToBegin(), it1.GoToBegin(); !it0.IsAtEnd(); ++it0, ++it1)
+    {
+    if (it0.Get() != it1.Get())
+      {
+      ++nbPixelsWithDiff;
+      }
+    }
+
+  std::cout << "Number of pixels with differences: " << nbPixelsWithDiff << std::endl;
+  std::cout << "Last input requested region: " << inputPixels[0] << " pixels without split, "
+            << inputPixels[1] << " pixels with split" << std::endl;
+
+  if (nbPixelsWithDiff != 0 || inputPixels[1] >= inputPixels[0])
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
@@ -24,6 +24,8 @@
 
 #include "itkImageToImageFilter.h"
 #include "itkLinearInterpolateImageFunction.h"
+#include "itkNearestNeighborInterpolateImageFunction.h"
+#include "itkProgressReporter.h"
 #include "itkDefaultConvertPixelTraits.h"
 
 #include "otbMacro.h"
@@ -51,6 +53,15 @@ namespace otb
  *  If CheckOutputBounds flag is set to true (default value), the
  *  interpolated value will be checked for output pixel type range
  *  prior to casting.
+ *
+ *  Since both grids are axis-aligned, the input column of an output
+ *  pixel only depends on its column, and the input row on its row. With
+ *  the default linear interpolator or a nearest neighbor interpolator,
+ *  the interpolation weights are therefore computed once per column and
+ *  once per row, and the pixels are read directly from the input buffer.
+ *  When the input position falls exactly on an input pixel (integer
+ *  decimation with aligned grids), the pixel is copied. Other
+ *  interpolators are evaluated for each pixel.
  *   
  * \ingroup OTBImageManipulation
  * \ingroup Streamed
@@ -97,6 +108,8 @@ public:
   typedef typename InterpolatorType::Pointer                              InterpolatorPointerType;
   typedef itk::LinearInterpolateImageFunction<InputImageType,
                                               TInterpolatorPrecision>     DefaultInterpolatorType;
+  typedef itk::NearestNeighborInterpolateImageFunction<InputImageType,
+                                              TInterpolatorPrecision>     NearestNeighborInterpolatorType;
   typedef typename InterpolatorType::OutputType                           InterpolatorOutputType;
   typedef itk::DefaultConvertPixelTraits< InterpolatorOutputType >        InterpolatorConvertType;
   typedef typename InterpolatorConvertType::ComponentType                 InterpolatorComponentType;
@@ -155,6 +168,13 @@ protected:
 
   void AfterThreadedGenerateData() override;
 
+  /** Resample a region with weights computed once per column and once
+   * per row. Only valid for the linear and nearest neighbor
+   * interpolators. */
+  void SeparableThreadedGenerateData(const OutputImageRegionType& regionToCompute,
+                                     bool nearest,
+                                     itk::ProgressReporter & progress);
+
   inline void CastPixelWithBoundsChecking( const InterpolatorOutputType& value,
                                                       const InterpolatorComponentType& minComponent,
                                                       const InterpolatorComponentType& maxComponent,
@@ -30,6 +30,9 @@
 #include "itkProgressReporter.h"
 #include "itkImageScanlineIterator.h"
 #include "itkContinuousIndex.h"
+#include "itkMath.h"
+
+#include <vector>
 
 namespace otb
 {
@@ -335,6 +338,18 @@ GridResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecision>
                                   threadId,
                                   regionToCompute.GetSize()[1]);
 
+  // Linear and nearest neighbor interpolations are separable
+  if (dynamic_cast<const DefaultInterpolatorType *>(m_Interpolator.GetPointer()))
+    {
+    this->SeparableThreadedGenerateData(regionToCompute, false, progress);
+    return;
+    }
+  if (dynamic_cast<const NearestNeighborInterpolatorType *>(m_Interpolator.GetPointer()))
+    {
+    this->SeparableThreadedGenerateData(regionToCompute, true, progress);
+    return;
+    }
+
   // Temporary variables for loop
   PointType outPoint;
   ContinuousInputIndexType inCIndex;
@@ -381,6 +396,180 @@ GridResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecision>
 
 }
 
+template <typename TInputImage, typename TOutputImage,
+          typename TInterpolatorPrecision>
+void
+GridResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecision>
+::SeparableThreadedGenerateData(const OutputImageRegionType& regionToCompute,
+                                bool nearest,
+                                itk::ProgressReporter & progress)
+{
+  typedef typename InputImageType::PixelType                InputPixelType;
+  typedef itk::DefaultConvertPixelTraits<InputPixelType>    InputPixelConvertType;
+
+  OutputImageType *outputPtr = this->GetOutput();
+  const InputImageType *inputPtr = this->GetInput();
+
+  const OutputPixelComponentType minValue =  itk::NumericTraits< OutputPixelComponentType >::NonpositiveMin();
+  const OutputPixelComponentType maxValue =  itk::NumericTraits< OutputPixelComponentType >::max();
+
+  const InterpolatorComponentType minOutputValue = static_cast< InterpolatorComponentType >( minValue );
+  const InterpolatorComponentType maxOutputValue = static_cast< InterpolatorComponentType >( maxValue );
+
+  const IndexType inStart = inputPtr->GetBufferedRegion().GetIndex();
+  IndexType inEnd = inStart + inputPtr->GetBufferedRegion().GetSize();
+  inEnd[0]-=1;
+  inEnd[1]-=1;
+
+  const unsigned int sizeX = regionToCompute.GetSize()[0];
+  const unsigned int sizeY = regionToCompute.GetSize()[1];
+
+  // Input position of each column and each row, computed as in the
+  // generic loop
+  std::vector<double> inX(sizeX);
+  std::vector<double> inY(sizeY);
+  PointType outPoint;
+  ContinuousInputIndexType inCIndex;
+  IndexType outIndex = regionToCompute.GetIndex();
+  const double delta = outputPtr->GetSignedSpacing()[0]/inputPtr->GetSignedSpacing()[0];
+  for (unsigned int j = 0; j < sizeY; ++j)
+    {
+    outIndex[1] = regionToCompute.GetIndex()[1] + j;
+    outputPtr->TransformIndexToPhysicalPoint(outIndex,outPoint);
+    inputPtr->TransformPhysicalPointToContinuousIndex(outPoint,inCIndex);
+    inY[j] = inCIndex[1];
+    if (j == 0)
+      {
+      double x = inCIndex[0];
+      for (unsigned int i = 0; i < sizeX; ++i)
+        {
+        inX[i] = x;
+        x += delta;
+        }
+      }
+    }
+
+  // Base index, weight of the next pixel, and whether the taps are
+  // inside the buffer, for each column and each row. Out of buffer
+  // positions are left to the interpolator, which handles the borders.
+  std::vector<long> baseX(sizeX), baseY(sizeY);
+  std::vector<double> weightX(sizeX), weightY(sizeY);
+  std::vector<bool> insideX(sizeX), insideY(sizeY);
+  auto computeTaps = [nearest](const std::vector<double> & in, long start, long end,
+                               std::vector<long> & base, std::vector<double> & weight,
+                               std::vector<bool> & inside)
+  {
+    for (unsigned int i = 0; i < in.size(); ++i)
+      {
+      if (nearest)
+        {
+        base[i] = itk::Math::RoundHalfIntegerUp<long>(in[i]);
+        weight[i] = 0.;
+        }
+      else
+        {
+        base[i] = itk::Math::Floor<long>(in[i]);
+        weight[i] = in[i] - static_cast<double>(base[i]);
+        }
+      inside[i] = base[i] >= start && (weight[i] > 0. ? base[i] + 1 : base[i]) <= end;
+      }
+  };
+  computeTaps(inX, inStart[0], inEnd[0], baseX, weightX, insideX);
+  computeTaps(inY, inStart[1], inEnd[1], baseY, weightY, insideY);
+
+  // Buffers of the interpolated pixel, allocated once for the region
+  const unsigned int n = inputPtr->GetNumberOfComponentsPerPixel();
+  std::vector<double> value(n);
+  InterpolatorOutputType interpolatorValue;
+  itk::NumericTraits<InterpolatorOutputType>::SetLength(interpolatorValue, n);
+  OutputPixelType outputValue;
+
+  itk::ImageScanlineIterator<OutputImageType> outIt(outputPtr, regionToCompute);
+  outIt.GoToBegin();
+  for (unsigned int j = 0; !outIt.IsAtEnd(); ++j)
+    {
+    for (unsigned int i = 0; !outIt.IsAtEndOfLine(); ++i, ++outIt)
+      {
+      if (!insideX[i] || !insideY[j])
+        {
+        inCIndex[0] = inX[i];
+        inCIndex[1] = inY[j];
+        interpolatorValue = m_Interpolator->EvaluateAtContinuousIndex(inCIndex);
+        this->CastPixelWithBoundsChecking(interpolatorValue,minOutputValue,maxOutputValue,outputValue);
+        outIt.Set(outputValue);
+        continue;
+        }
+
+      // Same operations, in the same order, as itk::LinearInterpolateImageFunction
+      IndexType index;
+      index[0] = baseX[i];
+      index[1] = baseY[j];
+      const double dx = weightX[i];
+      const double dy = weightY[j];
+      const InputPixelType & val00 = inputPtr->GetPixel(index);
+      if (dx <= 0. && dy <= 0.)
+        {
+        // Input pixel: direct copy
+        for (unsigned int k = 0; k < n; ++k)
+          {
+          value[k] = static_cast<double>(InputPixelConvertType::GetNthComponent(k, val00));
+          }
+        }
+      else if (dy <= 0.)
+        {
+        ++index[0];
+        const InputPixelType & val10 = inputPtr->GetPixel(index);
+        for (unsigned int k = 0; k < n; ++k)
+          {
+          const double v00 = InputPixelConvertType::GetNthComponent(k, val00);
+          value[k] = v00 + (InputPixelConvertType::GetNthComponent(k, val10) - v00) * dx;
+          }
+        }
+      else if (dx <= 0.)
+        {
+        ++index[1];
+        const InputPixelType & val01 = inputPtr->GetPixel(index);
+        for (unsigned int k = 0; k < n; ++k)
+          {
+          const double v00 = InputPixelConvertType::GetNthComponent(k, val00);
+          value[k] = v00 + (InputPixelConvertType::GetNthComponent(k, val01) - v00) * dy;
+          }
+        }
+      else
+        {
+        ++index[0];
+        const InputPixelType & val10 = inputPtr->GetPixel(index);
+        ++index[1];
+        const InputPixelType & val11 = inputPtr->GetPixel(index);
+        --index[0];
+        const InputPixelType & val01 = inputPtr->GetPixel(index);
+        for (unsigned int k = 0; k < n; ++k)
+          {
+          const double v00 = InputPixelConvertType::GetNthComponent(k, val00);
+          const double v01 = InputPixelConvertType::GetNthComponent(k, val01);
+          const double valx0 = v00 + (InputPixelConvertType::GetNthComponent(k, val10) - v00) * dx;
+          const double valx1 = v01 + (InputPixelConvertType::GetNthComponent(k, val11) - v01) * dx;
+          value[k] = valx0 + (valx1 - valx0) * dy;
+          }
+        }
+
+      for (unsigned int k = 0; k < n; ++k)
+        {
+        InterpolatorConvertType::SetNthComponent(k, interpolatorValue,
+                                                 static_cast<InterpolatorComponentType>(value[k]));
+        }
+      this->CastPixelWithBoundsChecking(interpolatorValue,minOutputValue,maxOutputValue,outputValue);
+      outIt.Set(outputValue);
+      }
+
+    // Report progress
+    progress.CompletedPixel();
+
+    // Move to next line
+    outIt.NextLine();
+    }
+}
+
 template <typename TInputImage, typename TOutputImage,
           typename TInterpolatorPrecision>
 void
@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbSceneMosaicImageFilter_h
+#define otbSceneMosaicImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include <vector>
+
+namespace otb
+{
+
+/** \class SceneMosaicImageFilter
+ *  \brief Mosaic of orthorectified scenes with priorities, feathering
+ *  and radiometric harmonization
+ *
+ *  The inputs, set with PushBackInput(), are images in the same map
+ *  projection, with any origin and spacing. By default the output
+ *  grid covers the union of their footprints with the spacing of the
+ *  first input; it can be set with SetOutputOrigin(), SetOutputSpacing()
+ *  and SetOutputSize(). Input pixels are sampled with the nearest
+ *  neighbor: resample the inputs beforehand for other interpolations.
+ *
+ *  The footprints of the inputs are indexed by a regular grid of
+ *  buckets over the output. Each output region only requests the
+ *  inputs which overlap it; the other inputs get an empty requested
+ *  region, as in TileImageFilter. Thousands of scenes can therefore be
+ *  mosaicked in one streamed pass.
+ *
+ *  The inputs are stacked by increasing priority (SetPriority()), and
+ *  by input order for equal priorities: the last one is on top. Input
+ *  pixels whose components are all equal to NoDataValue are
+ *  transparent. With a null FeatheringDistance, the seamlines are the
+ *  borders of the valid pixels of the top scenes. Otherwise, the
+ *  opacity of each scene grows linearly with the distance to its
+ *  nearest invalid (no-data or outside) pixel, up to FeatheringDistance
+ *  output pixels, so that the scenes blend across these borders. The
+ *  distance comes from a distance transform of the valid-data mask on
+ *  the output grid, over the requested region padded by
+ *  FeatheringDistance. No seamline is computed from the image content.
+ *
+ *  SetHarmonization() applies a linear correction (gain and offset per
+ *  band) to the pixels of an input, to compensate radiometric
+ *  differences between the scenes.
+ *
+ * \ingroup Streamed
+ * \ingroup MultiThreaded
+ *
+ * \ingroup OTBImageManipulation
+ */
+template <class TImage>
+class ITK_EXPORT SceneMosaicImageFilter :
+    public itk::ImageToImageFilter<TImage, TImage>
+{
+public:
+  /** Standard class typedef */
+  typedef SceneMosaicImageFilter                  Self;
+  typedef itk::ImageToImageFilter<TImage, TImage> Superclass;
+  typedef itk::SmartPointer<Self>                 Pointer;
+  typedef itk::SmartPointer<const Self>           ConstPointer;
+
+  /** Helper typedefs */
+  typedef TImage                                  ImageType;
+  typedef typename ImageType::PixelType           PixelType;
+  typedef typename ImageType::InternalPixelType   InternalPixelType;
+  typedef typename ImageType::SizeType            SizeType;
+  typedef typename ImageType::IndexType           IndexType;
+  typedef typename ImageType::RegionType          RegionType;
+  typedef typename ImageType::PointType           PointType;
+  typedef typename ImageType::SpacingType         SpacingType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SceneMosaicImageFilter, ImageToImageFilter);
+
+  /** Output grid. A null output size (the default) selects the union
+   * of the input footprints. A null spacing selects the spacing of the
+   * first input. */
+  itkSetMacro(OutputOrigin, PointType);
+  itkGetConstReferenceMacro(OutputOrigin, PointType);
+  itkSetMacro(OutputSpacing, SpacingType);
+  itkGetConstReferenceMacro(OutputSpacing, SpacingType);
+  itkSetMacro(OutputSize, SizeType);
+  itkGetConstReferenceMacro(OutputSize, SizeType);
+
+  /** Value of the transparent input pixels and of the output pixels
+   * covered by no input (default 0) */
+  itkSetMacro(NoDataValue, InternalPixelType);
+  itkGetConstMacro(NoDataValue, InternalPixelType);
+
+  /** Width of the blending band along the borders of the valid pixels
+   * of the scenes, in output pixels (default 0: no feathering) */
+  itkSetMacro(FeatheringDistance, double);
+  itkGetConstMacro(FeatheringDistance, double);
+
+  /** Size of the buckets of the footprint index, in output pixels
+   * (default 512) */
+  itkSetClampMacro(IndexCellSize, unsigned int, 1, itk::NumericTraits<unsigned int>::max());
+  itkGetConstMacro(IndexCellSize, unsigned int);
+
+  /** Priority of an input (default 0): inputs with a higher priority
+   * are on top */
+  void SetPriority(unsigned int input, double priority);
+  double GetPriority(unsigned int input) const;
+
+  /** Linear correction of the bands of an input: value * gain + offset */
+  void SetHarmonization(unsigned int input, const std::vector<double> & gains, const std::vector<double> & offsets);
+
+protected:
+  SceneMosaicImageFilter();
+
+  ~SceneMosaicImageFilter() override {}
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+  void GenerateOutputInformation() override;
+
+  void GenerateInputRequestedRegion() override;
+
+  void ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId) override;
+
+  /** The inputs do not need to occupy the same physical space */
+  void VerifyInputInformation() override {}
+
+private:
+  SceneMosaicImageFilter(const Self &) = delete;
+  void operator =(const Self&) = delete;
+
+  /** Footprint of an input, in continuous output indices (pixel
+   * borders) */
+  struct Footprint
+  {
+    double Min[2];
+    double Max[2];
+  };
+
+  /** Inputs whose footprint overlaps an output region, by increasing
+   * priority */
+  std::vector<unsigned int> FindInputs(const RegionType & region) const;
+
+  /** Part of the largest region of an input covering an output region,
+   * empty if they do not overlap */
+  RegionType OutputRegionToInputRegion(unsigned int input, const RegionType & region) const;
+
+  /** Margin of output pixels needed around a region by the feathering */
+  unsigned int GetFeatheringMargin() const;
+
+  /** Exact squared euclidean distance transform, in place: each value
+   * becomes the minimum over the image of value + squared distance */
+  static void SquaredDistanceTransform(std::vector<double> & image, unsigned int sizeX, unsigned int sizeY);
+
+  PointType         m_OutputOrigin;
+  SpacingType       m_OutputSpacing;
+  SizeType          m_OutputSize;
+  InternalPixelType m_NoDataValue;
+  double            m_FeatheringDistance;
+  unsigned int      m_IndexCellSize;
+
+  std::vector<double>              m_Priorities;
+  std::vector<std::vector<double>> m_Gains;
+  std::vector<std::vector<double>> m_Offsets;
+
+  /** Footprint index, computed in GenerateOutputInformation() */
+  std::vector<Footprint>                 m_Footprints;
+  unsigned int                           m_IndexGridSize[2];
+  std::vector<std::vector<unsigned int>> m_IndexGrid;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbSceneMosaicImageFilter.hxx"
+#endif
+
+#endif
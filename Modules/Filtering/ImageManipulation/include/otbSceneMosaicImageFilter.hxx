@@ -0,0 +1,609 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbSceneMosaicImageFilter_hxx
+#define otbSceneMosaicImageFilter_hxx
+
+#include "otbSceneMosaicImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkProgressReporter.h"
+#include "itkDefaultConvertPixelTraits.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace otb
+{
+
+template <class TImage>
+SceneMosaicImageFilter<TImage>
+::SceneMosaicImageFilter()
+  : m_NoDataValue(itk::NumericTraits<InternalPixelType>::ZeroValue()),
+    m_FeatheringDistance(0.),
+    m_IndexCellSize(512)
+{
+  m_OutputOrigin.Fill(0.);
+  m_OutputSpacing.Fill(0.);
+  m_OutputSize.Fill(0);
+  m_IndexGridSize[0] = 0;
+  m_IndexGridSize[1] = 0;
+}
+
+template <class TImage>
+void
+SceneMosaicImageFilter<TImage>
+::SetPriority(unsigned int input, double priority)
+{
+  if (input >= m_Priorities.size())
+    {
+    m_Priorities.resize(input + 1, 0.);
+    }
+  m_Priorities[input] = priority;
+  this->Modified();
+}
+
+template <class TImage>
+double
+SceneMosaicImageFilter<TImage>
+::GetPriority(unsigned int input) const
+{
+  return input < m_Priorities.size() ? m_Priorities[input] : 0.;
+}
+
+template <class TImage>
+void
+SceneMosaicImageFilter<TImage>
+::SetHarmonization(unsigned int input, const std::vector<double> & gains, const std::vector<double> & offsets)
+{
+  if (gains.size() != offsets.size())
+    {
+    itkExceptionMacro(<< "Harmonization of input " << input << ": " << gains.size() << " gains for "
+                      << offsets.size() << " offsets");
+    }
+  if (input >= m_Gains.size())
+    {
+    m_Gains.resize(input + 1);
+    m_Offsets.resize(input + 1);
+    }
+  m_Gains[input] = gains;
+  m_Offsets[input] = offsets;
+  this->Modified();
+}
+
+template <class TImage>
+void
+SceneMosaicImageFilter<TImage>
+::GenerateOutputInformation()
+{
+  // Copy the projection and the metadata of the first input
+  Superclass::GenerateOutputInformation();
+
+  const unsigned int nbInputs = this->GetNumberOfIndexedInputs();
+  if (nbInputs == 0 || this->GetInput(0) == nullptr)
+    {
+    itkExceptionMacro(<< "At least one input is required");
+    }
+
+  const unsigned int nbComponents = this->GetInput(0)->GetNumberOfComponentsPerPixel();
+  for (unsigned int i = 0; i < nbInputs; ++i)
+    {
+    if (this->GetInput(i)->GetNumberOfComponentsPerPixel() != nbComponents)
+      {
+      itkExceptionMacro(<< "Input " << i << " has " << this->GetInput(i)->GetNumberOfComponentsPerPixel()
+                        << " components instead of " << nbComponents);
+      }
+    if (i < m_Gains.size() && !m_Gains[i].empty() && m_Gains[i].size() != nbComponents)
+      {
+      itkExceptionMacro(<< "Harmonization of input " << i << " has " << m_Gains[i].size()
+                        << " bands instead of " << nbComponents);
+      }
+    }
+
+  SpacingType spacing = m_OutputSpacing;
+  if (spacing[0] == 0. || spacing[1] == 0.)
+    {
+    spacing = this->GetInput(0)->GetSignedSpacing();
+    }
+  PointType origin = m_OutputOrigin;
+  if (m_OutputSize[0] == 0 || m_OutputSize[1] == 0)
+    {
+    // Provisional grid, aligned on the first input
+    origin = this->GetInput(0)->GetOrigin();
+    }
+
+  // Footprints, in continuous output indices
+  m_Footprints.resize(nbInputs);
+  for (unsigned int i = 0; i < nbInputs; ++i)
+    {
+    const ImageType * input = this->GetInput(i);
+    const RegionType & largest = input->GetLargestPossibleRegion();
+    const SpacingType inSpacing = input->GetSignedSpacing();
+    for (unsigned int dim = 0; dim < 2; ++dim)
+      {
+      const double first = input->GetOrigin()[dim] + (largest.GetIndex()[dim] - 0.5) * inSpacing[dim];
+      const double last = input->GetOrigin()[dim]
+        + (largest.GetIndex()[dim] + largest.GetSize()[dim] - 0.5) * inSpacing[dim];
+      const double a = (first - origin[dim]) / spacing[dim];
+      const double b = (last - origin[dim]) / spacing[dim];
+      m_Footprints[i].Min[dim] = std::min(a, b);
+      m_Footprints[i].Max[dim] = std::max(a, b);
+      }
+    }
+
+  SizeType size = m_OutputSize;
+  if (m_OutputSize[0] == 0 || m_OutputSize[1] == 0)
+    {
+    // Union of the footprints: pixels intersecting the footprints
+    const double epsilon = 1e-6;
+    for (unsigned int dim = 0; dim < 2; ++dim)
+      {
+      double lower = itk::NumericTraits<double>::max();
+      double upper = itk::NumericTraits<double>::NonpositiveMin();
+      for (const Footprint & footprint : m_Footprints)
+        {
+        lower = std::min(lower, footprint.Min[dim]);
+        upper = std::max(upper, footprint.Max[dim]);
+        }
+      const double first = std::floor(lower + 0.5 + epsilon);
+      const double last = std::ceil(upper - 0.5 - epsilon);
+      origin[dim] += first * spacing[dim];
+      size[dim] = static_cast<typename SizeType::SizeValueType>(std::max(last - first + 1., 1.));
+      for (Footprint & footprint : m_Footprints)
+        {
+        footprint.Min[dim] -= first;
+        footprint.Max[dim] -= first;
+        }
+      }
+    }
+
+  ImageType * output = this->GetOutput();
+  output->SetOrigin(origin);
+  output->SetSignedSpacing(spacing);
+  IndexType start;
+  start.Fill(0);
+  RegionType largest(start, size);
+  output->SetLargestPossibleRegion(largest);
+  output->SetNumberOfComponentsPerPixel(nbComponents);
+
+  // Bucket the footprints
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    m_IndexGridSize[dim] = (size[dim] + m_IndexCellSize - 1) / m_IndexCellSize;
+    }
+  m_IndexGrid.assign(m_IndexGridSize[0] * m_IndexGridSize[1], std::vector<unsigned int>());
+  for (unsigned int i = 0; i < nbInputs; ++i)
+    {
+    unsigned int cellMin[2], cellMax[2];
+    bool inside = true;
+    for (unsigned int dim = 0; dim < 2; ++dim)
+      {
+      const double lower = std::max(m_Footprints[i].Min[dim] + 0.5, 0.);
+      const double upper = std::min(m_Footprints[i].Max[dim] + 0.5, static_cast<double>(size[dim]));
+      if (upper <= lower)
+        {
+        inside = false;
+        break;
+        }
+      cellMin[dim] = static_cast<unsigned int>(lower) / m_IndexCellSize;
+      cellMax[dim] = std::min(static_cast<unsigned int>(std::ceil(upper) - 1) / m_IndexCellSize,
+                              m_IndexGridSize[dim] - 1);
+      }
+    if (!inside)
+      {
+      continue;
+      }
+    for (unsigned int cy = cellMin[1]; cy <= cellMax[1]; ++cy)
+      {
+      for (unsigned int cx = cellMin[0]; cx <= cellMax[0]; ++cx)
+        {
+        m_IndexGrid[cy * m_IndexGridSize[0] + cx].push_back(i);
+        }
+      }
+    }
+}
+
+template <class TImage>
+std::vector<unsigned int>
+SceneMosaicImageFilter<TImage>
+::FindInputs(const RegionType & region) const
+{
+  std::vector<unsigned int> inputs;
+  if (region.GetNumberOfPixels() == 0 || m_IndexGrid.empty())
+    {
+    return inputs;
+    }
+
+  unsigned int cellMin[2], cellMax[2];
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    const long first = std::max(region.GetIndex()[dim], static_cast<typename IndexType::IndexValueType>(0));
+    const long last = region.GetIndex()[dim] + static_cast<long>(region.GetSize()[dim]) - 1;
+    if (last < first)
+      {
+      return inputs;
+      }
+    cellMin[dim] = std::min<unsigned int>(first / m_IndexCellSize, m_IndexGridSize[dim] - 1);
+    cellMax[dim] = std::min<unsigned int>(last / m_IndexCellSize, m_IndexGridSize[dim] - 1);
+    }
+
+  for (unsigned int cy = cellMin[1]; cy <= cellMax[1]; ++cy)
+    {
+    for (unsigned int cx = cellMin[0]; cx <= cellMax[0]; ++cx)
+      {
+      const std::vector<unsigned int> & cell = m_IndexGrid[cy * m_IndexGridSize[0] + cx];
+      inputs.insert(inputs.end(), cell.begin(), cell.end());
+      }
+    }
+  std::sort(inputs.begin(), inputs.end());
+  inputs.erase(std::unique(inputs.begin(), inputs.end()), inputs.end());
+
+  // Keep the footprints overlapping the region
+  auto outside = [&](unsigned int i)
+  {
+    for (unsigned int dim = 0; dim < 2; ++dim)
+      {
+      const double lower = region.GetIndex()[dim] - 0.5;
+      const double upper = lower + region.GetSize()[dim];
+      if (m_Footprints[i].Max[dim] <= lower || m_Footprints[i].Min[dim] >= upper)
+        {
+        return true;
+        }
+      }
+    return false;
+  };
+  inputs.erase(std::remove_if(inputs.begin(), inputs.end(), outside), inputs.end());
+
+  // Stack by priority, then by input order
+  std::stable_sort(inputs.begin(), inputs.end(), [this](unsigned int a, unsigned int b)
+    {
+    return this->GetPriority(a) < this->GetPriority(b);
+    });
+  return inputs;
+}
+
+template <class TImage>
+typename SceneMosaicImageFilter<TImage>::RegionType
+SceneMosaicImageFilter<TImage>
+::OutputRegionToInputRegion(unsigned int input, const RegionType & region) const
+{
+  const ImageType * inputPtr = this->GetInput(input);
+  const ImageType * outputPtr = this->GetOutput();
+  const SpacingType inSpacing = inputPtr->GetSignedSpacing();
+  const SpacingType outSpacing = outputPtr->GetSignedSpacing();
+
+  // Nearest input pixels of the first and last output pixel centers
+  RegionType inRegion;
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    const double first = (outputPtr->GetOrigin()[dim] + region.GetIndex()[dim] * outSpacing[dim]
+                          - inputPtr->GetOrigin()[dim]) / inSpacing[dim];
+    const double last = first + (static_cast<double>(region.GetSize()[dim]) - 1.) * outSpacing[dim] / inSpacing[dim];
+    const long lower = static_cast<long>(std::floor(std::min(first, last) + 0.5));
+    const long upper = static_cast<long>(std::floor(std::max(first, last) + 0.5));
+    inRegion.SetIndex(dim, lower);
+    inRegion.SetSize(dim, region.GetSize()[dim] > 0 ? upper - lower + 1 : 0);
+    }
+
+  if (region.GetNumberOfPixels() == 0 || !inRegion.Crop(inputPtr->GetLargestPossibleRegion()))
+    {
+    IndexType nullIndex;
+    nullIndex.Fill(0);
+    SizeType nullSize;
+    nullSize.Fill(0);
+    inRegion.SetIndex(nullIndex);
+    inRegion.SetSize(nullSize);
+    }
+  return inRegion;
+}
+
+template <class TImage>
+void
+SceneMosaicImageFilter<TImage>
+::GenerateInputRequestedRegion()
+{
+  const RegionType outRegion = this->GetOutput()->GetRequestedRegion();
+  const std::vector<unsigned int> overlapping = this->FindInputs(outRegion);
+
+  // The feathering needs the valid-data mask of the inputs up to
+  // FeatheringDistance output pixels around the region
+  RegionType paddedRegion = outRegion;
+  paddedRegion.PadByRadius(this->GetFeatheringMargin());
+
+  // Inputs outside of the requested region get an empty region
+  std::vector<bool> requested(this->GetNumberOfIndexedInputs(), false);
+  for (unsigned int i : overlapping)
+    {
+    requested[i] = true;
+    }
+
+  for (unsigned int i = 0; i < this->GetNumberOfIndexedInputs(); ++i)
+    {
+    ImageType * input = const_cast<ImageType *>(this->GetInput(i));
+    RegionType inRegion;
+    if (requested[i])
+      {
+      inRegion = this->OutputRegionToInputRegion(i, paddedRegion);
+      }
+    else
+      {
+      IndexType nullIndex;
+      nullIndex.Fill(0);
+      SizeType nullSize;
+      nullSize.Fill(0);
+      inRegion.SetIndex(nullIndex);
+      inRegion.SetSize(nullSize);
+      }
+    input->SetRequestedRegion(inRegion);
+    }
+}
+
+template <class TImage>
+unsigned int
+SceneMosaicImageFilter<TImage>
+::GetFeatheringMargin() const
+{
+  return m_FeatheringDistance > 0. ? static_cast<unsigned int>(std::ceil(m_FeatheringDistance)) : 0;
+}
+
+template <class TImage>
+void
+SceneMosaicImageFilter<TImage>
+::SquaredDistanceTransform(std::vector<double> & image, unsigned int sizeX, unsigned int sizeY)
+{
+  // Felzenszwalb and Huttenlocher: lower envelope of the parabolas
+  // rooted at each pixel, along the rows and then along the columns
+  const unsigned int n = std::max(sizeX, sizeY);
+  std::vector<double> f(n), z(n + 1);
+  std::vector<unsigned int> v(n);
+
+  auto transform1D = [&](double * data, unsigned int size, unsigned int stride)
+  {
+    for (unsigned int q = 0; q < size; ++q)
+      {
+      f[q] = data[q * stride];
+      }
+    auto intersection = [&](unsigned int q, unsigned int p)
+    {
+      return ((f[q] + static_cast<double>(q) * q) - (f[p] + static_cast<double>(p) * p)) / (2. * q - 2. * p);
+    };
+    unsigned int k = 0;
+    v[0] = 0;
+    z[0] = itk::NumericTraits<double>::NonpositiveMin();
+    z[1] = itk::NumericTraits<double>::max();
+    for (unsigned int q = 1; q < size; ++q)
+      {
+      double intersect = intersection(q, v[k]);
+      while (intersect <= z[k])
+        {
+        --k;
+        intersect = intersection(q, v[k]);
+        }
+      ++k;
+      v[k] = q;
+      z[k] = intersect;
+      z[k + 1] = itk::NumericTraits<double>::max();
+      }
+    k = 0;
+    for (unsigned int q = 0; q < size; ++q)
+      {
+      while (z[k + 1] < q)
+        {
+        ++k;
+        }
+      const double offset = static_cast<double>(q) - v[k];
+      data[q * stride] = offset * offset + f[v[k]];
+      }
+  };
+
+  for (unsigned int y = 0; y < sizeY; ++y)
+    {
+    transform1D(&image[y * sizeX], sizeX, 1);
+    }
+  for (unsigned int x = 0; x < sizeX; ++x)
+    {
+    transform1D(&image[x], sizeY, sizeX);
+    }
+}
+
+template <class TImage>
+void
+SceneMosaicImageFilter<TImage>
+::ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId)
+{
+  typedef itk::DefaultConvertPixelTraits<PixelType> PixelTraits;
+
+  ImageType * outputPtr = this->GetOutput();
+  const unsigned int nbComponents = outputPtr->GetNumberOfComponentsPerPixel();
+  const SpacingType outSpacing = outputPtr->GetSignedSpacing();
+  const unsigned int sizeX = outputRegionForThread.GetSize()[0];
+  const unsigned int sizeY = outputRegionForThread.GetSize()[1];
+  const IndexType start = outputRegionForThread.GetIndex();
+
+  // With feathering, the valid-data mask of each input is sampled on the
+  // region padded by the feathering margin
+  const unsigned int margin = this->GetFeatheringMargin();
+  const unsigned int paddedSizeX = sizeX + 2 * margin;
+  const unsigned int paddedSizeY = sizeY + 2 * margin;
+
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  // Composited values and coverage of the output pixels
+  std::vector<double> values(outputRegionForThread.GetNumberOfPixels() * nbComponents, 0.);
+  std::vector<double> coverage(outputRegionForThread.GetNumberOfPixels(), 0.);
+
+  std::vector<long> inIndexX(paddedSizeX), inIndexY(paddedSizeY);
+  std::vector<double> squaredDistances;
+  if (margin > 0)
+    {
+    squaredDistances.resize(paddedSizeX * paddedSizeY);
+    }
+
+  auto isNoData = [&](const PixelType & pixel)
+  {
+    bool noData = true;
+    for (unsigned int c = 0; c < nbComponents && noData; ++c)
+      {
+      noData = PixelTraits::GetNthComponent(c, pixel) == m_NoDataValue;
+      }
+    return noData;
+  };
+
+  for (unsigned int input : this->FindInputs(outputRegionForThread))
+    {
+    const ImageType * inputPtr = this->GetInput(input);
+    if (this->OutputRegionToInputRegion(input, outputRegionForThread).GetNumberOfPixels() == 0)
+      {
+      continue;
+      }
+    const RegionType & buffered = inputPtr->GetBufferedRegion();
+    const SpacingType inSpacing = inputPtr->GetSignedSpacing();
+    const bool harmonize = input < m_Gains.size() && !m_Gains[input].empty();
+
+    // Nearest input pixel of each padded output column and row
+    std::vector<long> * inIndex[2] = {&inIndexX, &inIndexY};
+    const unsigned int paddedSize[2] = {paddedSizeX, paddedSizeY};
+    for (unsigned int dim = 0; dim < 2; ++dim)
+      {
+      const long lower = buffered.GetIndex()[dim];
+      const long upper = lower + static_cast<long>(buffered.GetSize()[dim]) - 1;
+      for (unsigned int k = 0; k < paddedSize[dim]; ++k)
+        {
+        const long outIndex = start[dim] + static_cast<long>(k) - static_cast<long>(margin);
+        const double continuousIndex = (outputPtr->GetOrigin()[dim] + outIndex * outSpacing[dim]
+                                        - inputPtr->GetOrigin()[dim]) / inSpacing[dim];
+        const long index = static_cast<long>(std::floor(continuousIndex + 0.5));
+        // Indices below the buffered region flag the pixels outside of
+        // the input
+        (*inIndex[dim])[k] = (index >= lower && index <= upper) ? index : lower - 1;
+        }
+      }
+
+    IndexType index;
+    if (margin > 0)
+      {
+      // Distance to the nearest no-data or outside pixel: null on the
+      // invalid pixels, larger than any distance in the window elsewhere
+      const double far = static_cast<double>(paddedSizeX + paddedSizeY) * (paddedSizeX + paddedSizeY);
+      for (unsigned int y = 0; y < paddedSizeY; ++y)
+        {
+        index[1] = inIndexY[y];
+        for (unsigned int x = 0; x < paddedSizeX; ++x)
+          {
+          index[0] = inIndexX[x];
+          const bool valid = index[0] >= buffered.GetIndex()[0] && index[1] >= buffered.GetIndex()[1]
+            && !isNoData(inputPtr->GetPixel(index));
+          squaredDistances[y * paddedSizeX + x] = valid ? far : 0.;
+          }
+        }
+      SquaredDistanceTransform(squaredDistances, paddedSizeX, paddedSizeY);
+      }
+
+    for (unsigned int y = 0; y < sizeY; ++y)
+      {
+      if (inIndexY[y + margin] < buffered.GetIndex()[1])
+        {
+        continue;
+        }
+      index[1] = inIndexY[y + margin];
+      for (unsigned int x = 0; x < sizeX; ++x)
+        {
+        if (inIndexX[x + margin] < buffered.GetIndex()[0])
+          {
+          continue;
+          }
+        index[0] = inIndexX[x + margin];
+        const PixelType pixel = inputPtr->GetPixel(index);
+        if (isNoData(pixel))
+          {
+          continue;
+          }
+
+        // The opacity grows linearly from the border of the valid pixels
+        // (half a pixel from the nearest invalid pixel center)
+        double a = 1.;
+        if (margin > 0)
+          {
+          const double distance = std::sqrt(squaredDistances[(y + margin) * paddedSizeX + x + margin]) - 0.5;
+          a = std::max(0., std::min(1., distance / m_FeatheringDistance));
+          }
+
+        const unsigned int id = y * sizeX + x;
+        double * value = &values[id * nbComponents];
+        for (unsigned int c = 0; c < nbComponents; ++c)
+          {
+          double component = static_cast<double>(PixelTraits::GetNthComponent(c, pixel));
+          if (harmonize)
+            {
+            component = component * m_Gains[input][c] + m_Offsets[input][c];
+            }
+          value[c] = value[c] * (1. - a) + component * a;
+          }
+        coverage[id] = coverage[id] * (1. - a) + a;
+        }
+      }
+    }
+
+  // Normalize by the coverage, so that the scenes are opaque where
+  // nothing lies below them. Integer outputs are rounded, and all outputs
+  // are clamped to the range of the pixel type before the cast.
+  const double minValue = static_cast<double>(itk::NumericTraits<InternalPixelType>::NonpositiveMin());
+  const double maxValue = static_cast<double>(itk::NumericTraits<InternalPixelType>::max());
+  const bool isInteger = itk::NumericTraits<InternalPixelType>::is_integer;
+  PixelType outPixel;
+  itk::NumericTraits<PixelType>::SetLength(outPixel, nbComponents);
+  itk::ImageRegionIterator<ImageType> outIt(outputPtr, outputRegionForThread);
+  for (unsigned int id = 0; !outIt.IsAtEnd(); ++outIt, ++id)
+    {
+    for (unsigned int c = 0; c < nbComponents; ++c)
+      {
+      InternalPixelType component = m_NoDataValue;
+      if (coverage[id] > 0.)
+        {
+        double value = values[id * nbComponents + c] / coverage[id];
+        if (isInteger)
+          {
+          value = std::round(value);
+          }
+        component = static_cast<InternalPixelType>(std::max(minValue, std::min(maxValue, value)));
+        }
+      PixelTraits::SetNthComponent(c, outPixel, component);
+      }
+    outIt.Set(outPixel);
+    progress.CompletedPixel();
+    }
+}
+
+template <class TImage>
+void
+SceneMosaicImageFilter<TImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "OutputOrigin: " << m_OutputOrigin << std::endl;
+  os << indent << "OutputSpacing: " << m_OutputSpacing << std::endl;
+  os << indent << "OutputSize: " << m_OutputSize << std::endl;
+  os << indent << "NoDataValue: " << static_cast<typename itk::NumericTraits<InternalPixelType>::PrintType>(m_NoDataValue) << std::endl;
+  os << indent << "FeatheringDistance: " << m_FeatheringDistance << std::endl;
+  os << indent << "IndexCellSize: " << m_IndexCellSize << std::endl;
+}
+
+} // end namespace otb
+
+#endif
@@ -23,7 +23,8 @@
 
 #include "itkImageToImageFilter.h"
 #include "otbStreamingWarpImageFilter.h"
-#include "itkTransformToDisplacementFieldSource.h"
+#include "otbGridResampleImageFilter.h"
+#include "otbAdaptiveTransformToDisplacementFieldSource.h"
 #include "itkLinearInterpolateImageFunction.h"
 #include "otbImage.h"
 #include "itkVector.h"
@@ -47,6 +48,23 @@ namespace otb
  * the  interpolator (SetInterpolator()) and the origin (SetOrigin())
  * can be set using the method between brackets.
  *
+ * With SetMaximumGeometricError(), the displacement grid is refined
+ * adaptively: the transform is evaluated on a coarse grid, and only the
+ * cells where the interpolation is not accurate enough are subdivided.
+ * \sa AdaptiveTransformToDisplacementFieldSource
+ *
+ * With GridResamplingOn(), when the transform maps the output axes onto
+ * the input axes (scaling and translation only, as in superimposition of
+ * images in the same map projection), the output grid is an axis-aligned
+ * grid of the input image. The input is then resampled by a
+ * GridResampleImageFilter, without displacement field. The transform does
+ * not need to be linear: it is sampled on the displacement field nodes (at
+ * most 33 per axis), and the grid is used if all the samples are within
+ * 1e-3 input pixel (or the maximum geometric error, if larger) of the
+ * grid. This path is off by default, since the samples do not prove that
+ * a non-linear transform is axis-aligned between them.
+ * \sa GridResampleImageFilter
+ *
  *
  *
  * \ingroup Projection
@@ -87,9 +105,14 @@ public:
                                    OutputImageType,
                                    DisplacementFieldType>        WarpImageFilterType;
 
+  /** filter resampling input image for axis-aligned transforms */
+  typedef GridResampleImageFilter<InputImageType,
+                                  OutputImageType,
+                                  TInterpolatorPrecisionType>    GridResampleImageFilterType;
+
   /** Internal filters typedefs*/
-  typedef itk::TransformToDisplacementFieldSource<DisplacementFieldType,
-                                                 double>        DisplacementFieldGeneratorType;
+  typedef AdaptiveTransformToDisplacementFieldSource<DisplacementFieldType,
+                                                     double>    DisplacementFieldGeneratorType;
   typedef typename DisplacementFieldGeneratorType::TransformType TransformType;
   typedef typename DisplacementFieldGeneratorType::SizeType      SizeType;
   typedef typename DisplacementFieldGeneratorType::SpacingType   SpacingType;
@@ -124,6 +147,21 @@ public:
     return m_SignedOutputSpacing;
   };
 
+  /** Maximum geometric error, in input pixels, allowed when interpolating
+   * the transform from the displacement field. When it is not null, the
+   * transform is only evaluated on the displacement field nodes needed to
+   * reach this accuracy, and the default displacement field spacing is
+   * the output spacing. The default value 0 evaluates every node. */
+  itkSetMacro(MaximumGeometricError, double);
+  itkGetConstMacro(MaximumGeometricError, double);
+
+  /** Resample with a GridResampleImageFilter when the transform is
+   * axis-aligned on the output grid (see the class documentation).
+   * Default is false: the displacement field is always used. */
+  itkSetMacro(GridResampling, bool);
+  itkGetConstMacro(GridResampling, bool);
+  itkBooleanMacro(GridResampling);
+
   /** The resampled image parameters */
   // Output Origin
   void SetOutputOrigin(const OriginType & origin)
@@ -194,8 +232,17 @@ private:
   //spacing
   SpacingType m_SignedOutputSpacing;
 
+  double      m_MaximumGeometricError;
+
+  bool        m_GridResampling;
+
+  /** True when the transform is axis-aligned, computed in
+   * GenerateOutputInformation() */
+  bool        m_UseGridResampling;
+
   typename DisplacementFieldGeneratorType::Pointer   m_DisplacementFilter;
   typename WarpImageFilterType::Pointer             m_WarpFilter;
+  typename GridResampleImageFilterType::Pointer     m_GridResampleFilter;
 };
 
 } // namespace otb
@@ -25,16 +25,23 @@
 #include "itkProgressAccumulator.h"
 #include "otbImage.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace otb
 {
 
 template <class TInputImage, class TOutputImage, class TInterpolatorPrecisionType>
 StreamingResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionType>
 ::StreamingResampleImageFilter()
+  : m_MaximumGeometricError(0.),
+    m_GridResampling(false),
+    m_UseGridResampling(false)
 {
   // internal filters instantiation
   m_DisplacementFilter = DisplacementFieldGeneratorType::New();
   m_WarpFilter        = WarpImageFilterType::New();
+  m_GridResampleFilter = GridResampleImageFilterType::New();
   m_SignedOutputSpacing = m_DisplacementFilter->GetOutputSpacing();
   // Initialize the displacement field spacing to zero : inconsistent
   // value
@@ -52,6 +59,23 @@ StreamingResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionTy
   // Set up progress reporting
   typename itk::ProgressAccumulator::Pointer progress = itk::ProgressAccumulator::New();
   progress->SetMiniPipelineFilter(this);
+
+  if (m_UseGridResampling)
+    {
+    progress->RegisterInternalFilter(m_GridResampleFilter, 1.f);
+
+    // The internal output grid is expressed in the input physical
+    // frame: only its buffer is grafted, the output keeps its own
+    // information
+    m_GridResampleFilter->GetOutput()->SetRequestedRegion(this->GetOutput()->GetRequestedRegion());
+    m_GridResampleFilter->UpdateOutputData(m_GridResampleFilter->GetOutput());
+    typename OutputImageType::Pointer information = OutputImageType::New();
+    information->CopyInformation(this->GetOutput());
+    this->GraftOutput(m_GridResampleFilter->GetOutput());
+    this->GetOutput()->CopyInformation(information);
+    return;
+    }
+
   progress->RegisterInternalFilter(m_WarpFilter, 1.f);
 
   m_WarpFilter->GraftOutput(this->GetOutput());
@@ -70,9 +94,29 @@ StreamingResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionTy
   // check the output spacing of the displacement field
   if(this->GetDisplacementFieldSpacing()== itk::NumericTraits<SpacingType>::ZeroValue())
     {
-    this->SetDisplacementFieldSpacing(2.*this->GetOutputSpacing());
+    // With an adaptive grid, the nodes are only evaluated where needed
+    if (m_MaximumGeometricError > 0.)
+      {
+      this->SetDisplacementFieldSpacing(this->GetOutputSpacing());
+      }
+    else
+      {
+      this->SetDisplacementFieldSpacing(2.*this->GetOutputSpacing());
+      }
     }
 
+  // The displacement field is expressed in input physical coordinates
+  typename DisplacementFieldGeneratorType::ErrorType maximumError;
+  maximumError.Fill(0.);
+  if (m_MaximumGeometricError > 0. && this->GetInput())
+    {
+    for(unsigned int dim = 0; dim < InputImageType::ImageDimension; ++dim)
+      {
+      maximumError[dim] = m_MaximumGeometricError * std::abs(this->GetInput()->GetSignedSpacing()[dim]);
+      }
+    }
+  m_DisplacementFilter->SetMaximumError(maximumError);
+
   // Retrieve output largest region
   SizeType largestSize       = this->GetOutputSize();
 
@@ -99,6 +143,82 @@ StreamingResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionTy
   m_WarpFilter->GraftOutput(this->GetOutput());
   m_WarpFilter->UpdateOutputInformation();
   this->GraftOutput(m_WarpFilter->GetOutput());
+
+  // When enabled, check if the transform is axis-aligned on the output
+  // grid: the output axes are then mapped onto the input axes, and the
+  // output grid is a grid of the input image. Non-linear transforms (GenericRSTransform
+  // between two map projections for instance) can be axis-aligned too: the
+  // transform is sampled on the nodes of the displacement field (at most
+  // 33 per axis) and compared to the axis-aligned grid they define.
+  m_UseGridResampling = false;
+  const TransformType * transform = this->GetTransform();
+  if (m_GridResampling && InputImageType::ImageDimension == 2 && transform && this->GetInput()
+      && largestSize[0] > 0 && largestSize[1] > 0)
+    {
+    typedef typename TransformType::InputPointType  TransformInputPointType;
+    typedef typename TransformType::OutputPointType TransformOutputPointType;
+
+    const IndexType & startIndex = this->GetOutputStartIndex();
+    const SpacingType inSpacing = this->GetInput()->GetSignedSpacing();
+
+    // Input physical point of an output index, relative to the start index
+    auto inputPoint = [&](double i, double j)
+    {
+      TransformInputPointType outPoint;
+      outPoint[0] = this->GetOutputOrigin()[0] + (startIndex[0] + i) * this->GetOutputSpacing()[0];
+      outPoint[1] = this->GetOutputOrigin()[1] + (startIndex[1] + j) * this->GetOutputSpacing()[1];
+      return transform->TransformPoint(outPoint);
+    };
+
+    // Grid defined by the first pixel and the last column and row (or the
+    // next pixel when the output is a single column or row)
+    const TransformOutputPointType inStart = inputPoint(0., 0.);
+    const double lastX = largestSize[0] > 1 ? largestSize[0] - 1. : 1.;
+    const double lastY = largestSize[1] > 1 ? largestSize[1] - 1. : 1.;
+    SpacingType gridSpacing;
+    gridSpacing[0] = (inputPoint(lastX, 0.)[0] - inStart[0]) / lastX;
+    gridSpacing[1] = (inputPoint(0., lastY)[1] - inStart[1]) / lastY;
+
+    // Largest distance between the transform and the grid, in input pixels
+    const double tolerance = std::max(1e-3, m_MaximumGeometricError);
+    bool aligned = gridSpacing[0] != 0. && gridSpacing[1] != 0.;
+    unsigned int nbSamples[2];
+    for(unsigned int dim = 0; dim < 2; ++dim)
+      {
+      nbSamples[dim] = std::max(2u, std::min(33u, static_cast<unsigned int>(displacementFieldLargestSize[dim])));
+      }
+    for(unsigned int sj = 0; sj < nbSamples[1] && aligned; ++sj)
+      {
+      const double j = (largestSize[1] - 1.) * sj / (nbSamples[1] - 1);
+      for(unsigned int si = 0; si < nbSamples[0] && aligned; ++si)
+        {
+        const double i = (largestSize[0] - 1.) * si / (nbSamples[0] - 1);
+        const TransformOutputPointType inPoint = inputPoint(i, j);
+        aligned = std::abs((inPoint[0] - inStart[0] - i * gridSpacing[0]) / inSpacing[0]) < tolerance
+          && std::abs((inPoint[1] - inStart[1] - j * gridSpacing[1]) / inSpacing[1]) < tolerance;
+        }
+      }
+
+    if (aligned)
+      {
+      // Origin of the grid: input point of the output index 0
+      OriginType gridOrigin;
+      for(unsigned int dim = 0; dim < InputImageType::ImageDimension; ++dim)
+        {
+        gridOrigin[dim] = inStart[dim] - startIndex[dim] * gridSpacing[dim];
+        }
+      m_GridResampleFilter->SetInput(this->GetInput());
+      m_GridResampleFilter->SetOutputOrigin(gridOrigin);
+      m_GridResampleFilter->SetOutputSpacing(gridSpacing);
+      m_GridResampleFilter->SetOutputStartIndex(startIndex);
+      m_GridResampleFilter->SetOutputSize(this->GetOutputSize());
+      m_GridResampleFilter->SetInterpolator(const_cast<InterpolatorType *>(m_WarpFilter->GetInterpolator()));
+      m_GridResampleFilter->SetEdgePaddingValue(m_WarpFilter->GetEdgePaddingValue());
+      m_GridResampleFilter->UpdateOutputInformation();
+      m_UseGridResampling = true;
+      otbMsgDevMacro(<< "Axis-aligned transform: resampling without displacement field");
+      }
+    }
 }
 
 template <class TInputImage, class TOutputImage, class TInterpolatorPrecisionType>
@@ -108,6 +228,13 @@ StreamingResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionTy
 {
   if (this->m_Updating) return;
 
+  if (m_UseGridResampling)
+    {
+    m_GridResampleFilter->GetOutput()->SetRequestedRegion(output);
+    m_GridResampleFilter->GetOutput()->PropagateRequestedRegion();
+    return;
+    }
+
   m_WarpFilter->GetOutput()->SetRequestedRegion(output);
   m_WarpFilter->GetOutput()->PropagateRequestedRegion();
 }
@@ -163,6 +290,8 @@ StreamingResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionTy
   os << indent << "OutputSpacing: " << this->GetOutputSpacing() << std::endl;
   os << indent << "OutputStartIndex: " << this->GetOutputStartIndex() << std::endl;
   os << indent << "OutputSize: " << this->GetOutputSize() << std::endl;
+  os << indent << "MaximumGeometricError: " << m_MaximumGeometricError << std::endl;
+  os << indent << "GridResampling: " << m_GridResampling << std::endl;
 }
 
 
@@ -26,6 +26,7 @@
 #include "itkGaussianImageSource.h"
 #include "itkMersenneTwisterRandomVariateGenerator.h"
 #include "itkIdentityTransform.h"
+#include "itkNearestNeighborInterpolateImageFunction.h"
 #include "otbDifferenceImageFilter.h"
 #include "itkStreamingImageFilter.h"
 
@@ -158,5 +159,30 @@ int otbGridResampleImageFilter(int itkNotUsed(argc), char * itkNotUsed(argv)[])
     return EXIT_FAILURE;
     }
 
+  // Same check with nearest neighbor interpolation and an integer
+  // decimation factor, which copies input pixels
+  typedef itk::NearestNeighborInterpolateImageFunction<ImageType,double> NearestNeighborInterpolatorType;
+  filter->SetInterpolator(NearestNeighborInterpolatorType::New());
+  refFilter->SetInterpolator(NearestNeighborInterpolatorType::New());
+
+  spacing[0]=3;
+  spacing[1]=-2;
+  uspacing[0]=3;
+  uspacing[1]=2;
+  filter->SetOutputSpacing(spacing);
+  refFilter->SetOutputSpacing(uspacing);
+
+  comparisonFilter->Update();
+
+  nbPixelsWithDiff = comparisonFilter->GetNumberOfPixelsWithDifferences();
+
+  std::cout<<"Number of pixels with differences (nearest neighbor): "<<nbPixelsWithDiff<<std::endl;
+
+  if(nbPixelsWithDiff)
+    {
+    std::cerr<<"Output of itk::GridResampleImageFilter does not match output of itk::ResampleImageFilter with nearest neighbor interpolation"<<std::endl;
+    return EXIT_FAILURE;
+    }
+
   return EXIT_SUCCESS;
 }
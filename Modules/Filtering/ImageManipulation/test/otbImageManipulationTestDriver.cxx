@@ -35,6 +35,8 @@ void RegisterTests()
   REGISTER_TEST(otbVectorImageToAmplitudeImageFilter);
   REGISTER_TEST(otbUnaryFunctorNeighborhoodWithOffsetImageFilter);
   REGISTER_TEST(otbStreamingResampleImageFilterCompareWithITK);
+  REGISTER_TEST(otbStreamingResampleImageFilterGridPath);
+  REGISTER_TEST(otbStreamingResampleImageFilterGridPathAffine);
   REGISTER_TEST(otbRegionProjectionResampler);
   REGISTER_TEST(otbUnaryFunctorWithIndexImageFilter);
   REGISTER_TEST(otbMeanFunctorImageTest);
@@ -74,4 +76,5 @@ void RegisterTests()
   REGISTER_TEST(otbMaskedIteratorDecoratorNominal);
   REGISTER_TEST(otbMaskedIteratorDecoratorDegenerate);
   REGISTER_TEST(otbMaskedIteratorDecoratorExtended);
+  REGISTER_TEST(otbSceneMosaicImageFilter);
 }
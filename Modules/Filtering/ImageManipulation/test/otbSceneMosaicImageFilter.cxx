@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "otbImage.h"
+#include "otbVectorImage.h"
+#include "otbSceneMosaicImageFilter.h"
+#include "itkStreamingImageFilter.h"
+
+#include <cmath>
+
+typedef otb::Image<double> MosaicImageType;
+
+template <class TImage = MosaicImageType>
+static typename TImage::Pointer CreateScene(double x, typename TImage::PixelType value)
+{
+  typedef TImage ImageType;
+
+  typename ImageType::IndexType index;
+  index.Fill(0);
+  typename ImageType::SizeType size;
+  size.Fill(20);
+  typename ImageType::RegionType region(index, size);
+  typename ImageType::PointType origin;
+  origin[0] = x;
+  origin[1] = 0.;
+  typename ImageType::SpacingType spacing;
+  spacing[0] = 1.;
+  spacing[1] = -1.;
+
+  typename ImageType::Pointer scene = ImageType::New();
+  scene->SetRegions(region);
+  scene->SetOrigin(origin);
+  scene->SetSignedSpacing(spacing);
+  scene->Allocate();
+  scene->FillBuffer(value);
+  return scene;
+}
+
+int otbSceneMosaicImageFilter(int itkNotUsed(argc), char * itkNotUsed(argv)[])
+{
+  // Check that the filter builds with VectorImage too
+  typedef otb::SceneMosaicImageFilter<otb::VectorImage<double> > VectorFilterType;
+  VectorFilterType::Pointer vectorFilter = VectorFilterType::New();
+
+  typedef otb::SceneMosaicImageFilter<MosaicImageType>                  FilterType;
+  typedef itk::StreamingImageFilter<MosaicImageType, MosaicImageType> StreamingFilterType;
+
+  // Two scenes overlapping on 10 columns
+  MosaicImageType::Pointer left = CreateScene(0., 10.);
+  MosaicImageType::Pointer right = CreateScene(10., 20.);
+  MosaicImageType::IndexType hole;
+  hole[0] = 5;
+  hole[1] = 5;
+  right->SetPixel(hole, 0.);
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->PushBackInput(left);
+  filter->PushBackInput(right);
+  filter->SetIndexCellSize(8);
+
+  StreamingFilterType::Pointer streaming = StreamingFilterType::New();
+  streaming->SetInput(filter->GetOutput());
+  streaming->SetNumberOfStreamDivisions(4);
+
+  // Output pixel, expected value
+  struct Check
+  {
+    long x, y;
+    double value;
+  };
+
+  auto check = [&](const std::vector<Check> & checks, const char * name)
+  {
+    streaming->Update();
+    MosaicImageType * output = streaming->GetOutput();
+    std::cout << name << ": output size " << output->GetLargestPossibleRegion().GetSize() << std::endl;
+    if (output->GetLargestPossibleRegion().GetSize()[0] != 30
+        || output->GetLargestPossibleRegion().GetSize()[1] != 20)
+      {
+      std::cerr << name << ": wrong output size" << std::endl;
+      return false;
+      }
+    bool ok = true;
+    for (const Check & c : checks)
+      {
+      MosaicImageType::IndexType index;
+      index[0] = c.x;
+      index[1] = c.y;
+      if (std::abs(output->GetPixel(index) - c.value) > 1e-9)
+        {
+        std::cerr << name << ": pixel " << index << " is " << output->GetPixel(index)
+                  << " instead of " << c.value << std::endl;
+        ok = false;
+        }
+      }
+    return ok;
+  };
+
+  // The last input is on top, except on its no-data pixels
+  bool ok = check({{5, 5, 10.}, {25, 5, 20.}, {12, 3, 20.}, {15, 5, 10.}}, "Input order");
+
+  // The priorities override the input order
+  filter->SetPriority(0, 1.);
+  ok = check({{5, 5, 10.}, {25, 5, 20.}, {12, 3, 10.}, {15, 5, 10.}}, "Priorities") && ok;
+
+  // The right scene fades in over 4 pixels from its border (column 9.5)
+  filter->SetPriority(0, 0.);
+  filter->SetFeatheringDistance(4.);
+  ok = check({{12, 10, 10. * 0.375 + 20. * 0.625}, {14, 10, 20.}, {25, 5, 20.}}, "Feathering") && ok;
+
+  // It also fades in around its no-data pixel (column 15, row 5), and the
+  // left scene fades out towards its own border (column 19.5)
+  const double leftAlpha = 3.5 / 4.;
+  const double rightAlpha = 0.5 / 4.;
+  ok = check({{16, 5, (10. * leftAlpha * (1. - rightAlpha) + 20. * rightAlpha) / (leftAlpha * (1. - rightAlpha) + rightAlpha)}},
+             "Feathering around no-data") && ok;
+
+  // Harmonization of the left scene
+  filter->SetFeatheringDistance(0.);
+  filter->SetHarmonization(0, std::vector<double>(1, 2.), std::vector<double>(1, 1.));
+  ok = check({{5, 5, 21.}, {12, 3, 20.}}, "Harmonization") && ok;
+
+  // Integer outputs are rounded, and clamped to the range of the pixel type
+  typedef otb::Image<unsigned char>                   UInt8ImageType;
+  typedef otb::SceneMosaicImageFilter<UInt8ImageType> UInt8FilterType;
+  UInt8FilterType::Pointer uint8Filter = UInt8FilterType::New();
+  uint8Filter->PushBackInput(CreateScene<UInt8ImageType>(0., 200));
+  uint8Filter->PushBackInput(CreateScene<UInt8ImageType>(10., 100));
+  uint8Filter->PushBackInput(CreateScene<UInt8ImageType>(20., 100));
+  uint8Filter->SetHarmonization(0, std::vector<double>(1, 1.), std::vector<double>(1, 0.6));
+  uint8Filter->SetHarmonization(1, std::vector<double>(1, 3.), std::vector<double>(1, 0.));
+  uint8Filter->SetHarmonization(2, std::vector<double>(1, 1.), std::vector<double>(1, -150.));
+  uint8Filter->Update();
+
+  struct UInt8Check
+  {
+    long x;
+    unsigned int value;
+  };
+  const UInt8Check uint8Checks[3] = {{5, 201}, {15, 255}, {35, 0}};
+  for (const UInt8Check & c : uint8Checks)
+    {
+    UInt8ImageType::IndexType index;
+    index[0] = c.x;
+    index[1] = 5;
+    const unsigned int value = uint8Filter->GetOutput()->GetPixel(index);
+    if (value != c.value)
+      {
+      std::cerr << "UInt8: pixel " << index << " is " << value << " instead of " << c.value << std::endl;
+      ok = false;
+      }
+    }
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,266 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbImage.h"
+#include "otbTransform.h"
+#include "otbStreamingResampleImageFilter.h"
+#include "otbDifferenceImageFilter.h"
+#include "itkResampleImageFilter.h"
+#include "itkAffineTransform.h"
+#include "itkLinearInterpolateImageFunction.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <cmath>
+
+namespace
+{
+
+/** Analytic transform flagged as non-linear (like GenericRSTransform):
+ * a scale and a translation, optionally mixed with a small rotation */
+class TestNonLinearTransform : public otb::Transform<double, 2, 2>
+{
+public:
+  typedef TestNonLinearTransform         Self;
+  typedef otb::Transform<double, 2, 2>   Superclass;
+  typedef itk::SmartPointer<Self>        Pointer;
+  typedef itk::SmartPointer<const Self>  ConstPointer;
+
+  itkNewMacro(Self);
+  itkTypeMacro(TestNonLinearTransform, otb::Transform);
+
+  typedef Superclass::InputPointType  InputPointType;
+  typedef Superclass::OutputPointType OutputPointType;
+
+  itkSetMacro(Angle, double);
+
+  OutputPointType TransformPoint(const InputPointType & point) const override
+  {
+    const double x = 2.7 * point[0] + 13.5;
+    const double y = 1.9 * point[1] - 7.25;
+    OutputPointType out;
+    out[0] = std::cos(m_Angle) * x - std::sin(m_Angle) * y;
+    out[1] = std::sin(m_Angle) * x + std::cos(m_Angle) * y;
+    return out;
+  }
+
+protected:
+  TestNonLinearTransform() : m_Angle(0.) {}
+  ~TestNonLinearTransform() override {}
+
+private:
+  double m_Angle;
+};
+
+}
+
+/** Resamples a random image through StreamingResampleImageFilter with a
+ * transform flagged as non-linear, and compares with itk::ResampleImageFilter.
+ * With the grid path enabled, the axis-aligned transform runs the grid
+ * path, the rotated one the displacement field path. */
+int otbStreamingResampleImageFilterGridPath(int itkNotUsed(argc), char * itkNotUsed(argv)[])
+{
+  typedef otb::Image<double> ImageType;
+  typedef otb::StreamingResampleImageFilter<ImageType, ImageType, double> FilterType;
+  typedef itk::ResampleImageFilter<ImageType, ImageType, double> RefFilterType;
+  typedef itk::LinearInterpolateImageFunction<ImageType, double> InterpolatorType;
+  typedef otb::DifferenceImageFilter<ImageType, ImageType> ComparisonFilterType;
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+
+  RandomGeneratorType::Pointer randomGenerator = RandomGeneratorType::GetInstance();
+  randomGenerator->SetSeed(42);
+
+  ImageType::SizeType size;
+  size.Fill(500);
+  ImageType::RegionType region;
+  region.SetSize(size);
+
+  ImageType::Pointer randomImage = ImageType::New();
+  randomImage->SetRegions(region);
+  randomImage->Allocate();
+  itk::ImageRegionIterator<ImageType> iter(randomImage, region);
+  for (iter.GoToBegin(); !iter.IsAtEnd(); ++iter)
+    {
+    iter.Set(randomGenerator->GetUniformVariate(0.0, 1.0) * 1000);
+    }
+
+  ImageType::PointType origin;
+  origin[0] = 3.1;
+  origin[1] = 8.4;
+  ImageType::SpacingType spacing;
+  spacing.Fill(0.9);
+  ImageType::IndexType startIndex;
+  startIndex[0] = 5;
+  startIndex[1] = -3;
+  ImageType::SizeType outSize;
+  outSize.Fill(123);
+
+  const double angles[2] = {0., 0.01};
+  for (unsigned int k = 0; k < 2; ++k)
+    {
+    TestNonLinearTransform::Pointer transform = TestNonLinearTransform::New();
+    transform->SetAngle(angles[k]);
+
+    FilterType::Pointer filter = FilterType::New();
+    filter->SetInput(randomImage);
+    filter->SetTransform(transform);
+    filter->SetInterpolator(InterpolatorType::New());
+    filter->SetOutputOrigin(origin);
+    filter->SetOutputSpacing(spacing);
+    filter->SetOutputStartIndex(startIndex);
+    filter->SetOutputSize(outSize);
+    filter->SetDisplacementFieldSpacing(spacing * 10.);
+    filter->GridResamplingOn();
+
+    RefFilterType::Pointer refFilter = RefFilterType::New();
+    refFilter->SetInput(randomImage);
+    refFilter->SetTransform(transform);
+    refFilter->SetInterpolator(InterpolatorType::New());
+    refFilter->SetOutputOrigin(origin);
+    refFilter->SetOutputSpacing(spacing);
+    refFilter->SetOutputStartIndex(startIndex);
+    refFilter->SetSize(outSize);
+
+    ComparisonFilterType::Pointer comparisonFilter = ComparisonFilterType::New();
+    comparisonFilter->SetValidInput(refFilter->GetOutput());
+    comparisonFilter->SetTestInput(filter->GetOutput());
+    comparisonFilter->SetDifferenceThreshold(1e-6);
+    comparisonFilter->Update();
+
+    const unsigned int nbPixelsWithDiff = comparisonFilter->GetNumberOfPixelsWithDifferences();
+
+    std::cout << "Angle " << angles[k] << ": number of pixels with differences: " << nbPixelsWithDiff << std::endl;
+
+    if (nbPixelsWithDiff)
+      {
+      std::cerr << "Output of otb::StreamingResampleImageFilter does not match output of itk::ResampleImageFilter" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
+
+/** Resamples a random image through StreamingResampleImageFilter with an
+ * affine transform (scale and translation) mapping part of the output
+ * outside of the input, with and without the grid path. Both paths must
+ * give the same values, including the edge padding at the borders. */
+int otbStreamingResampleImageFilterGridPathAffine(int itkNotUsed(argc), char * itkNotUsed(argv)[])
+{
+  typedef otb::Image<double> ImageType;
+  typedef otb::StreamingResampleImageFilter<ImageType, ImageType, double> FilterType;
+  typedef itk::AffineTransform<double, 2> TransformType;
+  typedef itk::LinearInterpolateImageFunction<ImageType, double> InterpolatorType;
+  typedef otb::DifferenceImageFilter<ImageType, ImageType> ComparisonFilterType;
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+
+  RandomGeneratorType::Pointer randomGenerator = RandomGeneratorType::GetInstance();
+  randomGenerator->SetSeed(42);
+
+  ImageType::SizeType size;
+  size.Fill(200);
+  ImageType::RegionType region;
+  region.SetSize(size);
+
+  ImageType::Pointer randomImage = ImageType::New();
+  randomImage->SetRegions(region);
+  randomImage->Allocate();
+  itk::ImageRegionIterator<ImageType> iter(randomImage, region);
+  for (iter.GoToBegin(); !iter.IsAtEnd(); ++iter)
+    {
+    iter.Set(randomGenerator->GetUniformVariate(0.0, 1.0) * 1000);
+    }
+
+  // Output columns 16 to 161 and rows 11 to 251 fall inside the input
+  TransformType::Pointer transform = TransformType::New();
+  TransformType::MatrixType matrix;
+  matrix.Fill(0.);
+  matrix(0, 0) = 1.37;
+  matrix(1, 1) = 0.83;
+  transform->SetMatrix(matrix);
+  TransformType::OutputVectorType translation;
+  translation[0] = -21.3;
+  translation[1] = -9.6;
+  transform->SetTranslation(translation);
+
+  ImageType::PointType origin;
+  origin.Fill(0.);
+  ImageType::SpacingType spacing;
+  spacing.Fill(1.);
+  ImageType::SizeType outSize;
+  outSize[0] = 220;
+  outSize[1] = 260;
+
+  const double edgePaddingValue = -1.;
+
+  FilterType::Pointer filters[2];
+  for (unsigned int k = 0; k < 2; ++k)
+    {
+    filters[k] = FilterType::New();
+    filters[k]->SetInput(randomImage);
+    filters[k]->SetTransform(transform);
+    filters[k]->SetInterpolator(InterpolatorType::New());
+    filters[k]->SetOutputOrigin(origin);
+    filters[k]->SetOutputSpacing(spacing);
+    filters[k]->SetOutputSize(outSize);
+    filters[k]->SetEdgePaddingValue(edgePaddingValue);
+    filters[k]->SetDisplacementFieldSpacing(spacing * 10.);
+    filters[k]->SetGridResampling(k == 1);
+    filters[k]->Update();
+    }
+
+  ComparisonFilterType::Pointer comparisonFilter = ComparisonFilterType::New();
+  comparisonFilter->SetValidInput(filters[0]->GetOutput());
+  comparisonFilter->SetTestInput(filters[1]->GetOutput());
+  comparisonFilter->SetDifferenceThreshold(1e-6);
+  comparisonFilter->Update();
+
+  const unsigned int nbPixelsWithDiff = comparisonFilter->GetNumberOfPixelsWithDifferences();
+  std::cout << "Number of pixels with differences: " << nbPixelsWithDiff << std::endl;
+
+  unsigned int nbPaddedPixels = 0;
+  itk::ImageRegionConstIterator<ImageType> outIt(filters[1]->GetOutput(),
+                                                 filters[1]->GetOutput()->GetLargestPossibleRegion());
+  for (outIt.GoToBegin(); !outIt.IsAtEnd(); ++outIt)
+    {
+    if (outIt.Get() == edgePaddingValue)
+      {
+      ++nbPaddedPixels;
+      }
+    }
+  std::cout << "Number of padded pixels: " << nbPaddedPixels << std::endl;
+
+  if (nbPixelsWithDiff)
+    {
+    std::cerr << "The grid path does not match the displacement field path" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Columns 0-15 and 162-219, rows 0-10 and 252-259
+  const unsigned int expectedPaddedPixels = 220 * 260 - 146 * 241;
+  if (nbPaddedPixels != expectedPaddedPixels)
+    {
+    std::cerr << "Expected " << expectedPaddedPixels << " padded pixels, got " << nbPaddedPixels << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
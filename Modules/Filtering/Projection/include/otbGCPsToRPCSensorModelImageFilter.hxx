@@ -248,11 +248,18 @@ GCPsToRPCSensorModelImageFilter<TImage>
   rsTransform->SetInputKeywordList(m_Keywordlist);
   rsTransform->InstantiateTransform();
 
-  ContinuousIndexType   idFix, idOut;
-  Continuous3DIndexType idOut3D, idTrans3D;
-
-  Point2DType sensorPoint;
-  Point3DType groundPoint;
+  // Localize all the GCPs at once, by blocks in parallel
+  std::vector<Point3DType> sensorPoints(m_GCPsContainer.size());
+  std::vector<Point3DType> groundPoints(m_GCPsContainer.size());
+  for (unsigned int i = 0; i < m_GCPsContainer.size(); ++i)
+    {
+    sensorPoints[i][0] = m_GCPsContainer[i].first[0];
+    sensorPoints[i][1] = m_GCPsContainer[i].first[1];
+    sensorPoints[i][2] = m_GCPsContainer[i].second[2];
+    }
+  this->GetMultiThreader()->SetNumberOfThreads(this->GetNumberOfThreads());
+  ParallelBatchTransformPoints(rsTransform.GetPointer(), sensorPoints.data(), groundPoints.data(),
+                               sensorPoints.size(), this->GetMultiThreader());
 
   double sum = 0.;
   m_MeanError = 0.;
@@ -262,31 +269,8 @@ GCPsToRPCSensorModelImageFilter<TImage>
 
   for (unsigned int i = 0; i < m_GCPsContainer.size(); ++i)
     {
-    // GCP value
-    sensorPoint = m_GCPsContainer[i].first;
-    groundPoint = m_GCPsContainer[i].second;
-
-    // Compute Transform
-    Point3DType groundPointTemp, sensorPointTemp;
-    sensorPointTemp[0] = sensorPoint[0];
-    sensorPointTemp[1] = sensorPoint[1];
-    sensorPointTemp[2] = groundPoint[2];
-
-    groundPointTemp = rsTransform->TransformPoint(sensorPointTemp);
-
     // Compute Euclidian distance
-    idFix[0] = sensorPoint[0];
-    idFix[1] = sensorPoint[1];
-
-    idOut3D[0] = groundPoint[0];
-    idOut3D[1] = groundPoint[1];
-    idOut3D[2] = groundPoint[2];
-
-    idTrans3D[0] = groundPointTemp[0];
-    idTrans3D[1] = groundPointTemp[1];
-    idTrans3D[2] = groundPointTemp[2];
-
-    double error = idOut3D.EuclideanDistanceTo(idTrans3D);
+    double error = m_GCPsContainer[i].second.EuclideanDistanceTo(groundPoints[i]);
 
     // Add error to the container
     m_ErrorsContainer.push_back(error);
@@ -318,10 +302,12 @@ GCPsToRPCSensorModelImageFilter<TImage>
     // Retrieve the residual ground error
     m_RMSGroundError = rmsError;
 
-    // Compute errors
-    this->ComputeErrors();
-
+    // Compute errors with the estimated model: ComputeErrors() uses
+    // m_Keywordlist, which used to be updated only afterwards, so that
+    // the errors described the previous model (or no model at all on
+    // the first estimation). GetRMSGroundError() is not affected.
     m_Keywordlist = otb_kwl;
+    this->ComputeErrors();
 
     m_ModelUpToDate = true;
     }
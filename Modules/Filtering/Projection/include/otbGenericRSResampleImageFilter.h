@@ -110,6 +110,11 @@ public:
                                         DisplacementFieldSpacing,
                                         SpacingType);
 
+  /** The maximum geometric error (in input pixels) of the adaptive
+   *  displacement field. 0 disables the adaptive refinement. */
+  otbSetObjectMemberMacro(Resampler, MaximumGeometricError, double);
+  otbGetObjectMemberConstMacro(Resampler, MaximumGeometricError, double);
+
   /** The resampled image parameters */
   /** Output Origin */
   void SetOutputOrigin(const OriginType & origin)
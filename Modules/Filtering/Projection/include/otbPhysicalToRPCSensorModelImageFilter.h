@@ -48,6 +48,11 @@ namespace otb {
  * Depending on the value of the DEMDirectory, an elevation fetched
  * from the SRT directory is used.(TODO)
  *
+ * When the geometry cache is enabled (see GeometryCache), the
+ * estimated model is stored in the cache and read back for the same
+ * input geometry, grid and elevation settings. The estimation
+ * errors are then not computed.
+ *
  * This filter does not modify the image buffer, but only the
  * metadata. Therefore, it provides in-place support, which is
  * enabled by default. Call InPlaceOff() to change the default
@@ -23,6 +23,10 @@
 
 #include "otbPhysicalToRPCSensorModelImageFilter.h"
 #include "otbDEMHandler.h"
+#include "otbGeometryCache.h"
+
+#include <sstream>
+#include <vector>
 
 namespace otb {
 
@@ -65,39 +69,84 @@ PhysicalToRPCSensorModelImageFilter<TImage>
     // Get the input
     ImageType * input = const_cast<ImageType*>(this->GetInput());
 
-    // Build the grid
-    // Generate GCPs from physical sensor model
-    RSTransformPointerType  rsTransform = RSTransformType::New();
-    rsTransform->SetInputKeywordList(input->GetImageKeywordlist());
-    rsTransform->InstantiateTransform();
-
-    // Compute the size of the grid
-    typename ImageType::SizeType  size = input->GetLargestPossibleRegion().GetSize();
-    double gridSpacingX = size[0]/m_GridSize[0];
-    double gridSpacingY = size[1]/m_GridSize[1];
-
-    for(unsigned int px = 0; px<m_GridSize[0]; ++px)
+    // The estimated model depends on the input geometry, on the grid and
+    // on the elevation settings
+    std::string cacheKey;
+    if (GeometryCache::IsEnabled())
       {
-      for(unsigned int py = 0; py<m_GridSize[1]; ++py)
+      DEMHandler::Pointer demHandler = DEMHandler::Instance();
+      std::ostringstream description;
+      description.precision(17);
+      description << "rpc\n" << GeometryCache::Serialize(input->GetImageKeywordlist())
+                  << m_GridSize << "\n"
+                  << input->GetLargestPossibleRegion() << input->GetOrigin() << input->GetSignedSpacing()
+                  << demHandler->GetGeoidFile() << "\n"
+                  << demHandler->GetDefaultHeightAboveEllipsoid() << "\n";
+      for (unsigned int i = 0; i < demHandler->GetDEMCount(); ++i)
         {
-        PointType inputPoint =  input->GetOrigin();
-        inputPoint[0] += (px * gridSpacingX + 0.5) * input->GetSignedSpacing()[0];
-        inputPoint[1] += (py * gridSpacingY + 0.5) * input->GetSignedSpacing()[1];
-        PointType outputPoint = rsTransform->TransformPoint(inputPoint);
-        m_GCPsToSensorModelFilter->AddGCP(inputPoint, outputPoint);
+        description << demHandler->GetDEMDirectory(i) << "\n";
         }
+      cacheKey = GeometryCache::ComputeKey(description.str());
       }
 
-    m_GCPsToSensorModelFilter->SetInput(input);
-    m_GCPsToSensorModelFilter->UpdateOutputInformation();
+    ImageKeywordlist rpcKeywordlist;
+    if (!cacheKey.empty() && GeometryCache::Load(cacheKey, rpcKeywordlist))
+      {
+      otbMsgDevMacro(<<"RPC model read from the geometry cache");
+      }
+    else
+      {
+      // Build the grid
+      // Generate GCPs from physical sensor model
+      RSTransformPointerType  rsTransform = RSTransformType::New();
+      rsTransform->SetInputKeywordList(input->GetImageKeywordlist());
+      rsTransform->InstantiateTransform();
+
+      // Compute the size of the grid
+      typename ImageType::SizeType  size = input->GetLargestPossibleRegion().GetSize();
+      double gridSpacingX = size[0]/m_GridSize[0];
+      double gridSpacingY = size[1]/m_GridSize[1];
+
+      std::vector<PointType> inputPoints;
+      inputPoints.reserve(m_GridSize[0] * m_GridSize[1]);
+      for(unsigned int px = 0; px<m_GridSize[0]; ++px)
+        {
+        for(unsigned int py = 0; py<m_GridSize[1]; ++py)
+          {
+          PointType inputPoint =  input->GetOrigin();
+          inputPoint[0] += (px * gridSpacingX + 0.5) * input->GetSignedSpacing()[0];
+          inputPoint[1] += (py * gridSpacingY + 0.5) * input->GetSignedSpacing()[1];
+          inputPoints.push_back(inputPoint);
+          }
+        }
+
+      // Project the whole grid at once, by blocks in parallel
+      std::vector<PointType> outputPoints(inputPoints.size());
+      this->GetMultiThreader()->SetNumberOfThreads(this->GetNumberOfThreads());
+      ParallelBatchTransformPoints(rsTransform.GetPointer(), inputPoints.data(), outputPoints.data(),
+                                   inputPoints.size(), this->GetMultiThreader());
 
-    otbGenericMsgDebugMacro(<<"RPC model estimated. RMS ground error: "<<m_GCPsToSensorModelFilter->GetRMSGroundError()
-             <<", Mean error: "<<m_GCPsToSensorModelFilter->GetMeanError());
+      for(unsigned int i = 0; i < inputPoints.size(); ++i)
+        {
+        m_GCPsToSensorModelFilter->AddGCP(inputPoints[i], outputPoints[i]);
+        }
+
+      m_GCPsToSensorModelFilter->SetInput(input);
+      m_GCPsToSensorModelFilter->UpdateOutputInformation();
+
+      otbGenericMsgDebugMacro(<<"RPC model estimated. RMS ground error: "<<m_GCPsToSensorModelFilter->GetRMSGroundError()
+               <<", Mean error: "<<m_GCPsToSensorModelFilter->GetMeanError());
+
+      rpcKeywordlist = m_GCPsToSensorModelFilter->GetKeywordlist();
+      if (!cacheKey.empty())
+        {
+        GeometryCache::Store(cacheKey, rpcKeywordlist);
+        }
+      }
 
     // Encapsulate the keywordlist
     itk::MetaDataDictionary& dict = this->GetOutput()->GetMetaDataDictionary();
-    itk::EncapsulateMetaData<ImageKeywordlist>(dict, MetaDataKey::OSSIMKeywordlistKey,
-                                               m_GCPsToSensorModelFilter->GetKeywordlist());
+    itk::EncapsulateMetaData<ImageKeywordlist>(dict, MetaDataKey::OSSIMKeywordlistKey, rpcKeywordlist);
 
     // put the flag to true
     m_OutputInformationGenerated = true;
@@ -24,6 +24,9 @@
 #include "otbTransform.h"
 #include "itkMacro.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace otb
 {
 /** \class RationalTransform
@@ -147,6 +150,69 @@ public:
     return outputPoint;
   }
 
+  /** Transform an array of points. The polynomials are evaluated with the
+   * same operations as in TransformPoint(), so results are identical, but
+   * the loops run over the points and can be vectorized by the compiler. */
+  void TransformPoints(const InputPointType * inputPoints,
+                       OutputPointType * outputPoints,
+                       std::size_t count) const override
+  {
+    // Check for consistency
+    if(this->GetNumberOfParameters() != this->m_Parameters.size())
+      {
+      itkExceptionMacro(<<"Wrong number of parameters: found "<<this->m_Parameters.Size()<<", expected "<<this->GetNumberOfParameters());
+      }
+
+    unsigned int dimensionStride = (m_DenominatorDegree+1)+(m_NumeratorDegree+1);
+
+    std::vector<TScalarType> coordinates(count);
+    std::vector<TScalarType> num(count);
+    std::vector<TScalarType> denom(count);
+    std::vector<TScalarType> currentPower(count);
+
+    for(unsigned int dim = 0; dim < SpaceDimension; ++dim)
+      {
+      const ParametersValueType * coefficients = this->m_Parameters.data_block() + dim*dimensionStride;
+
+      for(std::size_t i = 0; i < count; ++i)
+        {
+        coordinates[i] = inputPoints[i][dim];
+        num[i] = itk::NumericTraits<TScalarType>::Zero;
+        denom[i] = itk::NumericTraits<TScalarType>::Zero;
+        currentPower[i] = 1.;
+        }
+
+      // Compute numerator
+      for(unsigned int numDegree = 0; numDegree <= m_NumeratorDegree; ++numDegree)
+        {
+        const ParametersValueType coefficient = coefficients[numDegree];
+        for(std::size_t i = 0; i < count; ++i)
+          {
+          num[i]+=coefficient*currentPower[i];
+          currentPower[i]*=coordinates[i];
+          }
+        }
+
+      // Compute denominator
+      std::fill(currentPower.begin(), currentPower.end(), 1.);
+      for(unsigned int denomDegree = 0; denomDegree <= m_DenominatorDegree; ++denomDegree)
+        {
+        const ParametersValueType coefficient = coefficients[m_NumeratorDegree+denomDegree+1];
+        for(std::size_t i = 0; i < count; ++i)
+          {
+          denom[i]+=coefficient*currentPower[i];
+          currentPower[i]*=coordinates[i];
+          }
+        }
+
+      // Fill the output
+      for(std::size_t i = 0; i < count; ++i)
+        {
+        outputPoints[i][dim]=num[i]/denom[i];
+        }
+      }
+  }
+
   /** Get the number of parameters */
   NumberOfParametersType GetNumberOfParameters() const override
   {
@@ -22,6 +22,7 @@
 
 #include "otbRationalTransform.h"
 #include <fstream>
+#include <vector>
 
 
 int otbRationalTransform(int argc, char* argv[])
@@ -77,16 +78,33 @@ int otbRationalTransform(int argc, char* argv[])
   ofs<<"Rational function is: "<<std::endl;
   ofs<<"fx(x, y) = (1+2*x+3*x^2+4*x^3+5*x^4)/(6+7*x+8*x^2+9*x^3+10*x^4)"<<std::endl;
   ofs<<"fy(x, y) = (11+12*y+13*y^2+14*y^3+15*y^4)/(16+17*y+18*y^2+19*y^3+20*y^4)"<<std::endl;
+  std::vector<RationalTransformType::InputPointType> inputPoints;
+  std::vector<RationalTransformType::OutputPointType> outputPoints;
   while(idx+1<(unsigned int)argc)
     {
     inputPoint[0] = atof(argv[idx]);
     inputPoint[1] = atof(argv[idx+1]);
     outputPoint = rt->TransformPoint(inputPoint);
     ofs<<inputPoint<<" -> "<<outputPoint<<std::endl;
+    inputPoints.push_back(inputPoint);
+    outputPoints.push_back(outputPoint);
     idx+=2;
     }
 
   ofs.close();
 
+  // The batch evaluation must give exactly the same results
+  std::vector<RationalTransformType::OutputPointType> batchPoints(inputPoints.size());
+  rt->TransformPoints(inputPoints.data(), batchPoints.data(), inputPoints.size());
+  for(unsigned int i = 0; i < inputPoints.size(); ++i)
+    {
+    if(batchPoints[i] != outputPoints[i])
+      {
+      std::cerr<<"Batch evaluation of "<<inputPoints[i]<<" gives "<<batchPoints[i]
+               <<" instead of "<<outputPoints[i]<<std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
   return EXIT_SUCCESS;
 }
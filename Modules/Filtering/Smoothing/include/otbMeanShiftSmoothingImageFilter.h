@@ -27,6 +27,7 @@
 #include "itkImageRegionConstIterator.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
 #include <algorithm>
+#include <vector>
 
 
 namespace otb
@@ -608,8 +609,10 @@ protected:
   /** PrintSelf method */
   void PrintSelf(std::ostream& os, itk::Indent indent) const override;
 
-  virtual void CalculateMeanShiftVector(const typename RealVectorImageType::Pointer inputImagePtr,
-                                        const RealVector& jointPixel, const OutputRegionType& outputRegion,
+  /** Mean shift vector at jointPixel, over the neighbors in outputRegion.
+   * The joint domain data is read from the structure of arrays built in
+   * BeforeThreadedGenerateData(). */
+  virtual void CalculateMeanShiftVector(const RealVector& jointPixel, const OutputRegionType& outputRegion,
                                         const RealVector& bandwidth,
                                         RealVector& meanShiftVector);
 #if 0
@@ -645,8 +648,22 @@ private:
   /** Number of components per pixel in the input image */
   unsigned int m_NumberOfComponentsPerPixel;
 
-  /** Input data in the joint spatial-range domain, scaled by the bandwidths */
-  typename RealVectorImageType::Pointer m_JointImage;
+  /** Input data in the joint spatial-range domain over m_JointRegion,
+   * stored component by component: component c of the pixel at offset o
+   * is m_JointComponents[c * m_JointRegion.GetNumberOfPixels() + o] */
+  std::vector<RealType> m_JointComponents;
+  RegionType            m_JointRegion;
+
+  /** Offset of a pixel in m_JointRegion */
+  std::size_t GetJointOffset(const InputIndexType & index) const
+  {
+    std::size_t offset = 0;
+    for (int dim = ImageDimension - 1; dim >= 0; --dim)
+      {
+      offset = offset * m_JointRegion.GetSize()[dim] + (index[dim] - m_JointRegion.GetIndex()[dim]);
+      }
+    return offset;
+  }
 
   /** Image to store the status at each pixel:
    * 0 : no mode has been found yet
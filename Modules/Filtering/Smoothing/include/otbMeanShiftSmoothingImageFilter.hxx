@@ -24,7 +24,8 @@
 
 #include "otbMeanShiftSmoothingImageFilter.h"
 #include "itkImageRegionIterator.h"
-#include "otbUnaryFunctorWithIndexWithOutputSizeImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "otbMacro.h"
 
 #include "itkProgressReporter.h"
@@ -241,21 +242,29 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
   zero.Fill(0);
   spatialOutput->FillBuffer(zero);
 
-  // m_JointImage is the input data expressed in the joint spatial-range
+  // m_JointComponents is the input data expressed in the joint spatial-range
   // domain, i.e. spatial coordinates are concatenated to the range values.
-  // Moreover, pixel components in this image are normalized by their respective
-  // (spatial or range) bandwidth.
-  typedef Meanshift::SpatialRangeJointDomainTransform<InputImageType, RealVectorImageType> FunctionType;
-  typedef otb::UnaryFunctorWithIndexWithOutputSizeImageFilter<InputImageType, RealVectorImageType, FunctionType>
-      JointImageFunctorType;
-
-  typename JointImageFunctorType::Pointer jointImageFunctor = JointImageFunctorType::New();
+  // It is stored component by component over the buffered region, so that
+  // the distances to a run of neighbors are computed on contiguous data.
+  const unsigned int jointDimension = ImageDimension + m_NumberOfComponentsPerPixel;
+  m_JointRegion = inputPtr->GetBufferedRegion();
+  const std::size_t nbJointPixels = m_JointRegion.GetNumberOfPixels();
+  m_JointComponents.resize(jointDimension * nbJointPixels);
 
-  jointImageFunctor->SetInput(inputPtr);
-  jointImageFunctor->GetFunctor().Initialize(ImageDimension, m_NumberOfComponentsPerPixel, m_GlobalShift);
-  jointImageFunctor->GetOutput()->SetRequestedRegion(this->GetInput()->GetBufferedRegion());
-  jointImageFunctor->Update();
-  m_JointImage = jointImageFunctor->GetOutput();
+  itk::ImageRegionConstIteratorWithIndex<InputImageType> inputIt(inputPtr, m_JointRegion);
+  for (std::size_t offset = 0; !inputIt.IsAtEnd(); ++inputIt, ++offset)
+    {
+    const InputIndexType index = inputIt.GetIndex();
+    const InputPixelType & inputPixel = inputIt.Get();
+    for (unsigned int comp = 0; comp < ImageDimension; comp++)
+      {
+      m_JointComponents[comp * nbJointPixels + offset] = index[comp] + m_GlobalShift[comp];
+      }
+    for (unsigned int comp = 0; comp < m_NumberOfComponentsPerPixel; comp++)
+      {
+      m_JointComponents[(ImageDimension + comp) * nbJointPixels + offset] = inputPixel[comp];
+      }
+    }
 
 #if 0
   if (m_BucketOptimization)
@@ -268,40 +277,6 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
                                     ImageDimension);
     }
 #endif
-  /*
-   // Allocate the joint domain image
-   m_JointImage = RealVectorImageType::New();
-   m_JointImage->SetNumberOfComponentsPerPixel(ImageDimension + m_NumberOfComponentsPerPixel);
-   m_JointImage->SetRegions(inputPtr->GetRequestedRegion());
-   m_JointImage->Allocate();
-
-   InputIteratorWithIndexType inputIt(inputPtr, inputPtr->GetRequestedRegion());
-   JointImageIteratorType jointIt(m_JointImage, inputPtr->GetRequestedRegion());
-
-   // Initialize the joint image with scaled values
-   inputIt.GoToBegin();
-   jointIt.GoToBegin();
-
-   while (!inputIt.IsAtEnd())
-   {
-   typename InputImageType::PixelType const& inputPixel = inputIt.Get();
-   index = inputIt.GetIndex();
-
-   RealVector & jointPixel = jointIt.Get();
-   for(unsigned int comp = 0; comp < ImageDimension; comp++)
-   {
-   jointPixel[comp] = index[comp] / m_SpatialBandwidth;
-   }
-   for(unsigned int comp = 0; comp < m_NumberOfComponentsPerPixel; comp++)
-   {
-   jointPixel[ImageDimension + comp] = inputPixel[comp] / m_RangeBandwidth;
-   }
-   // jointIt.Set(jointPixel);
-
-   ++inputIt;
-   ++jointIt;
-   }
-   */
 
   //TODO don't create mode table iterator when ModeSearch is set to false
   m_ModeTable = ModeTableImageType::New();
@@ -344,7 +319,6 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
 // Calculates the mean shift vector at the position given by jointPixel
 template<class TInputImage, class TOutputImage, class TKernel, class TOutputIterationImage>
 void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIterationImage>::CalculateMeanShiftVector(
-                                                                                                                        const typename RealVectorImageType::Pointer jointImage,
                                                                                                                         const RealVector& jointPixel,
                                                                                                                         const OutputRegionType& outputRegion,
                                                                                                                         const RealVector & bandwidth,
@@ -372,78 +346,91 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
                                         static_cast<long int> (inputIndex[comp] + m_SpatialRadius[comp] + 1));
 
     regionSize[comp] = std::max(0l, indexRight - static_cast<long int> (regionIndex[comp]) + 1);
+    if (regionSize[comp] == 0)
+      {
+      return;
+      }
     }
 
-  RegionType neighborhoodRegion;
-  neighborhoodRegion.SetIndex(regionIndex);
-  neighborhoodRegion.SetSize(regionSize);
-
+  const std::size_t nbJointPixels = m_JointRegion.GetNumberOfPixels();
   RealType weightSum = 0;
-  RealVector shifts(jointDimension);
-
-  // An iterator on the neighborhood of the current pixel (in joint
-  // spatial-range domain)
-  otb::Meanshift::FastImageRegionConstIterator<RealVectorImageType> it(jointImage, neighborhoodRegion);
-  //itk::ImageRegionConstIterator<RealVectorImageType> it(jointImage, neighborhoodRegion);
 
-  it.GoToBegin();
-  while (!it.IsAtEnd())
+  // The neighborhood is processed by runs of consecutive pixels along the
+  // first dimension, in raster order. For each run, the squared norms are
+  // computed component by component with loops over contiguous data, then
+  // the pixels with a non-null weight are accumulated. The sums are done in
+  // the same order as a pixel by pixel evaluation.
+  const unsigned int ChunkSize = 64;
+  RealType weights[ChunkSize];
+  unsigned int selected[ChunkSize];
+
+  InputIndexType rowIndex = regionIndex;
+  while (true)
     {
-    const RealType *jointNeighbor = it.GetPixelPointer();
+    const std::size_t rowOffset = this->GetJointOffset(rowIndex);
 
-    // Compute the squared norm of the difference
-    // This is the L2 norm, TODO: replace by the templated norm
-    RealType norm2 = 0;
-    for (unsigned int comp = 0; comp < jointDimension; comp++)
+    for (unsigned int chunkStart = 0; chunkStart < regionSize[0]; chunkStart += ChunkSize)
       {
-      shifts[comp] = jointNeighbor[comp] - jointPixel[comp];
-      double d = shifts[comp] / bandwidth[comp];
-      norm2 += d*d;
+      const unsigned int chunkLength = std::min(ChunkSize, static_cast<unsigned int>(regionSize[0] - chunkStart));
+      const std::size_t chunkOffset = rowOffset + chunkStart;
+
+      // Squared norm of the difference
+      for (unsigned int i = 0; i < chunkLength; ++i)
+        {
+        weights[i] = 0;
+        }
+      for (unsigned int comp = 0; comp < jointDimension; comp++)
+        {
+        const RealType * neighbors = &m_JointComponents[comp * nbJointPixels + chunkOffset];
+        const RealType center = jointPixel[comp];
+        const RealType scale = bandwidth[comp];
+        for (unsigned int i = 0; i < chunkLength; ++i)
+          {
+          const RealType d = (neighbors[i] - center) / scale;
+          weights[i] += d * d;
+          }
+        }
+
+      // Pixel weights from kernel
+      unsigned int nbSelected = 0;
+      for (unsigned int i = 0; i < chunkLength; ++i)
+        {
+        weights[i] = m_Kernel(weights[i]);
+        if (weights[i] != 0)
+          {
+          weightSum += weights[i];
+          selected[nbSelected++] = i;
+          }
+        }
+
+      // Update mean shift vector
+      for (unsigned int comp = 0; comp < jointDimension; comp++)
+        {
+        const RealType * neighbors = &m_JointComponents[comp * nbJointPixels + chunkOffset];
+        const RealType center = jointPixel[comp];
+        RealType sum = meanShiftVector[comp];
+        for (unsigned int k = 0; k < nbSelected; ++k)
+          {
+          sum += weights[selected[k]] * (neighbors[selected[k]] - center);
+          }
+        meanShiftVector[comp] = sum;
+        }
       }
 
-    // Compute pixel weight from kernel
-    const RealType weight = m_Kernel(norm2);
-    /*
-     // The following code is an alternative way to compute norm2 and weight
-     // It separates the norms of spatial and range elements
-     RealType spatialNorm2;
-     RealType rangeNorm2;
-     spatialNorm2 = 0;
-     for (unsigned int comp = 0; comp < ImageDimension; comp++)
-     {
-     RealType d;
-     d = jointNeighbor[comp] - jointPixel[comp];
-     spatialNorm2 += d*d;
-     }
-
-     if(spatialNorm2 >= 1.0)
-     {
-     weight = 0;
-     }
-     else
-     {
-     rangeNorm2 = 0;
-     for (unsigned int comp = 0; comp < m_NumberOfComponentsPerPixel; comp++)
-     {
-     RealType d;
-     d = jointNeighbor[ImageDimension + comp] - jointPixel[ImageDimension + comp];
-     rangeNorm2 += d*d;
-     }
-
-     weight = (rangeNorm2 <= 1.0)? 1.0 : 0.0;
-     }
-     */
-
-    // Update sum of weights
-    weightSum += weight;
-
-    // Update mean shift vector
-    for (unsigned int comp = 0; comp < jointDimension; comp++)
+    // Next run
+    unsigned int dim = 1;
+    for (; dim < ImageDimension; ++dim)
+      {
+      if (++rowIndex[dim] < regionIndex[dim] + static_cast<InputIndexValueType>(regionSize[dim]))
+        {
+        break;
+        }
+      rowIndex[dim] = regionIndex[dim];
+      }
+    if (dim == ImageDimension)
       {
-      meanShiftVector[comp] += weight * shifts[comp];
+      break;
       }
-
-    ++it;
     }
 
   if (weightSum > 0)
@@ -568,18 +555,16 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
 
   RegionType const& requestedRegion = input->GetRequestedRegion();
 
-  typedef itk::ImageRegionConstIteratorWithIndex<RealVectorImageType> JointImageIteratorType;
-  JointImageIteratorType jointIt(m_JointImage, outputRegionForThread);
+  const std::size_t nbJointPixels = m_JointRegion.GetNumberOfPixels();
 
   OutputIteratorType rangeIt(rangeOutput, outputRegionForThread);
   OutputSpatialIteratorType spatialIt(spatialOutput, outputRegionForThread);
   OutputIterationIteratorType iterationIt(iterationOutput, outputRegionForThread);
   OutputLabelIteratorType labelIt(labelOutput, outputRegionForThread);
 
-  typedef itk::ImageRegionIterator<ModeTableImageType> ModeTableImageIteratorType;
+  typedef itk::ImageRegionIteratorWithIndex<ModeTableImageType> ModeTableImageIteratorType;
   ModeTableImageIteratorType modeTableIt(m_ModeTable, outputRegionForThread);
 
-  jointIt.GoToBegin();
   rangeIt.GoToBegin();
   spatialIt.GoToBegin();
   iterationIt.GoToBegin();
@@ -601,7 +586,7 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
   // index of the current pixel updated during the mean shift loop
   InputIndexType modeCandidate;
 
-  for (; !jointIt.IsAtEnd(); ++jointIt, ++rangeIt, ++spatialIt, ++iterationIt, ++modeTableIt, ++labelIt, progress.CompletedPixel())
+  for (; !modeTableIt.IsAtEnd(); ++rangeIt, ++spatialIt, ++iterationIt, ++modeTableIt, ++labelIt, progress.CompletedPixel())
     {
 
     // if pixel has been already processed (by mode search optimization), skip
@@ -614,18 +599,17 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
 
     bool hasConverged = false;
 
-    // get input pixel in the joint spatial-range domain (with components
-    // normalized by bandwidth)
-    const RealVector &jointPixelVal = jointIt.Get(); // Pixel in the joint spatial-range domain
+    // index of the currently processed output pixel
+    InputIndexType currentIndex = modeTableIt.GetIndex();
+
+    // get input pixel in the joint spatial-range domain
+    const std::size_t currentOffset = this->GetJointOffset(currentIndex);
     for (unsigned int comp = 0; comp < jointDimension; comp++)
-      jointPixel[comp] = jointPixelVal[comp];
+      jointPixel[comp] = m_JointComponents[comp * nbJointPixels + currentOffset];
 
     for (unsigned int comp = ImageDimension; comp < jointDimension; comp++)
       bandwidth[comp] = m_RangeBandwidthRamp*jointPixel[comp]+m_RangeBandwidth;
 
-    // index of the currently processed output pixel
-    InputIndexType currentIndex = jointIt.GetIndex();
-
     // Number of points currently in the pointList
     unsigned int pointCount = 0; // Note: used only in mode search optimization
     iteration = 0;
@@ -650,10 +634,10 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
           {
           // Obtain the data point to see if it close to jointPixel
           RealType diff = 0;
-          RealVector const& candidatePixel = m_JointImage->GetPixel(modeCandidate);
+          const std::size_t candidateOffset = this->GetJointOffset(modeCandidate);
           for (unsigned int comp = ImageDimension; comp < jointDimension; comp++)
             {
-            const RealType d = (candidatePixel[comp] - jointPixel[comp])/bandwidth[comp];
+            const RealType d = (m_JointComponents[comp * nbJointPixels + candidateOffset] - jointPixel[comp])/bandwidth[comp];
             diff += d * d;
             }
 
@@ -697,7 +681,7 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
       else
         {
 #endif
-        this->CalculateMeanShiftVector(m_JointImage, jointPixel, requestedRegion, bandwidth, meanShiftVector);
+        this->CalculateMeanShiftVector(jointPixel, requestedRegion, bandwidth, meanShiftVector);
 
 #if 0
         }
@@ -774,6 +758,9 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
 template<class TInputImage, class TOutputImage, class TKernel, class TOutputIterationImage>
 void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIterationImage>::AfterThreadedGenerateData()
 {
+  // Release the joint domain data
+  std::vector<RealType>().swap(m_JointComponents);
+
   typename OutputLabelImageType::Pointer labelOutput = this->GetLabelOutput();
   typedef itk::ImageRegionIterator<OutputLabelImageType> OutputLabelIteratorType;
   OutputLabelIteratorType labelIt(labelOutput, labelOutput->GetRequestedRegion());
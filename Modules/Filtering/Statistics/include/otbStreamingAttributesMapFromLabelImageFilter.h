@@ -0,0 +1,379 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingAttributesMapFromLabelImageFilter_h
+#define otbStreamingAttributesMapFromLabelImageFilter_h
+
+#include "otbPersistentImageFilter.h"
+#include "otbPersistentFilterStreamingDecorator.h"
+#include "itkVariableLengthVector.h"
+#include "itkVector.h"
+#include "otbMacro.h"
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace otb
+{
+
+/** \class PersistentStreamingAttributesMapFromLabelImageFilter
+ * \brief Computes shape and radiometric attributes for each label of a
+ * label image, region by region
+ *
+ * For each label, the filter computes:
+ * - the number of pixels and the physical size,
+ * - the bounding box, in index coordinates,
+ * - the centroid, in physical coordinates,
+ * - the principal moments (eigenvalues of the covariance matrix of the
+ *   pixel centers, in physical units, ascending) and the elongation
+ *   (square root of the ratio of the two largest principal moments),
+ * - the perimeter, as the physical length of the pixel edges shared with
+ *   another label or with the image border,
+ * - when a vector image is set with SetInputVectorImage(), the mean,
+ *   standard deviation, min and max of each band, skipping the no data
+ *   values when UseNoDataValue is on.
+ *
+ * Unlike ShapeAttributesLabelMapFilter and
+ * StatisticsAttributesLabelMapFilter, the label image is never converted
+ * into a label map. Each thread accumulates its part of the requested
+ * region in a hash table of fixed size accumulators, with the radiometry
+ * stored in one flat array. The thread tables are merged into the
+ * persistent table after each region, so that the objects split by the
+ * streaming are merged too. The moments are accumulated relative to the
+ * first pixel of each label, which keeps them accurate on large images.
+ *
+ * The label image is requested with a one pixel margin, so that the
+ * perimeter does not depend on the streaming.
+ *
+ * When UseBackgroundValue is on, the pixels of value BackgroundValue are
+ * skipped.
+ *
+ * \sa StreamingAttributesMapFromLabelImageFilter
+ * \sa PersistentStreamingStatisticsMapFromLabelImageFilter
+ *
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ *
+ * \ingroup OTBStatistics
+ */
+template<class TLabelImage, class TInputVectorImage>
+class ITK_EXPORT PersistentStreamingAttributesMapFromLabelImageFilter :
+public PersistentImageFilter<TLabelImage, TLabelImage>
+{
+public:
+  /** Standard Self typedef */
+  typedef PersistentStreamingAttributesMapFromLabelImageFilter Self;
+  typedef PersistentImageFilter<TLabelImage, TLabelImage>      Superclass;
+  typedef itk::SmartPointer<Self>                              Pointer;
+  typedef itk::SmartPointer<const Self>                        ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(PersistentStreamingAttributesMapFromLabelImageFilter, PersistentImageFilter);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TLabelImage::ImageDimension);
+
+  /** Image related typedefs. */
+  typedef TLabelImage                                 LabelImageType;
+  typedef TInputVectorImage                           VectorImageType;
+  typedef typename LabelImageType::PixelType          LabelPixelType;
+  typedef typename LabelImageType::RegionType         RegionType;
+  typedef typename LabelImageType::IndexType          IndexType;
+  typedef typename LabelImageType::PointType          PointType;
+  typedef typename VectorImageType::PixelType::ValueType VectorPixelValueType;
+  typedef itk::VariableLengthVector<double>           RealVectorPixelType;
+  typedef itk::Vector<double, ImageDimension>         MomentsType;
+
+  /** Output maps */
+  typedef std::map<LabelPixelType, double>              LabelPopulationMapType;
+  typedef std::map<LabelPixelType, double>              RealValueMapType;
+  typedef std::map<LabelPixelType, RegionType>          BoundingBoxMapType;
+  typedef std::map<LabelPixelType, PointType>           PointMapType;
+  typedef std::map<LabelPixelType, MomentsType>         MomentsMapType;
+  typedef std::map<LabelPixelType, RealVectorPixelType> PixelValueMapType;
+
+  /** Set input label image, same as SetInput() */
+  void SetInputLabelImage(const LabelImageType * image);
+  const LabelImageType * GetInputLabelImage() const;
+
+  /** Set input vector image for the radiometric statistics (optional) */
+  void SetInputVectorImage(const VectorImageType * image);
+  const VectorImageType * GetInputVectorImage() const;
+
+  itkGetMacro(NoDataValue, VectorPixelValueType);
+  itkSetMacro(NoDataValue, VectorPixelValueType);
+  itkGetMacro(UseNoDataValue, bool);
+  itkSetMacro(UseNoDataValue, bool);
+
+  itkGetMacro(BackgroundValue, LabelPixelType);
+  itkSetMacro(BackgroundValue, LabelPixelType);
+  itkGetMacro(UseBackgroundValue, bool);
+  itkSetMacro(UseBackgroundValue, bool);
+
+  /** Shape attributes */
+  LabelPopulationMapType GetLabelPopulationMap() const;
+  RealValueMapType GetPhysicalSizeMap() const;
+  BoundingBoxMapType GetBoundingBoxMap() const;
+  PointMapType GetCentroidMap() const;
+  MomentsMapType GetPrincipalMomentsMap() const;
+  RealValueMapType GetElongationMap() const;
+  RealValueMapType GetPerimeterMap() const;
+
+  /** Radiometric attributes, empty without input vector image */
+  PixelValueMapType GetMeanValueMap() const;
+  PixelValueMapType GetStandardDeviationValueMap() const;
+  PixelValueMapType GetMinValueMap() const;
+  PixelValueMapType GetMaxValueMap() const;
+
+  /** The output image is not used. */
+  void AllocateOutputs() override;
+
+  void GenerateOutputInformation() override;
+
+  void GenerateInputRequestedRegion() override;
+
+  void Synthetize(void) override;
+
+  void Reset(void) override;
+
+protected:
+  PersistentStreamingAttributesMapFromLabelImageFilter();
+  ~PersistentStreamingAttributesMapFromLabelImageFilter() override {}
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+  void BeforeThreadedGenerateData() override;
+
+  void ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId ) override;
+
+  void AfterThreadedGenerateData() override;
+
+private:
+  PersistentStreamingAttributesMapFromLabelImageFilter(const Self &) = delete;
+  void operator =(const Self&) = delete;
+
+  /** Shape accumulator of a label. The moments are summed over the
+   * offsets of the pixels from Reference. */
+  struct ShapeAccumulator
+  {
+    uint64_t  Count;
+    IndexType Reference;
+    IndexType Min;
+    IndexType Max;
+    double    Sum[ImageDimension];
+    double    SqSum[ImageDimension][ImageDimension];
+    double    PerimeterEdges[ImageDimension];
+  };
+
+  /** Accumulators of the labels. For each label and each band, the
+   * radiometry holds the count, sum, squared sum, min and max. */
+  class AccumulatorTable
+  {
+  public:
+    std::unordered_map<LabelPixelType, std::size_t> Indices;
+    std::vector<ShapeAccumulator>                   Shapes;
+    std::vector<double>                             Radiometry;
+    unsigned int                                    NumberOfBands = 0;
+
+    /** Accumulator index of a label, created from its first pixel */
+    std::size_t Find(LabelPixelType label, const IndexType & index);
+
+    /** Merge the accumulators of another table */
+    void Merge(const AccumulatorTable & other);
+
+    void Clear();
+  };
+
+  VectorPixelValueType m_NoDataValue;
+  bool                 m_UseNoDataValue;
+  LabelPixelType       m_BackgroundValue;
+  bool                 m_UseBackgroundValue;
+
+  AccumulatorTable              m_Accumulators;
+  std::vector<AccumulatorTable> m_ThreadAccumulators;
+
+  LabelPopulationMapType m_LabelPopulation;
+  RealValueMapType       m_PhysicalSize;
+  BoundingBoxMapType     m_BoundingBox;
+  PointMapType           m_Centroid;
+  MomentsMapType         m_PrincipalMoments;
+  RealValueMapType       m_Elongation;
+  RealValueMapType       m_Perimeter;
+  PixelValueMapType      m_MeanRadiometricValue;
+  PixelValueMapType      m_StDevRadiometricValue;
+  PixelValueMapType      m_MinRadiometricValue;
+  PixelValueMapType      m_MaxRadiometricValue;
+
+}; // end of class PersistentStreamingAttributesMapFromLabelImageFilter
+
+
+/*===========================================================================*/
+
+/** \class StreamingAttributesMapFromLabelImageFilter
+ * \brief Computes shape and radiometric attributes for each label of a
+ * label image, streaming the whole image
+ *
+ * This class streams the label image (and the optional vector image)
+ * through the PersistentStreamingAttributesMapFromLabelImageFilter, so
+ * that the attributes of huge label images can be computed with a
+ * bounded memory, proportional to the number of labels.
+ *
+ * \code
+ * typedef otb::StreamingAttributesMapFromLabelImageFilter<LabelImageType, VectorImageType> AttributesType;
+ * AttributesType::Pointer attributes = AttributesType::New();
+ * attributes->SetInputLabelImage(labelReader->GetOutput());
+ * attributes->SetInputVectorImage(reader->GetOutput());
+ * attributes->Update();
+ * AttributesType::RealValueMapType perimeters = attributes->GetPerimeterMap();
+ * \endcode
+ *
+ * \sa PersistentStreamingAttributesMapFromLabelImageFilter
+ * \sa PersistentFilterStreamingDecorator
+ *
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ *
+ * \ingroup OTBStatistics
+ */
+template<class TLabelImage, class TInputVectorImage>
+class ITK_EXPORT StreamingAttributesMapFromLabelImageFilter :
+public PersistentFilterStreamingDecorator<PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage> >
+{
+public:
+  /** Standard Self typedef */
+  typedef StreamingAttributesMapFromLabelImageFilter Self;
+  typedef PersistentFilterStreamingDecorator
+      <PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage> > Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Type macro */
+  itkNewMacro(Self);
+
+  /** Creation through object factory macro */
+  itkTypeMacro(StreamingAttributesMapFromLabelImageFilter, PersistentFilterStreamingDecorator);
+
+  typedef TLabelImage       LabelImageType;
+  typedef TInputVectorImage VectorImageType;
+
+  typedef typename Superclass::FilterType::LabelPixelType         LabelPixelType;
+  typedef typename Superclass::FilterType::VectorPixelValueType   VectorPixelValueType;
+  typedef typename Superclass::FilterType::LabelPopulationMapType LabelPopulationMapType;
+  typedef typename Superclass::FilterType::RealValueMapType       RealValueMapType;
+  typedef typename Superclass::FilterType::BoundingBoxMapType     BoundingBoxMapType;
+  typedef typename Superclass::FilterType::PointMapType           PointMapType;
+  typedef typename Superclass::FilterType::MomentsMapType         MomentsMapType;
+  typedef typename Superclass::FilterType::PixelValueMapType      PixelValueMapType;
+
+  /** Set input label image */
+  using Superclass::SetInput;
+  void SetInputLabelImage(const LabelImageType * input)
+  {
+    this->GetFilter()->SetInputLabelImage(input);
+  }
+  const LabelImageType * GetInputLabelImage()
+  {
+    return this->GetFilter()->GetInputLabelImage();
+  }
+
+  /** Set input vector image (optional) */
+  void SetInputVectorImage(const VectorImageType * input)
+  {
+    this->GetFilter()->SetInputVectorImage(input);
+  }
+  const VectorImageType * GetInputVectorImage()
+  {
+    return this->GetFilter()->GetInputVectorImage();
+  }
+
+  otbSetObjectMemberMacro(Filter, NoDataValue, VectorPixelValueType);
+  otbGetObjectMemberMacro(Filter, NoDataValue, VectorPixelValueType);
+  otbSetObjectMemberMacro(Filter, UseNoDataValue, bool);
+  otbGetObjectMemberMacro(Filter, UseNoDataValue, bool);
+  otbSetObjectMemberMacro(Filter, BackgroundValue, LabelPixelType);
+  otbGetObjectMemberMacro(Filter, BackgroundValue, LabelPixelType);
+  otbSetObjectMemberMacro(Filter, UseBackgroundValue, bool);
+  otbGetObjectMemberMacro(Filter, UseBackgroundValue, bool);
+
+  LabelPopulationMapType GetLabelPopulationMap() const
+  {
+    return this->GetFilter()->GetLabelPopulationMap();
+  }
+  RealValueMapType GetPhysicalSizeMap() const
+  {
+    return this->GetFilter()->GetPhysicalSizeMap();
+  }
+  BoundingBoxMapType GetBoundingBoxMap() const
+  {
+    return this->GetFilter()->GetBoundingBoxMap();
+  }
+  PointMapType GetCentroidMap() const
+  {
+    return this->GetFilter()->GetCentroidMap();
+  }
+  MomentsMapType GetPrincipalMomentsMap() const
+  {
+    return this->GetFilter()->GetPrincipalMomentsMap();
+  }
+  RealValueMapType GetElongationMap() const
+  {
+    return this->GetFilter()->GetElongationMap();
+  }
+  RealValueMapType GetPerimeterMap() const
+  {
+    return this->GetFilter()->GetPerimeterMap();
+  }
+  PixelValueMapType GetMeanValueMap() const
+  {
+    return this->GetFilter()->GetMeanValueMap();
+  }
+  PixelValueMapType GetStandardDeviationValueMap() const
+  {
+    return this->GetFilter()->GetStandardDeviationValueMap();
+  }
+  PixelValueMapType GetMinValueMap() const
+  {
+    return this->GetFilter()->GetMinValueMap();
+  }
+  PixelValueMapType GetMaxValueMap() const
+  {
+    return this->GetFilter()->GetMaxValueMap();
+  }
+
+protected:
+  /** Constructor */
+  StreamingAttributesMapFromLabelImageFilter() {}
+  /** Destructor */
+  ~StreamingAttributesMapFromLabelImageFilter() override {}
+
+private:
+  StreamingAttributesMapFromLabelImageFilter(const Self &) = delete;
+  void operator =(const Self&) = delete;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbStreamingAttributesMapFromLabelImageFilter.hxx"
+#endif
+
+#endif
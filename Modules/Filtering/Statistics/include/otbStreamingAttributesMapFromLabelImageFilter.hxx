@@ -0,0 +1,589 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingAttributesMapFromLabelImageFilter_hxx
+#define otbStreamingAttributesMapFromLabelImageFilter_hxx
+#include "otbStreamingAttributesMapFromLabelImageFilter.h"
+
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkProgressReporter.h"
+#include "vnl/algo/vnl_symmetric_eigensystem.h"
+
+#include <cmath>
+#include <limits>
+
+namespace otb
+{
+
+template<class TLabelImage, class TInputVectorImage>
+std::size_t
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::AccumulatorTable::Find(LabelPixelType label, const IndexType & index)
+{
+  const auto found = Indices.find(label);
+  if (found != Indices.end())
+    {
+    return found->second;
+    }
+
+  const std::size_t k = Shapes.size();
+  Indices.emplace(label, k);
+
+  ShapeAccumulator shape;
+  shape.Count = 0;
+  shape.Reference = index;
+  shape.Min = index;
+  shape.Max = index;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+    {
+    shape.Sum[i] = 0.;
+    shape.PerimeterEdges[i] = 0.;
+    for (unsigned int j = 0; j < ImageDimension; ++j)
+      {
+      shape.SqSum[i][j] = 0.;
+      }
+    }
+  Shapes.push_back(shape);
+
+  for (unsigned int band = 0; band < NumberOfBands; ++band)
+    {
+    Radiometry.push_back(0.);
+    Radiometry.push_back(0.);
+    Radiometry.push_back(0.);
+    Radiometry.push_back(std::numeric_limits<double>::max());
+    Radiometry.push_back(std::numeric_limits<double>::lowest());
+    }
+  return k;
+}
+
+template<class TLabelImage, class TInputVectorImage>
+void
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::AccumulatorTable::Merge(const AccumulatorTable & other)
+{
+  for (const auto & entry : other.Indices)
+    {
+    const ShapeAccumulator & from = other.Shapes[entry.second];
+    const std::size_t k = Find(entry.first, from.Reference);
+    ShapeAccumulator & to = Shapes[k];
+
+    // Move the moments of the other accumulator to our reference
+    double shift[ImageDimension];
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+      {
+      shift[i] = static_cast<double>(from.Reference[i] - to.Reference[i]);
+      }
+    const double count = static_cast<double>(from.Count);
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+      {
+      for (unsigned int j = 0; j < ImageDimension; ++j)
+        {
+        to.SqSum[i][j] += from.SqSum[i][j] + shift[i] * from.Sum[j] + shift[j] * from.Sum[i]
+          + count * shift[i] * shift[j];
+        }
+      }
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+      {
+      to.Sum[i] += from.Sum[i] + count * shift[i];
+      to.Min[i] = std::min(to.Min[i], from.Min[i]);
+      to.Max[i] = std::max(to.Max[i], from.Max[i]);
+      to.PerimeterEdges[i] += from.PerimeterEdges[i];
+      }
+    to.Count += from.Count;
+
+    const double * fromRadiometry = &other.Radiometry[entry.second * 5 * NumberOfBands];
+    double * toRadiometry = &Radiometry[k * 5 * NumberOfBands];
+    for (unsigned int band = 0; band < NumberOfBands; ++band, fromRadiometry += 5, toRadiometry += 5)
+      {
+      toRadiometry[0] += fromRadiometry[0];
+      toRadiometry[1] += fromRadiometry[1];
+      toRadiometry[2] += fromRadiometry[2];
+      toRadiometry[3] = std::min(toRadiometry[3], fromRadiometry[3]);
+      toRadiometry[4] = std::max(toRadiometry[4], fromRadiometry[4]);
+      }
+    }
+}
+
+template<class TLabelImage, class TInputVectorImage>
+void
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::AccumulatorTable::Clear()
+{
+  Indices.clear();
+  Shapes.clear();
+  Radiometry.clear();
+}
+
+template<class TLabelImage, class TInputVectorImage>
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::PersistentStreamingAttributesMapFromLabelImageFilter()
+  : m_NoDataValue(),
+    m_UseNoDataValue(false),
+    m_BackgroundValue(),
+    m_UseBackgroundValue(false)
+{
+  this->Reset();
+}
+
+template<class TLabelImage, class TInputVectorImage>
+void
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::SetInputLabelImage(const LabelImageType * image)
+{
+  this->SetInput(image);
+}
+
+template<class TLabelImage, class TInputVectorImage>
+const typename PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>::LabelImageType *
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::GetInputLabelImage() const
+{
+  return this->GetInput();
+}
+
+template<class TLabelImage, class TInputVectorImage>
+void
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::SetInputVectorImage(const VectorImageType * image)
+{
+  // Process object is not const-correct so the const_cast is required here
+  this->itk::ProcessObject::SetNthInput(1, const_cast<VectorImageType *>(image));
+}
+
+template<class TLabelImage, class TInputVectorImage>
+const typename PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>::VectorImageType *
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::GetInputVectorImage() const
+{
+  if (this->GetNumberOfInputs() < 2)
+    {
+    return nullptr;
+    }
+  return static_cast<const VectorImageType *>(this->itk::ProcessObject::GetInput(1));
+}
+
+template<class TLabelImage, class TInputVectorImage>
+typename PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>::LabelPopulationMapType
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::GetLabelPopulationMap() const
+{
+  return m_LabelPopulation;
+}
+
+template<class TLabelImage, class TInputVectorImage>
+typename PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>::RealValueMapType
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::GetPhysicalSizeMap() const
+{
+  return m_PhysicalSize;
+}
+
+template<class TLabelImage, class TInputVectorImage>
+typename PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>::BoundingBoxMapType
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::GetBoundingBoxMap() const
+{
+  return m_BoundingBox;
+}
+
+template<class TLabelImage, class TInputVectorImage>
+typename PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>::PointMapType
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::GetCentroidMap() const
+{
+  return m_Centroid;
+}
+
+template<class TLabelImage, class TInputVectorImage>
+typename PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>::MomentsMapType
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::GetPrincipalMomentsMap() const
+{
+  return m_PrincipalMoments;
+}
+
+template<class TLabelImage, class TInputVectorImage>
+typename PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>::RealValueMapType
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::GetElongationMap() const
+{
+  return m_Elongation;
+}
+
+template<class TLabelImage, class TInputVectorImage>
+typename PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>::RealValueMapType
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::GetPerimeterMap() const
+{
+  return m_Perimeter;
+}
+
+template<class TLabelImage, class TInputVectorImage>
+typename PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>::PixelValueMapType
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::GetMeanValueMap() const
+{
+  return m_MeanRadiometricValue;
+}
+
+template<class TLabelImage, class TInputVectorImage>
+typename PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>::PixelValueMapType
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::GetStandardDeviationValueMap() const
+{
+  return m_StDevRadiometricValue;
+}
+
+template<class TLabelImage, class TInputVectorImage>
+typename PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>::PixelValueMapType
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::GetMinValueMap() const
+{
+  return m_MinRadiometricValue;
+}
+
+template<class TLabelImage, class TInputVectorImage>
+typename PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>::PixelValueMapType
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::GetMaxValueMap() const
+{
+  return m_MaxRadiometricValue;
+}
+
+template<class TLabelImage, class TInputVectorImage>
+void
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  if (this->GetInput())
+    {
+    this->GetOutput()->CopyInformation(this->GetInput());
+    this->GetOutput()->SetLargestPossibleRegion(this->GetInput()->GetLargestPossibleRegion());
+
+    if (this->GetOutput()->GetRequestedRegion().GetNumberOfPixels() == 0)
+      {
+      this->GetOutput()->SetRequestedRegion(this->GetOutput()->GetLargestPossibleRegion());
+      }
+    }
+
+  const VectorImageType * vectorImage = this->GetInputVectorImage();
+  if (vectorImage && vectorImage->GetLargestPossibleRegion() != this->GetInput()->GetLargestPossibleRegion())
+    {
+    itkExceptionMacro(<< "The label and vector images have different regions");
+    }
+}
+
+template<class TLabelImage, class TInputVectorImage>
+void
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::AllocateOutputs()
+{
+  // Nothing to allocate: the output image is not intended to be used
+}
+
+template<class TLabelImage, class TInputVectorImage>
+void
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::GenerateInputRequestedRegion()
+{
+  const RegionType requested = this->GetOutput()->GetRequestedRegion();
+
+  // One pixel margin for the perimeter
+  LabelImageType * labelImage = const_cast<LabelImageType *>(this->GetInput());
+  if (labelImage)
+    {
+    RegionType region = requested;
+    region.PadByRadius(1);
+    region.Crop(labelImage->GetLargestPossibleRegion());
+    labelImage->SetRequestedRegion(region);
+    }
+
+  VectorImageType * vectorImage = const_cast<VectorImageType *>(this->GetInputVectorImage());
+  if (vectorImage)
+    {
+    vectorImage->SetRequestedRegion(requested);
+    }
+}
+
+template<class TLabelImage, class TInputVectorImage>
+void
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::Reset()
+{
+  m_Accumulators.Clear();
+  m_ThreadAccumulators.clear();
+
+  m_LabelPopulation.clear();
+  m_PhysicalSize.clear();
+  m_BoundingBox.clear();
+  m_Centroid.clear();
+  m_PrincipalMoments.clear();
+  m_Elongation.clear();
+  m_Perimeter.clear();
+  m_MeanRadiometricValue.clear();
+  m_StDevRadiometricValue.clear();
+  m_MinRadiometricValue.clear();
+  m_MaxRadiometricValue.clear();
+}
+
+template<class TLabelImage, class TInputVectorImage>
+void
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::BeforeThreadedGenerateData()
+{
+  const VectorImageType * vectorImage = this->GetInputVectorImage();
+  const unsigned int nbBands = vectorImage ? vectorImage->GetNumberOfComponentsPerPixel() : 0;
+  if (m_Accumulators.Shapes.empty())
+    {
+    m_Accumulators.NumberOfBands = nbBands;
+    }
+  else if (m_Accumulators.NumberOfBands != nbBands)
+    {
+    itkExceptionMacro(<< "The number of bands changed since the last Reset()");
+    }
+
+  AccumulatorTable table;
+  table.NumberOfBands = nbBands;
+  m_ThreadAccumulators.assign(this->GetNumberOfThreads(), table);
+}
+
+template<class TLabelImage, class TInputVectorImage>
+void
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId )
+{
+  const LabelImageType * labelImage = this->GetInput();
+  const VectorImageType * vectorImage = this->GetInputVectorImage();
+  const RegionType largest = labelImage->GetLargestPossibleRegion();
+  const typename LabelImageType::OffsetValueType * offsetTable = labelImage->GetOffsetTable();
+
+  AccumulatorTable & table = m_ThreadAccumulators[threadId];
+  const unsigned int nbBands = table.NumberOfBands;
+
+  itk::ImageRegionConstIteratorWithIndex<LabelImageType> labelIt(labelImage, outputRegionForThread);
+  itk::ImageRegionConstIterator<VectorImageType> vectorIt;
+  if (vectorImage)
+    {
+    vectorIt = itk::ImageRegionConstIterator<VectorImageType>(vectorImage, outputRegionForThread);
+    }
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  // Consecutive pixels often share the same label: skip the hash lookup
+  std::size_t k = 0;
+  LabelPixelType lastLabel = LabelPixelType();
+  bool hasLastLabel = false;
+
+  for (labelIt.GoToBegin(); !labelIt.IsAtEnd(); ++labelIt, progress.CompletedPixel())
+    {
+    const LabelPixelType label = labelIt.Get();
+    const bool skip = m_UseBackgroundValue && label == m_BackgroundValue;
+    if (skip)
+      {
+      if (vectorImage)
+        {
+        ++vectorIt;
+        }
+      continue;
+      }
+
+    const IndexType index = labelIt.GetIndex();
+    if (!hasLastLabel || label != lastLabel)
+      {
+      k = table.Find(label, index);
+      lastLabel = label;
+      hasLastLabel = true;
+      }
+    ShapeAccumulator & shape = table.Shapes[k];
+
+    ++shape.Count;
+    double offset[ImageDimension];
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+      {
+      shape.Min[i] = std::min(shape.Min[i], index[i]);
+      shape.Max[i] = std::max(shape.Max[i], index[i]);
+      offset[i] = static_cast<double>(index[i] - shape.Reference[i]);
+      shape.Sum[i] += offset[i];
+      }
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+      {
+      for (unsigned int j = 0; j < ImageDimension; ++j)
+        {
+        shape.SqSum[i][j] += offset[i] * offset[j];
+        }
+      }
+
+    // Edges shared with another label or with the image border. The
+    // neighbors inside the image are buffered thanks to the margin.
+    const LabelPixelType * pixel = &labelIt.Value();
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+      {
+      if (index[i] == largest.GetIndex()[i] || pixel[-offsetTable[i]] != label)
+        {
+        shape.PerimeterEdges[i] += 1.;
+        }
+      if (index[i] == largest.GetIndex()[i] + static_cast<typename IndexType::IndexValueType>(largest.GetSize()[i]) - 1
+          || pixel[offsetTable[i]] != label)
+        {
+        shape.PerimeterEdges[i] += 1.;
+        }
+      }
+
+    if (vectorImage)
+      {
+      const typename VectorImageType::PixelType & value = vectorIt.Get();
+      double * radiometry = &table.Radiometry[k * 5 * nbBands];
+      for (unsigned int band = 0; band < nbBands; ++band, radiometry += 5)
+        {
+        if (m_UseNoDataValue && value[band] == m_NoDataValue)
+          {
+          continue;
+          }
+        const double v = static_cast<double>(value[band]);
+        radiometry[0] += 1.;
+        radiometry[1] += v;
+        radiometry[2] += v * v;
+        radiometry[3] = std::min(radiometry[3], v);
+        radiometry[4] = std::max(radiometry[4], v);
+        }
+      ++vectorIt;
+      }
+    }
+}
+
+template<class TLabelImage, class TInputVectorImage>
+void
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::AfterThreadedGenerateData()
+{
+  // Merge the partial objects of the threads, so that the memory only
+  // depends on the number of labels
+  for (const auto & table : m_ThreadAccumulators)
+    {
+    m_Accumulators.Merge(table);
+    }
+  m_ThreadAccumulators.clear();
+}
+
+template<class TLabelImage, class TInputVectorImage>
+void
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::Synthetize()
+{
+  const typename LabelImageType::SpacingType spacing = this->GetInput()->GetSpacing();
+  double pixelSize = 1.;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+    {
+    pixelSize *= spacing[i];
+    }
+
+  const unsigned int nbBands = m_Accumulators.NumberOfBands;
+  for (const auto & entry : m_Accumulators.Indices)
+    {
+    const LabelPixelType label = entry.first;
+    const ShapeAccumulator & shape = m_Accumulators.Shapes[entry.second];
+    const double count = static_cast<double>(shape.Count);
+
+    m_LabelPopulation[label] = count;
+    m_PhysicalSize[label] = count * pixelSize;
+
+    RegionType boundingBox;
+    boundingBox.SetIndex(shape.Min);
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+      {
+      boundingBox.SetSize(i, shape.Max[i] - shape.Min[i] + 1);
+      }
+    m_BoundingBox[label] = boundingBox;
+
+    // Centroid and covariance of the pixel centers
+    itk::ContinuousIndex<double, ImageDimension> centroidIndex;
+    double mean[ImageDimension];
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+      {
+      mean[i] = shape.Sum[i] / count;
+      centroidIndex[i] = shape.Reference[i] + mean[i];
+      }
+    PointType centroid;
+    this->GetInput()->TransformContinuousIndexToPhysicalPoint(centroidIndex, centroid);
+    m_Centroid[label] = centroid;
+
+    vnl_matrix<double> covariance(ImageDimension, ImageDimension);
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+      {
+      for (unsigned int j = 0; j < ImageDimension; ++j)
+        {
+        covariance(i, j) = (shape.SqSum[i][j] / count - mean[i] * mean[j]) * spacing[i] * spacing[j];
+        }
+      }
+    const vnl_symmetric_eigensystem<double> eigenSystem(covariance);
+    MomentsType principalMoments;
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+      {
+      principalMoments[i] = std::max(0., eigenSystem.get_eigenvalue(i));
+      }
+    m_PrincipalMoments[label] = principalMoments;
+    m_Elongation[label] = ImageDimension > 1 && principalMoments[ImageDimension - 2] > 0
+      ? std::sqrt(principalMoments[ImageDimension - 1] / principalMoments[ImageDimension - 2]) : 0.;
+
+    // Edges orthogonal to axis i have the size of the pixel without axis i
+    double perimeter = 0.;
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+      {
+      perimeter += shape.PerimeterEdges[i] * pixelSize / spacing[i];
+      }
+    m_Perimeter[label] = perimeter;
+
+    if (nbBands > 0)
+      {
+      RealVectorPixelType meanValue(nbBands), stdValue(nbBands), minValue(nbBands), maxValue(nbBands);
+      const double * radiometry = &m_Accumulators.Radiometry[entry.second * 5 * nbBands];
+      for (unsigned int band = 0; band < nbBands; ++band, radiometry += 5)
+        {
+        const double bandCount = radiometry[0];
+        meanValue[band] = radiometry[1] / bandCount;
+        // Unbiased standard deviation, as in StreamingStatisticsMapFromLabelImageFilter
+        stdValue[band] = std::sqrt((radiometry[2] - radiometry[1] * meanValue[band]) / (bandCount - 1));
+        minValue[band] = radiometry[3];
+        maxValue[band] = radiometry[4];
+        }
+      m_MeanRadiometricValue[label] = meanValue;
+      m_StDevRadiometricValue[label] = stdValue;
+      m_MinRadiometricValue[label] = minValue;
+      m_MaxRadiometricValue[label] = maxValue;
+      }
+    }
+}
+
+template<class TLabelImage, class TInputVectorImage>
+void
+PersistentStreamingAttributesMapFromLabelImageFilter<TLabelImage, TInputVectorImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "UseBackgroundValue: " << m_UseBackgroundValue << std::endl;
+  os << indent << "BackgroundValue: " << static_cast<typename itk::NumericTraits<LabelPixelType>::PrintType>(m_BackgroundValue) << std::endl;
+  os << indent << "UseNoDataValue: " << m_UseNoDataValue << std::endl;
+  os << indent << "Number of labels: " << m_LabelPopulation.size() << std::endl;
+}
+
+} // end namespace otb
+#endif
@@ -39,6 +39,7 @@ void RegisterTests()
   REGISTER_TEST(otbShiftScaleVectorImageFilterTest);
   REGISTER_TEST(otbStreamingCompareImageFilter);
   REGISTER_TEST(otbStreamingStatisticsMapFromLabelImageFilterTest);
+  REGISTER_TEST(otbStreamingAttributesMapFromLabelImageFilterTest);
   REGISTER_TEST(otbRealAndImaginaryImageToComplexImageFilterTest);
   REGISTER_TEST(otbStreamingStatisticsImageFilter);
   REGISTER_TEST(otbListSampleToBalancedListSampleFilter);
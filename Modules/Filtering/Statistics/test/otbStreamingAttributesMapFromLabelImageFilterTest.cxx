@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "itkMacro.h"
+
+#include "otbVectorImage.h"
+#include "otbImage.h"
+#include "itkImageRegionIterator.h"
+
+#include "otbStreamingAttributesMapFromLabelImageFilter.h"
+
+#include <cmath>
+
+namespace
+{
+
+bool CheckValue(const char * name, unsigned int label, double value, double expected)
+{
+  if (std::abs(value - expected) > 1e-6 * std::max(1., std::abs(expected)))
+    {
+    std::cerr << name << " of label " << label << " is " << value << ", expected " << expected << std::endl;
+    return false;
+    }
+  return true;
+}
+
+}
+
+int otbStreamingAttributesMapFromLabelImageFilterTest(int argc, char * argv[])
+{
+  if (argc != 2)
+    {
+    std::cerr << "Usage: " << argv[0] << " nbLinesPerStrip" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const unsigned int nbLines = atoi(argv[1]);
+
+  const unsigned int Dimension = 2;
+  typedef unsigned int                             LabelPixelType;
+  typedef otb::Image<LabelPixelType, Dimension>    LabelImageType;
+  typedef otb::VectorImage<float, Dimension>       VectorImageType;
+  typedef otb::StreamingAttributesMapFromLabelImageFilter<LabelImageType, VectorImageType> FilterType;
+
+  // Two rectangles on a background, each of uniform radiometry
+  LabelImageType::RegionType region;
+  region.SetSize(0, 100);
+  region.SetSize(1, 80);
+  LabelImageType::SpacingType spacing;
+  spacing[0] = 2.;
+  spacing[1] = 0.5;
+
+  const unsigned int nbRectangles = 3;
+  const LabelPixelType labels[nbRectangles] = {30, 10, 20};
+  const long rectangles[nbRectangles][4] = {{0, 0, 100, 80}, {10, 5, 20, 15}, {50, 40, 30, 25}};
+
+  LabelImageType::Pointer labelImage = LabelImageType::New();
+  labelImage->SetRegions(region);
+  labelImage->SetSpacing(spacing);
+  labelImage->Allocate();
+
+  VectorImageType::Pointer vectorImage = VectorImageType::New();
+  vectorImage->SetNumberOfComponentsPerPixel(2);
+  vectorImage->SetRegions(region);
+  vectorImage->SetSpacing(spacing);
+  vectorImage->Allocate();
+
+  for (unsigned int k = 0; k < nbRectangles; ++k)
+    {
+    LabelImageType::RegionType rectangle;
+    rectangle.SetIndex(0, rectangles[k][0]);
+    rectangle.SetIndex(1, rectangles[k][1]);
+    rectangle.SetSize(0, rectangles[k][2]);
+    rectangle.SetSize(1, rectangles[k][3]);
+    VectorImageType::PixelType color(2);
+    color[0] = labels[k];
+    color[1] = -static_cast<float>(labels[k]);
+    itk::ImageRegionIterator<LabelImageType> labelIt(labelImage, rectangle);
+    itk::ImageRegionIterator<VectorImageType> vectorIt(vectorImage, rectangle);
+    for (labelIt.GoToBegin(), vectorIt.GoToBegin(); !labelIt.IsAtEnd(); ++labelIt, ++vectorIt)
+      {
+      labelIt.Set(labels[k]);
+      vectorIt.Set(color);
+      }
+    }
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInputLabelImage(labelImage);
+  filter->SetInputVectorImage(vectorImage);
+  filter->GetStreamer()->SetNumberOfLinesStrippedStreaming(nbLines);
+  filter->Update();
+
+  FilterType::LabelPopulationMapType population = filter->GetLabelPopulationMap();
+  FilterType::BoundingBoxMapType boundingBoxes = filter->GetBoundingBoxMap();
+  FilterType::PointMapType centroids = filter->GetCentroidMap();
+  FilterType::MomentsMapType moments = filter->GetPrincipalMomentsMap();
+  FilterType::RealValueMapType perimeters = filter->GetPerimeterMap();
+  FilterType::PixelValueMapType means = filter->GetMeanValueMap();
+  FilterType::PixelValueMapType mins = filter->GetMinValueMap();
+
+  if (population.size() != nbRectangles)
+    {
+    std::cerr << "Got " << population.size() << " labels, expected " << nbRectangles << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  bool ok = true;
+  const double holes = rectangles[1][2] * rectangles[1][3] + rectangles[2][2] * rectangles[2][3];
+  for (unsigned int k = 1; k < nbRectangles; ++k)
+    {
+    const LabelPixelType label = labels[k];
+    const double width = rectangles[k][2];
+    const double height = rectangles[k][3];
+    ok = CheckValue("Population", label, population[label], width * height) && ok;
+    ok = CheckValue("Perimeter", label, perimeters[label], 2 * (width * spacing[0] + height * spacing[1])) && ok;
+    ok = CheckValue("Centroid x", label, centroids[label][0], (rectangles[k][0] + (width - 1) / 2) * spacing[0]) && ok;
+    ok = CheckValue("Centroid y", label, centroids[label][1], (rectangles[k][1] + (height - 1) / 2) * spacing[1]) && ok;
+
+    // Variance of a uniform discrete distribution over n values
+    const double varianceX = (width * width - 1) / 12 * spacing[0] * spacing[0];
+    const double varianceY = (height * height - 1) / 12 * spacing[1] * spacing[1];
+    ok = CheckValue("Principal moment 0", label, moments[label][0], std::min(varianceX, varianceY)) && ok;
+    ok = CheckValue("Principal moment 1", label, moments[label][1], std::max(varianceX, varianceY)) && ok;
+
+    if (boundingBoxes[label].GetIndex()[0] != rectangles[k][0] || boundingBoxes[label].GetIndex()[1] != rectangles[k][1]
+        || boundingBoxes[label].GetSize()[0] != width || boundingBoxes[label].GetSize()[1] != height)
+      {
+      std::cerr << "Wrong bounding box for label " << label << ": " << boundingBoxes[label] << std::endl;
+      ok = false;
+      }
+    }
+
+  // The background surrounds the two rectangles
+  const LabelPixelType background = labels[0];
+  ok = CheckValue("Population", background, population[background], 100 * 80 - holes) && ok;
+  ok = CheckValue("Perimeter", background, perimeters[background],
+                  perimeters[labels[1]] + perimeters[labels[2]] + 2 * (100 * spacing[0] + 80 * spacing[1])) && ok;
+
+  for (unsigned int k = 0; k < nbRectangles; ++k)
+    {
+    ok = CheckValue("Mean", labels[k], means[labels[k]][0], labels[k]) && ok;
+    ok = CheckValue("Min", labels[k], mins[labels[k]][1], -static_cast<double>(labels[k])) && ok;
+    }
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -37,6 +37,7 @@
 #include "otbConvertPixelBuffer.h"
 #include "otbImageIOFactory.h"
 #include "otbMetaDataKey.h"
+#include "otbGeometryCache.h"
 
 #include "otbMacro.h"
 
@@ -424,28 +425,48 @@ ImageFileReader<TOutputImage, ConvertPixelTraits>
     // Case 3: find an ossimPluginProjection
     // Case 4: find an ossimProjection
     // Case 5: find RPC tags in TIF
+    // The result of these cases may be found in the geometry cache
     else
       {
-      otb_kwl = ReadGeometryFromImage(lFileNameOssimKeywordlist,!m_FilenameHelper->GetSkipRpcTag());
-      if(!otb_kwl.Empty())
+      std::string cacheKey;
+      if (GeometryCache::IsEnabled())
         {
-        otbLogMacro(Info,<< "Loading kwl metadata from official product in file "<<lFileNameOssimKeywordlist);
+        cacheKey = GeometryCache::ComputeProductKey(lFileNameOssimKeywordlist,
+                                                    m_FilenameHelper->GetSkipRpcTag() ? "norpctag" : "rpctag");
+        }
+
+      if (!cacheKey.empty() && GeometryCache::Load(cacheKey, otb_kwl))
+        {
+        otbLogMacro(Info,<< "Loading kwl metadata of "<<lFileNameOssimKeywordlist<<" from the geometry cache");
         }
       else
         {
-        // Try attached files
-        for (const std::string& path : m_ImageIO->GetAttachedFileNames())
+        otb_kwl = ReadGeometryFromImage(lFileNameOssimKeywordlist,!m_FilenameHelper->GetSkipRpcTag());
+        if(!otb_kwl.Empty())
           {
-          otb_kwl = ReadGeometryFromImage(path,!m_FilenameHelper->GetSkipRpcTag());
-          if(!otb_kwl.Empty())
+          otbLogMacro(Info,<< "Loading kwl metadata from official product in file "<<lFileNameOssimKeywordlist);
+          }
+        else
+          {
+          // Try attached files
+          for (const std::string& path : m_ImageIO->GetAttachedFileNames())
+            {
+            otb_kwl = ReadGeometryFromImage(path,!m_FilenameHelper->GetSkipRpcTag());
+            if(!otb_kwl.Empty())
+              {
+              otbLogMacro(Info,<< "Loading kwl metadata in attached file "<<path);
+              break;
+              }
+            }
+          if (otb_kwl.Empty())
             {
-            otbLogMacro(Info,<< "Loading kwl metadata in attached file "<<path);
-            break;
+            otbLogMacro(Info,<< "No kwl metadata found in file "<<lFileNameOssimKeywordlist);
             }
           }
-        if (otb_kwl.Empty())
+
+        if (!cacheKey.empty() && !otb_kwl.Empty())
           {
-          otbLogMacro(Info,<< "No kwl metadata found in file "<<lFileNameOssimKeywordlist);
+          GeometryCache::Store(cacheKey, otb_kwl);
           }
         }
       }
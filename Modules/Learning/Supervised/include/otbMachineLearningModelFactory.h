@@ -23,6 +23,7 @@
 
 #include "otbMachineLearningModel.h"
 #include "otbMachineLearningModelFactoryBase.h"
+#include <map>
 
 namespace otb
 {
@@ -56,6 +57,17 @@ public:
   /** Create the appropriate MachineLearningModel depending on the particulars of the file. */
   static MachineLearningModelTypePointer CreateMachineLearningModel(const std::string& path, FileModeType mode);
 
+  /** Create the appropriate MachineLearningModel and load it from a file.
+   *
+   * Up to ConfigurationManager::GetMaxCachedModels() models are kept in
+   * memory: the same instance is returned as long as the file is not
+   * modified. Cached models are shared, callers must only use them for
+   * prediction. */
+  static MachineLearningModelTypePointer LoadMachineLearningModel(const std::string& path);
+
+  /** Release the models kept in memory by LoadMachineLearningModel() */
+  static void ClearModelCache();
+
   static void CleanFactories();
 
 protected:
@@ -66,6 +78,19 @@ private:
   MachineLearningModelFactory(const Self &) = delete;
   void operator =(const Self&) = delete;
 
+  struct CachedModelType
+  {
+    MachineLearningModelTypePointer Model;
+    long int                        ModifiedTime;
+    unsigned long                   FileLength;
+    unsigned long                   LastUse;
+  };
+  typedef std::map<std::string, CachedModelType> ModelCacheType;
+
+  /** Cache of loaded models, and its lock */
+  static ModelCacheType & GetModelCache();
+  static itk::SimpleMutexLock & GetModelCacheMutex();
+
   /** Register Built-in factories */
   static void RegisterBuiltInFactories();
 
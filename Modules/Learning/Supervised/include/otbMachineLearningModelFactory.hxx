@@ -47,6 +47,9 @@
 #endif
 
 #include "itkMutexLockHolder.h"
+#include "itksys/SystemTools.hxx"
+#include "otbConfigurationManager.h"
+#include "otbMacro.h"
 
 
 namespace otb
@@ -98,6 +101,100 @@ for(typename std::list<MachineLearningModelTypePointer>::iterator k = possibleMa
   return nullptr;
 }
 
+template <class TInputValue, class TOutputValue>
+typename MachineLearningModel<TInputValue,TOutputValue>::Pointer
+MachineLearningModelFactory<TInputValue,TOutputValue>
+::LoadMachineLearningModel(const std::string& path)
+{
+  const unsigned int maxCachedModels = ConfigurationManager::GetMaxCachedModels();
+  if (maxCachedModels == 0)
+    {
+    MachineLearningModelTypePointer model = CreateMachineLearningModel(path, ReadMode);
+    if (model.IsNotNull())
+      {
+      model->Load(path);
+      }
+    return model;
+    }
+
+  // Models are loaded under the lock, so that concurrent requests for
+  // the same file read it only once
+  itk::MutexLockHolder<itk::SimpleMutexLock> lockHolder(GetModelCacheMutex());
+  ModelCacheType & cache = GetModelCache();
+  static unsigned long useCounter = 0;
+
+  const long int modifiedTime = itksys::SystemTools::ModifiedTime(path);
+  const unsigned long fileLength = itksys::SystemTools::FileLength(path);
+
+  typename ModelCacheType::iterator it = cache.find(path);
+  if (it != cache.end())
+    {
+    if (it->second.ModifiedTime == modifiedTime && it->second.FileLength == fileLength)
+      {
+      otbLogMacro(Debug, << "Model " << path << " found in cache");
+      it->second.LastUse = ++useCounter;
+      return it->second.Model;
+      }
+    cache.erase(it);
+    }
+
+  MachineLearningModelTypePointer model = CreateMachineLearningModel(path, ReadMode);
+  if (model.IsNull())
+    {
+    return model;
+    }
+  model->Load(path);
+
+  // Make room for the new model by dropping the least recently used ones
+  while (!cache.empty() && cache.size() >= maxCachedModels)
+    {
+    typename ModelCacheType::iterator oldest = cache.begin();
+    for (typename ModelCacheType::iterator it2 = cache.begin(); it2 != cache.end(); ++it2)
+      {
+      if (it2->second.LastUse < oldest->second.LastUse)
+        {
+        oldest = it2;
+        }
+      }
+    cache.erase(oldest);
+    }
+
+  CachedModelType entry;
+  entry.Model = model;
+  entry.ModifiedTime = modifiedTime;
+  entry.FileLength = fileLength;
+  entry.LastUse = ++useCounter;
+  cache[path] = entry;
+  return model;
+}
+
+template <class TInputValue, class TOutputValue>
+void
+MachineLearningModelFactory<TInputValue,TOutputValue>
+::ClearModelCache()
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> lockHolder(GetModelCacheMutex());
+  GetModelCache().clear();
+}
+
+template <class TInputValue, class TOutputValue>
+typename MachineLearningModelFactory<TInputValue,TOutputValue>::ModelCacheType &
+MachineLearningModelFactory<TInputValue,TOutputValue>
+::GetModelCache()
+{
+  static ModelCacheType cache;
+  return cache;
+}
+
+template <class TInputValue, class TOutputValue>
+itk::SimpleMutexLock &
+MachineLearningModelFactory<TInputValue,TOutputValue>
+::GetModelCacheMutex()
+{
+  static itk::SimpleMutexLock cacheMutex;
+  return cacheMutex;
+}
+
 template <class TInputValue, class TOutputValue>
 void
 MachineLearningModelFactory<TInputValue,TOutputValue>
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <iostream>
+
+#include "otbMachineLearningModelFactory.h"
+#include "itksys/SystemTools.hxx"
+
+typedef otb::MachineLearningModelFactory<float,short> ModelFactoryType;
+typedef ModelFactoryType::MachineLearningModelTypePointer ModelPointerType;
+
+namespace
+{
+ModelPointerType LoadModel(const std::string & path)
+{
+  ModelPointerType model = ModelFactoryType::LoadMachineLearningModel(path);
+  if (model.IsNull())
+    {
+    itkGenericExceptionMacro(<< "Unable to load model " << path);
+    }
+  return model;
+}
+}
+
+int otbMachineLearningModelCache(int argc, char* argv[])
+{
+  if (argc != 3)
+    {
+    std::cerr << "Usage: " << argv[0] << " <model1> <model2>" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string path1(argv[1]);
+  const std::string path2(argv[2]);
+  bool ok = true;
+
+  // No cache: each call reads the file again
+  itksys::SystemTools::PutEnv("OTB_MAX_CACHED_MODELS=0");
+  ModelFactoryType::ClearModelCache();
+  if (LoadModel(path1) == LoadModel(path1))
+    {
+    std::cerr << "Model reused while the cache is disabled" << std::endl;
+    ok = false;
+    }
+
+  // One cached model: a hit returns the same instance, a new file evicts it
+  itksys::SystemTools::PutEnv("OTB_MAX_CACHED_MODELS=1");
+  ModelPointerType model1 = LoadModel(path1);
+  if (LoadModel(path1) != model1)
+    {
+    std::cerr << "Model 1 not found in cache" << std::endl;
+    ok = false;
+    }
+  ModelPointerType model2 = LoadModel(path2);
+  if (model2 == model1)
+    {
+    std::cerr << "Model 2 is the instance of model 1" << std::endl;
+    ok = false;
+    }
+  if (LoadModel(path1) == model1)
+    {
+    std::cerr << "Model 1 still cached after model 2 was loaded (limit is 1)" << std::endl;
+    ok = false;
+    }
+  if (LoadModel(path2) == model2)
+    {
+    std::cerr << "Model 2 still cached after model 1 was reloaded (limit is 1)" << std::endl;
+    ok = false;
+    }
+
+  // Two cached models: both stay in memory
+  itksys::SystemTools::PutEnv("OTB_MAX_CACHED_MODELS=2");
+  ModelFactoryType::ClearModelCache();
+  model1 = LoadModel(path1);
+  model2 = LoadModel(path2);
+  if (LoadModel(path1) != model1 || LoadModel(path2) != model2)
+    {
+    std::cerr << "Models not found in cache (limit is 2)" << std::endl;
+    ok = false;
+    }
+
+  ModelFactoryType::ClearModelCache();
+  if (LoadModel(path1) == model1)
+    {
+    std::cerr << "Model 1 still cached after ClearModelCache()" << std::endl;
+    ok = false;
+    }
+  ModelFactoryType::ClearModelCache();
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -36,6 +36,7 @@ void RegisterTests()
   
   #ifdef OTB_USE_LIBSVM
   REGISTER_TEST(otbLibSVMMachineLearningModelCanRead);
+  REGISTER_TEST(otbMachineLearningModelCache);
   REGISTER_TEST(otbLibSVMMachineLearningModel);
   REGISTER_TEST(otbLibSVMRegressionTests);
   REGISTER_TEST(otbLabelMapClassifier);
@@ -39,6 +39,13 @@ otb_add_test(NAME leTvLibSVMMachineLearningModelCanRead COMMAND otbSupervisedTes
   )
 set_property(TEST leTvLibSVMMachineLearningModelCanRead PROPERTY DEPENDS leTvLibSVMMachineLearningModel)
 
+otb_add_test(NAME leTvMachineLearningModelCache COMMAND otbSupervisedTestDriver
+  otbMachineLearningModelCache
+  ${INPUTDATA}/svm_model_image
+  ${TEMP}/libsvm_model.txt
+  )
+set_property(TEST leTvMachineLearningModelCache PROPERTY DEPENDS leTvLibSVMMachineLearningModel)
+
 otb_add_test(NAME leTvLibSVMMachineLearningModelReg COMMAND otbSupervisedTestDriver
   otbLibSVMRegressionTests
   )
@@ -22,6 +22,8 @@
 #define otbImageMultiSegmentationToRCC8GraphFilter_h
 
 #include "otbImageListToRCC8GraphFilter.h"
+#include "otbLabelMapWithAdjacency.h"
+#include "itkLabelObject.h"
 
 namespace otb
 {
@@ -30,6 +32,12 @@ namespace otb
  * \brief This class takes a list of labelled segmentation images
  * and build the RCC8 graph of the set of regions it represents.
  *
+ * The RCC8 relation is only computed for the pairs of regions which
+ * may be connected: two regions which do not touch, diagonals included,
+ * and where none lies in the bounding box of the other, are
+ * disconnected. The regions of a same segmentation image touch when
+ * their labels are adjacent in the LabelMapWithAdjacency built from it.
+ *
  * \ingroup OTBRCC8
  */
 template <class TInputImage, class TOutputGraph>
@@ -53,6 +61,10 @@ public:
   typedef typename Superclass::InputImageListType    InputImageListType;
   typedef typename InputImageListType::Pointer       InputImageListPointerType;
   typedef typename InputImageListType::ConstIterator ConstListIteratorType;
+  typedef typename InputImageType::RegionType        RegionType;
+  /** Label map related typedefs */
+  typedef itk::LabelObject<PixelType, InputImageType::ImageDimension> LabelObjectType;
+  typedef LabelMapWithAdjacency<LabelObjectType>                      LabelMapType;
   /** Output related typedefs */
   typedef TOutputGraph                                   OutputGraphType;
   typedef typename OutputGraphType::Pointer              OutputGraphPointerType;
@@ -96,6 +108,12 @@ protected:
    * \return The knowledge associated with the composition.
    */
   KnowledgeStateType GetKnowledge(RCC8ValueType r1, RCC8ValueType r2);
+  /**
+   * Get the bounding box of a label object.
+   * \param labelObject The label object,
+   * \return The smallest region containing its lines.
+   */
+  static RegionType GetBoundingBox(const LabelObjectType * labelObject);
 
 private:
   /** Optimisation flag */
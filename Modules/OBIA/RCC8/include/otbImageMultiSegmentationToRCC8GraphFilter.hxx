@@ -30,6 +30,9 @@
 #include "itkProgressReporter.h"
 #include "otbImageToEdgePathFilter.h"
 #include "otbSimplifyPathListFilter.h"
+#include "otbLabelImageToLabelMapWithAdjacencyFilter.h"
+
+#include <algorithm>
 
 namespace otb
 {
@@ -152,7 +155,7 @@ ImageMultiSegmentationToRCC8GraphFilter<TInputImage, TOutputGraph>
   typedef PolygonToPolygonRCC8Calculator<PathType>           RCC8CalculatorType;
   typedef RCC8VertexIterator<OutputGraphType>                VertexIteratorType;
   typedef RCC8InEdgeIterator<OutputGraphType>                InEdgeIteratorType;
-
+  typedef LabelImageToLabelMapWithAdjacencyFilter<InputImageType, LabelMapType> LabelMapFilterType;
 
   // Vector of label
   std::vector<PixelType> maxLabelVector;
@@ -162,6 +165,14 @@ ImageMultiSegmentationToRCC8GraphFilter<TInputImage, TOutputGraph>
   unsigned int segmentationImageIndex = 0;
   unsigned int nbVertices = 0;
 
+  // Segmentation image, label and bounding box of each vertex, and the
+  // adjacency of the regions of each segmentation image
+  std::vector<unsigned int>                   vertexImages;
+  std::vector<PixelType>                      vertexLabels;
+  std::vector<bool>                           vertexFound;
+  std::vector<RegionType>                     vertexRegions;
+  std::vector<typename LabelMapType::Pointer> labelMaps;
+
   // For each segmentation image
   for (ConstListIteratorType it = segList->Begin(); it != segList->End(); ++it)
     {
@@ -173,6 +184,12 @@ ImageMultiSegmentationToRCC8GraphFilter<TInputImage, TOutputGraph>
     otbMsgDebugMacro(<< "Number of objects in image " << segmentationImageIndex << ": "
                      << minMax->GetMaximum());
 
+    typename LabelMapFilterType::Pointer labelMapFilter = LabelMapFilterType::New();
+    labelMapFilter->SetInput(it.Get());
+    labelMapFilter->SetBackgroundValue(0);
+    labelMapFilter->Update();
+    labelMaps.push_back(labelMapFilter->GetOutput());
+
     // then for each region of the images
     for (PixelType label = 1; label <= maxLabelVector.back(); ++label)
       {
@@ -195,12 +212,53 @@ ImageMultiSegmentationToRCC8GraphFilter<TInputImage, TOutputGraph>
       vertex->SetSegmentationType(segmentationImageIndex % 2);
       // Put it in the graph
       graph->SetVertex(vertexIndex, vertex);
+
+      vertexImages.push_back(segmentationImageIndex);
+      vertexLabels.push_back(label);
+      vertexFound.push_back(labelMaps.back()->HasLabel(label));
+      RegionType vertexRegion;
+      if (vertexFound.back())
+        {
+        vertexRegion = GetBoundingBox(labelMaps.back()->GetLabelObject(label));
+        }
+      vertexRegions.push_back(vertexRegion);
       ++vertexIndex;
       ++nbVertices;
       }
     ++segmentationImageIndex;
     }
 
+  // Two regions which do not touch, diagonals included, and where none
+  // lies in the bounding box of the other, are disconnected: the RCC8
+  // calculator is only run on the other pairs. The regions of a same
+  // segmentation touch when they are adjacent in its label map.
+  auto mayBeConnected = [&](VertexDescriptorType v1, VertexDescriptorType v2)
+    {
+    if (!vertexFound[v1] || !vertexFound[v2])
+      {
+      return true;
+      }
+    RegionType region1 = vertexRegions[v1];
+    region1.PadByRadius(1);
+    if (!region1.Crop(vertexRegions[v2]))
+      {
+      return false;
+      }
+    if (vertexImages[v1] != vertexImages[v2]
+        || vertexRegions[v1].IsInside(vertexRegions[v2])
+        || vertexRegions[v2].IsInside(vertexRegions[v1]))
+      {
+      return true;
+      }
+    const LabelMapType * labelMap = labelMaps[vertexImages[v1]];
+    if (!labelMap->HasAdjacentLabels(vertexLabels[v1]))
+      {
+      return false;
+      }
+    typename LabelMapType::AdjacentLabelsRange adjacentLabels = labelMap->GetAdjacentLabels(vertexLabels[v1]);
+    return std::binary_search(adjacentLabels.begin(), adjacentLabels.end(), vertexLabels[v2]);
+    };
+
   itk::ProgressReporter progress(this, 0, nbVertices*nbVertices);
 
   VertexIteratorType vIt1(graph);
@@ -212,7 +270,11 @@ ImageMultiSegmentationToRCC8GraphFilter<TInputImage, TOutputGraph>
     for (vIt2.GoToBegin(); !vIt2.IsAtEnd(); ++vIt2)
       {
       //We do not examine each couple because of the RCC8 symmetry
-      if (vIt1.GetIndex() < vIt2.GetIndex())
+      if (vIt1.GetIndex() < vIt2.GetIndex() && !mayBeConnected(vIt1.GetIndex(), vIt2.GetIndex()))
+        {
+        m_Accumulator[OTB_RCC8_DC] += 2;
+        }
+      else if (vIt1.GetIndex() < vIt2.GetIndex())
         {
 
         // Compute the RCC8 relation
@@ -304,6 +366,36 @@ ImageMultiSegmentationToRCC8GraphFilter<TInputImage, TOutputGraph>
     }
 }
 
+template <class TInputImage, class TOutputGraph>
+typename ImageMultiSegmentationToRCC8GraphFilter<TInputImage, TOutputGraph>
+::RegionType
+ImageMultiSegmentationToRCC8GraphFilter<TInputImage, TOutputGraph>
+::GetBoundingBox(const LabelObjectType * labelObject)
+{
+  typedef typename LabelObjectType::ConstLineIterator LineIteratorType;
+  typename RegionType::IndexType min, max;
+  min.Fill(itk::NumericTraits<typename RegionType::IndexValueType>::max());
+  max.Fill(itk::NumericTraits<typename RegionType::IndexValueType>::NonpositiveMin());
+  for (LineIteratorType lIt(labelObject); !lIt.IsAtEnd(); ++lIt)
+    {
+    const typename RegionType::IndexType & index = lIt.GetLine().GetIndex();
+    for (unsigned int i = 0; i < RegionType::ImageDimension; ++i)
+      {
+      min[i] = std::min(min[i], index[i]);
+      max[i] = std::max(max[i], index[i]);
+      }
+    max[0] = std::max<typename RegionType::IndexValueType>(max[0], index[0] + lIt.GetLine().GetLength() - 1);
+    }
+
+  RegionType region;
+  region.SetIndex(min);
+  for (unsigned int i = 0; i < RegionType::ImageDimension; ++i)
+    {
+    region.SetSize(i, max[i] - min[i] + 1);
+    }
+  return region;
+}
+
 template <class TInputImage, class TOutputGraph>
 void
 ImageMultiSegmentationToRCC8GraphFilter<TInputImage, TOutputGraph>
@@ -30,6 +30,7 @@ otb_module(OTBRCC8
     OTBImageBase
     OTBRoadExtraction
     OTBImageManipulation
+    OTBLabelMap
     OTBPath
     OTBCommon
     OTBBoostAdapters
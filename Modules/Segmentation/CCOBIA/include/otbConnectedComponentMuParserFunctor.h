@@ -209,15 +209,39 @@ public:
     m_NbOfBands = 0;
   }
 
+  /** The copies have their own parser, with the same expression, so that
+   * each thread can evaluate its own copy */
+  ConnectedComponentMuParserFunctor(const Self & other)
+  {
+    m_Parser = ParserType::New();
+    m_NbOfBands = 0;
+    if (!other.m_Expression.empty())
+      {
+      this->SetExpression(other.m_Expression);
+      }
+  }
+
+  Self & operator =(const Self & other)
+  {
+    if (this != &other)
+      {
+      m_Parser = ParserType::New();
+      m_NbOfBands = 0;
+      m_Expression.clear();
+      if (!other.m_Expression.empty())
+        {
+        this->SetExpression(other.m_Expression);
+        }
+      }
+    return *this;
+  }
+
   ~ConnectedComponentMuParserFunctor()
   {
   }
 
 private:
 
-  ConnectedComponentMuParserFunctor(const Self &) = delete;
-  void operator =(const Self &) = delete;
-
   std::string m_Expression;
   ParserType::Pointer m_Parser;
   std::vector<double> m_AImageP1;
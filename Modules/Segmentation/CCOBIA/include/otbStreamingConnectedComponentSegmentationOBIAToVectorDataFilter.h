@@ -29,7 +29,8 @@
 #include "otbMaskMuParserFilter.h"
 #include "itkRelabelComponentImageFilter.h"
 #include "otbAttributesMapLabelObject.h"
-#include "otbLabelImageToLabelMapWithAdjacencyFilter.h"
+#include "otbLabelMapWithAdjacency.h"
+#include "itkLabelImageToLabelMapFilter.h"
 #include "otbBandsStatisticsAttributesLabelMapFilter.h"
 #include "otbShapeAttributesLabelMapFilter.h"
 #include "otbLabelObjectOpeningMuParserFilter.h"
@@ -105,7 +106,8 @@ public:
   typedef otb::AttributesMapLabelObject<unsigned int, InputImageDimension, double>   AttributesMapLabelObjectType;
 
   typedef otb::LabelMapWithAdjacency<AttributesMapLabelObjectType> AttributesLabelMapType;
-  typedef otb::LabelImageToLabelMapWithAdjacencyFilter<LabelImageType, AttributesLabelMapType>
+  // The adjacency of the objects is not used: it is not built
+  typedef itk::LabelImageToLabelMapFilter<LabelImageType, AttributesLabelMapType>
       LabelImageToLabelMapFilterType;
 
   typedef otb::BandsStatisticsAttributesLabelMapFilter<AttributesLabelMapType, VectorImageType>
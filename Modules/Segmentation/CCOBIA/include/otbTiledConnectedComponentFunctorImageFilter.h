@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbTiledConnectedComponentFunctorImageFilter_h
+#define otbTiledConnectedComponentFunctorImageFilter_h
+
+#include "itkImageToImageFilter.h"
+
+#include <map>
+#include <vector>
+
+namespace otb
+{
+
+/** \class TiledConnectedComponentFunctorImageFilter
+ *  \brief Multithreaded and streamable connected component labeling
+ *  with a user-defined connection functor
+ *
+ *  Neighbor pixels are connected when the functor, called with the
+ *  current pixel and the neighbor pixel, returns true, as in
+ *  itk::ConnectedComponentFunctorImageFilter. The pixels whose mask
+ *  value (SetMaskImage(), optional) is 0 are labeled 0 and connected to
+ *  nothing. The functor is copied once per thread, so that stateful
+ *  functors such as ConnectedComponentMuParserFunctor can be used.
+ *
+ *  The image is split into tiles of TileSize pixels, labeled
+ *  independently with a union-find, each with one extra row and column
+ *  so that the components crossing the tile borders can be merged:
+ *
+ *  - In GenerateOutputInformation(), the tiles are labeled concurrently,
+ *    a few tiles at a time. Only the labels found along the tile borders
+ *    are kept, with the position of their first pixel, and the number of
+ *    components starting on each row of the tiles. The label
+ *    equivalences across the tile borders are resolved with a
+ *    union-find.
+ *  - In GenerateData(), the tiles overlapping the requested region are
+ *    labeled again concurrently and relabeled. The tiles are cached
+ *    between two consecutive requests, so that streaming by strips
+ *    labels each tile only once.
+ *
+ *  The components are numbered consecutively from 1, in the raster order
+ *  of their first pixel, as itk::ConnectedComponentFunctorImageFilter
+ *  does. The output labels are therefore the same for the whole image,
+ *  whatever the tile size, the streaming and the number of threads.
+ *
+ * \sa itk::ConnectedComponentFunctorImageFilter
+ *
+ * \ingroup Streamed
+ * \ingroup MultiThreaded
+ *
+ * \ingroup OTBCCOBIA
+ */
+template <class TInputImage, class TOutputImage, class TFunctor, class TMaskImage = TOutputImage>
+class ITK_EXPORT TiledConnectedComponentFunctorImageFilter :
+    public itk::ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  /** Standard class typedef */
+  typedef TiledConnectedComponentFunctorImageFilter          Self;
+  typedef itk::ImageToImageFilter<TInputImage, TOutputImage> Superclass;
+  typedef itk::SmartPointer<Self>                            Pointer;
+  typedef itk::SmartPointer<const Self>                      ConstPointer;
+
+  /** Helper typedefs */
+  typedef TInputImage                          InputImageType;
+  typedef typename InputImageType::PixelType   InputPixelType;
+  typedef TOutputImage                         OutputImageType;
+  typedef typename OutputImageType::PixelType  OutputPixelType;
+  typedef TMaskImage                           MaskImageType;
+  typedef typename MaskImageType::PixelType    MaskPixelType;
+  typedef typename InputImageType::RegionType  RegionType;
+  typedef typename InputImageType::IndexType   IndexType;
+  typedef typename InputImageType::SizeType    SizeType;
+  typedef TFunctor                             FunctorType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(TiledConnectedComponentFunctorImageFilter, ImageToImageFilter);
+
+  /** Connection functor, copied for each thread */
+  FunctorType & GetFunctor()
+  {
+    return m_Functor;
+  }
+  const FunctorType & GetFunctor() const
+  {
+    return m_Functor;
+  }
+  void SetFunctor(const FunctorType & functor)
+  {
+    m_Functor = functor;
+    this->Modified();
+  }
+
+  /** Mask image (optional) */
+  void SetMaskImage(const MaskImageType * mask);
+  const MaskImageType * GetMaskImage() const;
+
+  /** Whether the diagonal neighbors are connected too (default off) */
+  itkSetMacro(FullyConnected, bool);
+  itkGetConstMacro(FullyConnected, bool);
+  itkBooleanMacro(FullyConnected);
+
+  /** Size of the labeling tiles (default 512x512) */
+  itkSetMacro(TileSize, SizeType);
+  itkGetConstReferenceMacro(TileSize, SizeType);
+
+  /** Number of connected components, available after
+   * UpdateOutputInformation() */
+  itkGetConstMacro(ObjectCount, unsigned long);
+
+protected:
+  TiledConnectedComponentFunctorImageFilter();
+
+  ~TiledConnectedComponentFunctorImageFilter() override {}
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+  void GenerateOutputInformation() override;
+
+  void GenerateInputRequestedRegion() override;
+
+  void GenerateData() override;
+
+private:
+  TiledConnectedComponentFunctorImageFilter(const Self &) = delete;
+  void operator =(const Self&) = delete;
+
+  /** Label of a tile found along its borders: offset of its first pixel
+   * in the tile in the raster order of the image, and number of the
+   * other components of the tile starting before it on the same row */
+  struct BorderLabel
+  {
+    itk::OffsetValueType FirstPixel;
+    unsigned long        InteriorStartsBefore;
+  };
+
+  /** Labels of a tile along its borders, as indices in Labels from 1
+   * (0 for the masked pixels), and number of the other components
+   * starting on each row. The bottom margin holds the corner of the
+   * extra row and column. */
+  struct TileBorders
+  {
+    std::vector<BorderLabel>   Labels;
+    std::vector<unsigned long> Top;
+    std::vector<unsigned long> Left;
+    std::vector<unsigned long> BottomMargin;
+    std::vector<unsigned long> RightMargin;
+    std::vector<unsigned long> InteriorStarts;
+  };
+
+  /** Tile region, with the extra row and column when extended */
+  RegionType GetTileRegion(unsigned int tile, bool extended) const;
+
+  /** Tiles overlapping a region, in row-major order */
+  std::vector<unsigned int> GetTiles(const RegionType & region) const;
+
+  /** Tiles overlapping a region and missing from the cache */
+  std::vector<unsigned int> GetMissingTiles(const RegionType & region) const;
+
+  /** Request the inputs over a region and update them */
+  void UpdateInputs(const RegionType & region);
+
+  /** Labels of the extended tile in raster order, numbered from 1 by
+   * first appearance, 0 for the masked pixels */
+  std::vector<unsigned long> LabelTile(unsigned int tile, FunctorType & functor) const;
+
+  /** Index from 1 of each label of the extended tile found along the
+   * borders of the tile or in its extra row and column, 0 for the other
+   * labels */
+  std::vector<unsigned long> GetBorderLabels(unsigned int tile, const std::vector<unsigned long> & labels,
+                                             unsigned long nbLabels) const;
+
+  /** First pass: label equivalences across the tiles */
+  void ComputeLabelTable();
+
+  /** Label the tiles concurrently, the inputs being buffered over them */
+  void ProcessTiles(const std::vector<unsigned int> & tiles, bool firstPass);
+
+  /** Label a tile, then keep its borders (first pass) or relabel it
+   * into the cache */
+  void ProcessTile(unsigned int tile, bool firstPass, unsigned int threadId);
+
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback(void *arg);
+
+  /** Internal structure used for passing data into the threading library */
+  struct ThreadStruct
+  {
+    Self *                            Filter;
+    const std::vector<unsigned int> * Tiles;
+    bool                              FirstPass;
+  };
+
+  FunctorType   m_Functor;
+  bool          m_FullyConnected;
+  SizeType      m_TileSize;
+
+  unsigned int  m_NumberOfTiles[2];
+  unsigned long m_ObjectCount;
+
+  /** One copy of the functor per thread */
+  std::vector<FunctorType> m_ThreadFunctors;
+
+  /** First pass results: final labels of the border labels of all the
+   * tiles, and number of components starting before each row of each
+   * tile in the raster order of the image */
+  std::vector<TileBorders>     m_TileBorders;
+  std::vector<unsigned long>   m_BorderLabelOffsets;
+  std::vector<OutputPixelType> m_FinalLabels;
+  std::vector<unsigned long>   m_RowStartOffsets;
+  itk::TimeStamp               m_LabelTableTime;
+
+  /** Relabeled tiles (without their extra row and column) */
+  std::map<unsigned int, std::vector<OutputPixelType> > m_TileCache;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbTiledConnectedComponentFunctorImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,793 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbTiledConnectedComponentFunctorImageFilter_hxx
+#define otbTiledConnectedComponentFunctorImageFilter_hxx
+
+#include "otbTiledConnectedComponentFunctorImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkNumericTraits.h"
+#include "otbMacro.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace otb
+{
+
+template <class TInputImage, class TOutputImage, class TFunctor, class TMaskImage>
+TiledConnectedComponentFunctorImageFilter<TInputImage, TOutputImage, TFunctor, TMaskImage>
+::TiledConnectedComponentFunctorImageFilter()
+  : m_FullyConnected(false),
+    m_ObjectCount(0)
+{
+  m_TileSize.Fill(512);
+  m_NumberOfTiles[0] = 0;
+  m_NumberOfTiles[1] = 0;
+}
+
+template <class TInputImage, class TOutputImage, class TFunctor, class TMaskImage>
+void
+TiledConnectedComponentFunctorImageFilter<TInputImage, TOutputImage, TFunctor, TMaskImage>
+::SetMaskImage(const MaskImageType * mask)
+{
+  this->itk::ProcessObject::SetNthInput(1, const_cast<MaskImageType *>(mask));
+}
+
+template <class TInputImage, class TOutputImage, class TFunctor, class TMaskImage>
+const typename TiledConnectedComponentFunctorImageFilter<TInputImage, TOutputImage, TFunctor, TMaskImage>::MaskImageType *
+TiledConnectedComponentFunctorImageFilter<TInputImage, TOutputImage, TFunctor, TMaskImage>
+::GetMaskImage() const
+{
+  if (this->GetNumberOfInputs() < 2)
+    {
+    return nullptr;
+    }
+  return static_cast<const MaskImageType *>(this->itk::ProcessObject::GetInput(1));
+}
+
+template <class TInputImage, class TOutputImage, class TFunctor, class TMaskImage>
+typename TiledConnectedComponentFunctorImageFilter<TInputImage, TOutputImage, TFunctor, TMaskImage>::RegionType
+TiledConnectedComponentFunctorImageFilter<TInputImage, TOutputImage, TFunctor, TMaskImage>
+::GetTileRegion(unsigned int tile, bool extended) const
+{
+  const RegionType largest = this->GetInput()->GetLargestPossibleRegion();
+  const unsigned int tileIndex[2] = {tile % m_NumberOfTiles[0], tile / m_NumberOfTiles[0]};
+
+  RegionType region;
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    region.SetIndex(dim, largest.GetIndex()[dim] + tileIndex[dim] * m_TileSize[dim]);
+    region.SetSize(dim, m_TileSize[dim] + (extended ? 1 : 0));
+    }
+  region.Crop(largest);
+  return region;
+}
+
+template <class TInputImage, class TOutputImage, class TFunctor, class TMaskImage>
+std::vector<unsigned int>
+TiledConnectedComponentFunctorImageFilter<TInputImage, TOutputImage, TFunctor, TMaskImage>
+::GetTiles(const RegionType & region) const
+{
+  std::vector<unsigned int> tiles;
+  RegionType cropped = region;
+  const RegionType largest = this->GetInput()->GetLargestPossibleRegion();
+  if (cropped.GetNumberOfPixels() == 0 || !cropped.Crop(largest))
+    {
+    return tiles;
+    }
+
+  unsigned int first[2], last[2];
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    const long offset = cropped.GetIndex()[dim] - largest.GetIndex()[dim];
+    first[dim] = offset / m_TileSize[dim];
+    last[dim] = (offset + cropped.GetSize()[dim] - 1) / m_TileSize[dim];
+    }
+  for (unsigned int ty = first[1]; ty <= last[1]; ++ty)
+    {
+    for (unsigned int tx = first[0]; tx <= last[0]; ++tx)
+      {
+      tiles.push_back(ty * m_NumberOfTiles[0] + tx);
+      }
+    }
+  return tiles;
+}
+
+template <class TInputImage, class TOutputImage, class TFunctor, class TMaskImage>
+std::vector<unsigned int>
+TiledConnectedComponentFunctorImageFilter<TInputImage, TOutputImage, TFunctor, TMaskImage>
+::GetMissingTiles(const RegionType & region) const
+{
+  std::vector<unsigned int> tiles = this->GetTiles(region);
+  tiles.erase(std::remove_if(tiles.begin(), tiles.end(), [this](unsigned int tile)
+    {
+    return m_TileCache.count(tile) > 0;
+    }), tiles.end());
+  return tiles;
+}
+
+template <class TInputImage, class TOutputImage, class TFunctor, class TMaskImage>
+void
+TiledConnectedComponentFunctorImageFilter<TInputImage, TOutputImage, TFunctor, TMaskImage>
+::UpdateInputs(const RegionType & region)
+{
+  InputImageType * input = const_cast<InputImageType *>(this->GetInput());
+  input->SetRequestedRegion(region);
+  input->PropagateRequestedRegion();
+  input->UpdateOutputData();
+
+  MaskImageType * mask = const_cast<MaskImageType *>(this->GetMaskImage());
+  if (mask)
+    {
+    mask->SetRequestedRegion(region);
+    mask->PropagateRequestedRegion();
+    mask->UpdateOutputData();
+    }
+}
+
+template <class TInputImage, class TOutputImage, class TFunctor, class TMaskImage>
+std::vector<unsigned long>
+TiledConnectedComponentFunctorImageFilter<TInputImage, TOutputImage, TFunctor, TMaskImage>
+::LabelTile(unsigned int tile, FunctorType & functor) const
+{
+  const InputImageType * input = this->GetInput();
+  const MaskImageType * mask = this->GetMaskImage();
+  const RegionType region = this->GetTileRegion(tile, true);
+  const unsigned int width = region.GetSize()[0];
+  const unsigned int height = region.GetSize()[1];
+  const MaskPixelType maskZero = itk::NumericTraits<MaskPixelType>::ZeroValue();
+
+  // Provisional labels, grouped with a union-find whose representative
+  // is the smallest label
+  std::vector<unsigned long> labels(region.GetNumberOfPixels(), 0);
+  std::vector<unsigned long> parents(1, 0);
+  auto find = [&parents](unsigned long label)
+  {
+    while (parents[label] != label)
+      {
+      parents[label] = parents[parents[label]];
+      label = parents[label];
+      }
+    return label;
+  };
+
+  std::vector<InputPixelType> previousRow(width);
+  std::vector<InputPixelType> currentRow(width);
+
+  itk::ImageRegionConstIterator<InputImageType> it(input, region);
+  itk::ImageRegionConstIterator<MaskImageType>  maskIt;
+  if (mask)
+    {
+    maskIt = itk::ImageRegionConstIterator<MaskImageType>(mask, region);
+    }
+
+  for (unsigned int y = 0; y < height; ++y)
+    {
+    std::swap(previousRow, currentRow);
+    for (unsigned int x = 0; x < width; ++x, ++it)
+      {
+      const std::size_t id = static_cast<std::size_t>(y) * width + x;
+      if (mask)
+        {
+        const bool masked = maskIt.Get() == maskZero;
+        ++maskIt;
+        if (masked)
+          {
+          continue;
+          }
+        }
+      currentRow[x] = it.Get();
+
+      // Previous neighbors in raster order: left, then up-left, up and
+      // up-right. The functor is not called when both pixels are already
+      // connected.
+      unsigned long label = 0;
+      auto connect = [&](unsigned long neighborLabel, const InputPixelType & neighbor)
+      {
+        if (neighborLabel == 0)
+          {
+          return;
+          }
+        neighborLabel = find(neighborLabel);
+        if (neighborLabel == label || !functor(currentRow[x], neighbor))
+          {
+          return;
+          }
+        if (label == 0)
+          {
+          label = neighborLabel;
+          }
+        else
+          {
+          parents[std::max(label, neighborLabel)] = std::min(label, neighborLabel);
+          label = std::min(label, neighborLabel);
+          }
+      };
+
+      if (x > 0)
+        {
+        connect(labels[id - 1], currentRow[x - 1]);
+        }
+      if (y > 0)
+        {
+        if (m_FullyConnected && x > 0)
+          {
+          connect(labels[id - width - 1], previousRow[x - 1]);
+          }
+        connect(labels[id - width], previousRow[x]);
+        if (m_FullyConnected && x + 1 < width)
+          {
+          connect(labels[id - width + 1], previousRow[x + 1]);
+          }
+        }
+
+      if (label == 0)
+        {
+        label = parents.size();
+        parents.push_back(label);
+        }
+      labels[id] = label;
+      }
+    }
+
+  // Number the components by first appearance
+  std::vector<unsigned long> numbers(parents.size(), 0);
+  unsigned long nbLabels = 0;
+  for (std::vector<unsigned long>::iterator label = labels.begin(); label != labels.end(); ++label)
+    {
+    if (*label != 0)
+      {
+      const unsigned long root = find(*label);
+      if (numbers[root] == 0)
+        {
+        numbers[root] = ++nbLabels;
+        }
+      *label = numbers[root];
+      }
+    }
+  return labels;
+}
+
+template <class TInputImage, class TOutputImage, class TFunctor, class TMaskImage>
+std::vector<unsigned long>
+TiledConnectedComponentFunctorImageFilter<TInputImage, TOutputImage, TFunctor, TMaskImage>
+::GetBorderLabels(unsigned int tile, const std::vector<unsigned long> & labels, unsigned long nbLabels) const
+{
+  const RegionType extended = this->GetTileRegion(tile, true);
+  const RegionType core = this->GetTileRegion(tile, false);
+  const unsigned int extendedWidth = extended.GetSize()[0];
+  const unsigned int extendedHeight = extended.GetSize()[1];
+
+  std::vector<bool> isBorder(nbLabels + 1, false);
+  for (unsigned int y = 0; y < extendedHeight; ++y)
+    {
+    const bool borderRow = y == 0 || y >= core.GetSize()[1];
+    for (unsigned int x = 0; x < extendedWidth; ++x)
+      {
+      if (borderRow || x == 0 || x >= core.GetSize()[0])
+        {
+        isBorder[labels[y * extendedWidth + x]] = true;
+        }
+      else
+        {
+        // Jump to the right border
+        x = static_cast<unsigned int>(core.GetSize()[0]) - 1;
+        }
+      }
+    }
+
+  // Indexed by increasing label, so that both passes agree
+  std::vector<unsigned long> borderLabels(nbLabels + 1, 0);
+  unsigned long nbBorderLabels = 0;
+  for (unsigned long label = 1; label <= nbLabels; ++label)
+    {
+    if (isBorder[label])
+      {
+      borderLabels[label] = ++nbBorderLabels;
+      }
+    }
+  return borderLabels;
+}
+
+template <class TInputImage, class TOutputImage, class TFunctor, class TMaskImage>
+void
+TiledConnectedComponentFunctorImageFilter<TInputImage, TOutputImage, TFunctor, TMaskImage>
+::ProcessTile(unsigned int tile, bool firstPass, unsigned int threadId)
+{
+  const std::vector<unsigned long> labels = this->LabelTile(tile, m_ThreadFunctors[threadId]);
+  const unsigned long nbLabels = labels.empty() ? 0 : *std::max_element(labels.begin(), labels.end());
+  const std::vector<unsigned long> borderLabels = this->GetBorderLabels(tile, labels, nbLabels);
+
+  const RegionType largest = this->GetInput()->GetLargestPossibleRegion();
+  const RegionType extended = this->GetTileRegion(tile, true);
+  const RegionType core = this->GetTileRegion(tile, false);
+  const unsigned int extendedWidth = extended.GetSize()[0];
+  const unsigned int width = core.GetSize()[0];
+  const unsigned int height = core.GetSize()[1];
+  const unsigned long firstRow = core.GetIndex()[1] - largest.GetIndex()[1];
+
+  if (!firstPass)
+    {
+    // The components are numbered in the raster order of their first
+    // pixel: count the components starting on each row. The final label
+    // of a border label is the next number only on its first pixel.
+    std::vector<OutputPixelType> interiorLabels(nbLabels + 1, itk::NumericTraits<OutputPixelType>::ZeroValue());
+    const unsigned long borderLabelOffset = m_BorderLabelOffsets[tile];
+
+    // The cache entry has been inserted before the threads started
+    std::vector<OutputPixelType> & relabeled = m_TileCache.find(tile)->second;
+    relabeled.resize(width * height);
+    for (unsigned int y = 0; y < height; ++y)
+      {
+      unsigned long count = m_RowStartOffsets[(firstRow + y) * m_NumberOfTiles[0] + tile % m_NumberOfTiles[0]];
+      for (unsigned int x = 0; x < width; ++x)
+        {
+        const unsigned long label = labels[y * extendedWidth + x];
+        OutputPixelType & outputLabel = relabeled[y * width + x];
+        if (label == 0)
+          {
+          outputLabel = itk::NumericTraits<OutputPixelType>::ZeroValue();
+          }
+        else if (borderLabels[label] != 0)
+          {
+          outputLabel = m_FinalLabels[borderLabelOffset + borderLabels[label]];
+          if (static_cast<unsigned long>(outputLabel) == count + 1)
+            {
+            ++count;
+            }
+          }
+        else
+          {
+          if (interiorLabels[label] == 0)
+            {
+            interiorLabels[label] = static_cast<OutputPixelType>(++count);
+            }
+          outputLabel = interiorLabels[label];
+          }
+        }
+      }
+    return;
+    }
+
+  TileBorders & borders = m_TileBorders[tile];
+  const unsigned long nbBorderLabels = nbLabels == 0 ? 0 : *std::max_element(borderLabels.begin(), borderLabels.end());
+
+  // First pixel of the border labels, and number of components starting
+  // on each row
+  BorderLabel noPixel;
+  noPixel.FirstPixel = itk::NumericTraits<itk::OffsetValueType>::max();
+  noPixel.InteriorStartsBefore = 0;
+  borders.Labels.assign(nbBorderLabels, noPixel);
+  borders.InteriorStarts.assign(height, 0);
+  std::vector<bool> started(nbLabels + 1, false);
+  for (unsigned int y = 0; y < height; ++y)
+    {
+    for (unsigned int x = 0; x < width; ++x)
+      {
+      const unsigned long label = labels[y * extendedWidth + x];
+      if (label == 0 || started[label])
+        {
+        continue;
+        }
+      started[label] = true;
+      if (borderLabels[label] == 0)
+        {
+        ++borders.InteriorStarts[y];
+        }
+      else
+        {
+        BorderLabel & borderLabel = borders.Labels[borderLabels[label] - 1];
+        borderLabel.FirstPixel = static_cast<itk::OffsetValueType>(firstRow + y) * largest.GetSize()[0]
+                                 + core.GetIndex()[0] - largest.GetIndex()[0] + x;
+        borderLabel.InteriorStartsBefore = borders.InteriorStarts[y];
+        }
+      }
+    }
+
+  borders.Top.resize(width);
+  for (unsigned int x = 0; x < width; ++x)
+    {
+    borders.Top[x] = borderLabels[labels[x]];
+    }
+  borders.Left.resize(height);
+  for (unsigned int y = 0; y < height; ++y)
+    {
+    borders.Left[y] = borderLabels[labels[y * extendedWidth]];
+    }
+  if (extended.GetSize()[1] > height)
+    {
+    borders.BottomMargin.resize(extendedWidth);
+    for (unsigned int x = 0; x < extendedWidth; ++x)
+      {
+      borders.BottomMargin[x] = borderLabels[labels[height * extendedWidth + x]];
+      }
+    }
+  if (extendedWidth > width)
+    {
+    borders.RightMargin.resize(height);
+    for (unsigned int y = 0; y < height; ++y)
+      {
+      borders.RightMargin[y] = borderLabels[labels[y * extendedWidth + width]];
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage, class TFunctor, class TMaskImage>
+ITK_THREAD_RETURN_TYPE
+TiledConnectedComponentFunctorImageFilter<TInputImage, TOutputImage, TFunctor, TMaskImage>
+::ThreaderCallback(void *arg)
+{
+  const unsigned int threadId = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->ThreadID;
+  const unsigned int threadCount = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->NumberOfThreads;
+  ThreadStruct * str = (ThreadStruct *) (((itk::MultiThreader::ThreadInfoStruct *) (arg))->UserData);
+
+  for (unsigned int k = threadId; k < str->Tiles->size(); k += threadCount)
+    {
+    str->Filter->ProcessTile((*str->Tiles)[k], str->FirstPass, threadId);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TInputImage, class TOutputImage, class TFunctor, class TMaskImage>
+void
+TiledConnectedComponentFunctorImageFilter<TInputImage, TOutputImage, TFunctor, TMaskImage>
+::ProcessTiles(const std::vector<unsigned int> & tiles, bool firstPass)
+{
+  if (tiles.empty())
+    {
+    return;
+    }
+
+  ThreadStruct str;
+  str.Filter = this;
+  str.Tiles = &tiles;
+  str.FirstPass = firstPass;
+
+  const unsigned int nbThreads =
+    std::min(static_cast<unsigned int>(this->GetNumberOfThreads()), static_cast<unsigned int>(tiles.size()));
+  m_ThreadFunctors.assign(nbThreads, m_Functor);
+
+  this->GetMultiThreader()->SetNumberOfThreads(nbThreads);
+  this->GetMultiThreader()->SetSingleMethod(this->ThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+}
+
+template <class TInputImage, class TOutputImage, class TFunctor, class TMaskImage>
+void
+TiledConnectedComponentFunctorImageFilter<TInputImage, TOutputImage, TFunctor, TMaskImage>
+::ComputeLabelTable()
+{
+  const unsigned int nbTiles = m_NumberOfTiles[0] * m_NumberOfTiles[1];
+  m_TileBorders.assign(nbTiles, TileBorders());
+  m_TileCache.clear();
+
+  // Label a few tiles of a row at a time, to bound the memory
+  const unsigned int groupSize = std::max(1, static_cast<int>(this->GetNumberOfThreads()));
+  for (unsigned int row = 0; row < m_NumberOfTiles[1]; ++row)
+    {
+    for (unsigned int column = 0; column < m_NumberOfTiles[0]; column += groupSize)
+      {
+      std::vector<unsigned int> tiles;
+      RegionType region = this->GetTileRegion(row * m_NumberOfTiles[0] + column, true);
+      for (unsigned int k = column; k < std::min(column + groupSize, m_NumberOfTiles[0]); ++k)
+        {
+        tiles.push_back(row * m_NumberOfTiles[0] + k);
+        const RegionType extended = this->GetTileRegion(tiles.back(), true);
+        region.SetSize(0, extended.GetIndex()[0] + extended.GetSize()[0] - region.GetIndex()[0]);
+        }
+
+      this->UpdateInputs(region);
+      this->ProcessTiles(tiles, true);
+      }
+    }
+
+  // Border labels are shifted by the number of border labels of the
+  // previous tiles
+  m_BorderLabelOffsets.resize(nbTiles);
+  unsigned long nbLabels = 0;
+  for (unsigned int tile = 0; tile < nbTiles; ++tile)
+    {
+    m_BorderLabelOffsets[tile] = nbLabels;
+    nbLabels += m_TileBorders[tile].Labels.size();
+    }
+
+  // Merge the labels of the pixels shared by the extended tiles: each
+  // component is represented by its smallest label
+  std::vector<unsigned long> parents(nbLabels + 1);
+  std::iota(parents.begin(), parents.end(), 0);
+  auto find = [&parents](unsigned long label)
+  {
+    while (parents[label] != label)
+      {
+      parents[label] = parents[parents[label]];
+      label = parents[label];
+      }
+    return label;
+  };
+  auto unite = [&](unsigned int tile1, unsigned long label1, unsigned int tile2, unsigned long label2)
+  {
+    // Masked pixels are 0 in both tiles
+    if (label1 == 0 || label2 == 0)
+      {
+      return;
+      }
+    const unsigned long a = find(m_BorderLabelOffsets[tile1] + label1);
+    const unsigned long b = find(m_BorderLabelOffsets[tile2] + label2);
+    parents[std::max(a, b)] = std::min(a, b);
+  };
+
+  for (unsigned int tile = 0; tile < nbTiles; ++tile)
+    {
+    const TileBorders & borders = m_TileBorders[tile];
+    const bool hasUp = tile >= m_NumberOfTiles[0];
+    const bool hasLeft = tile % m_NumberOfTiles[0] > 0;
+    if (hasUp)
+      {
+      const unsigned int up = tile - m_NumberOfTiles[0];
+      for (unsigned int x = 0; x < borders.Top.size(); ++x)
+        {
+        unite(tile, borders.Top[x], up, m_TileBorders[up].BottomMargin[x]);
+        }
+      }
+    if (hasLeft)
+      {
+      const unsigned int left = tile - 1;
+      for (unsigned int y = 0; y < borders.Left.size(); ++y)
+        {
+        unite(tile, borders.Left[y], left, m_TileBorders[left].RightMargin[y]);
+        }
+      }
+    if (hasUp && hasLeft)
+      {
+      // Corner of the extra row and column of the up-left tile
+      const unsigned int upLeft = tile - m_NumberOfTiles[0] - 1;
+      unite(tile, borders.Top[0], upLeft, m_TileBorders[upLeft].BottomMargin.back());
+      }
+    }
+
+  // First pixel of each component crossing the tile borders
+  std::vector<BorderLabel> firstPixels(nbLabels + 1);
+  for (unsigned int tile = 0; tile < nbTiles; ++tile)
+    {
+    const std::vector<BorderLabel> & labels = m_TileBorders[tile].Labels;
+    for (unsigned long k = 0; k < labels.size(); ++k)
+      {
+      const unsigned long label = m_BorderLabelOffsets[tile] + k + 1;
+      const unsigned long root = find(label);
+      if (label == root || labels[k].FirstPixel < firstPixels[root].FirstPixel)
+        {
+        firstPixels[root] = labels[k];
+        }
+      }
+    }
+
+  // Number of components starting on each row of each tile, the rows of
+  // the tiles being indexed in the raster order of the image
+  const unsigned long width = this->GetInput()->GetLargestPossibleRegion().GetSize()[0];
+  auto rowOf = [this, width](itk::OffsetValueType pixel)
+  {
+    return static_cast<unsigned long>(pixel / width) * m_NumberOfTiles[0] + (pixel % width) / m_TileSize[0];
+  };
+
+  m_RowStartOffsets.assign(static_cast<std::size_t>(this->GetInput()->GetLargestPossibleRegion().GetSize()[1])
+                           * m_NumberOfTiles[0], 0);
+  for (unsigned int tile = 0; tile < nbTiles; ++tile)
+    {
+    const std::vector<unsigned long> & interiorStarts = m_TileBorders[tile].InteriorStarts;
+    const unsigned long firstRow = (tile / m_NumberOfTiles[0]) * m_TileSize[1];
+    for (unsigned int y = 0; y < interiorStarts.size(); ++y)
+      {
+      m_RowStartOffsets[(firstRow + y) * m_NumberOfTiles[0] + tile % m_NumberOfTiles[0]] = interiorStarts[y];
+      }
+    }
+  m_TileBorders.clear();
+
+  std::vector<unsigned long> roots;
+  for (unsigned long label = 1; label <= nbLabels; ++label)
+    {
+    if (find(label) == label)
+      {
+      roots.push_back(label);
+      ++m_RowStartOffsets[rowOf(firstPixels[label].FirstPixel)];
+      }
+    }
+
+  unsigned long nbComponents = 0;
+  for (std::vector<unsigned long>::iterator it = m_RowStartOffsets.begin(); it != m_RowStartOffsets.end(); ++it)
+    {
+    const unsigned long nbStarts = *it;
+    *it = nbComponents;
+    nbComponents += nbStarts;
+    }
+  if (nbComponents > static_cast<unsigned long>(itk::NumericTraits<OutputPixelType>::max()))
+    {
+    itkExceptionMacro(<< "Too many connected components for the output pixel type");
+    }
+
+  // Final labels of the components crossing the tile borders, by
+  // increasing first pixel: each one follows the components starting
+  // before it on its row
+  std::sort(roots.begin(), roots.end(), [&firstPixels](unsigned long a, unsigned long b)
+    {
+    return firstPixels[a].FirstPixel < firstPixels[b].FirstPixel;
+    });
+  m_FinalLabels.assign(nbLabels + 1, itk::NumericTraits<OutputPixelType>::ZeroValue());
+  unsigned long previousRow = 0;
+  unsigned long rowBorderStarts = 0;
+  for (std::vector<unsigned long>::const_iterator it = roots.begin(); it != roots.end(); ++it)
+    {
+    const BorderLabel & first = firstPixels[*it];
+    const unsigned long row = rowOf(first.FirstPixel);
+    rowBorderStarts = (it != roots.begin() && row == previousRow) ? rowBorderStarts + 1 : 0;
+    previousRow = row;
+    m_FinalLabels[*it] = static_cast<OutputPixelType>(m_RowStartOffsets[row] + first.InteriorStartsBefore
+                                                      + rowBorderStarts + 1);
+    }
+  for (unsigned long label = 1; label <= nbLabels; ++label)
+    {
+    m_FinalLabels[label] = m_FinalLabels[find(label)];
+    }
+  m_ObjectCount = nbComponents;
+
+  otbMsgDevMacro(<< nbLabels << " tile border labels, " << m_ObjectCount << " connected components");
+  m_LabelTableTime.Modified();
+}
+
+template <class TInputImage, class TOutputImage, class TFunctor, class TMaskImage>
+void
+TiledConnectedComponentFunctorImageFilter<TInputImage, TOutputImage, TFunctor, TMaskImage>
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  const InputImageType * input = this->GetInput();
+  const MaskImageType * mask = this->GetMaskImage();
+  const RegionType largest = input->GetLargestPossibleRegion();
+  if (mask && mask->GetLargestPossibleRegion() != largest)
+    {
+    itkExceptionMacro(<< "The input and mask images have different regions");
+    }
+  if (m_TileSize[0] == 0 || m_TileSize[1] == 0)
+    {
+    itkExceptionMacro(<< "Null tile size");
+    }
+
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    m_NumberOfTiles[dim] = (largest.GetSize()[dim] + m_TileSize[dim] - 1) / m_TileSize[dim];
+    }
+
+  const itk::ModifiedTimeType labelTableTime = m_LabelTableTime.GetMTime();
+  if (labelTableTime < this->GetMTime() || labelTableTime < input->GetPipelineMTime()
+      || (mask && labelTableTime < mask->GetPipelineMTime()))
+    {
+    this->ComputeLabelTable();
+    }
+}
+
+template <class TInputImage, class TOutputImage, class TFunctor, class TMaskImage>
+void
+TiledConnectedComponentFunctorImageFilter<TInputImage, TOutputImage, TFunctor, TMaskImage>
+::GenerateInputRequestedRegion()
+{
+  // Only the tiles which are not cached are read
+  const std::vector<unsigned int> tiles = this->GetMissingTiles(this->GetOutput()->GetRequestedRegion());
+
+  RegionType region;
+  if (tiles.empty())
+    {
+    // All the tiles are cached, or the requested region is empty: an
+    // empty region is not valid for every input, request the first
+    // pixel of the image instead
+    SizeType oneSize;
+    oneSize.Fill(1);
+    region.SetIndex(this->GetInput()->GetLargestPossibleRegion().GetIndex());
+    region.SetSize(oneSize);
+    }
+  else
+    {
+    IndexType first = this->GetTileRegion(tiles.front(), true).GetIndex();
+    IndexType last = first;
+    for (unsigned int tile : tiles)
+      {
+      const RegionType extended = this->GetTileRegion(tile, true);
+      for (unsigned int dim = 0; dim < 2; ++dim)
+        {
+        first[dim] = std::min(first[dim], extended.GetIndex()[dim]);
+        last[dim] = std::max(last[dim], static_cast<typename IndexType::IndexValueType>(
+                               extended.GetIndex()[dim] + extended.GetSize()[dim] - 1));
+        }
+      }
+    region.SetIndex(first);
+    region.SetSize(0, last[0] - first[0] + 1);
+    region.SetSize(1, last[1] - first[1] + 1);
+    }
+
+  const_cast<InputImageType *>(this->GetInput())->SetRequestedRegion(region);
+  MaskImageType * mask = const_cast<MaskImageType *>(this->GetMaskImage());
+  if (mask)
+    {
+    mask->SetRequestedRegion(region);
+    }
+}
+
+template <class TInputImage, class TOutputImage, class TFunctor, class TMaskImage>
+void
+TiledConnectedComponentFunctorImageFilter<TInputImage, TOutputImage, TFunctor, TMaskImage>
+::GenerateData()
+{
+  this->AllocateOutputs();
+  OutputImageType * output = this->GetOutput();
+  const RegionType requested = output->GetRequestedRegion();
+  const std::vector<unsigned int> tiles = this->GetTiles(requested);
+
+  // Drop the cached tiles which are not needed anymore
+  for (auto it = m_TileCache.begin(); it != m_TileCache.end();)
+    {
+    if (std::find(tiles.begin(), tiles.end(), it->first) == tiles.end())
+      {
+      it = m_TileCache.erase(it);
+      }
+    else
+      {
+      ++it;
+      }
+    }
+
+  const std::vector<unsigned int> missing = this->GetMissingTiles(requested);
+  for (unsigned int tile : missing)
+    {
+    m_TileCache[tile];
+    }
+  this->ProcessTiles(missing, false);
+
+  for (unsigned int tile : tiles)
+    {
+    const RegionType core = this->GetTileRegion(tile, false);
+    RegionType region = core;
+    region.Crop(requested);
+    const std::vector<OutputPixelType> & labels = m_TileCache[tile];
+
+    itk::ImageRegionIterator<OutputImageType> outIt(output, region);
+    for (outIt.GoToBegin(); !outIt.IsAtEnd(); ++outIt)
+      {
+      const IndexType index = outIt.GetIndex();
+      outIt.Set(labels[(index[1] - core.GetIndex()[1]) * core.GetSize()[0] + index[0] - core.GetIndex()[0]]);
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage, class TFunctor, class TMaskImage>
+void
+TiledConnectedComponentFunctorImageFilter<TInputImage, TOutputImage, TFunctor, TMaskImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "FullyConnected: " << m_FullyConnected << std::endl;
+  os << indent << "TileSize: " << m_TileSize << std::endl;
+  os << indent << "ObjectCount: " << m_ObjectCount << std::endl;
+}
+
+} // end namespace otb
+
+#endif
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "otbVectorImage.h"
+#include "otbImage.h"
+#include "otbConnectedComponentMuParserFunctor.h"
+#include "otbTiledConnectedComponentFunctorImageFilter.h"
+#include "itkConnectedComponentFunctorImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "otbImageFileReader.h"
+#include "otbImageFileWriter.h"
+
+int otbTiledConnectedComponentFunctorImageFilterTest(int argc, char *argv[])
+{
+  if (argc < 7)
+    {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " inputImageFile outputImageFile expression tileSizeX tileSizeY nbLinesPerStrip [maskImageFile]" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const char * inputFilename  = argv[1];
+  const char * outputFilename = argv[2];
+  const std::string expression = argv[3];
+  const unsigned int nbLines = atoi(argv[6]);
+  const char * maskFilename = argc > 7 ? argv[7] : nullptr;
+
+  const unsigned int Dimension = 2;
+  typedef otb::VectorImage<float, Dimension>          InputVectorImageType;
+  typedef otb::Image<unsigned int, Dimension>         MaskImageType;
+  typedef otb::Image<unsigned int, Dimension>         OutputImageType;
+  typedef otb::ImageFileReader<InputVectorImageType>  ReaderType;
+  typedef otb::ImageFileReader<MaskImageType>         MaskReaderType;
+  typedef otb::ImageFileReader<OutputImageType>       LabelReaderType;
+  typedef otb::ImageFileWriter<OutputImageType>       WriterType;
+
+  typedef otb::Functor::ConnectedComponentMuParserFunctor<InputVectorImageType::PixelType> FunctorType;
+  typedef otb::TiledConnectedComponentFunctorImageFilter
+    <InputVectorImageType, OutputImageType, FunctorType, MaskImageType> FilterType;
+  typedef itk::ConnectedComponentFunctorImageFilter
+    <InputVectorImageType, OutputImageType, FunctorType, MaskImageType> ReferenceFilterType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(inputFilename);
+  MaskReaderType::Pointer maskReader = MaskReaderType::New();
+  if (maskFilename)
+    {
+    maskReader->SetFileName(maskFilename);
+    }
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(reader->GetOutput());
+  filter->GetFunctor().SetExpression(expression);
+  FilterType::SizeType tileSize;
+  tileSize[0] = atoi(argv[4]);
+  tileSize[1] = atoi(argv[5]);
+  filter->SetTileSize(tileSize);
+  if (maskFilename)
+    {
+    filter->SetMaskImage(maskReader->GetOutput());
+    }
+
+  // Streamed labeling
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(filter->GetOutput());
+  writer->SetFileName(outputFilename);
+  writer->SetNumberOfLinesStrippedStreaming(nbLines);
+  writer->Update();
+
+  // Reference labeling, on the whole image
+  ReferenceFilterType::Pointer reference = ReferenceFilterType::New();
+  reference->SetInput(reader->GetOutput());
+  reference->GetFunctor().SetExpression(expression);
+  if (maskFilename)
+    {
+    reference->SetMaskImage(maskReader->GetOutput());
+    }
+  reference->Update();
+
+  if (filter->GetObjectCount() != static_cast<unsigned long>(reference->GetObjectCount()))
+    {
+    std::cerr << "Got " << filter->GetObjectCount() << " components, expected "
+              << reference->GetObjectCount() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The labels must match the reference ones exactly: the components
+  // are numbered in the raster order of their first pixel
+  LabelReaderType::Pointer labelReader = LabelReaderType::New();
+  labelReader->SetFileName(outputFilename);
+  labelReader->Update();
+
+  itk::ImageRegionConstIterator<OutputImageType> it(labelReader->GetOutput(),
+                                                    labelReader->GetOutput()->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<OutputImageType> refIt(reference->GetOutput(),
+                                                       reference->GetOutput()->GetLargestPossibleRegion());
+  for (it.GoToBegin(), refIt.GoToBegin(); !it.IsAtEnd(); ++it, ++refIt)
+    {
+    if (it.Get() != refIt.Get())
+      {
+      std::cerr << "Label " << it.Get() << " instead of " << refIt.Get() << " at " << it.GetIndex() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -23,10 +23,12 @@
 #define otbLabelImageRegionMergingFilter_hxx
 
 #include "otbLabelImageRegionMergingFilter.h"
-#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
 #include "itkImageRegionIterator.h"
 #include "itkProgressReporter.h"
 
+#include <utility>
+
 
 namespace otb
 {
@@ -183,311 +185,157 @@ LabelImageRegionMergingFilter<TInputLabelImage, TInputSpectralImage, TOutputLabe
 
   m_NumberOfComponentsPerPixel = spectralImage->GetNumberOfComponentsPerPixel();
 
-  //std::cout << "Copy input label image to output label image" << std::endl;
-  // Copy input label image to output label image
-  typename itk::ImageRegionConstIterator<InputLabelImageType> inputIt(inputLabelImage, outputLabelImage->GetRequestedRegion());
-  typename itk::ImageRegionIterator<OutputLabelImageType> outputIt(outputLabelImage, outputLabelImage->GetRequestedRegion());
-  inputIt.GoToBegin();
-  outputIt.GoToBegin();
-  while(!inputIt.IsAtEnd())
-    {
-    outputIt.Set(inputIt.Get());
-    ++inputIt;
-    ++outputIt;
-    }
-
-  RegionAdjacencyMapType regionAdjacencyMap = LabelImageToRegionAdjacencyMap(outputLabelImage);
-  unsigned int regionCount = regionAdjacencyMap.size() - 1;
+  const RegionType region = outputLabelImage->GetRequestedRegion();
 
-  // Initialize arrays for mode information
-  m_CanonicalLabels.clear();
-  m_CanonicalLabels.resize(regionCount+1);
+  // Build the region adjacency graph
+  typename RegionAdjacencyGraphType::Pointer graph = BuildGraph(inputLabelImage.GetPointer(), region, m_NumberOfComponentsPerPixel);
 
-  m_Modes.clear();
-  m_Modes.reserve(regionCount+1);
-  for(unsigned int i = 0; i < regionCount+1; ++i)
+  // The spectral value of each region is the one of its first pixel
+  std::vector<bool> initialized(graph->GetNumberOfLabels(), false);
+  itk::ImageRegionConstIterator<InputLabelImageType> inputIt(inputLabelImage, region);
+  itk::ImageRegionConstIterator<InputSpectralImageType> spectralIt(spectralImage, region);
+  for (inputIt.GoToBegin(), spectralIt.GoToBegin(); !inputIt.IsAtEnd(); ++inputIt, ++spectralIt)
     {
-    m_Modes.push_back( SpectralPixelType(m_NumberOfComponentsPerPixel) );
-    }
-
-  m_PointCounts.clear();
-  m_PointCounts.resize(regionCount+1); // = std::vector<unsigned int>(regionCount+1);
-
-
-  // Associate each label to a spectral value, a canonical label and a point count
-  typename itk::ImageRegionConstIterator<InputLabelImageType> inputItWithIndex(inputLabelImage, outputLabelImage->GetRequestedRegion());
-  inputItWithIndex.GoToBegin();
-  while(!inputItWithIndex.IsAtEnd())
-    {
-    LabelType label = inputItWithIndex.Get();
-    // if label has not been initialized yet ..
-    if(m_PointCounts[label] == 0)
+    const LabelType label = inputIt.Get();
+    if (!initialized[label])
       {
-     // m_CanonicalLabels[label] = label;
-      m_Modes[label] = spectralImage->GetPixel(inputItWithIndex.GetIndex());
+      initialized[label] = true;
+      graph->SetRegionMean(label, spectralIt.Get());
       }
-    m_PointCounts[label]++;
-    ++inputItWithIndex;
     }
-  // Region Merging
 
-  bool finishedMerging = false;
-  unsigned int mergeIterations = 0;
-
-  //std::cout << "Start merging" << std::endl;
-  // Iterate until no more merge to do
- // while(!finishedMerging)
- //   {
-    while(!finishedMerging)
-      {
-
-      // Initialize Canonical Labels
-      for(LabelType curLabel = 1; curLabel <= regionCount; ++curLabel)
-        m_CanonicalLabels[curLabel] = curLabel;
-
-    // Iterate over all regions
-
-      for(LabelType curLabel = 1; curLabel <= regionCount; ++curLabel)
+  // Region Merging: the merges of an iteration are decided on the
+  // spectral values of the regions at its beginning
+  typename RegionAdjacencyGraphType::LabelListType adjacentRegions;
+  std::vector<std::pair<LabelType, LabelType> > merges;
+  for (unsigned int mergeIterations = 0; ; ++mergeIterations)
+    {
+    merges.clear();
+    for (LabelType curLabel = 0; curLabel < graph->GetNumberOfLabels(); ++curLabel)
       {
-
-      if(m_PointCounts[curLabel] == 0)
+      if (!graph->IsRegion(curLabel))
         {
-        // do not process empty regions
         continue;
         }
-     // std::cout<<" point in label "<<curLabel<<" "<<m_PointCounts[curLabel]<<std::endl;
-      const SpectralPixelType & curSpectral = m_Modes[curLabel];
 
-      // Iterate over all adjacent regions and check for merge
-      typename AdjacentLabelsContainerType::const_iterator adjIt = regionAdjacencyMap[curLabel].begin();
-      while (adjIt != regionAdjacencyMap[curLabel].end())
+      // Iterate over adjacent regions and check for merge, each pair of
+      // regions being checked once
+      graph->GetAdjacentRegions(curLabel, adjacentRegions);
+      for (typename RegionAdjacencyGraphType::LabelListType::const_iterator adjIt = adjacentRegions.begin();
+           adjIt != adjacentRegions.end(); ++adjIt)
         {
-        LabelType adjLabel = *adjIt;
-        assert(adjLabel <= regionCount);
-        const SpectralPixelType & adjSpectral = m_Modes[adjLabel];
-        // Check condition to merge regions
-        bool isSimilar = true;
+        const LabelType adjLabel = *adjIt;
+        if (adjLabel < curLabel)
+          {
+          continue;
+          }
+
         RealType norm2 = 0;
-         for(unsigned int comp = 0; comp < m_NumberOfComponentsPerPixel; ++comp)
+        for(unsigned int comp = 0; comp < m_NumberOfComponentsPerPixel; ++comp)
           {
-          RealType e;
-          e = (curSpectral[comp] - adjSpectral[comp]) / m_RangeBandwidth;
+          const RealType e = (graph->GetRegionMean(curLabel, comp) - graph->GetRegionMean(adjLabel, comp)) / m_RangeBandwidth;
           norm2 += e*e;
           }
-        isSimilar = norm2 < 0.25;
-
-        if(isSimilar)
+        if (norm2 < 0.25)
           {
-          // Find canonical label for current region
-          LabelType curCanLabel = curLabel; //m_CanonicalLabels[curLabel];
-          while(m_CanonicalLabels[curCanLabel] != curCanLabel)
-            {
-            curCanLabel = m_CanonicalLabels[curCanLabel];
-            }
-
-          // Find canonical label for adjacent region
-          LabelType adjCanLabel = adjLabel; //m_CanonicalLabels[curLabel];
-          while(m_CanonicalLabels[adjCanLabel] != adjCanLabel)
-            {
-            adjCanLabel = m_CanonicalLabels[adjCanLabel];
-            }
-
-          // Assign same canonical label to both regions
-          if(curCanLabel < adjCanLabel)
-            {
-            m_CanonicalLabels[adjCanLabel] = curCanLabel;
-            }
-          else
-            {
-            m_CanonicalLabels[m_CanonicalLabels[curCanLabel]] = adjCanLabel;
-            m_CanonicalLabels[curCanLabel] = adjCanLabel;
-            }
+          merges.push_back(std::make_pair(curLabel, adjLabel));
           }
-        ++adjIt;
-        } // end of loop over adjacent labels
-      } // end of loop over labels
-
-    //std::cout << "Simplify the table of canonical labels" << std::endl;
-    /* Simplify the table of canonical labels */
-    for(LabelType i = 1; i < regionCount+1; ++i)
-      {
-      LabelType can = i;
-      while(m_CanonicalLabels[can] != can)
-        {
-        can = m_CanonicalLabels[can];
         }
-      m_CanonicalLabels[i] = can;
       }
 
-    //std::cout << "merge regions with same canonical label" << std::endl;
-    /* Merge regions with same canonical label */
-    /* - update modes and point counts */
-    std::vector<SpectralPixelType> newModes;
-    newModes.reserve(regionCount+1); //(regionCount+1, SpectralPixelType(m_NumberOfComponentsPerPixel));
-    for(unsigned int i = 0; i < regionCount+1; ++i)
+    for (typename std::vector<std::pair<LabelType, LabelType> >::const_iterator it = merges.begin(); it != merges.end(); ++it)
       {
-      newModes.push_back( SpectralPixelType(m_NumberOfComponentsPerPixel) );
+      graph->MergeRegions(it->first, it->second);
       }
-    std::vector<unsigned int> newPointCounts(regionCount+1);
 
-    for(unsigned int i = 1; i < regionCount+1; ++i)
+    if (merges.empty() || mergeIterations >= 10 || graph->GetNumberOfRegions() <= 1)
       {
-      newModes[i].Fill(0);
-      newPointCounts[i] = 0;
+      break;
       }
+    }
 
-    for(unsigned int i = 1; i < regionCount+1; ++i)
-      {
-      LabelType canLabel = m_CanonicalLabels[i];
-      unsigned int nPoints = m_PointCounts[i];
-      for(unsigned int comp = 0; comp < m_NumberOfComponentsPerPixel; ++comp)
-        {
-        newModes[canLabel][comp] += nPoints * m_Modes[i][comp];
-        }
-      newPointCounts[canLabel] += nPoints;
-      }
+  // Generate the label and clustered outputs
+  typename RegionAdjacencyGraphType::LabelListType newLabels;
+  graph->GetConsecutiveRegionLabels(newLabels, true);
 
-    //std::cout << "re-labeling" << std::endl;
-    /* re-labeling */
-    std::vector<LabelType> newLabels(regionCount+1);
-    std::vector<bool> newLabelSet(regionCount+1);
-    for(unsigned int i = 1; i < regionCount+1; ++i)
-      {
-      newLabelSet[i] = false;
-      }
+  SpectralPixelType mode(m_NumberOfComponentsPerPixel);
+  LabelType modeLabel = 0;
+  bool modeSet = false;
 
-    LabelType label = 0;
-    for(unsigned int i = 1; i < regionCount+1; ++i)
+  itk::ImageRegionIterator<OutputLabelImageType> outputIt(outputLabelImage, region);
+  itk::ImageRegionIterator<OutputClusteredImageType> outputClusteredIt(outputClusteredImage, outputClusteredImage->GetRequestedRegion());
+  for (inputIt.GoToBegin(), outputIt.GoToBegin(), outputClusteredIt.GoToBegin(); !inputIt.IsAtEnd();
+       ++inputIt, ++outputIt, ++outputClusteredIt)
+    {
+    const LabelType label = inputIt.Get();
+    outputIt.Set(newLabels[label]);
+
+    if (!modeSet || newLabels[label] != modeLabel)
       {
-      LabelType canLabel = m_CanonicalLabels[i];
-      if(newLabelSet[canLabel] == false)
+      modeSet = true;
+      modeLabel = newLabels[label];
+      for(unsigned int comp = 0; comp < m_NumberOfComponentsPerPixel; ++comp)
         {
-        newLabelSet[canLabel] = true;
-        label++;
-        newLabels[canLabel] = label;
-        unsigned int nPoints = newPointCounts[canLabel];
-        for(unsigned int comp = 0; comp < m_NumberOfComponentsPerPixel; ++comp)
-          {
-          m_Modes[label][comp] = newModes[canLabel][comp] / nPoints;
-          }
-
-        m_PointCounts[label] = newPointCounts[canLabel];
+        mode[comp] = graph->GetRegionMean(label, comp);
         }
       }
-
-    unsigned int oldRegionCount = regionCount;
-    regionCount = label;
-
-    /* reassign labels in label image */
-    outputIt.GoToBegin();
-    while(!outputIt.IsAtEnd())
-      {
-
-      LabelType l = outputIt.Get();
-      LabelType canLabel;
-      assert(m_CanonicalLabels[l] <= oldRegionCount);
-      canLabel = newLabels[m_CanonicalLabels[l]];
-      outputIt.Set( canLabel );
-
-      ++outputIt;
-      }
-
-    finishedMerging = oldRegionCount == regionCount || mergeIterations >= 10 || regionCount == 1;
-
-    // only one iteration for now
-
-    if(!finishedMerging)
-      {
-      /* Update adjacency table */
-      regionAdjacencyMap = LabelImageToRegionAdjacencyMap(outputLabelImage);
-      }
-
-    mergeIterations++;
-    } // end of main iteration loop
-  // std::cout << "merge iterations: " << mergeIterations << std::endl;
-  // std::cout << "number of label objects: " << regionCount << std::endl;
-
-  // Generate clustered output
-  itk::ImageRegionIterator<OutputClusteredImageType> outputClusteredIt(outputClusteredImage, outputClusteredImage->GetRequestedRegion() );
-  outputClusteredIt.GoToBegin();
-  outputIt.GoToBegin();
-  while( !outputClusteredIt.IsAtEnd() )
-    {
-    LabelType label = outputIt.Get();
-    const SpectralPixelType & p = m_Modes[ label ];
-    outputClusteredIt.Set(p);
-    ++outputClusteredIt;
-    ++outputIt;
+    outputClusteredIt.Set(mode);
     }
 }
 
 template <class TInputLabelImage, class TInputSpectralImage, class TOutputLabelImage, class TOutputClusteredImage>
-void
+template <class TLabelImage>
+typename LabelImageRegionMergingFilter<TInputLabelImage, TInputSpectralImage, TOutputLabelImage, TOutputClusteredImage>::RegionAdjacencyGraphType::Pointer
 LabelImageRegionMergingFilter<TInputLabelImage, TInputSpectralImage, TOutputLabelImage, TOutputClusteredImage>
-::PrintSelf(std::ostream& os, itk::Indent indent) const
+::BuildGraph(const TLabelImage * labelImage, const typename TLabelImage::RegionType & region, unsigned int nbComponents)
 {
-  Superclass::PrintSelf(os, indent);
-  os << indent << "Range bandwidth: "                  << m_RangeBandwidth                 << std::endl;
+  typename RegionAdjacencyGraphType::Pointer graph = RegionAdjacencyGraphType::New();
+  graph->SetNumberOfComponents(nbComponents);
+  graph->AddLabels(labelImage, region);
+
+  // The pixels of the last row and column are not scanned, as in the
+  // former adjacency maps, so that the results do not change
+  typename TLabelImage::RegionType adjacencyRegion = region;
+  for (unsigned int dim = 0; dim < TLabelImage::ImageDimension; ++dim)
+    {
+    adjacencyRegion.SetSize(dim, region.GetSize(dim) > 0 ? region.GetSize(dim) - 1 : 0);
+    }
+  if (adjacencyRegion.GetNumberOfPixels() > 0)
+    {
+    graph->AddAdjacencies(labelImage, adjacencyRegion);
+    }
+  graph->BuildAdjacency();
+  return graph;
 }
 
-
 template <class TInputLabelImage, class TInputSpectralImage, class TOutputLabelImage, class TOutputClusteredImage>
 typename LabelImageRegionMergingFilter<TInputLabelImage, TInputSpectralImage, TOutputLabelImage, TOutputClusteredImage>::RegionAdjacencyMapType
 LabelImageRegionMergingFilter<TInputLabelImage, TInputSpectralImage, TOutputLabelImage, TOutputClusteredImage>
-::LabelImageToRegionAdjacencyMap(typename OutputLabelImageType::Pointer  labelImage)
+::LabelImageToRegionAdjacencyMap(typename OutputLabelImageType::Pointer labelImage)
 {
-  // declare the output map
-  RegionAdjacencyMapType ram;
-
-  // Find the maximum label value
-  itk::ImageRegionConstIterator<OutputLabelImageType> it(labelImage, labelImage->GetRequestedRegion());
-  it.GoToBegin();
-  LabelType maxLabel = 0;
-  while(!it.IsAtEnd())
-    {
-    LabelType label = it.Get();
-    maxLabel = std::max(maxLabel, label);
-    ++it;
-    }
-
-  // Set the size of the adjacency map
-  ram.resize(maxLabel+1);
-
-  // set the image region without bottom and right borders so that bottom and
-  // right neighbors always exist
-  RegionType regionWithoutBottomRightBorders  = labelImage->GetRequestedRegion();
-  SizeType size = regionWithoutBottomRightBorders.GetSize();
-  for(unsigned int d = 0; d < ImageDimension; ++d) size[d] -= 1;
-  regionWithoutBottomRightBorders.SetSize(size);
-  itk::ImageRegionConstIteratorWithIndex<OutputLabelImageType> inputIt(labelImage, regionWithoutBottomRightBorders);
+  typename RegionAdjacencyGraphType::Pointer graph = BuildGraph(labelImage.GetPointer(), labelImage->GetRequestedRegion(), 0);
 
-  inputIt.GoToBegin();
-  while(!inputIt.IsAtEnd())
+  RegionAdjacencyMapType ram(graph->GetNumberOfLabels());
+  typename RegionAdjacencyGraphType::LabelListType adjacentRegions;
+  for (LabelType label = 0; label < graph->GetNumberOfLabels(); ++label)
     {
-    const InputIndexType & index = inputIt.GetIndex();
-    LabelType label = inputIt.Get();
-
-    // check neighbors
-    for(unsigned int d = 0; d < ImageDimension; ++d)
-      {
-      InputIndexType neighborIndex = index;
-      neighborIndex[d]++;
-
-      LabelType neighborLabel = labelImage->GetPixel(neighborIndex);
-
-      // add adjacency if different labels
-      if(neighborLabel != label)
-        {
-        ram[label].insert(neighborLabel);
-        ram[neighborLabel].insert(label);
-        }
-      }
-    ++inputIt;
+    graph->GetAdjacentRegions(label, adjacentRegions);
+    ram[label].insert(adjacentRegions.begin(), adjacentRegions.end());
     }
 
   return ram;
 }
 
+template <class TInputLabelImage, class TInputSpectralImage, class TOutputLabelImage, class TOutputClusteredImage>
+void
+LabelImageRegionMergingFilter<TInputLabelImage, TInputSpectralImage, TOutputLabelImage, TOutputClusteredImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Range bandwidth: "                  << m_RangeBandwidth                 << std::endl;
+}
+
+
 } // end namespace otb
 
 #endif
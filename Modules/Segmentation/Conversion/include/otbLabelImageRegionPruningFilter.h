@@ -24,6 +24,7 @@
 #include "otbImage.h"
 #include "otbVectorImage.h"
 #include "itkImageToImageFilter.h"
+#include "otbRegionAdjacencyGraph.h"
 #include "itkNumericTraits.h"
 
 #include <set>
@@ -34,9 +35,18 @@ namespace otb
 /** \class LabelImageRegionPruningFilter
  *
  *
- * This class merges regions in the input label image according to the input
- * image of spectral values and the RangeBandwidth parameter.
+ * This class merges the regions of the input label image smaller than
+ * MinRegionSize with their spectrally closest adjacent region, according
+ * to the input image of spectral values.
  *
+ * The adjacency of the regions is computed once, in a RegionAdjacencyGraph.
+ * The pruning iterations then only update the graph, and the output label
+ * image is written at the end.
+ *
+ * As with the former adjacency maps, the adjacency is computed without
+ * the last row and column of the image, and the output regions are
+ * numbered consecutively from 1 by increasing smallest input label, the
+ * labels missing from the input image taking a number too.
  *
  * \ingroup ImageSegmentation
  *
@@ -87,9 +97,13 @@ public:
 
   itkStaticConstMacro(ImageDimension, unsigned int, InputLabelImageType::ImageDimension);
 
-  /** Typedefs for region adjacency map */
-  typedef InputLabelType      LabelType;
-  typedef std::set<LabelType> AdjacentLabelsContainerType;
+  /** Typedefs for region adjacency graph */
+  typedef InputLabelType                    LabelType;
+  typedef RegionAdjacencyGraph<LabelType>   RegionAdjacencyGraphType;
+
+  /** Typedefs for region adjacency map
+   * \deprecated The filter uses RegionAdjacencyGraphType instead */
+  typedef std::set<LabelType>                      AdjacentLabelsContainerType;
   typedef std::vector<AdjacentLabelsContainerType> RegionAdjacencyMapType;
 
   itkSetMacro(MinRegionSize, RealType);
@@ -129,22 +143,25 @@ protected:
   /** PrintSelf method */
   void PrintSelf(std::ostream& os, itk::Indent indent) const override;
 
-  /** Method to build a map of adjacent regions */
+  /** Method to build a map of adjacent regions
+   * \deprecated The filter does not use it anymore. It is built from a
+   * RegionAdjacencyGraph. */
   RegionAdjacencyMapType LabelImageToRegionAdjacencyMap(typename OutputLabelImageType::Pointer inputLabelImage);
 
 private:
+  /** Build the adjacency graph of a label image: the statistics over
+   * region, the adjacency without its last row and column */
+  template <class TLabelImage>
+  static typename RegionAdjacencyGraphType::Pointer BuildGraph(const TLabelImage * labelImage,
+                                                               const typename TLabelImage::RegionType & region,
+                                                               unsigned int nbComponents);
+
   LabelImageRegionPruningFilter(const Self &) = delete;
   void operator =(const Self&) = delete;
 
   /** Number of components per pixel in the input image */
   unsigned int                   m_NumberOfComponentsPerPixel;
   unsigned int                   m_MinRegionSize;
-  /** This contains the label to which each label will be merged */
-  std::vector<LabelType>         m_CanonicalLabels;
-  /** Contains the spectral value for each region */
-  std::vector<SpectralPixelType> m_Modes;
-  /** Number of points in each region */
-  std::vector<unsigned int>      m_PointCounts;
 
 };
 
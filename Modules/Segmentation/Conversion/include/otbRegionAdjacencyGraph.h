@@ -0,0 +1,253 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbRegionAdjacencyGraph_h
+#define otbRegionAdjacencyGraph_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+
+#include <cstddef>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace otb
+{
+
+/** \class RegionAdjacencyGraph
+ *  \brief Adjacency graph and statistics of the regions of a label image,
+ *  for region merging
+ *
+ *  The labels index the regions directly, from 0 to the maximum label
+ *  of the label image. The graph is filled in two steps:
+ *
+ *  - AddLabelImage() accumulates the pixel count of each label, the sum
+ *    of the spectral values when a spectral image is given, and the
+ *    pairs of adjacent labels. It can be called on consecutive tiles of
+ *    a large image: the statistics are computed over the given region,
+ *    and the adjacencies with the next pixel along each dimension
+ *    whenever it is buffered in the label image. Tiles buffered with one
+ *    extra row and column therefore give the adjacency of the whole
+ *    image. AddLabels() and AddAdjacencies() do each half separately,
+ *    to compute the adjacency over another region than the statistics.
+ *  - BuildAdjacency() stores the adjacency in a compressed sparse row
+ *    layout: one array of offsets, and one array of adjacent labels.
+ *
+ *  Regions are then merged with MergeRegions(). The labels are grouped
+ *  with a union-find: the region of a label is identified by its
+ *  smallest label, and holds the statistics of all its labels. The
+ *  compressed adjacency is never rebuilt: GetAdjacentRegions() walks
+ *  the adjacency of the labels of a region. Merging is therefore in
+ *  constant time, and listing the neighbors of a region is linear in
+ *  the number of its labels and of their adjacencies.
+ *
+ *  PushCandidate() and PopCandidates() manage a priority queue of
+ *  regions to merge. A candidate is discarded when its region is
+ *  merged or pushed again afterwards. MergeSmallRegions() uses it to
+ *  merge the regions smaller than a given size.
+ *
+ * \ingroup OTBConversion
+ */
+template <class TLabel>
+class ITK_EXPORT RegionAdjacencyGraph : public itk::Object
+{
+public:
+  /** Standard class typedef */
+  typedef RegionAdjacencyGraph          Self;
+  typedef itk::Object                   Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(RegionAdjacencyGraph, Object);
+
+  typedef TLabel                 LabelType;
+  typedef double                 RealType;
+  typedef std::vector<LabelType> LabelListType;
+
+  /** Number of spectral components of the regions (default 0) */
+  void SetNumberOfComponents(unsigned int nb);
+  itkGetConstMacro(NumberOfComponents, unsigned int);
+
+  /** Accumulate the pixel counts over region, and the adjacencies of
+   * its pixels with the next buffered pixels */
+  template <class TLabelImage>
+  void AddLabelImage(const TLabelImage * labelImage, const typename TLabelImage::RegionType & region);
+
+  /** Same as above, also accumulating the sums of the spectral values.
+   * The spectral image must be buffered over region. */
+  template <class TLabelImage, class TSpectralImage>
+  void AddLabelImage(const TLabelImage * labelImage, const TSpectralImage * spectralImage,
+                     const typename TLabelImage::RegionType & region);
+
+  /** Accumulate the pixel counts over region only */
+  template <class TLabelImage>
+  void AddLabels(const TLabelImage * labelImage, const typename TLabelImage::RegionType & region);
+
+  /** Add the adjacencies of the pixels of region with the next
+   * buffered pixels only */
+  template <class TLabelImage>
+  void AddAdjacencies(const TLabelImage * labelImage, const typename TLabelImage::RegionType & region);
+
+  /** Add an adjacency between two labels */
+  void AddEdge(LabelType label1, LabelType label2);
+
+  /** Compress the adjacencies and reset the regions to one per label */
+  void BuildAdjacency();
+
+  /** Number of labels, i.e. the maximum label plus one */
+  LabelType GetNumberOfLabels() const
+  {
+    return static_cast<LabelType>(m_Counts.size());
+  }
+
+  /** Number of non-empty regions */
+  itkGetConstMacro(NumberOfRegions, unsigned long);
+
+  /** Region of a label, identified by its smallest label */
+  LabelType GetRegion(LabelType label);
+
+  /** Whether a label identifies a non-empty region */
+  bool IsRegion(LabelType label)
+  {
+    return GetRegion(label) == label && m_Counts[label] > 0;
+  }
+
+  /** Number of pixels of the region of a label */
+  unsigned long GetRegionSize(LabelType label)
+  {
+    return m_Counts[GetRegion(label)];
+  }
+
+  /** Mean spectral value of the region of a label */
+  RealType GetRegionMean(LabelType label, unsigned int component)
+  {
+    const LabelType region = GetRegion(label);
+    return m_Sums[static_cast<std::size_t>(region) * m_NumberOfComponents + component] / m_Counts[region];
+  }
+
+  /** Replace the spectral sums of the region of a label by its size
+   * times the given value */
+  template <class TPixel>
+  void SetRegionMean(LabelType label, const TPixel & mean);
+
+  /** Regions adjacent to the region of a label, by increasing label */
+  void GetAdjacentRegions(LabelType label, LabelListType & regions);
+
+  /** Merge the regions of two labels, and return the merged region */
+  LabelType MergeRegions(LabelType label1, LabelType label2);
+
+  /** Add the region of a label to the merge candidates */
+  void PushCandidate(LabelType label, RealType priority);
+
+  /** Pop the valid candidates of lowest priority, by increasing label.
+   * Returns false when there are no candidates left. */
+  bool PopCandidates(LabelListType & regions);
+
+  /** Merge the regions smaller than minSize with their closest adjacent
+   * region, by increasing size. distance(region, adjacentRegion) gives
+   * the distance between two regions; ties go to the smallest adjacent
+   * label. The regions of the same size choose the region to merge with
+   * before any of them is merged. */
+  template <class TDistance>
+  void MergeSmallRegions(unsigned long minSize, TDistance distance);
+
+  /** Region of each label */
+  void GetRegionLabels(LabelListType & labels);
+
+  /** Region of each label, the regions being numbered consecutively
+   * from 1 by increasing label. Label 0 is left unchanged. When
+   * numberEmptyLabels is true, the labels without any pixel take a
+   * number too, as LabelImageRegionMergingFilter has always done. */
+  void GetConsecutiveRegionLabels(LabelListType & labels, bool numberEmptyLabels = false);
+
+protected:
+  RegionAdjacencyGraph();
+
+  ~RegionAdjacencyGraph() override {}
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+private:
+  RegionAdjacencyGraph(const Self &) = delete;
+  void operator =(const Self&) = delete;
+
+  typedef std::pair<LabelType, LabelType> EdgeType;
+
+  /** Merge candidate: priority, label and stamp of the push */
+  struct Candidate
+  {
+    RealType      Priority;
+    LabelType     Label;
+    unsigned long Stamp;
+
+    bool operator>(const Candidate & other) const
+    {
+      return Priority > other.Priority || (Priority == other.Priority && Label > other.Label);
+    }
+  };
+
+  /** Make room for the given label */
+  void Reserve(LabelType label);
+
+  /** Sort the pending edges and remove the duplicates */
+  void CompactEdges();
+
+  unsigned int  m_NumberOfComponents;
+  unsigned long m_NumberOfRegions;
+
+  /** Statistics, indexed by the region label */
+  std::vector<unsigned long> m_Counts;
+  std::vector<RealType>      m_Sums;
+
+  /** Edges added since the last BuildAdjacency() */
+  std::vector<EdgeType> m_Edges;
+  std::size_t           m_CompactedEdges;
+
+  /** Compressed adjacency of the labels */
+  std::vector<std::size_t> m_AdjacencyOffsets;
+  std::vector<LabelType>   m_Adjacency;
+
+  /** Union-find, and circular lists of the labels of each region */
+  std::vector<LabelType> m_Parents;
+  std::vector<LabelType> m_NextLabels;
+
+  /** Mark of the regions already listed by GetAdjacentRegions() */
+  std::vector<unsigned long> m_Marks;
+  unsigned long              m_CurrentMark;
+
+  /** Merge candidates */
+  std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate> > m_Candidates;
+  std::vector<unsigned long> m_Stamps;
+  unsigned long              m_CurrentStamp;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbRegionAdjacencyGraph.hxx"
+#endif
+
+#endif
@@ -0,0 +1,516 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbRegionAdjacencyGraph_hxx
+#define otbRegionAdjacencyGraph_hxx
+
+#include "otbRegionAdjacencyGraph.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkDefaultConvertPixelTraits.h"
+#include "itkNumericTraits.h"
+
+#include <algorithm>
+
+namespace otb
+{
+
+template <class TLabel>
+RegionAdjacencyGraph<TLabel>
+::RegionAdjacencyGraph()
+  : m_NumberOfComponents(0),
+    m_NumberOfRegions(0),
+    m_CompactedEdges(0),
+    m_CurrentMark(0),
+    m_CurrentStamp(0)
+{
+}
+
+template <class TLabel>
+void
+RegionAdjacencyGraph<TLabel>
+::SetNumberOfComponents(unsigned int nb)
+{
+  if (nb != m_NumberOfComponents)
+    {
+    m_NumberOfComponents = nb;
+    m_Sums.assign(m_Counts.size() * m_NumberOfComponents, 0.);
+    this->Modified();
+    }
+}
+
+template <class TLabel>
+void
+RegionAdjacencyGraph<TLabel>
+::Reserve(LabelType label)
+{
+  if (label >= m_Counts.size())
+    {
+    const std::size_t nbLabels = static_cast<std::size_t>(label) + 1;
+    m_Counts.resize(nbLabels, 0);
+    m_Sums.resize(nbLabels * m_NumberOfComponents, 0.);
+    }
+}
+
+template <class TLabel>
+template <class TLabelImage>
+void
+RegionAdjacencyGraph<TLabel>
+::AddLabelImage(const TLabelImage * labelImage, const typename TLabelImage::RegionType & region)
+{
+  AddLabels(labelImage, region);
+  AddAdjacencies(labelImage, region);
+}
+
+template <class TLabel>
+template <class TLabelImage>
+void
+RegionAdjacencyGraph<TLabel>
+::AddLabels(const TLabelImage * labelImage, const typename TLabelImage::RegionType & region)
+{
+  itk::ImageRegionConstIterator<TLabelImage> labelIt(labelImage, region);
+  for (labelIt.GoToBegin(); !labelIt.IsAtEnd(); ++labelIt)
+    {
+    const LabelType label = static_cast<LabelType>(labelIt.Get());
+    Reserve(label);
+    ++m_Counts[label];
+    }
+}
+
+template <class TLabel>
+template <class TLabelImage, class TSpectralImage>
+void
+RegionAdjacencyGraph<TLabel>
+::AddLabelImage(const TLabelImage * labelImage, const TSpectralImage * spectralImage,
+                const typename TLabelImage::RegionType & region)
+{
+  typedef typename TSpectralImage::PixelType                  SpectralPixelType;
+  typedef itk::DefaultConvertPixelTraits<SpectralPixelType>   PixelTraitsType;
+
+  if (m_NumberOfComponents == 0)
+    {
+    SetNumberOfComponents(spectralImage->GetNumberOfComponentsPerPixel());
+    }
+
+  itk::ImageRegionConstIterator<TLabelImage>    labelIt(labelImage, region);
+  itk::ImageRegionConstIterator<TSpectralImage> spectralIt(spectralImage, region);
+  for (labelIt.GoToBegin(), spectralIt.GoToBegin(); !labelIt.IsAtEnd(); ++labelIt, ++spectralIt)
+    {
+    const LabelType label = static_cast<LabelType>(labelIt.Get());
+    Reserve(label);
+    ++m_Counts[label];
+
+    const SpectralPixelType & pixel = spectralIt.Get();
+    RealType * sums = &m_Sums[static_cast<std::size_t>(label) * m_NumberOfComponents];
+    for (unsigned int comp = 0; comp < m_NumberOfComponents; ++comp)
+      {
+      sums[comp] += static_cast<RealType>(PixelTraitsType::GetNthComponent(comp, pixel));
+      }
+    }
+
+  AddAdjacencies(labelImage, region);
+}
+
+template <class TLabel>
+template <class TLabelImage>
+void
+RegionAdjacencyGraph<TLabel>
+::AddAdjacencies(const TLabelImage * labelImage, const typename TLabelImage::RegionType & region)
+{
+  typedef typename TLabelImage::IndexType       IndexType;
+  typedef typename TLabelImage::IndexValueType  IndexValueType;
+  typedef typename TLabelImage::OffsetValueType OffsetValueType;
+  typedef typename TLabelImage::PixelType       LabelPixelType;
+
+  const unsigned int Dimension = TLabelImage::ImageDimension;
+
+  // Upper bound of the buffered region, for the neighbors
+  const typename TLabelImage::RegionType & bufferedRegion = labelImage->GetBufferedRegion();
+  IndexType bufferedEnd;
+  for (unsigned int dim = 0; dim < Dimension; ++dim)
+    {
+    bufferedEnd[dim] = bufferedRegion.GetIndex(dim) + static_cast<IndexValueType>(bufferedRegion.GetSize(dim));
+    }
+
+  const LabelPixelType *  buffer = labelImage->GetBufferPointer();
+  const OffsetValueType * offsetTable = labelImage->GetOffsetTable();
+
+  itk::ImageRegionConstIteratorWithIndex<TLabelImage> labelIt(labelImage, region);
+  for (labelIt.GoToBegin(); !labelIt.IsAtEnd(); ++labelIt)
+    {
+    const IndexType &     index = labelIt.GetIndex();
+    const LabelType       label = static_cast<LabelType>(labelIt.Get());
+    const OffsetValueType offset = labelImage->ComputeOffset(index);
+
+    for (unsigned int dim = 0; dim < Dimension; ++dim)
+      {
+      if (index[dim] + 1 < bufferedEnd[dim])
+        {
+        const LabelType neighbor = static_cast<LabelType>(buffer[offset + offsetTable[dim]]);
+        if (neighbor != label)
+          {
+          AddEdge(label, neighbor);
+          }
+        }
+      }
+    }
+}
+
+template <class TLabel>
+void
+RegionAdjacencyGraph<TLabel>
+::AddEdge(LabelType label1, LabelType label2)
+{
+  const EdgeType edge = label1 < label2 ? EdgeType(label1, label2) : EdgeType(label2, label1);
+
+  // Neighbor pixels along a border give the same edge again and again
+  if (!m_Edges.empty() && m_Edges.back() == edge)
+    {
+    return;
+    }
+
+  Reserve(edge.second);
+  m_Edges.push_back(edge);
+
+  // Keep the memory bounded by the number of distinct edges
+  if (m_Edges.size() >= 2 * m_CompactedEdges + (1 << 20))
+    {
+    CompactEdges();
+    }
+}
+
+template <class TLabel>
+void
+RegionAdjacencyGraph<TLabel>
+::CompactEdges()
+{
+  std::sort(m_Edges.begin(), m_Edges.end());
+  m_Edges.erase(std::unique(m_Edges.begin(), m_Edges.end()), m_Edges.end());
+  m_CompactedEdges = m_Edges.size();
+}
+
+template <class TLabel>
+void
+RegionAdjacencyGraph<TLabel>
+::BuildAdjacency()
+{
+  CompactEdges();
+
+  const std::size_t nbLabels = m_Counts.size();
+
+  // Compressed sparse rows: count the adjacencies of each label, then
+  // fill them. The edges being sorted, each row is sorted too.
+  m_AdjacencyOffsets.assign(nbLabels + 1, 0);
+  for (typename std::vector<EdgeType>::const_iterator it = m_Edges.begin(); it != m_Edges.end(); ++it)
+    {
+    ++m_AdjacencyOffsets[it->first + 1];
+    ++m_AdjacencyOffsets[it->second + 1];
+    }
+  for (std::size_t label = 0; label < nbLabels; ++label)
+    {
+    m_AdjacencyOffsets[label + 1] += m_AdjacencyOffsets[label];
+    }
+
+  m_Adjacency.resize(m_AdjacencyOffsets[nbLabels]);
+  std::vector<std::size_t> positions(m_AdjacencyOffsets.begin(), m_AdjacencyOffsets.end() - 1);
+  for (typename std::vector<EdgeType>::const_iterator it = m_Edges.begin(); it != m_Edges.end(); ++it)
+    {
+    m_Adjacency[positions[it->first]++] = it->second;
+    m_Adjacency[positions[it->second]++] = it->first;
+    }
+
+  std::vector<EdgeType>().swap(m_Edges);
+  m_CompactedEdges = 0;
+
+  // One region per label
+  m_Parents.resize(nbLabels);
+  m_NextLabels.resize(nbLabels);
+  m_NumberOfRegions = 0;
+  for (std::size_t label = 0; label < nbLabels; ++label)
+    {
+    m_Parents[label] = static_cast<LabelType>(label);
+    m_NextLabels[label] = static_cast<LabelType>(label);
+    if (m_Counts[label] > 0)
+      {
+      ++m_NumberOfRegions;
+      }
+    }
+
+  m_Marks.assign(nbLabels, 0);
+  m_CurrentMark = 0;
+  m_Stamps.assign(nbLabels, 0);
+  m_CurrentStamp = 0;
+  m_Candidates = std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate> >();
+
+  this->Modified();
+}
+
+template <class TLabel>
+typename RegionAdjacencyGraph<TLabel>::LabelType
+RegionAdjacencyGraph<TLabel>
+::GetRegion(LabelType label)
+{
+  // Path halving
+  while (m_Parents[label] != label)
+    {
+    m_Parents[label] = m_Parents[m_Parents[label]];
+    label = m_Parents[label];
+    }
+  return label;
+}
+
+template <class TLabel>
+template <class TPixel>
+void
+RegionAdjacencyGraph<TLabel>
+::SetRegionMean(LabelType label, const TPixel & mean)
+{
+  typedef itk::DefaultConvertPixelTraits<TPixel> PixelTraitsType;
+
+  const LabelType region = GetRegion(label);
+  RealType * sums = &m_Sums[static_cast<std::size_t>(region) * m_NumberOfComponents];
+  for (unsigned int comp = 0; comp < m_NumberOfComponents; ++comp)
+    {
+    sums[comp] = static_cast<RealType>(PixelTraitsType::GetNthComponent(comp, mean)) * m_Counts[region];
+    }
+}
+
+template <class TLabel>
+void
+RegionAdjacencyGraph<TLabel>
+::GetAdjacentRegions(LabelType label, LabelListType & regions)
+{
+  regions.clear();
+
+  const LabelType region = GetRegion(label);
+  ++m_CurrentMark;
+  m_Marks[region] = m_CurrentMark;
+
+  // Walk the labels of the region
+  LabelType member = region;
+  do
+    {
+    for (std::size_t pos = m_AdjacencyOffsets[member]; pos < m_AdjacencyOffsets[member + 1]; ++pos)
+      {
+      const LabelType adjacentRegion = GetRegion(m_Adjacency[pos]);
+      if (m_Marks[adjacentRegion] != m_CurrentMark)
+        {
+        m_Marks[adjacentRegion] = m_CurrentMark;
+        regions.push_back(adjacentRegion);
+        }
+      }
+    member = m_NextLabels[member];
+    }
+  while (member != region);
+
+  std::sort(regions.begin(), regions.end());
+}
+
+template <class TLabel>
+typename RegionAdjacencyGraph<TLabel>::LabelType
+RegionAdjacencyGraph<TLabel>
+::MergeRegions(LabelType label1, LabelType label2)
+{
+  LabelType region1 = GetRegion(label1);
+  LabelType region2 = GetRegion(label2);
+  if (region1 == region2)
+    {
+    return region1;
+    }
+  if (region2 < region1)
+    {
+    std::swap(region1, region2);
+    }
+
+  if (m_Counts[region1] > 0 && m_Counts[region2] > 0)
+    {
+    --m_NumberOfRegions;
+    }
+
+  m_Parents[region2] = region1;
+
+  m_Counts[region1] += m_Counts[region2];
+  m_Counts[region2] = 0;
+  RealType * sums1 = &m_Sums[static_cast<std::size_t>(region1) * m_NumberOfComponents];
+  RealType * sums2 = &m_Sums[static_cast<std::size_t>(region2) * m_NumberOfComponents];
+  for (unsigned int comp = 0; comp < m_NumberOfComponents; ++comp)
+    {
+    sums1[comp] += sums2[comp];
+    sums2[comp] = 0.;
+    }
+
+  // Join the circular lists of labels
+  std::swap(m_NextLabels[region1], m_NextLabels[region2]);
+
+  // Discard the pending candidates of the merged region
+  m_Stamps[region1] = ++m_CurrentStamp;
+
+  return region1;
+}
+
+template <class TLabel>
+void
+RegionAdjacencyGraph<TLabel>
+::PushCandidate(LabelType label, RealType priority)
+{
+  Candidate candidate;
+  candidate.Priority = priority;
+  candidate.Label = GetRegion(label);
+  candidate.Stamp = ++m_CurrentStamp;
+
+  m_Stamps[candidate.Label] = candidate.Stamp;
+  m_Candidates.push(candidate);
+}
+
+template <class TLabel>
+bool
+RegionAdjacencyGraph<TLabel>
+::PopCandidates(LabelListType & regions)
+{
+  regions.clear();
+
+  RealType priority = 0.;
+  while (!m_Candidates.empty())
+    {
+    const Candidate candidate = m_Candidates.top();
+    if (!regions.empty() && candidate.Priority != priority)
+      {
+      break;
+      }
+    m_Candidates.pop();
+
+    if (m_Parents[candidate.Label] == candidate.Label && m_Stamps[candidate.Label] == candidate.Stamp)
+      {
+      priority = candidate.Priority;
+      regions.push_back(candidate.Label);
+      }
+    }
+
+  return !regions.empty();
+}
+
+template <class TLabel>
+template <class TDistance>
+void
+RegionAdjacencyGraph<TLabel>
+::MergeSmallRegions(unsigned long minSize, TDistance distance)
+{
+  for (LabelType label = 0; label < GetNumberOfLabels(); ++label)
+    {
+    if (IsRegion(label) && m_Counts[label] < minSize)
+      {
+      PushCandidate(label, m_Counts[label]);
+      }
+    }
+
+  LabelListType candidates, adjacentRegions, nearestRegions;
+  while (PopCandidates(candidates))
+    {
+    // Choose the nearest region of each candidate before merging any
+    nearestRegions.resize(candidates.size());
+    for (std::size_t i = 0; i < candidates.size(); ++i)
+      {
+      nearestRegions[i] = candidates[i];
+      RealType nearestDistance = itk::NumericTraits<RealType>::max();
+
+      GetAdjacentRegions(candidates[i], adjacentRegions);
+      for (typename LabelListType::const_iterator it = adjacentRegions.begin(); it != adjacentRegions.end(); ++it)
+        {
+        const RealType d = distance(candidates[i], *it);
+        if (d < nearestDistance)
+          {
+          nearestDistance = d;
+          nearestRegions[i] = *it;
+          }
+        }
+      }
+
+    for (std::size_t i = 0; i < candidates.size(); ++i)
+      {
+      MergeRegions(candidates[i], nearestRegions[i]);
+      }
+
+    // The merged regions still too small are candidates again
+    for (std::size_t i = 0; i < candidates.size(); ++i)
+      {
+      const LabelType region = GetRegion(candidates[i]);
+      if (nearestRegions[i] != candidates[i] && m_Counts[region] < minSize)
+        {
+        PushCandidate(region, m_Counts[region]);
+        }
+      }
+    }
+}
+
+template <class TLabel>
+void
+RegionAdjacencyGraph<TLabel>
+::GetRegionLabels(LabelListType & labels)
+{
+  labels.resize(m_Counts.size());
+  for (std::size_t label = 0; label < labels.size(); ++label)
+    {
+    labels[label] = GetRegion(static_cast<LabelType>(label));
+    }
+}
+
+template <class TLabel>
+void
+RegionAdjacencyGraph<TLabel>
+::GetConsecutiveRegionLabels(LabelListType & labels, bool numberEmptyLabels)
+{
+  labels.resize(m_Counts.size());
+
+  // A region is identified by its smallest label, so that it is
+  // numbered before its other labels are met
+  LabelType newLabel = 0;
+  for (std::size_t label = 0; label < labels.size(); ++label)
+    {
+    const LabelType region = GetRegion(static_cast<LabelType>(label));
+    if (region != label)
+      {
+      labels[label] = labels[region];
+      }
+    else if (label > 0 && (numberEmptyLabels || m_Counts[label] > 0))
+      {
+      labels[label] = ++newLabel;
+      }
+    else
+      {
+      labels[label] = 0;
+      }
+    }
+}
+
+template <class TLabel>
+void
+RegionAdjacencyGraph<TLabel>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Number of labels: " << m_Counts.size() << std::endl;
+  os << indent << "Number of regions: " << m_NumberOfRegions << std::endl;
+  os << indent << "Number of components: " << m_NumberOfComponents << std::endl;
+  os << indent << "Number of adjacencies: " << m_Adjacency.size() / 2 << std::endl;
+}
+
+} // end namespace otb
+
+#endif
@@ -0,0 +1,337 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingLabelImageVectorizationFilter_h
+#define otbStreamingLabelImageVectorizationFilter_h
+
+#include "otbPersistentImageFilter.h"
+#include "otbPersistentFilterStreamingDecorator.h"
+#include "otbOGRLayerWrapper.h"
+#include "otbOGRFeatureWrapper.h"
+#include "otbMacro.h"
+
+#include <string>
+#include <vector>
+
+class OGRGeometry;
+
+namespace otb
+{
+
+/** \class PersistentLabelImageVectorizationFilter
+ *  \brief Vectorize a label image strip by strip, stitching the polygons
+ *  across the strips.
+ *
+ *  Each 4-connected component of the label image is written as one
+ *  polygon in the \c ogr::Layer set by \c SetOGRLayer(), with its label
+ *  in the integer field FieldName (created if missing). When
+ *  UseBackgroundValue is on, the pixels of value BackgroundValue are not
+ *  vectorized.
+ *
+ *  The rows of each strip are scanned as runs of identical labels. The
+ *  runs are grouped into components with the runs of the previous row,
+ *  and each component accumulates the horizontal and vertical segments of
+ *  its boundary. A component absent from a row is complete: its rings are
+ *  traced and it leaves the open components. Only the last row and the
+ *  open components are kept between two strips, so that the memory does
+ *  not depend on the image size.
+ *
+ *  The polygons of the complete components are built concurrently, and
+ *  written by batches of BatchSize features, each batch in one OGR
+ *  transaction.
+ *
+ *  The requested regions must be full width strips, streamed from top to
+ *  bottom, as with the default streaming of
+ *  StreamingLabelImageVectorizationFilter.
+ *
+ * \sa PersistentImageFilter
+ * \sa LabelImageToOGRDataSourceFilter
+ *
+ * \ingroup Streamed
+ * \ingroup MultiThreaded
+ *
+ * \ingroup OTBConversion
+ */
+template<class TInputImage>
+class ITK_EXPORT PersistentLabelImageVectorizationFilter :
+  public PersistentImageFilter<TInputImage, TInputImage>
+{
+public:
+  /** Standard Self typedef */
+  typedef PersistentLabelImageVectorizationFilter         Self;
+  typedef PersistentImageFilter<TInputImage, TInputImage> Superclass;
+  typedef itk::SmartPointer<Self>                         Pointer;
+  typedef itk::SmartPointer<const Self>                   ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(PersistentLabelImageVectorizationFilter, PersistentImageFilter);
+
+  typedef TInputImage                             InputImageType;
+  typedef typename InputImageType::RegionType     RegionType;
+  typedef typename InputImageType::SizeType       SizeType;
+  typedef typename InputImageType::IndexType      IndexType;
+  typedef typename InputImageType::IndexValueType IndexValueType;
+  typedef typename InputImageType::PixelType      LabelType;
+  typedef typename InputImageType::PointType      PointType;
+  typedef typename InputImageType::SpacingType    SpacingType;
+
+  typedef ogr::Layer   OGRLayerType;
+  typedef ogr::Feature OGRFeatureType;
+
+  void AllocateOutputs() override;
+  void Reset(void) override;
+  void Synthetize(void) override;
+
+  /** Set the \c ogr::Layer in which the polygons will be written */
+  void SetOGRLayer(const OGRLayerType & ogrLayer);
+  /** Get the \c ogr::Layer output */
+  const OGRLayerType & GetOGRLayer(void) const;
+
+  /** Name of the field holding the labels (default "DN") */
+  itkSetStringMacro(FieldName);
+  itkGetStringMacro(FieldName);
+
+  /** Label of the pixels which are not vectorized, when
+   * UseBackgroundValue is on (default 0) */
+  itkSetMacro(BackgroundValue, LabelType);
+  itkGetConstMacro(BackgroundValue, LabelType);
+
+  /** Whether the background pixels are vectorized (default off) */
+  itkSetMacro(UseBackgroundValue, bool);
+  itkGetConstMacro(UseBackgroundValue, bool);
+  itkBooleanMacro(UseBackgroundValue);
+
+  /** Number of features written per OGR transaction (default 10000) */
+  itkSetMacro(BatchSize, unsigned long);
+  itkGetConstMacro(BatchSize, unsigned long);
+
+  /** Number of polygons written since the last Reset() */
+  itkGetConstMacro(NumberOfPolygons, unsigned long);
+
+protected:
+  PersistentLabelImageVectorizationFilter();
+  ~PersistentLabelImageVectorizationFilter() override {}
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+  void GenerateData() override;
+
+private:
+  PersistentLabelImageVectorizationFilter(const Self &) = delete;
+  void operator =(const Self&) = delete;
+
+  typedef unsigned int ComponentType;
+
+  /** Boundary segment between two pixel corners, the component being on
+   * its left in the image (row downwards) frame */
+  struct Segment
+  {
+    IndexValueType X0;
+    IndexValueType Y0;
+    IndexValueType X1;
+    IndexValueType Y1;
+  };
+
+  /** Run of identical labels [Begin, End) of a row */
+  struct Run
+  {
+    IndexValueType Begin;
+    IndexValueType End;
+    LabelType      Label;
+    ComponentType  Component;
+  };
+
+  /** Label and boundary of a component */
+  struct Component
+  {
+    LabelType            Label;
+    std::vector<Segment> Segments;
+  };
+
+  typedef std::vector<Run> RunListType;
+
+  /** Group the runs of a row with the previous row, accumulate their
+   * boundaries and retire the complete components. An empty row closes
+   * all the open components. */
+  void ProcessRow(RunListType & runs, IndexValueType y);
+
+  ComponentType NewComponent(LabelType label);
+
+  ComponentType FindComponent(ComponentType component);
+
+  void MergeComponents(ComponentType component1, ComponentType component2);
+
+  void AddSegment(ComponentType component, IndexValueType x0, IndexValueType y0,
+                  IndexValueType x1, IndexValueType y1);
+
+  /** Build the polygons of the complete components concurrently, then
+   * write them in one transaction */
+  void WriteCompleteComponents();
+
+  /** Trace the rings of a complete component, in physical coordinates */
+  OGRGeometry * BuildPolygon(const Component & component) const;
+
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback(void *arg);
+
+  /** Internal structure used for passing data into the threading library */
+  struct ThreadStruct
+  {
+    const Self *                Filter;
+    std::vector<OGRGeometry *> * Geometries;
+  };
+
+  // The layer where to write the polygons
+  OGRLayerType m_OGRLayer;
+
+  std::string   m_FieldName;
+  LabelType     m_BackgroundValue;
+  bool          m_UseBackgroundValue;
+  unsigned long m_BatchSize;
+  unsigned long m_NumberOfPolygons;
+
+  /** Image extent and physical position of the pixel corners */
+  RegionType m_LargestRegion;
+  PointType  m_CornerOrigin;
+  SpacingType m_Spacing;
+
+  /** Next row to process, and runs of the previous row */
+  IndexValueType m_NextRow;
+  RunListType    m_PreviousRuns;
+
+  /** Open components, grouped with a union-find. The identifiers of the
+   * merged and complete components are reused. */
+  std::vector<Component>     m_Components;
+  std::vector<ComponentType> m_Parents;
+  std::vector<ComponentType> m_FreeComponents;
+  std::vector<ComponentType> m_MergedComponents;
+  std::vector<unsigned long> m_Marks;
+  unsigned long              m_CurrentMark;
+
+  /** Complete components waiting to be written */
+  std::vector<Component> m_CompleteComponents;
+}; // end of class PersistentLabelImageVectorizationFilter
+
+
+/** \class StreamingLabelImageVectorizationFilter
+ *  \brief Streams a label image by strips through the
+ *  PersistentLabelImageVectorizationFilter.
+ *
+ *  The streamer is set up for automatic stripped streaming, and can be
+ *  tuned with GetStreamer()->SetAutomaticStrippedStreaming() or
+ *  SetNumberOfLinesStrippedStreaming(). Tiled streaming is not supported.
+ *
+ *  \code
+ *  typedef otb::StreamingLabelImageVectorizationFilter<LabelImageType> VectorizationFilterType;
+ *  VectorizationFilterType::Pointer filter = VectorizationFilterType::New();
+ *  filter->SetInput(labelImage);
+ *  filter->SetOGRLayer(layer);
+ *  filter->Update();
+ *  \endcode
+ *
+ * \sa PersistentLabelImageVectorizationFilter
+ * \sa PersistentFilterStreamingDecorator
+ *
+ * \ingroup Streamed
+ * \ingroup MultiThreaded
+ *
+ * \ingroup OTBConversion
+ */
+template<class TInputImage>
+class ITK_EXPORT StreamingLabelImageVectorizationFilter :
+  public PersistentFilterStreamingDecorator<PersistentLabelImageVectorizationFilter<TInputImage> >
+{
+public:
+  /** Standard Self typedef */
+  typedef StreamingLabelImageVectorizationFilter Self;
+  typedef PersistentFilterStreamingDecorator
+  <PersistentLabelImageVectorizationFilter<TInputImage> > Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(StreamingLabelImageVectorizationFilter, PersistentFilterStreamingDecorator);
+
+  typedef typename Superclass::FilterType            VectorizationFilterType;
+  typedef typename VectorizationFilterType::LabelType LabelType;
+  typedef typename VectorizationFilterType::OGRLayerType OGRLayerType;
+  typedef TInputImage                                 InputImageType;
+
+  using Superclass::SetInput;
+  void SetInput(const InputImageType * input)
+  {
+    this->GetFilter()->SetInput(input);
+  }
+  const InputImageType * GetInput()
+  {
+    return this->GetFilter()->GetInput();
+  }
+
+  void SetOGRLayer(const OGRLayerType & ogrLayer)
+  {
+    this->GetFilter()->SetOGRLayer(ogrLayer);
+  }
+  const OGRLayerType & GetOGRLayer() const
+  {
+    return this->GetFilter()->GetOGRLayer();
+  }
+
+  otbSetObjectMemberMacro(Filter, FieldName, std::string);
+  otbGetObjectMemberMacro(Filter, FieldName, std::string);
+  otbSetObjectMemberMacro(Filter, BackgroundValue, LabelType);
+  otbGetObjectMemberMacro(Filter, BackgroundValue, LabelType);
+  otbSetObjectMemberMacro(Filter, UseBackgroundValue, bool);
+  otbGetObjectMemberMacro(Filter, UseBackgroundValue, bool);
+  otbSetObjectMemberMacro(Filter, BatchSize, unsigned long);
+  otbGetObjectMemberMacro(Filter, BatchSize, unsigned long);
+
+  /** Number of polygons written by the last Update() */
+  unsigned long GetNumberOfPolygons() const
+  {
+    return this->GetFilter()->GetNumberOfPolygons();
+  }
+
+protected:
+  /** Constructor */
+  StreamingLabelImageVectorizationFilter()
+  {
+    this->GetStreamer()->SetAutomaticStrippedStreaming(0);
+  }
+
+  /** Destructor */
+  ~StreamingLabelImageVectorizationFilter() override {}
+
+private:
+  StreamingLabelImageVectorizationFilter(const Self &) = delete;
+  void operator =(const Self&) = delete;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbStreamingLabelImageVectorizationFilter.hxx"
+#endif
+
+#endif
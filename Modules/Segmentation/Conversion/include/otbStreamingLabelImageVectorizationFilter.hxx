@@ -0,0 +1,677 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingLabelImageVectorizationFilter_hxx
+#define otbStreamingLabelImageVectorizationFilter_hxx
+
+#include "otbStreamingLabelImageVectorizationFilter.h"
+#include "itkImageScanlineConstIterator.h"
+#include "itkMultiThreader.h"
+#include "itkNumericTraits.h"
+#include "otbStopwatch.h"
+#include "ogr_geometry.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+namespace otb
+{
+
+namespace internal
+{
+
+/** Orders the segment indices by start corner, row first */
+template <class TSegment>
+class SegmentStartLess
+{
+public:
+  explicit SegmentStartLess(const std::vector<TSegment> & segments) : m_Segments(segments) {}
+
+  bool operator()(std::size_t i, std::size_t j) const
+  {
+    const TSegment & a = m_Segments[i];
+    const TSegment & b = m_Segments[j];
+    return a.Y0 < b.Y0 || (a.Y0 == b.Y0 && a.X0 < b.X0);
+  }
+
+private:
+  const std::vector<TSegment> & m_Segments;
+};
+
+template <class T>
+inline int Sign(T value)
+{
+  return (value > 0) - (value < 0);
+}
+
+} // end namespace internal
+
+template<class TInputImage>
+PersistentLabelImageVectorizationFilter<TInputImage>
+::PersistentLabelImageVectorizationFilter()
+  : m_OGRLayer(nullptr, false),
+    m_FieldName("DN"),
+    m_BackgroundValue(itk::NumericTraits<LabelType>::ZeroValue()),
+    m_UseBackgroundValue(false),
+    m_BatchSize(10000),
+    m_NumberOfPolygons(0),
+    m_NextRow(0),
+    m_CurrentMark(0)
+{
+}
+
+template<class TInputImage>
+void
+PersistentLabelImageVectorizationFilter<TInputImage>
+::SetOGRLayer(const OGRLayerType & ogrLayer)
+{
+  m_OGRLayer = ogrLayer;
+  this->Modified();
+}
+
+template<class TInputImage>
+const typename PersistentLabelImageVectorizationFilter<TInputImage>::OGRLayerType &
+PersistentLabelImageVectorizationFilter<TInputImage>
+::GetOGRLayer(void) const
+{
+  return m_OGRLayer;
+}
+
+template<class TInputImage>
+void
+PersistentLabelImageVectorizationFilter<TInputImage>
+::AllocateOutputs()
+{
+  // Nothing that needs to be allocated for the outputs : the output is not meant to be used
+}
+
+template<class TInputImage>
+void
+PersistentLabelImageVectorizationFilter<TInputImage>
+::Reset()
+{
+  if (!m_OGRLayer)
+    {
+    itkExceptionMacro(<< "Output OGRLayer is null.");
+    }
+
+  if (m_OGRLayer.GetLayerDefn().GetFieldIndex(m_FieldName.c_str()) < 0)
+    {
+    OGRFieldDefn field(m_FieldName.c_str(), OFTInteger);
+    m_OGRLayer.CreateField(field, true);
+    }
+
+  InputImageType * input = const_cast<InputImageType *>(this->GetInput());
+  input->UpdateOutputInformation();
+
+  m_LargestRegion = input->GetLargestPossibleRegion();
+  m_Spacing = input->GetSignedSpacing();
+  input->TransformIndexToPhysicalPoint(m_LargestRegion.GetIndex(), m_CornerOrigin);
+  m_CornerOrigin[0] -= 0.5 * m_Spacing[0];
+  m_CornerOrigin[1] -= 0.5 * m_Spacing[1];
+
+  m_NextRow = m_LargestRegion.GetIndex()[1];
+  m_PreviousRuns.clear();
+  m_Components.clear();
+  m_Parents.clear();
+  m_FreeComponents.clear();
+  m_MergedComponents.clear();
+  m_Marks.clear();
+  m_CurrentMark = 0;
+  m_CompleteComponents.clear();
+  m_NumberOfPolygons = 0;
+}
+
+template<class TInputImage>
+void
+PersistentLabelImageVectorizationFilter<TInputImage>
+::Synthetize()
+{
+  // Close the components still open after the last row
+  RunListType noRuns;
+  this->ProcessRow(noRuns, m_NextRow);
+  this->WriteCompleteComponents();
+}
+
+template<class TInputImage>
+void
+PersistentLabelImageVectorizationFilter<TInputImage>
+::GenerateData()
+{
+  const InputImageType * input = this->GetInput();
+  const RegionType region = input->GetRequestedRegion();
+
+  if (region.GetIndex()[0] != m_LargestRegion.GetIndex()[0] || region.GetSize()[0] != m_LargestRegion.GetSize()[0]
+      || region.GetIndex()[1] != m_NextRow)
+    {
+    itkExceptionMacro(<< "Requested region starting at " << region.GetIndex() << " with size " << region.GetSize()
+                      << " is not the full width strip starting at row " << m_NextRow
+                      << ": the image must be streamed by strips, from top to bottom.");
+    }
+
+  otb::Stopwatch chrono = otb::Stopwatch::StartNew();
+
+  RunListType runs;
+  itk::ImageScanlineConstIterator<InputImageType> it(input, region);
+  IndexValueType y = region.GetIndex()[1];
+
+  for (it.GoToBegin(); !it.IsAtEnd(); it.NextLine(), ++y)
+    {
+    runs.clear();
+    IndexValueType x = region.GetIndex()[0];
+    for (; !it.IsAtEndOfLine(); ++it, ++x)
+      {
+      const LabelType label = it.Get();
+      if (m_UseBackgroundValue && label == m_BackgroundValue)
+        {
+        continue;
+        }
+      if (runs.empty() || runs.back().End != x || runs.back().Label != label)
+        {
+        Run run;
+        run.Begin = x;
+        run.End = x + 1;
+        run.Label = label;
+        run.Component = std::numeric_limits<ComponentType>::max();
+        runs.push_back(run);
+        }
+      else
+        {
+        ++runs.back().End;
+        }
+      }
+
+    this->ProcessRow(runs, y);
+
+    if (m_CompleteComponents.size() >= m_BatchSize)
+      {
+      this->WriteCompleteComponents();
+      }
+    }
+
+  m_NextRow = y;
+  this->WriteCompleteComponents();
+
+  chrono.Stop();
+  otbMsgDebugMacro(<< "Vectorizing strip took " << chrono.GetElapsedMilliseconds() << " ms, "
+                   << m_Components.size() - m_FreeComponents.size() << " components left open");
+}
+
+template<class TInputImage>
+void
+PersistentLabelImageVectorizationFilter<TInputImage>
+::ProcessRow(RunListType & runs, IndexValueType y)
+{
+  const ComponentType noComponent = std::numeric_limits<ComponentType>::max();
+
+  // Group the runs with the overlapping runs of the same label in the
+  // previous row (4-connectivity)
+  std::size_t first = 0;
+  for (typename RunListType::iterator run = runs.begin(); run != runs.end(); ++run)
+    {
+    while (first < m_PreviousRuns.size() && m_PreviousRuns[first].End <= run->Begin)
+      {
+      ++first;
+      }
+    for (std::size_t k = first; k < m_PreviousRuns.size() && m_PreviousRuns[k].Begin < run->End; ++k)
+      {
+      if (m_PreviousRuns[k].Label == run->Label)
+        {
+        if (run->Component == noComponent)
+          {
+          run->Component = m_PreviousRuns[k].Component;
+          }
+        else
+          {
+          this->MergeComponents(run->Component, m_PreviousRuns[k].Component);
+          }
+        }
+      }
+    if (run->Component == noComponent)
+      {
+      run->Component = this->NewComponent(run->Label);
+      }
+    }
+
+  // Horizontal boundaries between the two rows: bottom of the previous
+  // runs from left to right, then top of the current runs from right to
+  // left, except where the label continues
+  first = 0;
+  for (typename RunListType::const_iterator prev = m_PreviousRuns.begin(); prev != m_PreviousRuns.end(); ++prev)
+    {
+    while (first < runs.size() && runs[first].End <= prev->Begin)
+      {
+      ++first;
+      }
+    IndexValueType x = prev->Begin;
+    for (std::size_t k = first; k < runs.size() && runs[k].Begin < prev->End; ++k)
+      {
+      if (runs[k].Label == prev->Label)
+        {
+        const IndexValueType begin = std::max(runs[k].Begin, prev->Begin);
+        if (begin > x)
+          {
+          this->AddSegment(prev->Component, x, y, begin, y);
+          }
+        x = std::min(runs[k].End, prev->End);
+        }
+      }
+    if (x < prev->End)
+      {
+      this->AddSegment(prev->Component, x, y, prev->End, y);
+      }
+    }
+
+  first = 0;
+  for (typename RunListType::const_iterator run = runs.begin(); run != runs.end(); ++run)
+    {
+    while (first < m_PreviousRuns.size() && m_PreviousRuns[first].End <= run->Begin)
+      {
+      ++first;
+      }
+    IndexValueType x = run->Begin;
+    for (std::size_t k = first; k < m_PreviousRuns.size() && m_PreviousRuns[k].Begin < run->End; ++k)
+      {
+      if (m_PreviousRuns[k].Label == run->Label)
+        {
+        const IndexValueType begin = std::max(m_PreviousRuns[k].Begin, run->Begin);
+        if (begin > x)
+          {
+          this->AddSegment(run->Component, begin, y, x, y);
+          }
+        x = std::min(m_PreviousRuns[k].End, run->End);
+        }
+      }
+    if (x < run->End)
+      {
+      this->AddSegment(run->Component, run->End, y, x, y);
+      }
+
+    // Vertical boundaries: left side downwards, right side upwards
+    this->AddSegment(run->Component, run->Begin, y, run->Begin, y + 1);
+    this->AddSegment(run->Component, run->End, y + 1, run->End, y);
+    }
+
+  // The components of the previous row which do not reach this row are
+  // complete
+  ++m_CurrentMark;
+  for (typename RunListType::iterator run = runs.begin(); run != runs.end(); ++run)
+    {
+    run->Component = this->FindComponent(run->Component);
+    m_Marks[run->Component] = m_CurrentMark;
+    }
+  for (typename RunListType::const_iterator prev = m_PreviousRuns.begin(); prev != m_PreviousRuns.end(); ++prev)
+    {
+    const ComponentType component = this->FindComponent(prev->Component);
+    if (m_Marks[component] != m_CurrentMark)
+      {
+      m_Marks[component] = m_CurrentMark;
+      m_CompleteComponents.push_back(Component());
+      m_CompleteComponents.back().Label = m_Components[component].Label;
+      m_CompleteComponents.back().Segments.swap(m_Components[component].Segments);
+      m_FreeComponents.push_back(component);
+      }
+    }
+
+  // No run refers to the merged components anymore
+  for (typename std::vector<ComponentType>::const_iterator it = m_MergedComponents.begin();
+       it != m_MergedComponents.end(); ++it)
+    {
+    m_Parents[*it] = *it;
+    m_FreeComponents.push_back(*it);
+    }
+  m_MergedComponents.clear();
+
+  m_PreviousRuns.swap(runs);
+}
+
+template<class TInputImage>
+typename PersistentLabelImageVectorizationFilter<TInputImage>::ComponentType
+PersistentLabelImageVectorizationFilter<TInputImage>
+::NewComponent(LabelType label)
+{
+  ComponentType component;
+  if (m_FreeComponents.empty())
+    {
+    component = static_cast<ComponentType>(m_Components.size());
+    m_Components.push_back(Component());
+    m_Parents.push_back(component);
+    m_Marks.push_back(0);
+    }
+  else
+    {
+    component = m_FreeComponents.back();
+    m_FreeComponents.pop_back();
+    }
+  m_Components[component].Label = label;
+  return component;
+}
+
+template<class TInputImage>
+typename PersistentLabelImageVectorizationFilter<TInputImage>::ComponentType
+PersistentLabelImageVectorizationFilter<TInputImage>
+::FindComponent(ComponentType component)
+{
+  while (m_Parents[component] != component)
+    {
+    m_Parents[component] = m_Parents[m_Parents[component]];
+    component = m_Parents[component];
+    }
+  return component;
+}
+
+template<class TInputImage>
+void
+PersistentLabelImageVectorizationFilter<TInputImage>
+::MergeComponents(ComponentType component1, ComponentType component2)
+{
+  component1 = this->FindComponent(component1);
+  component2 = this->FindComponent(component2);
+  if (component1 == component2)
+    {
+    return;
+    }
+
+  // Keep the longest boundary in place
+  if (m_Components[component1].Segments.size() < m_Components[component2].Segments.size())
+    {
+    std::swap(component1, component2);
+    }
+  std::vector<Segment> & segments = m_Components[component1].Segments;
+  segments.insert(segments.end(), m_Components[component2].Segments.begin(), m_Components[component2].Segments.end());
+  std::vector<Segment>().swap(m_Components[component2].Segments);
+
+  m_Parents[component2] = component1;
+  m_MergedComponents.push_back(component2);
+}
+
+template<class TInputImage>
+void
+PersistentLabelImageVectorizationFilter<TInputImage>
+::AddSegment(ComponentType component, IndexValueType x0, IndexValueType y0, IndexValueType x1, IndexValueType y1)
+{
+  std::vector<Segment> & segments = m_Components[this->FindComponent(component)].Segments;
+
+  // Extend the last segment when collinear and contiguous
+  if (!segments.empty())
+    {
+    Segment & last = segments.back();
+    if (internal::Sign(last.X1 - last.X0) == internal::Sign(x1 - x0)
+        && internal::Sign(last.Y1 - last.Y0) == internal::Sign(y1 - y0))
+      {
+      if (last.X1 == x0 && last.Y1 == y0)
+        {
+        last.X1 = x1;
+        last.Y1 = y1;
+        return;
+        }
+      if (last.X0 == x1 && last.Y0 == y1)
+        {
+        last.X0 = x0;
+        last.Y0 = y0;
+        return;
+        }
+      }
+    }
+
+  Segment segment;
+  segment.X0 = x0;
+  segment.Y0 = y0;
+  segment.X1 = x1;
+  segment.Y1 = y1;
+  segments.push_back(segment);
+}
+
+template<class TInputImage>
+void
+PersistentLabelImageVectorizationFilter<TInputImage>
+::WriteCompleteComponents()
+{
+  if (m_CompleteComponents.empty())
+    {
+    return;
+    }
+
+  otb::Stopwatch chrono = otb::Stopwatch::StartNew();
+
+  std::vector<OGRGeometry *> geometries(m_CompleteComponents.size(), nullptr);
+
+  ThreadStruct str;
+  str.Filter = this;
+  str.Geometries = &geometries;
+
+  this->GetMultiThreader()->SetNumberOfThreads(
+    std::min(static_cast<unsigned int>(this->GetNumberOfThreads()), static_cast<unsigned int>(geometries.size())));
+  this->GetMultiThreader()->SetSingleMethod(this->ThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  const bool multiPolygons = wkbFlatten(m_OGRLayer.GetGeomType()) == wkbMultiPolygon;
+
+  OGRErr err = m_OGRLayer.ogr().StartTransaction();
+  if (err != OGRERR_NONE)
+    {
+    for (std::size_t i = 0; i < geometries.size(); ++i)
+      {
+      OGRGeometryFactory::destroyGeometry(geometries[i]);
+      }
+    itkExceptionMacro(<< "Unable to start transaction for OGR layer " << m_OGRLayer.ogr().GetName() << ".");
+    }
+
+  for (std::size_t i = 0; i < geometries.size(); ++i)
+    {
+    ogr::UniqueGeometryPtr geometry(geometries[i]);
+    if (multiPolygons && geometry)
+      {
+      OGRMultiPolygon * multiPolygon = new OGRMultiPolygon;
+      multiPolygon->addGeometryDirectly(geometry.release());
+      geometry.reset(multiPolygon);
+      }
+
+    OGRFeatureType feature(m_OGRLayer.GetLayerDefn());
+    feature.ogr().SetField(m_FieldName.c_str(), static_cast<int>(m_CompleteComponents[i].Label));
+    feature.SetGeometryDirectly(otb::move(geometry));
+    m_OGRLayer.CreateFeature(feature);
+    }
+
+  err = m_OGRLayer.ogr().CommitTransaction();
+  if (err != OGRERR_NONE)
+    {
+    itkExceptionMacro(<< "Unable to commit transaction for OGR layer " << m_OGRLayer.ogr().GetName() << ".");
+    }
+
+  m_NumberOfPolygons += m_CompleteComponents.size();
+  m_CompleteComponents.clear();
+
+  chrono.Stop();
+  otbMsgDebugMacro(<< "Writing " << geometries.size() << " polygons took " << chrono.GetElapsedMilliseconds() << " ms");
+}
+
+template<class TInputImage>
+OGRGeometry *
+PersistentLabelImageVectorizationFilter<TInputImage>
+::BuildPolygon(const Component & component) const
+{
+  const std::vector<Segment> & segments = component.Segments;
+  const std::size_t nbSegments = segments.size();
+
+  // Segments sorted by start corner, to find the ones leaving a corner
+  std::vector<std::size_t> order(nbSegments);
+  std::iota(order.begin(), order.end(), 0);
+  const internal::SegmentStartLess<Segment> less(segments);
+  std::sort(order.begin(), order.end(), less);
+
+  std::vector<bool> used(nbSegments, false);
+
+  typedef std::pair<IndexValueType, IndexValueType> CornerType;
+  std::vector<std::vector<CornerType> > rings;
+  std::vector<double> areas;
+
+  std::vector<std::size_t> traced;
+  for (std::size_t start = 0; start < nbSegments; ++start)
+    {
+    if (used[start])
+      {
+      continue;
+      }
+
+    // Follow the boundary until back to the first segment. Where the
+    // component touches itself by a corner, turn right so that the
+    // diagonal pixels stay joined and the rings do not cross.
+    traced.clear();
+    std::size_t current = start;
+    do
+      {
+      used[current] = true;
+      traced.push_back(current);
+
+      const Segment & segment = segments[current];
+      const int dx = internal::Sign(segment.X1 - segment.X0);
+      const int dy = internal::Sign(segment.Y1 - segment.Y0);
+
+      // First segment leaving the end corner
+      std::size_t lo = 0;
+      std::size_t hi = nbSegments;
+      while (lo < hi)
+        {
+        const std::size_t mid = (lo + hi) / 2;
+        const Segment & candidate = segments[order[mid]];
+        if (candidate.Y0 < segment.Y1 || (candidate.Y0 == segment.Y1 && candidate.X0 < segment.X1))
+          {
+          lo = mid + 1;
+          }
+        else
+          {
+          hi = mid;
+          }
+        }
+
+      std::size_t next = nbSegments;
+      for (std::size_t k = lo;
+           k < nbSegments && segments[order[k]].Y0 == segment.Y1 && segments[order[k]].X0 == segment.X1; ++k)
+        {
+        const Segment & candidate = segments[order[k]];
+        if (next == nbSegments
+            || (internal::Sign(candidate.X1 - candidate.X0) == -dy && internal::Sign(candidate.Y1 - candidate.Y0) == dx))
+          {
+          next = order[k];
+          }
+        }
+
+      // Open boundary: should not happen, the ring is dropped
+      if (next == nbSegments || (used[next] && next != start))
+        {
+        traced.clear();
+        break;
+        }
+      current = next;
+      }
+    while (current != start);
+
+    if (traced.empty())
+      {
+      continue;
+      }
+
+    // Keep the corners where the direction changes
+    rings.push_back(std::vector<CornerType>());
+    std::vector<CornerType> & ring = rings.back();
+    double area = 0.;
+    for (std::size_t i = 0; i < traced.size(); ++i)
+      {
+      const Segment & segment = segments[traced[i]];
+      const Segment & previous = segments[traced[i == 0 ? traced.size() - 1 : i - 1]];
+      if (internal::Sign(segment.X1 - segment.X0) != internal::Sign(previous.X1 - previous.X0)
+          || internal::Sign(segment.Y1 - segment.Y0) != internal::Sign(previous.Y1 - previous.Y0))
+        {
+        ring.push_back(CornerType(segment.X0, segment.Y0));
+        }
+      area += static_cast<double>(segment.X0) * segment.Y1 - static_cast<double>(segment.X1) * segment.Y0;
+      }
+    areas.push_back(area / 2.);
+    }
+
+  if (rings.empty())
+    {
+    return nullptr;
+    }
+
+  // The exterior ring turns the other way round than the holes
+  const std::size_t exterior = std::min_element(areas.begin(), areas.end()) - areas.begin();
+  std::swap(rings[0], rings[exterior]);
+
+  const IndexType origin = m_LargestRegion.GetIndex();
+  OGRPolygon * polygon = new OGRPolygon;
+  for (std::size_t r = 0; r < rings.size(); ++r)
+    {
+    const std::vector<CornerType> & corners = rings[r];
+    OGRLinearRing * ring = new OGRLinearRing;
+    ring->setNumPoints(static_cast<int>(corners.size()) + 1);
+    for (std::size_t i = 0; i <= corners.size(); ++i)
+      {
+      const CornerType & corner = corners[i % corners.size()];
+      ring->setPoint(static_cast<int>(i),
+                     m_CornerOrigin[0] + (corner.first - origin[0]) * m_Spacing[0],
+                     m_CornerOrigin[1] + (corner.second - origin[1]) * m_Spacing[1]);
+      }
+    polygon->addRingDirectly(ring);
+    }
+
+  return polygon;
+}
+
+template<class TInputImage>
+ITK_THREAD_RETURN_TYPE
+PersistentLabelImageVectorizationFilter<TInputImage>
+::ThreaderCallback(void *arg)
+{
+  const unsigned int threadId = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->ThreadID;
+  const unsigned int threadCount = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->NumberOfThreads;
+  ThreadStruct * str = (ThreadStruct *) (((itk::MultiThreader::ThreadInfoStruct *) (arg))->UserData);
+
+  // Interleave the components, so that the large ones are spread over
+  // the threads
+  const std::vector<Component> & components = str->Filter->m_CompleteComponents;
+  for (std::size_t i = threadId; i < components.size(); i += threadCount)
+    {
+    (*str->Geometries)[i] = str->Filter->BuildPolygon(components[i]);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template<class TInputImage>
+void
+PersistentLabelImageVectorizationFilter<TInputImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "FieldName: " << m_FieldName << std::endl;
+  os << indent << "BackgroundValue: " << static_cast<typename itk::NumericTraits<LabelType>::PrintType>(m_BackgroundValue)
+     << std::endl;
+  os << indent << "UseBackgroundValue: " << m_UseBackgroundValue << std::endl;
+  os << indent << "BatchSize: " << m_BatchSize << std::endl;
+  os << indent << "NumberOfPolygons: " << m_NumberOfPolygons << std::endl;
+}
+
+} // end namespace otb
+
+#endif
@@ -32,4 +32,7 @@ void RegisterTests()
   REGISTER_TEST(otbLabelImageRegionPruningFilter);
   REGISTER_TEST(otbLabelImageRegionMergingFilter);
   REGISTER_TEST(otbLabelMapToVectorDataFilter);
+  REGISTER_TEST(otbRegionAdjacencyGraph);
+  REGISTER_TEST(otbRegionMergingEquivalence);
+  REGISTER_TEST(otbStreamingLabelImageVectorizationFilter);
 }
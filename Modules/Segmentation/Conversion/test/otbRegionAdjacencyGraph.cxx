@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "otbRegionAdjacencyGraph.h"
+#include "otbImage.h"
+#include "otbExtractROI.h"
+
+#include <cmath>
+
+int otbRegionAdjacencyGraph(int itkNotUsed(argc), char * itkNotUsed(argv) [])
+{
+  typedef unsigned int                          LabelType;
+  typedef otb::Image<LabelType, 2>              LabelImageType;
+  typedef otb::Image<float, 2>                  SpectralImageType;
+  typedef otb::ExtractROI<LabelType, LabelType> LabelExtractType;
+  typedef otb::ExtractROI<float, float>         SpectralExtractType;
+  typedef otb::RegionAdjacencyGraph<LabelType>  GraphType;
+
+  // Label and spectral images
+  //   1 1 2 2
+  //   1 3 3 2
+  //   4 4 3 2
+  const LabelType labels[12] = {1, 1, 2, 2, 1, 3, 3, 2, 4, 4, 3, 2};
+  const float     values[12] = {1, 1, 5, 5, 1, 9, 9, 5, 2, 2, 9, 5};
+
+  LabelImageType::RegionType region;
+  region.SetIndex(0, 0);
+  region.SetIndex(1, 0);
+  region.SetSize(0, 4);
+  region.SetSize(1, 3);
+
+  LabelImageType::Pointer labelImage = LabelImageType::New();
+  labelImage->SetRegions(region);
+  labelImage->Allocate();
+  SpectralImageType::Pointer spectralImage = SpectralImageType::New();
+  spectralImage->SetRegions(region);
+  spectralImage->Allocate();
+
+  LabelImageType::IndexType index;
+  for (index[1] = 0; index[1] < 3; ++index[1])
+    {
+    for (index[0] = 0; index[0] < 4; ++index[0])
+      {
+      labelImage->SetPixel(index, labels[index[1] * 4 + index[0]]);
+      spectralImage->SetPixel(index, values[index[1] * 4 + index[0]]);
+      }
+    }
+
+  // Accumulate two tiles of two columns, the label tiles being extended
+  // with one column
+  GraphType::Pointer graph = GraphType::New();
+  for (unsigned int tile = 0; tile < 2; ++tile)
+    {
+    LabelExtractType::Pointer labelExtract = LabelExtractType::New();
+    labelExtract->SetInput(labelImage);
+    labelExtract->SetStartX(2 * tile);
+    labelExtract->SetSizeX(tile == 0 ? 3 : 2);
+    labelExtract->SetSizeY(3);
+    labelExtract->Update();
+
+    SpectralExtractType::Pointer spectralExtract = SpectralExtractType::New();
+    spectralExtract->SetInput(spectralImage);
+    spectralExtract->SetStartX(2 * tile);
+    spectralExtract->SetSizeX(2);
+    spectralExtract->SetSizeY(3);
+    spectralExtract->Update();
+
+    graph->AddLabelImage(labelExtract->GetOutput(), spectralExtract->GetOutput(),
+                         spectralExtract->GetOutput()->GetLargestPossibleRegion());
+    }
+  graph->BuildAdjacency();
+
+  if (graph->GetNumberOfLabels() != 5 || graph->GetNumberOfRegions() != 4)
+    {
+    std::cerr << "Wrong number of labels or regions: " << graph->GetNumberOfLabels()
+              << " " << graph->GetNumberOfRegions() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (graph->GetRegionSize(2) != 4 || graph->GetRegionMean(3, 0) != 9.)
+    {
+    std::cerr << "Wrong statistics of the regions" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  GraphType::LabelListType adjacentRegions;
+  graph->GetAdjacentRegions(3, adjacentRegions);
+  if (adjacentRegions.size() != 3 || adjacentRegions[0] != 1 || adjacentRegions[1] != 2 || adjacentRegions[2] != 4)
+    {
+    std::cerr << "Wrong adjacency of region 3" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The candidates of lowest priority are popped first, and the
+  // candidates of merged regions are discarded
+  graph->PushCandidate(4, 2.);
+  graph->PushCandidate(3, 3.);
+  graph->PushCandidate(1, 3.);
+
+  GraphType::LabelListType candidates;
+  if (!graph->PopCandidates(candidates) || candidates.size() != 1 || candidates[0] != 4)
+    {
+    std::cerr << "Wrong first candidates" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (graph->MergeRegions(4, 1) != 1 || graph->GetNumberOfRegions() != 3 || graph->GetRegionSize(4) != 5
+      || std::abs(graph->GetRegionMean(4, 0) - 7. / 5.) > 1e-12)
+    {
+    std::cerr << "Wrong merged region" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  graph->GetAdjacentRegions(4, adjacentRegions);
+  if (adjacentRegions.size() != 2 || adjacentRegions[0] != 2 || adjacentRegions[1] != 3)
+    {
+    std::cerr << "Wrong adjacency of the merged region" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (!graph->PopCandidates(candidates) || candidates.size() != 1 || candidates[0] != 3
+      || graph->PopCandidates(candidates))
+    {
+    std::cerr << "Wrong last candidates" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  graph->MergeRegions(3, 2);
+
+  GraphType::LabelListType newLabels;
+  graph->GetConsecutiveRegionLabels(newLabels);
+  const LabelType expectedLabels[5] = {0, 1, 2, 2, 1};
+  for (unsigned int label = 0; label < 5; ++label)
+    {
+    if (newLabels[label] != expectedLabels[label])
+      {
+      std::cerr << "Wrong new label for " << label << ": " << newLabels[label] << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
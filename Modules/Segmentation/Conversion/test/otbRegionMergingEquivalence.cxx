@@ -0,0 +1,515 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbRegionAdjacencyGraph.h"
+#include "otbLabelImageRegionMergingFilter.h"
+#include "otbLabelImageRegionPruningFilter.h"
+#include "otbImage.h"
+#include "otbVectorImage.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace
+{
+
+typedef unsigned int                   LabelType;
+typedef std::vector<LabelType>         LabelListType;
+typedef std::vector<float>             SpectralListType;
+typedef std::vector<std::set<LabelType> > AdjacencyMapType;
+
+const unsigned int Width = 40;
+const unsigned int Height = 30;
+const unsigned int NbComponents = 2;
+
+/** Random label image: Voronoi cells with shuffled labels, some labels
+ * being left unused, and single pixel regions. The spectral values are
+ * a random value per label plus some noise. */
+void GenerateImages(unsigned int seed, LabelListType & labels, SpectralListType & values)
+{
+  std::mt19937 generator(seed);
+  std::uniform_int_distribution<unsigned int> xDistribution(0, Width - 1);
+  std::uniform_int_distribution<unsigned int> yDistribution(0, Height - 1);
+  std::uniform_real_distribution<float> valueDistribution(0.f, 50.f);
+  std::uniform_real_distribution<float> noiseDistribution(0.f, 2.f);
+
+  const unsigned int nbCells = 120;
+  const unsigned int nbSingles = 30;
+
+  LabelListType availableLabels;
+  for (LabelType label = 1; label <= 2 * (nbCells + nbSingles); ++label)
+    {
+    availableLabels.push_back(label);
+    }
+  std::shuffle(availableLabels.begin(), availableLabels.end(), generator);
+
+  std::vector<unsigned int> cellX(nbCells), cellY(nbCells);
+  for (unsigned int cell = 0; cell < nbCells; ++cell)
+    {
+    cellX[cell] = xDistribution(generator);
+    cellY[cell] = yDistribution(generator);
+    }
+
+  labels.resize(Width * Height);
+  for (unsigned int y = 0; y < Height; ++y)
+    {
+    for (unsigned int x = 0; x < Width; ++x)
+      {
+      unsigned int nearestCell = 0;
+      unsigned int nearestDistance = std::numeric_limits<unsigned int>::max();
+      for (unsigned int cell = 0; cell < nbCells; ++cell)
+        {
+        const int dx = static_cast<int>(x) - static_cast<int>(cellX[cell]);
+        const int dy = static_cast<int>(y) - static_cast<int>(cellY[cell]);
+        const unsigned int distance = dx * dx + dy * dy;
+        if (distance < nearestDistance)
+          {
+          nearestDistance = distance;
+          nearestCell = cell;
+          }
+        }
+      labels[y * Width + x] = availableLabels[nearestCell];
+      }
+    }
+  for (unsigned int single = 0; single < nbSingles; ++single)
+    {
+    labels[yDistribution(generator) * Width + xDistribution(generator)] = availableLabels[nbCells + single];
+    }
+
+  std::map<LabelType, std::vector<float> > labelValues;
+  values.resize(Width * Height * NbComponents);
+  for (unsigned int pixel = 0; pixel < Width * Height; ++pixel)
+    {
+    std::vector<float> & labelValue = labelValues[labels[pixel]];
+    if (labelValue.empty())
+      {
+      for (unsigned int comp = 0; comp < NbComponents; ++comp)
+        {
+        labelValue.push_back(valueDistribution(generator));
+        }
+      }
+    for (unsigned int comp = 0; comp < NbComponents; ++comp)
+      {
+      values[pixel * NbComponents + comp] = labelValue[comp] + noiseDistribution(generator);
+      }
+    }
+}
+
+/** Adjacency of the labels, over the whole image or, as the former
+ * adjacency maps, without the last row and column of the image */
+AdjacencyMapType ComputeAdjacency(const LabelListType & labels, bool skipLastRowAndColumn)
+{
+  const unsigned int lastX = skipLastRowAndColumn ? Width - 1 : Width;
+  const unsigned int lastY = skipLastRowAndColumn ? Height - 1 : Height;
+
+  AdjacencyMapType adjacency(*std::max_element(labels.begin(), labels.end()) + 1);
+  for (unsigned int y = 0; y < lastY; ++y)
+    {
+    for (unsigned int x = 0; x < lastX; ++x)
+      {
+      const LabelType label = labels[y * Width + x];
+      if (x + 1 < Width && labels[y * Width + x + 1] != label)
+        {
+        adjacency[label].insert(labels[y * Width + x + 1]);
+        adjacency[labels[y * Width + x + 1]].insert(label);
+        }
+      if (y + 1 < Height && labels[(y + 1) * Width + x] != label)
+        {
+        adjacency[label].insert(labels[(y + 1) * Width + x]);
+        adjacency[labels[(y + 1) * Width + x]].insert(label);
+        }
+      }
+    }
+  return adjacency;
+}
+
+/** Union of two labels, the canonical label being the smallest one */
+void Union(std::vector<LabelType> & canonicalLabels, LabelType label1, LabelType label2)
+{
+  while (canonicalLabels[label1] != label1)
+    {
+    label1 = canonicalLabels[label1];
+    }
+  while (canonicalLabels[label2] != label2)
+    {
+    label2 = canonicalLabels[label2];
+    }
+  if (label1 < label2)
+    {
+    canonicalLabels[label2] = label1;
+    }
+  else
+    {
+    canonicalLabels[label1] = label2;
+    }
+}
+
+/** Iterative merging or pruning of the former LabelImageRegionMergingFilter
+ * and LabelImageRegionPruningFilter: the adjacency is rebuilt from the
+ * relabeled image at each iteration, without the last row and column of
+ * the image, the modes are averaged in float, and the regions are
+ * renumbered consecutively, missing labels included. Returns the labels
+ * and the modes of the output pixels. */
+void ReferenceMerging(const LabelListType & inputLabels, const SpectralListType & values, bool pruning,
+                      double parameter, LabelListType & labels, SpectralListType & outputValues)
+{
+  labels = inputLabels;
+  AdjacencyMapType adjacency = ComputeAdjacency(labels, true);
+  LabelType regionCount = static_cast<LabelType>(adjacency.size() - 1);
+
+  std::vector<std::vector<float> > modes(regionCount + 1, std::vector<float>(NbComponents, 0.f));
+  std::vector<unsigned int> counts(regionCount + 1, 0);
+  for (unsigned int pixel = 0; pixel < labels.size(); ++pixel)
+    {
+    if (counts[labels[pixel]]++ == 0)
+      {
+      std::copy(&values[pixel * NbComponents], &values[(pixel + 1) * NbComponents], modes[labels[pixel]].begin());
+      }
+    }
+
+  for (unsigned int iterations = 0; ; ++iterations)
+    {
+    std::vector<LabelType> canonicalLabels(regionCount + 1);
+    for (LabelType label = 0; label <= regionCount; ++label)
+      {
+      canonicalLabels[label] = label;
+      }
+
+    unsigned int smallRegions = 0;
+    for (LabelType label = 1; label <= regionCount; ++label)
+      {
+      if (counts[label] == 0 || (pruning && counts[label] > parameter))
+        {
+        continue;
+        }
+      ++smallRegions;
+
+      LabelType nearestLabel = 0;
+      double nearestNorm2 = std::numeric_limits<float>::max();
+      for (std::set<LabelType>::const_iterator it = adjacency[label].begin(); it != adjacency[label].end(); ++it)
+        {
+        double norm2 = 0.;
+        for (unsigned int comp = 0; comp < NbComponents; ++comp)
+          {
+          const double e = pruning ? modes[label][comp] - modes[*it][comp]
+                                   : (modes[label][comp] - modes[*it][comp]) / parameter;
+          norm2 += e * e;
+          }
+        if (!pruning && norm2 < 0.25)
+          {
+          Union(canonicalLabels, label, *it);
+          }
+        if (pruning && norm2 < nearestNorm2)
+          {
+          nearestNorm2 = norm2;
+          nearestLabel = *it;
+          }
+        }
+      if (nearestLabel != 0)
+        {
+        Union(canonicalLabels, label, nearestLabel);
+        }
+      }
+
+    // Merge the modes and renumber the regions
+    std::vector<std::vector<float> > newModes(regionCount + 1, std::vector<float>(NbComponents, 0.f));
+    std::vector<unsigned int> newCounts(regionCount + 1, 0);
+    for (LabelType label = 1; label <= regionCount; ++label)
+      {
+      LabelType canonicalLabel = label;
+      while (canonicalLabels[canonicalLabel] != canonicalLabel)
+        {
+        canonicalLabel = canonicalLabels[canonicalLabel];
+        }
+      canonicalLabels[label] = canonicalLabel;
+      for (unsigned int comp = 0; comp < NbComponents; ++comp)
+        {
+        newModes[canonicalLabel][comp] += counts[label] * modes[label][comp];
+        }
+      newCounts[canonicalLabel] += counts[label];
+      }
+
+    std::vector<LabelType> newLabels(regionCount + 1, 0);
+    LabelType newLabel = 0;
+    for (LabelType label = 1; label <= regionCount; ++label)
+      {
+      if (canonicalLabels[label] == label)
+        {
+        newLabels[label] = ++newLabel;
+        for (unsigned int comp = 0; comp < NbComponents; ++comp)
+          {
+          modes[newLabel][comp] = newModes[label][comp] / newCounts[label];
+          }
+        counts[newLabel] = newCounts[label];
+        }
+      }
+    for (unsigned int pixel = 0; pixel < labels.size(); ++pixel)
+      {
+      labels[pixel] = newLabels[canonicalLabels[labels[pixel]]];
+      }
+
+    const LabelType oldRegionCount = regionCount;
+    regionCount = newLabel;
+    if ((pruning ? smallRegions == 0 : oldRegionCount == regionCount) || iterations >= 10 || regionCount == 1)
+      {
+      break;
+      }
+    adjacency = ComputeAdjacency(labels, true);
+    }
+
+  outputValues.resize(labels.size() * NbComponents);
+  for (unsigned int pixel = 0; pixel < labels.size(); ++pixel)
+    {
+    std::copy(modes[labels[pixel]].begin(), modes[labels[pixel]].end(), &outputValues[pixel * NbComponents]);
+    }
+}
+
+/** Small regions merging LUT of the former LSMSSmallRegionsMerging
+ * application, on a single tile: for each size below minSize, the
+ * regions of that size are merged with the adjacent region of closest
+ * mean, the mean of the adjacent region being truncated. */
+LabelListType ReferenceSmallRegionsMerging(const LabelListType & labels, const SpectralListType & values, unsigned int minSize)
+{
+  const LabelType regionCount = *std::max_element(labels.begin(), labels.end());
+
+  std::vector<unsigned int> counts(regionCount + 1, 0);
+  std::vector<double> sums((regionCount + 1) * NbComponents, 0.);
+  for (unsigned int pixel = 0; pixel < labels.size(); ++pixel)
+    {
+    ++counts[labels[pixel]];
+    for (unsigned int comp = 0; comp < NbComponents; ++comp)
+      {
+      sums[labels[pixel] * NbComponents + comp] += values[pixel * NbComponents + comp];
+      }
+    }
+
+  LabelListType lut(regionCount + 1);
+  for (LabelType label = 0; label <= regionCount; ++label)
+    {
+    lut[label] = label;
+    }
+
+  for (unsigned int size = 1; size < minSize; ++size)
+    {
+    LabelListType lutTmp(lut);
+
+    // Adjacency of the regions of that size
+    std::map<LabelType, std::set<LabelType> > adjacency;
+    const AdjacencyMapType labelAdjacency = ComputeAdjacency(labels, false);
+    for (LabelType label = 0; label <= regionCount; ++label)
+      {
+      for (std::set<LabelType>::const_iterator it = labelAdjacency[label].begin(); it != labelAdjacency[label].end(); ++it)
+        {
+        if (lut[label] != lut[*it] && counts[lut[label]] == size)
+          {
+          adjacency[lut[label]].insert(lut[*it]);
+          }
+        }
+      }
+
+    for (std::map<LabelType, std::set<LabelType> >::const_iterator it = adjacency.begin(); it != adjacency.end(); ++it)
+      {
+      const LabelType label = it->first;
+      LabelType nearestLabel = label;
+      double nearestError = std::numeric_limits<double>::max();
+      for (std::set<LabelType>::const_iterator adjIt = it->second.begin(); adjIt != it->second.end(); ++adjIt)
+        {
+        double error = 0.;
+        for (unsigned int comp = 0; comp < NbComponents; ++comp)
+          {
+          const double mean = sums[label * NbComponents + comp] / counts[label];
+          const int adjMean = static_cast<int>(sums[*adjIt * NbComponents + comp] / counts[*adjIt]);
+          error += (mean - adjMean) * (mean - adjMean);
+          }
+        if (error < nearestError)
+          {
+          nearestError = error;
+          nearestLabel = *adjIt;
+          }
+        }
+      Union(lutTmp, label, nearestLabel);
+      }
+
+    for (LabelType label = 1; label <= regionCount; ++label)
+      {
+      LabelType canonicalLabel = label;
+      while (lutTmp[canonicalLabel] != canonicalLabel)
+        {
+        canonicalLabel = lutTmp[canonicalLabel];
+        }
+      lut[label] = canonicalLabel;
+      if (counts[label] != 0 && canonicalLabel != label)
+        {
+        counts[canonicalLabel] += counts[label];
+        counts[label] = 0;
+        for (unsigned int comp = 0; comp < NbComponents; ++comp)
+          {
+          sums[canonicalLabel * NbComponents + comp] += sums[label * NbComponents + comp];
+          }
+        }
+      }
+    }
+
+  return lut;
+}
+
+/** Compare the outputs of a filter with the expected labels and modes */
+template <class TFilter>
+bool CheckOutputs(TFilter * filter, const LabelListType & expectedLabels, const SpectralListType & expectedValues,
+                  const char * name, unsigned int seed)
+{
+  typedef typename TFilter::OutputLabelImageType     OutputLabelImageType;
+  typedef typename TFilter::OutputClusteredImageType OutputClusteredImageType;
+
+  itk::ImageRegionConstIterator<OutputLabelImageType> labelIt(filter->GetLabelOutput(),
+                                                             filter->GetLabelOutput()->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<OutputClusteredImageType> clusteredIt(filter->GetClusteredOutput(),
+                                                                     filter->GetClusteredOutput()->GetLargestPossibleRegion());
+  unsigned int pixel = 0;
+  for (labelIt.GoToBegin(), clusteredIt.GoToBegin(); !labelIt.IsAtEnd(); ++labelIt, ++clusteredIt, ++pixel)
+    {
+    if (labelIt.Get() != expectedLabels[pixel])
+      {
+      std::cerr << name << ", seed " << seed << ": label " << labelIt.Get() << " instead of "
+                << expectedLabels[pixel] << " at pixel " << pixel << std::endl;
+      return false;
+      }
+    for (unsigned int comp = 0; comp < NbComponents; ++comp)
+      {
+      if (std::abs(clusteredIt.Get()[comp] - expectedValues[pixel * NbComponents + comp]) > 1e-3)
+        {
+        std::cerr << name << ", seed " << seed << ": mode " << clusteredIt.Get()[comp] << " instead of "
+                  << expectedValues[pixel * NbComponents + comp] << " at pixel " << pixel << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+/** Check the region merging based on the RegionAdjacencyGraph against the
+ * former implementations based on adjacency maps, on random label images */
+int otbRegionMergingEquivalence(int itkNotUsed(argc), char * itkNotUsed(argv) [])
+{
+  typedef otb::Image<LabelType, 2>                                              LabelImageType;
+  typedef otb::VectorImage<float, 2>                                            SpectralImageType;
+  typedef otb::LabelImageRegionMergingFilter<LabelImageType, SpectralImageType> MergingFilterType;
+  typedef otb::LabelImageRegionPruningFilter<LabelImageType, SpectralImageType> PruningFilterType;
+  typedef otb::RegionAdjacencyGraph<LabelType>                                  GraphType;
+
+  const double       rangeBandwidth = 15.;
+  const unsigned int minRegionSize = 5;
+  const unsigned int minSize = 8;
+
+  LabelImageType::RegionType region;
+  region.SetIndex(0, 0);
+  region.SetIndex(1, 0);
+  region.SetSize(0, Width);
+  region.SetSize(1, Height);
+
+  bool success = true;
+  for (unsigned int seed = 0; seed < 20; ++seed)
+    {
+    LabelListType    labels;
+    SpectralListType values;
+    GenerateImages(seed, labels, values);
+
+    LabelImageType::Pointer labelImage = LabelImageType::New();
+    labelImage->SetRegions(region);
+    labelImage->Allocate();
+    SpectralImageType::Pointer spectralImage = SpectralImageType::New();
+    spectralImage->SetRegions(region);
+    spectralImage->SetNumberOfComponentsPerPixel(NbComponents);
+    spectralImage->Allocate();
+
+    itk::ImageRegionIterator<LabelImageType>    labelIt(labelImage, region);
+    itk::ImageRegionIterator<SpectralImageType> spectralIt(spectralImage, region);
+    SpectralImageType::PixelType spectralPixel(NbComponents);
+    unsigned int pixel = 0;
+    for (labelIt.GoToBegin(), spectralIt.GoToBegin(); !labelIt.IsAtEnd(); ++labelIt, ++spectralIt, ++pixel)
+      {
+      labelIt.Set(labels[pixel]);
+      for (unsigned int comp = 0; comp < NbComponents; ++comp)
+        {
+        spectralPixel[comp] = values[pixel * NbComponents + comp];
+        }
+      spectralIt.Set(spectralPixel);
+      }
+
+    LabelListType    expectedLabels;
+    SpectralListType expectedValues;
+
+    // Region merging
+    MergingFilterType::Pointer merging = MergingFilterType::New();
+    merging->SetInputLabelImage(labelImage);
+    merging->SetInputSpectralImage(spectralImage);
+    merging->SetRangeBandwidth(rangeBandwidth);
+    merging->Update();
+
+    ReferenceMerging(labels, values, false, rangeBandwidth, expectedLabels, expectedValues);
+    success = CheckOutputs(merging.GetPointer(), expectedLabels, expectedValues, "Merging", seed) && success;
+
+    // Region pruning
+    PruningFilterType::Pointer pruning = PruningFilterType::New();
+    pruning->SetInputLabelImage(labelImage);
+    pruning->SetInputSpectralImage(spectralImage);
+    pruning->SetMinRegionSize(minRegionSize);
+    pruning->Update();
+
+    ReferenceMerging(labels, values, true, minRegionSize, expectedLabels, expectedValues);
+    success = CheckOutputs(pruning.GetPointer(), expectedLabels, expectedValues, "Pruning", seed) && success;
+
+    // Small regions merging of LSMSSmallRegionsMerging
+    GraphType::Pointer graph = GraphType::New();
+    graph->AddLabelImage(labelImage.GetPointer(), spectralImage.GetPointer(), region);
+    graph->BuildAdjacency();
+    graph->MergeSmallRegions(minSize, [&graph](LabelType label, LabelType adjLabel)
+      {
+      double error = 0.;
+      for (unsigned int comp = 0; comp < NbComponents; ++comp)
+        {
+        const double mean = graph->GetRegionMean(label, comp);
+        const int    adjMean = static_cast<int>(graph->GetRegionMean(adjLabel, comp));
+        error += (mean - adjMean) * (mean - adjMean);
+        }
+      return error;
+      });
+
+    GraphType::LabelListType lut;
+    graph->GetRegionLabels(lut);
+    const LabelListType expectedLut = ReferenceSmallRegionsMerging(labels, values, minSize);
+    if (lut != expectedLut)
+      {
+      std::cerr << "Small regions merging, seed " << seed << ": wrong look-up table" << std::endl;
+      success = false;
+      }
+    }
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#include "otbStreamingLabelImageVectorizationFilter.h"
+#include "otbLabelImageToOGRDataSourceFilter.h"
+#include "otbImage.h"
+#include "otbImageFileReader.h"
+#include "ogr_geometry.h"
+
+#include <cmath>
+#include <map>
+
+namespace
+{
+
+// Total area of the features of each label
+std::map<int, double> AreaPerLabel(const otb::ogr::Layer & layer, const char * fieldName)
+{
+  std::map<int, double> areas;
+  for (otb::ogr::Layer::const_iterator featIt = layer.begin(); featIt != layer.end(); ++featIt)
+    {
+    const OGRGeometry * geometry = featIt->GetGeometry();
+    const double area = wkbFlatten(geometry->getGeometryType()) == wkbMultiPolygon
+      ? static_cast<const OGRMultiPolygon *>(geometry)->get_Area()
+      : static_cast<const OGRPolygon *>(geometry)->get_Area();
+    areas[featIt->ogr().GetFieldAsInteger(fieldName)] += area;
+    }
+  return areas;
+}
+
+}
+
+int otbStreamingLabelImageVectorizationFilter(int argc, char * argv[])
+{
+  if (argc != 3)
+    {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " inputLabelImageFile nbLinesPerStrip" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const char * infname = argv[1];
+  const unsigned int nbLines = atoi(argv[2]);
+
+  const unsigned int Dimension = 2;
+  typedef unsigned short LabelType;
+  typedef otb::Image<LabelType, Dimension> InputLabelImageType;
+
+  typedef otb::StreamingLabelImageVectorizationFilter<InputLabelImageType> FilterType;
+  typedef otb::LabelImageToOGRDataSourceFilter<InputLabelImageType>        ReferenceFilterType;
+  typedef otb::ImageFileReader<InputLabelImageType>                        LabelImageReaderType;
+
+  LabelImageReaderType::Pointer reader = LabelImageReaderType::New();
+  reader->SetFileName(infname);
+
+  // Reference: GDALPolygonize on the whole image
+  ReferenceFilterType::Pointer reference = ReferenceFilterType::New();
+  reference->SetInput(reader->GetOutput());
+  reference->Update();
+  otb::ogr::Layer referenceLayer = reference->GetOutput()->GetLayerChecked(0);
+
+  otb::ogr::DataSource::Pointer ogrDS = otb::ogr::DataSource::New();
+  otb::ogr::Layer layer = ogrDS->CreateLayer("Layer", nullptr, wkbPolygon);
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(reader->GetOutput());
+  filter->SetOGRLayer(layer);
+  filter->SetBatchSize(50);
+  filter->GetStreamer()->SetNumberOfLinesStrippedStreaming(nbLines);
+  filter->Update();
+
+  const int nbReference = referenceLayer.GetFeatureCount(true);
+  if (static_cast<int>(filter->GetNumberOfPolygons()) != nbReference || layer.GetFeatureCount(true) != nbReference)
+    {
+    std::cerr << "Got " << filter->GetNumberOfPolygons() << " polygons, expected " << nbReference << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const std::map<int, double> areas = AreaPerLabel(layer, "DN");
+  const std::map<int, double> referenceAreas = AreaPerLabel(referenceLayer, "DN");
+  if (areas.size() != referenceAreas.size())
+    {
+    std::cerr << "Got " << areas.size() << " labels, expected " << referenceAreas.size() << std::endl;
+    return EXIT_FAILURE;
+    }
+  for (std::map<int, double>::const_iterator it = referenceAreas.begin(); it != referenceAreas.end(); ++it)
+    {
+    std::map<int, double>::const_iterator found = areas.find(it->first);
+    if (found == areas.end() || std::abs(found->second - it->second) > 1e-6 * std::abs(it->second))
+      {
+      std::cerr << "Wrong area for label " << it->first << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,274 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbLSMSTileSegmentationImageFilter_h
+#define otbLSMSTileSegmentationImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkConnectedComponentFunctorImageFilter.h"
+#include "otbImage.h"
+
+#include <cmath>
+#include <map>
+#include <vector>
+
+namespace otb
+{
+
+namespace Functor
+{
+
+/** \class LSMSConnectionCriterion
+ *  \brief Connects two pixels of a filtered mean-shift image whose range
+ *  (and optionally spatial) distances are below the given radii
+ *
+ *  The pixels hold the range components, followed by the two spatial
+ *  components when UseSpatial is on.
+ *
+ * \ingroup OTBMeanShift
+ */
+template <class TPixel>
+class LSMSConnectionCriterion
+{
+public:
+  LSMSConnectionCriterion()
+    : m_NumberOfRangeComponents(1), m_RangeRadius(15.), m_SpatialRadius(5.), m_UseSpatial(false)
+  {}
+
+  void SetNumberOfRangeComponents(unsigned int nb) { m_NumberOfRangeComponents = nb; }
+  void SetRangeRadius(double radius) { m_RangeRadius = radius; }
+  void SetSpatialRadius(double radius) { m_SpatialRadius = radius; }
+  void SetUseSpatial(bool flag) { m_UseSpatial = flag; }
+
+  bool operator!=(const LSMSConnectionCriterion & other) const
+  {
+    return m_NumberOfRangeComponents != other.m_NumberOfRangeComponents || m_RangeRadius != other.m_RangeRadius
+      || m_SpatialRadius != other.m_SpatialRadius || m_UseSpatial != other.m_UseSpatial;
+  }
+
+  bool operator==(const LSMSConnectionCriterion & other) const
+  {
+    return !(*this != other);
+  }
+
+  inline bool operator()(const TPixel & p1, const TPixel & p2) const
+  {
+    double range = 0.;
+    for (unsigned int i = 0; i < m_NumberOfRangeComponents; ++i)
+      {
+      const double d = static_cast<double>(p1[i]) - static_cast<double>(p2[i]);
+      range += d * d;
+      }
+    if (!(std::sqrt(range) < m_RangeRadius))
+      {
+      return false;
+      }
+    if (!m_UseSpatial)
+      {
+      return true;
+      }
+    const double dx = static_cast<double>(p1[m_NumberOfRangeComponents]) - static_cast<double>(p2[m_NumberOfRangeComponents]);
+    const double dy = static_cast<double>(p1[m_NumberOfRangeComponents + 1])
+      - static_cast<double>(p2[m_NumberOfRangeComponents + 1]);
+    return std::sqrt(dx * dx + dy * dy) < m_SpatialRadius;
+  }
+
+private:
+  unsigned int m_NumberOfRangeComponents;
+  double       m_RangeRadius;
+  double       m_SpatialRadius;
+  bool         m_UseSpatial;
+};
+
+} // end namespace Functor
+
+/** \class LSMSTileSegmentationImageFilter
+ *  \brief Exact tile-wise segmentation step of the Large-Scale Mean-Shift
+ *  workflow, processed in memory
+ *
+ *  The input, a VectorImage, is the filtered range image produced by the
+ *  mean-shift smoothing without mode search, and the optional input
+ *  (SetSpatialInput()) is the filtered spatial image. Neighbor pixels whose range distance is
+ *  below RangeRadius, and whose spatial distance is below SpatialRadius
+ *  when the spatial image is set, are grouped in the same segment.
+ *
+ *  The image is split into tiles of TileSize pixels, each segmented with
+ *  one extra row and column so that the segments crossing the tile
+ *  borders can be merged. The labels are the same as those of the
+ *  historical tile-wise LSMSSegmentation application, whatever the
+ *  streaming and the number of threads:
+ *
+ *  - In GenerateOutputInformation(), the tiles are segmented concurrently,
+ *    a few tiles at a time. Only the labels along the tile borders and the
+ *    segment sizes are kept. The label equivalences across the tile
+ *    borders are resolved with a union-find, and the segments smaller
+ *    than MinimumRegionSize are set to 0.
+ *  - In GenerateData(), the tiles overlapping the requested region are
+ *    segmented again concurrently and relabeled. The tiles are cached
+ *    between two consecutive requests, so that streaming by strips
+ *    segments each tile only once.
+ *
+ *  No temporary file is written.
+ *
+ * \ingroup Streamed
+ * \ingroup MultiThreaded
+ *
+ * \ingroup OTBMeanShift
+ */
+template <class TInputImage, class TLabelImage>
+class ITK_EXPORT LSMSTileSegmentationImageFilter :
+    public itk::ImageToImageFilter<TInputImage, TLabelImage>
+{
+public:
+  /** Standard class typedef */
+  typedef LSMSTileSegmentationImageFilter                  Self;
+  typedef itk::ImageToImageFilter<TInputImage, TLabelImage> Superclass;
+  typedef itk::SmartPointer<Self>                          Pointer;
+  typedef itk::SmartPointer<const Self>                    ConstPointer;
+
+  /** Helper typedefs */
+  typedef TInputImage                          InputImageType;
+  typedef typename InputImageType::PixelType   InputPixelType;
+  typedef TLabelImage                          LabelImageType;
+  typedef typename LabelImageType::PixelType   LabelPixelType;
+  typedef typename InputImageType::RegionType  RegionType;
+  typedef typename InputImageType::IndexType   IndexType;
+  typedef typename InputImageType::SizeType    SizeType;
+
+  typedef Functor::LSMSConnectionCriterion<InputPixelType> FunctorType;
+  typedef itk::ConnectedComponentFunctorImageFilter<InputImageType, LabelImageType, FunctorType,
+                                                    otb::Image<unsigned int> > ConnectedComponentFilterType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(LSMSTileSegmentationImageFilter, ImageToImageFilter);
+
+  /** Filtered spatial image (optional) */
+  void SetSpatialInput(const InputImageType * image);
+  const InputImageType * GetSpatialInput() const;
+
+  /** Maximum range distance between connected pixels (default 15) */
+  itkSetMacro(RangeRadius, double);
+  itkGetConstMacro(RangeRadius, double);
+
+  /** Maximum spatial distance between connected pixels, used with the
+   * spatial image (default 5) */
+  itkSetMacro(SpatialRadius, double);
+  itkGetConstMacro(SpatialRadius, double);
+
+  /** Segments smaller than this size are set to 0 (default 0) */
+  itkSetMacro(MinimumRegionSize, unsigned long);
+  itkGetConstMacro(MinimumRegionSize, unsigned long);
+
+  /** Size of the segmentation tiles (default 500x500) */
+  itkSetMacro(TileSize, SizeType);
+  itkGetConstReferenceMacro(TileSize, SizeType);
+
+  /** Number of segments before the removal of the small segments,
+   * available after UpdateOutputInformation() */
+  itkGetConstMacro(NumberOfSegments, unsigned long);
+
+protected:
+  LSMSTileSegmentationImageFilter();
+
+  ~LSMSTileSegmentationImageFilter() override {}
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+  void GenerateOutputInformation() override;
+
+  void GenerateInputRequestedRegion() override;
+
+  void GenerateData() override;
+
+private:
+  LSMSTileSegmentationImageFilter(const Self &) = delete;
+  void operator =(const Self&) = delete;
+
+  /** Labels of a tile along its borders, and sizes of its segments */
+  struct TileBorders
+  {
+    unsigned long NumberOfLabels;
+    std::vector<unsigned long>  Sizes;
+    std::vector<LabelPixelType> Top;
+    std::vector<LabelPixelType> Left;
+    std::vector<LabelPixelType> BottomMargin;
+    std::vector<LabelPixelType> RightMargin;
+  };
+
+  /** Tile region, with the extra row and column when extended */
+  RegionType GetTileRegion(unsigned int tile, bool extended) const;
+
+  /** Tiles overlapping a region, in row-major order */
+  std::vector<unsigned int> GetTiles(const RegionType & region) const;
+
+  /** Tiles overlapping a region and missing from the cache */
+  std::vector<unsigned int> GetMissingTiles(const RegionType & region) const;
+
+  /** Connected component labels of the extended tile, in raster order */
+  std::vector<LabelPixelType> SegmentTile(unsigned int tile) const;
+
+  /** First pass: label equivalences and segment sizes */
+  void ComputeLabelTable();
+
+  /** Segment the tiles concurrently, the input being buffered over them */
+  void ProcessTiles(const std::vector<unsigned int> & tiles, bool firstPass);
+
+  /** Segment a tile, then keep its borders (first pass) or relabel it
+   * into the cache */
+  void ProcessTile(unsigned int tile, bool firstPass);
+
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback(void *arg);
+
+  /** Internal structure used for passing data into the threading library */
+  struct ThreadStruct
+  {
+    Self *                            Filter;
+    const std::vector<unsigned int> * Tiles;
+    bool                              FirstPass;
+  };
+
+  double        m_RangeRadius;
+  double        m_SpatialRadius;
+  unsigned long m_MinimumRegionSize;
+  SizeType      m_TileSize;
+
+  unsigned int  m_NumberOfTiles[2];
+  unsigned long m_NumberOfSegments;
+
+  /** First pass results */
+  std::vector<TileBorders>   m_TileBorders;
+  std::vector<unsigned long> m_LabelOffsets;
+  std::vector<LabelPixelType> m_FinalLabels;
+  itk::TimeStamp             m_LabelTableTime;
+
+  /** Relabeled tiles (without their extra row and column) */
+  std::map<unsigned int, std::vector<LabelPixelType> > m_TileCache;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbLSMSTileSegmentationImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,570 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbLSMSTileSegmentationImageFilter_hxx
+#define otbLSMSTileSegmentationImageFilter_hxx
+
+#include "otbLSMSTileSegmentationImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "otbMacro.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace otb
+{
+
+template <class TInputImage, class TLabelImage>
+LSMSTileSegmentationImageFilter<TInputImage, TLabelImage>
+::LSMSTileSegmentationImageFilter()
+  : m_RangeRadius(15.),
+    m_SpatialRadius(5.),
+    m_MinimumRegionSize(0),
+    m_NumberOfSegments(0)
+{
+  m_TileSize.Fill(500);
+  m_NumberOfTiles[0] = 0;
+  m_NumberOfTiles[1] = 0;
+}
+
+template <class TInputImage, class TLabelImage>
+void
+LSMSTileSegmentationImageFilter<TInputImage, TLabelImage>
+::SetSpatialInput(const InputImageType * image)
+{
+  this->itk::ProcessObject::SetNthInput(1, const_cast<InputImageType *>(image));
+}
+
+template <class TInputImage, class TLabelImage>
+const typename LSMSTileSegmentationImageFilter<TInputImage, TLabelImage>::InputImageType *
+LSMSTileSegmentationImageFilter<TInputImage, TLabelImage>
+::GetSpatialInput() const
+{
+  if (this->GetNumberOfInputs() < 2)
+    {
+    return nullptr;
+    }
+  return static_cast<const InputImageType *>(this->itk::ProcessObject::GetInput(1));
+}
+
+template <class TInputImage, class TLabelImage>
+typename LSMSTileSegmentationImageFilter<TInputImage, TLabelImage>::RegionType
+LSMSTileSegmentationImageFilter<TInputImage, TLabelImage>
+::GetTileRegion(unsigned int tile, bool extended) const
+{
+  const RegionType largest = this->GetInput()->GetLargestPossibleRegion();
+  const unsigned int tileIndex[2] = {tile % m_NumberOfTiles[0], tile / m_NumberOfTiles[0]};
+
+  RegionType region;
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    region.SetIndex(dim, largest.GetIndex()[dim] + tileIndex[dim] * m_TileSize[dim]);
+    region.SetSize(dim, m_TileSize[dim] + (extended ? 1 : 0));
+    }
+  region.Crop(largest);
+  return region;
+}
+
+template <class TInputImage, class TLabelImage>
+std::vector<unsigned int>
+LSMSTileSegmentationImageFilter<TInputImage, TLabelImage>
+::GetTiles(const RegionType & region) const
+{
+  std::vector<unsigned int> tiles;
+  RegionType cropped = region;
+  const RegionType largest = this->GetInput()->GetLargestPossibleRegion();
+  if (cropped.GetNumberOfPixels() == 0 || !cropped.Crop(largest))
+    {
+    return tiles;
+    }
+
+  unsigned int first[2], last[2];
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    const long offset = cropped.GetIndex()[dim] - largest.GetIndex()[dim];
+    first[dim] = offset / m_TileSize[dim];
+    last[dim] = (offset + cropped.GetSize()[dim] - 1) / m_TileSize[dim];
+    }
+  for (unsigned int ty = first[1]; ty <= last[1]; ++ty)
+    {
+    for (unsigned int tx = first[0]; tx <= last[0]; ++tx)
+      {
+      tiles.push_back(ty * m_NumberOfTiles[0] + tx);
+      }
+    }
+  return tiles;
+}
+
+template <class TInputImage, class TLabelImage>
+std::vector<unsigned int>
+LSMSTileSegmentationImageFilter<TInputImage, TLabelImage>
+::GetMissingTiles(const RegionType & region) const
+{
+  std::vector<unsigned int> tiles = this->GetTiles(region);
+  tiles.erase(std::remove_if(tiles.begin(), tiles.end(), [this](unsigned int tile)
+    {
+    return m_TileCache.count(tile) > 0;
+    }), tiles.end());
+  return tiles;
+}
+
+template <class TInputImage, class TLabelImage>
+std::vector<typename LSMSTileSegmentationImageFilter<TInputImage, TLabelImage>::LabelPixelType>
+LSMSTileSegmentationImageFilter<TInputImage, TLabelImage>
+::SegmentTile(unsigned int tile) const
+{
+  const InputImageType * rangeImage = this->GetInput();
+  const InputImageType * spatialImage = this->GetSpatialInput();
+  const unsigned int nbComponents = rangeImage->GetNumberOfComponentsPerPixel();
+  const RegionType region = this->GetTileRegion(tile, true);
+
+  // Copy the range and spatial components of the tile
+  typename InputImageType::Pointer tileImage = InputImageType::New();
+  tileImage->SetRegions(region);
+  tileImage->SetNumberOfComponentsPerPixel(nbComponents + (spatialImage ? 2 : 0));
+  tileImage->Allocate();
+
+  InputPixelType pixel;
+  pixel.SetSize(tileImage->GetNumberOfComponentsPerPixel());
+  itk::ImageRegionConstIterator<InputImageType> rangeIt(rangeImage, region);
+  itk::ImageRegionIterator<InputImageType> tileIt(tileImage, region);
+  if (spatialImage)
+    {
+    itk::ImageRegionConstIterator<InputImageType> spatialIt(spatialImage, region);
+    for (; !tileIt.IsAtEnd(); ++tileIt, ++rangeIt, ++spatialIt)
+      {
+      const InputPixelType & range = rangeIt.Get();
+      const InputPixelType & spatial = spatialIt.Get();
+      for (unsigned int c = 0; c < nbComponents; ++c)
+        {
+        pixel[c] = range[c];
+        }
+      pixel[nbComponents] = spatial[0];
+      pixel[nbComponents + 1] = spatial[1];
+      tileIt.Set(pixel);
+      }
+    }
+  else
+    {
+    for (; !tileIt.IsAtEnd(); ++tileIt, ++rangeIt)
+      {
+      tileIt.Set(rangeIt.Get());
+      }
+    }
+
+  typename ConnectedComponentFilterType::Pointer ccFilter = ConnectedComponentFilterType::New();
+  ccFilter->SetInput(tileImage);
+  ccFilter->SetNumberOfThreads(1);
+  ccFilter->GetFunctor().SetNumberOfRangeComponents(nbComponents);
+  ccFilter->GetFunctor().SetRangeRadius(m_RangeRadius);
+  ccFilter->GetFunctor().SetSpatialRadius(m_SpatialRadius);
+  ccFilter->GetFunctor().SetUseSpatial(spatialImage != nullptr);
+  ccFilter->Update();
+
+  std::vector<LabelPixelType> labels(region.GetNumberOfPixels());
+  itk::ImageRegionConstIterator<LabelImageType> labelIt(ccFilter->GetOutput(), region);
+  for (unsigned int id = 0; !labelIt.IsAtEnd(); ++labelIt, ++id)
+    {
+    labels[id] = labelIt.Get();
+    }
+  return labels;
+}
+
+template <class TInputImage, class TLabelImage>
+void
+LSMSTileSegmentationImageFilter<TInputImage, TLabelImage>
+::ProcessTile(unsigned int tile, bool firstPass)
+{
+  const std::vector<LabelPixelType> labels = this->SegmentTile(tile);
+  const RegionType extended = this->GetTileRegion(tile, true);
+  const RegionType core = this->GetTileRegion(tile, false);
+  const unsigned int extendedWidth = extended.GetSize()[0];
+  const unsigned int width = core.GetSize()[0];
+  const unsigned int height = core.GetSize()[1];
+
+  if (!firstPass)
+    {
+    // The cache entry has been inserted before the threads started
+    std::vector<LabelPixelType> & relabeled = m_TileCache.find(tile)->second;
+    relabeled.resize(width * height);
+    for (unsigned int y = 0; y < height; ++y)
+      {
+      for (unsigned int x = 0; x < width; ++x)
+        {
+        relabeled[y * width + x] = m_FinalLabels[m_LabelOffsets[tile] + labels[y * extendedWidth + x]];
+        }
+      }
+    return;
+    }
+
+  TileBorders & borders = m_TileBorders[tile];
+  borders.NumberOfLabels = labels.empty() ? 0 : *std::max_element(labels.begin(), labels.end());
+  borders.Sizes.assign(borders.NumberOfLabels + 1, 0);
+  for (unsigned int y = 0; y < height; ++y)
+    {
+    for (unsigned int x = 0; x < width; ++x)
+      {
+      ++borders.Sizes[labels[y * extendedWidth + x]];
+      }
+    }
+
+  borders.Top.assign(labels.begin(), labels.begin() + width);
+  borders.Left.resize(height);
+  for (unsigned int y = 0; y < height; ++y)
+    {
+    borders.Left[y] = labels[y * extendedWidth];
+    }
+  if (extended.GetSize()[1] > height)
+    {
+    borders.BottomMargin.assign(labels.begin() + height * extendedWidth,
+                                labels.begin() + height * extendedWidth + width);
+    }
+  if (extendedWidth > width)
+    {
+    borders.RightMargin.resize(height);
+    for (unsigned int y = 0; y < height; ++y)
+      {
+      borders.RightMargin[y] = labels[y * extendedWidth + width];
+      }
+    }
+}
+
+template <class TInputImage, class TLabelImage>
+ITK_THREAD_RETURN_TYPE
+LSMSTileSegmentationImageFilter<TInputImage, TLabelImage>
+::ThreaderCallback(void *arg)
+{
+  const unsigned int threadId = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->ThreadID;
+  const unsigned int threadCount = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->NumberOfThreads;
+  ThreadStruct * str = (ThreadStruct *) (((itk::MultiThreader::ThreadInfoStruct *) (arg))->UserData);
+
+  for (unsigned int k = threadId; k < str->Tiles->size(); k += threadCount)
+    {
+    str->Filter->ProcessTile((*str->Tiles)[k], str->FirstPass);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TInputImage, class TLabelImage>
+void
+LSMSTileSegmentationImageFilter<TInputImage, TLabelImage>
+::ProcessTiles(const std::vector<unsigned int> & tiles, bool firstPass)
+{
+  if (tiles.empty())
+    {
+    return;
+    }
+
+  ThreadStruct str;
+  str.Filter = this;
+  str.Tiles = &tiles;
+  str.FirstPass = firstPass;
+
+  this->GetMultiThreader()->SetNumberOfThreads(
+    std::min(static_cast<unsigned int>(this->GetNumberOfThreads()), static_cast<unsigned int>(tiles.size())));
+  this->GetMultiThreader()->SetSingleMethod(this->ThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+}
+
+template <class TInputImage, class TLabelImage>
+void
+LSMSTileSegmentationImageFilter<TInputImage, TLabelImage>
+::ComputeLabelTable()
+{
+  const unsigned int nbTiles = m_NumberOfTiles[0] * m_NumberOfTiles[1];
+  m_TileBorders.assign(nbTiles, TileBorders());
+  m_TileCache.clear();
+
+  // Segment a few tiles of a row at a time, to bound the memory
+  const unsigned int groupSize = std::max(1, static_cast<int>(this->GetNumberOfThreads()));
+  for (unsigned int row = 0; row < m_NumberOfTiles[1]; ++row)
+    {
+    for (unsigned int column = 0; column < m_NumberOfTiles[0]; column += groupSize)
+      {
+      std::vector<unsigned int> tiles;
+      RegionType region = this->GetTileRegion(row * m_NumberOfTiles[0] + column, true);
+      for (unsigned int k = column; k < std::min(column + groupSize, m_NumberOfTiles[0]); ++k)
+        {
+        tiles.push_back(row * m_NumberOfTiles[0] + k);
+        const RegionType extended = this->GetTileRegion(tiles.back(), true);
+        region.SetSize(0, extended.GetIndex()[0] + extended.GetSize()[0] - region.GetIndex()[0]);
+        }
+
+      for (unsigned int i = 0; i < std::min(static_cast<unsigned int>(this->GetNumberOfInputs()), 2u); ++i)
+        {
+        InputImageType * input = const_cast<InputImageType *>(static_cast<const InputImageType *>(
+          this->itk::ProcessObject::GetInput(i)));
+        if (input)
+          {
+          input->SetRequestedRegion(region);
+          input->PropagateRequestedRegion();
+          input->UpdateOutputData();
+          }
+        }
+      this->ProcessTiles(tiles, true);
+      }
+    }
+
+  // Labels are shifted by the number of labels of the previous tiles
+  m_LabelOffsets.resize(nbTiles);
+  unsigned long nbLabels = 0;
+  for (unsigned int tile = 0; tile < nbTiles; ++tile)
+    {
+    m_LabelOffsets[tile] = nbLabels;
+    nbLabels += m_TileBorders[tile].NumberOfLabels;
+    }
+  m_NumberOfSegments = nbLabels;
+
+  // Merge the labels across the tile borders: each segment is
+  // represented by its smallest label
+  std::vector<unsigned long> parents(nbLabels + 1);
+  std::iota(parents.begin(), parents.end(), 0);
+  auto find = [&parents](unsigned long label)
+  {
+    while (parents[label] != label)
+      {
+      parents[label] = parents[parents[label]];
+      label = parents[label];
+      }
+    return label;
+  };
+  auto unite = [&](unsigned long a, unsigned long b)
+  {
+    a = find(a);
+    b = find(b);
+    if (a < b)
+      {
+      parents[b] = a;
+      }
+    else
+      {
+      parents[a] = b;
+      }
+  };
+
+  for (unsigned int tile = 0; tile < nbTiles; ++tile)
+    {
+    const TileBorders & borders = m_TileBorders[tile];
+    if (tile >= m_NumberOfTiles[0])
+      {
+      const unsigned int up = tile - m_NumberOfTiles[0];
+      for (unsigned int x = 0; x < borders.Top.size(); ++x)
+        {
+        unite(m_LabelOffsets[tile] + borders.Top[x], m_LabelOffsets[up] + m_TileBorders[up].BottomMargin[x]);
+        }
+      }
+    if (tile % m_NumberOfTiles[0] > 0)
+      {
+      const unsigned int left = tile - 1;
+      for (unsigned int y = 0; y < borders.Left.size(); ++y)
+        {
+        unite(m_LabelOffsets[tile] + borders.Left[y], m_LabelOffsets[left] + m_TileBorders[left].RightMargin[y]);
+        }
+      }
+    }
+
+  std::vector<unsigned long> sizes(nbLabels + 1, 0);
+  for (unsigned int tile = 0; tile < nbTiles; ++tile)
+    {
+    const TileBorders & borders = m_TileBorders[tile];
+    for (unsigned long label = 1; label < borders.Sizes.size(); ++label)
+      {
+      sizes[find(m_LabelOffsets[tile] + label)] += borders.Sizes[label];
+      }
+    }
+  m_TileBorders.clear();
+
+  // Final labels, numbered by increasing representative label. As in
+  // the historical tile-wise application, the labels which are not
+  // representatives take a number too when MinimumRegionSize is 0.
+  m_FinalLabels.assign(nbLabels + 1, 0);
+  unsigned long newLabel = 1;
+  unsigned long smallCount = 0;
+  for (unsigned long label = 1; label <= nbLabels; ++label)
+    {
+    if (sizes[label] < m_MinimumRegionSize)
+      {
+      smallCount += (find(label) == label) ? 1 : 0;
+      }
+    else
+      {
+      m_FinalLabels[label] = static_cast<LabelPixelType>(newLabel++);
+      }
+    }
+  for (unsigned long label = 1; label <= nbLabels; ++label)
+    {
+    m_FinalLabels[label] = m_FinalLabels[find(label)];
+    }
+
+  otbMsgDevMacro(<< nbLabels << " labels, " << smallCount << " small segments removed");
+  m_LabelTableTime.Modified();
+}
+
+template <class TInputImage, class TLabelImage>
+void
+LSMSTileSegmentationImageFilter<TInputImage, TLabelImage>
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  const InputImageType * rangeImage = this->GetInput();
+  const InputImageType * spatialImage = this->GetSpatialInput();
+  const RegionType largest = rangeImage->GetLargestPossibleRegion();
+  if (spatialImage)
+    {
+    if (spatialImage->GetLargestPossibleRegion() != largest)
+      {
+      itkExceptionMacro(<< "The range and spatial images have different regions");
+      }
+    if (spatialImage->GetNumberOfComponentsPerPixel() < 2)
+      {
+      itkExceptionMacro(<< "The spatial image must have 2 components");
+      }
+    }
+  if (m_TileSize[0] == 0 || m_TileSize[1] == 0)
+    {
+    itkExceptionMacro(<< "Null tile size");
+    }
+
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    m_NumberOfTiles[dim] = (largest.GetSize()[dim] + m_TileSize[dim] - 1) / m_TileSize[dim];
+    }
+
+  const itk::ModifiedTimeType labelTableTime = m_LabelTableTime.GetMTime();
+  if (labelTableTime < this->GetMTime() || labelTableTime < rangeImage->GetPipelineMTime()
+      || (spatialImage && labelTableTime < spatialImage->GetPipelineMTime()))
+    {
+    this->ComputeLabelTable();
+    }
+}
+
+template <class TInputImage, class TLabelImage>
+void
+LSMSTileSegmentationImageFilter<TInputImage, TLabelImage>
+::GenerateInputRequestedRegion()
+{
+  // Only the tiles which are not cached are read
+  const std::vector<unsigned int> tiles = this->GetMissingTiles(this->GetOutput()->GetRequestedRegion());
+
+  RegionType region;
+  if (tiles.empty())
+    {
+    IndexType nullIndex;
+    nullIndex.Fill(0);
+    SizeType nullSize;
+    nullSize.Fill(0);
+    region.SetIndex(nullIndex);
+    region.SetSize(nullSize);
+    }
+  else
+    {
+    IndexType first = this->GetTileRegion(tiles.front(), true).GetIndex();
+    IndexType last = first;
+    for (unsigned int tile : tiles)
+      {
+      const RegionType extended = this->GetTileRegion(tile, true);
+      for (unsigned int dim = 0; dim < 2; ++dim)
+        {
+        first[dim] = std::min(first[dim], extended.GetIndex()[dim]);
+        last[dim] = std::max(last[dim], static_cast<typename IndexType::IndexValueType>(
+                               extended.GetIndex()[dim] + extended.GetSize()[dim] - 1));
+        }
+      }
+    region.SetIndex(first);
+    region.SetSize(0, last[0] - first[0] + 1);
+    region.SetSize(1, last[1] - first[1] + 1);
+    }
+
+  for (unsigned int i = 0; i < std::min(static_cast<unsigned int>(this->GetNumberOfInputs()), 2u); ++i)
+    {
+    InputImageType * input = const_cast<InputImageType *>(static_cast<const InputImageType *>(
+      this->itk::ProcessObject::GetInput(i)));
+    if (input)
+      {
+      input->SetRequestedRegion(region);
+      }
+    }
+}
+
+template <class TInputImage, class TLabelImage>
+void
+LSMSTileSegmentationImageFilter<TInputImage, TLabelImage>
+::GenerateData()
+{
+  this->AllocateOutputs();
+  LabelImageType * output = this->GetOutput();
+  const RegionType requested = output->GetRequestedRegion();
+  const std::vector<unsigned int> tiles = this->GetTiles(requested);
+
+  // Drop the cached tiles which are not needed anymore
+  for (auto it = m_TileCache.begin(); it != m_TileCache.end();)
+    {
+    if (std::find(tiles.begin(), tiles.end(), it->first) == tiles.end())
+      {
+      it = m_TileCache.erase(it);
+      }
+    else
+      {
+      ++it;
+      }
+    }
+
+  const std::vector<unsigned int> missing = this->GetMissingTiles(requested);
+  for (unsigned int tile : missing)
+    {
+    m_TileCache[tile];
+    }
+  this->ProcessTiles(missing, false);
+
+  for (unsigned int tile : tiles)
+    {
+    const RegionType core = this->GetTileRegion(tile, false);
+    RegionType region = core;
+    region.Crop(requested);
+    const std::vector<LabelPixelType> & labels = m_TileCache[tile];
+
+    itk::ImageRegionIterator<LabelImageType> outIt(output, region);
+    for (outIt.GoToBegin(); !outIt.IsAtEnd(); ++outIt)
+      {
+      const IndexType index = outIt.GetIndex();
+      outIt.Set(labels[(index[1] - core.GetIndex()[1]) * core.GetSize()[0] + index[0] - core.GetIndex()[0]]);
+      }
+    }
+}
+
+template <class TInputImage, class TLabelImage>
+void
+LSMSTileSegmentationImageFilter<TInputImage, TLabelImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "RangeRadius: " << m_RangeRadius << std::endl;
+  os << indent << "SpatialRadius: " << m_SpatialRadius << std::endl;
+  os << indent << "MinimumRegionSize: " << m_MinimumRegionSize << std::endl;
+  os << indent << "TileSize: " << m_TileSize << std::endl;
+  os << indent << "NumberOfSegments: " << m_NumberOfSegments << std::endl;
+}
+
+} // end namespace otb
+
+#endif
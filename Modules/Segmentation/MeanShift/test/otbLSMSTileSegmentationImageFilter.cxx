@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "otbLSMSTileSegmentationImageFilter.h"
+#include "otbImage.h"
+#include "otbVectorImage.h"
+#include "otbImageFileReader.h"
+#include "itkStreamingImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <map>
+
+int otbLSMSTileSegmentationImageFilter(int argc, char * argv[])
+{
+  if (argc != 4)
+    {
+    std::cerr << "Usage: " << argv[0] << " inputFileName rangeRadius minRegionSize" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef otb::VectorImage<float, 2>                                      ImageType;
+  typedef otb::Image<unsigned int, 2>                                     LabelImageType;
+  typedef otb::ImageFileReader<ImageType>                                 ReaderType;
+  typedef otb::LSMSTileSegmentationImageFilter<ImageType, LabelImageType> FilterType;
+  typedef itk::StreamingImageFilter<LabelImageType, LabelImageType>      StreamingFilterType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  reader->UpdateOutputInformation();
+
+  // Reference: the whole image in one tile
+  FilterType::Pointer reference = FilterType::New();
+  reference->SetInput(reader->GetOutput());
+  reference->SetRangeRadius(atof(argv[2]));
+  reference->SetMinimumRegionSize(atoi(argv[3]));
+  reference->SetTileSize(reader->GetOutput()->GetLargestPossibleRegion().GetSize());
+  reference->Update();
+
+  // Small tiles, streamed by strips which do not match the tiles
+  FilterType::SizeType tileSize;
+  tileSize[0] = 37;
+  tileSize[1] = 23;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(reader->GetOutput());
+  filter->SetRangeRadius(atof(argv[2]));
+  filter->SetMinimumRegionSize(atoi(argv[3]));
+  filter->SetTileSize(tileSize);
+
+  StreamingFilterType::Pointer streaming = StreamingFilterType::New();
+  streaming->SetInput(filter->GetOutput());
+  streaming->SetNumberOfStreamDivisions(7);
+  streaming->Update();
+
+  // The segments must be the same, up to their labels
+  std::map<unsigned int, unsigned int> forward, backward;
+  itk::ImageRegionConstIterator<LabelImageType> refIt(reference->GetOutput(),
+                                                      reference->GetOutput()->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<LabelImageType> it(streaming->GetOutput(),
+                                                   streaming->GetOutput()->GetLargestPossibleRegion());
+  unsigned long nbDifferences = 0;
+  for (; !it.IsAtEnd(); ++it, ++refIt)
+    {
+    auto f = forward.insert(std::make_pair(refIt.Get(), it.Get()));
+    auto b = backward.insert(std::make_pair(it.Get(), refIt.Get()));
+    if (f.first->second != it.Get() || b.first->second != refIt.Get()
+        || (refIt.Get() == 0) != (it.Get() == 0))
+      {
+      ++nbDifferences;
+      }
+    }
+
+  std::cout << forward.size() << " segments, " << nbDifferences << " pixels with differences" << std::endl;
+  return nbDifferences == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
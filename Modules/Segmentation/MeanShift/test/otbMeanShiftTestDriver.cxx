@@ -24,4 +24,5 @@ void RegisterTests()
 {
   REGISTER_TEST(otbMeanShiftConnectedComponentSegmentationFilter);
   REGISTER_TEST(otbMeanShiftSegmentationFilter);
+  REGISTER_TEST(otbLSMSTileSegmentationImageFilter);
 }
@@ -0,0 +1,343 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingHooverMetricsFilter_h
+#define otbStreamingHooverMetricsFilter_h
+
+#include "otbPersistentImageFilter.h"
+#include "otbPersistentFilterStreamingDecorator.h"
+#include "itkFixedArray.h"
+#include "otbMacro.h"
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace otb
+{
+
+/** \class PersistentHooverMetricsFilter
+ * \brief Computes the Hoover contingency table and instances of two
+ * label images, region by region
+ *
+ * The contingency table holds the number of pixels in the intersection
+ * of each couple of regions of the ground truth (GT) and of the machine
+ * segmentation (MS) which intersect. Unlike the dense matrix of
+ * HooverMatrixFilter, it is sparse, and it is computed directly from the
+ * label images: each thread accumulates the couples of labels of its
+ * part of the requested region in a hash table, skipping the hash lookup
+ * along runs of identical couples, and the thread tables are merged
+ * after each region. The pixels whose label is BackgroundValue do not
+ * belong to any region.
+ *
+ * In Synthetize(), the Hoover instances are computed from the sparse
+ * table, as in HooverInstanceFilter, with the overlapping Threshold. The
+ * scores of each region are stored in score maps:
+ *    - GT regions : RC, RF, RA, RM
+ *    - MS regions : RC, RF, RA, RN
+ * along with the average scores over the whole segmentation.
+ *
+ * (see Hoover et al., "An experimental comparison of range image segmentation algorithms", IEEE PAMI vol. 18, no. 7, July 1996)
+ *
+ * \sa HooverMatrixFilter
+ * \sa HooverInstanceFilter
+ * \sa StreamingHooverMetricsFilter
+ *
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ *
+ * \ingroup OTBMetrics
+ */
+template<class TLabelImage>
+class ITK_EXPORT PersistentHooverMetricsFilter :
+  public PersistentImageFilter<TLabelImage, TLabelImage>
+{
+public:
+  /** Standard Self typedef */
+  typedef PersistentHooverMetricsFilter                   Self;
+  typedef PersistentImageFilter<TLabelImage, TLabelImage> Superclass;
+  typedef itk::SmartPointer<Self>                         Pointer;
+  typedef itk::SmartPointer<const Self>                   ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(PersistentHooverMetricsFilter, PersistentImageFilter);
+
+  typedef TLabelImage                          LabelImageType;
+  typedef typename LabelImageType::PixelType   LabelType;
+  typedef typename LabelImageType::RegionType  RegionType;
+
+  typedef unsigned long CoefficientType;
+
+  /** Non empty cell of the contingency table */
+  struct ContingencyEntry
+  {
+    LabelType       GroundTruth;
+    LabelType       MachineSegmentation;
+    CoefficientType Count;
+  };
+
+  /** Cells sorted by ground truth label, then machine segmentation label */
+  typedef std::vector<ContingencyEntry>          ContingencyTableType;
+  typedef std::map<LabelType, CoefficientType>   CardinalityMapType;
+
+  /** Scores of a region : RC, RF, RA, then RM (GT) or RN (MS) */
+  typedef itk::FixedArray<double, 4>             ScoresType;
+  typedef std::map<LabelType, ScoresType>        ScoreMapType;
+
+  void SetGroundTruthImage(const LabelImageType * gt);
+  const LabelImageType * GetGroundTruthImage() const;
+
+  void SetMachineSegmentationImage(const LabelImageType * ms);
+  const LabelImageType * GetMachineSegmentationImage() const;
+
+  /** Label of the pixels which belong to no region (default 0) */
+  itkSetMacro(BackgroundValue, LabelType);
+  itkGetConstMacro(BackgroundValue, LabelType);
+
+  /** Overlapping threshold used to find the Hoover instances (default 0.8) */
+  itkSetMacro(Threshold, double);
+  itkGetConstMacro(Threshold, double);
+
+  /** Results, available after Synthetize() */
+  const ContingencyTableType & GetContingencyTable() const
+  {
+    return m_ContingencyTable;
+  }
+  const CardinalityMapType & GetGroundTruthCardinalities() const
+  {
+    return m_CardinalitiesGT;
+  }
+  const CardinalityMapType & GetMachineSegmentationCardinalities() const
+  {
+    return m_CardinalitiesMS;
+  }
+  const ScoreMapType & GetGroundTruthScores() const
+  {
+    return m_ScoresGT;
+  }
+  const ScoreMapType & GetMachineSegmentationScores() const
+  {
+    return m_ScoresMS;
+  }
+
+  itkGetConstMacro(MeanRC, double);
+  itkGetConstMacro(MeanRF, double);
+  itkGetConstMacro(MeanRA, double);
+  itkGetConstMacro(MeanRM, double);
+  itkGetConstMacro(MeanRN, double);
+
+  /** The output image is not used. */
+  void AllocateOutputs() override;
+
+  void GenerateOutputInformation() override;
+
+  void Reset(void) override;
+
+  void Synthetize(void) override;
+
+protected:
+  PersistentHooverMetricsFilter();
+  ~PersistentHooverMetricsFilter() override {}
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+  void BeforeThreadedGenerateData() override;
+
+  void ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId) override;
+
+  void AfterThreadedGenerateData() override;
+
+private:
+  PersistentHooverMetricsFilter(const Self &) = delete;
+  void operator =(const Self&) = delete;
+
+  /** Couple of (GT, MS) labels, one of which may be the background */
+  typedef std::pair<LabelType, LabelType> LabelPairType;
+
+  struct LabelPairHash
+  {
+    std::size_t operator()(const LabelPairType & labels) const
+    {
+      const std::size_t h = std::hash<LabelType>()(labels.first);
+      return h ^ (std::hash<LabelType>()(labels.second) + 0x9e3779b9 + (h << 6) + (h >> 2));
+    }
+  };
+
+  typedef std::unordered_map<LabelPairType, CoefficientType, LabelPairHash> PairCountMapType;
+
+  /** Compute the Hoover instances from the contingency table */
+  void ComputeInstances();
+
+  LabelType m_BackgroundValue;
+  double    m_Threshold;
+
+  /** Couples of labels counted since the last Reset(), and per thread */
+  PairCountMapType              m_PairCounts;
+  std::vector<PairCountMapType> m_ThreadPairCounts;
+
+  ContingencyTableType m_ContingencyTable;
+  CardinalityMapType   m_CardinalitiesGT;
+  CardinalityMapType   m_CardinalitiesMS;
+  ScoreMapType         m_ScoresGT;
+  ScoreMapType         m_ScoresMS;
+
+  double m_MeanRC;
+  double m_MeanRF;
+  double m_MeanRA;
+  double m_MeanRM;
+  double m_MeanRN;
+}; // end of class PersistentHooverMetricsFilter
+
+
+/** \class StreamingHooverMetricsFilter
+ * \brief Computes the Hoover metrics of two label images, streaming them
+ * through the PersistentHooverMetricsFilter.
+ *
+ * \code
+ * typedef otb::StreamingHooverMetricsFilter<LabelImageType> HooverFilterType;
+ * HooverFilterType::Pointer hoover = HooverFilterType::New();
+ * hoover->SetGroundTruthImage(gtReader->GetOutput());
+ * hoover->SetMachineSegmentationImage(msReader->GetOutput());
+ * hoover->SetThreshold(0.75);
+ * hoover->Update();
+ * double rc = hoover->GetMeanRC();
+ * \endcode
+ *
+ * \sa PersistentHooverMetricsFilter
+ * \sa PersistentFilterStreamingDecorator
+ *
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ *
+ * \ingroup OTBMetrics
+ */
+template<class TLabelImage>
+class ITK_EXPORT StreamingHooverMetricsFilter :
+  public PersistentFilterStreamingDecorator<PersistentHooverMetricsFilter<TLabelImage> >
+{
+public:
+  /** Standard Self typedef */
+  typedef StreamingHooverMetricsFilter Self;
+  typedef PersistentFilterStreamingDecorator
+  <PersistentHooverMetricsFilter<TLabelImage> > Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(StreamingHooverMetricsFilter, PersistentFilterStreamingDecorator);
+
+  typedef TLabelImage                                     LabelImageType;
+  typedef typename Superclass::FilterType                 HooverFilterType;
+  typedef typename HooverFilterType::LabelType            LabelType;
+  typedef typename HooverFilterType::ContingencyTableType ContingencyTableType;
+  typedef typename HooverFilterType::CardinalityMapType   CardinalityMapType;
+  typedef typename HooverFilterType::ScoresType           ScoresType;
+  typedef typename HooverFilterType::ScoreMapType         ScoreMapType;
+
+  void SetGroundTruthImage(const LabelImageType * gt)
+  {
+    this->GetFilter()->SetGroundTruthImage(gt);
+  }
+  const LabelImageType * GetGroundTruthImage()
+  {
+    return this->GetFilter()->GetGroundTruthImage();
+  }
+
+  void SetMachineSegmentationImage(const LabelImageType * ms)
+  {
+    this->GetFilter()->SetMachineSegmentationImage(ms);
+  }
+  const LabelImageType * GetMachineSegmentationImage()
+  {
+    return this->GetFilter()->GetMachineSegmentationImage();
+  }
+
+  otbSetObjectMemberMacro(Filter, BackgroundValue, LabelType);
+  otbGetObjectMemberMacro(Filter, BackgroundValue, LabelType);
+  otbSetObjectMemberMacro(Filter, Threshold, double);
+  otbGetObjectMemberMacro(Filter, Threshold, double);
+
+  const ContingencyTableType & GetContingencyTable() const
+  {
+    return this->GetFilter()->GetContingencyTable();
+  }
+  const CardinalityMapType & GetGroundTruthCardinalities() const
+  {
+    return this->GetFilter()->GetGroundTruthCardinalities();
+  }
+  const CardinalityMapType & GetMachineSegmentationCardinalities() const
+  {
+    return this->GetFilter()->GetMachineSegmentationCardinalities();
+  }
+  const ScoreMapType & GetGroundTruthScores() const
+  {
+    return this->GetFilter()->GetGroundTruthScores();
+  }
+  const ScoreMapType & GetMachineSegmentationScores() const
+  {
+    return this->GetFilter()->GetMachineSegmentationScores();
+  }
+
+  double GetMeanRC() const
+  {
+    return this->GetFilter()->GetMeanRC();
+  }
+  double GetMeanRF() const
+  {
+    return this->GetFilter()->GetMeanRF();
+  }
+  double GetMeanRA() const
+  {
+    return this->GetFilter()->GetMeanRA();
+  }
+  double GetMeanRM() const
+  {
+    return this->GetFilter()->GetMeanRM();
+  }
+  double GetMeanRN() const
+  {
+    return this->GetFilter()->GetMeanRN();
+  }
+
+protected:
+  /** Constructor */
+  StreamingHooverMetricsFilter() {}
+
+  /** Destructor */
+  ~StreamingHooverMetricsFilter() override {}
+
+private:
+  StreamingHooverMetricsFilter(const Self &) = delete;
+  void operator =(const Self&) = delete;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbStreamingHooverMetricsFilter.hxx"
+#endif
+
+#endif
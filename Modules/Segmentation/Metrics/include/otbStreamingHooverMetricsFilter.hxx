@@ -0,0 +1,421 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingHooverMetricsFilter_hxx
+#define otbStreamingHooverMetricsFilter_hxx
+
+#include "otbStreamingHooverMetricsFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+#include <numeric>
+#include <set>
+
+namespace otb
+{
+
+template<class TLabelImage>
+PersistentHooverMetricsFilter<TLabelImage>
+::PersistentHooverMetricsFilter()
+  : m_BackgroundValue(0),
+    m_Threshold(0.8),
+    m_MeanRC(0.),
+    m_MeanRF(0.),
+    m_MeanRA(0.),
+    m_MeanRM(0.),
+    m_MeanRN(0.)
+{
+  this->SetNumberOfRequiredInputs(2);
+}
+
+template<class TLabelImage>
+void
+PersistentHooverMetricsFilter<TLabelImage>
+::SetGroundTruthImage(const LabelImageType * gt)
+{
+  this->itk::ProcessObject::SetNthInput(0, const_cast<LabelImageType *>(gt));
+}
+
+template<class TLabelImage>
+const typename PersistentHooverMetricsFilter<TLabelImage>::LabelImageType *
+PersistentHooverMetricsFilter<TLabelImage>
+::GetGroundTruthImage() const
+{
+  return static_cast<const LabelImageType *>(this->itk::ProcessObject::GetInput(0));
+}
+
+template<class TLabelImage>
+void
+PersistentHooverMetricsFilter<TLabelImage>
+::SetMachineSegmentationImage(const LabelImageType * ms)
+{
+  this->itk::ProcessObject::SetNthInput(1, const_cast<LabelImageType *>(ms));
+}
+
+template<class TLabelImage>
+const typename PersistentHooverMetricsFilter<TLabelImage>::LabelImageType *
+PersistentHooverMetricsFilter<TLabelImage>
+::GetMachineSegmentationImage() const
+{
+  return static_cast<const LabelImageType *>(this->itk::ProcessObject::GetInput(1));
+}
+
+template<class TLabelImage>
+void
+PersistentHooverMetricsFilter<TLabelImage>
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  const LabelImageType * gt = this->GetGroundTruthImage();
+  const LabelImageType * ms = this->GetMachineSegmentationImage();
+  if (gt->GetLargestPossibleRegion() != ms->GetLargestPossibleRegion())
+    {
+    itkExceptionMacro(<< "The ground truth and machine segmentation images have different regions");
+    }
+
+  this->GetOutput()->CopyInformation(gt);
+  this->GetOutput()->SetLargestPossibleRegion(gt->GetLargestPossibleRegion());
+  if (this->GetOutput()->GetRequestedRegion().GetNumberOfPixels() == 0)
+    {
+    this->GetOutput()->SetRequestedRegion(this->GetOutput()->GetLargestPossibleRegion());
+    }
+}
+
+template<class TLabelImage>
+void
+PersistentHooverMetricsFilter<TLabelImage>
+::AllocateOutputs()
+{
+  // Nothing to allocate: the output image is not intended to be used
+}
+
+template<class TLabelImage>
+void
+PersistentHooverMetricsFilter<TLabelImage>
+::Reset()
+{
+  m_PairCounts.clear();
+  m_ThreadPairCounts.clear();
+
+  m_ContingencyTable.clear();
+  m_CardinalitiesGT.clear();
+  m_CardinalitiesMS.clear();
+  m_ScoresGT.clear();
+  m_ScoresMS.clear();
+
+  m_MeanRC = 0.;
+  m_MeanRF = 0.;
+  m_MeanRA = 0.;
+  m_MeanRM = 0.;
+  m_MeanRN = 0.;
+}
+
+template<class TLabelImage>
+void
+PersistentHooverMetricsFilter<TLabelImage>
+::BeforeThreadedGenerateData()
+{
+  m_ThreadPairCounts.assign(this->GetNumberOfThreads(), PairCountMapType());
+}
+
+template<class TLabelImage>
+void
+PersistentHooverMetricsFilter<TLabelImage>
+::ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId)
+{
+  itk::ImageRegionConstIterator<LabelImageType> gtIt(this->GetGroundTruthImage(), outputRegionForThread);
+  itk::ImageRegionConstIterator<LabelImageType> msIt(this->GetMachineSegmentationImage(), outputRegionForThread);
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  PairCountMapType & counts = m_ThreadPairCounts[threadId];
+
+  // The couples of labels are counted by runs, to skip most hash lookups
+  LabelPairType current;
+  CoefficientType run = 0;
+  for (gtIt.GoToBegin(), msIt.GoToBegin(); !gtIt.IsAtEnd(); ++gtIt, ++msIt, progress.CompletedPixel())
+    {
+    const LabelPairType labels(gtIt.Get(), msIt.Get());
+    if (run > 0 && labels == current)
+      {
+      ++run;
+      continue;
+      }
+    if (run > 0 && (current.first != m_BackgroundValue || current.second != m_BackgroundValue))
+      {
+      counts[current] += run;
+      }
+    current = labels;
+    run = 1;
+    }
+  if (run > 0 && (current.first != m_BackgroundValue || current.second != m_BackgroundValue))
+    {
+    counts[current] += run;
+    }
+}
+
+template<class TLabelImage>
+void
+PersistentHooverMetricsFilter<TLabelImage>
+::AfterThreadedGenerateData()
+{
+  for (const auto & counts : m_ThreadPairCounts)
+    {
+    for (const auto & count : counts)
+      {
+      m_PairCounts[count.first] += count.second;
+      }
+    }
+  m_ThreadPairCounts.clear();
+}
+
+template<class TLabelImage>
+void
+PersistentHooverMetricsFilter<TLabelImage>
+::Synthetize()
+{
+  m_ContingencyTable.clear();
+  m_CardinalitiesGT.clear();
+  m_CardinalitiesMS.clear();
+
+  for (const auto & count : m_PairCounts)
+    {
+    const LabelType gt = count.first.first;
+    const LabelType ms = count.first.second;
+    if (gt != m_BackgroundValue)
+      {
+      m_CardinalitiesGT[gt] += count.second;
+      }
+    if (ms != m_BackgroundValue)
+      {
+      m_CardinalitiesMS[ms] += count.second;
+      }
+    if (gt != m_BackgroundValue && ms != m_BackgroundValue)
+      {
+      ContingencyEntry entry;
+      entry.GroundTruth = gt;
+      entry.MachineSegmentation = ms;
+      entry.Count = count.second;
+      m_ContingencyTable.push_back(entry);
+      }
+    }
+
+  std::sort(m_ContingencyTable.begin(), m_ContingencyTable.end(),
+            [](const ContingencyEntry & a, const ContingencyEntry & b)
+    {
+    return a.GroundTruth < b.GroundTruth || (a.GroundTruth == b.GroundTruth && a.MachineSegmentation < b.MachineSegmentation);
+    });
+
+  this->ComputeInstances();
+}
+
+template<class TLabelImage>
+void
+PersistentHooverMetricsFilter<TLabelImage>
+::ComputeInstances()
+{
+  ScoresType noScore;
+  noScore.Fill(0.);
+  m_ScoresGT.clear();
+  m_ScoresMS.clear();
+  for (const auto & region : m_CardinalitiesGT)
+    {
+    m_ScoresGT.emplace_hint(m_ScoresGT.end(), region.first, noScore);
+    }
+  for (const auto & region : m_CardinalitiesMS)
+    {
+    m_ScoresMS.emplace_hint(m_ScoresMS.end(), region.first, noScore);
+    }
+
+  // Classified regions
+  std::set<LabelType> classifiedGT;
+  std::set<LabelType> classifiedMS;
+
+  double bufferRC = 0.0;
+  double bufferRF = 0.0;
+  double bufferRA = 0.0;
+  double bufferRM = 0.0;
+  double bufferRN = 0.0;
+  double areaGT = 0.0;
+  double areaMS = 0.0;
+
+  // First pass : rows of the table (GT regions), for correct detection
+  // and over segmentation
+  typename ContingencyTableType::const_iterator entry = m_ContingencyTable.begin();
+  for (const auto & regionGT : m_CardinalitiesGT)
+    {
+    const double cardGT = static_cast<double>(regionGT.second);
+    const double tGT = cardGT * m_Threshold;
+    double sumOS = 0.0;
+    double sumScoreRF = 0.0;
+    std::vector<LabelType> regionsOfMS;
+
+    bool isRowEmpty = true;
+    for (; entry != m_ContingencyTable.end() && entry->GroundTruth == regionGT.first; ++entry)
+      {
+      isRowEmpty = false;
+      const double coefT = static_cast<double>(entry->Count);
+      const double tMS = static_cast<double>(m_CardinalitiesMS[entry->MachineSegmentation]) * m_Threshold;
+      if (coefT >= tMS)
+        {
+        if (coefT >= tGT)
+          {
+          const double scoreRC = m_Threshold * std::min(coefT / tGT, coefT / tMS);
+          bufferRC += scoreRC * cardGT;
+          m_ScoresGT[regionGT.first][0] = scoreRC;
+          m_ScoresMS[entry->MachineSegmentation][0] = scoreRC;
+          classifiedGT.insert(regionGT.first);
+          classifiedMS.insert(entry->MachineSegmentation);
+          }
+        // candidate region for over-segmentation
+        regionsOfMS.push_back(entry->MachineSegmentation);
+        sumOS += coefT;
+        sumScoreRF += coefT * (coefT - 1.0);
+        }
+      }
+
+    if (sumOS >= tGT && sumOS > 0 && regionsOfMS.size() > 1)
+      {
+      const double scoreRF = 1.0 - sumScoreRF / (cardGT * (cardGT - 1.0));
+      bufferRF += scoreRF * cardGT;
+      m_ScoresGT[regionGT.first][1] = scoreRF;
+      for (const LabelType ms : regionsOfMS)
+        {
+        m_ScoresMS[ms][1] = scoreRF;
+        classifiedMS.insert(ms);
+        }
+      classifiedGT.insert(regionGT.first);
+      }
+
+    // empty rows are ignored and have no Hoover score
+    if (isRowEmpty)
+      {
+      classifiedGT.insert(regionGT.first);
+      }
+    else
+      {
+      areaGT += cardGT;
+      }
+    }
+
+  // Second pass : columns of the table (MS regions), for under
+  // segmentation
+  std::vector<std::size_t> columnOrder(m_ContingencyTable.size());
+  std::iota(columnOrder.begin(), columnOrder.end(), 0);
+  std::sort(columnOrder.begin(), columnOrder.end(), [this](std::size_t a, std::size_t b)
+    {
+    const ContingencyEntry & ea = m_ContingencyTable[a];
+    const ContingencyEntry & eb = m_ContingencyTable[b];
+    return ea.MachineSegmentation < eb.MachineSegmentation
+      || (ea.MachineSegmentation == eb.MachineSegmentation && ea.GroundTruth < eb.GroundTruth);
+    });
+
+  std::size_t k = 0;
+  for (const auto & regionMS : m_CardinalitiesMS)
+    {
+    const double cardMS = static_cast<double>(regionMS.second);
+    const double tMS = cardMS * m_Threshold;
+    double sumUS = 0.0;
+    double sumScoreUS = 0.0;
+    double sumCardUS = 0.0;
+    std::vector<LabelType> regionsOfGT;
+
+    bool isColEmpty = true;
+    for (; k < columnOrder.size() && m_ContingencyTable[columnOrder[k]].MachineSegmentation == regionMS.first; ++k)
+      {
+      isColEmpty = false;
+      const ContingencyEntry & cell = m_ContingencyTable[columnOrder[k]];
+      const double coefT = static_cast<double>(cell.Count);
+      const double cardGT = static_cast<double>(m_CardinalitiesGT[cell.GroundTruth]);
+      if (coefT >= cardGT * m_Threshold)
+        {
+        regionsOfGT.push_back(cell.GroundTruth);
+        sumUS += coefT;
+        sumScoreUS += coefT * (coefT - 1.0);
+        sumCardUS += cardGT;
+        }
+      }
+
+    if (sumUS >= tMS && regionsOfGT.size() > 1)
+      {
+      const double scoreRA = 1.0 - sumScoreUS / (sumCardUS * (sumCardUS - 1.0));
+      bufferRA += scoreRA * sumCardUS;
+      m_ScoresMS[regionMS.first][2] = scoreRA;
+      for (const LabelType gt : regionsOfGT)
+        {
+        m_ScoresGT[gt][2] = scoreRA;
+        classifiedGT.insert(gt);
+        }
+      classifiedMS.insert(regionMS.first);
+      }
+
+    // MS regions that don't intersect any GT region are ignored
+    if (isColEmpty)
+      {
+      classifiedMS.insert(regionMS.first);
+      }
+    else
+      {
+      areaMS += cardMS;
+      }
+    }
+
+  // Missed regions (unclassified regions in GT)
+  for (const auto & regionGT : m_CardinalitiesGT)
+    {
+    if (classifiedGT.count(regionGT.first) == 0)
+      {
+      bufferRM += static_cast<double>(regionGT.second);
+      m_ScoresGT[regionGT.first][3] = 1.0;
+      }
+    }
+
+  // Noise regions (unclassified regions in MS)
+  for (const auto & regionMS : m_CardinalitiesMS)
+    {
+    if (classifiedMS.count(regionMS.first) == 0)
+      {
+      bufferRN += static_cast<double>(regionMS.second);
+      m_ScoresMS[regionMS.first][3] = 1.0;
+      }
+    }
+
+  m_MeanRC = areaGT > 0 ? bufferRC / areaGT : 0.;
+  m_MeanRF = areaGT > 0 ? bufferRF / areaGT : 0.;
+  m_MeanRA = areaGT > 0 ? bufferRA / areaGT : 0.;
+  m_MeanRM = areaGT > 0 ? bufferRM / areaGT : 0.;
+  m_MeanRN = areaMS > 0 ? bufferRN / areaMS : 0.;
+}
+
+template<class TLabelImage>
+void
+PersistentHooverMetricsFilter<TLabelImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "BackgroundValue: " << static_cast<typename itk::NumericTraits<LabelType>::PrintType>(m_BackgroundValue) << std::endl;
+  os << indent << "Threshold: " << m_Threshold << std::endl;
+  os << indent << "Contingency table: " << m_ContingencyTable.size() << " non empty cells" << std::endl;
+}
+
+} // end namespace otb
+
+#endif
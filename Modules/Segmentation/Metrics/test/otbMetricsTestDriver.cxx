@@ -24,4 +24,5 @@ void RegisterTests()
 {
   REGISTER_TEST(otbHooverInstanceFilterToAttributeImage);
   REGISTER_TEST(otbHooverMatrixFilter);
+  REGISTER_TEST(otbStreamingHooverMetricsFilter);
 }
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "otbStreamingHooverMetricsFilter.h"
+#include "otbHooverMatrixFilter.h"
+#include "otbHooverInstanceFilter.h"
+
+#include "otbImage.h"
+#include "otbImageFileReader.h"
+#include "itkLabelImageToLabelMapFilter.h"
+
+#include <cmath>
+
+int otbStreamingHooverMetricsFilter(int argc, char* argv[])
+{
+  typedef otb::AttributesMapLabelObject<unsigned int, 2, float> LabelObjectType;
+  typedef itk::LabelMap<LabelObjectType>            LabelMapType;
+  typedef otb::HooverMatrixFilter<LabelMapType>     HooverMatrixFilterType;
+  typedef otb::HooverInstanceFilter<LabelMapType>   InstanceFilterType;
+  typedef otb::Image<unsigned int, 2>               ImageType;
+  typedef itk::LabelImageToLabelMapFilter
+    <ImageType, LabelMapType>                       ImageToLabelMapFilterType;
+  typedef otb::ImageFileReader<ImageType>           ImageReaderType;
+  typedef HooverMatrixFilterType::MatrixType        MatrixType;
+
+  typedef otb::StreamingHooverMetricsFilter<ImageType> StreamingHooverFilterType;
+
+  if(argc != 4)
+    {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " segmentationGT segmentationMS nbLinesPerStrip" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ImageReaderType::Pointer gt_reader = ImageReaderType::New();
+  gt_reader->SetFileName(argv[1]);
+
+  ImageReaderType::Pointer ms_reader = ImageReaderType::New();
+  ms_reader->SetFileName(argv[2]);
+
+  // Reference : dense matrix and instances on the label maps
+  ImageToLabelMapFilterType::Pointer gt_filter = ImageToLabelMapFilterType::New();
+  gt_filter->SetInput(gt_reader->GetOutput());
+  gt_filter->SetBackgroundValue(0);
+
+  ImageToLabelMapFilterType::Pointer ms_filter = ImageToLabelMapFilterType::New();
+  ms_filter->SetInput(ms_reader->GetOutput());
+  ms_filter->SetBackgroundValue(0);
+
+  HooverMatrixFilterType::Pointer hooverFilter = HooverMatrixFilterType::New();
+  hooverFilter->SetGroundTruthLabelMap(gt_filter->GetOutput());
+  hooverFilter->SetMachineSegmentationLabelMap(ms_filter->GetOutput());
+  hooverFilter->Update();
+
+  MatrixType &mat = hooverFilter->GetHooverConfusionMatrix();
+
+  InstanceFilterType::Pointer instances = InstanceFilterType::New();
+  instances->SetGroundTruthLabelMap(gt_filter->GetOutput());
+  instances->SetMachineSegmentationLabelMap(ms_filter->GetOutput());
+  instances->SetThreshold(0.75);
+  instances->SetHooverMatrix(mat);
+  instances->SetUseExtendedAttributes(false);
+  instances->Update();
+
+  // Streamed metrics, computed from the label images
+  StreamingHooverFilterType::Pointer streamingHoover = StreamingHooverFilterType::New();
+  streamingHoover->SetGroundTruthImage(gt_reader->GetOutput());
+  streamingHoover->SetMachineSegmentationImage(ms_reader->GetOutput());
+  streamingHoover->SetBackgroundValue(0);
+  streamingHoover->SetThreshold(0.75);
+  streamingHoover->GetStreamer()->SetNumberOfLinesStrippedStreaming(atoi(argv[3]));
+  streamingHoover->Update();
+
+  // The sparse table holds the non zero coefficients of the dense matrix
+  double matrixSum = 0.0;
+  unsigned long nonZero = 0;
+  for (unsigned int i = 0; i < mat.Rows(); ++i)
+    {
+    for (unsigned int j = 0; j < mat.Cols(); ++j)
+      {
+      matrixSum += mat(i, j);
+      if (mat(i, j) > 0)
+        {
+        ++nonZero;
+        }
+      }
+    }
+
+  double tableSum = 0.0;
+  const StreamingHooverFilterType::ContingencyTableType & table = streamingHoover->GetContingencyTable();
+  for (StreamingHooverFilterType::ContingencyTableType::const_iterator it = table.begin(); it != table.end(); ++it)
+    {
+    tableSum += it->Count;
+    }
+
+  if (table.size() != nonZero || tableSum != matrixSum)
+    {
+    std::cerr << "Got " << table.size() << " cells (" << tableSum << " pixels), expected "
+              << nonZero << " cells (" << matrixSum << " pixels)" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (streamingHoover->GetGroundTruthCardinalities().size() != gt_filter->GetOutput()->GetNumberOfLabelObjects()
+      || streamingHoover->GetMachineSegmentationCardinalities().size() != ms_filter->GetOutput()->GetNumberOfLabelObjects())
+    {
+    std::cerr << "Wrong number of regions" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const double expected[5] = {instances->GetMeanRC(), instances->GetMeanRF(), instances->GetMeanRA(),
+                              instances->GetMeanRM(), instances->GetMeanRN()};
+  const double computed[5] = {streamingHoover->GetMeanRC(), streamingHoover->GetMeanRF(), streamingHoover->GetMeanRA(),
+                              streamingHoover->GetMeanRM(), streamingHoover->GetMeanRN()};
+  const char * names[5] = {"RC", "RF", "RA", "RM", "RN"};
+  for (unsigned int i = 0; i < 5; ++i)
+    {
+    std::cout << "Mean " << names[i] << " = " << computed[i] << std::endl;
+    if (std::abs(computed[i] - expected[i]) > 1e-6)
+      {
+      std::cerr << "Wrong mean " << names[i] << ": got " << computed[i] << ", expected " << expected[i] << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
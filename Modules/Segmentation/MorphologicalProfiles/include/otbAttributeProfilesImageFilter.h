@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbAttributeProfilesImageFilter_h
+#define otbAttributeProfilesImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "otbComponentTree.h"
+
+namespace otb
+{
+/** \class AttributeProfilesImageFilter
+ *  \brief Computes the area attribute profiles of an image, with their
+ *  derivatives and multi-scale characteristics, from component trees.
+ *
+ * The opening (resp. closing) profile is the set of the area openings
+ * (resp. closings) of the image for an increasing list of area thresholds,
+ * in pixels. Instead of filtering the image once per threshold, the
+ * max-tree and the min-tree of the image are built once per requested
+ * region, and every level of the profiles is derived from them in a
+ * linear pass (see ComponentTree).
+ *
+ * The filter has six vector image outputs:
+ *  - the opening and closing profiles, one band per threshold,
+ *  - their derivatives (differential attribute profiles), defined as in
+ *    ProfileToProfileDerivativeFilter, one band less,
+ *  - their multi-scale characteristics, defined as in
+ *    ProfileDerivativeToMultiScaleCharacteristicsFilter: the maximum
+ *    derivative in the first band, and the characteristic, scaled with
+ *    InitialValue and Step, in the second band.
+ *
+ * The requested region of the input is padded by the largest threshold
+ * minus one pixel: a component which crosses the padded region border
+ * holds a path of at least that many pixels, so it is kept by all the
+ * thresholds either way, and the outputs are exactly the same whatever
+ * the streaming. As this padding grows with the area and not with the
+ * extent of the components, it can be capped with MaximumPadding, for
+ * instance to the diameter of a compact component of the largest area.
+ * Only the components longer than the cap which cross a stream border
+ * may then be filtered differently from one streaming to another, and a
+ * warning is logged.
+ *
+ * The max-tree and the min-tree are built concurrently, then the levels
+ * of the profiles are split among the threads.
+ *
+ * (see Dalla Mura et al., "Morphological attribute profiles for the
+ * analysis of very high resolution images", IEEE TGRS vol. 48, no. 10, 2010)
+ *
+ * \sa ComponentTree
+ * \sa MorphologicalOpeningProfileFilter
+ * \sa MorphologicalClosingProfileFilter
+ *
+ * \ingroup Streamed
+ * \ingroup MultiThreaded
+ *
+ * \ingroup OTBMorphologicalProfiles
+ */
+template <class TInputImage, class TOutputImage>
+class ITK_EXPORT AttributeProfilesImageFilter
+  : public itk::ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  /** Standard typedefs */
+  typedef AttributeProfilesImageFilter                       Self;
+  typedef itk::ImageToImageFilter<TInputImage, TOutputImage> Superclass;
+  typedef itk::SmartPointer<Self>                            Pointer;
+  typedef itk::SmartPointer<const Self>                      ConstPointer;
+
+  /** Type macro */
+  itkNewMacro(Self);
+
+  /** Creation through object factory macro */
+  itkTypeMacro(AttributeProfilesImageFilter, ImageToImageFilter);
+
+  /** Template parameters typedefs */
+  typedef TInputImage                                  InputImageType;
+  typedef typename InputImageType::PixelType           InputPixelType;
+  typedef TOutputImage                                 OutputImageType;
+  typedef typename OutputImageType::InternalPixelType  OutputInternalPixelType;
+  typedef typename OutputImageType::RegionType         RegionType;
+  typedef ComponentTree<InputPixelType>                ComponentTreeType;
+  typedef std::vector<unsigned long>                   ThresholdListType;
+
+  /** Set/Get the area thresholds of the profiles, in pixels, strictly
+   * increasing */
+  void SetThresholds(const ThresholdListType & thresholds)
+  {
+    m_Thresholds = thresholds;
+    this->Modified();
+  }
+  const ThresholdListType & GetThresholds() const
+  {
+    return m_Thresholds;
+  }
+
+  /** Set/Get whether the diagonal neighbors are connected (default off) */
+  itkSetMacro(FullyConnected, bool);
+  itkGetConstMacro(FullyConnected, bool);
+  itkBooleanMacro(FullyConnected);
+
+  /** Set/Get the maximum padding of the input requested region, in
+   * pixels (default: no cap, exact streaming) */
+  itkSetMacro(MaximumPadding, unsigned long);
+  itkGetConstMacro(MaximumPadding, unsigned long);
+
+  /** Set/Get the initial characteristic value */
+  itkSetMacro(InitialValue, double);
+  itkGetConstMacro(InitialValue, double);
+  /** Set/Get the characteristic step */
+  itkSetMacro(Step, double);
+  itkGetConstMacro(Step, double);
+
+  /** Outputs */
+  OutputImageType * GetOpeningProfileOutput();
+  OutputImageType * GetClosingProfileOutput();
+  OutputImageType * GetOpeningDerivativeOutput();
+  OutputImageType * GetClosingDerivativeOutput();
+  OutputImageType * GetOpeningCharacteristicsOutput();
+  OutputImageType * GetClosingCharacteristicsOutput();
+
+protected:
+  AttributeProfilesImageFilter();
+  ~AttributeProfilesImageFilter() override {}
+
+  void GenerateOutputInformation() override;
+
+  void GenerateInputRequestedRegion() override;
+
+  void GenerateData() override;
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+private:
+  AttributeProfilesImageFilter(const Self &) = delete;
+  void operator =(const Self&) = delete;
+
+  /** Padding of the input requested region */
+  unsigned long GetPadding() const;
+
+  /** Fill the levels [firstLevel, endLevel) of the profile and derivative
+   * outputs from the tree built over the padded region */
+  void ComputeProfileLevels(const ComponentTreeType & tree, const RegionType & treeRegion,
+                            unsigned int firstLevel, unsigned int endLevel,
+                            OutputImageType * profile, OutputImageType * derivative);
+
+  /** Fill the characteristics output from the derivative output */
+  void ComputeCharacteristics(const OutputImageType * derivative, OutputImageType * characteristics);
+
+  static ITK_THREAD_RETURN_TYPE BuildTreesThreaderCallback(void *arg);
+  static ITK_THREAD_RETURN_TYPE ComputeLevelsThreaderCallback(void *arg);
+
+  /** Internal structure used for passing data into the threading library */
+  struct ThreadStruct
+  {
+    Self *                              Filter;
+    const std::vector<InputPixelType> * Values;
+    RegionType                          TreeRegion;
+    /** Max-tree and min-tree */
+    ComponentTreeType                   Trees[2];
+  };
+
+  ThresholdListType m_Thresholds;
+  bool              m_FullyConnected;
+  unsigned long     m_MaximumPadding;
+  double            m_InitialValue;
+  double            m_Step;
+};
+
+} // End namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbAttributeProfilesImageFilter.hxx"
+#endif
+
+#endif
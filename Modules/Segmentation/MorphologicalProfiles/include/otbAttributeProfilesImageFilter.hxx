@@ -0,0 +1,349 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbAttributeProfilesImageFilter_hxx
+#define otbAttributeProfilesImageFilter_hxx
+
+#include "otbAttributeProfilesImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkNumericTraits.h"
+#include "otbMacro.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace otb
+{
+template <class TInputImage, class TOutputImage>
+AttributeProfilesImageFilter<TInputImage, TOutputImage>
+::AttributeProfilesImageFilter()
+  : m_FullyConnected(false),
+    m_MaximumPadding(itk::NumericTraits<unsigned long>::max()),
+    m_InitialValue(0.),
+    m_Step(1.)
+{
+  this->SetNumberOfRequiredOutputs(6);
+  for (unsigned int i = 1; i < 6; ++i)
+    {
+    this->SetNthOutput(i, OutputImageType::New());
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+TOutputImage *
+AttributeProfilesImageFilter<TInputImage, TOutputImage>
+::GetOpeningProfileOutput()
+{
+  return static_cast<OutputImageType *>(this->itk::ProcessObject::GetOutput(0));
+}
+
+template <class TInputImage, class TOutputImage>
+TOutputImage *
+AttributeProfilesImageFilter<TInputImage, TOutputImage>
+::GetClosingProfileOutput()
+{
+  return static_cast<OutputImageType *>(this->itk::ProcessObject::GetOutput(1));
+}
+
+template <class TInputImage, class TOutputImage>
+TOutputImage *
+AttributeProfilesImageFilter<TInputImage, TOutputImage>
+::GetOpeningDerivativeOutput()
+{
+  return static_cast<OutputImageType *>(this->itk::ProcessObject::GetOutput(2));
+}
+
+template <class TInputImage, class TOutputImage>
+TOutputImage *
+AttributeProfilesImageFilter<TInputImage, TOutputImage>
+::GetClosingDerivativeOutput()
+{
+  return static_cast<OutputImageType *>(this->itk::ProcessObject::GetOutput(3));
+}
+
+template <class TInputImage, class TOutputImage>
+TOutputImage *
+AttributeProfilesImageFilter<TInputImage, TOutputImage>
+::GetOpeningCharacteristicsOutput()
+{
+  return static_cast<OutputImageType *>(this->itk::ProcessObject::GetOutput(4));
+}
+
+template <class TInputImage, class TOutputImage>
+TOutputImage *
+AttributeProfilesImageFilter<TInputImage, TOutputImage>
+::GetClosingCharacteristicsOutput()
+{
+  return static_cast<OutputImageType *>(this->itk::ProcessObject::GetOutput(5));
+}
+
+template <class TInputImage, class TOutputImage>
+void
+AttributeProfilesImageFilter<TInputImage, TOutputImage>
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  if (m_Thresholds.size() < 2)
+    {
+    itkExceptionMacro(<< "At least two area thresholds are needed, got " << m_Thresholds.size());
+    }
+  if (m_Thresholds.front() < 1)
+    {
+    itkExceptionMacro(<< "Area thresholds must be at least one pixel");
+    }
+  for (unsigned int i = 1; i < m_Thresholds.size(); ++i)
+    {
+    if (m_Thresholds[i] <= m_Thresholds[i - 1])
+      {
+      itkExceptionMacro(<< "Area thresholds must be strictly increasing");
+      }
+    }
+  if (this->GetPadding() < m_Thresholds.back() - 1)
+    {
+    otbLogMacro(Warning, << "The streams are padded by " << this->GetPadding() << " pixels instead of "
+                << m_Thresholds.back() - 1 << ": the components longer than that which cross a stream border "
+                << "may be filtered differently than on the whole image");
+    }
+
+  const unsigned int nbLevels = m_Thresholds.size();
+  this->GetOpeningProfileOutput()->SetNumberOfComponentsPerPixel(nbLevels);
+  this->GetClosingProfileOutput()->SetNumberOfComponentsPerPixel(nbLevels);
+  this->GetOpeningDerivativeOutput()->SetNumberOfComponentsPerPixel(nbLevels - 1);
+  this->GetClosingDerivativeOutput()->SetNumberOfComponentsPerPixel(nbLevels - 1);
+  this->GetOpeningCharacteristicsOutput()->SetNumberOfComponentsPerPixel(2);
+  this->GetClosingCharacteristicsOutput()->SetNumberOfComponentsPerPixel(2);
+}
+
+template <class TInputImage, class TOutputImage>
+unsigned long
+AttributeProfilesImageFilter<TInputImage, TOutputImage>
+::GetPadding() const
+{
+  if (m_Thresholds.empty() || m_Thresholds.back() < 1)
+    {
+    return 0;
+    }
+  return std::min(m_Thresholds.back() - 1, m_MaximumPadding);
+}
+
+template <class TInputImage, class TOutputImage>
+void
+AttributeProfilesImageFilter<TInputImage, TOutputImage>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType * inputPtr = const_cast<InputImageType *>(this->GetInput());
+  if (!inputPtr || m_Thresholds.empty())
+    {
+    return;
+    }
+
+  // Unless the padding is capped, a component crossing the border of the
+  // padded region is kept by all the thresholds
+  typename InputImageType::RegionType region = this->GetOutput()->GetRequestedRegion();
+  typename InputImageType::SizeType   radius;
+  radius.Fill(this->GetPadding());
+  region.PadByRadius(radius);
+  region.Crop(inputPtr->GetLargestPossibleRegion());
+  inputPtr->SetRequestedRegion(region);
+}
+
+template <class TInputImage, class TOutputImage>
+void
+AttributeProfilesImageFilter<TInputImage, TOutputImage>
+::GenerateData()
+{
+  this->AllocateOutputs();
+
+  const InputImageType * inputPtr = this->GetInput();
+
+  ThreadStruct str;
+  str.Filter = this;
+  str.TreeRegion = inputPtr->GetRequestedRegion();
+
+  std::vector<InputPixelType> values;
+  values.reserve(str.TreeRegion.GetNumberOfPixels());
+  itk::ImageRegionConstIterator<InputImageType> inIt(inputPtr, str.TreeRegion);
+  for (inIt.GoToBegin(); !inIt.IsAtEnd(); ++inIt)
+    {
+    values.push_back(inIt.Get());
+    }
+  str.Values = &values;
+
+  // Build the max-tree and the min-tree concurrently
+  const unsigned int nbThreads = std::max(1, static_cast<int>(this->GetNumberOfThreads()));
+  this->GetMultiThreader()->SetNumberOfThreads(std::min(nbThreads, 2u));
+  this->GetMultiThreader()->SetSingleMethod(this->BuildTreesThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+  this->UpdateProgress(0.3);
+
+  // Then split the levels of both profiles among the threads
+  const unsigned int nbItems = 2 * m_Thresholds.size();
+  this->GetMultiThreader()->SetNumberOfThreads(std::min(nbThreads, nbItems));
+  this->GetMultiThreader()->SetSingleMethod(this->ComputeLevelsThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+  this->UpdateProgress(0.9);
+
+  this->ComputeCharacteristics(this->GetOpeningDerivativeOutput(), this->GetOpeningCharacteristicsOutput());
+  this->ComputeCharacteristics(this->GetClosingDerivativeOutput(), this->GetClosingCharacteristicsOutput());
+  this->UpdateProgress(1.0);
+}
+
+template <class TInputImage, class TOutputImage>
+ITK_THREAD_RETURN_TYPE
+AttributeProfilesImageFilter<TInputImage, TOutputImage>
+::BuildTreesThreaderCallback(void *arg)
+{
+  const unsigned int threadId = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->ThreadID;
+  const unsigned int threadCount = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->NumberOfThreads;
+  ThreadStruct * str = (ThreadStruct *) (((itk::MultiThreader::ThreadInfoStruct *) (arg))->UserData);
+
+  for (unsigned int k = threadId; k < 2; k += threadCount)
+    {
+    str->Trees[k].Build(str->Values->data(), str->TreeRegion.GetSize(0), str->TreeRegion.GetSize(1),
+                        k == 0, str->Filter->GetFullyConnected());
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TInputImage, class TOutputImage>
+ITK_THREAD_RETURN_TYPE
+AttributeProfilesImageFilter<TInputImage, TOutputImage>
+::ComputeLevelsThreaderCallback(void *arg)
+{
+  const unsigned int threadId = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->ThreadID;
+  const unsigned int threadCount = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->NumberOfThreads;
+  ThreadStruct * str = (ThreadStruct *) (((itk::MultiThreader::ThreadInfoStruct *) (arg))->UserData);
+  Self * filter = str->Filter;
+
+  // The levels of the opening profile, then of the closing profile, are
+  // split into contiguous ranges
+  const unsigned int nbLevels = filter->m_Thresholds.size();
+  const unsigned int firstItem = threadId * 2 * nbLevels / threadCount;
+  const unsigned int endItem = (threadId + 1) * 2 * nbLevels / threadCount;
+
+  OutputImageType * profiles[2] = {filter->GetOpeningProfileOutput(), filter->GetClosingProfileOutput()};
+  OutputImageType * derivatives[2] = {filter->GetOpeningDerivativeOutput(), filter->GetClosingDerivativeOutput()};
+  for (unsigned int k = 0; k < 2; ++k)
+    {
+    const unsigned int first = std::max(firstItem, k * nbLevels);
+    const unsigned int end = std::min(endItem, (k + 1) * nbLevels);
+    if (first < end)
+      {
+      filter->ComputeProfileLevels(str->Trees[k], str->TreeRegion, first - k * nbLevels, end - k * nbLevels,
+                                   profiles[k], derivatives[k]);
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TInputImage, class TOutputImage>
+void
+AttributeProfilesImageFilter<TInputImage, TOutputImage>
+::ComputeProfileLevels(const ComponentTreeType & tree, const RegionType & treeRegion,
+                       unsigned int firstLevel, unsigned int endLevel,
+                       OutputImageType * profile, OutputImageType * derivative)
+{
+  const RegionType & outputRegion = profile->GetBufferedRegion();
+  const unsigned int nbLevels = m_Thresholds.size();
+  const unsigned int outputWidth = outputRegion.GetSize(0);
+  const unsigned int outputHeight = outputRegion.GetSize(1);
+  const unsigned int treeWidth = tree.GetWidth();
+  const unsigned int offsetX = outputRegion.GetIndex(0) - treeRegion.GetIndex(0);
+  const unsigned int offsetY = outputRegion.GetIndex(1) - treeRegion.GetIndex(1);
+
+  OutputInternalPixelType * profileBuffer = profile->GetBufferPointer();
+  OutputInternalPixelType * derivativeBuffer = derivative->GetBufferPointer();
+
+  std::vector<InputPixelType> filtered;
+  std::vector<InputPixelType> previous;
+  if (firstLevel > 0)
+    {
+    tree.AreaFilter(m_Thresholds[firstLevel - 1], previous);
+    }
+  for (unsigned int level = firstLevel; level < endLevel; ++level)
+    {
+    tree.AreaFilter(m_Thresholds[level], filtered);
+
+    std::size_t outputPixel = 0;
+    for (unsigned int y = 0; y < outputHeight; ++y)
+      {
+      std::size_t treePixel = static_cast<std::size_t>(y + offsetY) * treeWidth + offsetX;
+      for (unsigned int x = 0; x < outputWidth; ++x, ++outputPixel, ++treePixel)
+        {
+        profileBuffer[outputPixel * nbLevels + level] = static_cast<OutputInternalPixelType>(filtered[treePixel]);
+        if (level > 0)
+          {
+          derivativeBuffer[outputPixel * (nbLevels - 1) + level - 1] = static_cast<OutputInternalPixelType>(
+            std::abs(static_cast<double>(filtered[treePixel]) - static_cast<double>(previous[treePixel])));
+          }
+        }
+      }
+    std::swap(filtered, previous);
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+AttributeProfilesImageFilter<TInputImage, TOutputImage>
+::ComputeCharacteristics(const OutputImageType * derivative, OutputImageType * characteristics)
+{
+  const unsigned int nbDerivatives = m_Thresholds.size() - 1;
+  const std::size_t nbPixels = derivative->GetBufferedRegion().GetNumberOfPixels();
+  const OutputInternalPixelType * derivativeBuffer = derivative->GetBufferPointer();
+  OutputInternalPixelType * characteristicsBuffer = characteristics->GetBufferPointer();
+
+  for (std::size_t pixel = 0; pixel < nbPixels; ++pixel)
+    {
+    const OutputInternalPixelType * values = derivativeBuffer + pixel * nbDerivatives;
+    OutputInternalPixelType * characteristic = characteristicsBuffer + 2 * pixel;
+    characteristic[0] = 0;
+    characteristic[1] = 0;
+    for (unsigned int k = 0; k < nbDerivatives; ++k)
+      {
+      if (values[k] > characteristic[0])
+        {
+        characteristic[0] = values[k];
+        characteristic[1] = static_cast<OutputInternalPixelType>(m_InitialValue + m_Step * k);
+        }
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+AttributeProfilesImageFilter<TInputImage, TOutputImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Number of thresholds: " << m_Thresholds.size() << std::endl;
+  os << indent << "FullyConnected: " << m_FullyConnected << std::endl;
+  os << indent << "MaximumPadding: " << m_MaximumPadding << std::endl;
+  os << indent << "InitialValue: " << m_InitialValue << std::endl;
+  os << indent << "Step: " << m_Step << std::endl;
+}
+
+} // End namespace otb
+
+#endif
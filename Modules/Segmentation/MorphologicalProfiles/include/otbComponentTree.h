@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbComponentTree_h
+#define otbComponentTree_h
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+namespace otb
+{
+/** \class ComponentTree
+ *  \brief Max-tree or min-tree of a 2D buffer, and area filtering.
+ *
+ * The max-tree is the tree of the connected components of the upper
+ * level sets of the image, the min-tree the one of the lower level sets.
+ * It is built with the union-find algorithm of Berger et al. ("Effective
+ * component tree computation with application to pattern recognition in
+ * astronomical imaging", ICIP 2007): the pixels are sorted by level, then
+ * processed from the leaves to the root. Each node is represented by a
+ * canonical pixel, whose parent has a different level, and holds the area
+ * of its component.
+ *
+ * Once built, the tree gives the area opening (max-tree) or closing
+ * (min-tree) for any threshold in a single linear pass, so that a whole
+ * attribute profile costs one tree construction.
+ *
+ * The buffer is in raster order, width pixels per line.
+ *
+ * \sa AttributeProfilesImageFilter
+ *
+ * \ingroup OTBMorphologicalProfiles
+ */
+template <class TValue>
+class ComponentTree
+{
+public:
+  typedef TValue                    ValueType;
+  typedef unsigned int              NodeType;
+  typedef std::vector<NodeType>     NodeListType;
+
+  ComponentTree() : m_Width(0), m_Height(0) {}
+
+  /** Build the max-tree, or the min-tree when maxTree is false */
+  void Build(const ValueType * values, unsigned int width, unsigned int height, bool maxTree, bool fullyConnected)
+  {
+    m_Width = width;
+    m_Height = height;
+    const NodeType nbPixels = width * height;
+    m_Values.assign(values, values + nbPixels);
+
+    // Sort the pixels from the leaves to the root
+    m_SortedPixels.resize(nbPixels);
+    std::iota(m_SortedPixels.begin(), m_SortedPixels.end(), 0);
+    if (maxTree)
+      {
+      std::stable_sort(m_SortedPixels.begin(), m_SortedPixels.end(),
+                       [this](NodeType a, NodeType b) { return m_Values[a] > m_Values[b]; });
+      }
+    else
+      {
+      std::stable_sort(m_SortedPixels.begin(), m_SortedPixels.end(),
+                       [this](NodeType a, NodeType b) { return m_Values[a] < m_Values[b]; });
+      }
+
+    const int nbNeighbors = fullyConnected ? 8 : 4;
+    const int dx[8] = {-1, 1, 0, 0, -1, 1, -1, 1};
+    const int dy[8] = {0, 0, -1, 1, -1, -1, 1, 1};
+
+    const NodeType unprocessed = nbPixels;
+    NodeListType zpar(nbPixels, unprocessed);
+    m_Parent.assign(nbPixels, 0);
+    m_Area.assign(nbPixels, 0);
+
+    for (const NodeType p : m_SortedPixels)
+      {
+      m_Parent[p] = p;
+      zpar[p] = p;
+      m_Area[p] = 1;
+      const int x = p % width;
+      const int y = p / width;
+      for (int k = 0; k < nbNeighbors; ++k)
+        {
+        const int nx = x + dx[k];
+        const int ny = y + dy[k];
+        if (nx < 0 || ny < 0 || nx >= static_cast<int>(width) || ny >= static_cast<int>(height))
+          {
+          continue;
+          }
+        const NodeType n = ny * width + nx;
+        if (zpar[n] == unprocessed)
+          {
+          continue;
+          }
+        const NodeType r = FindRoot(zpar, n);
+        if (r != p)
+          {
+          m_Parent[r] = p;
+          zpar[r] = p;
+          m_Area[p] += m_Area[r];
+          }
+        }
+      }
+
+    // Canonicalize, from the root to the leaves
+    for (typename NodeListType::const_reverse_iterator it = m_SortedPixels.rbegin(); it != m_SortedPixels.rend(); ++it)
+      {
+      const NodeType q = m_Parent[*it];
+      if (m_Values[m_Parent[q]] == m_Values[q])
+        {
+        m_Parent[*it] = m_Parent[q];
+        }
+      }
+  }
+
+  /** Area opening (max-tree) or closing (min-tree): each pixel gets the
+   * level of its nearest ancestor component of at least threshold
+   * pixels. The root is always kept. */
+  void AreaFilter(unsigned long threshold, std::vector<ValueType> & out) const
+  {
+    out.resize(m_Values.size());
+    for (typename NodeListType::const_reverse_iterator it = m_SortedPixels.rbegin(); it != m_SortedPixels.rend(); ++it)
+      {
+      const NodeType p = *it;
+      const NodeType q = m_Parent[p];
+      if (q == p)
+        {
+        out[p] = m_Values[p];
+        }
+      else if (m_Values[q] == m_Values[p])
+        {
+        out[p] = out[q];
+        }
+      else
+        {
+        out[p] = m_Area[p] >= threshold ? m_Values[p] : out[q];
+        }
+      }
+  }
+
+  unsigned int GetWidth() const
+  {
+    return m_Width;
+  }
+  unsigned int GetHeight() const
+  {
+    return m_Height;
+  }
+
+  /** Parent of each pixel: the canonical pixel of its node, or of the
+   * parent node for canonical pixels */
+  const NodeListType & GetParents() const
+  {
+    return m_Parent;
+  }
+  /** Area of the node of each canonical pixel */
+  const NodeListType & GetAreas() const
+  {
+    return m_Area;
+  }
+  /** Pixels from the leaves to the root */
+  const NodeListType & GetSortedPixels() const
+  {
+    return m_SortedPixels;
+  }
+
+private:
+  static NodeType FindRoot(NodeListType & zpar, NodeType p)
+  {
+    NodeType r = p;
+    while (zpar[r] != r)
+      {
+      r = zpar[r];
+      }
+    while (zpar[p] != r)
+      {
+      const NodeType next = zpar[p];
+      zpar[p] = r;
+      p = next;
+      }
+    return r;
+  }
+
+  unsigned int           m_Width;
+  unsigned int           m_Height;
+  std::vector<ValueType> m_Values;
+  NodeListType           m_SortedPixels;
+  NodeListType           m_Parent;
+  NodeListType           m_Area;
+};
+
+} // End namespace otb
+
+#endif
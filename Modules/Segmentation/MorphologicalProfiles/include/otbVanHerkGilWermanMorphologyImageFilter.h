@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbVanHerkGilWermanMorphologyImageFilter_h
+#define otbVanHerkGilWermanMorphologyImageFilter_h
+
+#include "itkImageToImageFilter.h"
+
+#include <functional>
+#include <vector>
+
+namespace otb
+{
+/** \class VanHerkGilWermanMorphologyImageFilter
+ *  \brief Grayscale dilation, erosion, opening or closing by line
+ *  decompositions of box, ball and cross structuring elements.
+ *
+ * The structuring element is decomposed into symmetric line segments,
+ * horizontal or vertical:
+ *  - a box is the Minkowski sum of a horizontal and a vertical segment,
+ *  - a ball, the one of itk::FlatStructuringElement::Ball, is the union
+ *    of the largest boxes it contains, about one per pixel of its radius,
+ *  - a cross is the union of a horizontal and a vertical segment.
+ *
+ * The running minimum or maximum along each segment is computed with the
+ * van Herk / Gil-Werman algorithm, with three comparisons per pixel
+ * whatever the segment length. The vertical segments are processed a
+ * whole row at a time, so that the inner loops run over contiguous
+ * memory and are vectorized by the compiler.
+ *
+ * Each pass runs over the whole requested region, padded once for all the
+ * operations, its rows or blocks of rows being split among the threads:
+ * no margin is computed twice.
+ *
+ * The pixels outside the image are ignored, as in
+ * itk::GrayscaleDilateImageFilter and itk::GrayscaleErodeImageFilter, and
+ * the opening and closing are the compositions of these filters: the
+ * outputs are the same as theirs for the same structuring element.
+ *
+ * (see M. van Herk, "A fast algorithm for local minimum and maximum filters
+ * on rectangular and octagonal kernels", Pattern Recognition Letters 13, 1992,
+ * and J. Gil, M. Werman, "Computing 2-D min, median, and max filters",
+ * IEEE PAMI vol. 15, no. 5, 1993)
+ *
+ * \sa itk::GrayscaleDilateImageFilter
+ * \sa itk::GrayscaleErodeImageFilter
+ *
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ *
+ * \ingroup OTBMorphologicalProfiles
+ */
+template <class TInputImage, class TOutputImage>
+class ITK_EXPORT VanHerkGilWermanMorphologyImageFilter
+  : public itk::ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  /** Standard typedefs */
+  typedef VanHerkGilWermanMorphologyImageFilter              Self;
+  typedef itk::ImageToImageFilter<TInputImage, TOutputImage> Superclass;
+  typedef itk::SmartPointer<Self>                            Pointer;
+  typedef itk::SmartPointer<const Self>                      ConstPointer;
+
+  /** Type macro */
+  itkNewMacro(Self);
+
+  /** Creation through object factory macro */
+  itkTypeMacro(VanHerkGilWermanMorphologyImageFilter, ImageToImageFilter);
+
+  /** Template parameters typedefs */
+  typedef TInputImage                           InputImageType;
+  typedef typename InputImageType::PixelType    InputPixelType;
+  typedef TOutputImage                          OutputImageType;
+  typedef typename OutputImageType::PixelType   OutputPixelType;
+  typedef typename OutputImageType::RegionType  RegionType;
+  typedef typename InputImageType::SizeType     SizeType;
+
+  typedef enum {DILATE, ERODE, OPENING, CLOSING} OperationType;
+  typedef enum {BOX, BALL, CROSS}                ShapeType;
+
+  /** Set/Get the morphological operation (default DILATE) */
+  itkSetMacro(Operation, OperationType);
+  itkGetConstMacro(Operation, OperationType);
+
+  /** Set/Get the structuring element shape (default BOX) */
+  itkSetMacro(Shape, ShapeType);
+  itkGetConstMacro(Shape, ShapeType);
+
+  /** Set/Get the structuring element radius */
+  itkSetMacro(Radius, SizeType);
+  itkGetConstReferenceMacro(Radius, SizeType);
+
+protected:
+  VanHerkGilWermanMorphologyImageFilter();
+  ~VanHerkGilWermanMorphologyImageFilter() override {}
+
+  void GenerateInputRequestedRegion() override;
+
+  void GenerateData() override;
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+private:
+  VanHerkGilWermanMorphologyImageFilter(const Self &) = delete;
+  void operator =(const Self&) = delete;
+
+  /** Symmetric segment of 2 * HalfLength + 1 pixels along (DeltaX, DeltaY),
+   * horizontal (1, 0) or vertical (0, 1) */
+  struct LineType
+  {
+    int          DeltaX;
+    int          DeltaY;
+    unsigned int HalfLength;
+  };
+  typedef std::vector<LineType> PathType;
+
+  /** Segments of the structuring element: the element is the union of
+   * the Minkowski sums of the segments of each path */
+  std::vector<PathType> GetPaths() const;
+
+  /** Margin needed around a region for one dilation or erosion */
+  SizeType GetExtent() const;
+
+  /** Dilation (compare is the maximum) or erosion (compare is the
+   * minimum) of a width x height buffer by a path, in place, the values
+   * near the buffer border being left unchanged */
+  template <class TCompare>
+  void ApplyPath(std::vector<InputPixelType> & buffer, unsigned int width, unsigned int height,
+                 const PathType & path, TCompare compare,
+                 std::vector<InputPixelType> & forward, std::vector<InputPixelType> & backward);
+
+  template <class TCompare>
+  void ApplyLine(std::vector<InputPixelType> & buffer, unsigned int width, unsigned int height,
+                 const LineType & line, TCompare compare,
+                 std::vector<InputPixelType> & forward, std::vector<InputPixelType> & backward);
+
+  typedef std::function<void(unsigned int, unsigned int)> JobType;
+
+  /** Run the job over contiguous ranges [begin, end) of [0, count),
+   * one per thread */
+  void SplitAmongThreads(unsigned int count, const JobType & job);
+
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback(void *arg);
+
+  /** Internal structure used for passing data into the threading library */
+  struct ThreadStruct
+  {
+    const JobType * Job;
+    unsigned int    Count;
+  };
+
+  OperationType         m_Operation;
+  ShapeType             m_Shape;
+  SizeType              m_Radius;
+};
+
+} // End namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbVanHerkGilWermanMorphologyImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,464 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbVanHerkGilWermanMorphologyImageFilter_hxx
+#define otbVanHerkGilWermanMorphologyImageFilter_hxx
+
+#include "otbVanHerkGilWermanMorphologyImageFilter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkFlatStructuringElement.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace otb
+{
+template <class TInputImage, class TOutputImage>
+VanHerkGilWermanMorphologyImageFilter<TInputImage, TOutputImage>
+::VanHerkGilWermanMorphologyImageFilter()
+  : m_Operation(DILATE),
+    m_Shape(BOX)
+{
+  m_Radius.Fill(1);
+}
+
+template <class TInputImage, class TOutputImage>
+std::vector<typename VanHerkGilWermanMorphologyImageFilter<TInputImage, TOutputImage>::PathType>
+VanHerkGilWermanMorphologyImageFilter<TInputImage, TOutputImage>
+::GetPaths() const
+{
+  const unsigned int rx = m_Radius[0];
+  const unsigned int ry = m_Radius[1];
+  const LineType horizontal = {1, 0, rx};
+  const LineType vertical = {0, 1, ry};
+
+  std::vector<PathType> paths;
+  switch (m_Shape)
+    {
+    case BOX:
+      paths.push_back(PathType{horizontal, vertical});
+      break;
+    case CROSS:
+      paths.push_back(PathType{horizontal});
+      paths.push_back(PathType{vertical});
+      break;
+    case BALL:
+      {
+      // The rows of the ball are centered segments, narrowing away from
+      // the center: the ball is the union of the boxes whose half height is
+      // a row offset and whose half width is the half length of this row,
+      // when the next row is shorter
+      typedef itk::FlatStructuringElement<2> BallType;
+      typename BallType::RadiusType ballRadius;
+      ballRadius[0] = rx;
+      ballRadius[1] = ry;
+      const BallType ball = BallType::Ball(ballRadius);
+      std::vector<unsigned int> halfWidths(ry + 1, 0);
+      for (unsigned int i = 0; i < ball.Size(); ++i)
+        {
+        const typename BallType::OffsetType offset = ball.GetOffset(i);
+        if (ball[i] && offset[1] >= 0)
+          {
+          halfWidths[offset[1]] = std::max<unsigned int>(halfWidths[offset[1]], std::abs(offset[0]));
+          }
+        }
+      for (unsigned int y = 0; y <= ry; ++y)
+        {
+        if (y == ry || halfWidths[y] > halfWidths[y + 1])
+          {
+          const LineType boxHorizontal = {1, 0, halfWidths[y]};
+          const LineType boxVertical = {0, 1, y};
+          paths.push_back(PathType{boxHorizontal, boxVertical});
+          }
+        }
+      break;
+      }
+    }
+  return paths;
+}
+
+template <class TInputImage, class TOutputImage>
+typename VanHerkGilWermanMorphologyImageFilter<TInputImage, TOutputImage>::SizeType
+VanHerkGilWermanMorphologyImageFilter<TInputImage, TOutputImage>
+::GetExtent() const
+{
+  SizeType extent;
+  extent.Fill(0);
+  const std::vector<PathType> paths = this->GetPaths();
+  for (const auto & path : paths)
+    {
+    unsigned long extentX = 0;
+    unsigned long extentY = 0;
+    for (const auto & line : path)
+      {
+      extentX += line.DeltaX * line.HalfLength;
+      extentY += line.DeltaY * line.HalfLength;
+      }
+    extent[0] = std::max<unsigned long>(extent[0], extentX);
+    extent[1] = std::max<unsigned long>(extent[1], extentY);
+    }
+  return extent;
+}
+
+template <class TInputImage, class TOutputImage>
+void
+VanHerkGilWermanMorphologyImageFilter<TInputImage, TOutputImage>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType * inputPtr = const_cast<InputImageType *>(this->GetInput());
+  if (!inputPtr)
+    {
+    return;
+    }
+
+  const unsigned int nbOperations = (m_Operation == OPENING || m_Operation == CLOSING) ? 2 : 1;
+  SizeType radius = this->GetExtent();
+  radius[0] *= nbOperations;
+  radius[1] *= nbOperations;
+
+  typename InputImageType::RegionType region = this->GetOutput()->GetRequestedRegion();
+  region.PadByRadius(radius);
+  region.Crop(inputPtr->GetLargestPossibleRegion());
+  inputPtr->SetRequestedRegion(region);
+}
+
+template <class TInputImage, class TOutputImage>
+void
+VanHerkGilWermanMorphologyImageFilter<TInputImage, TOutputImage>
+::GenerateData()
+{
+  this->AllocateOutputs();
+
+  const InputImageType * inputPtr = this->GetInput();
+  OutputImageType *      outputPtr = this->GetOutput();
+  const RegionType       outputRegion = outputPtr->GetRequestedRegion();
+  const std::vector<PathType> paths = this->GetPaths();
+
+  // Successive dilations (true) and erosions (false)
+  std::vector<bool> dilations;
+  switch (m_Operation)
+    {
+    case DILATE:
+      dilations.push_back(true);
+      break;
+    case ERODE:
+      dilations.push_back(false);
+      break;
+    case OPENING:
+      dilations.push_back(false);
+      dilations.push_back(true);
+      break;
+    case CLOSING:
+      dilations.push_back(true);
+      dilations.push_back(false);
+      break;
+    }
+
+  // Window of the output region, padded for all the operations. The
+  // window pixels outside the image get the neutral value of each
+  // operation, so that they are ignored.
+  SizeType radius = this->GetExtent();
+  radius[0] *= dilations.size();
+  radius[1] *= dilations.size();
+  RegionType window = outputRegion;
+  window.PadByRadius(radius);
+  RegionType inside = window;
+  inside.Crop(inputPtr->GetLargestPossibleRegion());
+
+  const unsigned int width = window.GetSize(0);
+  const unsigned int height = window.GetSize(1);
+  const long startX = window.GetIndex(0);
+  const long startY = window.GetIndex(1);
+  const unsigned int insideBeginX = inside.GetIndex(0) - startX;
+  const unsigned int insideEndX = insideBeginX + inside.GetSize(0);
+  const unsigned int insideBeginY = inside.GetIndex(1) - startY;
+  const unsigned int insideEndY = insideBeginY + inside.GetSize(1);
+
+  std::vector<InputPixelType> buffer(static_cast<std::size_t>(width) * height);
+  itk::ImageRegionConstIteratorWithIndex<InputImageType> inIt(inputPtr, inside);
+  for (inIt.GoToBegin(); !inIt.IsAtEnd(); ++inIt)
+    {
+    const typename InputImageType::IndexType & index = inIt.GetIndex();
+    buffer[static_cast<std::size_t>(index[1] - startY) * width + index[0] - startX] = inIt.Get();
+    }
+
+  auto maximum = [](InputPixelType a, InputPixelType b) { return std::max(a, b); };
+  auto minimum = [](InputPixelType a, InputPixelType b) { return std::min(a, b); };
+
+  std::vector<InputPixelType> forward;
+  std::vector<InputPixelType> backward;
+  std::vector<InputPixelType> pathBuffer;
+  for (unsigned int operation = 0; operation < dilations.size(); ++operation)
+    {
+    const bool dilate = dilations[operation];
+    const InputPixelType neutral = dilate ? itk::NumericTraits<InputPixelType>::NonpositiveMin()
+                                          : itk::NumericTraits<InputPixelType>::max();
+    for (unsigned int y = 0; y < height; ++y)
+      {
+      typename std::vector<InputPixelType>::iterator row = buffer.begin() + static_cast<std::size_t>(y) * width;
+      if (y < insideBeginY || y >= insideEndY)
+        {
+        std::fill(row, row + width, neutral);
+        }
+      else
+        {
+        std::fill(row, row + insideBeginX, neutral);
+        std::fill(row + insideEndX, row + width, neutral);
+        }
+      }
+
+    if (paths.size() == 1)
+      {
+      if (dilate)
+        {
+        this->ApplyPath(buffer, width, height, paths.front(), maximum, forward, backward);
+        }
+      else
+        {
+        this->ApplyPath(buffer, width, height, paths.front(), minimum, forward, backward);
+        }
+      }
+    else
+      {
+      // Union of structuring elements: combine the result of each path
+      std::vector<InputPixelType> result;
+      for (const auto & path : paths)
+        {
+        pathBuffer = buffer;
+        if (dilate)
+          {
+          this->ApplyPath(pathBuffer, width, height, path, maximum, forward, backward);
+          }
+        else
+          {
+          this->ApplyPath(pathBuffer, width, height, path, minimum, forward, backward);
+          }
+        if (result.empty())
+          {
+          result.swap(pathBuffer);
+          }
+        else if (dilate)
+          {
+          std::transform(result.begin(), result.end(), pathBuffer.begin(), result.begin(), maximum);
+          }
+        else
+          {
+          std::transform(result.begin(), result.end(), pathBuffer.begin(), result.begin(), minimum);
+          }
+        }
+      buffer.swap(result);
+      }
+    this->UpdateProgress(static_cast<float>(operation + 1) / dilations.size());
+    }
+
+  itk::ImageRegionIteratorWithIndex<OutputImageType> outIt(outputPtr, outputRegion);
+  for (outIt.GoToBegin(); !outIt.IsAtEnd(); ++outIt)
+    {
+    const typename OutputImageType::IndexType & index = outIt.GetIndex();
+    outIt.Set(static_cast<OutputPixelType>(buffer[static_cast<std::size_t>(index[1] - startY) * width + index[0] - startX]));
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+VanHerkGilWermanMorphologyImageFilter<TInputImage, TOutputImage>
+::SplitAmongThreads(unsigned int count, const JobType & job)
+{
+  if (count == 0)
+    {
+    return;
+    }
+
+  ThreadStruct str;
+  str.Job = &job;
+  str.Count = count;
+
+  const unsigned int nbThreads =
+    std::min(static_cast<unsigned int>(std::max(1, static_cast<int>(this->GetNumberOfThreads()))), count);
+  this->GetMultiThreader()->SetNumberOfThreads(nbThreads);
+  this->GetMultiThreader()->SetSingleMethod(this->ThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+}
+
+template <class TInputImage, class TOutputImage>
+ITK_THREAD_RETURN_TYPE
+VanHerkGilWermanMorphologyImageFilter<TInputImage, TOutputImage>
+::ThreaderCallback(void *arg)
+{
+  const unsigned int threadId = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->ThreadID;
+  const unsigned int threadCount = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->NumberOfThreads;
+  ThreadStruct * str = (ThreadStruct *) (((itk::MultiThreader::ThreadInfoStruct *) (arg))->UserData);
+
+  const unsigned int begin = static_cast<unsigned long>(str->Count) * threadId / threadCount;
+  const unsigned int end = static_cast<unsigned long>(str->Count) * (threadId + 1) / threadCount;
+  if (begin < end)
+    {
+    (*str->Job)(begin, end);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TInputImage, class TOutputImage>
+template <class TCompare>
+void
+VanHerkGilWermanMorphologyImageFilter<TInputImage, TOutputImage>
+::ApplyPath(std::vector<InputPixelType> & buffer, unsigned int width, unsigned int height,
+            const PathType & path, TCompare compare,
+            std::vector<InputPixelType> & forward, std::vector<InputPixelType> & backward)
+{
+  for (const auto & line : path)
+    {
+    this->ApplyLine(buffer, width, height, line, compare, forward, backward);
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+template <class TCompare>
+void
+VanHerkGilWermanMorphologyImageFilter<TInputImage, TOutputImage>
+::ApplyLine(std::vector<InputPixelType> & buffer, unsigned int width, unsigned int height,
+            const LineType & line, TCompare compare,
+            std::vector<InputPixelType> & forward, std::vector<InputPixelType> & backward)
+{
+  const unsigned int k = line.HalfLength;
+  if (k == 0)
+    {
+    return;
+    }
+  // The segment is cut into blocks of its length: each output is the
+  // combination of a backward running value in a block and a forward
+  // running value in the next one
+  const unsigned int length = 2 * k + 1;
+  InputPixelType * f = buffer.data();
+
+  if (line.DeltaY == 0)
+    {
+    if (width <= 2 * k)
+      {
+      return;
+      }
+    // The rows are independent
+    this->SplitAmongThreads(height, [=](unsigned int beginY, unsigned int endY)
+      {
+      std::vector<InputPixelType> rowForward(width);
+      std::vector<InputPixelType> rowBackward(width);
+      for (unsigned int y = beginY; y < endY; ++y)
+        {
+        InputPixelType * row = f + static_cast<std::size_t>(y) * width;
+        for (unsigned int x = 0; x < width; ++x)
+          {
+          rowForward[x] = (x % length == 0) ? row[x] : compare(rowForward[x - 1], row[x]);
+          }
+        for (unsigned int x = width; x-- > 0;)
+          {
+          rowBackward[x] = (x % length == length - 1 || x == width - 1) ? row[x] : compare(rowBackward[x + 1], row[x]);
+          }
+        for (unsigned int x = k; x + k < width; ++x)
+          {
+          row[x] = compare(rowBackward[x - k], rowForward[x + k]);
+          }
+        }
+      });
+    return;
+    }
+
+  // Vertical segments: whole rows at a time
+  if (height <= 2 * k)
+    {
+    return;
+    }
+  const std::size_t nbPixels = static_cast<std::size_t>(width) * height;
+  forward.resize(nbPixels);
+  backward.resize(nbPixels);
+  InputPixelType * forwardBuffer = forward.data();
+  InputPixelType * backwardBuffer = backward.data();
+
+  // The running values restart at each block of rows, so that the blocks
+  // are independent
+  const unsigned int nbBlocks = (height + length - 1) / length;
+  this->SplitAmongThreads(nbBlocks, [=](unsigned int beginBlock, unsigned int endBlock)
+    {
+    const unsigned int beginY = beginBlock * length;
+    const unsigned int endY = std::min(endBlock * length, height);
+    for (unsigned int y = beginY; y < endY; ++y)
+      {
+      const InputPixelType * row = f + static_cast<std::size_t>(y) * width;
+      InputPixelType *       fwd = forwardBuffer + static_cast<std::size_t>(y) * width;
+      if (y % length == 0)
+        {
+        std::copy(row, row + width, fwd);
+        continue;
+        }
+      const InputPixelType * previous = fwd - width;
+      for (unsigned int x = 0; x < width; ++x)
+        {
+        fwd[x] = compare(previous[x], row[x]);
+        }
+      }
+    for (unsigned int y = endY; y-- > beginY;)
+      {
+      const InputPixelType * row = f + static_cast<std::size_t>(y) * width;
+      InputPixelType *       bwd = backwardBuffer + static_cast<std::size_t>(y) * width;
+      if (y % length == length - 1 || y == height - 1)
+        {
+        std::copy(row, row + width, bwd);
+        continue;
+        }
+      const InputPixelType * next = bwd + width;
+      for (unsigned int x = 0; x < width; ++x)
+        {
+        bwd[x] = compare(next[x], row[x]);
+        }
+      }
+    });
+
+  this->SplitAmongThreads(height - 2 * k, [=](unsigned int begin, unsigned int end)
+    {
+    for (unsigned int y = begin + k; y < end + k; ++y)
+      {
+      InputPixelType *       row = f + static_cast<std::size_t>(y) * width;
+      const InputPixelType * bwd = backwardBuffer + static_cast<std::size_t>(y - k) * width;
+      const InputPixelType * fwd = forwardBuffer + static_cast<std::size_t>(y + k) * width;
+      for (unsigned int x = 0; x < width; ++x)
+        {
+        row[x] = compare(bwd[x], fwd[x]);
+        }
+      }
+    });
+}
+
+template <class TInputImage, class TOutputImage>
+void
+VanHerkGilWermanMorphologyImageFilter<TInputImage, TOutputImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Operation: " << m_Operation << std::endl;
+  os << indent << "Shape: " << m_Shape << std::endl;
+  os << indent << "Radius: " << m_Radius << std::endl;
+}
+
+} // End namespace otb
+
+#endif
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "otbAttributeProfilesImageFilter.h"
+#include "otbImage.h"
+#include "otbVectorImage.h"
+#include "otbImageFileReader.h"
+#include "itkStreamingImageFilter.h"
+#include "itkAreaOpeningImageFilter.h"
+#include "itkAreaClosingImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <cmath>
+
+namespace
+{
+
+// Check one band of the streamed profile against a reference image
+template <class TVectorImage, class TImage>
+bool CheckBand(const TVectorImage * profile, unsigned int band, const TImage * reference)
+{
+  itk::ImageRegionConstIterator<TVectorImage> it(profile, profile->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<TImage>       refIt(reference, reference->GetLargestPossibleRegion());
+  for (it.GoToBegin(), refIt.GoToBegin(); !it.IsAtEnd(); ++it, ++refIt)
+    {
+    if (it.Get()[band] != refIt.Get())
+      {
+      std::cerr << "Wrong value at " << it.GetIndex() << " band " << band << ": got " << it.Get()[band]
+                << ", expected " << refIt.Get() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+}
+
+int otbAttributeProfilesImageFilter(int argc, char * argv[])
+{
+  if (argc < 4)
+    {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " inputImageFile nbStreamDivisions threshold1 threshold2 ..." << std::endl;
+    return EXIT_FAILURE;
+    }
+  const char *       inputFilename = argv[1];
+  const unsigned int nbDivisions = atoi(argv[2]);
+
+  const unsigned int Dimension = 2;
+  typedef float                                   PixelType;
+  typedef otb::Image<PixelType, Dimension>        InputImageType;
+  typedef otb::VectorImage<PixelType, Dimension>  OutputImageType;
+  typedef otb::ImageFileReader<InputImageType>    ReaderType;
+
+  typedef otb::AttributeProfilesImageFilter<InputImageType, OutputImageType> AttributeProfilesFilterType;
+  typedef itk::StreamingImageFilter<OutputImageType, OutputImageType>        StreamingFilterType;
+  typedef itk::AreaOpeningImageFilter<InputImageType, InputImageType>        AreaOpeningFilterType;
+  typedef itk::AreaClosingImageFilter<InputImageType, InputImageType>        AreaClosingFilterType;
+
+  AttributeProfilesFilterType::ThresholdListType thresholds;
+  for (int i = 3; i < argc; ++i)
+    {
+    thresholds.push_back(atoi(argv[i]));
+    }
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(inputFilename);
+
+  AttributeProfilesFilterType::Pointer profiles = AttributeProfilesFilterType::New();
+  profiles->SetInput(reader->GetOutput());
+  profiles->SetThresholds(thresholds);
+
+  StreamingFilterType::Pointer openingStreamer = StreamingFilterType::New();
+  openingStreamer->SetInput(profiles->GetOpeningProfileOutput());
+  openingStreamer->SetNumberOfStreamDivisions(nbDivisions);
+  openingStreamer->Update();
+
+  StreamingFilterType::Pointer closingStreamer = StreamingFilterType::New();
+  closingStreamer->SetInput(profiles->GetClosingProfileOutput());
+  closingStreamer->SetNumberOfStreamDivisions(nbDivisions);
+  closingStreamer->Update();
+
+  // Reference: one area opening and closing per threshold, on the whole image
+  for (unsigned int i = 0; i < thresholds.size(); ++i)
+    {
+    AreaOpeningFilterType::Pointer opening = AreaOpeningFilterType::New();
+    opening->SetInput(reader->GetOutput());
+    opening->SetLambda(thresholds[i]);
+    opening->SetUseImageSpacing(false);
+    opening->Update();
+    if (!CheckBand(openingStreamer->GetOutput(), i, opening->GetOutput()))
+      {
+      std::cerr << "Opening profile differs at level " << i << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    AreaClosingFilterType::Pointer closing = AreaClosingFilterType::New();
+    closing->SetInput(reader->GetOutput());
+    closing->SetLambda(thresholds[i]);
+    closing->SetUseImageSpacing(false);
+    closing->Update();
+    if (!CheckBand(closingStreamer->GetOutput(), i, closing->GetOutput()))
+      {
+      std::cerr << "Closing profile differs at level " << i << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Derivative and characteristics of the opening profile
+  profiles->GetOpeningDerivativeOutput()->SetRequestedRegionToLargestPossibleRegion();
+  profiles->GetOpeningDerivativeOutput()->Update();
+  itk::ImageRegionConstIterator<OutputImageType> profileIt(openingStreamer->GetOutput(),
+                                                           openingStreamer->GetOutput()->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<OutputImageType> derivativeIt(profiles->GetOpeningDerivativeOutput(),
+                                                              profiles->GetOpeningDerivativeOutput()->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<OutputImageType> characteristicsIt(profiles->GetOpeningCharacteristicsOutput(),
+                                                                   profiles->GetOpeningCharacteristicsOutput()->GetLargestPossibleRegion());
+  for (profileIt.GoToBegin(), derivativeIt.GoToBegin(), characteristicsIt.GoToBegin(); !profileIt.IsAtEnd();
+       ++profileIt, ++derivativeIt, ++characteristicsIt)
+    {
+    PixelType maximum = 0;
+    PixelType characteristic = 0;
+    for (unsigned int i = 1; i < thresholds.size(); ++i)
+      {
+      const PixelType derivative = std::abs(profileIt.Get()[i] - profileIt.Get()[i - 1]);
+      if (derivativeIt.Get()[i - 1] != derivative)
+        {
+        std::cerr << "Wrong derivative at " << profileIt.GetIndex() << std::endl;
+        return EXIT_FAILURE;
+        }
+      if (derivative > maximum)
+        {
+        maximum = derivative;
+        characteristic = i - 1;
+        }
+      }
+    if (characteristicsIt.Get()[0] != maximum || characteristicsIt.Get()[1] != characteristic)
+      {
+      std::cerr << "Wrong characteristics at " << profileIt.GetIndex() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "otbVanHerkGilWermanMorphologyImageFilter.h"
+#include "otbImage.h"
+#include "otbImageFileReader.h"
+#include "itkStreamingImageFilter.h"
+#include "itkFlatStructuringElement.h"
+#include "itkGrayscaleDilateImageFilter.h"
+#include "itkGrayscaleErodeImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+
+namespace
+{
+
+template <class TImage>
+bool SameImages(const TImage * image, const TImage * reference)
+{
+  itk::ImageRegionConstIterator<TImage> it(image, image->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<TImage> refIt(reference, reference->GetLargestPossibleRegion());
+  for (it.GoToBegin(), refIt.GoToBegin(); !it.IsAtEnd(); ++it, ++refIt)
+    {
+    if (it.Get() != refIt.Get())
+      {
+      std::cerr << "Wrong value at " << it.GetIndex() << ": got " << it.Get() << ", expected " << refIt.Get() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+}
+
+int otbVanHerkGilWermanMorphologyImageFilter(int argc, char * argv[])
+{
+  if (argc != 5)
+    {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " inputImageFile xRadius yRadius nbStreamDivisions" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int Dimension = 2;
+  typedef float                                PixelType;
+  typedef otb::Image<PixelType, Dimension>     ImageType;
+  typedef otb::ImageFileReader<ImageType>      ReaderType;
+  typedef itk::FlatStructuringElement<Dimension> StructuringType;
+
+  typedef otb::VanHerkGilWermanMorphologyImageFilter<ImageType, ImageType>     FilterType;
+  typedef itk::StreamingImageFilter<ImageType, ImageType>                      StreamingFilterType;
+  typedef itk::GrayscaleDilateImageFilter<ImageType, ImageType, StructuringType> DilateFilterType;
+  typedef itk::GrayscaleErodeImageFilter<ImageType, ImageType, StructuringType>  ErodeFilterType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  FilterType::SizeType radius;
+  radius[0] = atoi(argv[2]);
+  radius[1] = atoi(argv[3]);
+  const unsigned int nbDivisions = atoi(argv[4]);
+
+  StructuringType::RadiusType seRadius;
+  seRadius[0] = radius[0];
+  seRadius[1] = radius[1];
+
+  const FilterType::ShapeType shapes[3] = {FilterType::BOX, FilterType::CROSS, FilterType::BALL};
+  const FilterType::OperationType operations[4] = {FilterType::DILATE, FilterType::ERODE,
+                                                   FilterType::OPENING, FilterType::CLOSING};
+
+  for (unsigned int s = 0; s < 3; ++s)
+    {
+    for (unsigned int o = 0; o < 4; ++o)
+      {
+      FilterType::Pointer filter = FilterType::New();
+      filter->SetInput(reader->GetOutput());
+      filter->SetShape(shapes[s]);
+      filter->SetOperation(operations[o]);
+      filter->SetRadius(radius);
+
+      StreamingFilterType::Pointer streamer = StreamingFilterType::New();
+      streamer->SetInput(filter->GetOutput());
+      streamer->SetNumberOfStreamDivisions(nbDivisions);
+      streamer->Update();
+
+      // The streamed output is the same as the one of the whole image
+      FilterType::Pointer wholeFilter = FilterType::New();
+      wholeFilter->SetInput(reader->GetOutput());
+      wholeFilter->SetShape(shapes[s]);
+      wholeFilter->SetOperation(operations[o]);
+      wholeFilter->SetRadius(radius);
+      wholeFilter->Update();
+      if (!SameImages(streamer->GetOutput(), wholeFilter->GetOutput()))
+        {
+        std::cerr << "Streaming changes the output of shape " << s << " operation " << o << std::endl;
+        return EXIT_FAILURE;
+        }
+
+      StructuringType se;
+      switch (shapes[s])
+        {
+        case FilterType::BOX:
+          se = StructuringType::Box(seRadius);
+          break;
+        case FilterType::BALL:
+          se = StructuringType::Ball(seRadius);
+          break;
+        case FilterType::CROSS:
+          se = StructuringType::Cross(seRadius);
+          break;
+        }
+      DilateFilterType::Pointer dilate = DilateFilterType::New();
+      dilate->SetKernel(se);
+      ErodeFilterType::Pointer erode = ErodeFilterType::New();
+      erode->SetKernel(se);
+
+      ImageType::Pointer reference;
+      switch (operations[o])
+        {
+        case FilterType::DILATE:
+          dilate->SetInput(reader->GetOutput());
+          dilate->Update();
+          reference = dilate->GetOutput();
+          break;
+        case FilterType::ERODE:
+          erode->SetInput(reader->GetOutput());
+          erode->Update();
+          reference = erode->GetOutput();
+          break;
+        case FilterType::OPENING:
+          erode->SetInput(reader->GetOutput());
+          dilate->SetInput(erode->GetOutput());
+          dilate->Update();
+          reference = dilate->GetOutput();
+          break;
+        case FilterType::CLOSING:
+          dilate->SetInput(reader->GetOutput());
+          erode->SetInput(dilate->GetOutput());
+          erode->Update();
+          reference = erode->GetOutput();
+          break;
+        }
+
+      if (!SameImages(streamer->GetOutput(), reference.GetPointer()))
+        {
+        std::cerr << "Wrong output for shape " << s << " operation " << o << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
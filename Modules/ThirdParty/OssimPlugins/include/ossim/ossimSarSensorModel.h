@@ -231,6 +231,22 @@ public:
     */
    virtual void worldToLineSample(const ossimGpt& worldPt, ossimDpt & imPt) const override;
 
+   /**
+    * Batched version of worldToLineSample(), with the same results up
+    * to rounding errors. The orbit records are turned once into the
+    * interpolation polynomials used by interpolateSensorPosVel(), and
+    * the orbit records around the zero-doppler time of each point are
+    * searched from the records of the previous point. Consecutive points
+    * should therefore be close to each other (as the pixels of an image
+    * line). Points outside of the orbit records are geocoded by
+    * worldToLineSample().
+    *
+    * \param[in] worldPts World points to geocode
+    * \param[out] imPts Corresponding estimated image points
+    * \param[in] count Number of points
+    */
+   void worldToLineSampleBatch(const ossimGpt* worldPts, ossimDpt* imPts, std::size_t count) const;
+
    /**
     * Sub-routine of lineSampleToWorld that computes azimuthTime and
     * slant range time from worldPoint
@@ -396,6 +412,16 @@ protected:
     */
    /*virtual*/ bool zeroDopplerLookup(const ossimEcefPoint & inputPt, TimeType & interpAzimuthTime, ossimEcefPoint & interpSensorPos, ossimEcefVector & interpSensorVel) const;
 
+   /**
+    * Convert azimuth time and range time to image point, as the last
+    * step of worldToLineSample().
+    *
+    * \param[in] azimuthTime The zero-doppler azimuth time
+    * \param[in] rangeTime The range time
+    * \param[out] imPt The corresponding image point
+    */
+   void azimuthRangeTimeToLineSample(const TimeType & azimuthTime, const double & rangeTime, ossimDpt & imPt) const;
+
    /**
     * Compute the bistatic correction to apply.
     *
@@ -32,6 +32,7 @@
 #include <ossim/base/ossimLsrSpace.h>
 #include <ossim/base/ossimKeywordNames.h>
 #include <boost/static_assert.hpp>
+#include <cmath>
 #include <iostream>
 #include <vector>
 #include <algorithm>
@@ -235,6 +236,11 @@ namespace ossimplugins
       // std::clog << "RangeTime: " << rangeTime << "\n";
       // std::clog << "GRD: " << isGRD() << "\n";
 
+      azimuthRangeTimeToLineSample(azimuthTime,rangeTime,imPt);
+   }
+
+   void ossimSarSensorModel::azimuthRangeTimeToLineSample(const TimeType & azimuthTime, const double & rangeTime, ossimDpt & imPt) const
+   {
       // Convert azimuth time to line
       azimuthTimeToLine(azimuthTime,imPt.y);
 
@@ -261,6 +267,205 @@ namespace ossimplugins
       }
    }
 
+   namespace
+   {
+      /**
+       * Orbit model equivalent to interpolateSensorPosVel(): each orbit
+       * record defines the Lagrange polynomial used for the times closest
+       * to it. The polynomials are stored in Newton form (divided
+       * differences), so that each evaluation costs one Horner scheme.
+       */
+      class OrbitPolynomials
+      {
+      public:
+         OrbitPolynomials(std::vector<ossimSarSensorModel::OrbitRecordType> const& records, unsigned int deg)
+         {
+            const unsigned int nbRecords = records.size();
+            m_times.resize(nbRecords);
+            for(unsigned int k = 0; k < nbRecords; ++k)
+            {
+               m_times[k] = (records[k].azimuthTime - records.front().azimuthTime).total_seconds();
+            }
+
+            // Same choice of records as in interpolateSensorPosVel()
+            m_windowOfRecord.resize(nbRecords);
+            for(unsigned int k = 0; k < nbRecords; ++k)
+            {
+               unsigned int nBegin(0), nEnd(0);
+               if(nbRecords<deg)
+               {
+                  nEnd = nbRecords-1;
+               }
+               else
+               {
+                  nBegin = std::max((int)k-(int)deg/2+1,(int)0);
+                  nEnd = std::min(nBegin+deg-1,nbRecords);
+                  nBegin = nEnd<nbRecords-1 ? nBegin : nEnd-deg+1;
+               }
+
+               if(m_windows.empty() || m_windows.back().begin != nBegin || m_windows.back().end != nEnd)
+               {
+                  m_windows.push_back(buildWindow(records, nBegin, nEnd));
+               }
+               m_windowOfRecord[k] = m_windows.size()-1;
+            }
+         }
+
+         /** Position and velocity at t, in seconds since the first record */
+         void evaluate(double t, double pos[3], double vel[3]) const
+         {
+            // Closest record, the first one in case of tie
+            const unsigned int idx = std::lower_bound(m_times.begin(), m_times.end(), t) - m_times.begin();
+            unsigned int k = idx;
+            if(idx == m_times.size())
+            {
+               k = idx-1;
+            }
+            else if(idx > 0 && t - m_times[idx-1] <= m_times[idx] - t)
+            {
+               k = idx-1;
+            }
+            const Window & window = m_windows[m_windowOfRecord[k]];
+            const unsigned int n = window.end - window.begin;
+
+            for(unsigned int dim = 0; dim < 3; ++dim)
+            {
+               pos[dim] = 0.;
+               vel[dim] = 0.;
+               if(n == 0)
+               {
+                  continue;
+               }
+               pos[dim] = window.pos[dim][n-1];
+               vel[dim] = window.vel[dim][n-1];
+               for(unsigned int j = n-1; j-- > 0; )
+               {
+                  const double u = t - m_times[window.begin+j];
+                  pos[dim] = pos[dim]*u + window.pos[dim][j];
+                  vel[dim] = vel[dim]*u + window.vel[dim][j];
+               }
+            }
+         }
+
+      private:
+         struct Window
+         {
+            unsigned int        begin;
+            unsigned int        end;
+            std::vector<double> pos[3];
+            std::vector<double> vel[3];
+         };
+
+         Window buildWindow(std::vector<ossimSarSensorModel::OrbitRecordType> const& records, unsigned int nBegin, unsigned int nEnd) const
+         {
+            Window window;
+            window.begin = nBegin;
+            window.end = nEnd;
+            const unsigned int n = nEnd - nBegin;
+            for(unsigned int dim = 0; dim < 3; ++dim)
+            {
+               window.pos[dim].resize(n);
+               window.vel[dim].resize(n);
+               for(unsigned int i = 0; i < n; ++i)
+               {
+                  window.pos[dim][i] = records[nBegin+i].position[dim];
+                  window.vel[dim][i] = records[nBegin+i].velocity[dim];
+               }
+               // Divided differences
+               for(unsigned int j = 1; j < n; ++j)
+               {
+                  for(unsigned int i = n-1; i >= j; --i)
+                  {
+                     const double dt = m_times[nBegin+i] - m_times[nBegin+i-j];
+                     window.pos[dim][i] = (window.pos[dim][i] - window.pos[dim][i-1]) / dt;
+                     window.vel[dim][i] = (window.vel[dim][i] - window.vel[dim][i-1]) / dt;
+                  }
+               }
+            }
+            return window;
+         }
+
+         std::vector<double>       m_times;
+         std::vector<Window>       m_windows;
+         std::vector<unsigned int> m_windowOfRecord;
+      };
+   }
+
+   void ossimSarSensorModel::worldToLineSampleBatch(const ossimGpt* worldPts, ossimDpt* imPts, std::size_t count) const
+   {
+      assert(theRangeResolution>0&&"theRangeResolution is null.");
+
+      // The bistatic correction is left to the point-wise implementation
+      if(theBistaticCorrectionNeeded || theOrbitRecords.size() < 2)
+      {
+         for(std::size_t i = 0; i < count; ++i)
+         {
+            worldToLineSample(worldPts[i], imPts[i]);
+         }
+         return;
+      }
+
+      const OrbitPolynomials orbit(theOrbitRecords, 8);
+      const TimeType & referenceTime = theOrbitRecords.front().azimuthTime;
+      const unsigned int nbRecords = theOrbitRecords.size();
+
+      // Record after the change of sign of the doppler for the previous
+      // point (0 when unknown)
+      unsigned int k = 0;
+      double pos[3], vel[3];
+
+      for(std::size_t i = 0; i < count; ++i)
+      {
+         const ossimEcefPoint inputPt(worldPts[i]);
+         auto doppler = [&](unsigned int r)
+         {
+            return (inputPt-theOrbitRecords[r].position).dot(theOrbitRecords[r].velocity);
+         };
+
+         // Same records as in zeroDopplerLookup(): the first ones around a
+         // change of sign of the doppler. The doppler of a ground point
+         // changes sign once along the orbit, so the search starts from
+         // the records of the previous point and walks towards the change.
+         const bool firstSign = doppler(0) < 0;
+         if(k == 0)
+         {
+            k = 1;
+         }
+         while(k > 1 && (doppler(k-1) < 0) != firstSign)
+         {
+            --k;
+         }
+         while(k < nbRecords && (doppler(k) < 0) == firstSign)
+         {
+            ++k;
+         }
+         if(k == nbRecords)
+         {
+            // Extrapolation is left to the point-wise implementation
+            k = 0;
+            worldToLineSample(worldPts[i], imPts[i]);
+            continue;
+         }
+
+         // Linear interpolation of the doppler between the two records, as
+         // in zeroDopplerLookup()
+         const OrbitRecordType & record1 = theOrbitRecords[k-1];
+         const OrbitRecordType & record2 = theOrbitRecords[k];
+         const double absDoppler1 = std::abs(doppler(k-1));
+         const double interp = absDoppler1 / (absDoppler1 + std::abs(doppler(k)));
+         const DurationType deltaTd = record2.azimuthTime - record1.azimuthTime;
+         const TimeType azimuthTime = record1.azimuthTime + deltaTd * interp + theAzimuthTimeOffset;
+
+         orbit.evaluate((azimuthTime - referenceTime).total_seconds(), pos, vel);
+         const double dx = pos[0]-inputPt[0];
+         const double dy = pos[1]-inputPt[1];
+         const double dz = pos[2]-inputPt[2];
+         const double rangeTime = theRangeTimeOffset + 2*std::sqrt(dx*dx+dy*dy+dz*dz)/C;
+
+         azimuthRangeTimeToLineSample(azimuthTime, rangeTime, imPts[i]);
+      }
+   }
+
 void ossimSarSensorModel::worldToLineSampleYZ(const ossimGpt& worldPt, ossimDpt & imPt, double & y, double & z) const
    {
       // std::clog << "ossimSarSensorModel::worldToLineSample()\n";
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbWrapperApplicationChain_h
+#define otbWrapperApplicationChain_h
+
+#include "otbWrapperApplication.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace otb
+{
+namespace Wrapper
+{
+
+/** \class ApplicationChain
+ *  \brief Run several applications as one streamed pipeline
+ *
+ * An ApplicationChain holds a list of applications, each one registered
+ * under an identifier, and a list of connections between an output image
+ * parameter of one application and an input image parameter of another one.
+ * Keys are prefixed by the application identifier: "calib.out" refers to
+ * parameter "out" of the application registered as "calib".
+ *
+ * Connections are made in memory, with SetParameterInputImage() (or
+ * AddImageToParameterInputImageList() for image lists), so that no
+ * intermediate file is written. Execute() calls Execute() on each
+ * application, in the order they were added, and ExecuteAndWriteOutput()
+ * triggers the writers of the terminal applications only (the ones whose
+ * outputs are not connected). The whole chain is then streamed by these
+ * writers as a single ITK pipeline.
+ *
+ * A chain can be loaded from an XML file with several <application> nodes
+ * (in the format used by InputProcessXMLParameter, with an additional "id"
+ * attribute) and <connection from="id1.key" to="id2.key"/> nodes.
+ *
+ * \ingroup OTBApplicationEngine
+ */
+class OTBApplicationEngine_EXPORT ApplicationChain : public itk::Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef ApplicationChain              Self;
+  typedef itk::Object                   Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Defining ::New() static method */
+  itkNewMacro(Self);
+
+  /** RTTI support */
+  itkTypeMacro(ApplicationChain, itk::Object);
+
+  /** A connection between an output key and an input key */
+  typedef std::pair<std::string, std::string> ConnectionType;
+
+  /** Instantiate an application and register it under the given identifier.
+   * If the identifier is empty, the application name is used. */
+  Application* AddApplication(const std::string & appType, std::string id = std::string());
+
+  /** Get a registered application */
+  Application* GetApplication(const std::string & id) const;
+
+  /** Identifiers of the registered applications, in insertion order */
+  const std::vector<std::string> & GetApplicationIds() const
+  {
+    return m_Order;
+  }
+
+  /** Connect an output image parameter to an input image parameter.
+   * Both keys are prefixed by an application identifier. The source
+   * application has to be added before the destination one. */
+  void Connect(const std::string & fromKey, const std::string & toKey);
+
+  /** Set a parameter from its string values. The key is prefixed by an
+   * application identifier. List parameters use all the values, output
+   * images accept an optional pixel type as second value. */
+  void SetParameterValues(const std::string & key, const std::vector<std::string> & values);
+
+  /** Load applications, parameters and connections from a chain XML file */
+  void Load(const std::string & filename);
+
+  /** Execute all the applications of the chain, in order */
+  int Execute();
+
+  /** Execute the chain and write the outputs of the terminal applications */
+  int ExecuteAndWriteOutput();
+
+  /** Logger shared by all the applications of the chain */
+  otb::Logger* GetLogger() const;
+
+protected:
+  ApplicationChain();
+  ~ApplicationChain() override;
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+private:
+  ApplicationChain(const Self &) = delete;
+  void operator =(const Self&) = delete;
+
+  /** Split a prefixed key into an application and a parameter key */
+  Application* DecodeKey(const std::string & key, std::string & paramKey) const;
+
+  /** Plug the outputs of upstream applications into the given application */
+  void ApplyConnections(const std::string & id);
+
+  /** True if one of the outputs of the application is connected */
+  bool IsConnectedOutput(const std::string & id) const;
+
+  std::map<std::string, Application::Pointer> m_Applications;
+
+  std::vector<std::string>                    m_Order;
+
+  std::vector<ConnectionType>                 m_Connections;
+
+  /** Position of each connected image in its input image list */
+  std::map<ConnectionType, unsigned int>      m_ListSlots;
+
+  otb::Logger::Pointer                        m_Logger;
+};
+
+} // end namespace Wrapper
+} // end namespace otb
+
+#endif
@@ -64,9 +64,16 @@ public:
   /** Return the application search path */
   static std::string GetApplicationPath();
 
-  /** Return the list of available applications */
+  /** Return the list of available applications. The plugins already
+   *  loaded by a previous call are not loaded again while their file is
+   *  unchanged (same modification time and size). */
   static std::vector<std::string> GetAvailableApplications(bool useFactory=true);
 
+  /** Return the names of the application plugins found in the search path.
+   *  Unlike GetAvailableApplications(), the plugins are not loaded: names
+   *  are deduced from the library file names. */
+  static std::vector<std::string> GetAvailableApplicationNames();
+
   /** Create the specified Application */
   static Application::Pointer CreateApplication(const std::string& applicationName, bool useFactory=true);
 
@@ -77,6 +77,11 @@ public:
 
   int Read(Application::Pointer application);
 
+  /** Set the parameters of an application from an <application> node. This
+   * is the part of Read() that does not depend on the file layout, it is
+   * also used to load each node of an application chain. */
+  int ReadParameters(Application::Pointer application, TiXmlElement *appNode);
+
   void otbAppLogInfo(Application::Pointer app, std::string info);
 
 /* copied from Utilities/tinyXMLlib/tinyxml.cpp. Must have a FIX inside tinyxml.cpp */
@@ -0,0 +1,379 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbWrapperApplicationChain.h"
+#include "otbWrapperApplicationRegistry.h"
+#include "otbWrapperInputProcessXMLParameter.h"
+#include "otbWrapperOutputImageParameter.h"
+#include "otbWrapperComplexOutputImageParameter.h"
+#include "otb_tinyxml.h"
+#include "itksys/SystemTools.hxx"
+
+#include <algorithm>
+
+namespace otb
+{
+namespace Wrapper
+{
+
+ApplicationChain::ApplicationChain()
+  : m_Logger(otb::Logger::New())
+{
+  m_Logger->SetName("ApplicationChain.logger");
+}
+
+ApplicationChain::~ApplicationChain()
+{
+}
+
+otb::Logger*
+ApplicationChain::GetLogger() const
+{
+  return m_Logger;
+}
+
+Application*
+ApplicationChain::AddApplication(const std::string & appType, std::string id)
+{
+  if (id.empty())
+    {
+    id = appType;
+    }
+  if (id.find('.') != std::string::npos)
+    {
+    itkExceptionMacro(<< "Invalid application identifier '" << id << "': it must not contain '.'");
+    }
+  if (m_Applications.count(id))
+    {
+    itkExceptionMacro(<< "The identifier '" << id << "' is already used in the chain");
+    }
+
+  Application::Pointer app = ApplicationRegistry::CreateApplication(appType);
+  if (app.IsNull())
+    {
+    itkExceptionMacro(<< "Could not find application " << appType << " in the application path: "
+                      << ApplicationRegistry::GetApplicationPath());
+    }
+  app->SetLogger(m_Logger);
+
+  m_Applications[id] = app;
+  m_Order.push_back(id);
+  this->Modified();
+  return app;
+}
+
+Application*
+ApplicationChain::GetApplication(const std::string & id) const
+{
+  auto it = m_Applications.find(id);
+  if (it == m_Applications.end())
+    {
+    itkExceptionMacro(<< "Unknown application identifier in the chain: " << id);
+    }
+  return it->second;
+}
+
+Application*
+ApplicationChain::DecodeKey(const std::string & key, std::string & paramKey) const
+{
+  size_t pos = key.find('.');
+  if (pos == std::string::npos || pos + 1 == key.size())
+    {
+    itkExceptionMacro(<< "Invalid key '" << key << "': expected <application id>.<parameter key>");
+    }
+  paramKey = key.substr(pos + 1);
+  return this->GetApplication(key.substr(0, pos));
+}
+
+void
+ApplicationChain::Connect(const std::string & fromKey, const std::string & toKey)
+{
+  std::string outKey, inKey;
+  Application* fromApp = this->DecodeKey(fromKey, outKey);
+  Application* toApp   = this->DecodeKey(toKey, inKey);
+
+  ParameterType outType = fromApp->GetParameterType(outKey);
+  if (outType != ParameterType_OutputImage && outType != ParameterType_ComplexOutputImage)
+    {
+    itkExceptionMacro(<< fromKey << " is not an output image parameter");
+    }
+  ParameterType inType = toApp->GetParameterType(inKey);
+  if (inType != ParameterType_InputImage &&
+      inType != ParameterType_InputImageList &&
+      inType != ParameterType_ComplexInputImage)
+    {
+    itkExceptionMacro(<< toKey << " is not an input image parameter");
+    }
+
+  // Applications are executed in insertion order : the source has to come first
+  const std::string fromId = fromKey.substr(0, fromKey.find('.'));
+  const std::string toId = toKey.substr(0, toKey.find('.'));
+  if (std::find(m_Order.begin(), m_Order.end(), fromId) >=
+      std::find(m_Order.begin(), m_Order.end(), toId))
+    {
+    itkExceptionMacro(<< "Can not connect " << fromKey << " to " << toKey
+                      << ": application " << fromId << " must be added before " << toId);
+    }
+
+  m_Connections.push_back(ConnectionType(fromKey, toKey));
+  this->Modified();
+}
+
+void
+ApplicationChain::SetParameterValues(const std::string & key, const std::vector<std::string> & values)
+{
+  std::string paramKey;
+  Application* app = this->DecodeKey(key, paramKey);
+  ParameterType type = app->GetParameterType(paramKey);
+
+  if (type == ParameterType_Empty)
+    {
+    app->SetParameterUserValue(paramKey, true);
+    if (values.empty() || values[0] == "1" || values[0] == "true")
+      {
+      app->EnableParameter(paramKey);
+      }
+    else
+      {
+      app->DisableParameter(paramKey);
+      }
+    }
+  else if (values.empty())
+    {
+    itkExceptionMacro(<< "No value associated to parameter " << key);
+    }
+  else if (type == ParameterType_InputVectorDataList ||
+           type == ParameterType_InputImageList ||
+           type == ParameterType_InputFilenameList ||
+           type == ParameterType_StringList ||
+           type == ParameterType_ListView)
+    {
+    app->SetParameterStringList(paramKey, values);
+    }
+  else
+    {
+    app->SetParameterString(paramKey, values[0]);
+    if (values.size() == 2 && type == ParameterType_OutputImage)
+      {
+      ImagePixelType pixType = ImagePixelType_float;
+      if (!OutputImageParameter::ConvertStringToPixelType(values[1], pixType))
+        {
+        itkExceptionMacro(<< "Invalid output type for parameter " << key << ": " << values[1]);
+        }
+      app->SetParameterOutputImagePixelType(paramKey, pixType);
+      }
+    else if (values.size() == 2 && type == ParameterType_ComplexOutputImage)
+      {
+      ComplexImagePixelType cpixType = ComplexImagePixelType_float;
+      if (!ComplexOutputImageParameter::ConvertStringToPixelType(values[1], cpixType))
+        {
+        itkExceptionMacro(<< "Invalid output type for parameter " << key << ": " << values[1]);
+        }
+      app->SetParameterComplexOutputImagePixelType(paramKey, cpixType);
+      }
+    else if (values.size() > 1)
+      {
+      itkExceptionMacro(<< "Too many values for parameter " << key);
+      }
+    }
+
+  app->UpdateParameters();
+}
+
+void
+ApplicationChain::Load(const std::string & filename)
+{
+  TiXmlDocument doc;
+  FILE* fp = itksys::SystemTools::Fopen(filename, "rb");
+  if (fp == nullptr)
+    {
+    itkExceptionMacro(<< "Can't open file " << filename);
+    }
+  if (!doc.LoadFile(fp, TIXML_ENCODING_UTF8))
+    {
+    fclose(fp);
+    itkExceptionMacro(<< "Can't parse file " << filename);
+    }
+  fclose(fp);
+
+  TiXmlHandle handle(&doc);
+  TiXmlElement *n_OTB = handle.FirstChild("OTB").Element();
+  if (!n_OTB)
+    {
+    itkExceptionMacro(<< "Input XML file " << filename << " is invalid.");
+    }
+
+  // The parameter reader is shared with the single application XML format
+  InputProcessXMLParameter::Pointer reader = InputProcessXMLParameter::New();
+
+  for (TiXmlElement* n_AppNode = n_OTB->FirstChildElement("application"); n_AppNode != nullptr;
+       n_AppNode = n_AppNode->NextSiblingElement("application"))
+    {
+    std::string appName = reader->GetChildNodeTextOf(n_AppNode, "name");
+    const char * id = n_AppNode->Attribute("id");
+    Application::Pointer app = this->AddApplication(appName, id ? std::string(id) : appName);
+    reader->ReadParameters(app, n_AppNode);
+    }
+
+  for (TiXmlElement* n_Connection = n_OTB->FirstChildElement("connection"); n_Connection != nullptr;
+       n_Connection = n_Connection->NextSiblingElement("connection"))
+    {
+    const char * from = n_Connection->Attribute("from");
+    const char * to = n_Connection->Attribute("to");
+    if (!from || !to)
+      {
+      itkExceptionMacro(<< "Invalid connection node in " << filename << ": 'from' and 'to' are required");
+      }
+    this->Connect(from, to);
+    }
+}
+
+bool
+ApplicationChain::IsConnectedOutput(const std::string & id) const
+{
+  const std::string prefix = id + ".";
+  for (const auto & connection : m_Connections)
+    {
+    if (connection.first.compare(0, prefix.size(), prefix) == 0)
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+void
+ApplicationChain::ApplyConnections(const std::string & id)
+{
+  const std::string prefix = id + ".";
+  for (const auto & connection : m_Connections)
+    {
+    if (connection.second.compare(0, prefix.size(), prefix) != 0)
+      {
+      continue;
+      }
+    std::string outKey, inKey;
+    Application* fromApp = this->DecodeKey(connection.first, outKey);
+    Application* toApp = this->DecodeKey(connection.second, inKey);
+
+    ImageBaseType * image = nullptr;
+    if (fromApp->GetParameterType(outKey) == ParameterType_ComplexOutputImage)
+      {
+      image = fromApp->GetParameterComplexOutputImage(outKey);
+      }
+    else
+      {
+      image = fromApp->GetParameterOutputImage(outKey);
+      }
+    if (image == nullptr)
+      {
+      itkExceptionMacro(<< "Output " << connection.first << " is not available, "
+                        "has the application been executed?");
+      }
+
+    switch (toApp->GetParameterType(inKey))
+      {
+      case ParameterType_InputImageList:
+        {
+        // Each connection keeps its own slot in the list, so that executing
+        // the chain several times does not append the same output twice
+        auto slot = m_ListSlots.find(connection);
+        if (slot != m_ListSlots.end() &&
+            slot->second < toApp->GetNumberOfElementsInParameterInputImageList(inKey))
+          {
+          toApp->SetNthParameterInputImageList(inKey, slot->second, image);
+          }
+        else
+          {
+          m_ListSlots[connection] = toApp->GetNumberOfElementsInParameterInputImageList(inKey);
+          toApp->AddImageToParameterInputImageList(inKey, image);
+          }
+        break;
+        }
+      case ParameterType_ComplexInputImage:
+        toApp->SetParameterComplexInputImage(inKey, image);
+        break;
+      default:
+        toApp->SetParameterInputImage(inKey, image);
+        break;
+      }
+    }
+}
+
+int
+ApplicationChain::Execute()
+{
+  for (const auto & id : m_Order)
+    {
+    this->ApplyConnections(id);
+    otbLogMacro(Debug, << "Executing " << id);
+    int status = m_Applications[id]->Execute();
+    if (status != 0)
+      {
+      return status;
+      }
+    }
+  return 0;
+}
+
+int
+ApplicationChain::ExecuteAndWriteOutput()
+{
+  for (const auto & id : m_Order)
+    {
+    this->ApplyConnections(id);
+    Application* app = m_Applications[id];
+    int status = 0;
+    if (this->IsConnectedOutput(id))
+      {
+      // Intermediate application: its outputs are pulled by the downstream
+      // writers, nothing is written on disk for it
+      otbLogMacro(Debug, << "Executing " << id << " (in-memory)");
+      status = app->Execute();
+      }
+    else
+      {
+      otbLogMacro(Debug, << "Executing and writing " << id);
+      status = app->ExecuteAndWriteOutput();
+      }
+    if (status != 0)
+      {
+      return status;
+      }
+    }
+  return 0;
+}
+
+void
+ApplicationChain::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  for (const auto & id : m_Order)
+    {
+    os << indent << id << ": " << m_Applications.at(id)->GetName() << std::endl;
+    }
+  for (const auto & connection : m_Connections)
+    {
+    os << indent << connection.first << " -> " << connection.second << std::endl;
+    }
+}
+
+} // end namespace Wrapper
+} // end namespace otb
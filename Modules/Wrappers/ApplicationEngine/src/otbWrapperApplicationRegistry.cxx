@@ -21,6 +21,7 @@
 #include "otbWrapperApplicationRegistry.h"
 #include "otbWrapperApplicationFactoryBase.h"
 #include "otbMacro.h"
+#include "otbStopwatch.h"
 #include "itksys/SystemTools.hxx"
 #include "itkDynamicLoader.h"
 #include "itkDirectory.h"
@@ -28,6 +29,7 @@
 #include "itkMutexLockHolder.h"
 
 #include <iterator>
+#include <map>
 
 namespace otb
 {
@@ -117,6 +119,124 @@ private:
 // static finalizer to close opened libraries
 static ApplicationPrivateRegistry m_ApplicationPrivateRegistryGlobal;
 
+/** Index of the application plugins found in OTB_APPLICATION_PATH.
+ *
+ * Application names are deduced from the library names, so building the
+ * index only lists the directories of the search path: no library is
+ * opened. The directories are listed again at each call, so that added
+ * and removed plugins are always seen. It is only used to list the
+ * applications: creating a single application only checks the possible
+ * library paths (see CreateApplicationFaster).
+ *
+ * The libraries which were already loaded successfully are remembered
+ * with their modification time and size, so that listing the available
+ * applications again does not open them again while they are unchanged. */
+class ApplicationIndex
+{
+public:
+  /** Library paths of each application, in search path order */
+  typedef std::map<std::string, std::vector<std::string> > IndexType;
+
+  /** Return the (name, library paths) index for the given search path */
+  IndexType Get(const std::string & searchPath)
+    {
+    otb::Stopwatch chrono = otb::Stopwatch::StartNew();
+    IndexType index;
+    ScanSearchPath(searchPath, index);
+    chrono.Stop();
+    otbLogMacro(Debug, << "Application index built in " << chrono.GetElapsedMilliseconds()
+                << " ms (" << index.size() << " applications)");
+    return index;
+    }
+
+  /** Whether the library was loaded successfully and is unchanged since */
+  bool IsKnownPlugin(const std::string & path)
+    {
+    itk::MutexLockHolder<itk::SimpleMutexLock> mutexHolder(m_Mutex);
+    PluginMapType::const_iterator it = m_KnownPlugins.find(path);
+    return it != m_KnownPlugins.end() && it->second == GetFileStamp(path);
+    }
+
+  /** Remember that the library was loaded successfully */
+  void AddKnownPlugin(const std::string & path)
+    {
+    itk::MutexLockHolder<itk::SimpleMutexLock> mutexHolder(m_Mutex);
+    m_KnownPlugins[path] = GetFileStamp(path);
+    }
+
+private:
+  /** Modification time and size of a file */
+  typedef std::pair<long int, unsigned long> FileStampType;
+  typedef std::map<std::string, FileStampType> PluginMapType;
+
+  static FileStampType GetFileStamp(const std::string & path)
+    {
+    return FileStampType(itksys::SystemTools::ModifiedTime(path),
+                         itksys::SystemTools::FileLength(path));
+    }
+
+  static void ScanSearchPath(const std::string & searchPath, IndexType & index)
+    {
+    std::string appPrefix("otbapp_");
+    std::string appExtension = itksys::DynamicLoader::LibExtension();
+#ifdef __APPLE__
+    appExtension = ".dylib";
+#endif
+
+#if defined(WIN32)
+    const char pathSeparator = ';';
+#else
+    const char pathSeparator = ':';
+#endif
+
+#ifdef _WIN32
+    const char sep = '\\';
+#else
+    const char sep = '/';
+#endif
+
+    std::vector<itksys::String> pathList;
+    if (!searchPath.empty())
+      {
+      pathList = itksys::SystemTools::SplitString(searchPath,pathSeparator,false);
+      }
+    for (unsigned int k=0 ; k<pathList.size() ; ++k)
+      {
+      itk::Directory::Pointer dir = itk::Directory::New();
+      if (pathList[k].empty() || !dir->Load(pathList[k].c_str()))
+        {
+        continue;
+        }
+      for (unsigned int i = 0; i < dir->GetNumberOfFiles(); i++)
+        {
+        std::string sfilename(dir->GetFile(i));
+        std::string::size_type extPos = sfilename.rfind(appExtension);
+
+        // Check if current file is a shared lib with the right pattern
+        if (extPos != std::string::npos &&
+            extPos + appExtension.size() == sfilename.size() &&
+            extPos > appPrefix.size() &&
+            sfilename.compare(0, appPrefix.size(), appPrefix) == 0)
+          {
+          std::string name = sfilename.substr(appPrefix.size(),extPos-appPrefix.size());
+          std::string fullpath = pathList[k];
+          if (fullpath[fullpath.size() - 1] != sep)
+            {
+            fullpath.push_back(sep);
+            }
+          fullpath.append(sfilename);
+          index[name].push_back(fullpath);
+          }
+        }
+      }
+    }
+
+  PluginMapType m_KnownPlugins;
+
+  itk::SimpleMutexLock m_Mutex;
+};
+static ApplicationIndex m_ApplicationIndexGlobal;
+
 // Define callbacks to unregister applications in ApplicationPrivateRegistry
 void DeleteAppCallback(itk::Object *obj,const itk::EventObject &, void *)
   {
@@ -243,6 +363,7 @@ ApplicationRegistry::CreateApplicationFaster(const std::string& name)
   const char sep = '/';
 #endif
 
+  otb::Stopwatch chrono = otb::Stopwatch::StartNew();
   std::string otbAppPath = GetApplicationPath();
   std::vector<itksys::String> pathList;
   if (!otbAppPath.empty())
@@ -264,74 +385,61 @@ ApplicationRegistry::CreateApplicationFaster(const std::string& name)
       break;
       }
     }
+  chrono.Stop();
+  otbLogMacro(Debug, << "Application " << name << " searched and loaded in "
+              << chrono.GetElapsedMilliseconds() << " ms");
 
   return appli;
 }
 
+std::vector<std::string>
+ApplicationRegistry::GetAvailableApplicationNames()
+{
+  ApplicationIndex::IndexType index = m_ApplicationIndexGlobal.Get(GetApplicationPath());
+
+  std::vector<std::string> appVec;
+  for (ApplicationIndex::IndexType::const_iterator it = index.begin(); it != index.end(); ++it)
+    {
+    appVec.push_back(it->first);
+    }
+  return appVec;
+}
+
 std::vector<std::string>
 ApplicationRegistry::GetAvailableApplications(bool useFactory)
 {
   ApplicationPointer appli;
   std::set<std::string> appSet;
 
-  std::string appPrefix("otbapp_");
-  std::string appExtension = itksys::DynamicLoader::LibExtension();
-#ifdef __APPLE__
-  appExtension = ".dylib";
-#endif
-
-#if defined(WIN32)
-  const char pathSeparator = ';';
-#else
-  const char pathSeparator = ':';
-#endif
-
-#ifdef _WIN32
-  const char sep = '\\';
-#else
-  const char sep = '/';
-#endif
-
-  std::string otbAppPath = GetApplicationPath();
-  std::vector<itksys::String> pathList;
-  if (!otbAppPath.empty())
+  // Every plugin is loaded to check that it really contains the
+  // application, unless it was already loaded and is unchanged
+  otb::Stopwatch chrono = otb::Stopwatch::StartNew();
+  unsigned int nbLoaded = 0;
+  ApplicationIndex::IndexType index = m_ApplicationIndexGlobal.Get(GetApplicationPath());
+  for (ApplicationIndex::IndexType::const_iterator it = index.begin(); it != index.end(); ++it)
     {
-    pathList = itksys::SystemTools::SplitString(otbAppPath,pathSeparator,false);
-    }
-  for (unsigned int k=0 ; k<pathList.size() ; ++k)
-    {
-    itk::Directory::Pointer dir = itk::Directory::New();
-    if (!dir->Load(pathList[k].c_str()))
+    // Fall back to the next directories if a library fails to load
+    for (std::vector<std::string>::const_iterator pit = it->second.begin(); pit != it->second.end(); ++pit)
       {
-      continue;
-      }
-    for (unsigned int i = 0; i < dir->GetNumberOfFiles(); i++)
-      {
-      const char *filename = dir->GetFile(i);
-      std::string sfilename(filename);
-      std::string::size_type extPos = sfilename.rfind(appExtension);
-      std::string::size_type prefixPos = sfilename.find(appPrefix);
-
-      // Check if current file is a shared lib with the right pattern
-      if (extPos + appExtension.size() == sfilename.size() &&
-          prefixPos == 0)
+      if (m_ApplicationIndexGlobal.IsKnownPlugin(*pit))
         {
-        std::string name = sfilename.substr(appPrefix.size(),extPos-appPrefix.size());
-        std::string fullpath = pathList[k];
-        if (!fullpath.empty() && fullpath[fullpath.size() - 1] != sep)
-          {
-          fullpath.push_back(sep);
-          }
-        fullpath.append(sfilename);
-        appli = LoadApplicationFromPath(fullpath,name);
-        if (appli.IsNotNull())
-          {
-          appSet.insert(name);
-          }
+        appSet.insert(it->first);
+        break;
+        }
+      appli = LoadApplicationFromPath(*pit,it->first);
+      ++nbLoaded;
+      if (appli.IsNotNull())
+        {
+        m_ApplicationIndexGlobal.AddKnownPlugin(*pit);
+        appSet.insert(it->first);
         appli = nullptr;
+        break;
         }
       }
     }
+  chrono.Stop();
+  otbLogMacro(Debug, << "Application plugins checked in " << chrono.GetElapsedMilliseconds()
+              << " ms (" << nbLoaded << " loaded)");
 
   if (useFactory)
     {
@@ -367,6 +475,7 @@ ApplicationRegistry::LoadApplicationFromPath(std::string path,std::string name)
 
   if (itksys::SystemTools::FileExists(path,true))
     {
+    otb::Stopwatch chrono = otb::Stopwatch::StartNew();
 #if defined(_WIN32) && !defined(__CYGWIN__)
     int cp = CP_UTF8;
     int acp = GetACP();
@@ -392,6 +501,8 @@ ApplicationRegistry::LoadApplicationFromPath(std::string path,std::string name)
 #else
     itk::LibHandle lib = itksys::DynamicLoader::OpenLibrary(path);
 #endif
+    chrono.Stop();
+    otbLogMacro(Debug, << "Library " << path << " opened in " << chrono.GetElapsedMilliseconds() << " ms");
     if (lib)
       {
       /**
@@ -411,10 +522,14 @@ ApplicationRegistry::LoadApplicationFromPath(std::string path,std::string name)
 
         if (appFactory)
           {
+          chrono.Restart();
           appli = appFactory->CreateApplication(name.c_str());
           if (appli.IsNotNull())
             {
             appli->Init();
+            chrono.Stop();
+            otbLogMacro(Debug, << "Application " << name << " created and initialized in "
+                        << chrono.GetElapsedMilliseconds() << " ms");
             // register library handle
             m_ApplicationPrivateRegistryGlobal.AddPair(appli.GetPointer(), (void*) lib);
             // set a callback on DeleteEvent
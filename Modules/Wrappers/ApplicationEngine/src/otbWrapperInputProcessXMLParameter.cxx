@@ -267,6 +267,22 @@ InputProcessXMLParameter::Read(Application::Pointer this_)
     return -1;
     }
 
+  this->ReadParameters(this_, n_AppNode);
+
+  //choice also comes as setint and setstring why??
+
+  ret = 0; //resetting return to zero, we don't use it anyway for now.
+
+  fclose(fp);
+
+  return ret;
+}
+
+int
+InputProcessXMLParameter::ReadParameters(Application::Pointer this_, TiXmlElement *n_AppNode)
+{
+  int ret = 0;
+
   ParameterGroup::Pointer paramGroup = this_->GetParameterList();
 
   // Iterate through the parameter list
@@ -439,11 +455,6 @@ InputProcessXMLParameter::Read(Application::Pointer this_)
     // Call UpdateParameters after each parameter is set
     this_->UpdateParameters();
     } //end updateFromXML
-  //choice also comes as setint and setstring why??
-
-  ret = 0; //resetting return to zero, we don't use it anyway for now.
-
-  fclose(fp);
 
   return ret;
 }
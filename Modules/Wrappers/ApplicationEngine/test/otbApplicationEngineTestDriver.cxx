@@ -38,5 +38,6 @@ void RegisterTests()
   REGISTER_TEST(otbWrapperOutputImageParameterTest1);
   //~ REGISTER_TEST(otbWrapperOutputImageParameterConversionTest);
   REGISTER_TEST(otbApplicationMemoryConnectTest);
+  REGISTER_TEST(otbWrapperApplicationChainTest);
   REGISTER_TEST(otbWrapperImageInterface);
 }
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "otbWrapperApplicationChain.h"
+#include "otbWrapperApplicationRegistry.h"
+
+
+int otbWrapperApplicationChainTest(int argc, char * argv[])
+{
+  if(argc<4)
+    {
+    std::cerr<<"Usage: "<<argv[0]<<" application_path infname outfname"<<std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::string path = argv[1];
+  std::string infname = argv[2];
+  std::string outfname = argv[3];
+
+  otb::Wrapper::ApplicationRegistry::SetApplicationPath(path);
+
+  otb::Wrapper::ApplicationChain::Pointer chain = otb::Wrapper::ApplicationChain::New();
+
+  chain->AddApplication("Smoothing","smooth1");
+  chain->AddApplication("Smoothing","smooth2");
+  chain->AddApplication("ConcatenateImages","concat");
+
+  chain->SetParameterValues("smooth1.in",std::vector<std::string>(1,infname));
+  chain->Connect("smooth1.out","smooth2.in");
+  chain->SetParameterValues("concat.il",std::vector<std::string>(1,infname));
+  chain->Connect("smooth2.out","concat.il");
+  chain->SetParameterValues("concat.out",std::vector<std::string>(1,outfname));
+
+  // Wrong connections are rejected
+  try
+    {
+    chain->Connect("concat.out","smooth1.in");
+    std::cerr<<"Connection to an upstream application should fail"<<std::endl;
+    return EXIT_FAILURE;
+    }
+  catch(itk::ExceptionObject &)
+    {
+    }
+
+  if (chain->ExecuteAndWriteOutput() != 0)
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Running the chain again must not append the connected image twice
+  chain->ExecuteAndWriteOutput();
+  if (chain->GetApplication("concat")->GetNumberOfElementsInParameterInputImageList("il") != 2)
+    {
+    std::cerr<<"Unexpected number of images in concat.il"<<std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
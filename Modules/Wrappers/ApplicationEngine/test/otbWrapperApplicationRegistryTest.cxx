@@ -23,6 +23,7 @@
 #endif
 
 #include "otbWrapperApplicationRegistry.h"
+#include <algorithm>
 
 int otbWrapperApplicationRegistry(int itkNotUsed(argc), char* itkNotUsed(argv)[])
 {
@@ -35,5 +36,23 @@ int otbWrapperApplicationRegistry(int itkNotUsed(argc), char* itkNotUsed(argv)[]
     {
     std::cout << *it << std::endl;
     }
+
+  // Every loadable application must be listed in the plugin index
+  std::vector<std::string> names = ApplicationRegistry::GetAvailableApplicationNames();
+  for (it = list.begin(); it != list.end(); ++it)
+    {
+    if (std::find(names.begin(), names.end(), *it) == names.end())
+      {
+      std::cout << "Application " << *it << " is missing from the plugin index" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // The second listing reuses the plugins already loaded
+  if (ApplicationRegistry::GetAvailableApplications() != list)
+    {
+    std::cout << "The second listing of the applications differs from the first one" << std::endl;
+    return EXIT_FAILURE;
+    }
   return EXIT_SUCCESS;
 }
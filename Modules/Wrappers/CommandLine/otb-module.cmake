@@ -26,6 +26,7 @@ otb_module(OTBCommandLine
     OTBITK
     OTBTinyXML
     OTBApplicationEngine
+    OTBOSSIMAdapters
 
     OPTIONAL_DEPENDS
     OTBMPIConfig
@@ -33,6 +34,7 @@ otb_module(OTBCommandLine
   TEST_DEPENDS
     OTBTestKernel
     OTBAppImageUtils
+    OTBAppProjection
 
   DESCRIPTION
     "${DOCUMENTATION}"
@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbWrapperApplicationChain.h"
+#include "otbWrapperApplicationRegistry.h"
+#include <cctype>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef OTB_USE_MPI
+#include "otbMPIConfig.h"
+#endif
+
+void ShowUsage(char* argv[])
+{
+  std::cerr << "Usage: " << argv[0] << " [-modulepath MODULEPATH] -inxml chain.xml" << std::endl;
+  std::cerr << "       " << argv[0] << " [-modulepath MODULEPATH] [id:]app_name [arguments] [+ [id:]app_name [arguments]]..." << std::endl;
+  std::cerr << std::endl;
+  std::cerr << "Applications are separated by '+'. A value written as @id.key connects" << std::endl;
+  std::cerr << "the output image 'key' of application 'id' to the parameter, in memory." << std::endl;
+  std::cerr << "Example:" << std::endl;
+  std::cerr << "  " << argv[0] << " calib:OpticalCalibration -in in.tif"
+            << " + ortho:OrthoRectification -io.in @calib.out -io.out out.tif" << std::endl;
+}
+
+bool IsParameterKey(const std::string & word)
+{
+  // Negative numerical values are not keys
+  return word.size() > 1 && word[0] == '-' && std::isalpha(word[1]);
+}
+
+void SetParameterFromWords(otb::Wrapper::ApplicationChain * chain,
+                           const std::string & id,
+                           const std::string & key,
+                           const std::vector<std::string> & words)
+{
+  std::vector<std::string> values;
+  std::vector<std::string> connections;
+  for (const auto & word : words)
+    {
+    if (word.size() > 1 && word[0] == '@')
+      {
+      connections.push_back(word.substr(1));
+      }
+    else
+      {
+      values.push_back(word);
+      }
+    }
+  const std::string fullKey = id + "." + key;
+  if (!values.empty() || connections.empty())
+    {
+    chain->SetParameterValues(fullKey, values);
+    }
+  for (const auto & from : connections)
+    {
+    chain->Connect(from, fullKey);
+    }
+}
+
+void LoadChainFromArguments(otb::Wrapper::ApplicationChain * chain,
+                            const std::vector<std::string> & args)
+{
+  std::string id;
+  std::string key;
+  std::vector<std::string> words;
+  bool expectApplication = true;
+
+  for (const auto & arg : args)
+    {
+    if (expectApplication)
+      {
+      std::string appName(arg);
+      id = arg;
+      size_t sep = arg.find(':');
+      if (sep != std::string::npos)
+        {
+        id = arg.substr(0, sep);
+        appName = arg.substr(sep + 1);
+        }
+      chain->AddApplication(appName, id);
+      expectApplication = false;
+      continue;
+      }
+
+    if (arg == "+" || IsParameterKey(arg))
+      {
+      if (!key.empty())
+        {
+        SetParameterFromWords(chain, id, key, words);
+        }
+      words.clear();
+      key.clear();
+      if (arg == "+")
+        {
+        expectApplication = true;
+        }
+      else
+        {
+        key = arg.substr(1);
+        }
+      }
+    else
+      {
+      words.push_back(arg);
+      }
+    }
+
+  if (!key.empty())
+    {
+    SetParameterFromWords(chain, id, key, words);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+  #ifdef OTB_USE_MPI
+  otb::MPIConfig::Instance()->Init(argc,argv);
+  #endif
+
+  std::vector<std::string> args;
+  for (int i = 1; i < argc; i++)
+    {
+    std::string arg(argv[i]);
+    if (!arg.empty())
+      {
+      args.push_back(arg);
+      }
+    }
+
+  if (args.size() >= 2 && args[0] == "-modulepath")
+    {
+    otb::Wrapper::ApplicationRegistry::AddApplicationPath(args[1]);
+    args.erase(args.begin(), args.begin() + 2);
+    }
+
+  if (args.empty())
+    {
+    ShowUsage(argv);
+    return EXIT_FAILURE;
+    }
+
+  int status = EXIT_FAILURE;
+  try
+    {
+    otb::Wrapper::ApplicationChain::Pointer chain = otb::Wrapper::ApplicationChain::New();
+    if (args[0] == "-inxml")
+      {
+      if (args.size() != 2)
+        {
+        ShowUsage(argv);
+        return EXIT_FAILURE;
+        }
+      chain->Load(args[1]);
+      }
+    else
+      {
+      LoadChainFromArguments(chain, args);
+      }
+    status = (chain->ExecuteAndWriteOutput() == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+  catch (itk::ExceptionObject & err)
+    {
+    std::cerr << "ERROR: " << err.GetDescription() << std::endl;
+    }
+  catch (std::exception & err)
+    {
+    std::cerr << "ERROR: " << err.what() << std::endl;
+    }
+
+  // shutdown MPI after the chain finished
+  #ifdef OTB_USE_MPI
+  otb::MPIConfig::Instance()->terminate();
+  #endif
+  return status;
+}
@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbWrapperCommandLineLauncher.h"
+#include "otbWrapperApplicationRegistry.h"
+#include "otbDEMHandler.h"
+#include "otbMacro.h"
+#include "otbStopwatch.h"
+#include "itksys/SystemTools.hxx"
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef OTB_USE_MPI
+#include "otbMPIConfig.h"
+#endif
+
+/** Status line written on stdout at the end of each request */
+static const char STATUS_PREFIX[] = "OTB_SERVER_STATUS";
+
+void ShowUsage(char* argv[])
+{
+  std::cerr << "Usage: " << argv[0] << " [-modulepath MODULEPATH]" << std::endl;
+  std::cerr << std::endl;
+  std::cerr << "Reads application requests on the standard input, one per line, with" << std::endl;
+  std::cerr << "the otbcli syntax: app_name -key value ... Values containing spaces" << std::endl;
+  std::cerr << "can be quoted. Each request is answered by a line" << std::endl;
+  std::cerr << "  " << STATUS_PREFIX << " <0|1>" << std::endl;
+  std::cerr << "after the application logs. Send 'quit' or close stdin to stop." << std::endl;
+  std::cerr << std::endl;
+  std::cerr << "Application plugins and (if OTB_MAX_CACHED_MODELS" << std::endl;
+  std::cerr << "is not 0, default 1 here) machine learning models stay in memory" << std::endl;
+  std::cerr << "between requests. The elevation setup (DEM directories, geoid and" << std::endl;
+  std::cerr << "default elevation) is reset before each request, as in a new process." << std::endl;
+}
+
+/** Split a request line in words, honoring simple and double quotes */
+bool SplitRequest(const std::string & line, std::vector<std::string> & words)
+{
+  words.clear();
+  std::string word;
+  bool inWord = false;
+  char quote = 0;
+  for (std::string::size_type i = 0; i < line.size(); ++i)
+    {
+    const char c = line[i];
+    if (quote)
+      {
+      if (c == quote)
+        {
+        quote = 0;
+        }
+      else if (c == '\\' && quote == '"' && i + 1 < line.size() &&
+               (line[i+1] == '"' || line[i+1] == '\\'))
+        {
+        word.push_back(line[++i]);
+        }
+      else
+        {
+        word.push_back(c);
+        }
+      }
+    else if (c == '"' || c == '\'')
+      {
+      quote = c;
+      inWord = true;
+      }
+    else if (c == ' ' || c == '\t' || c == '\r')
+      {
+      if (inWord)
+        {
+        words.push_back(word);
+        word.clear();
+        inWord = false;
+        }
+      }
+    else
+      {
+      word.push_back(c);
+      inWord = true;
+      }
+    }
+  if (inWord)
+    {
+    words.push_back(word);
+    }
+  return quote == 0;
+}
+
+int main(int argc, char* argv[])
+{
+  #ifdef OTB_USE_MPI
+  otb::MPIConfig::Instance()->Init(argc,argv);
+  #endif
+
+  for (int i = 1; i < argc; i++)
+    {
+    std::string arg(argv[i]);
+    if (arg == "-modulepath" && i + 1 < argc)
+      {
+      otb::Wrapper::ApplicationRegistry::AddApplicationPath(argv[++i]);
+      }
+    else
+      {
+      ShowUsage(argv);
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Keep the last loaded model in memory, unless configured otherwise
+  std::string cachedModels;
+  if (!itksys::SystemTools::GetEnv("OTB_MAX_CACHED_MODELS", cachedModels))
+    {
+    itksys::SystemTools::PutEnv("OTB_MAX_CACHED_MODELS=1");
+    }
+
+  typedef otb::Wrapper::CommandLineLauncher LauncherType;
+
+  // One instance of each application is kept alive so that its plugin is
+  // not unloaded (with its caches) when the request is over
+  std::map<std::string, otb::Wrapper::Application::Pointer> residentApplications;
+
+  std::string line;
+  std::vector<std::string> vexp;
+  while (std::getline(std::cin, line))
+    {
+    if (!SplitRequest(line, vexp))
+      {
+      std::cerr << "ERROR: Unbalanced quotes in request: " << line << std::endl;
+      std::cout << STATUS_PREFIX << " 1" << std::endl;
+      continue;
+      }
+    if (vexp.empty() || vexp[0][0] == '#')
+      {
+      continue;
+      }
+    if (vexp[0] == "quit" || vexp[0] == "exit")
+      {
+      break;
+      }
+
+    otb::Stopwatch chrono = otb::Stopwatch::StartNew();
+    bool success = false;
+    try
+      {
+      // A request without elevation parameters must not use the DEM
+      // directories and geoid opened by a previous one
+      otb::DEMHandler::Pointer demHandler = otb::DEMHandler::Instance();
+      demHandler->ClearDEMs();
+      demHandler->ClearGeoid();
+      demHandler->SetDefaultHeightAboveEllipsoid(0.);
+
+      // The resident instance is created first, so that the plugin stays
+      // loaded when the launcher releases its own instance
+      if (residentApplications.count(vexp[0]) == 0)
+        {
+        otb::Wrapper::Application::Pointer app = otb::Wrapper::ApplicationRegistry::CreateApplication(vexp[0]);
+        if (app.IsNotNull())
+          {
+          residentApplications[vexp[0]] = app;
+          }
+        }
+      LauncherType::Pointer launcher = LauncherType::New();
+      success = launcher->Load(vexp) && launcher->ExecuteAndWriteOutput();
+      }
+    catch (itk::ExceptionObject & err)
+      {
+      std::cerr << "ERROR: " << err.GetDescription() << std::endl;
+      }
+    catch (std::exception & err)
+      {
+      std::cerr << "ERROR: " << err.what() << std::endl;
+      }
+    chrono.Stop();
+    otbLogMacro(Debug, << "Request " << vexp[0] << " processed in " << chrono.GetElapsedMilliseconds() << " ms");
+
+    std::cout << STATUS_PREFIX << " " << (success ? 0 : 1) << std::endl;
+    }
+
+  residentApplications.clear();
+  otb::Wrapper::ApplicationRegistry::CleanRegistry();
+
+  #ifdef OTB_USE_MPI
+  otb::MPIConfig::Instance()->terminate();
+  #endif
+  return EXIT_SUCCESS;
+}
@@ -45,6 +45,8 @@
 
 #include "otbWrapperApplicationRegistry.h"
 #include "otbWrapperTypes.h"
+#include "otbMacro.h"
+#include "otbStopwatch.h"
 #include <itksys/RegularExpression.hxx>
 #include <string>
 #include <iostream>
@@ -271,7 +273,10 @@ bool CommandLineLauncher::BeforeExecute()
     return false;
     }
 
+  otb::Stopwatch chrono = otb::Stopwatch::StartNew();
   ParamResultType result = this->LoadParameters();
+  chrono.Stop();
+  otbLogMacro(Debug, << "Parameters loaded in " << chrono.GetElapsedMilliseconds() << " ms");
 
   if (result == MISSINGMANDATORYPARAMETER)
     {
@@ -318,7 +323,10 @@ bool CommandLineLauncher::LoadApplication()
     }
 
   // Instantiate the application using the factory
+  otb::Stopwatch chrono = otb::Stopwatch::StartNew();
   m_Application = ApplicationRegistry::CreateApplication(moduleName);
+  chrono.Stop();
+  otbLogMacro(Debug, << "Application " << moduleName << " loaded in " << chrono.GetElapsedMilliseconds() << " ms");
 
   if (m_Application.IsNull())
     {
@@ -326,7 +334,7 @@ bool CommandLineLauncher::LoadApplication()
     std::string modulePath = ApplicationRegistry::GetApplicationPath();
     std::cerr << "ERROR: Module search path: " << (modulePath.empty() ? "none (check OTB_APPLICATION_PATH)" : modulePath) << std::endl;
 
-    std::vector<std::string> list = ApplicationRegistry::GetAvailableApplications();
+    std::vector<std::string> list = ApplicationRegistry::GetAvailableApplicationNames();
     if (list.size() == 0)
       {
       std::cerr << "ERROR: Available modules: none." << std::endl;
@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "itksys/Process.h"
+
+namespace
+{
+/** Run the application server on a request file and read the status
+ *  line written for each request */
+bool RunServer(const std::string & server, const std::string & modulePath,
+               const std::string & requests, std::vector<std::string> & status)
+{
+  const std::string output = requests + ".out";
+
+  std::vector<const char*> command;
+  command.push_back(server.c_str());
+  command.push_back("-modulepath");
+  command.push_back(modulePath.c_str());
+  command.push_back(nullptr);
+
+  itksysProcess * process = itksysProcess_New();
+  itksysProcess_SetCommand(process, &command[0]);
+  itksysProcess_SetPipeFile(process, itksysProcess_Pipe_STDIN, requests.c_str());
+  itksysProcess_SetPipeFile(process, itksysProcess_Pipe_STDOUT, output.c_str());
+  itksysProcess_SetPipeShared(process, itksysProcess_Pipe_STDERR, true);
+  itksysProcess_Execute(process);
+  itksysProcess_WaitForExit(process, nullptr);
+  const int state = itksysProcess_GetState(process);
+  const int retCode = itksysProcess_GetExitValue(process);
+  itksysProcess_Delete(process);
+
+  if (state != itksysProcess_State_Exited || retCode != EXIT_SUCCESS)
+    {
+    std::cerr << "Server did not exit normally (state " << state << ", code " << retCode << ")" << std::endl;
+    return false;
+    }
+
+  // Application logs are mixed with the status lines on stdout
+  status.clear();
+  std::ifstream ifs(output.c_str());
+  std::string line;
+  while (std::getline(ifs, line))
+    {
+    std::istringstream iss(line);
+    std::string prefix, code;
+    if ((iss >> prefix >> code) && prefix == "OTB_SERVER_STATUS")
+      {
+      status.push_back(code);
+      }
+    }
+  return true;
+}
+
+/** Check the status lines against the expected ones */
+bool CheckStatus(const std::vector<std::string> & status, const std::vector<std::string> & expected)
+{
+  if (status == expected)
+    {
+    return true;
+    }
+  std::cerr << "Unexpected status lines:";
+  for (size_t i = 0; i < status.size(); ++i)
+    {
+    std::cerr << " " << status[i];
+    }
+  std::cerr << " (expected";
+  for (size_t i = 0; i < expected.size(); ++i)
+    {
+    std::cerr << " " << expected[i];
+    }
+  std::cerr << ")" << std::endl;
+  return false;
+}
+
+std::string ReadFile(const std::string & filename)
+{
+  std::ifstream ifs(filename.c_str(), std::ios::binary);
+  std::ostringstream oss;
+  oss << ifs.rdbuf();
+  return oss.str();
+}
+}
+
+/** Run the application server on a request file and check the status
+ *  line written for each request */
+int otbApplicationServerCommandLineTest(int argc, char* argv[])
+{
+  if (argc != 7)
+    {
+    std::cerr << "Usage: " << argv[0]
+              << " <server> <modulepath> <input> <requests> <out1> <out2>" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string server(argv[1]);
+  const std::string modulePath(argv[2]);
+  const std::string input(argv[3]);
+  const std::string requests(argv[4]);
+  const std::string out1(argv[5]);
+  const std::string out2(argv[6]);
+
+  // Two applications, an unknown one and the first one again, in one session
+  std::ofstream ofs(requests.c_str());
+  ofs << "# application server session" << std::endl;
+  ofs << "Rescale -in \"" << input << "\" -out \"" << out1 << "\" -outmin 15 -outmax 200" << std::endl;
+  ofs << "ExtractROI -in \"" << input << "\" -out \"" << out2 << "\" -startx 10 -starty 10 -sizex 20 -sizey 20" << std::endl;
+  ofs << "NotAnApplication -in \"" << input << "\"" << std::endl;
+  ofs << "Rescale -in \"" << input << "\" -out \"" << out1 << "\" -outmin 0 -outmax 255" << std::endl;
+  ofs << "quit" << std::endl;
+  ofs << "Rescale -in \"" << input << "\" -out \"" << out1 << "\"" << std::endl;
+  ofs.close();
+
+  std::vector<std::string> status;
+  if (!RunServer(server, modulePath, requests, status))
+    {
+    return EXIT_FAILURE;
+    }
+
+  const char * expected[] = {"0", "0", "1", "0"};
+  if (!CheckStatus(status, std::vector<std::string>(expected, expected + 4)))
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+/** Run two orthorectifications in one session, only the first one with a
+ *  DEM, and a fresh session with the second one only. Both outputs of the
+ *  second request are compared by the test driver. */
+int otbApplicationServerCommandLineElevationTest(int argc, char* argv[])
+{
+  if (argc != 9)
+    {
+    std::cerr << "Usage: " << argv[0]
+              << " <server> <modulepath> <input> <demdir> <requests> <outdem> <outsession> <outfresh>" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string server(argv[1]);
+  const std::string modulePath(argv[2]);
+  const std::string input(argv[3]);
+  const std::string demDirectory(argv[4]);
+  const std::string requests(argv[5]);
+  const std::string outDEM(argv[6]);
+  const std::string outSession(argv[7]);
+  const std::string outFresh(argv[8]);
+  const std::string freshRequests = requests + ".fresh";
+
+  std::ofstream ofs(requests.c_str());
+  ofs << "OrthoRectification -io.in \"" << input << "\" -io.out \"" << outDEM
+      << "\" -elev.dem \"" << demDirectory << "\"" << std::endl;
+  ofs << "OrthoRectification -io.in \"" << input << "\" -io.out \"" << outSession << "\"" << std::endl;
+  ofs.close();
+
+  ofs.open(freshRequests.c_str());
+  ofs << "OrthoRectification -io.in \"" << input << "\" -io.out \"" << outFresh << "\"" << std::endl;
+  ofs.close();
+
+  std::vector<std::string> status;
+  if (!RunServer(server, modulePath, requests, status)
+      || !CheckStatus(status, std::vector<std::string>(2, "0")))
+    {
+    return EXIT_FAILURE;
+    }
+  if (!RunServer(server, modulePath, freshRequests, status)
+      || !CheckStatus(status, std::vector<std::string>(1, "0")))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Otherwise the test would not check anything
+  if (ReadFile(outDEM) == ReadFile(outFresh))
+    {
+    std::cerr << "The DEM does not change the orthorectified image" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
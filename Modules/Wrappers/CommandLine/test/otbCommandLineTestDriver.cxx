@@ -27,4 +27,6 @@ void RegisterTests()
   REGISTER_TEST(otbWrapperCommandLineParserTest2);
   REGISTER_TEST(otbWrapperCommandLineParserTest3);
   REGISTER_TEST(otbWrapperCommandLineParserTest4);
+  REGISTER_TEST(otbApplicationServerCommandLineTest);
+  REGISTER_TEST(otbApplicationServerCommandLineElevationTest);
 }
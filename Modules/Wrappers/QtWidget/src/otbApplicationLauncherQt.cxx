@@ -74,7 +74,7 @@ int main(int argc, char* argv[])
     std::cerr << "Could not find application " << moduleName << std::endl;
     std::string modulePath = ApplicationRegistry::GetApplicationPath();
     std::cout << "Module search path : " << modulePath << std::endl;
-    std::vector<std::string> list = ApplicationRegistry::GetAvailableApplications();
+    std::vector<std::string> list = ApplicationRegistry::GetAvailableApplicationNames();
 
     std::cout << "Available applications : " << (list.empty() ? "None" : "") << std::endl;
     for (std::vector<std::string>::const_iterator it = list.begin(); it != list.end(); ++it)
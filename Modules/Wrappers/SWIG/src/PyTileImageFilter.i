@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if SWIGPYTHON
+
+ %{
+#include "otbPyTileImageFilter.h"
+typedef otb::PyTileImageFilter          PyTileImageFilter;
+typedef otb::PyTileImageFilter::Pointer PyTileImageFilter_Pointer;
+
+/** Release the GIL for the lifetime of the object, used around the calls
+ *  that run a whole pipeline */
+class PyGILReleaser
+{
+public:
+  PyGILReleaser() : m_State(PyEval_SaveThread()) {}
+  ~PyGILReleaser() { PyEval_RestoreThread(m_State); }
+private:
+  PyThreadState * m_State;
+};
+ %}
+
+%init
+%{
+#if PY_VERSION_HEX < 0x03070000
+  PyEval_InitThreads();
+#endif
+%}
+
+class PyTileImageFilter : public itkProcessObject
+{
+public:
+  static PyTileImageFilter_Pointer New();
+  virtual char const * GetNameOfClass() const;
+
+  void SetTileFunction(PyObject *obj);
+  PyObject * GetTileFunction();
+  void SetInputImage(ImageBaseType * image);
+  ImageBaseType * GetOutputImage();
+  void SetNumberOfOutputBands(unsigned int nb);
+  unsigned int GetNumberOfOutputBands() const;
+  void SetRadius(unsigned int radius);
+  unsigned int GetRadius() const;
+protected:
+  PyTileImageFilter();
+};
+DECLARE_REF_COUNT_CLASS( PyTileImageFilter )
+
+%pythoncode {
+
+class _TileBufferView(object):
+  """
+  Numpy array interface on a raw float buffer owned by a PyTileImageFilter
+  """
+  def __init__(self, address, shape, readonly):
+    import numpy
+    self.__array_interface__ = {
+      'version' : 3,
+      'shape' : shape,
+      'typestr' : numpy.dtype('float32').str,
+      'data' : (address, readonly)
+      }
+
+class _TileFunctionAdapter(object):
+  """
+  Turn the raw buffers given by PyTileImageFilter into numpy views and call
+  the user function with them
+  """
+  def __init__(self, function, radius):
+    self.function = function
+    self.radius = radius
+
+  def __call__(self, inAddress, inShape, outAddress, outShape, offset):
+    import numpy
+    inArray = numpy.asarray(_TileBufferView(inAddress, inShape, True))
+    outArray = numpy.asarray(_TileBufferView(outAddress, outShape, False))
+    row, col = offset
+    if self.radius == 0:
+      # give the function an input aligned on the output region
+      self.function(inArray[row:row+outShape[0], col:col+outShape[1]], outArray)
+    else:
+      r0 = max(0, row - self.radius)
+      c0 = max(0, col - self.radius)
+      r1 = min(inShape[0], row + outShape[0] + self.radius)
+      c1 = min(inShape[1], col + outShape[1] + self.radius)
+      self.function(inArray[r0:r1, c0:c1], outArray, (row - r0, col - c0))
+
+def ApplyTileFunction(image, function, nbBands = 0, radius = 0):
+  """
+  Insert a Python function in a streamed pipeline. The function is called
+  for each streamed region as function(inArray, outArray), where the arrays
+  are (rows, cols, bands) float32 numpy views on the OTB buffers; it must
+  fill outArray in place. With a radius, the input array has a margin of
+  up to 'radius' pixels around the output region, and the function is
+  called as function(inArray, outArray, (row, col)) where (row, col) is the
+  position of the output region in inArray.
+  The views are only valid during the call. Returns the filter, which has
+  to be kept alive while its output is used (see ConnectTileFunction).
+  """
+  tileFilter = PyTileImageFilter.New()
+  tileFilter.SetTileFunction(_TileFunctionAdapter(function, radius))
+  tileFilter.SetNumberOfOutputBands(nbBands)
+  tileFilter.SetRadius(radius)
+  tileFilter.SetInputImage(image)
+  return tileFilter
+
+}
+
+#endif
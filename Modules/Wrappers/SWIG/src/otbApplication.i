@@ -204,6 +204,19 @@ public:
 
 } // end of namespace otb
 
+#if SWIGPYTHON
+// Writing the outputs runs the whole pipeline: release the GIL meanwhile, so
+// that other Python threads can run. Python code called from the pipeline
+// (PyCommand, PyTileImageFilter) takes it back when needed.
+%exception Application::ExecuteAndWriteOutput
+{
+  {
+  PyGILReleaser releaser;
+  $action
+  }
+}
+#endif
+
 class Application: public itkObject
 {
 public:
@@ -373,7 +386,7 @@ public:
     img->Update();                                                            \
     unsigned int nbComp = img->GetNumberOfComponentsPerPixel();               \
     ImageBaseType::RegionType region = img->GetBufferedRegion();              \
-    ImageBaseType::SizeType size = region.GetSize();                          \
+    *buffer = nullptr;                                                        \
     *dim1 = region.GetSize(1);                                                \
     *dim2 = region.GetSize(0);                                                \
     *dim3 = nbComp;                                                           \
@@ -403,6 +416,13 @@ public:
             "and RGBA<T> not supported yet)" << std::endl;                    \
         }                                                                     \
       }                                                                       \
+    if (*buffer == nullptr)                                                   \
+      {                                                                       \
+      /* never expose a view on an invalid pointer */                         \
+      *dim1 = 0;                                                              \
+      *dim2 = 0;                                                              \
+      *dim3 = 0;                                                              \
+      }                                                                       \
     }
 
   GetVectorImageAsNumpyArrayMacro(UInt8, unsigned char)
@@ -714,6 +734,21 @@ class ApplicationProxy(object):
 
 #if OTB_SWIGNUMPY
 
+%pythoncode {
+
+class ImageBufferView(object):
+  """
+  Expose the buffer of an OTB image through the numpy array interface.
+  numpy.asarray() on this object gives an array sharing the image memory,
+  whose base is this object: the owner (application) is kept alive as long
+  as the array is used.
+  """
+  def __init__(self, owner, array):
+    self._owner = owner
+    self.__array_interface__ = array.__array_interface__
+
+}
+
 %extend Application
 {
   %pythoncode
@@ -752,11 +787,26 @@ class ApplicationProxy(object):
       ImagePixelType_cdouble : SetVectorImageFromCDoubleNumpyArray_,
       }
     
+    def _KeepNumpyInput(self, paramKey, index, npArray):
+      """
+      The image created from a numpy array shares its buffer: keep a reference
+      to the array as long as the application lives. Non contiguous arrays
+      (slices, transposes) are copied once, because the image buffer has to
+      be contiguous.
+      """
+      if not npArray.flags['C_CONTIGUOUS']:
+        npArray = npArray.copy(order='C')
+      self.__dict__.setdefault('_numpyInputs', {})[(paramKey, index)] = npArray
+      return npArray
+
     def SetImageFromNumpyArray(self, paramKey, npArray, index=0):
       """
       This method takes a numpy array and set ImageIOBase of
       InputImageParameter by creating an otbImage with
       same pixel type as numpyarray.dtype
+      NOTE: The array is not copied (unless it is not contiguous), the
+      image points to its buffer. The array must not be resized while the
+      application uses it.
       """
       shp = npArray.shape
       if len(shp) == 2:
@@ -767,6 +817,7 @@ class ApplicationProxy(object):
                            "Cannot convert to Image, use SetVectorImageFromNumpyArray instead\n")
       else:
         raise ValueError( "Expected 2 or 3 dimensions for numpyarray\n")
+      npArray = self._KeepNumpyInput(paramKey, index, npArray)
       dt = npArray.dtype.name
       isFound = False
       for pixT in self.ImageImporterMap:
@@ -774,8 +825,6 @@ class ApplicationProxy(object):
           isFound = True
           img = self.ImageImporterMap[pixT](self,paramKey, index, npArray)
           break
-      if len(shp) == 2:
-        npArray = npArray.reshape(shp)
       if not isFound:
         raise ValueError("Can't convert Numpy array of dtype "+dt)
       return img
@@ -786,12 +835,15 @@ class ApplicationProxy(object):
       InputImageParameter by creating an otbVectorImage with
       same pixel type as numpyarray.dtype.
       NOTE: Input (npArray) must be an ndarray with 2 or 3 dimensions,
+      NOTE: The array is not copied (unless it is not contiguous), the
+      image points to its buffer.
       """
       shp = npArray.shape
       if len(shp) == 2:
         npArray = npArray.reshape((shp[0],shp[1],1))
       elif len(npArray.shape) != 3:
         raise ValueError( "Expected 2 or 3 dimensions for numpyarray")
+      npArray = self._KeepNumpyInput(paramKey, index, npArray)
       dt = npArray.dtype.name
       isFound = False
       for pixT in self.VectorImageImporterMap:
@@ -799,8 +851,6 @@ class ApplicationProxy(object):
           isFound = True
           img = self.VectorImageImporterMap[pixT](self,paramKey, index, npArray)
           break
-      if len(shp) == 2:
-        npArray = npArray.reshape(shp)
       if not isFound:
         raise ValueError("Can't convert Numpy array of dtype "+dt)
       return img
@@ -816,9 +866,14 @@ class ApplicationProxy(object):
       cfloat, cdouble.
       NOTE: This method always return an numpy array with 3 dimensions
       NOTE: cint16 and cint32 are not supported yet
+      NOTE: The array is a view on the output buffer, it keeps the
+      application alive. It is invalidated if the application is executed
+      again.
       """
+      import numpy
       pixT = self.GetImageBasePixelType(paramKey)
-      return self.NumpyExporterMap[pixT](self,paramKey)
+      array = self.NumpyExporterMap[pixT](self,paramKey)
+      return numpy.asarray(ImageBufferView(self, array))
 
     def GetImageAsNumpyArray(self, paramKey, dt='float'):
       """
@@ -832,8 +887,7 @@ class ApplicationProxy(object):
       NOTE: This method always return an numpy array with 2 dimensions
       NOTE: cint16 and cint32 are not supported yet
       """
-      pixT = self.GetImageBasePixelType(paramKey)
-      array = self.NumpyExporterMap[pixT](self,paramKey)
+      array = self.GetVectorImageAsNumpyArray(paramKey)
       if array.shape[2] > 1:
         raise ValueError("array.shape[2] > 1\n"
                          "Output image from application has more than 1 band\n"
@@ -858,6 +912,19 @@ class ApplicationProxy(object):
       img = self.SetVectorImageFromNumpyArray(paramKey, pyImg["array"], index)
       self.SetupImageInformation(img, pyImg["origin"], pyImg["spacing"], pyImg["size"], pyImg["region"], pyImg["metadata"])
 
+    def ConnectTileFunction(self, paramKey, upstream, upstreamKey, function, nbBands = 0, radius = 0):
+      """
+      Connect the output image 'upstreamKey' of the application 'upstream' to
+      the input image 'paramKey' of this application, through a Python
+      function called on each streamed tile (see ApplyTileFunction). The
+      streaming of the downstream application is preserved.
+      """
+      tileFilter = ApplyTileFunction(upstream.GetParameterOutputImage(upstreamKey), function, nbBands, radius)
+      self.SetParameterInputImage(paramKey, tileFilter.GetOutputImage())
+      # the filter and the upstream application must live as long as this one
+      self.__dict__.setdefault('_tileFilters', {})[paramKey] = (tileFilter, upstream)
+      return tileFilter
+
     def ExportImage(self, paramKey):
       """
       Export an output image from an otbApplication into a python dictionary with the
@@ -882,6 +949,7 @@ class Registry : public itkObject
 public:
 
   static std::vector<std::string> GetAvailableApplications();
+  static std::vector<std::string> GetAvailableApplicationNames();
   static Application_Pointer CreateApplication(const std::string& name);
   static void AddApplicationPath(std::string newpath);
   static void SetApplicationPath(std::string newpath);
@@ -909,6 +977,7 @@ public:
 };
 
 %include "PyCommand.i"
+%include "PyTileImageFilter.i"
 
 %extend itkMetaDataDictionary
 {
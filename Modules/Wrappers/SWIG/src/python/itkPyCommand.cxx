@@ -79,9 +79,13 @@ void PyCommand::Execute(const Object*, const EventObject&)
 
 void PyCommand::PyExecute()
 {
+    // the command may be invoked by a pipeline running without the GIL
+    PyGILState_STATE state = PyGILState_Ensure();
+
     // make sure that the CommandCallable is in fact callable
     if (!PyCallable_Check(this->obj))
     {
+        PyGILState_Release(state);
         // we throw a standard ITK exception: this makes it possible for
         // our standard CableSwig exception handling logic to take this
         // through to the invoking Python process
@@ -97,11 +101,13 @@ void PyCommand::PyExecute()
         if (result)
         {
             Py_DECREF(result);
+            PyGILState_Release(state);
         }
         else
         {
             // there was a Python error.  Clear the error by printing to stdout
             PyErr_Print();
+            PyGILState_Release(state);
             // make sure the invoking Python code knows there was a problem
             // by raising an exception
             itkExceptionMacro(<<"There was an error executing the "
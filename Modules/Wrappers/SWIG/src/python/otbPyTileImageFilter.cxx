@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 1999-2011 Insight Software Consortium
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbPyTileImageFilter.h"
+
+namespace otb
+{
+
+PyTileImageFilter::PyTileImageFilter()
+  : m_TileFunction(nullptr),
+    m_NumberOfOutputBands(0),
+    m_Radius(0)
+{
+}
+
+PyTileImageFilter::~PyTileImageFilter()
+{
+  if (m_TileFunction)
+    {
+    PyGILState_STATE state = PyGILState_Ensure();
+    Py_DECREF(m_TileFunction);
+    PyGILState_Release(state);
+    }
+  m_TileFunction = nullptr;
+}
+
+void
+PyTileImageFilter::SetTileFunction(PyObject *obj)
+{
+  if (obj != m_TileFunction)
+    {
+    if (m_TileFunction)
+      {
+      Py_DECREF(m_TileFunction);
+      }
+    m_TileFunction = obj;
+    if (m_TileFunction)
+      {
+      Py_INCREF(m_TileFunction);
+      }
+    this->Modified();
+    }
+}
+
+PyObject *
+PyTileImageFilter::GetTileFunction()
+{
+  return m_TileFunction;
+}
+
+void
+PyTileImageFilter::SetInputImage(Wrapper::ImageBaseType * image)
+{
+  ImageType * input = dynamic_cast<ImageType *>(image);
+  if (input == nullptr)
+    {
+    itkExceptionMacro(<< "The input of the tile function must be a float vector image");
+    }
+  this->SetInput(input);
+}
+
+Wrapper::ImageBaseType *
+PyTileImageFilter::GetOutputImage()
+{
+  return this->GetOutput();
+}
+
+void
+PyTileImageFilter::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  unsigned int nbBands = m_NumberOfOutputBands;
+  if (nbBands == 0)
+    {
+    nbBands = this->GetInput()->GetNumberOfComponentsPerPixel();
+    }
+  this->GetOutput()->SetNumberOfComponentsPerPixel(nbBands);
+}
+
+void
+PyTileImageFilter::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  ImageType * input = const_cast<ImageType *>(this->GetInput());
+  if (!input)
+    {
+    return;
+    }
+  RegionType requested = this->GetOutput()->GetRequestedRegion();
+  requested.PadByRadius(m_Radius);
+  requested.Crop(input->GetLargestPossibleRegion());
+  input->SetRequestedRegion(requested);
+}
+
+void
+PyTileImageFilter::GenerateData()
+{
+  this->AllocateOutputs();
+
+  const ImageType * input = this->GetInput();
+  ImageType * output = this->GetOutput();
+
+  const RegionType & inRegion = input->GetBufferedRegion();
+  const RegionType & outRegion = output->GetBufferedRegion();
+
+  // Pointer to the first pixel of the buffered regions
+  const float * inBuffer = input->GetBufferPointer();
+  float * outBuffer = output->GetBufferPointer();
+
+  PyGILState_STATE state = PyGILState_Ensure();
+
+  if (!PyCallable_Check(m_TileFunction))
+    {
+    PyGILState_Release(state);
+    itkExceptionMacro(<< "The tile function is not a callable Python object, or it has not been set.");
+    }
+
+  PyObject * args = Py_BuildValue("(N(kkk)N(kkk)(ll))",
+    PyLong_FromVoidPtr(const_cast<float *>(inBuffer)),
+    static_cast<unsigned long>(inRegion.GetSize(1)),
+    static_cast<unsigned long>(inRegion.GetSize(0)),
+    static_cast<unsigned long>(input->GetNumberOfComponentsPerPixel()),
+    PyLong_FromVoidPtr(outBuffer),
+    static_cast<unsigned long>(outRegion.GetSize(1)),
+    static_cast<unsigned long>(outRegion.GetSize(0)),
+    static_cast<unsigned long>(output->GetNumberOfComponentsPerPixel()),
+    static_cast<long>(outRegion.GetIndex(1) - inRegion.GetIndex(1)),
+    static_cast<long>(outRegion.GetIndex(0) - inRegion.GetIndex(0)));
+
+  PyObject * result = args ? PyObject_CallObject(m_TileFunction, args) : nullptr;
+  Py_XDECREF(args);
+
+  if (result)
+    {
+    Py_DECREF(result);
+    PyGILState_Release(state);
+    }
+  else
+    {
+    // Print the Python error and report it as an ITK exception
+    PyErr_Print();
+    PyGILState_Release(state);
+    itkExceptionMacro(<< "There was an error executing the tile function on region " << outRegion);
+    }
+}
+
+} // namespace otb
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 1999-2011 Insight Software Consortium
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbPyTileImageFilter_h
+#define otbPyTileImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "otbWrapperTypes.h"
+
+// The python header defines _POSIX_C_SOURCE without a preceding #undef
+#undef _POSIX_C_SOURCE
+// The python header defines _XOPEN_SOURCE without a preceding #undef
+#undef _XOPEN_SOURCE
+
+#include <Python.h>
+
+namespace otb
+{
+
+/** \class PyTileImageFilter
+ *  \brief Filter calling a Python callable on each streamed region
+ *
+ * For each requested region, the filter calls the tile function with the
+ * addresses and shapes of the input and output buffers:
+ *
+ *   function(inAddress, (rows, cols, bands), outAddress, (rows, cols, bands), (row, col))
+ *
+ * The last tuple is the position of the output region in the input buffer,
+ * which is larger than the output region when a radius is set. The Python
+ * side wraps the addresses as numpy views (see ApplyTileFunction in
+ * otbApplication.i) : nothing is copied and the views are only valid during
+ * the call.
+ *
+ * The GIL is only held during the call, so that the rest of the pipeline
+ * runs without it. The filter is not multi-threaded: the callable is called
+ * once per streamed region, from the thread that updates the pipeline.
+ *
+ * \ingroup OTBSWIG
+ */
+class PyTileImageFilter
+  : public itk::ImageToImageFilter<Wrapper::FloatVectorImageType, Wrapper::FloatVectorImageType>
+{
+public:
+  /** Standard class typedefs. */
+  typedef PyTileImageFilter                Self;
+  typedef itk::ImageToImageFilter<Wrapper::FloatVectorImageType,
+                                  Wrapper::FloatVectorImageType> Superclass;
+  typedef itk::SmartPointer<Self>          Pointer;
+  typedef itk::SmartPointer<const Self>    ConstPointer;
+
+  typedef Wrapper::FloatVectorImageType    ImageType;
+  typedef ImageType::RegionType            RegionType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(PyTileImageFilter, ImageToImageFilter);
+
+  /** Set the Python callable. The filter takes out a reference on it. */
+  void SetTileFunction(PyObject *obj);
+
+  PyObject * GetTileFunction();
+
+  /** Set the input from a generic image, it must be a FloatVectorImageType */
+  void SetInputImage(Wrapper::ImageBaseType * image);
+
+  /** Get the output as a generic image, to connect it to an application */
+  Wrapper::ImageBaseType * GetOutputImage();
+
+  /** Number of bands of the output, 0 means same as input (default) */
+  itkSetMacro(NumberOfOutputBands, unsigned int);
+  itkGetConstMacro(NumberOfOutputBands, unsigned int);
+
+  /** Margin of input pixels needed around each output region (default 0) */
+  itkSetMacro(Radius, unsigned int);
+  itkGetConstMacro(Radius, unsigned int);
+
+protected:
+  PyTileImageFilter();
+  ~PyTileImageFilter() override;
+
+  void GenerateOutputInformation() override;
+
+  void GenerateInputRequestedRegion() override;
+
+  void GenerateData() override;
+
+private:
+  PyTileImageFilter(const Self &) = delete;
+  void operator =(const Self&) = delete;
+
+  PyObject     *m_TileFunction;
+
+  unsigned int  m_NumberOfOutputBands;
+
+  unsigned int  m_Radius;
+};
+
+} // namespace otb
+
+#endif
@@ -0,0 +1,80 @@
+# -*- coding: utf-8 -*-
+#
+# Copyright (C) 2005-2017 CS Systemes d'Information (CS SI)
+#
+# This file is part of Orfeo Toolbox
+#
+#     https://www.orfeo-toolbox.org/
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+#  Check that numpy arrays exchanged with applications share their buffer
+#  and keep their owner alive
+#
+
+import gc
+import numpy as np
+
+def test(otbApplication, argv):
+	inFile = argv[1]
+
+	ExtractROI = otbApplication.Registry.CreateApplication("ExtractROI")
+	ExtractROI.SetParameterString("in", inFile)
+	ExtractROI.Execute()
+
+	out = ExtractROI.GetVectorImageAsNumpyArray("out")
+	ref = out.copy()
+
+	# the array is a view on the output buffer, not a copy
+	if out.flags['OWNDATA'] or out.base is None:
+		raise RuntimeError("Output array owns its data: the buffer was copied")
+	out[0, 0, 0] += 1
+	view = ExtractROI.GetVectorImageAsNumpyArray("out")
+	if view[0, 0, 0] != out[0, 0, 0] or \
+			view.__array_interface__['data'][0] != out.__array_interface__['data'][0]:
+		raise RuntimeError("Writing to the output array did not change the image buffer")
+	out[0, 0, 0] -= 1
+	del view
+
+	# the array keeps the application and its output buffer alive
+	del ExtractROI
+	gc.collect()
+	if not np.array_equal(out, ref):
+		raise RuntimeError("Output buffer released while still in use")
+
+	# a contiguous input is not copied: changing it before execution
+	# changes the output
+	inArray = ref.copy()
+	Identity = otbApplication.Registry.CreateApplication("ExtractROI")
+	Identity.SetVectorImageFromNumpyArray("in", inArray)
+	inArray[0, 0, 0] += 1
+	Identity.Execute()
+	identity = Identity.GetVectorImageAsNumpyArray("out")
+	if identity[0, 0, 0] != inArray[0, 0, 0]:
+		raise RuntimeError("Input array was copied by the application")
+	del identity, Identity
+
+	# a strided input is copied once
+	Rescale = otbApplication.Registry.CreateApplication("Rescale")
+	Rescale.SetVectorImageFromNumpyArray("in", ref[:, ::2, :])
+	Rescale.SetParameterFloat("outmin", 0)
+	Rescale.SetParameterFloat("outmax", 255)
+	del ref
+	gc.collect()
+	Rescale.Execute()
+	rescaled = Rescale.GetVectorImageAsNumpyArray("out")
+	if rescaled.shape[1] != (out.shape[1] + 1) // 2:
+		raise RuntimeError("Unexpected output shape " + str(rescaled.shape))
+	if rescaled.min() < 0 or rescaled.max() > 255:
+		raise RuntimeError("Unexpected output range")
@@ -0,0 +1,59 @@
+# -*- coding: utf-8 -*-
+#
+# Copyright (C) 2005-2017 CS Systemes d'Information (CS SI)
+#
+# This file is part of Orfeo Toolbox
+#
+#     https://www.orfeo-toolbox.org/
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+#  Insert a Python function in a streamed pipeline between two applications
+#
+
+import numpy as np
+
+def test(otbApplication, argv):
+	inFile  = argv[1]
+	outFile = argv[2]
+
+	calls = []
+	def double(inArray, outArray):
+		calls.append(outArray.shape)
+		outArray[...] = 2 * inArray
+
+	Smoothing = otbApplication.Registry.CreateApplication("Smoothing")
+	Smoothing.SetParameterString("in", inFile)
+	Smoothing.SetParameterString("type", "mean")
+	Smoothing.Execute()
+
+	ExtractROI = otbApplication.Registry.CreateApplication("ExtractROI")
+	ExtractROI.ConnectTileFunction("in", Smoothing, "out", double)
+	ExtractROI.SetParameterString("out", outFile)
+	# small RAM budget to stream the output in several tiles
+	ExtractROI.SetParameterInt("ram", 1)
+	ExtractROI.ExecuteAndWriteOutput()
+
+	if len(calls) < 2:
+		raise RuntimeError("The tile function was called %d time(s)" % len(calls))
+
+	Reference = otbApplication.Registry.CreateApplication("ExtractROI")
+	Reference.SetParameterInputImage("in", Smoothing.GetParameterOutputImage("out"))
+	Reference.Execute()
+	Result = otbApplication.Registry.CreateApplication("ExtractROI")
+	Result.SetParameterString("in", outFile)
+	Result.Execute()
+	if not np.allclose(Result.GetVectorImageAsNumpyArray("out"),
+	                   2 * Reference.GetVectorImageAsNumpyArray("out")):
+		raise RuntimeError("Tile function output differs from the expected one")